@@ -89,16 +89,25 @@ struct IntrinsicBase
     return x - proj;
   }
   
+  /// Projection of 3D points (one per column) into the camera plane (Apply pose, disto (if any) and Intrinsics)
+  /// Batch version of project: the camera model is only dispatched once for all the points
+  Mat2X project(
+    const geometry::Pose3 & pose,
+    const Mat3X & pts3D,
+    bool applyDistortion = true) const
+  {
+    const Mat2X X = pose(pts3D).colwise().hnormalized(); // apply pose
+    if (applyDistortion && this->have_disto()) // apply disto & intrinsics
+      return this->cam2imaPoints( this->addDistoPoints(X) );
+    else // apply intrinsics
+      return this->cam2imaPoints(X);
+  }
+
+  /// Compute the residuals between the 3D projected points X and the image observations x (one per column)
   Mat2X residuals(const geometry::Pose3 & pose, const Mat3X & X, const Mat2X & x) const
   {
     assert(X.cols() == x.cols());
-    const std::size_t numPts = x.cols();
-    Mat2X residuals = Mat2X::Zero(2, numPts);
-    for(std::size_t i = 0; i < numPts; ++i)
-    {
-      residuals.col(i) = residual(pose, X.col(i), x.col(i));
-    }
-    return residuals;
+    return x - this->project(pose, X);
   }
 
   // --
@@ -138,6 +147,48 @@ struct IntrinsicBase
   /// Return the distorted pixel (with added distortion)
   virtual Vec2 get_d_pixel(const Vec2& p) const = 0;
 
+  // --
+  // Batch members (one point per column)
+  // The default implementations call the per-point virtual members,
+  // camera models override them with statically dispatched versions.
+  // --
+
+  /// Transform points from the camera plane to the image plane
+  virtual Mat2X cam2imaPoints(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return this->cam2ima(pt); });
+  }
+
+  /// Transform points from the image plane to the camera plane
+  virtual Mat2X ima2camPoints(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return this->ima2cam(pt); });
+  }
+
+  /// Add the distortion field to points (that are in normalized camera frame)
+  virtual Mat2X addDistoPoints(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return this->add_disto(pt); });
+  }
+
+  /// Remove the distortion to camera points (that are in normalized camera frame)
+  virtual Mat2X removeDistoPoints(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return this->remove_disto(pt); });
+  }
+
+  /// Return the un-distorted pixels (with removed distortion)
+  virtual Mat2X getUndistortedPixels(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return this->get_ud_pixel(pt); });
+  }
+
+  /// Return the distorted pixels (with added distortion)
+  virtual Mat2X getDistortedPixels(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return this->get_d_pixel(pt); });
+  }
+
   /// Normalize a given unit pixel error to the camera plane
   virtual double imagePlane_toCameraPlaneError(double value) const = 0;
 
@@ -174,6 +225,17 @@ struct IntrinsicBase
     _locked  = false;
   }
 
+protected:
+  /// Apply a point transformation to each column of p
+  template <typename TransformFunction>
+  static Mat2X transformPoints(const Mat2X& p, const TransformFunction& function)
+  {
+    Mat2X out(2, p.cols());
+    for(Mat2X::Index i = 0; i < p.cols(); ++i)
+      out.col(i) = function(p.col(i));
+    return out;
+  }
+
 private:
   /// intrinsic lock
   bool _locked = false;
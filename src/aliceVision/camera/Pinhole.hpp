@@ -92,6 +92,18 @@ class Pinhole : public IntrinsicBase
     return ( p -  principal_point() ) / focal();
   }
 
+  // Transform points from the camera plane to the image plane
+  virtual Mat2X cam2imaPoints(const Mat2X& p) const
+  {
+    return (focal() * p).colwise() + principal_point();
+  }
+
+  // Transform points from the image plane to the camera plane
+  virtual Mat2X ima2camPoints(const Mat2X& p) const
+  {
+    return (p.colwise() - principal_point()) / focal();
+  }
+
   virtual bool have_disto() const {  return false; }
 
   virtual Vec2 add_disto(const Vec2& p) const  { return p; }
@@ -152,6 +164,26 @@ class Pinhole : public IntrinsicBase
   /// Return the distorted pixel (with added distortion)
   virtual Vec2 get_d_pixel(const Vec2& p) const {return p;}
 
+  virtual Mat2X addDistoPoints(const Mat2X& p) const { return p; }
+
+  virtual Mat2X removeDistoPoints(const Mat2X& p) const { return p; }
+
+  /// Return the un-distorted pixels (with removed distortion)
+  virtual Mat2X getUndistortedPixels(const Mat2X& p) const
+  {
+    if(!have_disto())
+      return p;
+    return Pinhole::cam2imaPoints( removeDistoPoints(Pinhole::ima2camPoints(p)) );
+  }
+
+  /// Return the distorted pixels (with added distortion)
+  virtual Mat2X getDistortedPixels(const Mat2X& p) const
+  {
+    if(!have_disto())
+      return p;
+    return Pinhole::cam2imaPoints( addDistoPoints(Pinhole::ima2camPoints(p)) );
+  }
+
 private:
   // Focal & principal point are embed into the calibration matrix K
   Mat3 _K, _Kinv;
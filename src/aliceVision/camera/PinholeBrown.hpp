@@ -70,6 +70,27 @@ class PinholeBrownT2 : public Pinhole
       return cam2ima( add_disto(ima2cam(p)) );
     }
 
+    /// Add distortion to the points p (one per column), vectorized over all points
+    virtual Mat2X addDistoPoints(const Mat2X& p) const
+    {
+        const double k1 = _distortionParams[0], k2 = _distortionParams[1], k3 = _distortionParams[2], t1 = _distortionParams[3], t2 = _distortionParams[4];
+        const Eigen::Array<double, 1, Eigen::Dynamic> x = p.row(0).array();
+        const Eigen::Array<double, 1, Eigen::Dynamic> y = p.row(1).array();
+        const Eigen::Array<double, 1, Eigen::Dynamic> r2 = x * x + y * y;
+        const Eigen::Array<double, 1, Eigen::Dynamic> k_coeff = 1. + r2 * (k1 + r2 * (k2 + r2 * k3));
+        const Eigen::Array<double, 1, Eigen::Dynamic> xy2 = 2. * x * y;
+
+        Mat2X out(2, p.cols());
+        out.row(0) = (x * k_coeff + t2 * (r2 + 2. * x * x) + t1 * xy2).matrix();
+        out.row(1) = (y * k_coeff + t1 * (r2 + 2. * y * y) + t2 * xy2).matrix();
+        return out;
+    }
+
+    virtual Mat2X removeDistoPoints(const Mat2X& p) const
+    {
+      return transformPoints(p, [this](const Vec2& pt) { return PinholeBrownT2::remove_disto(pt); });
+    }
+
     private:
 
     /// Functor to calculate distortion offset accounting for both radial and tangential distortion
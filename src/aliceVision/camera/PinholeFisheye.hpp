@@ -99,6 +99,39 @@ class PinholeFisheye : public Pinhole
   {
     return cam2ima( add_disto(ima2cam(p)) );
   }
+
+  /// Add distortion to the points p (one per column), vectorized over all points
+  virtual Mat2X addDistoPoints(const Mat2X& p) const
+  {
+    const double eps = 1e-8;
+    const double k1 = _distortionParams.at(0), k2 = _distortionParams.at(1), k3 = _distortionParams.at(2), k4 = _distortionParams.at(3);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r = p.colwise().norm().array();
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta = r.atan();
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta2 = theta.square();
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta_dist = theta * (1. + theta2 * (k1 + theta2 * (k2 + theta2 * (k3 + theta2 * k4))));
+    const Eigen::Array<double, 1, Eigen::Dynamic> cdist = (r > eps).select(theta_dist / r, 1.0);
+
+    return p.array().rowwise() * cdist;
+  }
+
+  /// Remove distortion from the points p (one per column), vectorized over all points
+  virtual Mat2X removeDistoPoints(const Mat2X& p) const
+  {
+    const double eps = 1e-8;
+    const double k1 = _distortionParams.at(0), k2 = _distortionParams.at(1), k3 = _distortionParams.at(2), k4 = _distortionParams.at(3);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta_dist = p.colwise().norm().array();
+    Eigen::Array<double, 1, Eigen::Dynamic> theta = theta_dist;
+    for(int j = 0; j < 10; ++j)
+    {
+      const Eigen::Array<double, 1, Eigen::Dynamic> theta2 = theta.square();
+      theta = theta_dist / (1. + theta2 * (k1 + theta2 * (k2 + theta2 * (k3 + theta2 * k4))));
+    }
+    const Eigen::Array<double, 1, Eigen::Dynamic> scale = (theta_dist > eps).select(theta.tan() / theta_dist, 1.0);
+
+    return p.array().rowwise() * scale;
+  }
 };
 
 } // namespace camera
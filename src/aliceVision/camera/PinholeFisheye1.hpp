@@ -68,6 +68,28 @@ public:
   {
     return cam2ima( add_disto(ima2cam(p)) );
   }
+
+  /// Add distortion to the points p (one per column), vectorized over all points
+  virtual Mat2X addDistoPoints(const Mat2X& p) const
+  {
+    const double k1 = _distortionParams.at(0);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r = p.colwise().norm().array();
+    const Eigen::Array<double, 1, Eigen::Dynamic> coef = (2.0 * std::tan(0.5 * k1) * r).atan() / (k1 * r);
+
+    return p.array().rowwise() * coef;
+  }
+
+  /// Remove distortion from the points p (one per column), vectorized over all points
+  virtual Mat2X removeDistoPoints(const Mat2X& p) const
+  {
+    const double k1 = _distortionParams.at(0);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r = p.colwise().norm().array();
+    const Eigen::Array<double, 1, Eigen::Dynamic> coef = (0.5 / std::tan(0.5 * k1)) * (k1 * r).tan() / r;
+
+    return p.array().rowwise() * coef;
+  }
 };
 
 } // namespace camera
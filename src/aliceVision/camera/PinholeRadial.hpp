@@ -102,6 +102,22 @@ class PinholeRadialK1 : public Pinhole
     return cam2ima( add_disto(ima2cam(p)) );
   }
 
+  /// Add distortion to the points p (one per column), vectorized over all points
+  virtual Mat2X addDistoPoints(const Mat2X& p) const
+  {
+    const double k1 = _distortionParams.at(0);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    const Eigen::Array<double, 1, Eigen::Dynamic> r_coeff = 1. + k1 * r2;
+
+    return p.array().rowwise() * r_coeff;
+  }
+
+  virtual Mat2X removeDistoPoints(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return PinholeRadialK1::remove_disto(pt); });
+  }
+
   private:
 
   /// Functor to solve Square(disto(radius(p'))) = r^2
@@ -170,6 +186,22 @@ class PinholeRadialK3 : public Pinhole
     return cam2ima( add_disto(ima2cam(p)) );
   }
 
+  /// Add distortion to the points p (one per column), vectorized over all points
+  virtual Mat2X addDistoPoints(const Mat2X& p) const
+  {
+    const double k1 = _distortionParams[0], k2 = _distortionParams[1], k3 = _distortionParams[2];
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    const Eigen::Array<double, 1, Eigen::Dynamic> r_coeff = 1. + r2 * (k1 + r2 * (k2 + r2 * k3));
+
+    return p.array().rowwise() * r_coeff;
+  }
+
+  virtual Mat2X removeDistoPoints(const Mat2X& p) const
+  {
+    return transformPoints(p, [this](const Vec2& pt) { return PinholeRadialK3::remove_disto(pt); });
+  }
+
   private:
 
   /// Functor to solve Square(disto(radius(p'))) = r^2
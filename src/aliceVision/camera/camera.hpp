@@ -15,6 +15,7 @@
 #include <aliceVision/camera/PinholeFisheye.hpp>
 #include <aliceVision/camera/PinholeFisheye1.hpp>
 #include <aliceVision/camera/cameraUndistortImage.hpp>
+#include <aliceVision/camera/cameraUndistortMap.hpp>
 
 namespace aliceVision {
 namespace camera {
@@ -0,0 +1,407 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/Sampler.hpp>
+#include <aliceVision/camera/cameraCommon.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace aliceVision {
+namespace camera {
+
+namespace detail {
+
+/**
+ * @brief Channel access used by the remap to interpolate the channels as float arrays
+ */
+template <typename T>
+struct RemapPixel
+{
+  static const int channels = 1;
+
+  static inline float channel(const T& pixel, int) { return static_cast<float>(pixel); }
+
+  static inline typename image::RealPixel<T>::real_type toReal(const Eigen::ArrayXXf& values, int i)
+  {
+    return values(i, 0);
+  }
+};
+
+template <typename U>
+struct RemapPixel<image::Rgb<U>>
+{
+  static const int channels = 3;
+
+  static inline float channel(const image::Rgb<U>& pixel, int c) { return static_cast<float>(pixel(c)); }
+
+  static inline image::Rgb<double> toReal(const Eigen::ArrayXXf& values, int i)
+  {
+    return image::Rgb<double>(values(i, 0), values(i, 1), values(i, 2));
+  }
+};
+
+template <typename U>
+struct RemapPixel<image::Rgba<U>>
+{
+  static const int channels = 4;
+
+  static inline float channel(const image::Rgba<U>& pixel, int c) { return static_cast<float>(pixel(c)); }
+
+  static inline image::Rgba<double> toReal(const Eigen::ArrayXXf& values, int i)
+  {
+    return image::Rgba<double>(values(i, 0), values(i, 1), values(i, 2), values(i, 3));
+  }
+};
+
+} // namespace detail
+
+/**
+ * @brief Precomputed undistortion remap grid.
+ *
+ * For each pixel of the undistorted image, store the integer position of the corresponding
+ * distorted pixel (2 x int16) and its packed fractional part (uint16), which indexes a table
+ * of bilinear interpolation weights (same layout as the OpenCV CV_16SC2 + CV_16UC1 maps).
+ * Building the grid costs one distortion evaluation per pixel, applying it only
+ * costs a bilinear interpolation, so the grid should be shared by all the images
+ * with the same intrinsic and resolution (see UndistortMapCache).
+ * The grid uses 6 bytes per pixel and the images are limited to 32767 pixels per side.
+ */
+class UndistortMap
+{
+public:
+  /// Number of fractional bits of the coordinates
+  static const int fractionalBits = 5;
+  static const int fractionalScale = 1 << fractionalBits;
+  static const int fractionalMask = fractionalScale - 1;
+  /// Number of entries of the interpolation weight table
+  static const int weightTableSize = fractionalScale * fractionalScale;
+
+  /// Marker of pixels without source in the distorted image
+  static const std::int16_t invalid = std::numeric_limits<std::int16_t>::min();
+
+  UndistortMap() = default;
+
+  /**
+   * @brief Build the remap grid of an intrinsic
+   * @param[in] intrinsic The camera intrinsic
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] correctPrincipalPoint Move the principal point to the image center
+   */
+  UndistortMap(const IntrinsicBase& intrinsic, int width, int height, bool correctPrincipalPoint = false)
+  {
+    build(intrinsic, width, height, correctPrincipalPoint);
+  }
+
+  void build(const IntrinsicBase& intrinsic, int width, int height, bool correctPrincipalPoint = false)
+  {
+    if(width > std::numeric_limits<std::int16_t>::max() || height > std::numeric_limits<std::int16_t>::max())
+      throw std::invalid_argument("Undistortion map: image size " + std::to_string(width) + "x" + std::to_string(height) + " is too large.");
+
+    _width = width;
+    _height = height;
+    _xy.resize(2 * static_cast<std::size_t>(width) * height);
+    _fxy.resize(static_cast<std::size_t>(width) * height);
+
+    Vec2 ppCorrection(0.0, 0.0);
+    if(correctPrincipalPoint && camera::isPinhole(intrinsic.getType()))
+    {
+      const Vec2 center(width * 0.5, height * 0.5);
+      ppCorrection = dynamic_cast<const camera::Pinhole&>(intrinsic).principal_point() - center;
+    }
+
+    #pragma omp parallel for
+    for(int j = 0; j < height; ++j)
+    {
+      // compute coordinates with distortion for the whole row at once
+      Mat2X undisto_pix(2, width);
+      undisto_pix.row(0) = Eigen::RowVectorXd::LinSpaced(width, 0, width - 1);
+      undisto_pix.row(1).setConstant(j);
+
+      const Mat2X disto_pix = intrinsic.getDistortedPixels(undisto_pix).colwise() + ppCorrection;
+
+      std::int16_t* rowXY = &_xy[2 * static_cast<std::size_t>(j) * width];
+      std::uint16_t* rowFXY = &_fxy[static_cast<std::size_t>(j) * width];
+      for(int i = 0; i < width; ++i)
+      {
+        const double x = disto_pix(0, i);
+        const double y = disto_pix(1, i);
+
+        // same domain test as UndistortImage
+        if(!(x > -1.0 && x < width && y > -1.0 && y < height))
+        {
+          rowXY[2 * i] = invalid;
+          rowXY[2 * i + 1] = invalid;
+          rowFXY[i] = 0;
+          continue;
+        }
+        const int xf = static_cast<int>(std::floor(x * fractionalScale + 0.5));
+        const int yf = static_cast<int>(std::floor(y * fractionalScale + 0.5));
+
+        // arithmetic shift gives the floor of the coordinates
+        rowXY[2 * i] = static_cast<std::int16_t>(xf >> fractionalBits);
+        rowXY[2 * i + 1] = static_cast<std::int16_t>(yf >> fractionalBits);
+        rowFXY[i] = static_cast<std::uint16_t>(((yf & fractionalMask) << fractionalBits) | (xf & fractionalMask));
+      }
+    }
+  }
+
+  inline int width() const { return _width; }
+  inline int height() const { return _height; }
+  inline bool empty() const { return _xy.empty(); }
+
+  /// Memory used by the grid in bytes
+  inline std::size_t memorySize() const
+  {
+    return _xy.size() * sizeof(std::int16_t) + _fxy.size() * sizeof(std::uint16_t);
+  }
+
+  /**
+   * @brief Bilinear weights (w00, w01, w10, w11) of each packed fractional position
+   * @return the shared table of weightTableSize x 4 weights
+   */
+  static const std::vector<float>& weightTable()
+  {
+    static const std::vector<float> table = buildWeightTable();
+    return table;
+  }
+
+  /**
+   * @brief Undistort an image with the remap grid (bilinear interpolation)
+   * @param[in] imageIn The distorted image (same size as the grid)
+   * @param[out] image_ud The undistorted image
+   * @param[in] fillcolor The color of the pixels without source
+   */
+  template <typename T>
+  void remap(const image::Image<T>& imageIn, image::Image<T>& image_ud, T fillcolor) const
+  {
+    assert(imageIn.Width() == _width && imageIn.Height() == _height);
+
+    typedef detail::RemapPixel<T> RemapPixel;
+    const int nbChannels = RemapPixel::channels;
+
+    image_ud.resize(_width, _height, true, fillcolor);
+    const image::Sampler2d<image::SamplerLinear> sampler;
+    const float* weights = weightTable().data();
+    const float invScale = 1.0f / fractionalScale;
+
+    #pragma omp parallel
+    {
+      // per thread row buffers: the interior pixels of a row are gathered,
+      // then interpolated with Eigen packets (vectorized, remainder handled by Eigen)
+      std::vector<int> columns(_width);
+      Eigen::ArrayXXf p00(_width, nbChannels), p01(_width, nbChannels), p10(_width, nbChannels), p11(_width, nbChannels);
+      Eigen::ArrayXf w00(_width), w01(_width), w10(_width), w11(_width);
+      Eigen::ArrayXXf result(_width, nbChannels);
+
+      #pragma omp for
+      for(int j = 0; j < _height; ++j)
+      {
+        const std::int16_t* rowXY = &_xy[2 * static_cast<std::size_t>(j) * _width];
+        const std::uint16_t* rowFXY = &_fxy[static_cast<std::size_t>(j) * _width];
+        int n = 0;
+
+        for(int i = 0; i < _width; ++i)
+        {
+          const int x0 = rowXY[2 * i];
+          const int y0 = rowXY[2 * i + 1];
+
+          if(x0 == invalid)
+            continue;
+
+          const int fxy = rowFXY[i];
+
+          if(x0 < 0 || y0 < 0 || x0 + 1 >= _width || y0 + 1 >= _height)
+          {
+            // image border: use the generic sampler (handles missing neighbors)
+            const float x = x0 + (fxy & fractionalMask) * invScale;
+            const float y = y0 + (fxy >> fractionalBits) * invScale;
+            image_ud(j, i) = sampler(imageIn, y, x);
+            continue;
+          }
+
+          const T* row0 = &imageIn(y0, x0);
+          const T* row1 = &imageIn(y0 + 1, x0);
+          for(int c = 0; c < nbChannels; ++c)
+          {
+            p00(n, c) = RemapPixel::channel(row0[0], c);
+            p01(n, c) = RemapPixel::channel(row0[1], c);
+            p10(n, c) = RemapPixel::channel(row1[0], c);
+            p11(n, c) = RemapPixel::channel(row1[1], c);
+          }
+          const float* w = &weights[4 * fxy];
+          w00(n) = w[0];
+          w01(n) = w[1];
+          w10(n) = w[2];
+          w11(n) = w[3];
+          columns[n++] = i;
+        }
+
+        for(int c = 0; c < nbChannels; ++c)
+        {
+          result.col(c).head(n) = p00.col(c).head(n) * w00.head(n) + p01.col(c).head(n) * w01.head(n) +
+                                  p10.col(c).head(n) * w10.head(n) + p11.col(c).head(n) * w11.head(n);
+        }
+
+        for(int k = 0; k < n; ++k)
+          image_ud(j, columns[k]) = image::RealPixel<T>::convert_from_real(RemapPixel::toReal(result, k));
+      }
+    }
+  }
+
+private:
+  static std::vector<float> buildWeightTable()
+  {
+    std::vector<float> table(4 * weightTableSize);
+    for(int fy = 0; fy < fractionalScale; ++fy)
+    {
+      for(int fx = 0; fx < fractionalScale; ++fx)
+      {
+        const float ax = static_cast<float>(fx) / fractionalScale;
+        const float ay = static_cast<float>(fy) / fractionalScale;
+        float* w = &table[4 * ((fy << fractionalBits) | fx)];
+        w[0] = (1.0f - ax) * (1.0f - ay);
+        w[1] = ax * (1.0f - ay);
+        w[2] = (1.0f - ax) * ay;
+        w[3] = ax * ay;
+      }
+    }
+    return table;
+  }
+
+  int _width = 0;
+  int _height = 0;
+  /// interleaved integer (x, y) distorted coordinates, row major
+  std::vector<std::int16_t> _xy;
+  /// packed fractional parts (fy << fractionalBits | fx), index in the weight table
+  std::vector<std::uint16_t> _fxy;
+};
+
+/**
+ * @brief Thread-safe cache of undistortion remap grids.
+ *
+ * Grids are keyed on the intrinsic hash, the resolution and the principal point correction.
+ * When several threads request the same missing grid, only one of them builds it.
+ * The grids are kept until they are released, the caller should release the grids
+ * of an intrinsic once its last image is undistorted.
+ */
+class UndistortMapCache
+{
+public:
+  /**
+   * @brief Get the remap grid of an intrinsic, build it if needed
+   * @param[in] intrinsic The camera intrinsic
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] correctPrincipalPoint Move the principal point to the image center
+   * @return the shared remap grid
+   */
+  std::shared_ptr<const UndistortMap> get(const IntrinsicBase& intrinsic, int width, int height, bool correctPrincipalPoint = false)
+  {
+    const Key key(intrinsic.hashValue(), width, height, correctPrincipalPoint);
+
+    std::promise<std::shared_ptr<const UndistortMap>> promise;
+    std::shared_future<std::shared_ptr<const UndistortMap>> future;
+    bool mustBuild = false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const auto it = _maps.find(key);
+      if(it != _maps.end())
+      {
+        future = it->second;
+      }
+      else
+      {
+        future = promise.get_future().share();
+        _maps.emplace(key, future);
+        mustBuild = true;
+      }
+    }
+
+    if(mustBuild)
+    {
+      try
+      {
+        promise.set_value(std::make_shared<const UndistortMap>(intrinsic, width, height, correctPrincipalPoint));
+      }
+      catch(...)
+      {
+        // do not keep the failure in the cache
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _maps.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+      }
+    }
+    return future.get();
+  }
+
+  /// Number of cached grids
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _maps.size();
+  }
+
+  /**
+   * @brief Release the cached grids of an intrinsic (all resolutions),
+   * the grids still used by the callers are freed once they are not used anymore
+   * @param[in] intrinsic The camera intrinsic
+   */
+  void release(const IntrinsicBase& intrinsic)
+  {
+    const std::size_t hash = intrinsic.hashValue();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _maps.lower_bound(Key(hash, std::numeric_limits<int>::min(), std::numeric_limits<int>::min(), false));
+    while(it != _maps.end() && std::get<0>(it->first) == hash)
+      it = _maps.erase(it);
+  }
+
+  /// Release all the cached grids
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maps.clear();
+  }
+
+private:
+  typedef std::tuple<std::size_t, int, int, bool> Key;
+
+  mutable std::mutex _mutex;
+  std::map<Key, std::shared_future<std::shared_ptr<const UndistortMap>>> _maps;
+};
+
+/// Undistort an image with a precomputed remap grid
+template <typename T>
+void UndistortImage(
+  const image::Image<T>& imageIn,
+  const UndistortMap& undistortMap,
+  image::Image<T>& image_ud,
+  T fillcolor)
+{
+  undistortMap.remap(imageIn, image_ud, fillcolor);
+}
+
+} // namespace camera
+} // namespace aliceVision
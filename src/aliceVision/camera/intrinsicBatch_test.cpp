@@ -0,0 +1,63 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+
+#define BOOST_TEST_MODULE intrinsicBatch
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+#include <memory>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create one camera of each pinhole model
+// - Generate random points inside the image domain
+// - Assert that the batch members give the same results as the per-point members
+//-----------------
+BOOST_AUTO_TEST_CASE(intrinsicBatch_samePerPoint)
+{
+  std::vector<std::shared_ptr<IntrinsicBase>> cameras;
+  cameras.emplace_back(new Pinhole(1000, 1000, 1000, 500, 500));
+  cameras.emplace_back(new PinholeRadialK1(1000, 1000, 1000, 500, 500, 0.1));
+  cameras.emplace_back(new PinholeRadialK3(1000, 1000, 1000, 500, 500, -0.245539, 0.255195, 0.163773));
+  cameras.emplace_back(new PinholeBrownT2(1000, 1000, 1000, 500, 500, -0.054, 0.014, 0.006, 0.001, -0.001));
+  cameras.emplace_back(new PinholeFisheye(1000, 1000, 1000, 500, 500, -0.054, 0.014, 0.006, 0.011));
+  cameras.emplace_back(new PinholeFisheye1(1000, 1000, 1000, 500, 500, 0.1));
+
+  const int nbPoints = 100;
+  const Mat2X ptsImage = (Mat2X::Random(2, nbPoints) * 800. / 2.).colwise() + Vec2(500, 500);
+  const Mat3X pts3D = (Mat3X::Random(3, nbPoints)).colwise() + Vec3(0, 0, 5);
+  const geometry::Pose3 pose(RotationAroundY(0.1), Vec3(0.1, -0.2, 0.3));
+
+  const double epsilon = 1e-8;
+  for(const auto& cam : cameras)
+  {
+    const Mat2X ptsCamera = cam->ima2camPoints(ptsImage);
+    const Mat2X ptsCameraDisto = cam->addDistoPoints(ptsCamera);
+    const Mat2X ptsCameraUndisto = cam->removeDistoPoints(ptsCamera);
+    const Mat2X ptsImageDisto = cam->getDistortedPixels(ptsImage);
+    const Mat2X ptsImageUndisto = cam->getUndistortedPixels(ptsImage);
+    const Mat2X ptsProjected = cam->project(pose, pts3D);
+
+    for(int i = 0; i < nbPoints; ++i)
+    {
+      const Vec2 ptImage = ptsImage.col(i);
+      EXPECT_MATRIX_NEAR(cam->ima2cam(ptImage), ptsCamera.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(cam->cam2ima(cam->ima2cam(ptImage)), cam->cam2imaPoints(ptsCamera).col(i), epsilon);
+      EXPECT_MATRIX_NEAR(cam->add_disto(cam->ima2cam(ptImage)), ptsCameraDisto.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(cam->remove_disto(cam->ima2cam(ptImage)), ptsCameraUndisto.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(cam->get_d_pixel(ptImage), ptsImageDisto.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(cam->get_ud_pixel(ptImage), ptsImageUndisto.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(cam->project(pose, Vec3(pts3D.col(i))), ptsProjected.col(i), epsilon);
+    }
+  }
+}
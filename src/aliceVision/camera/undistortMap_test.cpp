@@ -0,0 +1,81 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+
+#define BOOST_TEST_MODULE undistortMap
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a PinholeRadialK3 camera and a smooth synthetic image
+// - Undistort the image with UndistortImage and with a cached remap grid
+// - Assert that both images are (nearly) identical
+// - Assert that the cache gives back the same grid for the same intrinsic
+// - Assert that the grids of a released intrinsic are removed from the cache
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortMap_sameAsUndistortImage)
+{
+  const int width = 320;
+  const int height = 240;
+  const PinholeRadialK3 cam(width, height, 300, 165, 118, -0.245539, 0.255195, 0.163773);
+
+  image::Image<float> imageIn(width, height);
+  for(int j = 0; j < height; ++j)
+    for(int i = 0; i < width; ++i)
+      imageIn(j, i) = 0.5f * i + 0.25f * j;
+
+  image::Image<float> imageUndistorted;
+  UndistortImage(imageIn, &cam, imageUndistorted, -1.f);
+
+  UndistortMapCache cache;
+  const std::shared_ptr<const UndistortMap> undistortMap = cache.get(cam, width, height);
+  BOOST_CHECK(cache.get(cam, width, height) == undistortMap);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  image::Image<float> imageRemapped;
+  UndistortImage(imageIn, *undistortMap, imageRemapped, -1.f);
+
+  BOOST_CHECK_EQUAL(imageRemapped.Width(), width);
+  BOOST_CHECK_EQUAL(imageRemapped.Height(), height);
+
+  // fixed-point coordinates have 1/32 pixel accuracy
+  for(int j = 0; j < height; ++j)
+    for(int i = 0; i < width; ++i)
+      BOOST_CHECK_SMALL(imageRemapped(j, i) - imageUndistorted(j, i), 0.02f);
+
+  // RGB images use the same grid
+  image::Image<image::RGBColor> rgbIn(width, height);
+  for(int j = 0; j < height; ++j)
+    for(int i = 0; i < width; ++i)
+      rgbIn(j, i) = image::RGBColor(static_cast<unsigned char>(i / 2), static_cast<unsigned char>(j), 128);
+
+  image::Image<image::RGBColor> rgbUndistorted;
+  image::Image<image::RGBColor> rgbRemapped;
+  UndistortImage(rgbIn, &cam, rgbUndistorted, image::BLACK);
+  UndistortImage(rgbIn, *undistortMap, rgbRemapped, image::BLACK);
+
+  for(int j = 0; j < height; ++j)
+    for(int i = 0; i < width; ++i)
+      for(int c = 0; c < 3; ++c)
+        BOOST_CHECK_LE(std::abs(static_cast<int>(rgbRemapped(j, i)(c)) - static_cast<int>(rgbUndistorted(j, i)(c))), 1);
+
+  const PinholeRadialK3 otherCam(width, height, 310, 165, 118, -0.245539, 0.255195, 0.163773);
+  cache.get(otherCam, width, height);
+  cache.get(cam, width / 2, height / 2);
+  BOOST_CHECK_EQUAL(cache.size(), 3);
+
+  cache.release(cam);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  // the released grid is still valid for its users
+  BOOST_CHECK_EQUAL(undistortMap->width(), width);
+  BOOST_CHECK(cache.get(cam, width, height) != undistortMap);
+}
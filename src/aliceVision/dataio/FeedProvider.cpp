@@ -6,6 +6,7 @@
 
 #include "FeedProvider.hpp"
 #include <aliceVision/config.hpp>
+#include <aliceVision/system/Logger.hpp>
 #include "ImageFeed.hpp"
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENCV)
 #include "VideoFeed.hpp"
@@ -13,15 +14,236 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
 #include <exception>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <limits>
+#include <thread>
+#include <vector>
 #include <ctype.h>
 
 namespace aliceVision{
 namespace dataio{
 
+/**
+ * @brief Decode the frames of a feed on a background thread, into a ring buffer of frames.
+ * The feed is only used by the background thread.
+ */
+class FeedProvider::AsyncReader
+{
+public:
+  enum class EImageType { RGB, GRAY_FLOAT, GRAY_UCHAR };
+
+  static EImageType getImageType(const image::Image<image::RGBColor>&) { return EImageType::RGB; }
+  static EImageType getImageType(const image::Image<float>&) { return EImageType::GRAY_FLOAT; }
+  static EImageType getImageType(const image::Image<unsigned char>&) { return EImageType::GRAY_UCHAR; }
+
+  /**
+   * @brief Start decoding the frames firstFrame + floor(k * frameStep)
+   * @param[in] feeder The feed
+   * @param[in] imageType The type of the decoded images
+   * @param[in] readAhead The ring buffer size
+   * @param[in] frameStep The step between two decoded frames
+   * @param[in] firstFrame The first decoded frame
+   * @param[in] isLiveFeed True if the feed cannot seek
+   */
+  AsyncReader(IFeed& feeder, EImageType imageType, std::size_t readAhead, double frameStep, unsigned int firstFrame, bool isLiveFeed)
+    : _feeder(feeder)
+    , _imageType(imageType)
+    , _frameStep(frameStep)
+    , _firstFrame(firstFrame)
+    , _isLiveFeed(isLiveFeed)
+    , _frames(readAhead)
+  {
+    _thread = std::thread(&AsyncReader::run, this);
+  }
+
+  ~AsyncReader()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _condition.notify_all();
+    _thread.join();
+  }
+
+  EImageType getImageType() const { return _imageType; }
+
+  /**
+   * @brief Get a decoded frame, wait for its decoding if needed.
+   * The previous frames of the ring buffer are dropped.
+   * @param[in] frame The frame index
+   * @param[in,out] image The decoded image, swapped with the ring buffer image
+   * @param[out] isDecoded False if the frame is not decoded by this reader (before the decoded frames or not in the frame step)
+   * @return True if the frame is valid
+   */
+  template<typename T>
+  bool read(unsigned int frame,
+            image::Image<T> &image,
+            camera::PinholeRadialK3 &camIntrinsics,
+            std::string &mediaPath,
+            bool &hasIntrinsics,
+            bool &isDecoded)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    isDecoded = true;
+
+    while(true)
+    {
+      _condition.wait(lock, [this]{ return _count > 0 || _isDone; });
+
+      if(_count == 0)
+      {
+        // no more frames, decoded until the end of the feed or until the frame
+        isDecoded = (frame >= _endFrame);
+        return false;
+      }
+
+      Frame& decoded = _frames[_head];
+      // the frame is before the decoded frames or too far after them
+      if(decoded.frame > frame || (frame - decoded.frame) > _frames.size() * _frameStep)
+      {
+        isDecoded = false;
+        return false;
+      }
+      if(decoded.frame == frame)
+      {
+        const bool isValid = decoded.isValid;
+        image.swap(getImage(decoded, image));
+        camIntrinsics = decoded.intrinsics;
+        hasIntrinsics = decoded.hasIntrinsics;
+        mediaPath = decoded.mediaPath;
+        pop();
+        lock.unlock();
+        _condition.notify_all();
+        return isValid;
+      }
+      // previous frame, not read
+      pop();
+      _condition.notify_all();
+    }
+  }
+
+private:
+  struct Frame
+  {
+    unsigned int frame = 0;
+    bool isValid = false;
+    image::Image<image::RGBColor> imageRGB;
+    image::Image<float> imageFloat;
+    image::Image<unsigned char> imageUChar;
+    camera::PinholeRadialK3 intrinsics;
+    bool hasIntrinsics = false;
+    std::string mediaPath;
+  };
+
+  static image::Image<image::RGBColor>& getImage(Frame& frame, const image::Image<image::RGBColor>&) { return frame.imageRGB; }
+  static image::Image<float>& getImage(Frame& frame, const image::Image<float>&) { return frame.imageFloat; }
+  static image::Image<unsigned char>& getImage(Frame& frame, const image::Image<unsigned char>&) { return frame.imageUChar; }
+
+  void pop()
+  {
+    _head = (_head + 1) % _frames.size();
+    --_count;
+  }
+
+  bool decode(Frame& frame)
+  {
+    switch(_imageType)
+    {
+      case EImageType::RGB:        return _feeder.readImage(frame.imageRGB, frame.intrinsics, frame.mediaPath, frame.hasIntrinsics);
+      case EImageType::GRAY_FLOAT: return _feeder.readImage(frame.imageFloat, frame.intrinsics, frame.mediaPath, frame.hasIntrinsics);
+      case EImageType::GRAY_UCHAR: return _feeder.readImage(frame.imageUChar, frame.intrinsics, frame.mediaPath, frame.hasIntrinsics);
+    }
+    return false;
+  }
+
+  void run()
+  {
+    unsigned int frameIndex = _firstFrame;
+    bool isValid = true;
+
+    if(!_isLiveFeed)
+      _feeder.goToFrame(frameIndex);
+
+    for(std::size_t k = 1; isValid; ++k)
+    {
+      // wait for a free frame of the ring buffer
+      std::size_t slot = 0;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this]{ return _stop || _count < _frames.size(); });
+        if(_stop)
+          return;
+        slot = (_head + _count) % _frames.size();
+      }
+
+      // decode outside of the lock, the frame is not visible to the consumer
+      Frame& frame = _frames[slot];
+      frame.frame = frameIndex;
+      try
+      {
+        frame.isValid = decode(frame);
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Cannot decode the frame " << frameIndex << ": " << e.what());
+        frame.isValid = false;
+      }
+      isValid = frame.isValid;
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_count;
+        if(!isValid)
+          _endFrame = frameIndex;
+      }
+      _condition.notify_all();
+
+      // go to the next frame of the step
+      const unsigned int nextFrameIndex = _firstFrame + static_cast<unsigned int>(std::floor(k * _frameStep));
+      if(isValid && nextFrameIndex != frameIndex)
+      {
+        if(nextFrameIndex == frameIndex + 1 || _isLiveFeed)
+          _feeder.goToNextFrame();
+        else
+          _feeder.goToFrame(nextFrameIndex);
+      }
+      frameIndex = nextFrameIndex;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _isDone = true;
+    }
+    _condition.notify_all();
+  }
+
+  IFeed& _feeder;
+  const EImageType _imageType;
+  const double _frameStep;
+  const unsigned int _firstFrame;
+  const bool _isLiveFeed;
+
+  /// ring buffer of decoded frames, _count frames from _head
+  std::vector<Frame> _frames;
+  std::size_t _head = 0;
+  std::size_t _count = 0;
+  /// first frame that cannot be read
+  unsigned int _endFrame = std::numeric_limits<unsigned int>::max();
+
+  bool _stop = false;
+  bool _isDone = false;
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  std::thread _thread;
+};
+
 FeedProvider::FeedProvider(const std::string &feedPath, const std::string &calibPath) 
 : _isVideo(false), _isLiveFeed(false)
 {
@@ -73,12 +295,36 @@ FeedProvider::FeedProvider(const std::string &feedPath, const std::string &calib
   }
 }
 
+template<typename T>
+bool FeedProvider::readFrame(image::Image<T> &image,
+      camera::PinholeRadialK3 &camIntrinsics,
+      std::string &mediaPath,
+      bool &hasIntrinsics)
+{
+  if(_readAhead == 0)
+    return _feeder->readImage(image, camIntrinsics, mediaPath, hasIntrinsics);
+
+  bool isDecoded = false;
+
+  if(_asyncReader != nullptr && _asyncReader->getImageType() == AsyncReader::getImageType(image))
+  {
+    const bool isValid = _asyncReader->read(_frame, image, camIntrinsics, mediaPath, hasIntrinsics, isDecoded);
+    if(isDecoded)
+      return isValid;
+  }
+
+  // start decoding from the current frame
+  _asyncReader.reset();
+  _asyncReader.reset(new AsyncReader(*_feeder, AsyncReader::getImageType(image), _readAhead, _frameStep, _frame, _isLiveFeed));
+  return _asyncReader->read(_frame, image, camIntrinsics, mediaPath, hasIntrinsics, isDecoded);
+}
+
 bool FeedProvider::readImage(image::Image<image::RGBColor> &imageRGB,
       camera::PinholeRadialK3 &camIntrinsics,
       std::string &mediaPath,
       bool &hasIntrinsics)
 {
-  return(_feeder->readImage(imageRGB, camIntrinsics, mediaPath, hasIntrinsics));
+  return readFrame(imageRGB, camIntrinsics, mediaPath, hasIntrinsics);
 }
 
 bool FeedProvider::readImage(image::Image<float> &imageGray,
@@ -86,7 +332,7 @@ bool FeedProvider::readImage(image::Image<float> &imageGray,
       std::string &mediaPath,
       bool &hasIntrinsics)
 {
-  return(_feeder->readImage(imageGray, camIntrinsics, mediaPath, hasIntrinsics));
+  return readFrame(imageGray, camIntrinsics, mediaPath, hasIntrinsics);
 }
 
 bool FeedProvider::readImage(image::Image<unsigned char> &imageGray,
@@ -94,7 +340,7 @@ bool FeedProvider::readImage(image::Image<unsigned char> &imageGray,
       std::string &mediaPath,
       bool &hasIntrinsics)
 {
-  return(_feeder->readImage(imageGray, camIntrinsics, mediaPath, hasIntrinsics));
+  return readFrame(imageGray, camIntrinsics, mediaPath, hasIntrinsics);
 }
   
 std::size_t FeedProvider::nbFrames() const
@@ -107,20 +353,43 @@ std::size_t FeedProvider::nbFrames() const
 
 bool FeedProvider::goToFrame(const unsigned int frame)
 {
+  _frame = _isLiveFeed ? _frame + 1 : frame;
+
+  // the background thread seeks
+  if(_readAhead > 0)
+    return _isLiveFeed || _frame < nbFrames();
+
   return _feeder->goToFrame(frame);
 }
 
 bool FeedProvider::goToNextFrame()
 {
+  ++_frame;
+
+  if(_readAhead > 0)
+    return _isLiveFeed || _frame < nbFrames();
+
   return _feeder->goToNextFrame();
 }
 
+void FeedProvider::setReadAhead(std::size_t readAhead, double frameStep)
+{
+  _asyncReader.reset();
+
+  // the feed is left on the last decoded frame
+  if(_readAhead > 0 && readAhead == 0 && !_isLiveFeed)
+    _feeder->goToFrame(_frame);
+
+  _readAhead = readAhead;
+  _frameStep = std::max(1.0, frameStep);
+}
+
 bool FeedProvider::isInit() const
 {
   return(_feeder->isInit());
 }
 
-FeedProvider::~FeedProvider( ) { }
+FeedProvider::~FeedProvider( ) = default;
 
 }//namespace dataio 
 }//namespace aliceVision
@@ -109,13 +109,47 @@ public:
    */    
   bool isLiveFeed() const {return _isLiveFeed; }
 
+  /**
+   * @brief Enable the asynchronous mode: the next frames are decoded in advance
+   * on a background thread, into a ring buffer of frames.
+   * readImage hands over the decoded frame by swapping it with the given image,
+   * whose buffer is reused to decode a next frame.
+   * The frames are decoded in the order: first frame, then first frame + floor(k * frameStep),
+   * reading another frame (goToFrame) restarts the decoding from this frame.
+   *
+   * @param[in] readAhead The number of frames decoded in advance (0 disables the asynchronous mode).
+   * @param[in] frameStep The expected step between two frames read.
+   */
+  void setReadAhead(std::size_t readAhead, double frameStep = 1.0);
+
+  /**
+   * @brief Return the number of frames decoded in advance (0 if the asynchronous mode is disabled).
+   */
+  std::size_t getReadAhead() const {return _readAhead; }
+
   virtual ~FeedProvider();
     
 private:
+  class AsyncReader;
+
+  template<typename T>
+  bool readFrame(image::Image<T> &image,
+        camera::PinholeRadialK3 &camIntrinsics,
+        std::string &mediaPath,
+        bool &hasIntrinsics);
+
   std::unique_ptr<IFeed> _feeder;
   bool _isVideo;
   bool _isLiveFeed;
 
+  /// number of frames decoded in advance (0 = synchronous mode)
+  std::size_t _readAhead = 0;
+  /// expected step between two frames read
+  double _frameStep = 1.0;
+  /// current frame (asynchronous mode)
+  unsigned int _frame = 0;
+  /// background decoding (asynchronous mode)
+  std::unique_ptr<AsyncReader> _asyncReader;
 };
 
 }//namespace dataio 
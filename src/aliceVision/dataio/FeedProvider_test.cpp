@@ -0,0 +1,269 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/dataio/FeedProvider.hpp>
+#include <aliceVision/image/all.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE FeedProvider
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+
+const int nbFrames = 12;
+const int width = 16;
+const int height = 8;
+
+/**
+ * @brief Write a folder of images, the pixels of the frame i are equal to 10 * i
+ */
+fs::path writeImageFolder()
+{
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(folder);
+
+  for(int i = 0; i < nbFrames; ++i)
+  {
+    const image::Image<unsigned char> frame(width, height, true, static_cast<unsigned char>(10 * i));
+    image::writeImage((folder / ("frame_" + std::to_string(100 + i) + ".png")).string(), frame);
+  }
+  return folder;
+}
+
+/// pixel value in [0, 255]
+inline float pixelValue(unsigned char value) { return value; }
+inline float pixelValue(float value) { return 255.0f * value; }
+inline float pixelValue(const image::RGBColor& value) { return value.r(); }
+
+/**
+ * @brief Read the current frame of the feed
+ * @return the index of the frame, -1 if there is no frame
+ */
+template<typename T>
+int readFrameIndex(dataio::FeedProvider& feed, std::string& mediaPath)
+{
+  image::Image<T> frame;
+  camera::PinholeRadialK3 intrinsics;
+  bool hasIntrinsics = false;
+
+  if(!feed.readImage(frame, intrinsics, mediaPath, hasIntrinsics))
+    return -1;
+
+  BOOST_CHECK_EQUAL(frame.Width(), width);
+  BOOST_CHECK_EQUAL(frame.Height(), height);
+  BOOST_CHECK(!hasIntrinsics);
+  return static_cast<int>(std::round(pixelValue(frame(height - 1, width - 1)) / 10.0f));
+}
+
+int readFrameIndex(dataio::FeedProvider& feed)
+{
+  std::string mediaPath;
+  const int frameIndex = readFrameIndex<unsigned char>(feed, mediaPath);
+  if(frameIndex >= 0)
+    BOOST_CHECK_EQUAL(fs::path(mediaPath).filename().string(), "frame_" + std::to_string(100 + frameIndex) + ".png");
+  return frameIndex;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Read a folder of images without and with read-ahead
+// - Assert that the read-ahead gives the same frames, in order, for several ring buffer sizes
+// - Assert that the end of the feed is reported by goToNextFrame and readImage
+//-----------------
+BOOST_AUTO_TEST_CASE(FeedProvider_readAhead)
+{
+  const fs::path folder = writeImageFolder();
+
+  // synchronous reading
+  std::vector<int> expected;
+  {
+    dataio::FeedProvider feed(folder.string());
+    BOOST_REQUIRE(feed.isInit());
+    BOOST_REQUIRE_EQUAL(feed.nbFrames(), nbFrames);
+    BOOST_CHECK_EQUAL(feed.getReadAhead(), 0);
+
+    bool hasNext = true;
+    while(hasNext)
+    {
+      expected.push_back(readFrameIndex(feed));
+      hasNext = feed.goToNextFrame();
+    }
+  }
+  BOOST_REQUIRE_EQUAL(expected.size(), nbFrames);
+  for(int i = 0; i < nbFrames; ++i)
+    BOOST_CHECK_EQUAL(expected[i], i);
+
+  for(const std::size_t readAhead : {1, 3, 64})
+  {
+    dataio::FeedProvider feed(folder.string());
+    feed.setReadAhead(readAhead);
+    BOOST_CHECK_EQUAL(feed.getReadAhead(), readAhead);
+
+    std::vector<int> frames;
+    bool hasNext = true;
+    while(hasNext)
+    {
+      frames.push_back(readFrameIndex(feed));
+      hasNext = feed.goToNextFrame();
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(frames.begin(), frames.end(), expected.begin(), expected.end());
+
+    // end of the feed
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), -1);
+    BOOST_CHECK(!feed.goToNextFrame());
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), -1);
+  }
+
+  fs::remove_all(folder);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Read every frameStep frame of a folder of images, with integer and fractional steps
+// - Assert that the read-ahead decodes the frames of the step, as the synchronous reading with goToFrame
+// - Assert that a frame out of the step is still given, by restarting the reader
+//-----------------
+BOOST_AUTO_TEST_CASE(FeedProvider_readAheadFrameStep)
+{
+  const fs::path folder = writeImageFolder();
+
+  for(const double frameStep : {2.0, 2.5, 5.0})
+  {
+    std::vector<int> expected;
+    std::vector<int> frames;
+    for(int k = 0; std::floor(k * frameStep) < nbFrames; ++k)
+      expected.push_back(static_cast<int>(std::floor(k * frameStep)));
+
+    dataio::FeedProvider feed(folder.string());
+    feed.setReadAhead(2, frameStep);
+    for(const int frameIndex : expected)
+    {
+      BOOST_CHECK(feed.goToFrame(frameIndex));
+      frames.push_back(readFrameIndex(feed));
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(frames.begin(), frames.end(), expected.begin(), expected.end());
+    BOOST_CHECK(!feed.goToFrame(nbFrames));
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), -1);
+
+    // frame between two frames of the step
+    feed.goToFrame(3);
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 3);
+    feed.goToFrame(static_cast<unsigned int>(3 + std::floor(frameStep)));
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), static_cast<int>(3 + std::floor(frameStep)));
+  }
+
+  fs::remove_all(folder);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Seek forward, backward and after the end of the feed while reading ahead
+// - Read the frames with another image type
+// - Assert that the reader restarts from the sought frame and gives the right frames
+//-----------------
+BOOST_AUTO_TEST_CASE(FeedProvider_readAheadSeek)
+{
+  const fs::path folder = writeImageFolder();
+
+  dataio::FeedProvider feed(folder.string());
+  feed.setReadAhead(3);
+
+  for(int i = 0; i < 4; ++i)
+  {
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), i);
+    feed.goToNextFrame();
+  }
+
+  // forward, beyond the ring buffer
+  BOOST_CHECK(feed.goToFrame(9));
+  BOOST_CHECK_EQUAL(readFrameIndex(feed), 9);
+
+  // backward
+  BOOST_CHECK(feed.goToFrame(2));
+  BOOST_CHECK_EQUAL(readFrameIndex(feed), 2);
+  BOOST_CHECK(feed.goToNextFrame());
+  BOOST_CHECK_EQUAL(readFrameIndex(feed), 3);
+
+  // same frame read twice
+  BOOST_CHECK_EQUAL(readFrameIndex(feed), 3);
+
+  // after the end of the feed, then back to the first frame
+  BOOST_CHECK(!feed.goToFrame(nbFrames + 2));
+  BOOST_CHECK_EQUAL(readFrameIndex(feed), -1);
+  BOOST_CHECK(feed.goToFrame(0));
+  BOOST_CHECK_EQUAL(readFrameIndex(feed), 0);
+
+  // another image type
+  BOOST_CHECK(feed.goToNextFrame());
+  std::string mediaPath;
+  BOOST_CHECK_EQUAL(readFrameIndex<float>(feed, mediaPath), 1);
+  BOOST_CHECK(feed.goToNextFrame());
+  BOOST_CHECK_EQUAL(readFrameIndex<image::RGBColor>(feed, mediaPath), 2);
+  BOOST_CHECK(feed.goToNextFrame());
+  BOOST_CHECK_EQUAL(readFrameIndex(feed), 3);
+
+  fs::remove_all(folder);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Stop reading ahead while the ring buffer is full, then read synchronously
+// - Assert that the synchronous reading continues from the current frame
+// - Destroy feeds whose reader is waiting for a free frame or is done
+//-----------------
+BOOST_AUTO_TEST_CASE(FeedProvider_readAheadStop)
+{
+  const fs::path folder = writeImageFolder();
+
+  {
+    dataio::FeedProvider feed(folder.string());
+    feed.setReadAhead(2);
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 0);
+    feed.goToNextFrame();
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 1);
+    feed.goToNextFrame();
+
+    feed.setReadAhead(0);
+    BOOST_CHECK_EQUAL(feed.getReadAhead(), 0);
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 2);
+    BOOST_CHECK(feed.goToNextFrame());
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 3);
+
+    // restart reading ahead from the current frame
+    feed.setReadAhead(4);
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 3);
+    feed.goToNextFrame();
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 4);
+  }
+
+  // reader waiting for a free frame of the ring buffer
+  {
+    dataio::FeedProvider feed(folder.string());
+    feed.setReadAhead(1);
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), 0);
+  }
+
+  // reader done with the feed
+  {
+    dataio::FeedProvider feed(folder.string());
+    feed.setReadAhead(2 * nbFrames);
+    feed.goToFrame(nbFrames - 1);
+    BOOST_CHECK_EQUAL(readFrameIndex(feed), nbFrames - 1);
+  }
+
+  fs::remove_all(folder);
+}
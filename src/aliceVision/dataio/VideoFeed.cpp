@@ -59,6 +59,8 @@ private:
   std::string _videoPath;
   cv::VideoCapture _videoCapture;
   camera::PinholeRadialK3 _camIntrinsics;
+  /// grayscale frame buffer for the float images
+  image::Image<unsigned char> _imageGrayUChar;
 };
 
 
@@ -119,21 +121,10 @@ bool VideoFeed::FeederImpl::readImage(image::Image<image::RGBColor> &imageRGB,
   
   if(frame.channels() == 3)
   {
-    cv::Mat color;
-    resize(frame, color, cv::Size(frame.cols, frame.rows));
-    
+    // convert in the image buffer, reused if the frame size does not change
+    imageRGB.resize(frame.cols, frame.rows, false);
+    cv::Mat color(frame.rows, frame.cols, CV_8UC3, imageRGB.data());
     cv::cvtColor(frame, color, cv::COLOR_BGR2RGB);
-    imageRGB.resize(color.cols, color.rows);
-    
-    unsigned char* pixelPtr = (unsigned char*)color.data;
-    for(int i = 0; i < color.rows; i++)
-    {
-      for(int j = 0; j < color.cols; j++)
-      {
-        const size_t index = i*color.cols*3 + j*3;
-        imageRGB(i,j) = image::RGBColor(pixelPtr[index], pixelPtr[index + 1], pixelPtr[index + 2]);
-      }
-    }
   }
   else
   {
@@ -154,10 +145,10 @@ bool VideoFeed::FeederImpl::readImage(image::Image<float> &imageGray,
           std::string &mediaPath,
           bool &hasIntrinsics)
 {
-  image::Image<unsigned char> imageGrayUChar;
-  if(FeederImpl::readImage(imageGrayUChar, camIntrinsics, mediaPath, hasIntrinsics))
+  if(FeederImpl::readImage(_imageGrayUChar, camIntrinsics, mediaPath, hasIntrinsics))
   {
-    imageGray = (imageGrayUChar.GetMat().cast<float>() / 255.f);
+    imageGray.resize(_imageGrayUChar.Width(), _imageGrayUChar.Height(), false);
+    imageGray.array() = _imageGrayUChar.array().cast<float>() / 255.f;
     return true;
   }
   return false;
@@ -179,11 +170,10 @@ bool VideoFeed::FeederImpl::readImage(image::Image<unsigned char> &imageGray,
   
   if(frame.channels() == 3)
   {
-    // convert to gray
-    cv::Mat grey;
+    // convert to gray in the image buffer, reused if the frame size does not change
+    imageGray.resize(frame.cols, frame.rows, false);
+    cv::Mat grey(frame.rows, frame.cols, CV_8UC1, imageGray.data());
     cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);
-    imageGray.resize(grey.cols, grey.rows);
-    cv::cv2eigen(grey, imageGray);
 //      ALICEVISION_LOG_DEBUG(grey.channels() << " " << grey.rows << " " << grey.cols);
 //      ALICEVISION_LOG_DEBUG(imageGray.Depth() << " " << imageGray.Height() << " " << imageGray.Width());
   }
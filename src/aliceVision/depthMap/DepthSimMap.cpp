@@ -8,6 +8,7 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/mvsUtils/depthSimMapStorage.hpp>
 #include <aliceVision/mvsData/Color.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
@@ -409,8 +410,8 @@ void DepthSimMap::save(int rc, const StaticVector<int>& tcams)
         metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, matrixP.data()));
     }
 
-    imageIO::writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap->getDataWritable(), imageIO::EImageQuality::LOSSLESS, metadata);
-    imageIO::writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale), width, height, simMap->getDataWritable());
+    mvsUtils::writeDepthSimMaps(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale),
+                                width, height, depthMap->getData(), simMap->getData(), metadata, mvsUtils::getDepthMapStorage(mp));
 
     {
         // TODO: write max & min depth in depth maps metadata.
@@ -429,7 +430,7 @@ void DepthSimMap::load(int rc, int fromScale)
     StaticVector<float> simMap;
 
     imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, fromScale), width, height, depthMap.getDataWritable());
-    imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, fromScale), width, height, simMap.getDataWritable());
+    mvsUtils::readSimMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, fromScale), width, height, simMap.getDataWritable());
 
     imageIO::transposeImage(width, height, depthMap.getDataWritable());
     imageIO::transposeImage(width, height, simMap.getDataWritable());
@@ -462,8 +463,7 @@ void DepthSimMap::saveRefine(int rc, std::string depthMapFileName, std::string s
         metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, matrixP.data()));
     }
 
-    imageIO::writeImage(depthMapFileName, width, height, depthMap, imageIO::EImageQuality::LOSSLESS, metadata);
-    imageIO::writeImage(simMapFileName, width, height, simMap);
+    mvsUtils::writeDepthSimMaps(depthMapFileName, simMapFileName, width, height, depthMap, simMap, metadata, mvsUtils::getDepthMapStorage(mp));
 }
 
 float DepthSimMap::getCellSmoothStep(int rc, const int cellId)
@@ -0,0 +1,651 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PatchMatchRc.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/mvsData/Color.hpp>
+#include <aliceVision/mvsData/Point2d.hpp>
+#include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+
+namespace aliceVision {
+namespace depthMap {
+
+/// cost of the hypotheses which cannot be scored
+static const float maxCost = 2.0f;
+/// minimum weighted variance of a patch (in squared gray levels) to compute a similarity
+static const double minPatchVariance = 1.0;
+
+/// propagation neighbours, all at an odd distance so they have the other checkerboard color
+static const int propagationNeighbours[8][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-5, 0}, {5, 0}, {0, -5}, {0, 5}};
+
+/**
+ * @brief Random generator of a pixel at an iteration (splitmix64),
+ * so that the random hypotheses do not depend on the threads.
+ */
+class PixelRandom
+{
+public:
+    PixelRandom(int pixel, int iteration)
+        : _state((static_cast<std::uint64_t>(pixel) << 20) ^ static_cast<std::uint64_t>(iteration))
+    {}
+
+    /// uniform in [0, 1[
+    float uniform()
+    {
+        std::uint64_t z = (_state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return static_cast<float>(z >> 40) * (1.0f / 16777216.0f);
+    }
+
+    /// uniform on the unit sphere
+    Point3d unitVector()
+    {
+        const double z = 2.0 * uniform() - 1.0;
+        const double phi = 2.0 * M_PI * uniform();
+        const double r = std::sqrt(std::max(0.0, 1.0 - z * z));
+        return Point3d(r * std::cos(phi), r * std::sin(phi), z);
+    }
+
+private:
+    std::uint64_t _state;
+};
+
+/// flip a normal so that the plane faces the camera
+static inline Point3d faceRay(const Point3d& normal, const Point3d& ray)
+{
+    return (dot(normal, ray) > 0.0) ? -normal : normal;
+}
+
+static inline Point3d getRay(const Matrix3x3& iCam, int x, int y)
+{
+    return (iCam * Point2d(x, y)).normalize();
+}
+
+void PatchMatchParams::readUserParams(const boost::property_tree::ptree& userParams)
+{
+    wsh = userParams.get<int>("patchMatch.wsh", wsh);
+    windowStep = std::max(1, userParams.get<int>("patchMatch.windowStep", windowStep));
+    gammaC = static_cast<float>(userParams.get<double>("patchMatch.gammaC", gammaC));
+    gammaP = static_cast<float>(userParams.get<double>("patchMatch.gammaP", gammaP));
+    nbBestViews = std::max(1, userParams.get<int>("patchMatch.nbBestViews", nbBestViews));
+    nbScales = std::max(1, userParams.get<int>("patchMatch.nbScales", nbScales));
+    nbIterations = userParams.get<int>("patchMatch.nbIterations", nbIterations);
+    maxSim = static_cast<float>(userParams.get<double>("patchMatch.maxSim", maxSim));
+}
+
+PatchMatchRc::PatchMatchRc(const PatchMatchView& rcView, const std::vector<PatchMatchView>& tcViews,
+                           const PatchMatchParams& params)
+    : _rcView(rcView)
+    , _tcViews(tcViews)
+    , _params(params)
+{
+    for(int dy = -_params.wsh; dy <= _params.wsh; dy += _params.windowStep)
+    {
+        for(int dx = -_params.wsh; dx <= _params.wsh; dx += _params.windowStep)
+        {
+            _patchOffsetsX.push_back(dx);
+            _patchOffsetsY.push_back(dy);
+            _patchDistWeights.push_back(std::exp(-std::sqrt(static_cast<float>(dx * dx + dy * dy)) / _params.gammaP));
+        }
+    }
+}
+
+static void downscaleImage(const std::vector<float>& in, int inWidth, int inHeight, std::vector<float>& out, int& outWidth, int& outHeight)
+{
+    outWidth = std::max(1, inWidth / 2);
+    outHeight = std::max(1, inHeight / 2);
+    out.resize(outWidth * outHeight);
+
+    for(int y = 0; y < outHeight; ++y)
+    {
+        const int y0 = std::min(2 * y, inHeight - 1);
+        const int y1 = std::min(2 * y + 1, inHeight - 1);
+        for(int x = 0; x < outWidth; ++x)
+        {
+            const int x0 = std::min(2 * x, inWidth - 1);
+            const int x1 = std::min(2 * x + 1, inWidth - 1);
+            out[y * outWidth + x] = 0.25f * (in[y0 * inWidth + x0] + in[y0 * inWidth + x1] +
+                                             in[y1 * inWidth + x0] + in[y1 * inWidth + x1]);
+        }
+    }
+}
+
+void PatchMatchRc::buildScales()
+{
+    // the coarsest rc image keeps at least 32 pixels in each dimension
+    int nbScales = 1;
+    while(nbScales < _params.nbScales && (std::min(_rcView.width, _rcView.height) >> nbScales) >= 32)
+        ++nbScales;
+
+    _scales.clear();
+    _scales.resize(nbScales);
+
+    for(int s = 0; s < nbScales; ++s)
+    {
+        Scale& scale = _scales[s];
+        scale.tcImages.resize(_tcViews.size());
+        scale.tcP.resize(_tcViews.size());
+        scale.tcRcCenter.resize(_tcViews.size());
+
+        if(s == 0)
+        {
+            scale.rcImage.width = _rcView.width;
+            scale.rcImage.height = _rcView.height;
+            scale.rcImage.data = _rcView.gray;
+            for(std::size_t t = 0; t < _tcViews.size(); ++t)
+            {
+                scale.tcImages[t].width = _tcViews[t].width;
+                scale.tcImages[t].height = _tcViews[t].height;
+                scale.tcImages[t].data = _tcViews[t].gray;
+            }
+        }
+        else
+        {
+            const Scale& previous = _scales[s - 1];
+            downscaleImage(previous.rcImage.data, previous.rcImage.width, previous.rcImage.height,
+                           scale.rcImage.data, scale.rcImage.width, scale.rcImage.height);
+            for(std::size_t t = 0; t < _tcViews.size(); ++t)
+                downscaleImage(previous.tcImages[t].data, previous.tcImages[t].width, previous.tcImages[t].height,
+                               scale.tcImages[t].data, scale.tcImages[t].width, scale.tcImages[t].height);
+        }
+
+        // the pixel x at this scale is the center of the pixels [f * x, f * (x + 1)[ of the process resolution
+        const double f = static_cast<double>(1 << s);
+        const double o = 0.5 * (f - 1.0);
+
+        Matrix3x3 toProcess;
+        toProcess.m11 = f;
+        toProcess.m13 = o;
+        toProcess.m22 = f;
+        toProcess.m23 = o;
+        toProcess.m33 = 1.0;
+
+        Matrix3x3 fromProcess;
+        fromProcess.m11 = 1.0 / f;
+        fromProcess.m13 = -o / f;
+        fromProcess.m22 = 1.0 / f;
+        fromProcess.m23 = -o / f;
+        fromProcess.m33 = 1.0;
+
+        scale.rcICam = _rcView.iCam * toProcess;
+        scale.rcP = fromProcess * _rcView.P;
+        for(std::size_t t = 0; t < _tcViews.size(); ++t)
+        {
+            scale.tcP[t] = fromProcess * _tcViews[t].P;
+            scale.tcRcCenter[t] = scale.tcP[t] * _rcView.C;
+        }
+    }
+}
+
+void PatchMatchRc::computePatch(const Scale& scale, int x, int y, Patch& patch) const
+{
+    const Image& image = scale.rcImage;
+    const float center = image.data[y * image.width + x];
+    const int nbSamples = _patchOffsetsX.size();
+
+    patch.values.resize(nbSamples);
+    patch.weights.resize(nbSamples);
+
+    double sumWeights = 0.0;
+    double sumValues = 0.0;
+    for(int i = 0; i < nbSamples; ++i)
+    {
+        const int qx = x + _patchOffsetsX[i];
+        const int qy = y + _patchOffsetsY[i];
+        if(qx < 0 || qy < 0 || qx >= image.width || qy >= image.height)
+        {
+            patch.values[i] = 0.0f;
+            patch.weights[i] = 0.0f;
+            continue;
+        }
+        const float value = image.data[qy * image.width + qx];
+        const float weight = _patchDistWeights[i] * std::exp(-std::abs(value - center) / _params.gammaC);
+        patch.values[i] = value;
+        patch.weights[i] = weight;
+        sumWeights += weight;
+        sumValues += weight * value;
+    }
+
+    const float mean = static_cast<float>(sumValues / sumWeights);
+    double variance = 0.0;
+    for(int i = 0; i < nbSamples; ++i)
+    {
+        if(patch.weights[i] == 0.0f)
+            continue;
+        patch.values[i] -= mean;
+        variance += patch.weights[i] * patch.values[i] * patch.values[i];
+    }
+
+    patch.sumWeights = static_cast<float>(sumWeights);
+    patch.textured = (variance / sumWeights) >= minPatchVariance;
+}
+
+float PatchMatchRc::computeCost(const Scale& scale, const Patch& patch, int x, int y, float depth,
+                                const Point3d& normal, std::vector<float>& tcCosts) const
+{
+    const Point3d ray = getRay(scale.rcICam, x, y);
+    // signed distance of rc center to the plane, negative if the plane faces rc
+    const double dn = depth * dot(normal, ray);
+    if(depth <= 0.0f || dn >= 0.0)
+        return maxCost;
+
+    const int nbSamples = patch.values.size();
+
+    for(std::size_t t = 0; t < scale.tcImages.size(); ++t)
+    {
+        const Image& image = scale.tcImages[t];
+        const Matrix3x4& P = scale.tcP[t];
+        const Point3d& c = scale.tcRcCenter[t];
+
+        // homography of the plane from rc to tc, -((P * C) * n^T + dn * P3x3) * iCam:
+        // the sign makes the last coordinate positive in front of the cameras
+        Matrix3x3 M;
+        M.m11 = -(c.x * normal.x + dn * P.m11);
+        M.m12 = -(c.x * normal.y + dn * P.m12);
+        M.m13 = -(c.x * normal.z + dn * P.m13);
+        M.m21 = -(c.y * normal.x + dn * P.m21);
+        M.m22 = -(c.y * normal.y + dn * P.m22);
+        M.m23 = -(c.y * normal.z + dn * P.m23);
+        M.m31 = -(c.z * normal.x + dn * P.m31);
+        M.m32 = -(c.z * normal.y + dn * P.m32);
+        M.m33 = -(c.z * normal.z + dn * P.m33);
+        const Matrix3x3 H = M * scale.rcICam;
+
+        double sw = 0.0, sa = 0.0, sb = 0.0, saa = 0.0, sbb = 0.0, sab = 0.0;
+        for(int i = 0; i < nbSamples; ++i)
+        {
+            const float weight = patch.weights[i];
+            if(weight == 0.0f)
+                continue;
+
+            const double qx = x + _patchOffsetsX[i];
+            const double qy = y + _patchOffsetsY[i];
+            const double hz = H.m31 * qx + H.m32 * qy + H.m33;
+            if(hz <= 0.0)
+                continue;
+            const double u = (H.m11 * qx + H.m12 * qy + H.m13) / hz;
+            const double v = (H.m21 * qx + H.m22 * qy + H.m23) / hz;
+            if(!(u >= 0.0 && v >= 0.0 && u < image.width - 1 && v < image.height - 1))
+                continue;
+
+            // bilinear interpolation
+            const int u0 = static_cast<int>(u);
+            const int v0 = static_cast<int>(v);
+            const float fu = static_cast<float>(u - u0);
+            const float fv = static_cast<float>(v - v0);
+            const float* p = &image.data[v0 * image.width + u0];
+            const float b = (p[0] + (p[1] - p[0]) * fu) * (1.0f - fv) +
+                            (p[image.width] + (p[image.width + 1] - p[image.width]) * fu) * fv;
+            const float a = patch.values[i];
+
+            sw += weight;
+            sa += weight * a;
+            sb += weight * b;
+            saa += weight * a * a;
+            sbb += weight * b * b;
+            sab += weight * a * b;
+        }
+
+        float cost = maxCost;
+        // at least half of the patch must be seen in tc
+        if(sw >= 0.5 * patch.sumWeights)
+        {
+            const double ma = sa / sw;
+            const double mb = sb / sw;
+            const double va = saa / sw - ma * ma;
+            const double vb = sbb / sw - mb * mb;
+            if(va >= minPatchVariance && vb >= minPatchVariance)
+            {
+                const double ncc = (sab / sw - ma * mb) / std::sqrt(va * vb);
+                cost = static_cast<float>(std::min(2.0, std::max(0.0, 1.0 - ncc)));
+            }
+        }
+        tcCosts[t] = cost;
+    }
+
+    // average of the best tc costs, so that occlusions in some tc are not penalized
+    const int nbBest = std::min(static_cast<int>(tcCosts.size()), _params.nbBestViews);
+    std::partial_sort(tcCosts.begin(), tcCosts.begin() + nbBest, tcCosts.end());
+    float sum = 0.0f;
+    for(int i = 0; i < nbBest; ++i)
+        sum += tcCosts[i];
+    return sum / nbBest;
+}
+
+bool PatchMatchRc::transferPlane(const Point3d& fromRay, float fromDepth, const Point3d& normal, const Point3d& ray,
+                                 float& out_depth) const
+{
+    const double den = dot(normal, ray);
+    if(den > -1e-3)
+        return false;
+    out_depth = static_cast<float>(fromDepth * dot(normal, fromRay) / den);
+    return (out_depth >= 0.5f * _minDepth) && (out_depth <= 2.0f * _maxDepth);
+}
+
+void PatchMatchRc::computeAllCosts(const Scale& scale)
+{
+    const int width = scale.rcImage.width;
+    const int height = scale.rcImage.height;
+
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        Patch patch;
+        std::vector<float> tcCosts(_tcViews.size());
+        for(int x = 0; x < width; ++x)
+        {
+            const int i = y * width + x;
+            computePatch(scale, x, y, patch);
+            _costs[i] = patch.textured ? computeCost(scale, patch, x, y, _depths[i], _normals[i], tcCosts) : maxCost;
+        }
+    }
+}
+
+void PatchMatchRc::initializeCoarsestScale(const std::vector<Point3d>& seeds)
+{
+    const Scale& scale = _scales.back();
+    const int width = scale.rcImage.width;
+    const int height = scale.rcImage.height;
+
+    _depths.resize(width * height);
+    _normals.resize(width * height);
+    _costs.resize(width * height);
+
+    // random hypotheses, uniform in inverse depth
+    const float minInvDepth = 1.0f / _maxDepth;
+    const float maxInvDepth = 1.0f / _minDepth;
+
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            const int i = y * width + x;
+            PixelRandom random(i, -1);
+            _depths[i] = 1.0f / (minInvDepth + random.uniform() * (maxInvDepth - minInvDepth));
+            _normals[i] = faceRay(random.unitVector(), getRay(scale.rcICam, x, y));
+        }
+    }
+
+    computeAllCosts(scale);
+
+    // fronto-parallel hypotheses at the landmarks seen by rc
+    Patch patch;
+    std::vector<float> tcCosts(_tcViews.size());
+    int nbSeedsUsed = 0;
+    for(const Point3d& seed : seeds)
+    {
+        const Point3d p = scale.rcP * seed;
+        if(p.z <= 0.0)
+            continue;
+        const int x = static_cast<int>(std::floor(p.x / p.z + 0.5));
+        const int y = static_cast<int>(std::floor(p.y / p.z + 0.5));
+        if(x < 0 || y < 0 || x >= width || y >= height)
+            continue;
+
+        computePatch(scale, x, y, patch);
+        if(!patch.textured)
+            continue;
+
+        const int i = y * width + x;
+        const Point3d ray = getRay(scale.rcICam, x, y);
+        const float depth = static_cast<float>((seed - _rcView.C).size());
+        const float cost = computeCost(scale, patch, x, y, depth, -ray, tcCosts);
+        if(cost < _costs[i])
+        {
+            _depths[i] = depth;
+            _normals[i] = -ray;
+            _costs[i] = cost;
+            ++nbSeedsUsed;
+        }
+    }
+    ALICEVISION_LOG_DEBUG("PatchMatch: " << nbSeedsUsed << " / " << seeds.size() << " seeds used.");
+}
+
+void PatchMatchRc::upscaleHypotheses(int scaleIndex)
+{
+    const Scale& coarse = _scales[scaleIndex + 1];
+    const Scale& fine = _scales[scaleIndex];
+    const int coarseWidth = coarse.rcImage.width;
+    const int coarseHeight = coarse.rcImage.height;
+    const int width = fine.rcImage.width;
+    const int height = fine.rcImage.height;
+
+    std::vector<float> depths(width * height);
+    std::vector<Point3d> normals(width * height);
+
+    #pragma omp parallel for
+    for(int y = 0; y < height; ++y)
+    {
+        const int cy = std::min(y / 2, coarseHeight - 1);
+        for(int x = 0; x < width; ++x)
+        {
+            const int cx = std::min(x / 2, coarseWidth - 1);
+            const int i = y * width + x;
+            const int j = cy * coarseWidth + cx;
+
+            // the plane of the coarse pixel at the fine pixel
+            normals[i] = _normals[j];
+            if(!transferPlane(getRay(coarse.rcICam, cx, cy), _depths[j], _normals[j], getRay(fine.rcICam, x, y), depths[i]))
+                depths[i] = _depths[j];
+        }
+    }
+
+    _depths.swap(depths);
+    _normals.swap(normals);
+    _costs.resize(width * height);
+    computeAllCosts(fine);
+}
+
+void PatchMatchRc::iterate(int scaleIndex, int iteration)
+{
+    const Scale& scale = _scales[scaleIndex];
+    const int width = scale.rcImage.width;
+    const int height = scale.rcImage.height;
+    const bool isCoarsest = (scaleIndex == static_cast<int>(_scales.size()) - 1);
+    // relative amplitude of the refinement perturbations, decreasing with the iterations
+    const float perturbation = (isCoarsest ? 0.5f : 0.125f) / static_cast<float>(1 << std::min(iteration, 16));
+    const float minInvDepth = 1.0f / _maxDepth;
+    const float maxInvDepth = 1.0f / _minDepth;
+
+    // red-black checkerboard: the pixels of a color only read the hypotheses of the other color
+    for(int color = 0; color < 2; ++color)
+    {
+        #pragma omp parallel for
+        for(int y = 0; y < height; ++y)
+        {
+            Patch patch;
+            std::vector<float> tcCosts(_tcViews.size());
+            for(int x = (y + color) % 2; x < width; x += 2)
+            {
+                const int i = y * width + x;
+                computePatch(scale, x, y, patch);
+                if(!patch.textured)
+                    continue;
+
+                const Point3d ray = getRay(scale.rcICam, x, y);
+                float bestDepth = _depths[i];
+                Point3d bestNormal = _normals[i];
+                float bestCost = _costs[i];
+
+                const auto tryHypothesis = [&](float depth, const Point3d& normal)
+                {
+                    const float cost = computeCost(scale, patch, x, y, depth, normal, tcCosts);
+                    if(cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestDepth = depth;
+                        bestNormal = normal;
+                    }
+                };
+
+                // spatial propagation of the neighbours planes
+                for(const auto& neighbour : propagationNeighbours)
+                {
+                    const int qx = x + neighbour[0];
+                    const int qy = y + neighbour[1];
+                    if(qx < 0 || qy < 0 || qx >= width || qy >= height)
+                        continue;
+                    const int j = qy * width + qx;
+                    float depth;
+                    if(transferPlane(getRay(scale.rcICam, qx, qy), _depths[j], _normals[j], ray, depth))
+                        tryHypothesis(depth, _normals[j]);
+                }
+
+                // random refinement
+                PixelRandom random(i, (scaleIndex * 1024 + iteration) * 2 + color);
+                tryHypothesis(1.0f / (minInvDepth + random.uniform() * (maxInvDepth - minInvDepth)),
+                              faceRay(random.unitVector(), ray));
+
+                const float perturbedDepth = bestDepth * (1.0f + perturbation * (2.0f * random.uniform() - 1.0f));
+                const Point3d perturbedNormal = faceRay((bestNormal + random.unitVector() * perturbation).normalize(), ray);
+                const Point3d normal = bestNormal;
+                const float depth = bestDepth;
+                tryHypothesis(perturbedDepth, normal);
+                tryHypothesis(depth, perturbedNormal);
+                tryHypothesis(perturbedDepth, perturbedNormal);
+
+                _depths[i] = bestDepth;
+                _normals[i] = bestNormal;
+                _costs[i] = bestCost;
+            }
+        }
+    }
+}
+
+void PatchMatchRc::estimate(float minDepth, float maxDepth, const std::vector<Point3d>& seeds,
+                            std::vector<DepthSim>& out_depthSim)
+{
+    _minDepth = minDepth;
+    _maxDepth = maxDepth;
+
+    buildScales();
+    initializeCoarsestScale(seeds);
+
+    for(int s = static_cast<int>(_scales.size()) - 1; s >= 0; --s)
+    {
+        if(s != static_cast<int>(_scales.size()) - 1)
+            upscaleHypotheses(s);
+
+        for(int iteration = 0; iteration < _params.nbIterations; ++iteration)
+            iterate(s, iteration);
+    }
+
+    out_depthSim.assign(_depths.size(), DepthSim(-1.0f, 1.0f));
+    for(std::size_t i = 0; i < _depths.size(); ++i)
+    {
+        // sim is -NCC as in the other depth maps
+        const float sim = _costs[i] - 1.0f;
+        if(_costs[i] < maxCost && sim <= _params.maxSim)
+            out_depthSim[i] = DepthSim(_depths[i], sim);
+    }
+
+    _scales.clear();
+}
+
+/**
+ * @brief Get a grayscale view of a camera in [0, 255]
+ */
+static void loadPatchMatchView(const mvsUtils::MultiViewParams* mp, mvsUtils::ImagesCache& ic, int cam, PatchMatchView& view)
+{
+    const mvsUtils::ImagesCache::ImgPtr img = ic.getImg(cam);
+
+    view.width = img->getWidth();
+    view.height = img->getHeight();
+    view.gray.resize(view.width * view.height);
+    for(int y = 0; y < view.height; ++y)
+    {
+        for(int x = 0; x < view.width; ++x)
+        {
+            const Color& color = img->at(x, y);
+            view.gray[y * view.width + x] = (color.r + color.g + color.b) * (255.0f / 3.0f);
+        }
+    }
+
+    view.P = mp->camArr[cam];
+    view.iCam = mp->iCamArr[cam];
+    view.C = mp->CArr[cam];
+}
+
+void estimateDepthMapPatchMatch(int rc, mvsUtils::MultiViewParams* mp, mvsUtils::ImagesCache& ic, const PatchMatchParams& params)
+{
+    const long tall = clock();
+    const IndexT viewId = mp->getViewId(rc);
+
+    const int maxTCams = mp->userParams.get<int>("patchMatch.maxTCams", 6);
+    const StaticVector<int> tcams = mp->findNearestCamsFromLandmarks(rc, maxTCams);
+
+    DepthSimMap depthSimMap(rc, mp, 1, 1);
+
+    // generate default depthSimMap if rc has no tcam
+    if(tcams.empty())
+    {
+        depthSimMap.save(rc, StaticVector<int>());
+        return;
+    }
+
+    // the landmarks depths are distances to the camera plane, the hypotheses depths are along the pixels rays
+    float minDepth, maxDepth, midDepth;
+    std::size_t nbDepths;
+    mp->getMinMaxMidNbDepth(rc, minDepth, maxDepth, midDepth, nbDepths);
+    maxDepth *= 1.5f;
+    minDepth = std::max(0.8f * minDepth, 0.01f * maxDepth);
+
+    // SfM landmarks seen by rc
+    std::vector<Point3d> seeds;
+    seeds.reserve(nbDepths);
+    for(const auto& landmarkPair : mp->getInputSfMData().getLandmarks())
+    {
+        const sfmData::Landmark& landmark = landmarkPair.second;
+        if(landmark.observations.count(viewId))
+            seeds.push_back(Point3d(landmark.X(0), landmark.X(1), landmark.X(2)));
+    }
+
+    PatchMatchView rcView;
+    loadPatchMatchView(mp, ic, rc, rcView);
+    std::vector<PatchMatchView> tcViews(tcams.size());
+    for(int t = 0; t < tcams.size(); ++t)
+        loadPatchMatchView(mp, ic, tcams[t], tcViews[t]);
+
+    PatchMatchRc patchMatch(rcView, tcViews, params);
+    std::vector<DepthSim> depthSim;
+    patchMatch.estimate(minDepth, maxDepth, seeds, depthSim);
+
+    for(int i = 0; i < depthSimMap.dsm->size(); ++i)
+        (*depthSimMap.dsm)[i] = depthSim[i];
+
+    depthSimMap.save(rc, tcams);
+
+    mvsUtils::printfElapsedTime(tall, "PatchMatch: " + mvsUtils::num2str(rc) + " of " + mvsUtils::num2str(mp->ncams) + ", " + std::to_string(viewId) + " done.");
+}
+
+void estimateDepthMapsPatchMatch(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams)
+{
+    PatchMatchParams params;
+    params.readUserParams(mp->userParams);
+
+    const int bandType = 0;
+    mvsUtils::ImagesCache ic(mp, bandType);
+
+    for(const int rc : cams)
+    {
+        if(!mvsUtils::FileExists(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1)))
+            estimateDepthMapPatchMatch(rc, mp, ic, params);
+    }
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,177 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/depthMap/DepthSimMap.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+
+namespace mvsUtils {
+class ImagesCache;
+} // namespace mvsUtils
+
+namespace depthMap {
+
+/**
+ * @brief PatchMatch stereo parameters, read from the "patchMatch.*" user parameters
+ */
+struct PatchMatchParams
+{
+    /// half size of the patch used to compute the similarity
+    int wsh = 4;
+    /// step between the pixels of the patch
+    int windowStep = 2;
+    /// color difference attenuation of the patch pixels weights
+    float gammaC = 10.0f;
+    /// distance attenuation of the patch pixels weights
+    float gammaP = 8.0f;
+    /// number of neighbour cameras whose similarities are averaged for a pixel
+    int nbBestViews = 3;
+    /// number of scales of the coarse-to-fine estimation
+    int nbScales = 3;
+    /// number of propagation and refinement iterations at each scale
+    int nbIterations = 4;
+    /// pixels with a larger similarity (-NCC) are invalidated
+    float maxSim = -0.3f;
+
+    void readUserParams(const boost::property_tree::ptree& userParams);
+};
+
+/**
+ * @brief A view used by PatchMatchRc, at the process resolution
+ */
+struct PatchMatchView
+{
+    int width = 0;
+    int height = 0;
+    /// grayscale image, row major
+    std::vector<float> gray;
+    /// projection matrix
+    Matrix3x4 P;
+    /// inverse of K*R, gives the ray of a pixel
+    Matrix3x3 iCam;
+    /// camera center
+    Point3d C;
+};
+
+/**
+ * @brief PatchMatch stereo estimation of the depth map of a reference camera (rc) on the CPU.
+ *
+ * Each pixel holds a plane hypothesis (depth along the pixel ray and normal), scored by the
+ * bilateral weighted NCC of the patch warped by the plane homography in each neighbour camera (tc),
+ * averaging the best tc similarities. The hypotheses are improved by red-black checkerboard
+ * propagation and random refinement, so that all the pixels of a color can be processed in parallel
+ * and the result does not depend on the number of threads.
+ *
+ * The estimation is done coarse to fine: the coarsest scale is initialized with random hypotheses
+ * and the SfM landmarks seen by rc, and each scale is initialized with the planes of the previous one.
+ */
+class PatchMatchRc
+{
+public:
+    PatchMatchRc(const PatchMatchView& rcView, const std::vector<PatchMatchView>& tcViews, const PatchMatchParams& params);
+
+    /**
+     * @brief Estimate the depth and similarity of each pixel of rc
+     * @param[in] minDepth minimum depth of the random hypotheses
+     * @param[in] maxDepth maximum depth of the random hypotheses
+     * @param[in] seeds 3D points seen by rc
+     * @param[out] out_depthSim depth and similarity of each pixel (y * width + x), invalid pixels are (-1, 1)
+     */
+    void estimate(float minDepth, float maxDepth, const std::vector<Point3d>& seeds, std::vector<DepthSim>& out_depthSim);
+
+private:
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> data;
+    };
+
+    /// the images and cameras of a scale, in the pixel coordinates of the scale
+    struct Scale
+    {
+        Image rcImage;
+        std::vector<Image> tcImages;
+        Matrix3x3 rcICam;
+        Matrix3x4 rcP;
+        std::vector<Matrix3x4> tcP;
+        /// projection of the rc center in each tc
+        std::vector<Point3d> tcRcCenter;
+    };
+
+    /// rc patch of a pixel, with its weights and centered values
+    struct Patch
+    {
+        std::vector<float> values;
+        std::vector<float> weights;
+        float sumWeights = 0.0f;
+        bool textured = false;
+    };
+
+    void buildScales();
+    void initializeCoarsestScale(const std::vector<Point3d>& seeds);
+    void upscaleHypotheses(int scaleIndex);
+    void iterate(int scaleIndex, int iteration);
+    void computeAllCosts(const Scale& scale);
+    void computePatch(const Scale& scale, int x, int y, Patch& patch) const;
+
+    /**
+     * @brief Compute the cost (1 - NCC) of a plane hypothesis at a pixel
+     * @param[in,out] tcCosts buffer of the cost in each tc
+     */
+    float computeCost(const Scale& scale, const Patch& patch, int x, int y, float depth, const Point3d& normal,
+                      std::vector<float>& tcCosts) const;
+
+    /**
+     * @brief Get the depth along a ray of the plane of another ray
+     * @return false if the ray does not intersect the plane in the depth range
+     */
+    bool transferPlane(const Point3d& fromRay, float fromDepth, const Point3d& normal, const Point3d& ray,
+                       float& out_depth) const;
+
+    const PatchMatchView& _rcView;
+    const std::vector<PatchMatchView>& _tcViews;
+    const PatchMatchParams _params;
+
+    /// patch pixels offsets and distance weights
+    std::vector<int> _patchOffsetsX;
+    std::vector<int> _patchOffsetsY;
+    std::vector<float> _patchDistWeights;
+
+    std::vector<Scale> _scales;
+    float _minDepth = 0.0f;
+    float _maxDepth = 0.0f;
+
+    /// current hypotheses and costs (1 - NCC) of the pixels at the current scale
+    std::vector<float> _depths;
+    std::vector<Point3d> _normals;
+    std::vector<float> _costs;
+};
+
+/**
+ * @brief Estimate and save the depth map of a camera with PatchMatchRc,
+ * the depth and sim maps are the same files as the ones written by RefineRc.
+ */
+void estimateDepthMapPatchMatch(int rc, mvsUtils::MultiViewParams* mp, mvsUtils::ImagesCache& ic, const PatchMatchParams& params);
+
+/**
+ * @brief Estimate and save the depth maps of cameras with PatchMatchRc, on the CPU.
+ * Cameras whose depth map already exists are skipped.
+ */
+void estimateDepthMapsPatchMatch(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams);
+
+} // namespace depthMap
+} // namespace aliceVision
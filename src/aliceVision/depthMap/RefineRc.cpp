@@ -6,6 +6,8 @@
 
 #include "RefineRc.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <aliceVision/mvsData/Point2d.hpp>
@@ -105,6 +107,8 @@ DepthSimMap* RefineRc::getDepthPixSizeMapFromSGM()
 
 DepthSimMap* RefineRc::refineAndFuseDepthSimMapCUDA(DepthSimMap* depthPixSizeMapVis)
 {
+    ALICEVISION_PROFILE_ZONE("depthMap::refineAndFuse");
+
     int w11 = sp->mp->getWidth(rc);
     int h11 = sp->mp->getHeight(rc);
 
@@ -198,6 +202,8 @@ DepthSimMap* RefineRc::refineAndFuseDepthSimMapCUDA(DepthSimMap* depthPixSizeMap
 DepthSimMap* RefineRc::optimizeDepthSimMapCUDA(DepthSimMap* depthPixSizeMapVis,
                                                       DepthSimMap* depthSimMapPhoto)
 {
+    ALICEVISION_PROFILE_ZONE("depthMap::refineOptimize");
+
     int h11 = sp->mp->getHeight(rc);
 
     StaticVector<DepthSimMap*>* dataMaps = new StaticVector<DepthSimMap*>();
@@ -241,6 +247,9 @@ DepthSimMap* RefineRc::optimizeDepthSimMapCUDA(DepthSimMap* depthPixSizeMapVis,
 
 bool RefineRc::refinercCUDA(bool checkIfExists)
 {
+    ALICEVISION_PROFILE_ZONE("depthMap::refine");
+    ALICEVISION_MEMORY_PHASE("depthMap::refine");
+
     const IndexT viewId = sp->mp->getViewId(rc);
 
     if(sp->mp->verbose)
@@ -6,6 +6,8 @@
 
 #include "SemiGlobalMatchingRc.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
 #include <aliceVision/depthMap/SemiGlobalMatchingRcTc.hpp>
@@ -317,6 +319,8 @@ void SemiGlobalMatchingRc::computeDepthsTcamsLimits(StaticVector<StaticVector<fl
 
 void SemiGlobalMatchingRc::computeDepthsAndResetTCams()
 {
+    ALICEVISION_PROFILE_ZONE("depthMap::sgmDepths");
+
     std::size_t nbObsDepths;
     float minObsDepth, maxObsDepth, midObsDepth;
     sp->mp->getMinMaxMidNbDepth(rc, minObsDepth, maxObsDepth, midObsDepth, nbObsDepths, sp->seedsRangePercentile);
@@ -480,6 +484,9 @@ void SemiGlobalMatchingRc::getSubDepthsForTCam( int tcamid, std::vector<float>&
 
 bool SemiGlobalMatchingRc::sgmrc(bool checkIfExists)
 {
+    ALICEVISION_PROFILE_ZONE("depthMap::sgm");
+    ALICEVISION_MEMORY_PHASE("depthMap::sgm");
+
     if(sp->mp->verbose)
         ALICEVISION_LOG_DEBUG("sgmrc: processing " << (rc + 1) << " of " << sp->mp->ncams << ".");
 
@@ -544,6 +551,7 @@ bool SemiGlobalMatchingRc::sgmrc(bool checkIfExists)
     if(sp->doSGMoptimizeVolume) // this is here for experimental reason ... to show how SGGC work on non
                                 // optimized depthmaps ... it must equals to true in normal case
     {
+        ALICEVISION_PROFILE_ZONE("depthMap::sgmOptimizeVolume");
         svol->SGMoptimizeVolumeStepZ(rc, step, 0, 0, scale);
     }
 
@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "SemiGlobalMatchingRcTc.hpp"
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 
 namespace aliceVision {
@@ -67,6 +68,8 @@ StaticVector<Voxel>* SemiGlobalMatchingRcTc::getPixels()
 StaticVector<unsigned char>* SemiGlobalMatchingRcTc::computeDepthSimMapVolume(float& volumeMBinGPUMem, int wsh, float gammaC,
                                                                    float gammaP)
 {
+    ALICEVISION_PROFILE_ZONE("depthMap::sgmSimilarityVolume");
+
     long tall = clock();
 
     int volStepXY = _step;
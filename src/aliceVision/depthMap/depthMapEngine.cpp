@@ -0,0 +1,41 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "depthMapEngine.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <stdexcept>
+
+namespace aliceVision {
+namespace depthMap {
+
+EDepthMapEngine EDepthMapEngine_stringToEnum(const std::string& engine)
+{
+    std::string e = engine;
+    boost::to_lower(e);
+
+    if(e == "sgm")
+        return EDepthMapEngine::SGM;
+    if(e == "patchmatch")
+        return EDepthMapEngine::PATCHMATCH;
+    throw std::out_of_range("Invalid depth map engine " + engine);
+}
+
+std::string EDepthMapEngine_enumToString(EDepthMapEngine engine)
+{
+    switch(engine)
+    {
+    case EDepthMapEngine::SGM:
+        return "sgm";
+    case EDepthMapEngine::PATCHMATCH:
+        return "patchMatch";
+    }
+    throw std::out_of_range("Unrecognized EDepthMapEngine");
+}
+
+} // namespace depthMap
+} // namespace aliceVision
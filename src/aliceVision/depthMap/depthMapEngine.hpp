@@ -0,0 +1,40 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <string>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Depth map estimation engines
+ */
+enum class EDepthMapEngine
+{
+    /// Semi Global Matching followed by the refinement (RefineRc), needs a CUDA device
+    SGM = 0,
+    /// PatchMatch stereo on the CPU (PatchMatchRc)
+    PATCHMATCH
+};
+
+/**
+ * @brief returns the EDepthMapEngine enum from a string.
+ * @param[in] engine the input string.
+ * @return the associated EDepthMapEngine enum.
+ */
+EDepthMapEngine EDepthMapEngine_stringToEnum(const std::string& engine);
+
+/**
+ * @brief converts an EDepthMapEngine enum to a string.
+ * @param[in] engine the EDepthMapEngine enum to convert.
+ * @return the string associated to the EDepthMapEngine enum.
+ */
+std::string EDepthMapEngine_enumToString(EDepthMapEngine engine);
+
+} // namespace depthMap
+} // namespace aliceVision
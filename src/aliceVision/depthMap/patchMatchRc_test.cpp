@@ -0,0 +1,127 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/depthMap/PatchMatchRc.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE patchMatchRc
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::depthMap;
+
+const int width = 160;
+const int height = 120;
+const double focal = 200.0;
+
+/// normal and offset of the plane of the scene: dot(planeNormal, X) = planeOffset
+const Point3d planeNormal(-0.3, 0.2, 1.0);
+const double planeOffset = 4.0;
+
+double texture(double x, double y)
+{
+  return 128.0 + 40.0 * std::sin(23.0 * x + 3.0 * y) * std::cos(17.0 * y - 5.0 * x)
+               + 30.0 * std::sin(41.0 * y + 11.0 * x) + 20.0 * std::cos(53.0 * x - 29.0 * y);
+}
+
+/// depth along the ray of a pixel of a camera without rotation
+double planeDepth(const Point3d& C, double x, double y)
+{
+  const Point3d ray = Point3d((x - width / 2.0) / focal, (y - height / 2.0) / focal, 1.0).normalize();
+  return (planeOffset - dot(planeNormal, C)) / dot(planeNormal, ray);
+}
+
+/**
+ * @brief Render a view of the textured plane from a camera without rotation
+ */
+PatchMatchView createView(const Point3d& C)
+{
+  PatchMatchView view;
+  view.width = width;
+  view.height = height;
+  view.C = C;
+
+  // P = K * [I | -C]
+  view.P.m11 = focal; view.P.m13 = width / 2.0;  view.P.m14 = -focal * C.x - width / 2.0 * C.z;
+  view.P.m22 = focal; view.P.m23 = height / 2.0; view.P.m24 = -focal * C.y - height / 2.0 * C.z;
+  view.P.m33 = 1.0;   view.P.m34 = -C.z;
+
+  // iCam = K^-1
+  view.iCam.m11 = 1.0 / focal; view.iCam.m13 = -width / 2.0 / focal;
+  view.iCam.m22 = 1.0 / focal; view.iCam.m23 = -height / 2.0 / focal;
+  view.iCam.m33 = 1.0;
+
+  view.gray.resize(width * height);
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const Point3d ray = Point3d((x - width / 2.0) / focal, (y - height / 2.0) / focal, 1.0).normalize();
+      const Point3d X = C + ray * planeDepth(C, x, y);
+      view.gray[y * width + x] = static_cast<float>(texture(X.x, X.y));
+    }
+  }
+  return view;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Render a slanted textured plane from a reference camera and 3 neighbour cameras
+// - Estimate the depth map of the reference camera with PatchMatch, seeded with a few points of the plane
+// - Assert that most pixels are valid and that their depths are close to the plane depths
+//-----------------
+BOOST_AUTO_TEST_CASE(patchMatchRc_slantedPlane)
+{
+  const Point3d rcCenter(0.0, 0.0, 0.0);
+  const PatchMatchView rcView = createView(rcCenter);
+  const std::vector<PatchMatchView> tcViews = {createView(Point3d(0.4, 0.0, 0.0)),
+                                               createView(Point3d(-0.3, 0.2, 0.1)),
+                                               createView(Point3d(0.1, -0.4, 0.0))};
+
+  std::vector<Point3d> seeds;
+  for(int i = 0; i < 20; ++i)
+  {
+    const double x = 10.0 + 7.0 * i;
+    const double y = 10.0 + 5.0 * i;
+    const Point3d ray = Point3d((x - width / 2.0) / focal, (y - height / 2.0) / focal, 1.0).normalize();
+    seeds.push_back(rcCenter + ray * planeDepth(rcCenter, x, y));
+  }
+
+  PatchMatchParams params;
+  PatchMatchRc patchMatch(rcView, tcViews, params);
+  std::vector<DepthSim> depthSim;
+  patchMatch.estimate(2.0f, 8.0f, seeds, depthSim);
+  BOOST_REQUIRE_EQUAL(depthSim.size(), width * height);
+
+  // relative depth errors of the pixels away from the borders
+  std::vector<double> errors;
+  int nbPixels = 0;
+  for(int y = 10; y < height - 10; ++y)
+  {
+    for(int x = 10; x < width - 10; ++x)
+    {
+      ++nbPixels;
+      const DepthSim& ds = depthSim[y * width + x];
+      if(ds.depth <= 0.0f)
+      {
+        BOOST_CHECK_EQUAL(ds.sim, 1.0f);
+        continue;
+      }
+      BOOST_CHECK_LE(ds.sim, params.maxSim);
+      errors.push_back(std::abs(ds.depth - planeDepth(rcCenter, x, y)) / planeDepth(rcCenter, x, y));
+    }
+  }
+
+  BOOST_CHECK_GE(errors.size(), 0.9 * nbPixels);
+  std::sort(errors.begin(), errors.end());
+  BOOST_CHECK_LT(errors[errors.size() / 2], 0.005);
+  BOOST_CHECK_LT(errors[errors.size() * 9 / 10], 0.02);
+}
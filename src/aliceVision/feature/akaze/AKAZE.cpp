@@ -115,75 +115,91 @@ float computeAutomaticContrastFactor(const image::Image<float>& image,
 }
 
 /**
- * @brief Compute an AKAZE slice
- * @param[in] src Input image for the given octave
+ * @brief Compute the nonlinear diffusion image of an AKAZE slice
+ * @param[in] src Input image for the given octave (diffusion image of the previous slice)
  * @param[in] p Octave index
  * @param[in] q Slice index
  * @param[in] nbSlice Slices per octave
  * @param[in] sigma0 First octave initial scale
  * @param[in] contrastFactor
  * @param Li Diffusion image
- * @param Lx X derivatives
- * @param Ly Y derivatives
- * @param Lhess Det(Hessian)
  */
-void computeAKAZESlice(const image::Image<float>& src,
-                       const int p,
-                       const int q,
-                       const int nbSlice,
-                       const float sigma0,
-                       const float contrastFactor,
-                       image::Image<float>& Li,
-                       image::Image<float>& Lx,
-                       image::Image<float>& Ly,
-                       image::Image<float>& Lhess)
+void computeAKAZESliceDiffusion(const image::Image<float>& src,
+                                const int p,
+                                const int q,
+                                const int nbSlice,
+                                const float sigma0,
+                                const float contrastFactor,
+                                image::Image<float>& Li)
 {
-  const float sigmaCur = sigma(sigma0, p, q, nbSlice);
-  const float ratio = 1 << p; //pow(2,p);
-  const int sigmaScale = MathTrait<float>::round(sigmaCur * derivativeFactor / ratio);
-
-  image::Image<float> smoothed;
-
   if(p == 0 && q == 0)
   {
     // compute new image
     image::ImageGaussianFilter(src , sigma0 , Li, 0, 0);
+    return;
+  }
+
+  // general case
+  image::Image<float> in;
+  if( q == 0 )
+  {
+    image::ImageHalfSample(src , in);
   }
   else
   {
-    // general case
-    image::Image<float> in;
-    if( q == 0 )
-    {
-      image::ImageHalfSample(src , in);
-    }
-    else
-    {
-      in = src;
-    }
-
-    const float sigmaPrev = ( q == 0 ) ? sigma(sigma0, p - 1, nbSlice - 1, nbSlice) : sigma(sigma0, p, q - 1, nbSlice);
-
-    // compute non linear timing between two consecutive slices
-    const float t_prev = 0.5f * (sigmaPrev * sigmaPrev);
-    const float t_cur  = 0.5f * (sigmaCur * sigmaCur);
-    const float total_cycle_time = t_cur - t_prev;
+    in = src;
+  }
 
-    // compute first derivatives (Scharr scale 1, non normalized) for diffusion coef
-    image::ImageGaussianFilter(in , 1.f , smoothed, 0, 0 );
-    image::ImageScharrXDerivative(smoothed, Lx, false);
-    image::ImageScharrYDerivative(smoothed, Ly, false);
+  const float sigmaCur = sigma(sigma0, p, q, nbSlice);
+  const float sigmaPrev = ( q == 0 ) ? sigma(sigma0, p - 1, nbSlice - 1, nbSlice) : sigma(sigma0, p, q - 1, nbSlice);
+
+  // compute non linear timing between two consecutive slices
+  const float t_prev = 0.5f * (sigmaPrev * sigmaPrev);
+  const float t_cur  = 0.5f * (sigmaCur * sigmaCur);
+  const float total_cycle_time = t_cur - t_prev;
+
+  // compute first derivatives (Scharr scale 1, non normalized) for diffusion coef
+  image::Image<float> smoothed, Lx, Ly;
+  image::ImageGaussianFilter(in , 1.f , smoothed, 0, 0 );
+  image::ImageScharrXDerivative(smoothed, Lx, false);
+  image::ImageScharrYDerivative(smoothed, Ly, false);
+
+  // compute diffusion coefficient
+  image::Image<float> & diff = smoothed; // diffusivity image (reuse existing memory)
+  image::ImagePeronaMalikG2DiffusionCoef(Lx, Ly, contrastFactor, diff) ;
+
+  // compute FED cycles (fused and row parallel steps)
+  std::vector<float> tau ;
+  image::FEDCycleTimings(total_cycle_time, 0.25f, tau);
+  image::ImageFEDCycle(in, diff, tau);
+  Li.swap(in); // evolution image
+}
 
-    // compute diffusion coefficient
-    image::Image<float> & diff = smoothed; // diffusivity image (reuse existing memory)
-    image::ImagePeronaMalikG2DiffusionCoef(Lx, Ly, contrastFactor, diff) ;
+/**
+ * @brief Compute the derivatives and the Hessian response of an AKAZE slice
+ * @param[in] Li Diffusion image
+ * @param[in] p Octave index
+ * @param[in] q Slice index
+ * @param[in] nbSlice Slices per octave
+ * @param[in] sigma0 First octave initial scale
+ * @param Lx X derivatives
+ * @param Ly Y derivatives
+ * @param Lhess Det(Hessian)
+ */
+void computeAKAZESliceHessian(const image::Image<float>& Li,
+                              const int p,
+                              const int q,
+                              const int nbSlice,
+                              const float sigma0,
+                              image::Image<float>& Lx,
+                              image::Image<float>& Ly,
+                              image::Image<float>& Lhess)
+{
+  const float sigmaCur = sigma(sigma0, p, q, nbSlice);
+  const float ratio = 1 << p; //pow(2,p);
+  const int sigmaScale = MathTrait<float>::round(sigmaCur * derivativeFactor / ratio);
 
-    // compute FED cycles
-    std::vector<float> tau ;
-    image::FEDCycleTimings(total_cycle_time, 0.25f, tau);
-    image::ImageFEDCycle(in, diff, tau);
-    Li = in ; // evolution image
-  }
+  image::Image<float> smoothed;
 
   // compute Hessian response
   if(p == 0 && q == 0)
@@ -239,36 +255,44 @@ AKAZE::AKAZE(const image::Image<float>& image, const AKAZEOptions& options):
 void AKAZE::computeScaleSpace()
 {
   float contrastFactor = computeAutomaticContrastFactor( _input, 0.7f);
-  image::Image<float> input = _input;
+  const int nbSlices = _options.nbOctaves * _options.nbSlicePerOctave;
+  _evolution.resize(nbSlices);
 
-  // octave computation
+  // diffusion images, each slice is diffused from the previous one
+  // (the filters and the FED steps are parallel over the rows)
   for(int p = 0; p < _options.nbOctaves; ++p)
   {
     contrastFactor *= (p == 0) ? 1.f : 0.75f;
 
     for(int q = 0; q < _options.nbSlicePerOctave; ++q)
     {
-      _evolution.emplace_back(TEvolution());
-      TEvolution& evo = _evolution.back();
+      const int sliceIndex = p * _options.nbSlicePerOctave + q;
+      const image::Image<float>& input = (sliceIndex == 0) ? _input : _evolution[sliceIndex - 1].cur;
 
       // compute Slice at (p,q) index
-      computeAKAZESlice(input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
-        evo.cur, evo.Lx, evo.Ly, evo.Lhess);
-
-      // Prepare inputs for next slice
-      input = evo.cur;
+      computeAKAZESliceDiffusion(input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
+        _evolution[sliceIndex].cur);
 
       // DEBUG octave image
 #if DEBUG_OCTAVE
       std::stringstream str ;
       str << "./" << "_oct_" << p << "_" << q << ".png" ;
-      image::Image<float> tmp = evo.cur;
+      image::Image<float> tmp = _evolution[sliceIndex].cur;
       convertScale(tmp);
       image::Image< unsigned char > tmp2 ((tmp*255).cast<unsigned char>());
       image::writeImage(str.str(), tmp2);
 #endif // DEBUG_OCTAVE
     }
   }
+
+  // derivatives and Hessian responses, independent between the slices
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < nbSlices; ++i)
+  {
+    TEvolution& evo = _evolution[i];
+    computeAKAZESliceHessian(evo.cur, i / _options.nbSlicePerOctave, i % _options.nbSlicePerOctave,
+      _options.nbSlicePerOctave, _options.sigma0, evo.Lx, evo.Ly, evo.Lhess);
+  }
 }
 
 void detectDuplicates(std::vector<std::pair<AKAZEKeypoint, bool>>& previous,
@@ -298,49 +322,50 @@ void detectDuplicates(std::vector<std::pair<AKAZEKeypoint, bool>>& previous,
 
 void AKAZE::featureDetection(std::vector<AKAZEKeypoint>& keypoints) const
 {
-  std::vector<std::vector<std::pair<AKAZEKeypoint, bool>>> ptsPerSlice(_options.nbOctaves * _options.nbSlicePerOctave);
+  const int nbSlices = _options.nbOctaves * _options.nbSlicePerOctave;
+  std::vector<std::vector<std::pair<AKAZEKeypoint, bool>>> ptsPerSlice(nbSlices);
 
+  // the slices are independent, the first octaves are the largest
   #pragma omp parallel for schedule(dynamic)
-  for(int p = 0 ; p < _options.nbOctaves ; ++p)
+  for(int i = 0; i < nbSlices; ++i)
   {
+    const int p = i / _options.nbSlicePerOctave;
+    const int q = i % _options.nbSlicePerOctave;
     const float ratio = static_cast<float>(1 << p);
 
-    for(int q = 0 ; q < _options.nbSlicePerOctave ; ++q)
-    {
-      const float sigma_cur = sigma( _options.sigma0 , p , q , _options.nbSlicePerOctave );
-      const image::Image<float>& LDetHess = _evolution[_options.nbOctaves * p + q].Lhess;
+    const float sigma_cur = sigma( _options.sigma0 , p , q , _options.nbSlicePerOctave );
+    const image::Image<float>& LDetHess = _evolution[i].Lhess;
 
-      // check that the point is under the image limits for the descriptor computation
-      const float borderLimit =
-        MathTrait<float>::round(_options.descFactor * sigma_cur * derivativeFactor / ratio) + 1;
+    // check that the point is under the image limits for the descriptor computation
+    const float borderLimit =
+      MathTrait<float>::round(_options.descFactor * sigma_cur * derivativeFactor / ratio) + 1;
 
-      for(int jx = borderLimit; jx < LDetHess.Height()-borderLimit; ++jx)
+    for(int jx = borderLimit; jx < LDetHess.Height()-borderLimit; ++jx)
+    {
+      for(int ix = borderLimit; ix < LDetHess.Width()-borderLimit; ++ix)
       {
-        for(int ix = borderLimit; ix < LDetHess.Width()-borderLimit; ++ix)
+        const float value = LDetHess(jx, ix);
+
+        // filter the points with the detector threshold
+        if(value > _options.threshold &&
+           value > LDetHess(jx-1, ix)   &&
+           value > LDetHess(jx-1, ix+1) &&
+           value > LDetHess(jx-1, ix-1) &&
+           value > LDetHess(jx  , ix-1) &&
+           value > LDetHess(jx  , ix+1) &&
+           value > LDetHess(jx+1, ix-1) &&
+           value > LDetHess(jx+1, ix)   &&
+           value > LDetHess(jx+1, ix+1))
         {
-          const float value = LDetHess(jx, ix);
-
-          // filter the points with the detector threshold
-          if(value > _options.threshold &&
-             value > LDetHess(jx-1, ix)   &&
-             value > LDetHess(jx-1, ix+1) &&
-             value > LDetHess(jx-1, ix-1) &&
-             value > LDetHess(jx  , ix-1) &&
-             value > LDetHess(jx  , ix+1) &&
-             value > LDetHess(jx+1, ix-1) &&
-             value > LDetHess(jx+1, ix)   &&
-             value > LDetHess(jx+1, ix+1))
-          {
-            AKAZEKeypoint point;
-            point.size = sigma_cur * derivativeFactor ;
-            point.octave = p;
-            point.response = fabs(value);
-            point.x = ix * ratio + 0.5 * (ratio-1);
-            point.y = jx * ratio + 0.5 * (ratio-1);
-            point.angle = 0.0f;
-            point.class_id = p * _options.nbSlicePerOctave + q;
-            ptsPerSlice[_options.nbOctaves * p + q].emplace_back(point, false);
-          }
+          AKAZEKeypoint point;
+          point.size = sigma_cur * derivativeFactor ;
+          point.octave = p;
+          point.response = fabs(value);
+          point.x = ix * ratio + 0.5 * (ratio-1);
+          point.y = jx * ratio + 0.5 * (ratio-1);
+          point.angle = 0.0f;
+          point.class_id = i;
+          ptsPerSlice[i].emplace_back(point, false);
         }
       }
     }
@@ -456,15 +481,20 @@ void AKAZE::subpixelRefinement(std::vector<AKAZEKeypoint>& keypoints) const
   in_keypoints.swap(keypoints);
   keypoints.reserve(in_keypoints.size());
 
+  std::vector<char> isStable(in_keypoints.size());
+
   #pragma omp parallel for schedule(dynamic)
   for(int i = 0; i < static_cast<int>(in_keypoints.size()); ++i)
   {
     AKAZEKeypoint& point = in_keypoints[i];
-    if(subpixelRefinement(point, this->_evolution[point.class_id].Lhess))
-    {
-      #pragma omp critical
-      keypoints.emplace_back(point);
-    }
+    isStable[i] = subpixelRefinement(point, this->_evolution[point.class_id].Lhess);
+  }
+
+  // keep the detection order
+  for(std::size_t i = 0; i < in_keypoints.size(); ++i)
+  {
+    if(isStable[i])
+      keypoints.emplace_back(in_keypoints[i]);
   }
 }
 
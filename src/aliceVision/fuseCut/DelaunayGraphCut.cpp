@@ -7,14 +7,22 @@
 #include "DelaunayGraphCut.hpp"
 // #include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 #include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+#include <aliceVision/fuseCut/tetrahedronIntersection.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/mvsData/compressedChunks.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
 #include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Universe.hpp>
+#include <aliceVision/mvsUtils/depthSimMapStorage.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/imageIO/image.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 #include "nanoflann.hpp"
@@ -24,6 +32,14 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <sstream>
+
 // OpenMP >= 3.1 for advanced atomic clauses (https://software.intel.com/en-us/node/608160)
 // OpenMP preprocessor version: https://github.com/jeffhammond/HPCInfo/wiki/Preprocessor-Macros
 #if defined _OPENMP && _OPENMP >= 201107 
@@ -40,6 +56,48 @@ namespace fuseCut {
 
 namespace bfs = boost::filesystem;
 
+/**
+ * @brief Wall-clock duration and resident memory of a meshing phase, from its construction or reset().
+ */
+class PhaseLog
+{
+public:
+    PhaseLog() { reset(); }
+
+    void reset()
+    {
+        _timer.reset();
+        _startRss = system::getUsedMemory();
+        _startPeakRss = system::getPeakUsedMemory();
+    }
+
+    /**
+     * @brief Log the duration, the memory increase and the peak memory of the phase.
+     * The peak of the process is only known for the phase if it was raised during the phase,
+     * otherwise the phase peak is below the peak of the process before the phase.
+     */
+    void log(const std::string& phaseName) const
+    {
+        const std::size_t rss = system::getUsedMemory();
+        const std::size_t peakRss = system::getPeakUsedMemory();
+        const long long increaseMB = (static_cast<long long>(rss) - static_cast<long long>(_startRss)) / (1024 * 1024);
+
+        std::ostringstream peak;
+        if(peakRss > _startPeakRss)
+            peak << peakRss / (1024 * 1024) << " MB";
+        else
+            peak << "below " << _startPeakRss / (1024 * 1024) << " MB";
+
+        ALICEVISION_LOG_INFO(phaseName << " done in " << _timer.elapsed() << " s"
+                             << " (memory: " << (increaseMB >= 0 ? "+" : "") << increaseMB << " MB, peak: " << peak.str() << ").");
+    }
+
+private:
+    system::Timer _timer;
+    std::size_t _startRss = 0;
+    std::size_t _startPeakRss = 0;
+};
+
 // #define USE_GEOGRAM_KDTREE 1
 
 #ifdef USE_GEOGRAM_KDTREE
@@ -266,6 +324,15 @@ void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vecto
     verticesAttrPrepare.swap(verticesAttrTmp);
 }
 
+/// depth and similarity maps of a camera
+struct DepthSimMaps
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> depthMap;
+    std::vector<float> simMap;
+};
+
 void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare,
                                     std::vector<GC_vertexInfo>& verticesAttrPrepare, mvsUtils::MultiViewParams* mp, float simFactor, float voteMarginFactor, float contributeMarginFactor, float simGaussianSize)
 {
@@ -279,42 +346,61 @@ void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<P
     kdTree.buildIndex();
     ALICEVISION_LOG_INFO("NANOFLANN: KdTree created.");
 #endif
-    // TODO FACA: update into new data structures
-    // std::vector<Point3d> newVerticesCoordsPrepare(verticesCoordsPrepare.size());
-    // std::vector<float> newSimScorePrepare(simScorePrepare.size());
-    // std::vector<double> newPixSizePrepare(pixSizePrepare.size());
-    std::vector<omp_lock_t> locks(verticesCoordsPrepare.size());
-    for (auto& lock: locks)
-        omp_init_lock(&lock);
-
-    omp_set_nested(1);
-    #pragma omp parallel for num_threads(3)
-    for(int c = 0; c < cams.size(); ++c)
+    /// observation of a vertex by a pixel of the current camera
+    struct VertexObservation
     {
-        ALICEVISION_LOG_INFO("Create visibilities (" << c << "/" << cams.size() << ")");
-        std::vector<float> depthMap;
-        std::vector<float> simMap;
-        int width, height;
+        std::size_t vertexIndex;
+        Point3d p;
+        bool contributes;
+    };
+    RangeBuffers<VertexObservation> observations(verticesCoordsPrepare.size(), omp_get_max_threads());
+
+    // read the depth and similarity maps of a camera, done in a separate thread for the next camera
+    const auto readMaps = [&](int c, DepthSimMaps& maps)
+    {
+        const std::string depthMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::depthMap, 0);
+        imageIO::readImage(depthMapFilepath, maps.width, maps.height, maps.depthMap);
+        if(maps.depthMap.empty())
         {
-            const std::string depthMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::depthMap, 0);
-            imageIO::readImage(depthMapFilepath, width, height, depthMap);
-            if(depthMap.empty())
-            {
-                ALICEVISION_LOG_WARNING("Empty depth map: " << depthMapFilepath);
-                continue;
-            }
-            int wTmp, hTmp;
-            const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
-            imageIO::readImage(simMapFilepath, wTmp, hTmp, simMap);
-            if(wTmp != width || hTmp != height)
-                throw std::runtime_error("Similarity map size doesn't match the depth map size: " + simMapFilepath + ", " + depthMapFilepath);
-            {
-                std::vector<float> simMapTmp(simMap.size());
-                imageIO::convolveImage(width, height, simMap, simMapTmp, "gaussian", simGaussianSize, simGaussianSize);
-                simMap.swap(simMapTmp);
-            }
+            ALICEVISION_LOG_WARNING("Empty depth map: " << depthMapFilepath);
+            return;
+        }
+        int wTmp, hTmp;
+        const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
+        mvsUtils::readSimMap(simMapFilepath, wTmp, hTmp, maps.simMap);
+        if(wTmp != maps.width || hTmp != maps.height)
+            throw std::runtime_error("Similarity map size doesn't match the depth map size: " + simMapFilepath + ", " + depthMapFilepath);
+        {
+            std::vector<float> simMapTmp(maps.simMap.size());
+            imageIO::convolveImage(maps.width, maps.height, maps.simMap, simMapTmp, "gaussian", simGaussianSize, simGaussianSize);
+            maps.simMap.swap(simMapTmp);
         }
+    };
+
+    DepthSimMaps nextMaps;
+    std::future<void> nextMapsRead;
+    if(cams.size() > 0)
+        nextMapsRead = std::async(std::launch::async, readMaps, 0, std::ref(nextMaps));
+
+    for(int c = 0; c < cams.size(); ++c)
+    {
+        ALICEVISION_LOG_INFO("Create visibilities (" << c << "/" << cams.size() << ")");
+        nextMapsRead.get();
+        DepthSimMaps maps;
+        std::swap(maps, nextMaps);
+        if(c + 1 < cams.size())
+            nextMapsRead = std::async(std::launch::async, readMaps, c + 1, std::ref(nextMaps));
+
+        if(maps.depthMap.empty())
+            continue;
+
+        const int width = maps.width;
+        const int height = maps.height;
+        const std::vector<float>& depthMap = maps.depthMap;
+        const std::vector<float>& simMap = maps.simMap;
+
         // Add visibility
+        // The vertices are not modified during the loop, the observations are applied after it.
         #pragma omp parallel for
         for(int y = 0; y < height; ++y)
         {
@@ -348,41 +434,26 @@ void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<P
 
                 if(dist < voteMarginFactor * std::max(pixSizeScoreI, pixSizeScoreV))
                 {
-                    GC_vertexInfo& va = verticesAttrPrepare[nearestVertexIndex];
-                    Point3d& vc = verticesCoordsPrepare[nearestVertexIndex];
-                    const float simValue = simMap[index];
-                    // remap similarity values from [-1;+1] to [+1;+simFactor]
-                    // interpretation is [goodSimilarity;badSimilarity]
-                    const float simScore = simValue < -1.0f ? 1.0f : 1.0f + (1.0f + simValue) * simFactor;
-
-                    // Custom locks to limit it to the index: nearestVertexIndex
-                    // to avoid using "omp critical"
-                    omp_lock_t* lock = &locks[nearestVertexIndex];
-                    omp_set_lock(lock);
-                    {
-                        va.cams.push_back_distinct(c);
-                        if(dist < contributeMarginFactor * pixSizeScoreV)
-                        {
-                            vc = (vc * (double)va.nrc + p) / double(va.nrc + 1);
-//                            newVerticesCoordsPrepare[nearestVertexIndex] = (newVerticesCoordsPrepare[nearestVertexIndex] * double(va.nrc) + p) / double(va.nrc + 1);
-//                            newSimScorePrepare[nearestVertexIndex] = (newSimScorePrepare[nearestVertexIndex] * float(va.nrc) + simScore) / float(va.nrc + 1);
-//                            newPixSizePrepare[nearestVertexIndex] = (newPixSizePrepare[nearestVertexIndex] * double(va.nrc) + pixSize) / double(va.nrc + 1);
-                            va.nrc += 1;
-                        }
-                    }
-                    omp_unset_lock(lock);
+                    const bool contributes = (dist < contributeMarginFactor * pixSizeScoreV);
+                    observations.add(nearestVertexIndex, VertexObservation{nearestVertexIndex, p, contributes});
                 }
             }
         }
-    }
-    omp_set_nested(0);
 
-    for(auto& lock: locks)
-        omp_destroy_lock(&lock);
+        // each vertex is updated by a single thread, in the order of the pixels for a given number of threads
+        observations.apply([&](const VertexObservation& observation)
+        {
+            GC_vertexInfo& va = verticesAttrPrepare[observation.vertexIndex];
+            va.cams.push_back_distinct(c);
+            if(observation.contributes)
+            {
+                Point3d& vc = verticesCoordsPrepare[observation.vertexIndex];
+                vc = (vc * (double)va.nrc + observation.p) / double(va.nrc + 1);
+                va.nrc += 1;
+            }
+        });
+    }
 
-//    verticesCoordsPrepare.swap(newVerticesCoordsPrepare);
-//    simScorePrepare.swap(newSimScorePrepare);
-//    pixSizePrepare.swap(newPixSizePrepare);
     ALICEVISION_LOG_INFO("Visibilities created.");
 }
 
@@ -396,7 +467,17 @@ DelaunayGraphCut::DelaunayGraphCut(mvsUtils::MultiViewParams* _mp)
     saveTemporaryBinFiles = mp->userParams.get<bool>("LargeScale.saveTemporaryBinFiles", false);
 
     GEO::initialize();
-    _tetrahedralization = GEO::Delaunay::create(3, "BDEL");
+    if(mp->userParams.get<bool>("delaunaycut.parallelTetrahedralization", true))
+    {
+        // multithreaded 3D Delaunay, only available if geogram is built with PDEL
+        // (Delaunay::create does not fail on an unknown algorithm, it falls back to a nearest neighbors search)
+        if(GEO::DelaunayFactory::has_creator("PDEL"))
+            _tetrahedralization = GEO::Delaunay::create(3, "PDEL");
+        else
+            ALICEVISION_LOG_WARNING("Parallel tetrahedralization not available, use the sequential one.");
+    }
+    if(_tetrahedralization.is_null())
+        _tetrahedralization = GEO::Delaunay::create(3, "BDEL");
     // _tetrahedralization->set_keeps_infinite(true);
     _tetrahedralization->set_stores_neighbors(true);
     // _tetrahedralization->set_stores_cicl(true);
@@ -408,22 +489,22 @@ DelaunayGraphCut::~DelaunayGraphCut()
 
 void DelaunayGraphCut::saveDhInfo(const std::string& fileNameInfo)
 {
-    FILE* f = fopen(fileNameInfo.c_str(), "wb");
+    fuseCut::saveDhInfo(fileNameInfo, _verticesAttr, _cellsAttr);
+}
 
-    int npts = getNbVertices();
-    fwrite(&npts, sizeof(int), 1, f);
-    for(const GC_vertexInfo& v: _verticesAttr)
-    {
-        v.fwriteinfo(f);
-    }
+void DelaunayGraphCut::loadDhInfo(const std::string& fileNameInfo)
+{
+    std::vector<GC_vertexInfo> verticesAttr;
+    std::vector<GC_cellInfo> cellsAttr;
+    fuseCut::loadDhInfo(fileNameInfo, verticesAttr, cellsAttr);
 
-    int ncells = _cellsAttr.size();
-    fwrite(&ncells, sizeof(int), 1, f);
-    for(const GC_cellInfo& c: _cellsAttr)
-    {
-        c.fwriteinfo(f);
-    }
-    fclose(f);
+    if(verticesAttr.size() != getNbVertices() || cellsAttr.size() != _tetrahedralization->nb_cells())
+        ALICEVISION_THROW_ERROR("The Delaunay info file " << fileNameInfo << " does not match the tetrahedralization ("
+                                << verticesAttr.size() << " vertices and " << cellsAttr.size() << " cells instead of "
+                                << getNbVertices() << " and " << _tetrahedralization->nb_cells() << ")");
+
+    _verticesAttr.swap(verticesAttr);
+    _cellsAttr.swap(cellsAttr);
 }
 
 void DelaunayGraphCut::saveDh(const std::string& fileNameDh, const std::string& fileNameInfo)
@@ -443,8 +524,10 @@ void DelaunayGraphCut::saveDh(const std::string& fileNameDh, const std::string&
 void DelaunayGraphCut::initVertices()
 {
     ALICEVISION_LOG_DEBUG("initVertices ...\n");
+    PhaseLog phase;
 
     // Re-assign ids to the vertices to go one after another
+    #pragma omp parallel for
     for(int vi = 0; vi < _verticesAttr.size(); ++vi)
     {
         GC_vertexInfo& v = _verticesAttr[vi];
@@ -454,22 +537,28 @@ void DelaunayGraphCut::initVertices()
         v.pixSize = mp->getCamsMinPixelSize(_verticesCoords[vi], v.cams);
     }
 
-    ALICEVISION_LOG_DEBUG("initVertices done\n");
+    phase.log("initVertices");
 }
 
 void DelaunayGraphCut::computeDelaunay()
 {
+    ALICEVISION_PROFILE_ZONE("meshing::delaunay");
+
     ALICEVISION_LOG_DEBUG("computeDelaunay GEOGRAM ...\n");
 
     assert(_verticesCoords.size() == _verticesAttr.size());
 
-    long tall = clock();
+    PhaseLog phase;
     _tetrahedralization->set_vertices(_verticesCoords.size(), _verticesCoords.front().m);
-    mvsUtils::printfElapsedTime(tall, "GEOGRAM Delaunay tetrahedralization ");
+    phase.log("GEOGRAM Delaunay tetrahedralization");
 
+    phase.reset();
     initCells();
+    phase.log("initCells");
 
+    phase.reset();
     updateVertexToCellsCache();
+    phase.log("updateVertexToCellsCache");
 
     ALICEVISION_LOG_DEBUG("computeDelaunay done\n");
 }
@@ -481,22 +570,78 @@ void DelaunayGraphCut::initCells()
     _cellsAttr.resize(_tetrahedralization->nb_cells()); // or nb_finite_cells() if keeps_infinite()
 
     ALICEVISION_LOG_INFO(_cellsAttr.size() << " cells created by tetrahedralization.");
+    // reset the weights of all the cells, including the ones kept by resize
+    #pragma omp parallel for
     for(int i = 0; i < _cellsAttr.size(); ++i)
     {
-        GC_cellInfo& c = _cellsAttr[i];
+        _cellsAttr[i] = GC_cellInfo();
+    }
 
-        c.cellSWeight = 0.0f;
-        c.cellTWeight = 0.0f;
-        c.on = 0.0f;
-        c.in = 0.0f;
-        c.out = 0.0f;
-        for(int s = 0; s < 4; ++s)
+    ALICEVISION_LOG_DEBUG("initCells done\n");
+}
+
+void DelaunayGraphCut::updateVertexToCellsCache()
+{
+    const int nbCells = _tetrahedralization->nb_cells();
+    const std::size_t nbVertices = _verticesCoords.size();
+
+    // count the cells around each vertex
+    std::vector<GEO::index_t> nbCellsPerVertex(nbVertices, 0);
+    int coutInvalidVertices = 0;
+    #pragma omp parallel for reduction(+:coutInvalidVertices)
+    for(int ci = 0; ci < nbCells; ++ci)
+    {
+        for(VertexIndex k = 0; k < 4; ++k)
         {
-            c.gEdgeVisWeight[s] = 0.0f; // weights for the 4 faces of the tetrahedron
+            const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
+            if(vi == GEO::NO_VERTEX || vi >= nbVertices)
+            {
+                ++coutInvalidVertices;
+                continue;
+            }
+            OMP_ATOMIC_UPDATE
+            ++nbCellsPerVertex[vi];
         }
     }
+    ALICEVISION_LOG_INFO("coutInvalidVertices: " << coutInvalidVertices);
 
-    ALICEVISION_LOG_DEBUG("initCells done\n");
+    _neighboringCellsOffsets.resize(nbVertices + 1);
+    _neighboringCellsOffsets[0] = 0;
+    for(std::size_t vi = 0; vi < nbVertices; ++vi)
+        _neighboringCellsOffsets[vi + 1] = _neighboringCellsOffsets[vi] + nbCellsPerVertex[vi];
+
+    // fill the cells of each vertex, nbCellsPerVertex is reused as the write position
+    _neighboringCells.resize(_neighboringCellsOffsets.back());
+    std::fill(nbCellsPerVertex.begin(), nbCellsPerVertex.end(), 0);
+    #pragma omp parallel for
+    for(int ci = 0; ci < nbCells; ++ci)
+    {
+        for(VertexIndex k = 0; k < 4; ++k)
+        {
+            const VertexIndex vi = _tetrahedralization->cell_vertex(ci, k);
+            if(vi == GEO::NO_VERTEX || vi >= nbVertices)
+                continue;
+            GEO::index_t position;
+#if defined _OPENMP && _OPENMP >= 201107
+            #pragma omp atomic capture
+            position = nbCellsPerVertex[vi]++;
+#else
+            #pragma omp critical
+            position = nbCellsPerVertex[vi]++;
+#endif
+            _neighboringCells[_neighboringCellsOffsets[vi] + position] = ci;
+        }
+    }
+
+    // sort the cells around each vertex to be independent of the threads scheduling
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(int vi = 0; vi < static_cast<int>(nbVertices); ++vi)
+    {
+        std::sort(_neighboringCells.begin() + _neighboringCellsOffsets[vi],
+                  _neighboringCells.begin() + _neighboringCellsOffsets[vi + 1]);
+    }
+
+    ALICEVISION_LOG_INFO("verticesCoords: " << nbVertices << ", vertex to cells incidences: " << _neighboringCells.size());
 }
 
 void DelaunayGraphCut::displayStatistics()
@@ -770,6 +915,9 @@ void DelaunayGraphCut::addHelperPoints(int nGridHelperVolumePointsDim, const Poi
 
 void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Point3d voxel[8], const FuseParams& params)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::fuseDepthMaps");
+    ALICEVISION_MEMORY_PHASE("meshing::fuseDepthMaps");
+
     ALICEVISION_LOG_INFO("fuseFromDepthMaps, maxVertices: " << params.maxPoints);
 
     std::vector<Point3d> verticesCoordsPrepare;
@@ -825,7 +973,7 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
                 }
                 int wTmp, hTmp;
                 const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
-                imageIO::readImage(simMapFilepath, wTmp, hTmp, simMap);
+                mvsUtils::readSimMap(simMapFilepath, wTmp, hTmp, simMap);
                 if(wTmp != width || hTmp != height)
                     throw std::runtime_error("Wrong sim map dimensions: " + simMapFilepath);
                 {
@@ -1233,55 +1381,49 @@ bool DelaunayGraphCut::rayCellIntersection(const Point3d& camC, const Point3d& p
         return false;
     }
 
-    Point3d linePoint = p;
-    Point3d lineVect = (camC - p).normalize();
+    const Point3d lineVect = (camC - p).normalize();
     double mind = (camC - p).size();
 
-    // go thru all triangles
-    bool existsTriOnRay = false;
-    const Point3d* A = &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 0)]);
-    const Point3d* B = &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 1)]);
-    const Point3d* C = &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 2)]);
-    const Point3d* D = &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 3)]);
-
-    // All the facets of the tetrahedron
-    std::array<std::array<const Point3d*, 3>, 4> facets {{
-        {B, C, D}, // opposite vertex A, index 0
-        {A, C, D}, // opposite vertex B, index 1
-        {A, B, D}, // opposite vertex C, index 2
-        {A, B, C}  // opposite vertex D, index 3
+    const std::array<const Point3d*, 4> vertices = {{
+        &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 0)]),
+        &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 1)]),
+        &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 2)]),
+        &(_verticesCoords[_tetrahedralization->cell_vertex(tetrahedron, 3)])
     }};
+
+    // Test all facets of the tetrahedron at once
+    std::array<Point3d, 4> facetsLpi;
+    const int intersectedFacets = intersectLineTetrahedronFacets(vertices, p, lineVect, facetsLpi);
+
+    bool existsTriOnRay = false;
     int oppositeVertexIndex = -1;
-    Point3d lpi;
-    double dist;
-    // Test all facets of the tetrahedron
     for(int i = 0; i < 4; ++i)
     {
-        const auto& facet= facets[i];
-        if(isLineInTriangle(&lpi, facet[0], facet[1], facet[2], &linePoint, &lineVect))
+        if((intersectedFacets & (1 << i)) == 0)
+            continue;
+
+        const Point3d& lpi = facetsLpi[i];
+        const double dist = (camC - lpi).size();
+        if(nearestFarest)
         {
-            dist = (camC - lpi).size();
-            if(nearestFarest)
+            if(dist < mind) // between the camera and the point
             {
-                if(dist < mind) // between the camera and the point
-                {
-                    oppositeVertexIndex = i;
-                    existsTriOnRay = true;
-                    mind = dist;
-                    out_nlpi = lpi;
-                    //break;
-                }
+                oppositeVertexIndex = i;
+                existsTriOnRay = true;
+                mind = dist;
+                out_nlpi = lpi;
+                //break;
             }
-            else
+        }
+        else
+        {
+            if(dist > mind) // behind the point (from the camera)
             {
-                if(dist > mind) // behind the point (from the camera)
-                {
-                    oppositeVertexIndex = i;
-                    existsTriOnRay = true;
-                    mind = dist;
-                    out_nlpi = lpi;
-                    //break;
-                }
+                oppositeVertexIndex = i;
+                existsTriOnRay = true;
+                mind = dist;
+                out_nlpi = lpi;
+                //break;
             }
         }
     }
@@ -1529,14 +1671,18 @@ float DelaunayGraphCut::weightFcn(float nrc, bool labatutWeights, int  /*ncams*/
 void DelaunayGraphCut::fillGraph(bool fixesSigma, float nPixelSizeBehind, bool allPoints, bool behind,
                                bool labatutWeights, bool fillOut, float distFcnHeight) // fixesSigma=true nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 labatutWeights=0 fillOut=1 distFcnHeight=0
 {
+    ALICEVISION_PROFILE_ZONE("meshing::fillGraph");
+
     ALICEVISION_LOG_INFO("Computing s-t graph weights.");
-    long t1 = clock();
+    PhaseLog phase;
 
     setIsOnSurface();
 
     // loop over all cells ... initialize
-    for(GC_cellInfo& c: _cellsAttr)
+    #pragma omp parallel for
+    for(int ci = 0; ci < _cellsAttr.size(); ++ci)
     {
+        GC_cellInfo& c = _cellsAttr[ci];
         c.cellSWeight = 0.0f;
         c.cellTWeight = 0.0f;
         c.in = 0.0f;
@@ -1548,9 +1694,6 @@ void DelaunayGraphCut::fillGraph(bool fixesSigma, float nPixelSizeBehind, bool a
         }
     }
 
-    // choose random order to prevent waiting
-    StaticVector<int>* vetexesToProcessIdsRand = mvsUtils::createRandomArrayOfIntegers(_verticesAttr.size());
-
     int64_t avStepsFront = 0;
     int64_t aAvStepsFront = 0;
     int64_t avStepsBehind = 0;
@@ -1558,51 +1701,77 @@ void DelaunayGraphCut::fillGraph(bool fixesSigma, float nPixelSizeBehind, bool a
     int avCams = 0;
     int nAvCams = 0;
 
-#pragma omp parallel for reduction(+:avStepsFront,aAvStepsFront,avStepsBehind,nAvStepsBehind,avCams,nAvCams)
-    for(int i = 0; i < vetexesToProcessIdsRand->size(); i++)
+    // The rays are walked in parallel and the weights are accumulated in per-thread buffers,
+    // then each range of cells is updated by a single thread.
+    // The vertices are processed by blocks to bound the memory of the buffers.
+    const int nbThreads = omp_get_max_threads();
+    const int nbVertices = _verticesAttr.size();
+    const int blockSize = nbThreads * 1024;
+    RangeBuffers<CellWeight> cellWeights(_cellsAttr.size(), nbThreads);
+
+    for(int blockStart = 0; blockStart < nbVertices; blockStart += blockSize)
     {
-        int iV = (*vetexesToProcessIdsRand)[i];
-        const GC_vertexInfo& v = _verticesAttr[iV];
+        const int blockEnd = std::min(blockStart + blockSize, nbVertices);
 
-        if(v.isReal() && (allPoints || v.isOnSurface) && (v.nrc > 0))
+        // the vertices are spatially sorted, the consecutive rays go through the same cells
+        #pragma omp parallel for schedule(static, 16) reduction(+:avStepsFront,aAvStepsFront,avStepsBehind,nAvStepsBehind,avCams,nAvCams)
+        for(int iV = blockStart; iV < blockEnd; iV++)
         {
-            for(int c = 0; c < v.cams.size(); c++)
+            const GC_vertexInfo& v = _verticesAttr[iV];
+
+            if(v.isReal() && (allPoints || v.isOnSurface) && (v.nrc > 0))
             {
-                // "weight" is called alpha(p) in the paper
-                float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
+                for(int c = 0; c < v.cams.size(); c++)
+                {
+                    // "weight" is called alpha(p) in the paper
+                    float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
 
-                assert(v.cams[c] >= 0);
-                assert(v.cams[c] < mp->ncams);
+                    assert(v.cams[c] >= 0);
+                    assert(v.cams[c] < mp->ncams);
 
-                int nstepsFront = 0;
-                int nstepsBehind = 0;
-                fillGraphPartPtRc(nstepsFront, nstepsBehind, iV, v.cams[c], weight, fixesSigma, nPixelSizeBehind,
-                                  allPoints, behind, fillOut, distFcnHeight);
+                    int nstepsFront = 0;
+                    int nstepsBehind = 0;
+                    fillGraphPartPtRc(nstepsFront, nstepsBehind, iV, v.cams[c], weight, fixesSigma, nPixelSizeBehind,
+                                      allPoints, behind, fillOut, distFcnHeight, cellWeights);
 
-                avStepsFront += nstepsFront;
-                aAvStepsFront += 1;
-                avStepsBehind += nstepsBehind;
-                nAvStepsBehind += 1;
-            } // for c
+                    avStepsFront += nstepsFront;
+                    aAvStepsFront += 1;
+                    avStepsBehind += nstepsBehind;
+                    nAvStepsBehind += 1;
+                } // for c
 
-            avCams += v.cams.size();
-            nAvCams += 1;
+                avCams += v.cams.size();
+                nAvCams += 1;
+            }
         }
-    }
 
-    delete vetexesToProcessIdsRand;
+        cellWeights.apply([this](const CellWeight& w)
+        {
+            GC_cellInfo& c = _cellsAttr[w.cellIndex];
+            switch(w.type)
+            {
+                case CellWeight::eOut:     c.out += w.weight; break;
+                case CellWeight::eIn:      c.in += w.weight; break;
+                case CellWeight::eOn:      c.on += w.weight; break;
+                case CellWeight::eTWeight: c.cellTWeight += w.weight; break;
+                case CellWeight::eSWeight: c.cellSWeight = w.weight; break;
+                case CellWeight::eEdgeVis: c.gEdgeVisWeight[w.facet] += w.weight; break;
+            }
+        });
+    }
 
     ALICEVISION_LOG_DEBUG("avStepsFront " << avStepsFront);
     ALICEVISION_LOG_DEBUG("avStepsFront = " << mvsUtils::num2str(avStepsFront) << " // " << mvsUtils::num2str(aAvStepsFront));
     ALICEVISION_LOG_DEBUG("avStepsBehind = " << mvsUtils::num2str(avStepsBehind) << " // " << mvsUtils::num2str(nAvStepsBehind));
     ALICEVISION_LOG_DEBUG("avCams = " << mvsUtils::num2str(avCams) << " // " << mvsUtils::num2str(nAvCams));
 
-    mvsUtils::printfElapsedTime(t1, "s-t graph weights computed : ");
+    phase.log("s-t graph weights");
 }
 
 void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBehind, int vertexIndex, int cam,
                                        float weight, bool fixesSigma, float nPixelSizeBehind, bool allPoints,
-                                       bool behind, bool fillOut, float distFcnHeight)  // fixesSigma=true nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 fillOut=1 distFcnHeight=0
+                                       bool behind, bool fillOut, float distFcnHeight,
+                                       RangeBuffers<CellWeight>& cellWeights)  // fixesSigma=true nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 fillOut=1 distFcnHeight=0
 {
     out_nstepsFront = 0;
     out_nstepsBehind = 0;
@@ -1635,10 +1804,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         bool ok = ci != GEO::NO_CELL;
         while(ok)
         {
-            {
-#pragma OMP_ATOMIC_UPDATE
-                _cellsAttr[ci].out += weight;
-            }
+            cellWeights.add(ci, CellWeight(ci, CellWeight::eOut, weight));
 
             ++out_nstepsFront;
             ++nsteps;
@@ -1655,10 +1821,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
             {
                 float dist = distFcn(maxDist, (po - pold).size(), distFcnHeight);
 
-                {
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[f1.cellIndex].gEdgeVisWeight[f1.localVertexIndex] += weight * dist;
-                }
+                cellWeights.add(f1.cellIndex, CellWeight(f1.cellIndex, CellWeight::eEdgeVis, weight * dist, f1.localVertexIndex));
 
                 if(f2.cellIndex == GEO::NO_CELL)
                     ok = false;
@@ -1670,8 +1833,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         // get the outer tetrahedron of camera c for the ray to p = the last tetrahedron
         if(lastFinite != GEO::NO_CELL)
         {
-#pragma OMP_ATOMIC_WRITE
-            _cellsAttr[lastFinite].cellSWeight = (float)maxint;
+            cellWeights.add(lastFinite, CellWeight(lastFinite, CellWeight::eSWeight, (float)maxint));
         }
     }
 
@@ -1684,8 +1846,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         CellIndex ci = f1.cellIndex;
         if(ci != GEO::NO_CELL)
         {
-#pragma OMP_ATOMIC_UPDATE
-            _cellsAttr[ci].on += weight;
+            cellWeights.add(ci, CellWeight(ci, CellWeight::eOn, weight));
         }
 
         Point3d p = po; // HAS TO BE HERE !!!
@@ -1693,16 +1854,11 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         bool ok = (ci != GEO::NO_CELL) && allPoints;
         while(ok)
         {
-            GC_cellInfo& c = _cellsAttr[ci];
+            if(behind)
             {
-                if(behind)
-                {
-#pragma OMP_ATOMIC_UPDATE
-                    c.cellTWeight += weight;
-                }
-#pragma OMP_ATOMIC_UPDATE
-                c.in += weight;
+                cellWeights.add(ci, CellWeight(ci, CellWeight::eTWeight, weight));
             }
+            cellWeights.add(ci, CellWeight(ci, CellWeight::eIn, weight));
 
             ++out_nstepsBehind;
             ++nsteps;
@@ -1731,8 +1887,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
                 }
                 else
                 {
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[f2.cellIndex].gEdgeVisWeight[f2.localVertexIndex] += weight * dist;
+                    cellWeights.add(f2.cellIndex, CellWeight(f2.cellIndex, CellWeight::eEdgeVis, weight * dist, f2.localVertexIndex));
                 }
                 ci = f2.cellIndex;
             }
@@ -1743,8 +1898,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         {
             if(ci != GEO::NO_CELL)
             {
-#pragma OMP_ATOMIC_UPDATE
-                _cellsAttr[ci].cellTWeight += weight;
+                cellWeights.add(ci, CellWeight(ci, CellWeight::eTWeight, weight));
             }
         }
     }
@@ -1752,6 +1906,8 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
 
 void DelaunayGraphCut::forceTedgesByGradientCVPR11(bool fixesSigma, float nPixelSizeBehind)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::forceTedges");
+
     ALICEVISION_LOG_INFO("Forcing t-edges.");
     long t2 = clock();
 
@@ -1830,7 +1986,7 @@ void DelaunayGraphCut::forceTedgesByGradientCVPR11(bool fixesSigma, float nPixel
                     float eLast = _cellsAttr[f2.cellIndex].out;
                     if((eFirst > eLast) && (eFirst < beta) && (eLast / eFirst < delta))
                     {
-#pragma OMP_ATOMIC_UPDATE
+                        OMP_ATOMIC_UPDATE
                         _cellsAttr[ci].on += (eFirst - eLast);
                     }
                 }
@@ -1852,6 +2008,8 @@ void DelaunayGraphCut::forceTedgesByGradientCVPR11(bool fixesSigma, float nPixel
 
 void DelaunayGraphCut::forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSizeBehind)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::forceTedges");
+
     ALICEVISION_LOG_INFO("Forcing t-edges");
     long t2 = clock();
 
@@ -2012,7 +2170,7 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSi
                        (maxSilent < maxSilentPartRange)) // g < k_outl                  //// k_outl=100  // 400 in the paper
                         //(maxSilent-minSilent<maxSilentPartRange))
                     {
-#pragma OMP_ATOMIC_UPDATE
+                        OMP_ATOMIC_UPDATE
                         _cellsAttr[ci].on += (maxJump - midSilent);
                     }
                 }
@@ -2114,7 +2272,7 @@ void DelaunayGraphCut::updateGraphFromTmpPtsCamsHexahRC(int rc, Point3d hexah[8]
                 while(ok)
                 {
                     {
-#pragma OMP_ATOMIC_UPDATE
+                        OMP_ATOMIC_UPDATE
                         _cellsAttr[tmp_ci].out += weight;
                     }
 
@@ -2134,7 +2292,7 @@ void DelaunayGraphCut::updateGraphFromTmpPtsCamsHexahRC(int rc, Point3d hexah[8]
                         }
                         else
                         {
-#pragma OMP_ATOMIC_UPDATE
+                            OMP_ATOMIC_UPDATE
                             _cellsAttr[f2.cellIndex].gEdgeVisWeight[f2.localVertexIndex] += weight;
                         }
                         tmp_ci = f2.cellIndex;
@@ -2198,6 +2356,8 @@ int DelaunayGraphCut::setIsOnSurface()
 
 void DelaunayGraphCut::graphCutPostProcessing()
 {
+    ALICEVISION_PROFILE_ZONE("meshing::graphCutPostProcessing");
+
     long timer = std::clock();
     ALICEVISION_LOG_INFO("Graph cut post-processing.");
     invertFullStatusForSmallLabels();
@@ -2372,6 +2532,9 @@ void DelaunayGraphCut::invertFullStatusForSmallLabels()
 
 void DelaunayGraphCut::createDensePointCloudFromDepthMaps(Point3d hexah[8], const StaticVector<int>& cams, StaticVector<int>* voxelsIds, VoxelsGrid* ls, const FuseParams& fuseParams)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::densePointCloud");
+    ALICEVISION_MEMORY_PHASE("meshing::densePointCloud");
+
   // Load tracks
   ALICEVISION_LOG_INFO("Creating delaunay tetrahedralization from depth maps voxel");
 
@@ -2399,6 +2562,9 @@ void DelaunayGraphCut::createDensePointCloudFromDepthMaps(Point3d hexah[8], cons
 
 void DelaunayGraphCut::createDensePointCloudFromSfM(const Point3d hexah[8], const StaticVector<int>& cams, const sfmData::SfMData& sfmData)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::densePointCloud");
+    ALICEVISION_MEMORY_PHASE("meshing::densePointCloud");
+
   // Load tracks
   float minDist = hexah ? (hexah[0] - hexah[1]).size() / 1000.0f : 0.00001f;
 
@@ -2456,6 +2622,9 @@ void DelaunayGraphCut::createDensePointCloudFromSfM(const Point3d hexah[8], cons
 
 void DelaunayGraphCut::createGraphCut(Point3d hexah[8], const StaticVector<int>& cams, VoxelsGrid* ls, const std::string& folderName, const std::string& tmpCamsPtsFolderName, bool removeSmallSegments, const Point3d& spaceSteps)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::graphCut");
+    ALICEVISION_MEMORY_PHASE("meshing::graphCut");
+
   initVertices();
 
   // Create tetrahedralization
@@ -2510,6 +2679,14 @@ void DelaunayGraphCut::reconstructGC(const Point3d* hexah)
 
 void DelaunayGraphCut::maxflow()
 {
+    ALICEVISION_PROFILE_ZONE("meshing::maxflow");
+
+    if(mp->userParams.get<bool>("delaunaycut.parallelMaxflow", true))
+    {
+        maxflowParallel();
+        return;
+    }
+
     long t_maxflow = clock();
 
     ALICEVISION_LOG_INFO("Maxflow: start allocation.");
@@ -2593,6 +2770,78 @@ void DelaunayGraphCut::maxflow()
     ALICEVISION_LOG_INFO("Maxflow: done.");
 }
 
+void DelaunayGraphCut::maxflowParallel()
+{
+    ALICEVISION_PROFILE_ZONE("meshing::maxflow");
+
+    PhaseLog phase;
+
+    ALICEVISION_LOG_INFO("Maxflow: build the graph.");
+    const std::size_t nbCells = _cellsAttr.size();
+    MaxFlow_PushRelabel maxFlowGraph(nbCells, 4);
+
+    const float CONSTalphaVIS = 1.0f;
+    const float CONSTalphaPHOTO = 5.0f;
+
+    // each cell only sets its own s-t edges and its 4 facet edges,
+    // the reverse edge is set by the adjacent cell through the mirror facet
+    #pragma omp parallel for
+    for(int ci = 0; ci < static_cast<int>(nbCells); ++ci)
+    {
+        const GC_cellInfo& c = _cellsAttr[ci];
+        assert(c.cellSWeight >= 0.0f && c.cellTWeight >= 0.0f);
+        maxFlowGraph.addNode(ci, c.cellSWeight, c.cellTWeight);
+
+        const bool isInfinite = isInfiniteCell(ci);
+        for(VertexIndex k = 0; k < 4; ++k)
+        {
+            const Facet fu(ci, k);
+            const Facet fv = mirrorFacet(fu);
+            if(fv.cellIndex == GEO::NO_CELL)
+                continue;
+            const bool isMirrorInfinite = isInfiniteCell(fv.cellIndex);
+            if(isInfinite && isMirrorInfinite)
+                continue;
+
+            // score for each facet based on the quality of the topology
+            const float a = (isInfinite || isMirrorInfinite) ? 0.0f : getFaceWeight(fv);
+            const float w = _cellsAttr[fv.cellIndex].gEdgeVisWeight[fv.localVertexIndex] * CONSTalphaVIS + a * CONSTalphaPHOTO;
+            assert(w >= 0.0f);
+
+            // same capacities as MaxFlow_AdjList, where the edges between two finite cells
+            // are added from both cells and the edges with an infinite cell only from one
+            const float nbEdges = (isInfinite || isMirrorInfinite) ? 1.0f : 2.0f;
+            maxFlowGraph.addEdge(ci, k, fv.cellIndex, fv.localVertexIndex, w * nbEdges);
+        }
+    }
+    phase.log("Maxflow graph");
+
+    ALICEVISION_LOG_INFO("Maxflow: clear cells info.");
+    std::vector<GC_cellInfo>().swap(_cellsAttr); // force clear
+
+    const std::string graphFilepath = mp->userParams.get<std::string>("delaunaycut.maxflowGraphFilepath", "");
+    if(!graphFilepath.empty())
+    {
+        ALICEVISION_LOG_INFO("Maxflow: save the graph: " << graphFilepath);
+        maxFlowGraph.save(graphFilepath);
+    }
+
+    phase.reset();
+    ALICEVISION_LOG_INFO("Maxflow: compute.");
+    const float totalFlow = maxFlowGraph.compute();
+    phase.log("Maxflow computation");
+    ALICEVISION_LOG_INFO("totalFlow: " << totalFlow);
+
+    ALICEVISION_LOG_INFO("Maxflow: update full/empty cells status.");
+    _cellIsFull.resize(nbCells);
+    for(CellIndex ci = 0; ci < nbCells; ++ci)
+    {
+        _cellIsFull[ci] = maxFlowGraph.isTarget(ci);
+    }
+
+    ALICEVISION_LOG_INFO("Maxflow: done.");
+}
+
 void DelaunayGraphCut::reconstructExpetiments(const StaticVector<int>& cams, const std::string& folderName,
                                             bool update, Point3d* hexahInflated, const std::string& tmpCamsPtsFolderName,
                                             const Point3d& spaceSteps)
@@ -14,6 +14,7 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
 #include <aliceVision/fuseCut/delaunayGraphCutTypes.hpp>
+#include <aliceVision/fuseCut/RangeBuffers.hpp>
 #include <aliceVision/fuseCut/VoxelsGrid.hpp>
 
 #include <geogram/delaunay/delaunay.h>
@@ -21,6 +22,7 @@
 #include <geogram/mesh/mesh.h>
 #include <geogram/basic/geometry_nd.h>
 
+#include <cstdint>
 #include <map>
 #include <set>
 
@@ -75,6 +77,37 @@ public:
         VertexIndex localVertexIndex = GEO::NO_VERTEX;
     };
 
+    /**
+     * @brief Contribution of a ray to the weights of a cell, accumulated per thread by fillGraph
+     */
+    struct CellWeight
+    {
+        enum EType : std::uint8_t
+        {
+            eOut,
+            eIn,
+            eOn,
+            eTWeight,
+            /// set the cellSWeight
+            eSWeight,
+            /// add to the gEdgeVisWeight of the facet
+            eEdgeVis
+        };
+
+        CellWeight() {}
+        CellWeight(CellIndex ci, EType t, float w, std::uint8_t f = 0)
+            : cellIndex(ci)
+            , type(t)
+            , facet(f)
+            , weight(w)
+        {}
+
+        CellIndex cellIndex = GEO::NO_CELL;
+        EType type = eOut;
+        std::uint8_t facet = 0;
+        float weight = 0.0f;
+    };
+
     mvsUtils::MultiViewParams* mp;
 
     GEO::Delaunay_var _tetrahedralization;
@@ -88,7 +121,10 @@ public:
     std::vector<bool> _cellIsFull;
 
     std::vector<int> _camsVertexes;
-    std::vector<std::vector<CellIndex>> _neighboringCellsPerVertex;
+    /// Vertex to cells cache stored as CSR arrays: the cells around the vertex vi are
+    /// _neighboringCells[_neighboringCellsOffsets[vi]] ... _neighboringCells[_neighboringCellsOffsets[vi + 1] - 1]
+    std::vector<std::size_t> _neighboringCellsOffsets;
+    std::vector<CellIndex> _neighboringCells;
 
     bool saveTemporaryBinFiles;
 
@@ -186,36 +222,10 @@ public:
         return out;
     }
 
-    void updateVertexToCellsCache()
-    {
-        _neighboringCellsPerVertex.clear();
-
-        std::map<VertexIndex, std::set<CellIndex>> neighboringCellsPerVertexTmp;
-        int coutInvalidVertices = 0;
-        for(CellIndex ci = 0, nbCells = _tetrahedralization->nb_cells(); ci < nbCells; ++ci)
-        {
-            for(VertexIndex k = 0; k < 4; ++k)
-            {
-                CellIndex vi = _tetrahedralization->cell_vertex(ci, k);
-                if(vi == GEO::NO_VERTEX || vi >= _verticesCoords.size())
-                {
-                    ++coutInvalidVertices;
-                    continue;
-                }
-                neighboringCellsPerVertexTmp[vi].insert(ci);
-            }
-        }
-        ALICEVISION_LOG_INFO("coutInvalidVertices: " << coutInvalidVertices);
-        ALICEVISION_LOG_INFO("neighboringCellsPerVertexTmp: " << neighboringCellsPerVertexTmp.size());
-        _neighboringCellsPerVertex.resize(_verticesCoords.size());
-        ALICEVISION_LOG_INFO("verticesCoords: " << _verticesCoords.size());
-        for(const auto& it: neighboringCellsPerVertexTmp)
-        {
-            const std::set<CellIndex>& input = it.second;
-            std::vector<CellIndex>& output = _neighboringCellsPerVertex[it.first];
-            output.assign(input.begin(), input.end());
-        }
-    }
+    /**
+     * @brief Build the vertex to cells cache in parallel, the cells around each vertex are sorted.
+     */
+    void updateVertexToCellsCache();
 
     /**
      * @brief vertexToCells
@@ -228,10 +238,17 @@ public:
      */
     CellIndex vertexToCells(VertexIndex vi, int lvi) const
     {
-        const std::vector<CellIndex>& localCells = _neighboringCellsPerVertex.at(vi);
-        if(lvi >= localCells.size())
+        const std::size_t end = _neighboringCellsOffsets.at(vi + 1);
+        const std::size_t index = _neighboringCellsOffsets[vi] + lvi;
+        if(index >= end)
             return GEO::NO_CELL;
-        return localCells[lvi];
+        return _neighboringCells[index];
+    }
+
+    /// Get the number of cells around the vertex vi
+    inline std::size_t getNbNeighboringCells(VertexIndex vi) const
+    {
+        return _neighboringCellsOffsets[vi + 1] - _neighboringCellsOffsets[vi];
     }
 
     void initVertices();
@@ -240,6 +257,8 @@ public:
     void displayStatistics();
 
     void saveDhInfo(const std::string& fileNameInfo);
+    /// load the vertices and cells info saved by saveDhInfo for the same tetrahedralization
+    void loadDhInfo(const std::string& fileNameInfo);
     void saveDh(const std::string& fileNameDh, const std::string& fileNameInfo);
 
     StaticVector<StaticVector<int>*>* createPtsCams();
@@ -292,7 +311,7 @@ public:
                            bool fillOut, float distFcnHeight = 0.0f);
     void fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBehind, int vertexIndex, int cam, float weight,
                            bool fixesSigma, float nPixelSizeBehind, bool allPoints, bool behind, bool fillOut,
-                           float distFcnHeight);
+                           float distFcnHeight, RangeBuffers<CellWeight>& cellWeights);
 
     void forceTedgesByGradientCVPR11(bool fixesSigma, float nPixelSizeBehind);
     void forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSizeBehind);
@@ -312,6 +331,12 @@ public:
 
     void maxflow();
 
+    /**
+     * @brief Build the maxflow graph from the cells in parallel and solve it with MaxFlow_PushRelabel,
+     * the labeling of the cells is the same as the sequential boykov_kolmogorov maxflow.
+     */
+    void maxflowParallel();
+
     void reconstructExpetiments(const StaticVector<int>& cams, const std::string& folderName,
                                 bool update, Point3d hexahInflated[8], const std::string& tmpCamsPtsFolderName,
                                 const Point3d& spaceSteps);
@@ -0,0 +1,217 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DepthMapsCache.hpp"
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/imageIO/image.hpp>
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace fuseCut {
+
+static std::size_t getBytes(const DepthMapsCache::DepthMapPtr& depthMap)
+{
+    return depthMap ? depthMap->size() * sizeof(float) : 0;
+}
+
+DepthMapsCache::DepthMapsCache(const mvsUtils::MultiViewParams* mp, std::size_t maxBytes)
+    : _readDepthMap([mp](int cam, StaticVector<float>& depthMap)
+        {
+            int width, height;
+            imageIO::readImage(mvsUtils::getFileNameFromIndex(mp, cam, mvsUtils::EFileType::depthMap, 1), width, height, depthMap.getDataWritable());
+            // transpose image in-place, width/height are no more valid after this function.
+            imageIO::transposeImage(width, height, depthMap.getDataWritable());
+        })
+    , _maxBytes(maxBytes)
+    , _budgetListener([this](std::size_t bytes) { shrink(bytes); })
+{}
+
+DepthMapsCache::DepthMapsCache(const ReadFunction& readDepthMap, std::size_t maxBytes)
+    : _readDepthMap(readDepthMap)
+    , _maxBytes(maxBytes)
+    , _budgetListener([this](std::size_t bytes) { shrink(bytes); })
+{}
+
+DepthMapsCache::~DepthMapsCache()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    system::MemoryTracker::getInstance().release(_bytes);
+    _bytes = 0;
+}
+
+void DepthMapsCache::setNbUses(const std::map<int, int>& nbUses)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(const auto& camNbUses : nbUses)
+        _entries[camNbUses.first].nbPendingUses += camNbUses.second;
+}
+
+DepthMapsCache::DepthMapPtr DepthMapsCache::acquire(int cam)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // the entries are only erased when they have no active use, so this reference stays valid
+    Entry& entry = _entries[cam];
+    ++entry.nbActiveUses;
+
+    while(entry.loading)
+        _loaded.wait(lock);
+
+    if(entry.depthMap)
+        return entry.depthMap;
+
+    entry.loading = true;
+    lock.unlock();
+
+    std::shared_ptr<StaticVector<float>> depthMap = std::make_shared<StaticVector<float>>();
+    try
+    {
+        _readDepthMap(cam, *depthMap);
+    }
+    catch(...)
+    {
+        lock.lock();
+        entry.loading = false;
+        --entry.nbActiveUses;
+        _loaded.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    entry.depthMap = depthMap;
+    entry.loading = false;
+    _bytes += getBytes(entry.depthMap);
+    system::MemoryTracker::getInstance().allocate(getBytes(entry.depthMap));
+    ++_nbReads;
+    _loaded.notify_all();
+
+    evict(_maxBytes);
+    return entry.depthMap;
+}
+
+void DepthMapsCache::release(int cam)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto it = _entries.find(cam);
+    if(it == _entries.end())
+        return;
+
+    Entry& entry = it->second;
+    --entry.nbActiveUses;
+    if(entry.nbPendingUses > 0)
+        --entry.nbPendingUses;
+
+    if(entry.nbActiveUses == 0 && entry.nbPendingUses == 0)
+    {
+        // last use
+        _bytes -= getBytes(entry.depthMap);
+        system::MemoryTracker::getInstance().release(getBytes(entry.depthMap));
+        _entries.erase(it);
+        return;
+    }
+    evict(_maxBytes);
+}
+
+std::size_t DepthMapsCache::shrink(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const std::size_t previousBytes = _bytes;
+    evict(previousBytes - std::min(previousBytes, bytes));
+    return previousBytes - _bytes;
+}
+
+int DepthMapsCache::getNbReads() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nbReads;
+}
+
+void DepthMapsCache::evict(std::size_t maxBytes)
+{
+    while(_bytes > maxBytes)
+    {
+        // unused map with the fewest pending uses
+        Entry* evicted = nullptr;
+        for(auto& camEntry : _entries)
+        {
+            Entry& entry = camEntry.second;
+            if(!entry.depthMap || entry.nbActiveUses > 0)
+                continue;
+            if(evicted == nullptr || entry.nbPendingUses < evicted->nbPendingUses)
+                evicted = &entry;
+        }
+        if(evicted == nullptr)
+            return;
+
+        _bytes -= getBytes(evicted->depthMap);
+        system::MemoryTracker::getInstance().release(getBytes(evicted->depthMap));
+        evicted->depthMap.reset();
+    }
+}
+
+std::vector<int> orderJobsByDepthMapsReuse(const std::vector<std::vector<int>>& jobsDepthMaps)
+{
+    const int nbJobs = jobsDepthMaps.size();
+
+    // jobs reading each depth map
+    std::map<int, std::vector<int>> depthMapsJobs;
+    for(int j = 0; j < nbJobs; ++j)
+        for(const int cam : jobsDepthMaps[j])
+            depthMapsJobs[cam].push_back(j);
+
+    std::vector<int> order;
+    order.reserve(nbJobs);
+    std::vector<bool> scheduled(nbJobs, false);
+    std::vector<int> nbSharedMaps(nbJobs, 0);
+    std::vector<int> candidates;
+    int firstUnscheduled = 0;
+    int job = -1;
+
+    while(static_cast<int>(order.size()) < nbJobs)
+    {
+        if(job == -1)
+        {
+            // no remaining job shares a map with the last one
+            while(scheduled[firstUnscheduled])
+                ++firstUnscheduled;
+            job = firstUnscheduled;
+        }
+        scheduled[job] = true;
+        order.push_back(job);
+
+        candidates.clear();
+        for(const int cam : jobsDepthMaps[job])
+        {
+            for(const int j : depthMapsJobs[cam])
+            {
+                if(scheduled[j])
+                    continue;
+                if(nbSharedMaps[j] == 0)
+                    candidates.push_back(j);
+                ++nbSharedMaps[j];
+            }
+        }
+
+        int nextJob = -1;
+        for(const int j : candidates)
+        {
+            if(nextJob == -1 || nbSharedMaps[j] > nbSharedMaps[nextJob] ||
+               (nbSharedMaps[j] == nbSharedMaps[nextJob] && j < nextJob))
+                nextJob = j;
+        }
+        for(const int j : candidates)
+            nbSharedMaps[j] = 0;
+        job = nextJob;
+    }
+    return order;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
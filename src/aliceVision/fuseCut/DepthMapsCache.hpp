@@ -0,0 +1,118 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace aliceVision {
+
+namespace mvsUtils {
+class MultiViewParams;
+} // namespace mvsUtils
+
+namespace fuseCut {
+
+/**
+ * @brief Cache of the depth maps shared by the threads processing the cameras.
+ *
+ * Each depth map has a reference count of its pending uses, given by setNbUses(). A map is read once
+ * when it is first acquired, kept while other uses are pending and released after its last use.
+ * When the maps kept exceed the byte budget, the unused maps with the fewest pending uses are
+ * evicted (they are read again if needed). The maps being used are never evicted, so the budget
+ * can be exceeded by the maps used at the same time by the threads.
+ * The maps are accounted in the MemoryTracker, and the unused maps are evicted when the memory
+ * budget of the process is exceeded.
+ */
+class DepthMapsCache
+{
+public:
+    typedef std::shared_ptr<const StaticVector<float>> DepthMapPtr;
+    /// function reading the depth map of a camera
+    typedef std::function<void(int, StaticVector<float>&)> ReadFunction;
+
+    /**
+     * @brief Cache of the transposed depth maps at scale 1 of the cameras
+     */
+    DepthMapsCache(const mvsUtils::MultiViewParams* mp, std::size_t maxBytes);
+
+    DepthMapsCache(const ReadFunction& readDepthMap, std::size_t maxBytes);
+
+    ~DepthMapsCache();
+
+    DepthMapsCache(const DepthMapsCache&) = delete;
+    DepthMapsCache& operator=(const DepthMapsCache&) = delete;
+
+    /**
+     * @brief Set the number of times each depth map will be acquired
+     */
+    void setNbUses(const std::map<int, int>& nbUses);
+
+    /**
+     * @brief Get the depth map of a camera, it is read if it is not in the cache.
+     * Concurrent acquisitions of the same map wait for a single read.
+     * Each acquisition must be followed by a release.
+     */
+    DepthMapPtr acquire(int cam);
+
+    /**
+     * @brief Release a use of the depth map of a camera
+     */
+    void release(int cam);
+
+    /**
+     * @brief Evict unused depth maps to free memory, the budget is not changed
+     * @param[in] bytes the number of bytes to free
+     * @return the number of bytes freed
+     */
+    std::size_t shrink(std::size_t bytes);
+
+    /// number of depth maps read
+    int getNbReads() const;
+
+private:
+    struct Entry
+    {
+        DepthMapPtr depthMap;
+        bool loading = false;
+        int nbActiveUses = 0;
+        int nbPendingUses = 0;
+    };
+
+    /// evict unused maps until the maps kept fit in maxBytes
+    void evict(std::size_t maxBytes);
+
+    ReadFunction _readDepthMap;
+    const std::size_t _maxBytes;
+    std::size_t _bytes = 0;
+    int _nbReads = 0;
+
+    std::map<int, Entry> _entries;
+    mutable std::mutex _mutex;
+    std::condition_variable _loaded;
+    /// removed first, before the destruction of the cache
+    system::ScopedBudgetListener _budgetListener;
+};
+
+/**
+ * @brief Order jobs reading depth maps so that consecutive jobs read the same maps,
+ * each job is followed by the remaining job sharing the most maps with it.
+ * @param[in] jobsDepthMaps the cameras of the depth maps read by each job
+ * @return the job indexes in processing order
+ */
+std::vector<int> orderJobsByDepthMapsReuse(const std::vector<std::vector<int>>& jobsDepthMaps);
+
+} // namespace fuseCut
+} // namespace aliceVision
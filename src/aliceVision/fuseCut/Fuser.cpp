@@ -5,7 +5,10 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Fuser.hpp"
+#include <aliceVision/fuseCut/depthMapReprojection.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/Pixel.hpp>
@@ -13,6 +16,7 @@
 #include <aliceVision/mvsData/Stat3d.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/mvsUtils/depthSimMapStorage.hpp>
 #include <aliceVision/imageIO/image.hpp>
 #include <aliceVision/imageIO/imageScaledColors.hpp>
 
@@ -20,6 +24,7 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
 
+#include <cmath>
 #include <iostream>
 
 namespace aliceVision {
@@ -68,81 +73,97 @@ Fuser::~Fuser()
 
 
 /**
- * @brief 
- * 
- * @param[in]
- * @param[in]
+ * @brief Count the pixels around a cell of the rc depth map which are consistent with a 3D point of tc
+ *
  * @param[in] p: 3d point back projected from tc camera
- * @param[in]
- * @param[in]
+ * @param[in] cell: projection of p in rc
+ * @param[in] pixDepth: depth of p in rc
  * @param[out] numOfPtsMap
  * @param[in] depthMap
  * @param[in] simMap
- * @param[in] scale
  */
-bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc,
-                           StaticVector<int>* numOfPtsMap, StaticVector<float>* depthMap, StaticVector<float>* simMap,
-                           int scale)
+void Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, const Point3d& p, const Pixel& cell, float pixDepth, int rc, int tc,
+                         StaticVector<int>* numOfPtsMap, const StaticVector<float>& depthMap, const StaticVector<float>& simMap)
 {
-    int w = mp->getWidth(rc) / scale;
-    int h = mp->getHeight(rc) / scale;
-
-    Pixel pix;
-    mp->getPixelFor3DPoint(&pix, p, rc);
-    if(!mp->isPixelInImage(pix, rc))
-    {
-        return false;
-    }
-
-    Pixel cell = pix;
-    cell.x /= scale;
-    cell.y /= scale;
-
-    float pixDepth = (mp->CArr[rc] - p).size();
+    int w = mp->getWidth(rc);
+    int h = mp->getHeight(rc);
 
     int d = pixSizeBall;
 
-    float sim = (*simMap)[cell.x * h + cell.y];
+    float sim = simMap[cell.x * h + cell.y];
     if(sim >= 1.0f)
     {
         d = pixSizeBallWSP;
     }
 
     // float pixSize = 2.0f*(float)std::max(d,1)*mp->getCamPixelSize(p,cam);
-    float pixSize = 2.0f * mp->getCamPixelSizePlaneSweepAlpha(p, rc, tc, scale, 1);
+    float pixSize = 2.0f * mp->getCamPixelSizePlaneSweepAlpha(p, rc, tc, 1, 1);
 
     Pixel ncell;
     for(ncell.x = std::max(0, cell.x - d); ncell.x <= std::min(w - 1, cell.x + d); ncell.x++)
     {
         for(ncell.y = std::max(0, cell.y - d); ncell.y <= std::min(h - 1, cell.y + d); ncell.y++)
         {
-            // printf("%i %i %i %i %i %i %i %i\n",ncell.x,ncell.y,w,h,w*h,depthMap->size(),cam,scale);
-            float depth = (*depthMap)[ncell.x * h + ncell.y];
-            // Point3d p1 = mp->CArr[rc] +
-            // (mp->iCamArr[rc]*Point2d((float)ncell.x*(float)scale,(float)ncell.y*(float)scale)).normalize()*depth;
-            // if ( (p1-p).size() < pixSize ) {
+            float depth = depthMap[ncell.x * h + ncell.y];
             if(fabs(pixDepth - depth) < pixSize)
             {
                 (*numOfPtsMap)[ncell.x * h + ncell.y]++;
             }
         }
     }
-
-    return true;
 }
 
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
 void Fuser::filterGroups(const StaticVector<int>& cams, int pixSizeBall, int pixSizeBallWSP, int nNearestCams)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::filterGroups");
+
     ALICEVISION_LOG_INFO("Precomputing groups.");
     long t1 = clock();
-#pragma omp parallel for
+
+    std::vector<int> rcams;
     for(int c = 0; c < cams.size(); c++)
     {
-        int rc = cams[c];
-        filterGroupsRC(rc, pixSizeBall, pixSizeBallWSP, nNearestCams);
+        if(!mvsUtils::FileExists(getFileNameFromIndex(mp, cams[c], mvsUtils::EFileType::nmodMap)))
+            rcams.push_back(cams[c]);
+    }
+
+    // depth maps read by each camera: its own one and the ones of its neighbour cameras
+    std::vector<StaticVector<int>> tcams(rcams.size());
+    std::vector<std::vector<int>> depthMapsCams(rcams.size());
+#pragma omp parallel for
+    for(int c = 0; c < rcams.size(); c++)
+    {
+        tcams[c] = mp->findNearestCamsFromLandmarks(rcams[c], nNearestCams);
+        depthMapsCams[c].push_back(rcams[c]);
+        for(const int tc : tcams[c])
+            depthMapsCams[c].push_back(tc);
     }
 
+    std::map<int, int> nbUses;
+    for(const std::vector<int>& depthMaps : depthMapsCams)
+    {
+        for(const int cam : depthMaps)
+            ++nbUses[cam];
+    }
+
+    // within the memory budget of the process
+    const std::size_t maxBytes = std::min(static_cast<std::size_t>(mp->userParams.get<int>("depthMapsCache.maxMB", 2048)) * 1024 * 1024,
+                                          system::MemoryTracker::getInstance().getAvailableMemory());
+    DepthMapsCache depthMapsCache(mp, maxBytes);
+    depthMapsCache.setNbUses(nbUses);
+
+    const std::vector<int> order = orderJobsByDepthMapsReuse(depthMapsCams);
+
+    // dynamic schedule: the threads process consecutive cameras of the order at the same time
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int i = 0; i < order.size(); i++)
+    {
+        const int c = order[i];
+        filterGroupsRC(rcams[c], pixSizeBall, pixSizeBallWSP, tcams[c], depthMapsCache);
+    }
+
+    ALICEVISION_LOG_INFO(depthMapsCache.getNbReads() << " depth map reads for " << nbUses.size() << " depth maps.");
     mvsUtils::printfElapsedTime(t1);
 }
 
@@ -154,20 +175,28 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
         return true;
     }
 
+    const StaticVector<int> tcams = mp->findNearestCamsFromLandmarks(rc, nNearestCams);
+
+    // the depth maps are not kept after their use
+    DepthMapsCache depthMapsCache(mp, 0);
+    return filterGroupsRC(rc, pixSizeBall, pixSizeBallWSP, tcams, depthMapsCache);
+}
+
+bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, const StaticVector<int>& tcams, DepthMapsCache& depthMapsCache)
+{
     long t1 = clock();
     int w = mp->getWidth(rc);
     int h = mp->getHeight(rc);
 
-    StaticVector<float> depthMap;
+    const DepthMapsCache::DepthMapPtr depthMapPtr = depthMapsCache.acquire(rc);
+    const StaticVector<float>& depthMap = *depthMapPtr;
     StaticVector<float> simMap;
 
     {
         int width, height;
 
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap.getDataWritable());
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap.getDataWritable());
+        mvsUtils::readSimMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap.getDataWritable());
 
-        imageIO::transposeImage(width, height, depthMap.getDataWritable());
         imageIO::transposeImage(width, height, simMap.getDataWritable());
     }
 
@@ -175,6 +204,7 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
 
     if((depthMap.empty()) || (simMap.empty()) || (depthMap.size() != w * h) || (simMap.size() != w * h))
     {
+        depthMapsCache.release(rc);
         std::stringstream s;
         s << "filterGroupsRC: bad image dimension for camera: " << mp->getViewId(rc) << "\n";
         s << "depthMap size: " << depthMap.size() << ", simMap size: " << simMap.size() << ", width: " << w << ", height: " << h;
@@ -185,45 +215,41 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
     numOfPtsMap->reserve(w * h);
     numOfPtsMap->resize_with(w * h, 0);
 
-    StaticVector<int> tcams = mp->findNearestCamsFromLandmarks(rc, nNearestCams);
+    const Matrix3x4& rcP = mp->camArr[rc];
+    const Point3d& rcC = mp->CArr[rc];
+    const double minX = mp->g_border;
+    const double maxX = w - mp->g_border;
+    const double minY = mp->g_border;
+    const double maxY = h - mp->g_border;
 
     for(int c = 0; c < tcams.size(); c++)
     {
         numOfPtsMap->resize_with(w * h, 0);
         int tc = tcams[c];
 
-        StaticVector<float> tcdepthMap;
-
-        {
-            int width, height;
-
-            imageIO::readImage(getFileNameFromIndex(mp, tc, mvsUtils::EFileType::depthMap, 1), width, height, tcdepthMap.getDataWritable());
-
-            // transpose image in-place, width/height are no more valid after this function.
-            imageIO::transposeImage(width, height, tcdepthMap.getDataWritable());
-        }
+        const DepthMapsCache::DepthMapPtr tcdepthMapPtr = depthMapsCache.acquire(tc);
+        const StaticVector<float>& tcdepthMap = *tcdepthMapPtr;
 
         if(!tcdepthMap.empty())
         {
-            for(int i = 0; i < sizeOfStaticVector<float>(&tcdepthMap); i++)
+            // the tc depth map has the size of tc
+            reprojectDepthMap(tcdepthMap, mp->getHeight(tc), mp->iCamArr[tc], mp->CArr[tc], rcP, rcC, minX, maxX, minY, maxY,
+                              [&](const Point3d& p, const Pixel& cell, float pixDepth)
             {
-                int x = i / h;
-                int y = i % h;
-                float depth = tcdepthMap[i];
-                if(depth > 0.0f)
-                {
-                    Point3d p = mp->CArr[tc] + (mp->iCamArr[tc] * Point2d((float)x, (float)y)).normalize() * depth;
-                    updateInSurr(pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, &depthMap, &simMap, 1);
-                }
-            }
+                updateInSurr(pixSizeBall, pixSizeBallWSP, p, cell, pixDepth, rc, tc, numOfPtsMap, depthMap, simMap);
+            });
 
             for(int i = 0; i < w * h; i++)
             {
                 numOfModalsMap.at(i) += static_cast<int>((*numOfPtsMap)[i] > 0);
             }
         }
+
+        depthMapsCache.release(tc);
     }
 
+    depthMapsCache.release(rc);
+
     {
       imageIO::transposeImage(h, w, numOfModalsMap);
       imageIO::writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap), w, h, numOfModalsMap);
@@ -242,6 +268,9 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
 void Fuser::filterDepthMaps(const StaticVector<int>& cams, int minNumOfModals, int minNumOfModalsWSP2SSP)
 {
+    ALICEVISION_PROFILE_ZONE("meshing::filterDepthMaps");
+    ALICEVISION_MEMORY_PHASE("meshing::filterDepthMaps");
+
     ALICEVISION_LOG_INFO("Filtering depth maps.");
     long t1 = clock();
 
@@ -270,7 +299,7 @@ bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2
         int width, height;
 
         imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap);
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap);
+        mvsUtils::readSimMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap);
         imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap), width, height, numOfModalsMap);
 
         imageIO::transposeImage(width, height, depthMap);
@@ -322,8 +351,8 @@ bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2
         metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, matrixP.data()));
     }
 
-    imageIO::writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 0), w, h, depthMap, imageIO::EImageQuality::LOSSLESS, metadata);
-    imageIO::writeImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 0), w, h, simMap);
+    mvsUtils::writeDepthSimMaps(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 0), getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 0),
+                                w, h, depthMap, simMap, metadata, mvsUtils::getDepthMapStorage(mp));
 
     if(mp->verbose)
         ALICEVISION_LOG_DEBUG(rc << " solved.");
@@ -766,7 +795,7 @@ std::string generateTempPtsSimsFiles(std::string tmpDir, mvsUtils::MultiViewPara
                 int width, height;
 
                 imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, scale), width, height, depthMap.getDataWritable());
-                imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale), width, height, simMap.getDataWritable());
+                mvsUtils::readSimMap(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, scale), width, height, simMap.getDataWritable());
 
                 imageIO::transposeImage(width, height, depthMap.getDataWritable());
                 imageIO::transposeImage(width, height, simMap.getDataWritable());
@@ -7,10 +7,12 @@
 #pragma once
 
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/Universe.hpp>
 #include <aliceVision/mvsData/Voxel.hpp>
+#include <aliceVision/fuseCut/DepthMapsCache.hpp>
 
 namespace aliceVision {
 
@@ -30,8 +32,11 @@ public:
 
     // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,... default 3
     // pixSizeBall = default 2
+    // The cameras are ordered so that consecutive cameras share their neighbour cameras and the depth maps
+    // are shared in a cache bounded by the "depthMapsCache.maxMB" user parameter.
     void filterGroups(const StaticVector<int>& cams, int pixSizeBall, int pixSizeBallWSP, int nNearestCams);
     bool filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNearestCams);
+    bool filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, const StaticVector<int>& tcams, DepthMapsCache& depthMapsCache);
     void filterDepthMaps(const StaticVector<int>& cams, int minNumOfModals, int minNumOfModalsWSP2SSP);
     bool filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2SSP);
 
@@ -45,8 +50,8 @@ public:
     Voxel estimateDimensions(Point3d* vox, Point3d* newSpace, int scale, int maxOcTreeDim, const sfmData::SfMData* sfmData = nullptr);
 
 private:
-    bool updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc, StaticVector<int>* numOfPtsMap,
-                      StaticVector<float>* depthMap, StaticVector<float>* simMap, int scale);
+    void updateInSurr(int pixSizeBall, int pixSizeBallWSP, const Point3d& p, const Pixel& cell, float pixDepth, int rc, int tc,
+                      StaticVector<int>* numOfPtsMap, const StaticVector<float>& depthMap, const StaticVector<float>& simMap);
 };
 
 unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams* mp, int scale);
@@ -0,0 +1,383 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MaxFlow_PushRelabel.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace {
+
+using NodeType = MaxFlow_PushRelabel::NodeType;
+
+/**
+ * @brief Atomically replace the value and return the previous one.
+ */
+inline NodeType atomicExchange(NodeType& x, NodeType value)
+{
+    NodeType previous;
+#if defined _OPENMP && _OPENMP >= 201107
+    #pragma omp atomic capture
+    { previous = x; x = value; }
+#else
+    #pragma omp critical(MaxFlow_PushRelabel_atomicExchange)
+    { previous = x; x = value; }
+#endif
+    return previous;
+}
+
+inline NodeType atomicRead(const NodeType& x)
+{
+    NodeType value;
+#if defined _OPENMP && _OPENMP >= 201107
+    #pragma omp atomic read
+    value = x;
+#else
+    #pragma omp critical(MaxFlow_PushRelabel_atomicExchange)
+    value = x;
+#endif
+    return value;
+}
+
+/**
+ * @brief Append the thread local nodes to the shared list, in a parallel region
+ */
+inline void appendNodes(const std::vector<NodeType>& localNodes, std::vector<NodeType>& nodes)
+{
+    #pragma omp critical(MaxFlow_PushRelabel_appendNodes)
+    nodes.insert(nodes.end(), localNodes.begin(), localNodes.end());
+}
+
+template<class T>
+void writeArray(std::ofstream& stream, const std::vector<T>& values)
+{
+    stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template<class T>
+void readArray(std::ifstream& stream, std::vector<T>& values, std::size_t size)
+{
+    values.resize(size);
+    stream.read(reinterpret_cast<char*>(values.data()), size * sizeof(T));
+}
+
+} // namespace
+
+const MaxFlow_PushRelabel::NodeType MaxFlow_PushRelabel::NO_EDGE;
+
+MaxFlow_PushRelabel::MaxFlow_PushRelabel(std::size_t numNodes, std::size_t degree)
+    : _degree(degree)
+    , _residual(numNodes * degree, 0)
+    , _reverse(numNodes * degree, NO_EDGE)
+    , _sinkResidual(numNodes, 0)
+    , _excess(numNodes, 0)
+{
+    if(numNodes * degree >= NO_EDGE)
+        throw std::runtime_error("Too many edges for the maxflow graph: " + std::to_string(numNodes * degree));
+}
+
+void MaxFlow_PushRelabel::save(const std::string& filepath) const
+{
+    std::ofstream stream(filepath, std::ios::binary);
+    if(!stream.is_open())
+        throw std::runtime_error("Unable to write the maxflow graph: " + filepath);
+
+    const std::uint64_t header[2] = {getNbNodes(), _degree};
+    stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    writeArray(stream, _excess);
+    writeArray(stream, _sinkResidual);
+    writeArray(stream, _reverse);
+    writeArray(stream, _residual);
+
+    if(!stream.good())
+        throw std::runtime_error("Error while writing the maxflow graph: " + filepath);
+}
+
+void MaxFlow_PushRelabel::load(const std::string& filepath)
+{
+    std::ifstream stream(filepath, std::ios::binary);
+    if(!stream.is_open())
+        throw std::runtime_error("Unable to read the maxflow graph: " + filepath);
+
+    std::uint64_t header[2] = {0, 0};
+    stream.read(reinterpret_cast<char*>(header), sizeof(header));
+    const std::size_t numNodes = header[0];
+    _degree = header[1];
+    readArray(stream, _excess, numNodes);
+    readArray(stream, _sinkResidual, numNodes);
+    readArray(stream, _reverse, numNodes * _degree);
+    readArray(stream, _residual, numNodes * _degree);
+    _label.clear();
+
+    if(!stream.good())
+        throw std::runtime_error("Invalid maxflow graph file: " + filepath);
+}
+
+void MaxFlow_PushRelabel::globalRelabel()
+{
+    const NodeType nbNodes = getNbNodes();
+    const NodeType unreachable = getUnreachableLabel();
+    const int nbNodesI = static_cast<int>(nbNodes);
+
+    _label.resize(nbNodes);
+    std::vector<NodeType> frontier;
+
+    // the nodes with a residual edge to the sink are at distance 1
+    #pragma omp parallel
+    {
+        std::vector<NodeType> localFrontier;
+        #pragma omp for
+        for(int n = 0; n < nbNodesI; ++n)
+        {
+            if(_sinkResidual[n] > 0)
+            {
+                _label[n] = 1;
+                localFrontier.push_back(n);
+            }
+            else
+            {
+                _label[n] = unreachable;
+            }
+        }
+        appendNodes(localFrontier, frontier);
+    }
+
+    // level synchronous breadth-first search on the reverse residual edges
+    for(NodeType distance = 2; !frontier.empty(); ++distance)
+    {
+        std::vector<NodeType> nextFrontier;
+        #pragma omp parallel
+        {
+            std::vector<NodeType> localFrontier;
+            #pragma omp for
+            for(int i = 0; i < static_cast<int>(frontier.size()); ++i)
+            {
+                const std::size_t firstEdge = frontier[i] * _degree;
+                for(std::size_t e = firstEdge; e < firstEdge + _degree; ++e)
+                {
+                    const NodeType rev = _reverse[e];
+                    if(rev == NO_EDGE || _residual[rev] <= 0)
+                        continue;
+                    const NodeType n = rev / _degree;
+                    // the nodes labeled at the previous levels are not modified,
+                    // all the threads write the same distance at this level
+                    if(atomicRead(_label[n]) != unreachable)
+                        continue;
+                    if(atomicExchange(_label[n], distance) == unreachable)
+                        localFrontier.push_back(n);
+                }
+            }
+            appendNodes(localFrontier, nextFrontier);
+        }
+        frontier.swap(nextFrontier);
+    }
+}
+
+MaxFlow_PushRelabel::ValueType MaxFlow_PushRelabel::compute()
+{
+    const NodeType nbNodes = getNbNodes();
+    const NodeType unreachable = getUnreachableLabel();
+    const int nbNodesI = static_cast<int>(nbNodes);
+
+    ALICEVISION_LOG_INFO("Compute parallel push-relabel max flow (" << nbNodes << " nodes, " << _reverse.size() << " edge slots).");
+
+    // flow pushed along each edge during the current iteration
+    std::vector<ValueType> pushed(_residual.size(), 0);
+    // last iteration where the node has been added to a list, to avoid duplicates
+    std::vector<NodeType> stamps(nbNodes, 0);
+    NodeType stamp = 0;
+
+    double totalFlow = 0.0;
+    std::size_t nbIterations = 0;
+    std::size_t nbGlobalRelabels = 0;
+    std::size_t nbRelabelsSinceGlobal = 0;
+    // recompute all the labels when the local relabels have done a comparable amount of work
+    const std::size_t globalRelabelThreshold = std::max<std::size_t>(nbNodes / 2, 1);
+
+    std::vector<NodeType> active;
+    std::vector<NodeType> receivers;
+    std::vector<NodeType> newLabels;
+    bool needGlobalRelabel = true;
+    bool exactLabels = false;
+
+    for(;;)
+    {
+        if(needGlobalRelabel)
+        {
+            globalRelabel();
+            ++nbGlobalRelabels;
+            nbRelabelsSinceGlobal = 0;
+            needGlobalRelabel = false;
+            exactLabels = true;
+
+            active.clear();
+            #pragma omp parallel
+            {
+                std::vector<NodeType> localActive;
+                #pragma omp for
+                for(int n = 0; n < nbNodesI; ++n)
+                {
+                    if(_excess[n] > 0 && _label[n] < unreachable)
+                        localActive.push_back(n);
+                }
+                appendNodes(localActive, active);
+            }
+        }
+
+        if(active.empty())
+            break;
+
+        ++nbIterations;
+        exactLabels = false;
+        const int nbActive = static_cast<int>(active.size());
+        const NodeType receiversStamp = ++stamp;
+        receivers.clear();
+        newLabels.assign(nbActive, 0);
+
+        // push the excess along the admissible edges with the labels of the previous iteration.
+        // An edge (u, v) and its reverse cannot be both admissible, so each edge is modified by one node.
+        #pragma omp parallel reduction(+:totalFlow)
+        {
+            std::vector<NodeType> localReceivers;
+            #pragma omp for
+            for(int i = 0; i < nbActive; ++i)
+            {
+                const NodeType n = active[i];
+                const NodeType label = _label[n];
+                ValueType excess = _excess[n];
+
+                if(label == 1 && _sinkResidual[n] > 0)
+                {
+                    const ValueType delta = std::min(excess, _sinkResidual[n]);
+                    _sinkResidual[n] = (delta == _sinkResidual[n]) ? 0 : _sinkResidual[n] - delta;
+                    excess = (delta == excess) ? 0 : excess - delta;
+                    totalFlow += delta;
+                }
+
+                const std::size_t firstEdge = n * _degree;
+                for(std::size_t e = firstEdge; e < firstEdge + _degree && excess > 0; ++e)
+                {
+                    const ValueType residual = _residual[e];
+                    if(residual <= 0)
+                        continue;
+                    const NodeType neighbor = _reverse[e] / _degree;
+                    if(_label[neighbor] + 1 != label)
+                        continue;
+
+                    const ValueType delta = std::min(excess, residual);
+                    _residual[e] = (delta == residual) ? 0 : residual - delta;
+                    excess = (delta == excess) ? 0 : excess - delta;
+                    pushed[e] = delta;
+
+                    if(atomicExchange(stamps[neighbor], receiversStamp) != receiversStamp)
+                        localReceivers.push_back(neighbor);
+                }
+                _excess[n] = excess;
+
+                // no admissible edge left, the node will be relabeled
+                if(excess > 0)
+                    newLabels[i] = unreachable;
+            }
+            appendNodes(localReceivers, receivers);
+        }
+
+        // gather the flow received by each node
+        const int nbReceivers = static_cast<int>(receivers.size());
+        #pragma omp parallel for
+        for(int i = 0; i < nbReceivers; ++i)
+        {
+            const NodeType n = receivers[i];
+            const std::size_t firstEdge = n * _degree;
+            for(std::size_t e = firstEdge; e < firstEdge + _degree; ++e)
+            {
+                const NodeType rev = _reverse[e];
+                if(rev == NO_EDGE || pushed[rev] <= 0)
+                    continue;
+                _residual[e] += pushed[rev];
+                _excess[n] += pushed[rev];
+                pushed[rev] = 0;
+            }
+        }
+
+        // relabel the nodes with the labels of the previous iteration,
+        // the labels only increase so they remain valid
+        std::size_t nbRelabels = 0;
+        #pragma omp parallel for reduction(+:nbRelabels)
+        for(int i = 0; i < nbActive; ++i)
+        {
+            if(newLabels[i] == 0)
+                continue;
+            const NodeType n = active[i];
+            NodeType label = (_sinkResidual[n] > 0) ? 1 : unreachable;
+            const std::size_t firstEdge = n * _degree;
+            for(std::size_t e = firstEdge; e < firstEdge + _degree; ++e)
+            {
+                if(_residual[e] > 0)
+                    label = std::min(label, _label[_reverse[e] / _degree] + 1);
+            }
+            newLabels[i] = label;
+            ++nbRelabels;
+        }
+        #pragma omp parallel for
+        for(int i = 0; i < nbActive; ++i)
+        {
+            if(newLabels[i] != 0)
+                _label[active[i]] = newLabels[i];
+        }
+
+        nbRelabelsSinceGlobal += nbRelabels;
+        if(nbRelabelsSinceGlobal >= globalRelabelThreshold)
+        {
+            needGlobalRelabel = true;
+            continue;
+        }
+
+        // the next active nodes are the active nodes with some remaining excess and the receivers
+        const NodeType activeStamp = ++stamp;
+        std::vector<NodeType> nextActive;
+        #pragma omp parallel
+        {
+            std::vector<NodeType> localActive;
+            #pragma omp for nowait
+            for(int i = 0; i < nbActive; ++i)
+            {
+                const NodeType n = active[i];
+                if(_excess[n] > 0 && _label[n] < unreachable && atomicExchange(stamps[n], activeStamp) != activeStamp)
+                    localActive.push_back(n);
+            }
+            #pragma omp for
+            for(int i = 0; i < nbReceivers; ++i)
+            {
+                const NodeType n = receivers[i];
+                if(_excess[n] > 0 && _label[n] < unreachable && atomicExchange(stamps[n], activeStamp) != activeStamp)
+                    localActive.push_back(n);
+            }
+            appendNodes(localActive, nextActive);
+        }
+        active.swap(nextActive);
+    }
+
+    // the labels are the distances to the sink in the final residual graph
+    if(!exactLabels)
+    {
+        globalRelabel();
+        ++nbGlobalRelabels;
+    }
+
+    ALICEVISION_LOG_INFO("Push-relabel max flow done in " << nbIterations << " iterations and " << nbGlobalRelabels << " global relabels.");
+
+    return static_cast<ValueType>(totalFlow);
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,173 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Multithreaded maxflow computation based on a synchronous push-relabel algorithm.
+ *
+ * The graph is stored in a compressed sparse row layout with a fixed number of edge slots per node
+ * (e.g. the 4 facets of a tetrahedron). The edges of different nodes can be set in parallel and
+ * the reverse of an edge is stored with it, so no lookup is needed to build the residual graph.
+ *
+ * Each iteration pushes the excess of all the active nodes in parallel with the labels of the
+ * previous iteration, then each node gathers the flow it has received and the nodes with some
+ * remaining excess are relabeled. The labels are periodically recomputed with a parallel
+ * breadth-first search from the sink. Each step only writes the data of the node it processes,
+ * so the result does not depend on the number of threads.
+ *
+ * Only the first phase of the push-relabel is done (maximum preflow), it gives the minimum cut.
+ * The target nodes are the nodes which can reach the sink in the residual graph. It is the smallest
+ * sink side of the minimum cuts, which is unique, so the labeling is the same as the one of
+ * boykov_kolmogorov_max_flow in MaxFlow_AdjList.
+ *
+ * @see MaxFlow_AdjList
+ */
+class MaxFlow_PushRelabel
+{
+public:
+    using NodeType = std::uint32_t;
+    using ValueType = float;
+
+    /// reverse edge of an empty slot
+    static const NodeType NO_EDGE = NodeType(-1);
+
+    /**
+     * @brief Create an empty graph, to be loaded from a file
+     */
+    MaxFlow_PushRelabel() = default;
+
+    /**
+     * @brief Create a graph without edges
+     * @param[in] numNodes The number of nodes, without the source and the sink
+     * @param[in] degree The number of edge slots per node
+     */
+    MaxFlow_PushRelabel(std::size_t numNodes, std::size_t degree);
+
+    inline std::size_t getNbNodes() const
+    {
+        return _excess.size();
+    }
+
+    inline std::size_t getDegree() const
+    {
+        return _degree;
+    }
+
+    /**
+     * @brief Set the capacities of the edges between the node and the terminals.
+     * It can be called in parallel on different nodes.
+     */
+    inline void addNode(NodeType n, ValueType source, ValueType sink)
+    {
+        assert(source >= 0 && sink >= 0);
+        const ValueType score = source - sink;
+        // the edge from the source is saturated from the beginning
+        _excess[n] = (score > 0) ? score : 0;
+        _sinkResidual[n] = (score > 0) ? 0 : -score;
+    }
+
+    /**
+     * @brief Set the edge in the slot of node n1 to node n2.
+     * The reverse edge must be set by a call from the slot of node n2.
+     * It can be called in parallel on different nodes.
+     * @param[in] n1 The source node of the edge
+     * @param[in] slot1 The slot of the edge in node n1
+     * @param[in] n2 The target node of the edge
+     * @param[in] slot2 The slot of the reverse edge in node n2
+     * @param[in] capacity The capacity of the edge from n1 to n2
+     */
+    inline void addEdge(NodeType n1, std::size_t slot1, NodeType n2, std::size_t slot2, ValueType capacity)
+    {
+        assert(capacity >= 0);
+        assert(slot1 < _degree && slot2 < _degree);
+        const std::size_t e = n1 * _degree + slot1;
+        _reverse[e] = NodeType(n2 * _degree + slot2);
+        _residual[e] = capacity;
+    }
+
+    /**
+     * @brief Add the graph to another maxflow implementation (e.g. MaxFlow_AdjList).
+     * It must be called before compute().
+     */
+    template<class MaxFlowT>
+    void copyTo(MaxFlowT& maxFlow) const
+    {
+        for(std::size_t n = 0; n < getNbNodes(); ++n)
+            maxFlow.addNode(n, _excess[n], _sinkResidual[n]);
+
+        for(std::size_t e = 0; e < _reverse.size(); ++e)
+        {
+            // add each pair of edges once
+            const NodeType rev = _reverse[e];
+            if(rev != NO_EDGE && rev > e)
+                maxFlow.addEdge(e / _degree, rev / _degree, _residual[e], _residual[rev]);
+        }
+    }
+
+    /**
+     * @brief Save the graph in a binary file, it must be called before compute()
+     */
+    void save(const std::string& filepath) const;
+
+    /**
+     * @brief Load a graph saved by save()
+     */
+    void load(const std::string& filepath);
+
+    /**
+     * @brief Compute the maximum flow
+     * @return the value of the maximum flow
+     */
+    ValueType compute();
+
+    /// is empty
+    inline bool isSource(NodeType n) const
+    {
+        return !isTarget(n);
+    }
+    /// is full
+    inline bool isTarget(NodeType n) const
+    {
+        return _label[n] < getUnreachableLabel();
+    }
+
+private:
+    /// label of the nodes which cannot reach the sink, the distances are at most the number of nodes
+    inline NodeType getUnreachableLabel() const
+    {
+        return NodeType(getNbNodes() + 1);
+    }
+
+    /**
+     * @brief Set the labels to the distance to the sink in the residual graph,
+     * the nodes which cannot reach the sink get the unreachable label
+     */
+    void globalRelabel();
+
+    std::size_t _degree = 0;
+    /// residual capacity of the edges
+    std::vector<ValueType> _residual;
+    /// index of the reverse edge, NO_EDGE for the empty slots
+    std::vector<NodeType> _reverse;
+    /// residual capacity of the edges to the sink
+    std::vector<ValueType> _sinkResidual;
+    std::vector<ValueType> _excess;
+    /// distance to the sink
+    std::vector<NodeType> _label;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
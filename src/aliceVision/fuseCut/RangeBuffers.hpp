@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Accumulate the contributions of several threads to shared elements without synchronization.
+ *
+ * Each thread appends its contributions to its own buffers, sorted by range of elements.
+ * Then apply() processes the ranges in parallel, each range is owned by a single thread which
+ * applies the contributions of all the threads in the order of the threads.
+ */
+template <class T>
+class RangeBuffers
+{
+public:
+    /**
+     * @param[in] nbElements The number of shared elements
+     * @param[in] nbThreads The number of threads adding contributions
+     * @param[in] nbRangesPerThread The number of ranges per thread, to balance the apply step
+     */
+    RangeBuffers(std::size_t nbElements, int nbThreads, std::size_t nbRangesPerThread = 8)
+        : _nbThreads(std::max(nbThreads, 1))
+    {
+        // power of two range size to get the range with a shift
+        const std::size_t nbRanges = _nbThreads * nbRangesPerThread;
+        while((nbElements >> _rangeShift) >= nbRanges)
+            ++_rangeShift;
+        _nbRanges = (nbElements >> _rangeShift) + 1;
+        _buffers.resize(_nbThreads * _nbRanges);
+    }
+
+    /**
+     * @brief Add the contribution of the calling thread to an element
+     */
+    inline void add(std::size_t element, const T& contribution)
+    {
+        _buffers[omp_get_thread_num() * _nbRanges + (element >> _rangeShift)].push_back(contribution);
+    }
+
+    /**
+     * @brief Apply all the contributions and clear the buffers, must be called outside of a parallel region
+     * @param[in] applyContribution The function applying a contribution, called in parallel on different ranges
+     */
+    template <class ApplyFunction>
+    void apply(const ApplyFunction& applyContribution)
+    {
+        #pragma omp parallel for schedule(dynamic)
+        for(int range = 0; range < static_cast<int>(_nbRanges); ++range)
+        {
+            for(std::size_t thread = 0; thread < _nbThreads; ++thread)
+            {
+                std::vector<T>& buffer = _buffers[thread * _nbRanges + range];
+                for(const T& contribution : buffer)
+                    applyContribution(contribution);
+                // keep the memory for the next contributions
+                buffer.clear();
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of contributions waiting to be applied
+     */
+    std::size_t size() const
+    {
+        std::size_t size = 0;
+        for(const std::vector<T>& buffer : _buffers)
+            size += buffer.size();
+        return size;
+    }
+
+private:
+    std::size_t _nbThreads;
+    std::size_t _nbRanges = 1;
+    std::size_t _rangeShift = 0;
+    std::vector<std::vector<T>> _buffers;
+};
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,127 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "delaunayGraphCutTypes.hpp"
+#include <aliceVision/mvsData/compressedChunks.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <cstdio>
+
+namespace aliceVision {
+namespace fuseCut {
+
+void saveDhInfo(const std::string& fileNameInfo, const std::vector<GC_vertexInfo>& verticesAttr,
+                const std::vector<GC_cellInfo>& cellsAttr)
+{
+    // same layout as the successive fwriteinfo of the vertices and cells, serialized in parallel
+    const int npts = verticesAttr.size();
+    const int ncells = cellsAttr.size();
+
+    std::vector<std::size_t> verticesOffsets(npts + 1);
+    verticesOffsets[0] = sizeof(int);
+    for(int vi = 0; vi < npts; ++vi)
+        verticesOffsets[vi + 1] = verticesOffsets[vi] + verticesAttr[vi].getInfoSize();
+    const std::size_t cellsOffset = verticesOffsets[npts] + sizeof(int);
+    const std::uint64_t size = cellsOffset + ncells * GC_cellInfo::infoSize;
+
+    std::vector<unsigned char> buffer(size);
+    std::memcpy(&buffer[0], &npts, sizeof(int));
+#pragma omp parallel for
+    for(int vi = 0; vi < npts; ++vi)
+        verticesAttr[vi].writeinfo(&buffer[verticesOffsets[vi]]);
+
+    std::memcpy(&buffer[verticesOffsets[npts]], &ncells, sizeof(int));
+#pragma omp parallel for
+    for(int ci = 0; ci < ncells; ++ci)
+        cellsAttr[ci].writeinfo(&buffer[cellsOffset + ci * GC_cellInfo::infoSize]);
+
+    FILE* f = fopen(fileNameInfo.c_str(), "wb");
+    if(f == nullptr)
+        ALICEVISION_THROW_ERROR("Can't open file " << fileNameInfo);
+    try
+    {
+        // header, uncompressed size, then the chunks
+        if(fwrite(dhInfoMagic, sizeof(dhInfoMagic), 1, f) != 1 ||
+           fwrite(&dhInfoVersion, sizeof(std::uint32_t), 1, f) != 1 ||
+           fwrite(&size, sizeof(std::uint64_t), 1, f) != 1)
+            ALICEVISION_THROW_ERROR("Can't write file " << fileNameInfo);
+        fwriteCompressedChunks(f, buffer.data(), size, fileNameInfo);
+    }
+    catch(...)
+    {
+        fclose(f);
+        throw;
+    }
+    fclose(f);
+}
+
+void loadDhInfo(const std::string& fileNameInfo, std::vector<GC_vertexInfo>& verticesAttr,
+                std::vector<GC_cellInfo>& cellsAttr)
+{
+    FILE* f = fopen(fileNameInfo.c_str(), "rb");
+    if(f == nullptr)
+        ALICEVISION_THROW_ERROR("Can't open file " << fileNameInfo);
+
+    std::vector<unsigned char> buffer;
+    try
+    {
+        char magic[sizeof(dhInfoMagic)];
+        std::uint32_t version;
+        std::uint64_t size;
+        if(fread(magic, sizeof(magic), 1, f) != 1 || std::memcmp(magic, dhInfoMagic, sizeof(magic)) != 0)
+            ALICEVISION_THROW_ERROR(fileNameInfo << " is not a Delaunay info file");
+        if(fread(&version, sizeof(std::uint32_t), 1, f) != 1)
+            ALICEVISION_THROW_ERROR("Can't read the version of " << fileNameInfo);
+        if(version != dhInfoVersion)
+            ALICEVISION_THROW_ERROR("Unsupported Delaunay info file version " << version << " in " << fileNameInfo
+                                    << " (expected " << dhInfoVersion << ")");
+        if(fread(&size, sizeof(std::uint64_t), 1, f) != 1 || size < 2 * sizeof(int))
+            ALICEVISION_THROW_ERROR("Can't read the size of " << fileNameInfo);
+
+        buffer.resize(size);
+        freadCompressedChunks(f, buffer.data(), size, fileNameInfo);
+    }
+    catch(...)
+    {
+        fclose(f);
+        throw;
+    }
+    fclose(f);
+
+    const std::size_t size = buffer.size();
+    std::size_t offset = 0;
+
+    int npts;
+    std::memcpy(&npts, &buffer[offset], sizeof(int));
+    offset += sizeof(int);
+    if(npts < 0)
+        ALICEVISION_THROW_ERROR("Invalid number of vertices " << npts << " in " << fileNameInfo);
+
+    verticesAttr.resize(npts);
+    for(int vi = 0; vi < npts; ++vi)
+    {
+        const std::size_t infoSize = verticesAttr[vi].readinfo(&buffer[offset], size - offset);
+        if(infoSize == 0)
+            ALICEVISION_THROW_ERROR("Can't read the info of vertex " << vi << " from " << fileNameInfo);
+        offset += infoSize;
+    }
+
+    int ncells;
+    if(size - offset < sizeof(int))
+        ALICEVISION_THROW_ERROR("Can't read the number of cells from " << fileNameInfo);
+    std::memcpy(&ncells, &buffer[offset], sizeof(int));
+    offset += sizeof(int);
+    if(ncells < 0 || size - offset != ncells * GC_cellInfo::infoSize)
+        ALICEVISION_THROW_ERROR("Invalid number of cells " << ncells << " in " << fileNameInfo);
+
+    cellsAttr.resize(ncells);
+#pragma omp parallel for
+    for(int ci = 0; ci < ncells; ++ci)
+        cellsAttr[ci].readinfo(&buffer[offset + ci * GC_cellInfo::infoSize]);
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
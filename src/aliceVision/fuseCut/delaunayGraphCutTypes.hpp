@@ -9,7 +9,12 @@
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace fuseCut {
@@ -42,6 +47,30 @@ struct GC_cellInfo
         fwrite(&gEdgeVisWeight.front(), sizeof(float), 4, f);
     }
 
+    /// size in bytes of the info written by fwriteinfo
+    static const std::size_t infoSize = 9 * sizeof(float);
+
+    /// write the info of fwriteinfo in a buffer of infoSize bytes
+    void writeinfo(unsigned char* buffer) const
+    {
+        const float values[9] = {cellSWeight, cellTWeight, in, out, on,
+                                 gEdgeVisWeight[0], gEdgeVisWeight[1], gEdgeVisWeight[2], gEdgeVisWeight[3]};
+        std::memcpy(buffer, values, infoSize);
+    }
+
+    /// read the info of writeinfo from a buffer of infoSize bytes
+    void readinfo(const unsigned char* buffer)
+    {
+        float values[9];
+        std::memcpy(values, buffer, infoSize);
+        cellSWeight = values[0];
+        cellTWeight = values[1];
+        in = values[2];
+        out = values[3];
+        on = values[4];
+        std::copy(values + 5, values + 9, gEdgeVisWeight.begin());
+    }
+
     void freadinfo(FILE* f)
     {
         fread(&cellSWeight, sizeof(float), 1, f);
@@ -97,6 +126,62 @@ struct GC_vertexInfo
         }
     }
 
+    /// size in bytes of the info written by fwriteinfo
+    std::size_t getInfoSize() const
+    {
+        return sizeof(float) + 4 * sizeof(int) + sizeof(bool) + cams.size() * sizeof(int);
+    }
+
+    /// write the info of fwriteinfo in a buffer of getInfoSize() bytes
+    void writeinfo(unsigned char* buffer) const
+    {
+        const int n = cams.size();
+        std::memcpy(buffer, &pixSize, sizeof(float));
+        buffer += sizeof(float);
+        std::memcpy(buffer, &nrc, sizeof(int));
+        buffer += sizeof(int);
+        std::memcpy(buffer, &segSize, sizeof(int));
+        buffer += sizeof(int);
+        std::memcpy(buffer, &segId, sizeof(int));
+        buffer += sizeof(int);
+        std::memcpy(buffer, &isOnSurface, sizeof(bool));
+        buffer += sizeof(bool);
+        std::memcpy(buffer, &n, sizeof(int));
+        buffer += sizeof(int);
+        if(n > 0)
+            std::memcpy(buffer, &cams[0], n * sizeof(int));
+    }
+
+    /**
+     * @brief Read the info of writeinfo from a buffer, checking that it does not go past the buffer end.
+     * @return the number of bytes read, 0 if the buffer is too small or the number of cameras is invalid
+     */
+    std::size_t readinfo(const unsigned char* buffer, std::size_t bufferSize)
+    {
+        const std::size_t fixedSize = sizeof(float) + 4 * sizeof(int) + sizeof(bool);
+        if(bufferSize < fixedSize)
+            return 0;
+        int n;
+        std::memcpy(&pixSize, buffer, sizeof(float));
+        buffer += sizeof(float);
+        std::memcpy(&nrc, buffer, sizeof(int));
+        buffer += sizeof(int);
+        std::memcpy(&segSize, buffer, sizeof(int));
+        buffer += sizeof(int);
+        std::memcpy(&segId, buffer, sizeof(int));
+        buffer += sizeof(int);
+        std::memcpy(&isOnSurface, buffer, sizeof(bool));
+        buffer += sizeof(bool);
+        std::memcpy(&n, buffer, sizeof(int));
+        buffer += sizeof(int);
+        if(n < 0 || static_cast<std::size_t>(n) > (bufferSize - fixedSize) / sizeof(int))
+            return 0;
+        cams.resize(n);
+        if(n > 0)
+            std::memcpy(&cams[0], buffer, n * sizeof(int));
+        return fixedSize + n * sizeof(int);
+    }
+
     void freadinfo(FILE* f)
     {
         fread(&pixSize, sizeof(float), 1, f);
@@ -138,5 +223,33 @@ struct GC_camVertexInfo
     }
 };
 
+/// magic number and version of the files written by saveDhInfo
+const char dhInfoMagic[4] = {'A', 'V', 'D', 'H'};
+const std::uint32_t dhInfoVersion = 1;
+
+/**
+ * @brief Save the vertices and cells info of a Delaunay tetrahedralization.
+ *
+ * Layout: magic, version, uncompressed size, then the compressed chunks of the number of vertices,
+ * the info of each vertex (GC_vertexInfo::writeinfo), the number of cells and the info of each cell.
+ *
+ * @param[in] fileNameInfo the file name
+ * @param[in] verticesAttr the vertices info
+ * @param[in] cellsAttr the cells info
+ */
+void saveDhInfo(const std::string& fileNameInfo, const std::vector<GC_vertexInfo>& verticesAttr,
+                const std::vector<GC_cellInfo>& cellsAttr);
+
+/**
+ * @brief Load the vertices and cells info written by saveDhInfo.
+ * Throws if the file is not a Delaunay info file, has an unsupported version or is corrupted.
+ *
+ * @param[in] fileNameInfo the file name
+ * @param[out] verticesAttr the vertices info
+ * @param[out] cellsAttr the cells info
+ */
+void loadDhInfo(const std::string& fileNameInfo, std::vector<GC_vertexInfo>& verticesAttr,
+                std::vector<GC_cellInfo>& cellsAttr);
+
 } // namespace fuseCut
 } // namespace aliceVision
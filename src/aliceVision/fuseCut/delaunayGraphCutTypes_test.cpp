@@ -0,0 +1,148 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/delaunayGraphCutTypes.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutDelaunayGraphCutTypes
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace bfs = boost::filesystem;
+
+const std::string tmpFile()
+{
+  return (bfs::temp_directory_path() / bfs::unique_path("dhInfo_%%%%%%%%.bin")).string();
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Save random vertices and cells info, with and without cameras
+// - Load them back and assert that they are identical
+// - Assert that a file with a wrong magic, an unsupported version or a truncated content is rejected
+//-----------------
+BOOST_AUTO_TEST_CASE(delaunayGraphCutTypes_dhInfoRoundTrip)
+{
+  const std::string fileName = tmpFile();
+
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<float> distValue(-10.0f, 10.0f);
+  std::uniform_int_distribution<int> distInt(0, 50);
+
+  std::vector<GC_vertexInfo> verticesAttr(1000);
+  for(GC_vertexInfo& v : verticesAttr)
+  {
+    v.pixSize = distValue(generator);
+    v.nrc = distInt(generator);
+    v.segSize = distInt(generator);
+    v.segId = distInt(generator) - 1;
+    v.isOnSurface = (distInt(generator) % 2) == 0;
+    // virtual vertices have no camera
+    const int nbCams = distInt(generator) % 5;
+    for(int c = 0; c < nbCams; ++c)
+      v.cams.push_back(distInt(generator));
+  }
+
+  std::vector<GC_cellInfo> cellsAttr(5000);
+  for(GC_cellInfo& c : cellsAttr)
+  {
+    c.cellSWeight = distValue(generator);
+    c.cellTWeight = distValue(generator);
+    c.in = distValue(generator);
+    c.out = distValue(generator);
+    c.on = distValue(generator);
+    for(float& w : c.gEdgeVisWeight)
+      w = distValue(generator);
+  }
+
+  saveDhInfo(fileName, verticesAttr, cellsAttr);
+
+  std::vector<GC_vertexInfo> readVerticesAttr;
+  std::vector<GC_cellInfo> readCellsAttr;
+  loadDhInfo(fileName, readVerticesAttr, readCellsAttr);
+
+  BOOST_REQUIRE_EQUAL(readVerticesAttr.size(), verticesAttr.size());
+  for(std::size_t vi = 0; vi < verticesAttr.size(); ++vi)
+  {
+    BOOST_CHECK_EQUAL(readVerticesAttr[vi].pixSize, verticesAttr[vi].pixSize);
+    BOOST_CHECK_EQUAL(readVerticesAttr[vi].nrc, verticesAttr[vi].nrc);
+    BOOST_CHECK_EQUAL(readVerticesAttr[vi].segSize, verticesAttr[vi].segSize);
+    BOOST_CHECK_EQUAL(readVerticesAttr[vi].segId, verticesAttr[vi].segId);
+    BOOST_CHECK_EQUAL(readVerticesAttr[vi].isOnSurface, verticesAttr[vi].isOnSurface);
+    BOOST_CHECK(readVerticesAttr[vi].cams.getData() == verticesAttr[vi].cams.getData());
+  }
+
+  BOOST_REQUIRE_EQUAL(readCellsAttr.size(), cellsAttr.size());
+  for(std::size_t ci = 0; ci < cellsAttr.size(); ++ci)
+  {
+    BOOST_CHECK_EQUAL(readCellsAttr[ci].cellSWeight, cellsAttr[ci].cellSWeight);
+    BOOST_CHECK_EQUAL(readCellsAttr[ci].cellTWeight, cellsAttr[ci].cellTWeight);
+    BOOST_CHECK_EQUAL(readCellsAttr[ci].in, cellsAttr[ci].in);
+    BOOST_CHECK_EQUAL(readCellsAttr[ci].out, cellsAttr[ci].out);
+    BOOST_CHECK_EQUAL(readCellsAttr[ci].on, cellsAttr[ci].on);
+    BOOST_CHECK(readCellsAttr[ci].gEdgeVisWeight == cellsAttr[ci].gEdgeVisWeight);
+  }
+
+  // empty tetrahedralization
+  saveDhInfo(fileName, std::vector<GC_vertexInfo>(), std::vector<GC_cellInfo>());
+  loadDhInfo(fileName, readVerticesAttr, readCellsAttr);
+  BOOST_CHECK(readVerticesAttr.empty());
+  BOOST_CHECK(readCellsAttr.empty());
+
+  bfs::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(delaunayGraphCutTypes_dhInfoInvalid)
+{
+  const std::string fileName = tmpFile();
+
+  std::vector<GC_vertexInfo> verticesAttr(10);
+  std::vector<GC_cellInfo> cellsAttr(20);
+  saveDhInfo(fileName, verticesAttr, cellsAttr);
+
+  std::vector<unsigned char> content(bfs::file_size(fileName));
+  FILE* f = fopen(fileName.c_str(), "rb");
+  BOOST_REQUIRE_EQUAL(fread(content.data(), 1, content.size(), f), content.size());
+  fclose(f);
+
+  const auto writeContent = [&fileName](const std::vector<unsigned char>& data)
+  {
+    FILE* f = fopen(fileName.c_str(), "wb");
+    fwrite(data.data(), 1, data.size(), f);
+    fclose(f);
+  };
+
+  std::vector<GC_vertexInfo> readVerticesAttr;
+  std::vector<GC_cellInfo> readCellsAttr;
+
+  // file of the previous versions, starting with the uncompressed size
+  std::vector<unsigned char> invalid = content;
+  invalid[0] = 'X';
+  writeContent(invalid);
+  BOOST_CHECK_THROW(loadDhInfo(fileName, readVerticesAttr, readCellsAttr), std::runtime_error);
+
+  // unsupported version
+  invalid = content;
+  invalid[sizeof(dhInfoMagic)] = dhInfoVersion + 1;
+  writeContent(invalid);
+  BOOST_CHECK_THROW(loadDhInfo(fileName, readVerticesAttr, readCellsAttr), std::runtime_error);
+
+  // truncated
+  invalid.assign(content.begin(), content.end() - 5);
+  writeContent(invalid);
+  BOOST_CHECK_THROW(loadDhInfo(fileName, readVerticesAttr, readCellsAttr), std::runtime_error);
+
+  bfs::remove(fileName);
+  BOOST_CHECK_THROW(loadDhInfo(fileName, readVerticesAttr, readCellsAttr), std::runtime_error);
+}
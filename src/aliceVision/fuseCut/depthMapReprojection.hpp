@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
+#include <aliceVision/mvsData/Pixel.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Back project the pixels of a tc depth map and project them in rc.
+ * The depth map is stored by columns of tcHeight pixels, tcHeight being the height of tc which can differ from rc.
+ * The pixels of a column are processed without branches so that the loop can be vectorized.
+ *
+ * @param[in] tcDepthMap The depth map of tc, stored by columns
+ * @param[in] tcHeight The height of tc
+ * @param[in] tcICam The inverse of the tc camera matrix (iCamArr)
+ * @param[in] tcC The tc camera center
+ * @param[in] rcP The rc projection matrix (camArr)
+ * @param[in] rcC The rc camera center
+ * @param[in] minX, maxX, minY, maxY The rc pixels [minX, maxX) x [minY, maxY) receiving the points
+ * @param[in] pointFunction Called in the order of the tc pixels with the 3D point, the rc pixel and
+ *            the distance to the rc camera center of each valid tc pixel
+ */
+template <class PointFunction>
+void reprojectDepthMap(const StaticVector<float>& tcDepthMap, int tcHeight, const Matrix3x3& tcICam, const Point3d& tcC,
+                       const Matrix3x4& rcP, const Point3d& rcC, double minX, double maxX, double minY, double maxY,
+                       const PointFunction& pointFunction)
+{
+    if(tcDepthMap.empty() || tcHeight <= 0)
+        return;
+
+    const int nbColumns = tcDepthMap.size() / tcHeight;
+
+    std::vector<double> columnX(tcHeight), columnY(tcHeight), columnZ(tcHeight);
+    std::vector<int> columnCellX(tcHeight), columnCellY(tcHeight);
+    std::vector<float> columnPixDepth(tcHeight);
+    std::vector<unsigned char> columnValid(tcHeight);
+
+    for(int x = 0; x < nbColumns; x++)
+    {
+        const float* depths = &tcDepthMap[x * tcHeight];
+
+        for(int y = 0; y < tcHeight; y++)
+        {
+            const double depth = depths[y];
+            const double rx = tcICam.m11 * x + tcICam.m12 * y + tcICam.m13;
+            const double ry = tcICam.m21 * x + tcICam.m22 * y + tcICam.m23;
+            const double rz = tcICam.m31 * x + tcICam.m32 * y + tcICam.m33;
+            const double n = std::sqrt(rx * rx + ry * ry + rz * rz);
+            const double px = tcC.x + (rx / n) * depth;
+            const double py = tcC.y + (ry / n) * depth;
+            const double pz = tcC.z + (rz / n) * depth;
+
+            const double tx = rcP.m11 * px + rcP.m12 * py + rcP.m13 * pz + rcP.m14;
+            const double ty = rcP.m21 * px + rcP.m22 * py + rcP.m23 * pz + rcP.m24;
+            const double tz = rcP.m31 * px + rcP.m32 * py + rcP.m33 * pz + rcP.m34;
+            const double sz = tz > 0.0 ? tz : 1.0;
+            const double cellX = std::floor(tx / sz + 0.5);
+            const double cellY = std::floor(ty / sz + 0.5);
+            const bool valid = (depth > 0.0) & (tz > 0.0) & (cellX >= minX) & (cellX < maxX) & (cellY >= minY) & (cellY < maxY);
+
+            const double dx = rcC.x - px;
+            const double dy = rcC.y - py;
+            const double dz = rcC.z - pz;
+
+            columnX[y] = px;
+            columnY[y] = py;
+            columnZ[y] = pz;
+            columnCellX[y] = valid ? static_cast<int>(cellX) : 0;
+            columnCellY[y] = valid ? static_cast<int>(cellY) : 0;
+            columnPixDepth[y] = static_cast<float>(std::sqrt(dx * dx + dy * dy + dz * dz));
+            columnValid[y] = valid;
+        }
+
+        for(int y = 0; y < tcHeight; y++)
+        {
+            if(columnValid[y])
+                pointFunction(Point3d(columnX[y], columnY[y], columnZ[y]), Pixel(columnCellX[y], columnCellY[y]), columnPixDepth[y]);
+        }
+    }
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
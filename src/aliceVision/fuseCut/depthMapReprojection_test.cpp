@@ -0,0 +1,124 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/depthMapReprojection.hpp>
+
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutDepthMapReprojection
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+/**
+ * @brief Pinhole camera without rotation
+ */
+struct Camera
+{
+  int width;
+  int height;
+  double focal;
+  Point3d C;
+
+  /// projection matrix, as MultiViewParams::camArr
+  Matrix3x4 P() const
+  {
+    Matrix3x4 m;
+    m.m11 = focal; m.m12 = 0.0;   m.m13 = width / 2.0;  m.m14 = -(focal * C.x + width / 2.0 * C.z);
+    m.m21 = 0.0;   m.m22 = focal; m.m23 = height / 2.0; m.m24 = -(focal * C.y + height / 2.0 * C.z);
+    m.m31 = 0.0;   m.m32 = 0.0;   m.m33 = 1.0;          m.m34 = -C.z;
+    return m;
+  }
+
+  /// inverse of the camera matrix, as MultiViewParams::iCamArr
+  Matrix3x3 iCam() const
+  {
+    Matrix3x3 m;
+    m.m11 = 1.0 / focal; m.m12 = 0.0;         m.m13 = -width / (2.0 * focal);
+    m.m21 = 0.0;         m.m22 = 1.0 / focal; m.m23 = -height / (2.0 * focal);
+    m.m31 = 0.0;         m.m32 = 0.0;         m.m33 = 1.0;
+    return m;
+  }
+};
+
+struct ReprojectedPoint
+{
+  Point3d p;
+  Pixel cell;
+  float pixDepth;
+};
+
+//-----------------
+// Test summary:
+//-----------------
+// - Reproject the depth map of a tc camera in a rc camera of a different size, tc being taller than rc
+// - Assert that all the columns of the tc depth map are processed with the tc height
+// - Assert that each valid tc pixel gives its 3D point, its rc pixel and its distance to the rc center
+//-----------------
+BOOST_AUTO_TEST_CASE(depthMapReprojection_differentSizes)
+{
+  const Camera rc{40, 30, 50.0, Point3d(0.0, 0.0, 0.0)};
+  const Camera tc{24, 50, 60.0, Point3d(0.3, -0.1, 0.0)};
+  const int border = 2;
+
+  // depth map of tc, stored by columns, with a few invalid pixels
+  StaticVector<float> tcDepthMap;
+  tcDepthMap.resize(tc.width * tc.height);
+  for(int x = 0; x < tc.width; ++x)
+    for(int y = 0; y < tc.height; ++y)
+      tcDepthMap[x * tc.height + y] = ((x + y) % 7 == 0) ? -1.0f : 5.0f + 0.01f * x + 0.02f * y;
+
+  // reference: per-pixel back projection and projection
+  const Matrix3x4 rcP = rc.P();
+  const Matrix3x3 tcICam = tc.iCam();
+  std::vector<ReprojectedPoint> expected;
+  int nbOutside = 0;
+  for(int x = 0; x < tc.width; ++x)
+  {
+    for(int y = 0; y < tc.height; ++y)
+    {
+      const float depth = tcDepthMap[x * tc.height + y];
+      if(depth <= 0.0f)
+        continue;
+      const Point3d ray = (tcICam * Point3d(x, y, 1.0)).normalize();
+      const Point3d p = tc.C + ray * depth;
+      const Point3d proj = rcP * p;
+      const Pixel cell(static_cast<int>(std::floor(proj.x / proj.z + 0.5)), static_cast<int>(std::floor(proj.y / proj.z + 0.5)));
+      if(cell.x < border || cell.x >= rc.width - border || cell.y < border || cell.y >= rc.height - border)
+      {
+        ++nbOutside;
+        continue;
+      }
+      expected.push_back(ReprojectedPoint{p, cell, static_cast<float>((rc.C - p).size())});
+    }
+  }
+  // tc sees more than rc
+  BOOST_CHECK_GT(nbOutside, 0);
+  BOOST_CHECK_GT(expected.size(), 100);
+
+  std::vector<ReprojectedPoint> reprojected;
+  reprojectDepthMap(tcDepthMap, tc.height, tcICam, tc.C, rcP, rc.C, border, rc.width - border, border, rc.height - border,
+                    [&](const Point3d& p, const Pixel& cell, float pixDepth)
+  {
+    reprojected.push_back(ReprojectedPoint{p, cell, pixDepth});
+  });
+
+  BOOST_REQUIRE_EQUAL(reprojected.size(), expected.size());
+  for(std::size_t i = 0; i < expected.size(); ++i)
+  {
+    BOOST_CHECK_SMALL((reprojected[i].p - expected[i].p).size(), 1e-9);
+    BOOST_CHECK_EQUAL(reprojected[i].cell.x, expected[i].cell.x);
+    BOOST_CHECK_EQUAL(reprojected[i].cell.y, expected[i].cell.y);
+    BOOST_CHECK_CLOSE(reprojected[i].pixDepth, expected[i].pixDepth, 1e-4);
+  }
+
+  // empty depth map
+  reprojectDepthMap(StaticVector<float>(), tc.height, tcICam, tc.C, rcP, rc.C, border, rc.width - border, border, rc.height - border,
+                    [](const Point3d&, const Pixel&, float) { BOOST_ERROR("no point expected"); });
+}
@@ -0,0 +1,219 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/DepthMapsCache.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutDepthMapsCache
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+const int depthMapSize = 100;
+const std::size_t depthMapBytes = depthMapSize * sizeof(float);
+
+/**
+ * @brief Create a cache of fake depth maps filled with their camera index, counting the reads of each map
+ */
+DepthMapsCache::ReadFunction createReader(std::vector<std::atomic<int>>& nbReads)
+{
+  return [&nbReads](int cam, StaticVector<float>& depthMap)
+  {
+    ++nbReads[cam];
+    depthMap.resize_with(depthMapSize, static_cast<float>(cam));
+  };
+}
+
+/**
+ * @brief Depth maps read by the jobs of a ring of cameras, each job reads its camera and the 2 next ones
+ */
+std::vector<std::vector<int>> createRingJobs(int nbCams)
+{
+  std::vector<std::vector<int>> jobs(nbCams);
+  for(int rc = 0; rc < nbCams; ++rc)
+    jobs[rc] = {rc, (rc + 1) % nbCams, (rc + 2) % nbCams};
+  return jobs;
+}
+
+std::map<int, int> getNbUses(const std::vector<std::vector<int>>& jobs)
+{
+  std::map<int, int> nbUses;
+  for(const auto& job : jobs)
+    for(const int cam : job)
+      ++nbUses[cam];
+  return nbUses;
+}
+
+BOOST_AUTO_TEST_CASE(depthMapsCache_orderJobs)
+{
+  // jobs 0 and 2 share 2 maps, job 1 shares no map with the others
+  const std::vector<std::vector<int>> jobs = {{0, 1, 2}, {5, 6}, {1, 2, 3}, {3, 4}};
+  const std::vector<int> order = orderJobsByDepthMapsReuse(jobs);
+
+  BOOST_CHECK_EQUAL(order.size(), 4);
+  BOOST_CHECK_EQUAL(order[0], 0);
+  BOOST_CHECK_EQUAL(order[1], 2);
+  BOOST_CHECK_EQUAL(order[2], 3);
+  BOOST_CHECK_EQUAL(order[3], 1);
+
+  // each job is scheduled exactly once
+  std::vector<int> sorted = orderJobsByDepthMapsReuse(createRingJobs(50));
+  std::sort(sorted.begin(), sorted.end());
+  for(int i = 0; i < 50; ++i)
+    BOOST_CHECK_EQUAL(sorted[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(depthMapsCache_singleReadPerMap)
+{
+  const int nbCams = 50;
+  const std::vector<std::vector<int>> jobs = createRingJobs(nbCams);
+  std::vector<std::atomic<int>> nbReads(nbCams);
+  for(auto& n : nbReads)
+    n = 0;
+
+  // enough room for the maps of a few consecutive jobs
+  DepthMapsCache cache(createReader(nbReads), 8 * depthMapBytes);
+  cache.setNbUses(getNbUses(jobs));
+
+  const std::vector<int> order = orderJobsByDepthMapsReuse(jobs);
+  std::atomic<int> nbErrors(0);
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for(int i = 0; i < nbCams; ++i)
+  {
+    for(const int cam : jobs[order[i]])
+    {
+      const DepthMapsCache::DepthMapPtr depthMap = cache.acquire(cam);
+      if(depthMap->size() != depthMapSize || (*depthMap)[0] != cam)
+        ++nbErrors;
+      cache.release(cam);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(nbErrors, 0);
+  // in sequential order the maps are never evicted, concurrent jobs may need a few more reads
+  BOOST_CHECK_LE(cache.getNbReads(), 2 * nbCams);
+  int totalReads = 0;
+  for(const auto& n : nbReads)
+    totalReads += n;
+  BOOST_CHECK_EQUAL(totalReads, cache.getNbReads());
+}
+
+BOOST_AUTO_TEST_CASE(depthMapsCache_sequentialNoEviction)
+{
+  const int nbCams = 30;
+  const std::vector<std::vector<int>> jobs = createRingJobs(nbCams);
+  std::vector<std::atomic<int>> nbReads(nbCams);
+  for(auto& n : nbReads)
+    n = 0;
+
+  DepthMapsCache cache(createReader(nbReads), 4 * depthMapBytes);
+  cache.setNbUses(getNbUses(jobs));
+
+  for(const int job : orderJobsByDepthMapsReuse(jobs))
+  {
+    for(const int cam : jobs[job])
+    {
+      cache.acquire(cam);
+      cache.release(cam);
+    }
+  }
+
+  // maps 0 and 1 are kept until the end of the ring, the others are read once
+  BOOST_CHECK_EQUAL(cache.getNbReads(), nbCams);
+  for(int cam = 0; cam < nbCams; ++cam)
+    BOOST_CHECK_EQUAL(nbReads[cam], 1);
+}
+
+BOOST_AUTO_TEST_CASE(depthMapsCache_evictionUnderBudget)
+{
+  std::vector<std::atomic<int>> nbReads(3);
+  for(auto& n : nbReads)
+    n = 0;
+
+  // room for 2 maps
+  DepthMapsCache cache(createReader(nbReads), 2 * depthMapBytes);
+  cache.setNbUses({{0, 2}, {1, 1}, {2, 3}});
+
+  cache.acquire(2);
+  cache.release(2);
+  cache.acquire(0);
+  cache.release(0);
+  // the budget is exceeded: map 0 has fewer pending uses than map 2 and is evicted
+  cache.acquire(1);
+  cache.release(1);
+  cache.acquire(2);
+  cache.release(2);
+  cache.acquire(0);
+  cache.release(0);
+
+  BOOST_CHECK_EQUAL(nbReads[0], 2);
+  BOOST_CHECK_EQUAL(nbReads[1], 1);
+  BOOST_CHECK_EQUAL(nbReads[2], 1);
+  BOOST_CHECK_EQUAL(cache.getNbReads(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(depthMapsCache_noEvictionWhileUsed)
+{
+  std::vector<std::atomic<int>> nbReads(2);
+  for(auto& n : nbReads)
+    n = 0;
+
+  // no room: the maps are only kept while they are used
+  DepthMapsCache cache(createReader(nbReads), 0);
+
+  const DepthMapsCache::DepthMapPtr map1 = cache.acquire(1);
+  const DepthMapsCache::DepthMapPtr map1Again = cache.acquire(1);
+  BOOST_CHECK_EQUAL((*map1)[0], 1.0f);
+  BOOST_CHECK(map1 == map1Again);
+  BOOST_CHECK_EQUAL(nbReads[1], 1);
+  cache.release(1);
+  cache.release(1);
+
+  cache.acquire(1);
+  cache.release(1);
+  BOOST_CHECK_EQUAL(nbReads[1], 2);
+}
+
+BOOST_AUTO_TEST_CASE(depthMapsCache_shrink)
+{
+  std::vector<std::atomic<int>> nbReads(3);
+  for(auto& n : nbReads)
+    n = 0;
+
+  system::MemoryTracker& tracker = system::MemoryTracker::getInstance();
+  const std::size_t trackedBytes = tracker.getTrackedBytes();
+  {
+    DepthMapsCache cache(createReader(nbReads), 3 * depthMapBytes);
+    cache.setNbUses({{0, 2}, {1, 3}, {2, 2}});
+
+    cache.acquire(0);
+    cache.release(0);
+    cache.acquire(1);
+    cache.release(1);
+    cache.acquire(2);
+    BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes + 3 * depthMapBytes);
+
+    // the used map 2 is kept, the unused map with the fewest pending uses is evicted first
+    BOOST_CHECK_EQUAL(cache.shrink(depthMapBytes), depthMapBytes);
+    BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes + 2 * depthMapBytes);
+    BOOST_CHECK_EQUAL(cache.shrink(3 * depthMapBytes), depthMapBytes);
+    cache.release(2);
+
+    cache.acquire(0);
+    cache.release(0);
+    cache.acquire(1);
+    cache.release(1);
+    BOOST_CHECK_EQUAL(nbReads[0], 2);
+    BOOST_CHECK_EQUAL(nbReads[1], 2);
+  }
+  BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes);
+}
@@ -0,0 +1,135 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE fuseCutMaxFlow
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+/**
+ * @brief Create a 3D grid graph with random integer capacities,
+ * each node has 6 edge slots (-x, +x, -y, +y, -z, +z)
+ */
+MaxFlow_PushRelabel createGridGraph(int size, std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> edgeCapacity(0, 9);
+  std::uniform_int_distribution<int> terminalCapacity(0, 20);
+
+  const int nbNodes = size * size * size;
+  MaxFlow_PushRelabel graph(nbNodes, 6);
+
+  const auto nodeIndex = [size](int x, int y, int z) { return (z * size + y) * size + x; };
+
+  for(int z = 0; z < size; ++z)
+  {
+    for(int y = 0; y < size; ++y)
+    {
+      for(int x = 0; x < size; ++x)
+      {
+        const int n = nodeIndex(x, y, z);
+        graph.addNode(n, terminalCapacity(generator), terminalCapacity(generator));
+
+        // edges to the next nodes and their reverse edges
+        const int next[3] = {x + 1, y + 1, z + 1};
+        for(int axis = 0; axis < 3; ++axis)
+        {
+          if(next[axis] >= size)
+            continue;
+          const int neighbor = nodeIndex(axis == 0 ? x + 1 : x, axis == 1 ? y + 1 : y, axis == 2 ? z + 1 : z);
+          graph.addEdge(n, 2 * axis + 1, neighbor, 2 * axis, edgeCapacity(generator));
+          graph.addEdge(neighbor, 2 * axis, n, 2 * axis + 1, edgeCapacity(generator));
+        }
+      }
+    }
+  }
+  return graph;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Source -> 0 -> 1 -> sink with a bottleneck between 0 and 1
+// - Assert the flow value and that only the node 1 is on the sink side
+//-----------------
+BOOST_AUTO_TEST_CASE(maxflowPushRelabel_chain)
+{
+  MaxFlow_PushRelabel graph(2, 1);
+  graph.addNode(0, 10.f, 0.f);
+  graph.addNode(1, 0.f, 10.f);
+  graph.addEdge(0, 0, 1, 0, 3.f);
+  graph.addEdge(1, 0, 0, 0, 5.f);
+
+  BOOST_CHECK_CLOSE(graph.compute(), 3.f, 1e-6);
+  BOOST_CHECK(graph.isSource(0));
+  BOOST_CHECK(graph.isTarget(1));
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create random 3D grid graphs
+// - Compute the maxflow with push-relabel and with boykov_kolmogorov (MaxFlow_AdjList)
+// - Assert that the flow values and the labelings are the same
+//-----------------
+BOOST_AUTO_TEST_CASE(maxflowPushRelabel_sameAsBoykovKolmogorov)
+{
+  std::mt19937 generator(0);
+
+  for(int size : {1, 5, 12})
+  {
+    MaxFlow_PushRelabel graph = createGridGraph(size, generator);
+
+    MaxFlow_AdjList reference(graph.getNbNodes());
+    graph.copyTo(reference);
+
+    const float flow = graph.compute();
+    const float referenceFlow = reference.compute();
+    BOOST_CHECK_CLOSE(flow, referenceFlow, 1e-4);
+
+    std::size_t nbTargets = 0;
+    for(std::size_t n = 0; n < graph.getNbNodes(); ++n)
+    {
+      BOOST_CHECK_EQUAL(graph.isTarget(n), reference.isTarget(n));
+      nbTargets += graph.isTarget(n);
+    }
+    BOOST_TEST_MESSAGE("grid " << size << ": flow " << flow << ", " << nbTargets << " target nodes");
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Save a random graph and load it
+// - Assert that both graphs give the same maxflow and labeling
+//-----------------
+BOOST_AUTO_TEST_CASE(maxflowPushRelabel_saveLoad)
+{
+  std::mt19937 generator(1);
+  MaxFlow_PushRelabel graph = createGridGraph(6, generator);
+
+  const std::string filepath = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("maxflow_%%%%%%%%.bin")).string();
+  graph.save(filepath);
+
+  MaxFlow_PushRelabel loaded;
+  loaded.load(filepath);
+  boost::filesystem::remove(filepath);
+
+  BOOST_CHECK_EQUAL(loaded.getNbNodes(), graph.getNbNodes());
+  BOOST_CHECK_EQUAL(loaded.getDegree(), graph.getDegree());
+  BOOST_CHECK_EQUAL(loaded.compute(), graph.compute());
+
+  for(std::size_t n = 0; n < graph.getNbNodes(); ++n)
+    BOOST_CHECK_EQUAL(loaded.isTarget(n), graph.isTarget(n));
+}
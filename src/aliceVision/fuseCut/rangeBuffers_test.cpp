@@ -0,0 +1,78 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/RangeBuffers.hpp>
+
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutRangeBuffers
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+struct Contribution
+{
+  int element;
+  int thread;
+  int index;
+};
+
+//-----------------
+// Test summary:
+//-----------------
+// - Add contributions to shared elements from several threads
+// - Apply them without synchronization
+// - Assert that all the contributions are applied once, in the order of the threads then of their addition
+// - Assert that the buffers are empty and can be reused after apply()
+//-----------------
+BOOST_AUTO_TEST_CASE(rangeBuffers_apply)
+{
+  const int nbThreads = omp_get_max_threads();
+
+  for(const int nbElements : {0, 1, 7, 1000, 65537})
+  {
+    RangeBuffers<Contribution> buffers(nbElements, nbThreads);
+    std::vector<std::vector<Contribution>> applied(nbElements);
+
+    for(int pass = 0; pass < 2; ++pass)
+    {
+      const int nbContributions = 5 * nbElements;
+
+      #pragma omp parallel for num_threads(nbThreads) schedule(static, 3)
+      for(int i = 0; i < nbContributions; ++i)
+      {
+        // several contributions per element, from different threads
+        const int element = static_cast<int>((i * 7919LL) % nbElements);
+        buffers.add(element, Contribution{element, omp_get_thread_num(), i});
+      }
+      BOOST_CHECK_EQUAL(buffers.size(), nbContributions);
+
+      buffers.apply([&applied](const Contribution& contribution)
+      {
+        applied[contribution.element].push_back(contribution);
+      });
+      BOOST_CHECK_EQUAL(buffers.size(), 0);
+
+      std::size_t nbApplied = 0;
+      for(int element = 0; element < nbElements; ++element)
+      {
+        const std::vector<Contribution>& contributions = applied[element];
+        nbApplied += contributions.size();
+        for(std::size_t c = 1; c < contributions.size(); ++c)
+        {
+          const Contribution& previous = contributions[c - 1];
+          const Contribution& current = contributions[c];
+          BOOST_CHECK(previous.thread < current.thread || (previous.thread == current.thread && previous.index < current.index));
+        }
+        for(const Contribution& contribution : contributions)
+          BOOST_CHECK_EQUAL(contribution.element, element);
+        applied[element].clear();
+      }
+      BOOST_CHECK_EQUAL(nbApplied, nbContributions);
+    }
+  }
+}
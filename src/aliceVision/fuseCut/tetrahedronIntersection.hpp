@@ -0,0 +1,86 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <array>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Intersect a line with the 4 facets of a tetrahedron, the facet i is opposite to the vertex i.
+ * It is the same computation as isLineInTriangle on each facet, with the 4 facets in the lanes of
+ * fixed-size arrays so that the compiler can vectorize it.
+ * The float roundings follow isLineInTriangle, only the vectorization can change the hits on the facet edges.
+ * @return the bit mask of the facets intersected by the line
+ */
+inline int intersectLineTetrahedronFacets(const std::array<const Point3d*, 4>& vertices, const Point3d& linePoint,
+                                          const Point3d& lineVect, std::array<Point3d, 4>& out_lpi)
+{
+    // vertices A, B, C of each facet, as in isLineInTriangle(lpi, A, B, C, ...)
+    static const int facetVertices[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
+
+    float A[3][4], v0[3][4], v1[3][4];
+    for(int i = 0; i < 4; ++i)
+    {
+        const Point3d& a = *vertices[facetVertices[i][0]];
+        const Point3d& b = *vertices[facetVertices[i][1]];
+        const Point3d& c = *vertices[facetVertices[i][2]];
+        for(int d = 0; d < 3; ++d)
+        {
+            A[d][i] = static_cast<float>(a.m[d]);
+            // difference in double, rounded to float
+            v0[d][i] = static_cast<float>(c.m[d] - A[d][i]);
+            v1[d][i] = static_cast<float>(b.m[d] - A[d][i]);
+        }
+    }
+    const float lp[3] = {static_cast<float>(linePoint.x), static_cast<float>(linePoint.y), static_cast<float>(linePoint.z)};
+    const float lv[3] = {static_cast<float>(lineVect.x), static_cast<float>(lineVect.y), static_cast<float>(lineVect.z)};
+
+    float P[3][4], u[4], v[4];
+    for(int i = 0; i < 4; ++i)
+    {
+        // intersection of the line with the plane of the facet
+        const float nx = v0[1][i] * v1[2][i] - v0[2][i] * v1[1][i];
+        const float ny = v0[2][i] * v1[0][i] - v0[0][i] * v1[2][i];
+        const float nz = v0[0][i] * v1[1][i] - v0[1][i] * v1[0][i];
+        const float k = ((A[0][i] * nx + A[1][i] * ny + A[2][i] * nz) - (nx * lp[0] + ny * lp[1] + nz * lp[2])) /
+                        (nx * lv[0] + ny * lv[1] + nz * lv[2]);
+        float v2[3];
+        for(int d = 0; d < 3; ++d)
+        {
+            P[d][i] = lp[d] + lv[d] * k;
+            v2[d] = P[d][i] - A[d][i];
+        }
+
+        // barycentric coordinates
+        const float dot00 = v0[0][i] * v0[0][i] + v0[1][i] * v0[1][i] + v0[2][i] * v0[2][i];
+        const float dot01 = v0[0][i] * v1[0][i] + v0[1][i] * v1[1][i] + v0[2][i] * v1[2][i];
+        const float dot02 = v0[0][i] * v2[0] + v0[1][i] * v2[1] + v0[2][i] * v2[2];
+        const float dot11 = v1[0][i] * v1[0][i] + v1[1][i] * v1[1][i] + v1[2][i] * v1[2][i];
+        const float dot12 = v1[0][i] * v2[0] + v1[1][i] * v2[1] + v1[2][i] * v2[2];
+        // inverse in double, rounded to float
+        const float invDenom = static_cast<float>(1.0 / (dot00 * dot11 - dot01 * dot01));
+        u[i] = (dot11 * dot02 - dot01 * dot12) * invDenom;
+        v[i] = (dot00 * dot12 - dot01 * dot02) * invDenom;
+    }
+
+    int intersectedFacets = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        out_lpi[i] = Point3d(P[0][i], P[1][i], P[2][i]);
+        // same test as isPointInTriangle
+        if((u[i] >= 0.0) && (v[i] >= 0.0) && (double(u[i]) + double(v[i]) <= 1.0))
+            intersectedFacets |= (1 << i);
+    }
+    return intersectedFacets;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,125 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/tetrahedronIntersection.hpp>
+#include <aliceVision/mvsData/geometry.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE fuseCutTetrahedronIntersection
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+/// tolerance on the barycentric coordinates and the intersection points, for the float roundings of the vectorized code
+const double epsilon = 1e-4;
+
+/**
+ * @brief Compare intersectLineTetrahedronFacets with isLineInTriangle on each facet.
+ * The results must be the same, except for the hits on the edges of the facets (up to epsilon) which can go either way.
+ * @param[in,out] nbEdgeHits The number of hits on the edges of the facets
+ * @return the number of intersected facets
+ */
+int checkSameAsIsLineInTriangle(const std::array<Point3d, 4>& tetrahedron, const Point3d& linePoint, const Point3d& lineVect,
+                                int& nbEdgeHits)
+{
+  static const int facetVertices[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
+
+  const std::array<const Point3d*, 4> vertices = {{&tetrahedron[0], &tetrahedron[1], &tetrahedron[2], &tetrahedron[3]}};
+  std::array<Point3d, 4> facetsLpi;
+  const int intersectedFacets = intersectLineTetrahedronFacets(vertices, linePoint, lineVect, facetsLpi);
+
+  int nbIntersected = 0;
+  for(int i = 0; i < 4; ++i)
+  {
+    Point3d lpi;
+    const Point2d uv = getLineTriangleIntersectBarycCoords(&lpi, &tetrahedron[facetVertices[i][0]], &tetrahedron[facetVertices[i][1]],
+                                                           &tetrahedron[facetVertices[i][2]], &linePoint, &lineVect);
+    const bool expected = isPointInTriangle(uv);
+    const bool intersected = (intersectedFacets & (1 << i)) != 0;
+
+    const bool onEdge = std::abs(uv.x) < epsilon || std::abs(uv.y) < epsilon || std::abs(1.0 - uv.x - uv.y) < epsilon;
+    if(onEdge)
+      ++nbEdgeHits;
+    else
+      BOOST_CHECK_EQUAL(intersected, expected);
+
+    if(expected && intersected)
+    {
+      const double scale = std::max(1.0, lpi.size());
+      BOOST_CHECK_SMALL((facetsLpi[i] - lpi).size() / scale, epsilon);
+      ++nbIntersected;
+    }
+  }
+  return nbIntersected;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Intersect random lines with random tetrahedra
+// - Intersect lines going exactly through the vertices and the edges of tetrahedra with integer coordinates
+// - Intersect lines with degenerate tetrahedra (flat, repeated vertex) and lines parallel to a facet
+// - Assert that intersectLineTetrahedronFacets gives the same facets and points as isLineInTriangle,
+//   except for the hits on the edges of the facets which depend on the float roundings
+//-----------------
+BOOST_AUTO_TEST_CASE(tetrahedronIntersection_sameAsIsLineInTriangle)
+{
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> distCoord(-10.0, 10.0);
+  std::uniform_int_distribution<int> distInt(-5, 5);
+  const auto randomPoint = [&]() { return Point3d(distCoord(generator), distCoord(generator), distCoord(generator)); };
+  const auto randomIntPoint = [&]() { return Point3d(distInt(generator), distInt(generator), distInt(generator)); };
+
+  // random lines, starting inside the tetrahedron as in the ray casting or anywhere
+  int nbIntersected = 0;
+  int nbEdgeHits = 0;
+  for(int t = 0; t < 2000; ++t)
+  {
+    const std::array<Point3d, 4> tetrahedron = {{randomPoint(), randomPoint(), randomPoint(), randomPoint()}};
+    const Point3d inside = (tetrahedron[0] + tetrahedron[1] + tetrahedron[2] + tetrahedron[3]) / 4.0;
+    const Point3d linePoint = (t % 2 == 0) ? inside : randomPoint();
+    const Point3d lineVect = (randomPoint() - linePoint).normalize();
+    nbIntersected += checkSameAsIsLineInTriangle(tetrahedron, linePoint, lineVect, nbEdgeHits);
+  }
+  BOOST_CHECK_GT(nbIntersected, 1000);
+
+  nbEdgeHits = 0;
+
+  // lines through a vertex or the middle of an edge
+  for(int t = 0; t < 2000; ++t)
+  {
+    const std::array<Point3d, 4> tetrahedron = {{randomIntPoint(), randomIntPoint(), randomIntPoint(), randomIntPoint()}};
+    const Point3d linePoint = randomIntPoint();
+    const Point3d& a = tetrahedron[t % 4];
+    const Point3d& b = tetrahedron[(t + 1) % 4];
+    const Point3d target = (t % 3 == 0) ? a : (a + b) / 2.0;
+    if((target - linePoint).size() == 0.0)
+      continue;
+    checkSameAsIsLineInTriangle(tetrahedron, linePoint, (target - linePoint).normalize(), nbEdgeHits);
+    // unnormalized direction, as in isLineInTriangle callers
+    checkSameAsIsLineInTriangle(tetrahedron, linePoint, target - linePoint, nbEdgeHits);
+  }
+  BOOST_CHECK_GT(nbEdgeHits, 1000);
+
+  // degenerate tetrahedra
+  const Point3d linePoint(0.25, 0.25, -1.0);
+  const Point3d lineVect(0.0, 0.0, 1.0);
+  const std::array<Point3d, 4> flat = {{Point3d(0.0, 0.0, 0.0), Point3d(1.0, 0.0, 0.0), Point3d(0.0, 1.0, 0.0), Point3d(1.0, 1.0, 0.0)}};
+  checkSameAsIsLineInTriangle(flat, linePoint, lineVect, nbEdgeHits);
+  const std::array<Point3d, 4> repeatedVertex = {{Point3d(0.0, 0.0, 0.0), Point3d(1.0, 0.0, 0.0), Point3d(0.0, 1.0, 0.0), Point3d(0.0, 0.0, 0.0)}};
+  checkSameAsIsLineInTriangle(repeatedVertex, linePoint, lineVect, nbEdgeHits);
+
+  // line parallel to the facets containing the z axis
+  const std::array<Point3d, 4> unit = {{Point3d(0.0, 0.0, 0.0), Point3d(1.0, 0.0, 0.0), Point3d(0.0, 1.0, 0.0), Point3d(0.0, 0.0, 1.0)}};
+  checkSameAsIsLineInTriangle(unit, linePoint, lineVect, nbEdgeHits);
+  checkSameAsIsLineInTriangle(unit, Point3d(0.0, 0.0, -1.0), lineVect, nbEdgeHits);
+  BOOST_CHECK_EQUAL(checkSameAsIsLineInTriangle(unit, Point3d(0.2, 0.3, 0.1), Point3d(1.0, 1.0, 1.0).normalize(), nbEdgeHits), 2);
+}
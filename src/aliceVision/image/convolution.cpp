@@ -6,6 +6,9 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "convolution.hpp"
+#include "convolutionSimd.hpp"
+
+#include <vector>
 
 namespace aliceVision {
 namespace image {
@@ -13,66 +16,40 @@ namespace image {
 void SeparableConvolution2d(const RowMatrixXf& image,
                             const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_x,
                             const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_y,
-                            RowMatrixXf* out) {
-  const int sigma_y = static_cast<int>( kernel_y.cols() );
-  const int half_sigma_y = static_cast<int>( kernel_y.cols() ) / 2;
-
-  // Convolving a vertical filter across rows is the same thing as transpose
-  // multiply i.e. kernel_y^t * rows. This will give us the convoled value for
-  // each row. However, care must be taken at the top and bottom borders.
-  const Eigen::Matrix<float, 1, Eigen::Dynamic> reverse_kernel_y = kernel_y.reverse();
-
-  #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < half_sigma_y; i++)
+                            RowMatrixXf* out)
+{
+  const int rows = static_cast<int>(image.rows());
+  const int cols = static_cast<int>(image.cols());
+  const int size_x = static_cast<int>(kernel_x.cols());
+  const int size_y = static_cast<int>(kernel_y.cols());
+  const int half_size_x = size_x / 2;
+  const int half_size_y = size_y / 2;
+
+  // Each output row is computed in a single pass: the vertical filter is applied on
+  // the input rows into a line extended with the mirrored borders, then the horizontal
+  // filter is applied on this line. The borders are mirrored without duplicating the
+  // border pixel in both directions.
+  #pragma omp parallel
   {
-    const int forward_size = i + half_sigma_y + 1;
-    const int reverse_size = sigma_y - forward_size;
-    out->row(i) = kernel_y.tail(forward_size) *
-                  image.block(0, 0, forward_size, image.cols()) +
-                  reverse_kernel_y.tail(reverse_size) *
-                  image.block(1, 0, reverse_size, image.cols());
+    std::vector<const float*> rows_y(size_y);
+    std::vector<float, Eigen::aligned_allocator<float>> line(cols + 2 * half_size_x);
 
-    // Apply the same technique for the end rows.
-    out->row(image.rows() - i - 1) =
-      kernel_y.head(forward_size) *
-      image.block(image.rows() - forward_size, 0, forward_size, image.cols())
-      +
-      reverse_kernel_y.head(reverse_size) *
-      image.block(image.rows() - reverse_size - 1, 0, reverse_size, image.cols());
-  }
+    #pragma omp for schedule(static)
+    for(int row = 0; row < rows; ++row)
+    {
+      for(int k = 0; k < size_y; ++k)
+        rows_y[k] = image.data() + static_cast<std::size_t>(simd::reflectBorder(row + k - half_size_y, rows)) * cols;
 
-  // Applying the rest of the y filter.
-  #pragma omp parallel for schedule(dynamic)
-  for (int row = half_sigma_y; row < image.rows() - half_sigma_y; row++)
-  {
-    out->row(row) =  kernel_y * image.block(row - half_sigma_y, 0, sigma_y, out->cols());
-  }
-
-  const int sigma_x = static_cast<int>(kernel_x.cols());
-  const int half_sigma_x = static_cast<int>(kernel_x.cols() / 2);
+      float* line_cols = line.data() + half_size_x;
+      simd::convolveColumnsF32(rows_y.data(), kernel_y.data(), size_y, line_cols, cols);
 
-  // Convolving with the horizontal filter is easy. Rather than using the kernel
-  // as a sliding window, we use the row pixels as a sliding window around the
-  // filter. We prepend and append the proper border values so that we are sure
-  // to end up with the correct convolved values.
-  Eigen::RowVectorXf temp_row(image.cols() + sigma_x - 1);
-
-  #pragma omp parallel for firstprivate(temp_row), schedule(dynamic)
-  for (int row = 0; row < out->rows(); row++)
-  {
-    temp_row.head(half_sigma_x) =
-      out->row(row).segment(1, half_sigma_x).reverse();
-    temp_row.segment(half_sigma_x, image.cols()) = out->row(row);
-    temp_row.tail(half_sigma_x) =
-      out->row(row)
-      .segment(image.cols() - 2 - half_sigma_x, half_sigma_x)
-      .reverse();
+      for(int k = 1; k <= half_size_x; ++k)
+      {
+        line_cols[-k] = line_cols[simd::reflectBorder(-k, cols)];
+        line_cols[cols - 1 + k] = line_cols[simd::reflectBorder(cols - 1 + k, cols)];
+      }
 
-    // Convolve the row. We perform the first step here explicitly so that we
-    // avoid setting the row equal to zero.
-    out->row(row) = kernel_x(0) * temp_row.head(image.cols());
-    for (int i = 1; i < sigma_x; i++) {
-      out->row(row) += kernel_x(i) * temp_row.segment(i, image.cols());
+      simd::convolveRowF32(line.data(), kernel_x.data(), size_x, out->data() + static_cast<std::size_t>(row) * cols, cols);
     }
   }
 }
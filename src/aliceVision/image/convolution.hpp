@@ -209,9 +209,25 @@ void ImageSeparableConvolution( const Image<float> & img ,
   const VecKernel horiz_k_cast = horiz_k.template cast< typename aliceVision::Accumulator<pix_t>::Type >();
   const VecKernel vert_k_cast = vert_k.template cast< typename aliceVision::Accumulator<pix_t>::Type >();
 
-  out.resize(img.Width(), img.Height());
+  out.resize(img.Width(), img.Height(), false);
   SeparableConvolution2d(img.GetMat(), horiz_k_cast, vert_k_cast, &((Image<float>::Base&)out));
 }
 
+// Specialization for Image<unsigned char>: the convolution is computed in float
+// and the result is rounded and saturated
+template<typename Kernel>
+void ImageSeparableConvolution( const Image<unsigned char> & img ,
+                                const Kernel & horiz_k ,
+                                const Kernel & vert_k ,
+                                Image<unsigned char> & out)
+{
+  const Image<float> imgFloat(img.GetMat().cast<float>());
+  Image<float> outFloat;
+  ImageSeparableConvolution(imgFloat, horiz_k, vert_k, outFloat);
+
+  out.resize(img.Width(), img.Height(), false);
+  out.array() = outFloat.array().round().max(0.f).min(255.f).cast<unsigned char>();
+}
+
 } // namespace image
 } // namespace aliceVision
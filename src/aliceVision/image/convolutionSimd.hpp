@@ -0,0 +1,273 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/config.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <emmintrin.h>
+#endif
+
+#include <cstdint>
+
+/**
+ ** @file Row kernels of the separable convolutions and of the half sampling,
+ ** vectorized with AVX2 or SSE2 if available. The loads are unaligned, so the rows
+ ** of an image can be used directly.
+ **/
+
+namespace aliceVision {
+namespace image {
+namespace simd {
+
+/**
+ * @brief Index of a pixel mirrored at the borders without duplicating the border pixel (reflect 101)
+ * @param i the pixel index, possibly out of [0, size)
+ * @param size the number of pixels
+ */
+inline int reflectBorder(int i, int size)
+{
+  if(size == 1)
+    return 0;
+  while(i < 0 || i >= size)
+  {
+    if(i < 0)
+      i = -i;
+    if(i >= size)
+      i = 2 * (size - 1) - i;
+  }
+  return i;
+}
+
+#if defined(__AVX2__)
+/// a * b + c
+inline __m256 madd(__m256 a, __m256 b, __m256 c)
+{
+#if defined(__FMA__)
+  return _mm256_fmadd_ps(a, b, c);
+#else
+  return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+/**
+ * @brief Vertical convolution of rows: out[x] = sum_k kernel[k] * rows[k][x]
+ * @param rows the ksize input rows
+ * @param kernel the kernel values
+ * @param ksize the kernel size
+ * @param out the output row
+ * @param width the row length
+ */
+inline void convolveColumnsF32(const float* const* rows, const float* kernel, int ksize, float* out, int width)
+{
+  int x = 0;
+
+#if defined(__AVX2__)
+  // 4 independent sums to hide the latency of the additions
+  for(; x + 32 <= width; x += 32)
+  {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 sum2 = _mm256_setzero_ps();
+    __m256 sum3 = _mm256_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+    {
+      const __m256 weight = _mm256_set1_ps(kernel[k]);
+      const float* row = rows[k] + x;
+      sum0 = madd(weight, _mm256_loadu_ps(row), sum0);
+      sum1 = madd(weight, _mm256_loadu_ps(row + 8), sum1);
+      sum2 = madd(weight, _mm256_loadu_ps(row + 16), sum2);
+      sum3 = madd(weight, _mm256_loadu_ps(row + 24), sum3);
+    }
+    _mm256_storeu_ps(out + x, sum0);
+    _mm256_storeu_ps(out + x + 8, sum1);
+    _mm256_storeu_ps(out + x + 16, sum2);
+    _mm256_storeu_ps(out + x + 24, sum3);
+  }
+  for(; x + 8 <= width; x += 8)
+  {
+    __m256 sum = _mm256_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+      sum = madd(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(rows[k] + x), sum);
+    _mm256_storeu_ps(out + x, sum);
+  }
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  for(; x + 8 <= width; x += 8)
+  {
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+    {
+      const __m128 weight = _mm_set1_ps(kernel[k]);
+      sum0 = _mm_add_ps(sum0, _mm_mul_ps(weight, _mm_loadu_ps(rows[k] + x)));
+      sum1 = _mm_add_ps(sum1, _mm_mul_ps(weight, _mm_loadu_ps(rows[k] + x + 4)));
+    }
+    _mm_storeu_ps(out + x, sum0);
+    _mm_storeu_ps(out + x + 4, sum1);
+  }
+  for(; x + 4 <= width; x += 4)
+  {
+    __m128 sum = _mm_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[k]), _mm_loadu_ps(rows[k] + x)));
+    _mm_storeu_ps(out + x, sum);
+  }
+#endif
+
+  for(; x < width; ++x)
+  {
+    float sum = 0.f;
+    for(int k = 0; k < ksize; ++k)
+      sum += kernel[k] * rows[k][x];
+    out[x] = sum;
+  }
+}
+
+/**
+ * @brief Horizontal convolution of an extended row [ksize / 2][row][ksize / 2]:
+ * out[x] = sum_k kernel[k] * line[x + k]
+ * @param line the extended input row
+ * @param kernel the kernel values
+ * @param ksize the kernel size
+ * @param out the output row, it must not overlap the input row
+ * @param width the row length
+ */
+inline void convolveRowF32(const float* line, const float* kernel, int ksize, float* out, int width)
+{
+  int x = 0;
+
+#if defined(__AVX2__)
+  for(; x + 32 <= width; x += 32)
+  {
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    __m256 sum2 = _mm256_setzero_ps();
+    __m256 sum3 = _mm256_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+    {
+      const __m256 weight = _mm256_set1_ps(kernel[k]);
+      const float* in = line + x + k;
+      sum0 = madd(weight, _mm256_loadu_ps(in), sum0);
+      sum1 = madd(weight, _mm256_loadu_ps(in + 8), sum1);
+      sum2 = madd(weight, _mm256_loadu_ps(in + 16), sum2);
+      sum3 = madd(weight, _mm256_loadu_ps(in + 24), sum3);
+    }
+    _mm256_storeu_ps(out + x, sum0);
+    _mm256_storeu_ps(out + x + 8, sum1);
+    _mm256_storeu_ps(out + x + 16, sum2);
+    _mm256_storeu_ps(out + x + 24, sum3);
+  }
+  for(; x + 8 <= width; x += 8)
+  {
+    __m256 sum = _mm256_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+      sum = madd(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(line + x + k), sum);
+    _mm256_storeu_ps(out + x, sum);
+  }
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  for(; x + 8 <= width; x += 8)
+  {
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+    {
+      const __m128 weight = _mm_set1_ps(kernel[k]);
+      sum0 = _mm_add_ps(sum0, _mm_mul_ps(weight, _mm_loadu_ps(line + x + k)));
+      sum1 = _mm_add_ps(sum1, _mm_mul_ps(weight, _mm_loadu_ps(line + x + k + 4)));
+    }
+    _mm_storeu_ps(out + x, sum0);
+    _mm_storeu_ps(out + x + 4, sum1);
+  }
+  for(; x + 4 <= width; x += 4)
+  {
+    __m128 sum = _mm_setzero_ps();
+    for(int k = 0; k < ksize; ++k)
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel[k]), _mm_loadu_ps(line + x + k)));
+    _mm_storeu_ps(out + x, sum);
+  }
+#endif
+
+  for(; x < width; ++x)
+  {
+    float sum = 0.f;
+    for(int k = 0; k < ksize; ++k)
+      sum += kernel[k] * line[x + k];
+    out[x] = sum;
+  }
+}
+
+/**
+ * @brief Keep the odd pixels of a row: out[x] = in[2 * x + 1]
+ * @param in the input row, of at least 2 * width values
+ * @param out the output row
+ * @param width the output row length
+ */
+inline void halfSampleRowF32(const float* in, float* out, int width)
+{
+  int x = 0;
+
+#if defined(__AVX2__)
+  for(; x + 8 <= width; x += 8)
+  {
+    const __m256 a = _mm256_loadu_ps(in + 2 * x);
+    const __m256 b = _mm256_loadu_ps(in + 2 * x + 8);
+    // a1 a3 b1 b3 | a5 a7 b5 b7
+    const __m256 odd = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm256_storeu_ps(out + x, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(odd), _MM_SHUFFLE(3, 1, 2, 0))));
+  }
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  for(; x + 4 <= width; x += 4)
+  {
+    const __m128 a = _mm_loadu_ps(in + 2 * x);
+    const __m128 b = _mm_loadu_ps(in + 2 * x + 4);
+    _mm_storeu_ps(out + x, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+#endif
+
+  for(; x < width; ++x)
+    out[x] = in[2 * x + 1];
+}
+
+/**
+ * @brief Keep the odd pixels of a row: out[x] = in[2 * x + 1]
+ * @param in the input row, of at least 2 * width values
+ * @param out the output row
+ * @param width the output row length
+ */
+inline void halfSampleRowU8(const std::uint8_t* in, std::uint8_t* out, int width)
+{
+  int x = 0;
+
+#if defined(__AVX2__)
+  for(; x + 32 <= width; x += 32)
+  {
+    // odd bytes in the low byte of each 16 bits value
+    const __m256i a = _mm256_srli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * x)), 8);
+    const __m256i b = _mm256_srli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * x + 32)), 8);
+    // the pack works on 128 bits lanes
+    const __m256i odd = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), odd);
+  }
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  for(; x + 16 <= width; x += 16)
+  {
+    const __m128i a = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * x)), 8);
+    const __m128i b = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * x + 16)), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(a, b));
+  }
+#endif
+
+  for(; x < width; ++x)
+    out[x] = in[2 * x + 1];
+}
+
+} // namespace simd
+} // namespace image
+} // namespace aliceVision
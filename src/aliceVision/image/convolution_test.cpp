@@ -0,0 +1,195 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/image/convolutionSimd.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <cmath>
+#include <random>
+
+#define BOOST_TEST_MODULE ImageConvolution
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+Image<float> createRandomImage(int width, int height)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(0.f, 255.f);
+  Image<float> image(width, height, false);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = distribution(generator);
+  return image;
+}
+
+/**
+ * @brief Direct 2D separable convolution with mirrored borders (reflect 101), in double
+ */
+Image<float> referenceSeparableConvolution(const Image<float>& image, const Vec& kernelX, const Vec& kernelY)
+{
+  const int halfX = kernelX.size() / 2;
+  const int halfY = kernelY.size() / 2;
+  Image<float> out(image.Width(), image.Height(), false);
+
+  for(int y = 0; y < image.Height(); ++y)
+  {
+    for(int x = 0; x < image.Width(); ++x)
+    {
+      double sum = 0.0;
+      for(int ky = 0; ky < kernelY.size(); ++ky)
+        for(int kx = 0; kx < kernelX.size(); ++kx)
+          sum += kernelY(ky) * kernelX(kx) * image(simd::reflectBorder(y + ky - halfY, image.Height()),
+                                                   simd::reflectBorder(x + kx - halfX, image.Width()));
+      out(y, x) = static_cast<float>(sum);
+    }
+  }
+  return out;
+}
+
+BOOST_AUTO_TEST_CASE(Convolution_reflectBorder)
+{
+  BOOST_CHECK_EQUAL(simd::reflectBorder(-1, 5), 1);
+  BOOST_CHECK_EQUAL(simd::reflectBorder(-3, 5), 3);
+  BOOST_CHECK_EQUAL(simd::reflectBorder(2, 5), 2);
+  BOOST_CHECK_EQUAL(simd::reflectBorder(5, 5), 3);
+  BOOST_CHECK_EQUAL(simd::reflectBorder(7, 5), 1);
+  BOOST_CHECK_EQUAL(simd::reflectBorder(-4, 2), 0);
+  BOOST_CHECK_EQUAL(simd::reflectBorder(3, 1), 0);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Separable convolutions of images whose sizes are not multiple of the SIMD width,
+//   with kernels larger than the images
+// - Compare to the direct 2D convolution
+//-----------------
+BOOST_AUTO_TEST_CASE(Convolution_separableFloat)
+{
+  const int sizes[][2] = {{1, 1}, {3, 2}, {17, 13}, {64, 48}, {101, 37}};
+  const int kernelSizes[] = {1, 3, 5, 9, 25};
+
+  for(const auto& size : sizes)
+  {
+    const Image<float> image = createRandomImage(size[0], size[1]);
+
+    for(int kernelSize : kernelSizes)
+    {
+      const Vec kernelX = ComputeGaussianKernel(kernelSize, kernelSize / 4.0 + 0.5);
+      Vec kernelY = Vec::LinSpaced(kernelSize, -1.0, 1.0);
+
+      Image<float> out;
+      ImageSeparableConvolution(image, kernelX, kernelY, out);
+      const Image<float> reference = referenceSeparableConvolution(image, kernelX, kernelY);
+
+      BOOST_REQUIRE_EQUAL(out.Width(), image.Width());
+      BOOST_REQUIRE_EQUAL(out.Height(), image.Height());
+      BOOST_CHECK_SMALL((out - reference).cwiseAbs().maxCoeff(), 1e-3f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Convolution_separableUChar)
+{
+  const Image<float> imageFloat = createRandomImage(75, 41);
+  const Image<unsigned char> image(imageFloat.cast<unsigned char>());
+  const Vec3 kernel(0.25, 0.5, 0.25);
+
+  Image<unsigned char> out;
+  ImageSeparableConvolution(image, kernel, kernel, out);
+  const Image<float> reference = referenceSeparableConvolution(Image<float>(image.cast<float>()), kernel, kernel);
+
+  for(int y = 0; y < image.Height(); ++y)
+    for(int x = 0; x < image.Width(); ++x)
+      BOOST_CHECK_LE(std::abs(static_cast<float>(out(y, x)) - reference(y, x)), 0.5f + 1e-3f);
+
+  // saturation
+  const Vec3 gain(0.0, 2.0, 0.0);
+  ImageSeparableConvolution(image, gain, gain, out);
+  for(int y = 0; y < image.Height(); ++y)
+    for(int x = 0; x < image.Width(); ++x)
+      BOOST_CHECK_EQUAL(static_cast<int>(out(y, x)), std::min(255, 4 * image(y, x)));
+}
+
+BOOST_AUTO_TEST_CASE(Convolution_scharr)
+{
+  const Image<float> image = createRandomImage(50, 33);
+
+  Image<float> Lx, Ly;
+  ImageScharrXDerivative(image, Lx, false);
+  ImageScharrYDerivative(image, Ly, false);
+
+  const Image<float> referenceX = referenceSeparableConvolution(image, Vec3(-1.0, 0.0, 1.0), Vec3(3.0, 10.0, 3.0));
+  const Image<float> referenceY = referenceSeparableConvolution(image, Vec3(3.0, 10.0, 3.0), Vec3(-1.0, 0.0, 1.0));
+  BOOST_CHECK_SMALL((Lx - referenceX).cwiseAbs().maxCoeff(), 1e-2f);
+  BOOST_CHECK_SMALL((Ly - referenceY).cwiseAbs().maxCoeff(), 1e-2f);
+
+  // the derivatives of the mirrored borders are null
+  for(int y = 0; y < image.Height(); ++y)
+  {
+    BOOST_CHECK_EQUAL(Lx(y, 0), 0.f);
+    BOOST_CHECK_EQUAL(Lx(y, image.Width() - 1), 0.f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Convolution_halfSample)
+{
+  const Image<float> imageFloat = createRandomImage(71, 38);
+  const Image<unsigned char> imageUChar(imageFloat.cast<unsigned char>());
+
+  // generic bilinear half sampling
+  const Sampler2d<SamplerLinear> sampler;
+
+  Image<float> outFloat;
+  ImageHalfSample(imageFloat, outFloat);
+  BOOST_REQUIRE_EQUAL(outFloat.Width(), 35);
+  BOOST_REQUIRE_EQUAL(outFloat.Height(), 19);
+
+  Image<unsigned char> outUChar;
+  ImageHalfSample(imageUChar, outUChar);
+  BOOST_REQUIRE_EQUAL(outUChar.Width(), 35);
+  BOOST_REQUIRE_EQUAL(outUChar.Height(), 19);
+
+  for(int i = 0; i < outFloat.Height(); ++i)
+  {
+    for(int j = 0; j < outFloat.Width(); ++j)
+    {
+      BOOST_CHECK_EQUAL(outFloat(i, j), sampler(imageFloat, 2.f * (i + .5f), 2.f * (j + .5f)));
+      BOOST_CHECK_EQUAL(outUChar(i, j), sampler(imageUChar, 2.f * (i + .5f), 2.f * (j + .5f)));
+    }
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Report the throughput of the gaussian filter, the Scharr derivatives and the half sampling
+//   on a 4000x3000 image (no timing check)
+//-----------------
+BOOST_AUTO_TEST_CASE(Convolution_throughput)
+{
+  const Image<float> image = createRandomImage(4000, 3000);
+  const double megaPixels = image.size() / 1e6;
+  Image<float> out;
+
+  system::Timer timer;
+  ImageGaussianFilter(image, 1.6, out);
+  BOOST_TEST_MESSAGE("gaussian filter (sigma 1.6): " << megaPixels / timer.elapsed() << " MPix/s");
+
+  timer.reset();
+  ImageScharrXDerivative(image, out, false);
+  BOOST_TEST_MESSAGE("Scharr derivative: " << megaPixels / timer.elapsed() << " MPix/s");
+
+  timer.reset();
+  ImageHalfSample(image, out);
+  BOOST_TEST_MESSAGE("half sampling: " << megaPixels / timer.elapsed() << " MPix/s");
+
+  BOOST_CHECK_EQUAL(out.Width(), 2000);
+}
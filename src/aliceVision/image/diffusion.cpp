@@ -0,0 +1,186 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "diffusion.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+namespace aliceVision {
+namespace image {
+namespace {
+
+/**
+ ** FED step of a row, pixel j: out = src + half_t * (fluxes with the 4 neighbors).
+ ** A neighbor out of the image is replaced by the pixel itself, so its flux is null.
+ **/
+inline float FEDPixel(const float* srcUp, const float* src, const float* srcDown,
+                      const float* diffUp, const float* diff, const float* diffDown,
+                      const float half_t, const int j, const int width)
+{
+  const int left = std::max(j - 1, 0);
+  const int right = std::min(j + 1, width - 1);
+  const float cur_src = src[j];
+  const float cur_diff = diff[j];
+  const float a = (cur_diff + diff[right]) * (src[right] - cur_src);
+  const float b = (cur_diff + diffUp[j]) * (cur_src - srcUp[j]);
+  const float c = (cur_diff + diff[left]) * (cur_src - src[left]);
+  const float d = (cur_diff + diffDown[j]) * (srcDown[j] - cur_src);
+  return cur_src + half_t * (a - c + d - b);
+}
+
+/**
+ ** FED step of a row, the upper/lower rows are the row itself on the first/last row
+ **/
+void FEDRow(const float* srcUp, const float* src, const float* srcDown,
+            const float* diffUp, const float* diff, const float* diffDown,
+            const float half_t, float* out, const int width)
+{
+  out[0] = FEDPixel(srcUp, src, srcDown, diffUp, diff, diffDown, half_t, 0, width);
+  if(width == 1)
+    return;
+
+  int j = 1;
+  const int end = width - 1;
+
+#if defined(__AVX2__)
+  const __m256 halfT = _mm256_set1_ps(half_t);
+  for(; j + 8 <= end; j += 8)
+  {
+    const __m256 cur_src = _mm256_loadu_ps(src + j);
+    const __m256 cur_diff = _mm256_loadu_ps(diff + j);
+    const __m256 a = _mm256_mul_ps(_mm256_add_ps(cur_diff, _mm256_loadu_ps(diff + j + 1)), _mm256_sub_ps(_mm256_loadu_ps(src + j + 1), cur_src));
+    const __m256 b = _mm256_mul_ps(_mm256_add_ps(cur_diff, _mm256_loadu_ps(diffUp + j)), _mm256_sub_ps(cur_src, _mm256_loadu_ps(srcUp + j)));
+    const __m256 c = _mm256_mul_ps(_mm256_add_ps(cur_diff, _mm256_loadu_ps(diff + j - 1)), _mm256_sub_ps(cur_src, _mm256_loadu_ps(src + j - 1)));
+    const __m256 d = _mm256_mul_ps(_mm256_add_ps(cur_diff, _mm256_loadu_ps(diffDown + j)), _mm256_sub_ps(_mm256_loadu_ps(srcDown + j), cur_src));
+    const __m256 flux = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(a, c), d), b);
+    _mm256_storeu_ps(out + j, _mm256_add_ps(cur_src, _mm256_mul_ps(halfT, flux)));
+  }
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  const __m128 halfT = _mm_set1_ps(half_t);
+  for(; j + 4 <= end; j += 4)
+  {
+    const __m128 cur_src = _mm_loadu_ps(src + j);
+    const __m128 cur_diff = _mm_loadu_ps(diff + j);
+    const __m128 a = _mm_mul_ps(_mm_add_ps(cur_diff, _mm_loadu_ps(diff + j + 1)), _mm_sub_ps(_mm_loadu_ps(src + j + 1), cur_src));
+    const __m128 b = _mm_mul_ps(_mm_add_ps(cur_diff, _mm_loadu_ps(diffUp + j)), _mm_sub_ps(cur_src, _mm_loadu_ps(srcUp + j)));
+    const __m128 c = _mm_mul_ps(_mm_add_ps(cur_diff, _mm_loadu_ps(diff + j - 1)), _mm_sub_ps(cur_src, _mm_loadu_ps(src + j - 1)));
+    const __m128 d = _mm_mul_ps(_mm_add_ps(cur_diff, _mm_loadu_ps(diffDown + j)), _mm_sub_ps(_mm_loadu_ps(srcDown + j), cur_src));
+    const __m128 flux = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(a, c), d), b);
+    _mm_storeu_ps(out + j, _mm_add_ps(cur_src, _mm_mul_ps(halfT, flux)));
+  }
+#endif
+
+  for(; j < width; ++j)
+    out[j] = FEDPixel(srcUp, src, srcDown, diffUp, diff, diffDown, half_t, j, width);
+}
+
+} // namespace
+
+void ImageFEDStep(const Image<float>& src, const Image<float>& diff, const float t, Image<float>& out)
+{
+  const int width = src.Width();
+  const int height = src.Height();
+  const float half_t = t * 0.5f;
+
+  out.resize(width, height, false);
+
+  // each thread streams a contiguous block of rows, the 3 input rows of a step stay in cache
+  #pragma omp parallel for schedule(static)
+  for(int i = 0; i < height; ++i)
+  {
+    const int up = std::max(i - 1, 0);
+    const int down = std::min(i + 1, height - 1);
+    FEDRow(src.data() + static_cast<std::size_t>(up) * width,
+           src.data() + static_cast<std::size_t>(i) * width,
+           src.data() + static_cast<std::size_t>(down) * width,
+           diff.data() + static_cast<std::size_t>(up) * width,
+           diff.data() + static_cast<std::size_t>(i) * width,
+           diff.data() + static_cast<std::size_t>(down) * width,
+           half_t, out.data() + static_cast<std::size_t>(i) * width, width);
+  }
+}
+
+void ImageFEDCycle(Image<float>& self, const Image<float>& diff, const std::vector<float>& tau)
+{
+  const int nbSteps = static_cast<int>(tau.size());
+  const int width = self.Width();
+  const int height = self.Height();
+
+  if(nbSteps == 0 || width == 0 || height == 0)
+    return;
+
+  // the images of a step (source, diffusivity and output) of a few MB stay in cache between the steps
+  if(3 * static_cast<std::size_t>(width) * height * sizeof(float) <= (static_cast<std::size_t>(8) << 20))
+  {
+    Image<float> tmp;
+    for(int s = 0; s < nbSteps; ++s)
+    {
+      ImageFEDStep(self, diff, tau[s], tmp);
+      self.swap(tmp);
+    }
+    return;
+  }
+
+  // the steps of a band of rows are computed row by row, the step s following the step s-1 one row behind,
+  // so that the intermediate steps only keep 3 rows in cache instead of streaming full images.
+  // each band also computes the intermediate rows of the nbSteps-1 rows around it needed by its last step,
+  // the bands are large compared to these rows, with at least a band per thread
+  const int nbThreads = omp_get_max_threads();
+  const int bandHeight = std::max(std::min(128, (height + nbThreads - 1) / nbThreads), 4 * nbSteps);
+  const int nbBands = (height + bandHeight - 1) / bandHeight;
+  Image<float> out(width, height, false);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int band = 0; band < nbBands; ++band)
+  {
+    const int bandBegin = band * bandHeight;
+    const int bandEnd = std::min(bandBegin + bandHeight, height);
+
+    // 3 rows ring buffer of each intermediate step, the row i of a step is in the slot i % 3
+    std::vector<float> rings(static_cast<std::size_t>(nbSteps - 1) * 3 * width);
+    const auto row = [&](int step, int i) -> const float*
+    {
+      i = std::min(std::max(i, 0), height - 1);
+      if(step < 0)
+        return self.data() + static_cast<std::size_t>(i) * width;
+      return &rings[(static_cast<std::size_t>(step) * 3 + i % 3) * width];
+    };
+
+    // the step s computes the rows [bandBegin - margin, bandEnd + margin), margin = nbSteps - 1 - s
+    const int lastRow = bandEnd - 1 + (nbSteps - 1);
+    for(int t = std::max(bandBegin - (nbSteps - 1), 0); t <= lastRow; ++t)
+    {
+      for(int s = 0; s < nbSteps; ++s)
+      {
+        const int i = t - s;
+        const int margin = nbSteps - 1 - s;
+        if(i < std::max(bandBegin - margin, 0) || i >= std::min(bandEnd + margin, height))
+          continue;
+
+        float* rowOut = (s == nbSteps - 1) ? out.data() + static_cast<std::size_t>(i) * width
+                                            : &rings[(static_cast<std::size_t>(s) * 3 + i % 3) * width];
+        FEDRow(row(s - 1, i - 1), row(s - 1, i), row(s - 1, i + 1),
+               diff.data() + static_cast<std::size_t>(std::max(i - 1, 0)) * width,
+               diff.data() + static_cast<std::size_t>(i) * width,
+               diff.data() + static_cast<std::size_t>(std::min(i + 1, height - 1)) * width,
+               tau[s] * 0.5f, rowOut, width);
+      }
+    }
+  }
+
+  self.swap(out);
+}
+
+} // namespace image
+} // namespace aliceVision
@@ -9,6 +9,7 @@
 
 #include <aliceVision/config.hpp>
 #include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/image/Image.hpp>
 
 #include <vector>
 
@@ -235,6 +236,28 @@ void ImageFEDCycle( Image & self , const Image & diff , const std::vector< typen
   }
 }
 
+/**
+ ** Apply a Fast Explicit Diffusion step to a float image and update it in a single pass:
+ ** out = src + FED(src), parallel over the rows and vectorized.
+ ** The borders have no flux (the missing neighbors are replaced by the pixel itself).
+ ** @param src input image
+ ** @param diff diffusion coefficient image
+ ** @param t diffusion time
+ ** @param out output image, it must not be src
+ **/
+void ImageFEDStep( const Image<float> & src , const Image<float> & diff , const float t , Image<float> & out ) ;
+
+/**
+ ** Compute Fast Explicit Diffusion cycle of a float image, with fused steps (see ImageFEDStep).
+ ** The steps of the images larger than the cache are blocked: the image is processed by bands of rows,
+ ** in parallel, and all the steps of a band are computed while its rows are in cache.
+ ** The result is the same as successive ImageFEDStep.
+ ** @param self input/output image
+ ** @param diff diffusion coefficient
+ ** @param tau cycle timing vector
+ **/
+void ImageFEDCycle( Image<float> & self , const Image<float> & diff , const std::vector<float> & tau ) ;
+
 // Compute if a number is prime of not
 inline bool IsPrime( const int i )
 {
@@ -0,0 +1,139 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/all.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE ImageDiffusion
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+Image<float> createRandomImage(int width, int height, float minValue, float maxValue)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(minValue, maxValue);
+  Image<float> image(width, height, false);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = distribution(generator);
+  return image;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Compare the fused FED step to the generic ImageFED + update,
+//   on images whose widths are not multiple of the SIMD width
+// - The corners, not computed by ImageFED, have no flux through the borders
+//-----------------
+BOOST_AUTO_TEST_CASE(Diffusion_FEDStep)
+{
+  const int sizes[][2] = {{3, 3}, {17, 5}, {64, 48}, {101, 37}};
+
+  for(const auto& size : sizes)
+  {
+    const int width = size[0];
+    const int height = size[1];
+    const Image<float> src = createRandomImage(width, height, 0.f, 1.f);
+    const Image<float> diff = createRandomImage(width, height, 0.1f, 1.f);
+    const float t = 0.2f;
+
+    Image<float> out;
+    ImageFEDStep(src, diff, t, out);
+    BOOST_REQUIRE_EQUAL(out.Width(), width);
+    BOOST_REQUIRE_EQUAL(out.Height(), height);
+
+    Image<float> step;
+    ImageFED(src, diff, t, step);
+
+    for(int i = 0; i < height; ++i)
+    {
+      for(int j = 0; j < width; ++j)
+      {
+        const bool isCorner = (i == 0 || i == height - 1) && (j == 0 || j == width - 1);
+        if(!isCorner)
+          BOOST_CHECK_SMALL(out(i, j) - (src(i, j) + step(i, j)), 1e-5f);
+      }
+    }
+
+    // top left corner
+    const float a = (diff(0, 0) + diff(0, 1)) * (src(0, 1) - src(0, 0));
+    const float d = (diff(0, 0) + diff(1, 0)) * (src(1, 0) - src(0, 0));
+    BOOST_CHECK_SMALL(out(0, 0) - (src(0, 0) + 0.5f * t * (a + d)), 1e-5f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Diffusion_FEDCycle)
+{
+  const Image<float> src = createRandomImage(75, 41, 0.f, 1.f);
+  const Image<float> diff = createRandomImage(75, 41, 0.1f, 1.f);
+
+  std::vector<float> tau;
+  FEDCycleTimings(2.f, 0.25f, tau);
+
+  Image<float> out = src;
+  ImageFEDCycle(out, diff, tau);
+
+  // the diffusion without flux through the borders preserves the sum of the pixels
+  BOOST_CHECK_CLOSE(out.cast<double>().sum(), src.cast<double>().sum(), 1e-3);
+  // and smooths the image
+  BOOST_CHECK_LT(out.maxCoeff() - out.minCoeff(), src.maxCoeff() - src.minCoeff());
+
+  // a constant image is unchanged
+  Image<float> constant(20, 10, true, 0.5f);
+  ImageFEDCycle(constant, Image<float>(20, 10, true, 1.f), tau);
+  BOOST_CHECK_SMALL(std::abs(constant.maxCoeff() - 0.5f) + std::abs(constant.minCoeff() - 0.5f), 1e-6f);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Compare the FED cycle to successive FED steps, with images small enough to stay in cache,
+//   and images processed by bands of rows, whose last band is smaller, with cycles of 1 to many steps
+//-----------------
+BOOST_AUTO_TEST_CASE(Diffusion_FEDCycleBlocked)
+{
+  const int sizes[][2] = {{1, 1}, {9, 2}, {75, 41}, {2000, 700}, {4100, 260}};
+  const float cycleTimes[] = {0.1f, 2.f, 200.f};
+
+  for(const auto& size : sizes)
+  {
+    const int width = size[0];
+    const int height = size[1];
+    const Image<float> src = createRandomImage(width, height, 0.f, 1.f);
+    const Image<float> diff = createRandomImage(width, height, 0.1f, 1.f);
+
+    for(const float cycleTime : cycleTimes)
+    {
+      std::vector<float> tau;
+      FEDCycleTimings(cycleTime, 0.25f, tau);
+
+      Image<float> expected = src;
+      Image<float> tmp;
+      for(const float t : tau)
+      {
+        ImageFEDStep(expected, diff, t, tmp);
+        expected.swap(tmp);
+      }
+
+      Image<float> out = src;
+      ImageFEDCycle(out, diff, tau);
+      BOOST_REQUIRE_EQUAL(out.Width(), width);
+      BOOST_REQUIRE_EQUAL(out.Height(), height);
+      BOOST_CHECK_SMALL((out - expected).cwiseAbs().maxCoeff(), 1e-6f);
+    }
+  }
+
+  // no step
+  Image<float> out = createRandomImage(10, 10, 0.f, 1.f);
+  const Image<float> src = out;
+  ImageFEDCycle(out, Image<float>(10, 10, true, 1.f), std::vector<float>());
+  BOOST_CHECK_EQUAL((out - src).cwiseAbs().maxCoeff(), 0.f);
+}
@@ -6,6 +6,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/ImageCache.hpp>
 #include <aliceVision/image/all.hpp>
 
 #include <OpenImageIO/imageio.h>
@@ -97,6 +98,24 @@ void readImage(const std::string& path, oiio::TypeDesc format, int nchannels, Im
   // check requested channels number
   assert(nchannels == 1 || nchannels >= 3);
 
+  // get the decoded image from the shared cache
+  system::ImageCache& imageCache = system::ImageCache::getInstance();
+  const bool useCache = imageCache.isEnabled();
+  const std::string decoding = std::string(format.c_str()) + "x" + std::to_string(nchannels);
+  std::string fileStamp;
+
+  if(useCache)
+  {
+    fileStamp = system::ImageCache::getFileStamp(path);
+    const system::ImageCache::ImagePtr cachedImage = imageCache.get(path, decoding, fileStamp);
+    if(cachedImage)
+    {
+      image.resize(cachedImage->width, cachedImage->height, false);
+      std::memcpy(image.data(), cachedImage->data.data(), cachedImage->data.size());
+      return;
+    }
+  }
+
   oiio::ImageSpec configSpec;
 
   // libRAW configuration
@@ -158,6 +177,16 @@ void readImage(const std::string& path, oiio::TypeDesc format, int nchannels, Im
 
     inBuf.get_pixels(exportROI, format, image.data());
   }
+
+  if(useCache)
+  {
+    std::shared_ptr<system::ImageCache::Image> cachedImage = std::make_shared<system::ImageCache::Image>();
+    cachedImage->width = image.Width();
+    cachedImage->height = image.Height();
+    cachedImage->data.resize(image.size() * sizeof(T));
+    std::memcpy(cachedImage->data.data(), image.data(), cachedImage->data.size());
+    imageCache.add(path, decoding, fileStamp, cachedImage);
+  }
 }
 
 template<typename T>
@@ -205,6 +234,8 @@ void writeImage(const std::string& path,
 
   // rename temporay filename
   fs::rename(tmpPath, path);
+
+  system::ImageCache::getInstance().invalidate(path);
 }
 
 void readImage(const std::string& path, Image<float>& image)
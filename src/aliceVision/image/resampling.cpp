@@ -0,0 +1,38 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "resampling.hpp"
+#include "convolutionSimd.hpp"
+
+namespace aliceVision {
+namespace image {
+
+void ImageHalfSample(const Image<float>& src, Image<float>& out)
+{
+  const int new_width = src.Width() / 2;
+  const int new_height = src.Height() / 2;
+
+  out.resize(new_width, new_height, false);
+
+  #pragma omp parallel for schedule(static)
+  for(int i = 0; i < new_height; ++i)
+    simd::halfSampleRowF32(src.data() + static_cast<std::size_t>(2 * i + 1) * src.Width(), out.data() + static_cast<std::size_t>(i) * new_width, new_width);
+}
+
+void ImageHalfSample(const Image<unsigned char>& src, Image<unsigned char>& out)
+{
+  const int new_width = src.Width() / 2;
+  const int new_height = src.Height() / 2;
+
+  out.resize(new_width, new_height, false);
+
+  #pragma omp parallel for schedule(static)
+  for(int i = 0; i < new_height; ++i)
+    simd::halfSampleRowU8(src.data() + static_cast<std::size_t>(2 * i + 1) * src.Width(), out.data() + static_cast<std::size_t>(i) * new_width, new_width);
+}
+
+} // namespace image
+} // namespace aliceVision
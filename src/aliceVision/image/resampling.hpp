@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <aliceVision/image/Image.hpp>
 #include <aliceVision/image/Sampler.hpp>
 
 namespace aliceVision {
@@ -37,6 +38,15 @@ namespace image {
     }
   }
 
+  /**
+   ** Half sample specializations: the bilinear samples are the odd pixels of the input image,
+   ** which are copied with SIMD row kernels
+   ** @param src input image
+   ** @param out output image
+   **/
+  void ImageHalfSample( const Image<float> & src , Image<float> & out );
+  void ImageHalfSample( const Image<unsigned char> & src , Image<unsigned char> & out );
+
   /**
    ** @brief Ressample an image using given sampling positions
    ** @param src Input image
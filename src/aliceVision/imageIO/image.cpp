@@ -5,7 +5,9 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "image.hpp"
+#include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/ImageCache.hpp>
 #include <aliceVision/mvsData/Color.hpp>
 #include <aliceVision/mvsData/Rgb.hpp>
 
@@ -17,8 +19,15 @@
 
 #include <boost/filesystem.hpp>
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <memory>
+#include <type_traits>
 
 namespace fs = boost::filesystem;
 
@@ -107,19 +116,219 @@ void readImageMetadata(const std::string& path, oiio::ParamValueList& metadata)
   in->close();
 }
 
+/**
+ * @brief get the MIP level of an opened image whose size is the image size divided by a factor.
+ * The levels of a mipmapped file halve the size, so only the level of a power of 2 factor is checked.
+ * @return the MIP level, or 0 if the image has no such level
+ */
+static int getDownscaledMipLevel(const oiio::ImageBuf& inBuf, int downscale)
+{
+    if(downscale <= 1 || (downscale & (downscale - 1)) != 0)
+        return 0;
+
+    int level = 0;
+    while((1 << level) < downscale)
+        ++level;
+
+    return (level < inBuf.nmiplevels()) ? level : 0;
+}
+
+template<typename S>
+inline S boxAverage(float value, std::true_type /*isIntegral*/)
+{
+    return static_cast<S>(value + 0.5f);
+}
+
+template<typename S>
+inline S boxAverage(float value, std::false_type /*isIntegral*/)
+{
+    return static_cast<S>(value);
+}
+
+/**
+ * @brief add a row of pixels to a row of sums
+ */
+template<typename S>
+inline void addRow(const S* in, float* sum, int size)
+{
+    for(int i = 0; i < size; ++i)
+        sum[i] += in[i];
+}
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+inline void addRow(const float* in, float* sum, int size)
+{
+    int i = 0;
+    for(; i + 4 <= size; i += 4)
+        _mm_storeu_ps(sum + i, _mm_add_ps(_mm_loadu_ps(sum + i), _mm_loadu_ps(in + i)));
+    for(; i < size; ++i)
+        sum[i] += in[i];
+}
+
+inline void addRow(const unsigned char* in, float* sum, int size)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for(; i + 16 <= size; i += 16)
+    {
+        // 16 x 8 bits -> 2 x 8 x 16 bits -> 4 x 4 x 32 bits
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i words[2] = {_mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero)};
+        for(int k = 0; k < 2; ++k)
+        {
+            float* sum8 = sum + i + 8 * k;
+            _mm_storeu_ps(sum8, _mm_add_ps(_mm_loadu_ps(sum8), _mm_cvtepi32_ps(_mm_unpacklo_epi16(words[k], zero))));
+            _mm_storeu_ps(sum8 + 4, _mm_add_ps(_mm_loadu_ps(sum8 + 4), _mm_cvtepi32_ps(_mm_unpackhi_epi16(words[k], zero))));
+        }
+    }
+    for(; i < size; ++i)
+        sum[i] += in[i];
+}
+
+inline void addRow(const unsigned short* in, float* sum, int size)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(sum + i, _mm_add_ps(_mm_loadu_ps(sum + i), _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero))));
+        _mm_storeu_ps(sum + i + 4, _mm_add_ps(_mm_loadu_ps(sum + i + 4), _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero))));
+    }
+    for(; i < size; ++i)
+        sum[i] += in[i];
+}
+#endif
+
+/**
+ * @brief sum the blocks of downscale consecutive pixels of a row of sums.
+ * The 3 channels pixels are summed with 4 lanes, so rowSum and blockSum have a padding float.
+ */
+inline void sumBlocks(const float* rowSum, int outWidth, int nchannels, int downscale, float* blockSum)
+{
+    int x = 0;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+    if(downscale == 2 && nchannels == 1)
+    {
+        // even + odd pixels
+        for(; x + 4 <= outWidth; x += 4)
+        {
+            const __m128 a = _mm_loadu_ps(rowSum + 2 * x);
+            const __m128 b = _mm_loadu_ps(rowSum + 2 * x + 4);
+            _mm_storeu_ps(blockSum + x, _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                                                   _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+    }
+    else if(downscale == 2 && nchannels == 3)
+    {
+        // the 4th lane is overwritten by the next pixel
+        for(; x < outWidth; ++x)
+            _mm_storeu_ps(blockSum + 3 * x, _mm_add_ps(_mm_loadu_ps(rowSum + 6 * x), _mm_loadu_ps(rowSum + 6 * x + 3)));
+    }
+#endif
+    for(; x < outWidth; ++x)
+    {
+        for(int c = 0; c < nchannels; ++c)
+        {
+            float sum = 0.0f;
+            for(int dx = 0; dx < downscale; ++dx)
+                sum += rowSum[(x * downscale + dx) * nchannels + c];
+            blockSum[x * nchannels + c] = sum;
+        }
+    }
+}
+
+/**
+ * @brief downscale an image by an integer factor with a box filter,
+ * the input rows of an output row are summed, then the blocks of these sums (vectorized with SSE2 if available)
+ */
+template<typename S>
+void downscaleImageBox(int inWidth, int inHeight, int nchannels, int downscale, const S* inBuffer, S* outBuffer)
+{
+    const int outWidth = inWidth / downscale;
+    const int outHeight = inHeight / downscale;
+    const int outRowSize = outWidth * nchannels;
+    const int blockRowSize = outRowSize * downscale;
+    const std::size_t inRowSize = static_cast<std::size_t>(inWidth) * nchannels;
+    const float norm = 1.0f / static_cast<float>(downscale * downscale);
+
+    #pragma omp parallel
+    {
+        std::vector<float> rowSum(blockRowSize + 1);
+        std::vector<float> blockSum(outRowSize + 1);
+
+        #pragma omp for
+        for(int y = 0; y < outHeight; ++y)
+        {
+            std::fill(rowSum.begin(), rowSum.end(), 0.0f);
+
+            for(int dy = 0; dy < downscale; ++dy)
+                addRow(inBuffer + static_cast<std::size_t>(y * downscale + dy) * inRowSize, rowSum.data(), blockRowSize);
+
+            sumBlocks(rowSum.data(), outWidth, nchannels, downscale, blockSum.data());
+
+            S* outRow = outBuffer + static_cast<std::size_t>(y) * outRowSize;
+            for(int i = 0; i < outRowSize; ++i)
+                outRow[i] = boxAverage<S>(blockSum[i] * norm, std::is_integral<S>());
+        }
+    }
+}
+
+template<typename T>
+void downscaleImageBox(oiio::TypeDesc typeDesc,
+                       int inWidth,
+                       int inHeight,
+                       int nchannels,
+                       int downscale,
+                       const std::vector<T>& inBuffer,
+                       std::vector<T>& outBuffer)
+{
+    outBuffer.resize((inWidth / downscale) * (inHeight / downscale));
+
+    if(typeDesc == oiio::TypeDesc::UCHAR)
+        downscaleImageBox(inWidth, inHeight, nchannels, downscale, reinterpret_cast<const unsigned char*>(inBuffer.data()), reinterpret_cast<unsigned char*>(outBuffer.data()));
+    else if(typeDesc == oiio::TypeDesc::UINT16)
+        downscaleImageBox(inWidth, inHeight, nchannels, downscale, reinterpret_cast<const unsigned short*>(inBuffer.data()), reinterpret_cast<unsigned short*>(outBuffer.data()));
+    else if(typeDesc == oiio::TypeDesc::FLOAT)
+        downscaleImageBox(inWidth, inHeight, nchannels, downscale, reinterpret_cast<const float*>(inBuffer.data()), reinterpret_cast<float*>(outBuffer.data()));
+    else
+        throw std::runtime_error("Unsupported pixel type for box downscale.");
+}
+
 template<typename T>
 void readImage(const std::string& path,
                oiio::TypeDesc typeDesc,
                int nchannels,
                int& width,
                int& height,
-               std::vector<T>& buffer)
+               std::vector<T>& buffer,
+               int downscale = 1)
 {
     ALICEVISION_LOG_DEBUG("[IO] Read Image: " << path);
 
     // check requested channels number
     assert(nchannels == 1 || nchannels >= 3);
 
+    // the image may have been decoded by another reader of the process
+    system::ImageCache& imageCache = system::ImageCache::getInstance();
+    const bool useCache = imageCache.isEnabled();
+    const std::string decoding = std::string(typeDesc.c_str()) + "x" + std::to_string(nchannels) + "/" + std::to_string(downscale);
+    std::string fileStamp;
+
+    if(useCache)
+    {
+        fileStamp = system::ImageCache::getFileStamp(path);
+        const system::ImageCache::ImagePtr cachedImage = imageCache.get(path, decoding, fileStamp);
+        if(cachedImage)
+        {
+            width = cachedImage->width;
+            height = cachedImage->height;
+            buffer.resize(cachedImage->data.size() / sizeof(T));
+            std::memcpy(buffer.data(), cachedImage->data.data(), cachedImage->data.size());
+            return;
+        }
+    }
+
     oiio::ImageSpec configSpec;
 
     // libRAW configuration
@@ -133,6 +342,23 @@ void readImage(const std::string& path,
     if(!inBuf.initialized())
         throw std::runtime_error("Can't find/open image file '" + path + "'.");
 
+    // read the MIP level of the downscaled size if the file has one (tiled EXR/TIFF)
+    int mipLevel = getDownscaledMipLevel(inBuf, downscale);
+    if(mipLevel > 0)
+    {
+        const int fullWidth = inBuf.spec().width;
+        const int fullHeight = inBuf.spec().height;
+
+        inBuf.reset(path, 0, mipLevel, NULL, &configSpec);
+
+        // the level may be rounded up, or the file may not be readable at this level
+        if(!inBuf.initialized() || inBuf.spec().width != fullWidth / downscale || inBuf.spec().height != fullHeight / downscale)
+        {
+            mipLevel = 0;
+            inBuf.reset(path, 0, 0, NULL, &configSpec);
+        }
+    }
+
     const oiio::ImageSpec& inSpec = inBuf.spec();
 
     // check picture channels number
@@ -184,6 +410,26 @@ void readImage(const std::string& path,
 
         inBuf.get_pixels(exportROI, typeDesc, buffer.data());
     }
+
+    // no MIP level, downscale the full resolution image
+    if(downscale > 1 && mipLevel == 0)
+    {
+        std::vector<T> downscaledBuffer;
+        downscaleImageBox(typeDesc, width, height, nchannels, downscale, buffer, downscaledBuffer);
+        buffer.swap(downscaledBuffer);
+        width /= downscale;
+        height /= downscale;
+    }
+
+    if(useCache)
+    {
+        std::shared_ptr<system::ImageCache::Image> cachedImage = std::make_shared<system::ImageCache::Image>();
+        cachedImage->width = width;
+        cachedImage->height = height;
+        cachedImage->data.resize(buffer.size() * sizeof(T));
+        std::memcpy(cachedImage->data.data(), buffer.data(), cachedImage->data.size());
+        imageCache.add(path, decoding, fileStamp, cachedImage);
+    }
 }
 
 void readImage(const std::string& path, int& width, int& height, std::vector<unsigned char>& buffer)
@@ -211,6 +457,46 @@ void readImage(const std::string& path, int& width, int& height, std::vector<Col
     readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, buffer);
 }
 
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<unsigned char>& buffer)
+{
+    readImage(path, oiio::TypeDesc::UCHAR, 1, width, height, buffer, downscale);
+}
+
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<rgb>& buffer)
+{
+    readImage(path, oiio::TypeDesc::UCHAR, 3, width, height, buffer, downscale);
+}
+
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<float>& buffer)
+{
+    readImage(path, oiio::TypeDesc::FLOAT, 1, width, height, buffer, downscale);
+}
+
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<Color>& buffer)
+{
+    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, buffer, downscale);
+}
+
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<unsigned char>& inBuffer, std::vector<unsigned char>& outBuffer)
+{
+    downscaleImageBox(oiio::TypeDesc::UCHAR, inWidth, inHeight, 1, downscale, inBuffer, outBuffer);
+}
+
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<rgb>& inBuffer, std::vector<rgb>& outBuffer)
+{
+    downscaleImageBox(oiio::TypeDesc::UCHAR, inWidth, inHeight, 3, downscale, inBuffer, outBuffer);
+}
+
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<float>& inBuffer, std::vector<float>& outBuffer)
+{
+    downscaleImageBox(oiio::TypeDesc::FLOAT, inWidth, inHeight, 1, downscale, inBuffer, outBuffer);
+}
+
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<Color>& inBuffer, std::vector<Color>& outBuffer)
+{
+    downscaleImageBox(oiio::TypeDesc::FLOAT, inWidth, inHeight, 3, downscale, inBuffer, outBuffer);
+}
+
 template<typename T>
 void writeImage(const std::string& path,
                 oiio::TypeDesc typeDesc,
@@ -269,6 +555,8 @@ void writeImage(const std::string& path,
 
     // rename temporay filename
     fs::rename(tmpPath, path);
+
+    system::ImageCache::getInstance().invalidate(path);
 }
 
 void writeImage(const std::string& path, int width, int height, const std::vector<unsigned char>& buffer, EImageQuality imageQuality, const oiio::ParamValueList& metadata)
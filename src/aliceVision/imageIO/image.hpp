@@ -101,6 +101,21 @@ void readImage(const std::string& path, int& width, int& height, std::vector<rgb
 void readImage(const std::string& path, int& width, int& height, std::vector<float>& buffer);
 void readImage(const std::string& path, int& width, int& height, std::vector<Color>& buffer);
 
+/**
+ * @brief read an image downscaled by an integer factor with a given path and buffer.
+ * The MIP level of the downscaled size is read if the file has one (tiled EXR/TIFF),
+ * otherwise the full resolution image is decoded and downscaled with downscaleImageBox.
+ * @param[in] path The given path to the image
+ * @param[in] downscale The downscale factor
+ * @param[out] width The output image width (input width / downscale)
+ * @param[out] height The output image height (input height / downscale)
+ * @param[out] buffer The output image buffer
+ */
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<unsigned char>& buffer);
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<rgb>& buffer);
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<float>& buffer);
+void readImageDownscaled(const std::string& path, int downscale, int& width, int& height, std::vector<Color>& buffer);
+
 /**
  * @brief write an image with a given path and buffer
  * @param[in] path The given path to the image
@@ -125,6 +140,22 @@ void transposeImage(int width, int height, std::vector<rgb>& buffer);
 void transposeImage(int width, int height, std::vector<float>& buffer);
 void transposeImage(int width, int height, std::vector<Color>& buffer);
 
+/**
+ * @brief downscale a given image buffer by an integer factor with a box filter,
+ * each output pixel is the average of a downscale x downscale block of input pixels.
+ * Unlike resizeImage, the last input columns and rows that do not fill a block are dropped
+ * instead of stretching the image, so the output pixels keep the same footprint as the downscaled camera.
+ * @param[in] inWidth The input image buffer width
+ * @param[in] inHeight The input image buffer height
+ * @param[in] downscale The downscale factor
+ * @param[in] inBuffer The input image buffer
+ * @param[out] outBuffer The output image buffer, of size (inWidth / downscale) x (inHeight / downscale)
+ */
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<unsigned char>& inBuffer, std::vector<unsigned char>& outBuffer);
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<rgb>& inBuffer, std::vector<rgb>& outBuffer);
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<float>& inBuffer, std::vector<float>& outBuffer);
+void downscaleImageBox(int inWidth, int inHeight, int downscale, const std::vector<Color>& inBuffer, std::vector<Color>& outBuffer);
+
 /**
  * @brief resize a given image buffer
  * @param[in] inWidth The input image buffer width
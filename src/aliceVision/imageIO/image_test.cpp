@@ -0,0 +1,208 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/imageIO/image.hpp>
+#include <aliceVision/mvsData/Color.hpp>
+#include <aliceVision/mvsData/Rgb.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE imageIO
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::imageIO;
+
+namespace bfs = boost::filesystem;
+
+/**
+ * @brief Pixel value of a channel of the test images, in [0, 255]
+ */
+inline int pixelValue(int x, int y, int c)
+{
+  return (x * 37 + y * 11 + c * 71) % 256;
+}
+
+/**
+ * @brief Reference box downscale of a channel of the test images
+ */
+inline float boxValue(int x, int y, int c, int downscale)
+{
+  float sum = 0.0f;
+  for(int dy = 0; dy < downscale; ++dy)
+    for(int dx = 0; dx < downscale; ++dx)
+      sum += pixelValue(x * downscale + dx, y * downscale + dy, c);
+  return sum / (downscale * downscale);
+}
+
+// sizes which are not multiples of the downscale factors
+const int width = 23;
+const int height = 14;
+const int downscales[3] = {2, 3, 4};
+// widths of the downscale tests, the wide one runs the SIMD loops on many pixels
+const int widths[2] = {width, 517};
+
+BOOST_AUTO_TEST_CASE(imageIO_downscaleImageBox_uchar)
+{
+  for(const int inWidth : widths)
+  {
+    std::vector<unsigned char> image(inWidth * height);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < inWidth; ++x)
+        image[y * inWidth + x] = pixelValue(x, y, 0);
+
+    for(const int downscale : downscales)
+    {
+      std::vector<unsigned char> downscaled;
+      downscaleImageBox(inWidth, height, downscale, image, downscaled);
+
+      const int outWidth = inWidth / downscale;
+      const int outHeight = height / downscale;
+      BOOST_REQUIRE_EQUAL(downscaled.size(), static_cast<std::size_t>(outWidth * outHeight));
+
+      for(int y = 0; y < outHeight; ++y)
+        for(int x = 0; x < outWidth; ++x)
+          BOOST_CHECK_EQUAL(static_cast<int>(downscaled[y * outWidth + x]), static_cast<int>(boxValue(x, y, 0, downscale) + 0.5f));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(imageIO_downscaleImageBox_float)
+{
+  for(const int inWidth : widths)
+  {
+    std::vector<float> image(inWidth * height);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < inWidth; ++x)
+        image[y * inWidth + x] = pixelValue(x, y, 0) / 255.0f;
+
+    for(const int downscale : downscales)
+    {
+      std::vector<float> downscaled;
+      downscaleImageBox(inWidth, height, downscale, image, downscaled);
+
+      const int outWidth = inWidth / downscale;
+      const int outHeight = height / downscale;
+      BOOST_REQUIRE_EQUAL(downscaled.size(), static_cast<std::size_t>(outWidth * outHeight));
+
+      for(int y = 0; y < outHeight; ++y)
+        for(int x = 0; x < outWidth; ++x)
+          BOOST_CHECK_SMALL(downscaled[y * outWidth + x] - boxValue(x, y, 0, downscale) / 255.0f, 1e-5f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(imageIO_downscaleImageBox_rgb)
+{
+  for(const int inWidth : widths)
+  {
+    std::vector<rgb> image(inWidth * height);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < inWidth; ++x)
+        image[y * inWidth + x] = rgb(pixelValue(x, y, 0), pixelValue(x, y, 1), pixelValue(x, y, 2));
+
+    for(const int downscale : downscales)
+    {
+      std::vector<rgb> downscaled;
+      downscaleImageBox(inWidth, height, downscale, image, downscaled);
+
+      const int outWidth = inWidth / downscale;
+      const int outHeight = height / downscale;
+      BOOST_REQUIRE_EQUAL(downscaled.size(), static_cast<std::size_t>(outWidth * outHeight));
+
+      for(int y = 0; y < outHeight; ++y)
+      {
+        for(int x = 0; x < outWidth; ++x)
+        {
+          const rgb& pixel = downscaled[y * outWidth + x];
+          BOOST_CHECK_EQUAL(static_cast<int>(pixel.r), static_cast<int>(boxValue(x, y, 0, downscale) + 0.5f));
+          BOOST_CHECK_EQUAL(static_cast<int>(pixel.g), static_cast<int>(boxValue(x, y, 1, downscale) + 0.5f));
+          BOOST_CHECK_EQUAL(static_cast<int>(pixel.b), static_cast<int>(boxValue(x, y, 2, downscale) + 0.5f));
+        }
+      }
+    }
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Write uchar, float and RGB images without MIP levels
+// - Read them downscaled and compare with the box downscale of the written images
+//-----------------
+BOOST_AUTO_TEST_CASE(imageIO_readImageDownscaled)
+{
+  const bfs::path folder = bfs::temp_directory_path() / bfs::unique_path();
+  bfs::create_directories(folder);
+
+  std::vector<unsigned char> grayImage(width * height);
+  std::vector<float> floatImage(width * height);
+  std::vector<rgb> rgbImage(width * height);
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const int i = y * width + x;
+      grayImage[i] = pixelValue(x, y, 0);
+      floatImage[i] = pixelValue(x, y, 0) / 255.0f;
+      rgbImage[i] = rgb(pixelValue(x, y, 0), pixelValue(x, y, 1), pixelValue(x, y, 2));
+    }
+  }
+
+  const std::string grayPath = (folder / "gray.png").string();
+  const std::string floatPath = (folder / "float.exr").string();
+  const std::string rgbPath = (folder / "rgb.png").string();
+  writeImage(grayPath, width, height, grayImage);
+  writeImage(floatPath, width, height, floatImage, EImageQuality::LOSSLESS);
+  writeImage(rgbPath, width, height, rgbImage);
+
+  for(const int downscale : downscales)
+  {
+    const int outWidth = width / downscale;
+    const int outHeight = height / downscale;
+    int readWidth, readHeight;
+
+    std::vector<unsigned char> grayRead;
+    std::vector<unsigned char> grayExpected;
+    readImageDownscaled(grayPath, downscale, readWidth, readHeight, grayRead);
+    downscaleImageBox(width, height, downscale, grayImage, grayExpected);
+    BOOST_CHECK_EQUAL(readWidth, outWidth);
+    BOOST_CHECK_EQUAL(readHeight, outHeight);
+    BOOST_REQUIRE_EQUAL(grayRead.size(), grayExpected.size());
+    for(std::size_t i = 0; i < grayExpected.size(); ++i)
+      BOOST_CHECK_EQUAL(static_cast<int>(grayRead[i]), static_cast<int>(grayExpected[i]));
+
+    std::vector<float> floatRead;
+    std::vector<float> floatExpected;
+    readImageDownscaled(floatPath, downscale, readWidth, readHeight, floatRead);
+    downscaleImageBox(width, height, downscale, floatImage, floatExpected);
+    BOOST_CHECK_EQUAL(readWidth, outWidth);
+    BOOST_CHECK_EQUAL(readHeight, outHeight);
+    BOOST_REQUIRE_EQUAL(floatRead.size(), floatExpected.size());
+    for(std::size_t i = 0; i < floatExpected.size(); ++i)
+      BOOST_CHECK_SMALL(floatRead[i] - floatExpected[i], 1e-5f);
+
+    std::vector<rgb> rgbRead;
+    std::vector<rgb> rgbExpected;
+    readImageDownscaled(rgbPath, downscale, readWidth, readHeight, rgbRead);
+    downscaleImageBox(width, height, downscale, rgbImage, rgbExpected);
+    BOOST_CHECK_EQUAL(readWidth, outWidth);
+    BOOST_CHECK_EQUAL(readHeight, outHeight);
+    BOOST_REQUIRE_EQUAL(rgbRead.size(), rgbExpected.size());
+    for(std::size_t i = 0; i < rgbExpected.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(static_cast<int>(rgbRead[i].r), static_cast<int>(rgbExpected[i].r));
+      BOOST_CHECK_EQUAL(static_cast<int>(rgbRead[i].g), static_cast<int>(rgbExpected[i].g));
+      BOOST_CHECK_EQUAL(static_cast<int>(rgbRead[i].b), static_cast<int>(rgbExpected[i].b));
+    }
+  }
+
+  bfs::remove_all(folder);
+}
@@ -9,6 +9,7 @@
 #include <aliceVision/sensorDB/parseDatabase.hpp>
 #include <aliceVision/feature/sift/ImageDescriber_SIFT.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/filesystem.hpp>
 
@@ -108,17 +109,12 @@ void KeyframeSelector::process()
   }
 
   // resize selection data vector
-  _framesData.resize(nbFrames);
-
-  // feed provider variables
-  image::Image< image::RGBColor> image;    // original image
-  camera::PinholeRadialK3 queryIntrinsics; // image associated camera intrinsics
-  bool hasIntrinsics = false;              // true if queryIntrinsics is valid
-  std::string currentImgName;              // current image name
+  _framesData.assign(nbFrames, FrameData());
 
   // process variables
   const unsigned int frameStep = _maxFrameStep - _minFrameStep;
   const unsigned int tileSharpSubset = (_nbTileSide * _nbTileSide) / _sharpSubset;
+  const std::size_t batchSize = std::max(1, omp_get_max_threads());
 
   // create output folders
   if(_feeds.size() > 1)
@@ -134,87 +130,38 @@ void KeyframeSelector::process()
         fs::create_directory(subPoseFolder);
     }
   }
-  
-  // feed and metadata initialization
+
+  // decode the frames of each media on a background thread (first frame with offset)
+  _frameBuffer.clear();
+  _nbDecodedFrames = 0;
   for(std::size_t mediaIndex = 0 ; mediaIndex < _feeds.size(); ++mediaIndex)
   {
-    // first frame with offset
+    _feeds.at(mediaIndex)->setReadAhead(_hasReadAhead ? 2 * batchSize : 0);
     _feeds.at(mediaIndex)->goToFrame(_cameraInfos.at(mediaIndex).frameOffset);
-
-    if(!_feeds.at(mediaIndex)->readImage(image, queryIntrinsics, currentImgName, hasIntrinsics))
-    {
-      ALICEVISION_LOG_ERROR("Cannot read media first frame " << _mediaPaths[mediaIndex]);
-      throw std::invalid_argument("Cannot read media first frame " + _mediaPaths[mediaIndex]);
-    }
-
-    // define output image metadata
-    if(!_cameraInfos.at(mediaIndex).focalIsMM)
-    {
-      convertFocalLengthInMM(_cameraInfos.at(mediaIndex), image.Width());
-    }
-
-    // define media informations
-    auto& mediaInfo =  _mediasInfo.at(mediaIndex);
-    mediaInfo.tileHeight = (image.Height() / 2) / _nbTileSide;
-    mediaInfo.tileWidth = (image.Width() / 2) / _nbTileSide;
-    mediaInfo.spec = oiio::ImageSpec(image.Width(), image.Height(), 3, oiio::TypeDesc::UINT8); // always jpeg
-    mediaInfo.spec.attribute("CompressionQuality", 100);   // always best compression quality
-    mediaInfo.spec.attribute("jpeg:subsampling", "4:4:4"); // always subsampling 4:4:4
-    mediaInfo.spec.attribute("oiio:ColorSpace", "sRGB");   // always sRGB
-    mediaInfo.spec.attribute("Make",  _cameraInfos[mediaIndex].brand);
-    mediaInfo.spec.attribute("Model", _cameraInfos[mediaIndex].model);
-    mediaInfo.spec.attribute("Exif:BodySerialNumber", std::to_string(getRandomInt())); // TODO: use Exif:OriginalRawFileName instead
-    mediaInfo.spec.attribute("Exif:FocalLength", _cameraInfos[mediaIndex].focalLength);
   }
 
   // iteration process
   _keyframeIndexes.clear();
   std::size_t currentFrameStep = _minFrameStep + 1; // start directly (dont skip minFrameStep first frames)
-  
+  std::size_t nbReleasedFrames = 0;
+
   for(std::size_t frameIndex = 0; frameIndex < _framesData.size(); ++frameIndex)
   {
     ALICEVISION_LOG_INFO("frame : " << frameIndex);
-    bool frameSelected = true;
-    auto& frameData = _framesData.at(frameIndex);
-    frameData.mediasData.resize(_feeds.size());
 
-    for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
+    // decode and score a batch of the next frames, up to the end of the selection step
+    // (the frames of a step are all evaluated)
+    if(frameIndex >= _nbDecodedFrames)
     {
-      ALICEVISION_LOG_DEBUG("media : " << _mediaPaths.at(mediaIndex));
-      auto& feed = *_feeds.at(mediaIndex);
-
-      if(frameSelected) // false if a camera of a rig is not selected
-      {
-        if(!feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics))
-        {
-          ALICEVISION_LOG_ERROR("Cannot read frame '" << currentImgName << "' !");
-          throw std::invalid_argument("Cannot read frame '" + currentImgName + "' !");
-        }
-
-        // compute sharpness and sparse distance
-        if(!computeFrameData(image, frameIndex, mediaIndex, tileSharpSubset))
-        {
-          frameSelected = false;
-        }
-      }
-
-      feed.goToNextFrame();
+      const std::size_t stepEnd = frameIndex + (_maxFrameStep - std::min(currentFrameStep, static_cast<std::size_t>(_maxFrameStep)));
+      scoreFrames(frameIndex, std::min(std::min(stepEnd, frameIndex + batchSize - 1), nbFrames - 1), tileSharpSubset);
     }
 
-    {
-      if(frameSelected)
-      {
-        ALICEVISION_LOG_INFO(" > selected" << std::endl);
-        frameData.selected = true;
-        if(_hasSharpnessSelection)
-          frameData.computeAvgSharpness();
-      }
-      else
-      {
-        ALICEVISION_LOG_INFO(" > skipped" << std::endl);
-        frameData.mediasData.clear(); // remove unselected mediasData
-      }
-    }
+    // evaluate the frame with the current keyframes (the frame scores are computed once)
+    if(evaluateFrame(frameIndex))
+      ALICEVISION_LOG_INFO(" > selected" << std::endl);
+    else
+      ALICEVISION_LOG_INFO(" > skipped" << std::endl);
 
     // selection process
     if(currentFrameStep >= _maxFrameStep)
@@ -264,19 +211,13 @@ void KeyframeSelector::process()
       {
         ALICEVISION_LOG_INFO("keyframe choice : " << keyframeIndex << std::endl);
 
-        // write keyframe
-        for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
-        {
-          auto& feed = *_feeds.at(mediaIndex);
+        // write keyframe from the decoded frames
+        const std::vector<image::Image<image::RGBColor>>& images = _frameBuffer.at(keyframeIndex);
 
-          feed.goToFrame(keyframeIndex + _cameraInfos.at(mediaIndex).frameOffset);
+        #pragma omp parallel for
+        for(int mediaIndex = 0; mediaIndex < static_cast<int>(_feeds.size()); ++mediaIndex)
+          writeKeyframe(images.at(mediaIndex), keyframeIndex, mediaIndex);
 
-          if(_maxOutFrame == 0) // no limit of keyframes (direct evaluation)
-          {
-            feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
-            writeKeyframe(image, keyframeIndex, mediaIndex);
-          }
-        }
         _framesData[keyframeIndex].keyframe = true;
         _keyframeIndexes.push_back(keyframeIndex);
 
@@ -286,16 +227,30 @@ void KeyframeSelector::process()
       {
         ALICEVISION_LOG_INFO("keyframe choice : none" << std::endl);
       }
+
+      // release the frames that will not be evaluated again (keep the keyframes histograms)
+      for(; nbReleasedFrames <= frameIndex && nbReleasedFrames < _framesData.size(); ++nbReleasedFrames)
+      {
+        _frameBuffer.erase(nbReleasedFrames);
+        if(!_framesData[nbReleasedFrames].keyframe)
+          _framesData[nbReleasedFrames].mediasData.clear();
+      }
     }
     ++currentFrameStep;
   }
 
+  // stop the decoding
+  for(auto& feed : _feeds)
+    feed->setReadAhead(0);
+  _frameBuffer.clear();
+
   if(_maxOutFrame == 0) // no limit of keyframes (evaluation and write already done)
   {
     return;
   }
 
   // if limited number of keyframe, select smallest sparse distance
+  // and remove the other keyframes (written when selected)
   {
     std::vector< std::tuple<float, float, std::size_t> > keyframes;
 
@@ -310,20 +265,102 @@ void KeyframeSelector::process()
 
     const std::size_t nbOutFrames = std::min(static_cast<std::size_t>(_maxOutFrame), keyframes.size());
 
-    for(std::size_t i = 0; i < nbOutFrames; ++i)
+    for(std::size_t i = nbOutFrames; i < keyframes.size(); ++i)
     {
       const std::size_t frameIndex = std::get<2>(keyframes.at(i));
+      _framesData[frameIndex].keyframe = false;
       for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
+        fs::remove(getKeyframePath(frameIndex, mediaIndex));
+    }
+  }
+}
+
+void KeyframeSelector::scoreFrames(std::size_t firstFrameIndex,
+                                   std::size_t lastFrameIndex,
+                                   unsigned int tileSharpSubset)
+{
+  const int nbMedias = static_cast<int>(_feeds.size());
+
+  // get the decoded frames in sequence, the frames before the first one are not evaluated
+  for(; _nbDecodedFrames <= lastFrameIndex; ++_nbDecodedFrames)
+  {
+    std::vector<image::Image<image::RGBColor>> images(nbMedias);
+
+    for(int mediaIndex = 0; mediaIndex < nbMedias; ++mediaIndex)
+    {
+      auto& feed = *_feeds.at(mediaIndex);
+      std::string currentImgName;
+      camera::PinholeRadialK3 queryIntrinsics;
+      bool hasIntrinsics = false;
+
+      if(!feed.readImage(images.at(mediaIndex), queryIntrinsics, currentImgName, hasIntrinsics))
+      {
+        ALICEVISION_LOG_ERROR("Cannot read frame '" << currentImgName << "' !");
+        throw std::invalid_argument("Cannot read frame '" + currentImgName + "' !");
+      }
+      feed.goToNextFrame();
+
+      if(_nbDecodedFrames == 0)
+        initMediaInfo(images.at(mediaIndex), mediaIndex);
+    }
+
+    if(_nbDecodedFrames >= firstFrameIndex)
+      _frameBuffer[_nbDecodedFrames].swap(images);
+  }
+
+  for(std::size_t frameIndex = firstFrameIndex; frameIndex <= lastFrameIndex; ++frameIndex)
+    _framesData.at(frameIndex).mediasData.resize(nbMedias);
+
+  if(!_hasSharpnessSelection && !_hasSparseDistanceSelection)
+    return; // nothing to do
+
+  // frames and medias are independent
+  const int nbJobs = static_cast<int>(lastFrameIndex - firstFrameIndex + 1) * nbMedias;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < nbJobs; ++i)
+  {
+    const std::size_t frameIndex = firstFrameIndex + i / nbMedias;
+    const std::size_t mediaIndex = i % nbMedias;
+    computeMediaScores(_frameBuffer.at(frameIndex).at(mediaIndex), frameIndex, mediaIndex, tileSharpSubset);
+  }
+
+  // only keep the frames that can be selected
+  for(std::size_t frameIndex = firstFrameIndex; frameIndex <= lastFrameIndex; ++frameIndex)
+  {
+    for(const MediaData& mediaData : _framesData.at(frameIndex).mediasData)
+    {
+      if(!isSharp(mediaData))
       {
-        auto& feed = *_feeds.at(mediaIndex);
-        feed.goToFrame(frameIndex + _cameraInfos.at(mediaIndex).frameOffset);
-        feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
-        writeKeyframe(image, frameIndex, mediaIndex);
+        _frameBuffer.erase(frameIndex);
+        break;
       }
     }
   }
 }
 
+void KeyframeSelector::initMediaInfo(const image::Image<image::RGBColor>& image, std::size_t mediaIndex)
+{
+  // define output image metadata
+  if(!_cameraInfos.at(mediaIndex).focalIsMM)
+  {
+    convertFocalLengthInMM(_cameraInfos.at(mediaIndex), image.Width());
+  }
+
+  // define media informations
+  auto& mediaInfo =  _mediasInfo.at(mediaIndex);
+  mediaInfo.tileHeight = (image.Height() / 2) / _nbTileSide;
+  mediaInfo.tileWidth = (image.Width() / 2) / _nbTileSide;
+  mediaInfo.spec = oiio::ImageSpec(image.Width(), image.Height(), 3, oiio::TypeDesc::UINT8); // always jpeg
+  mediaInfo.spec.attribute("CompressionQuality", 100);   // always best compression quality
+  mediaInfo.spec.attribute("jpeg:subsampling", "4:4:4"); // always subsampling 4:4:4
+  mediaInfo.spec.attribute("oiio:ColorSpace", "sRGB");   // always sRGB
+  mediaInfo.spec.attribute("Make",  _cameraInfos[mediaIndex].brand);
+  mediaInfo.spec.attribute("Model", _cameraInfos[mediaIndex].model);
+  mediaInfo.spec.attribute("Exif:BodySerialNumber", std::to_string(getRandomInt())); // TODO: use Exif:OriginalRawFileName instead
+  mediaInfo.spec.attribute("Exif:FocalLength", _cameraInfos[mediaIndex].focalLength);
+}
+
 float KeyframeSelector::computeSharpness(const image::Image<float>& imageGray,
                                          const unsigned int tileHeight,
                                          const unsigned int tileWidth,
@@ -335,20 +372,18 @@ float KeyframeSelector::computeSharpness(const image::Image<float>& imageGray,
   image::ImageScharrXDerivative(imageGray, scharrXDer); // normalized
   image::ImageScharrYDerivative(imageGray, scharrYDer); // normalized
 
-  scharrXDer = scharrXDer.cwiseAbs(); // absolute value
-  scharrYDer = scharrYDer.cwiseAbs(); // absolute value
-
-  // image tiles
-  std::vector<float> averageTileIntensity;
+  // image tiles, average of the absolute derivatives
+  const int nbTiles = _nbTileSide * _nbTileSide;
+  std::vector<float> averageTileIntensity(nbTiles);
   const float tileSizeInv = 1 / static_cast<float>(tileHeight * tileWidth);
 
-  for(std::size_t y =  0; y < (_nbTileSide * tileHeight); y += tileHeight)
+  #pragma omp parallel for
+  for(int i = 0; i < nbTiles; ++i)
   {
-    for(std::size_t x =  0; x < (_nbTileSide * tileWidth); x += tileWidth)
-    {
-      const auto sum = scharrXDer.block(y, x, tileHeight, tileWidth).sum() + scharrYDer.block(y, x, tileHeight, tileWidth).sum();
-      averageTileIntensity.push_back(sum * tileSizeInv);
-    }
+    const std::size_t y = (i / _nbTileSide) * tileHeight;
+    const std::size_t x = (i % _nbTileSide) * tileWidth;
+    const auto sum = scharrXDer.block(y, x, tileHeight, tileWidth).cwiseAbs().sum() + scharrYDer.block(y, x, tileHeight, tileWidth).cwiseAbs().sum();
+    averageTileIntensity[i] = sum * tileSizeInv;
   }
 
   // sort tiles average pixel intensity
@@ -359,20 +394,16 @@ float KeyframeSelector::computeSharpness(const image::Image<float>& imageGray,
 }
 
 
-bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& image,
-                                        std::size_t frameIndex,
-                                        std::size_t mediaIndex,
-                                        unsigned int tileSharpSubset)
+void KeyframeSelector::computeMediaScores(const image::Image<image::RGBColor>& image,
+                                          std::size_t frameIndex,
+                                          std::size_t mediaIndex,
+                                          unsigned int tileSharpSubset)
 {
-  if(!_hasSharpnessSelection && !_hasSparseDistanceSelection)
-    return true; // nothing to do
-
   image::Image<float> imageGray;           // grayscale image
   image::Image<float> imageGrayHalfSample; // half resolution grayscale image
   
   const auto& currMediaInfo = _mediasInfo.at(mediaIndex);
-  auto& currframeData = _framesData.at(frameIndex);
-  auto& currMediaData = currframeData.mediasData.at(mediaIndex);
+  auto& currMediaData = _framesData.at(frameIndex).mediasData.at(mediaIndex);
 
   // get grayscale image and resize
   image::ConvertPixelType(image, &imageGray);
@@ -385,17 +416,38 @@ bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& ima
                                                currMediaInfo.tileHeight,
                                                currMediaInfo.tileWidth,
                                                tileSharpSubset);
-    ALICEVISION_LOG_DEBUG( " - sharpness : " << currMediaData.sharpness);
+    ALICEVISION_LOG_DEBUG( " - frame " << frameIndex << ", media " << mediaIndex << ", sharpness : " << currMediaData.sharpness);
   }
 
-  if((currMediaData.sharpness > _sharpnessThreshold) || !_hasSharpnessSelection)
+  // compute current frame sparse histogram
+  if(isSharp(currMediaData) && _hasSparseDistanceSelection)
   {
-    bool noKeyframe = (_keyframeIndexes.empty());
-
-    // compute current frame sparse histogram
     std::unique_ptr<feature::Regions> regions;
     _imageDescriber->describe(imageGrayHalfSample, regions);
     currMediaData.histogram = voctree::SparseHistogram(_voctree->quantizeToSparse(dynamic_cast<feature::SIFT_Regions*>(regions.get())->Descriptors()));
+  }
+}
+
+bool KeyframeSelector::evaluateFrame(std::size_t frameIndex)
+{
+  auto& currframeData = _framesData.at(frameIndex);
+  currframeData.selected = true;
+  currframeData.maxDistScore = 0;
+
+  if(!_hasSharpnessSelection && !_hasSparseDistanceSelection)
+    return true; // nothing to do
+
+  const bool noKeyframe = (_keyframeIndexes.empty());
+
+  for(auto& currMediaData : currframeData.mediasData)
+  {
+    currMediaData.distScore = 0;
+
+    if(!isSharp(currMediaData))
+    {
+      currframeData.selected = false;
+      break;
+    }
 
     // compute sparseDistance
     if(!noKeyframe && _hasSparseDistanceSelection)
@@ -413,12 +465,17 @@ bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& ima
       ALICEVISION_LOG_DEBUG(" - distScore : " << currMediaData.distScore);
     }
 
-    if(noKeyframe || (currMediaData.distScore < _distScoreMax))
+    if(!noKeyframe && (currMediaData.distScore >= _distScoreMax))
     {
-      return true;
+      currframeData.selected = false;
+      break;
     }
-  } 
-  return false;
+  }
+
+  if(currframeData.selected && _hasSharpnessSelection)
+    currframeData.computeAvgSharpness();
+
+  return currframeData.selected;
 }
 
 void KeyframeSelector::writeKeyframe(const image::Image<image::RGBColor>& image, 
@@ -426,12 +483,7 @@ void KeyframeSelector::writeKeyframe(const image::Image<image::RGBColor>& image,
                                      std::size_t mediaIndex)
 {
   auto& mediaInfo = _mediasInfo.at(mediaIndex);
-  fs::path folder{_outputFolder};
-
-  if(_feeds.size() > 1)
-     folder  /= fs::path("rig") / fs::path(std::to_string(mediaIndex));
-
-  const auto filepath = (folder / fs::path(std::to_string(frameIndex) + ".jpg")).string();
+  const std::string filepath = getKeyframePath(frameIndex, mediaIndex);
 
   mediaInfo.spec.attribute("Exif:ImageUniqueID", std::to_string(getRandomInt()));
 
@@ -451,6 +503,16 @@ void KeyframeSelector::writeKeyframe(const image::Image<image::RGBColor>& image,
   out->close();
 }
 
+std::string KeyframeSelector::getKeyframePath(std::size_t frameIndex, std::size_t mediaIndex) const
+{
+  fs::path folder{_outputFolder};
+
+  if(_feeds.size() > 1)
+     folder  /= fs::path("rig") / fs::path(std::to_string(mediaIndex));
+
+  return (folder / fs::path(std::to_string(frameIndex) + ".jpg")).string();
+}
+
 void KeyframeSelector::convertFocalLengthInMM(CameraInfo& cameraInfo, int imageWidth)
 {
   assert(imageWidth > 0);
@@ -15,6 +15,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
 #include <limits>
 
@@ -74,7 +75,9 @@ public:
   KeyframeSelector(const KeyframeSelector& copy) = delete;
 
   /**
-   * @brief Process media paths and extract keyframes
+   * @brief Process media paths and extract keyframes.
+   * The frames of each media are decoded once, on a background thread per media
+   * if the read-ahead is used, and the frames scores are computed in parallel.
    */
   void process();
 
@@ -96,6 +99,15 @@ public:
     _hasSharpnessSelection = useSharpnessSelection;
   }
 
+  /**
+   * @brief Set if selector decodes the frames in advance, on a background thread per media
+   * @param[in] useReadAhead True or False
+   */
+  void useReadAhead(bool useReadAhead)
+  {
+    _hasReadAhead = useReadAhead;
+  }
+
   /**
    * @brief Set cameras informations for output keyframes
    * @param[in] cameras informations
@@ -241,6 +253,8 @@ private:
   bool _hasSharpnessSelection = true;
   /// Use sparseDistance selection
   bool _hasSparseDistanceSelection = true;
+  /// Decode the frames in advance
+  bool _hasReadAhead = true;
 
   /// Camera metadatas
   std::vector<CameraInfo> _cameraInfos;
@@ -303,6 +317,7 @@ private:
      */
     void computeAvgSharpness()
     {
+      avgSharpness = 0;
       for(const auto& media : mediasData)
         avgSharpness += media.sharpness;
       avgSharpness /= mediasData.size();
@@ -315,6 +330,37 @@ private:
   std::vector<FrameData> _framesData;
   /// Keyframe indexes container
   std::vector<std::size_t> _keyframeIndexes;
+  /// Number of frames already decoded
+  std::size_t _nbDecodedFrames = 0;
+  /// Decoded images (per media) of the frames that can still become keyframes
+  std::map<std::size_t, std::vector< image::Image<image::RGBColor> > > _frameBuffer;
+
+  /**
+   * @brief Return true if the media image is sharp enough to be selected
+   * @param[in] mediaData media informations at a specific frame
+   */
+  bool isSharp(const MediaData& mediaData) const
+  {
+    return !_hasSharpnessSelection || (mediaData.sharpness > _sharpnessThreshold);
+  }
+
+  /**
+   * @brief Initialize the media informations from its first frame
+   * @param[in] image the first frame of the media
+   * @param[in] mediaIndex the media index
+   */
+  void initMediaInfo(const image::Image<image::RGBColor>& image, std::size_t mediaIndex);
+
+  /**
+   * @brief Get the decoded frames up to a given frame and compute the scores
+   * of the frames [firstFrameIndex, lastFrameIndex] of all the medias in parallel
+   * @param[in] firstFrameIndex the first frame to score, the previous ones are skipped
+   * @param[in] lastFrameIndex the last frame to score
+   * @param[in] tileSharpSubset number of sharp tiles
+   */
+  void scoreFrames(std::size_t firstFrameIndex,
+                   std::size_t lastFrameIndex,
+                   unsigned int tileSharpSubset);
 
   /**
    * @brief Compute sharpness score of a given image
@@ -330,17 +376,31 @@ private:
                          const unsigned int tileSharpSubset) const;
 
   /**
-   * @brief Compute sharpness and distance score for a given image
+   * @brief Compute the scores of an image that do not depend on the keyframes:
+   * sharpness, and sparse histogram if the image is sharp enough
    * @param[in] image an image of the media
    * @param[in] frameIndex the image index in the media sequence
    * @param[in] mediaIndex the media index
    * @param[in] tileSharpSubset number of sharp tiles
+   */
+  void computeMediaScores(const image::Image<image::RGBColor>& image,
+                          std::size_t frameIndex,
+                          std::size_t mediaIndex,
+                          unsigned int tileSharpSubset);
+
+  /**
+   * @brief Compute the distance scores of a frame with the current keyframes and select it
+   * @param[in] frameIndex the frame index in the media sequence
    * @return true if the frame is selected
    */
-  bool computeFrameData(const image::Image<image::RGBColor>& image,
-                        std::size_t frameIndex,
-                        std::size_t mediaIndex,
-                        unsigned int tileSharpSubset);
+  bool evaluateFrame(std::size_t frameIndex);
+
+  /**
+   * @brief Get the output path of a keyframe
+   * @param[in] frameIndex the image index in the media sequence
+   * @param[in] mediaIndex the media index
+   */
+  std::string getKeyframePath(std::size_t frameIndex, std::size_t mediaIndex) const;
 
   /**
    * @brief Write a keyframe and metadata
@@ -0,0 +1,151 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/keyframe/KeyframeSelector.hpp>
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE KeyframeSelector
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace fs = boost::filesystem;
+
+const int nbFrames = 40;
+const int width = 160;
+const int height = 120;
+
+/**
+ * @brief Return true if the frame is almost uniform (not sharp enough to be selected)
+ */
+inline bool isBlurryFrame(int frameIndex)
+{
+  return (frameIndex % 5) == 4;
+}
+
+/**
+ * @brief Write the frames of a media: a moving checkerboard whose contrast changes with the frame
+ */
+void writeMedia(const fs::path& folder, int mediaIndex)
+{
+  fs::create_directories(folder);
+
+  for(int i = 0; i < nbFrames; ++i)
+  {
+    const int contrast = isBlurryFrame(i) ? 2 : 100 + ((i * 7 + mediaIndex * 3) % 13) * 10;
+    image::Image<image::RGBColor> frame(width, height);
+    for(int y = 0; y < height; ++y)
+    {
+      for(int x = 0; x < width; ++x)
+      {
+        const bool isWhite = (((x + 2 * i) / 8 + (y + mediaIndex) / 8) % 2) == 0;
+        const unsigned char value = static_cast<unsigned char>(20 + (isWhite ? contrast : 0));
+        frame(y, x) = image::RGBColor(value, value, static_cast<unsigned char>(value / 2));
+      }
+    }
+    image::writeImage((folder / ("frame_" + std::to_string(100 + i) + ".png")).string(), frame);
+  }
+}
+
+/**
+ * @brief Write a vocabulary tree of 2 words
+ */
+void writeVocabularyTree(const std::string& treePath)
+{
+  typedef feature::Descriptor<float, 128> DescriptorFloat;
+
+  voctree::MutableVocabularyTree<DescriptorFloat> tree;
+  tree.setSize(1, 2);
+  tree.centers().clear();
+  tree.centers().push_back(DescriptorFloat(0.0f));
+  tree.centers().push_back(DescriptorFloat(64.0f));
+  tree.validCenters().assign(2, 1);
+  tree.save(treePath);
+}
+
+/**
+ * @brief Run the keyframe selection of the medias
+ * @return the paths of the keyframes, relative to the output folder
+ */
+std::set<std::string> selectKeyframes(const std::vector<std::string>& mediaPaths,
+                                      const std::string& treePath,
+                                      const fs::path& outputFolder,
+                                      bool useReadAhead)
+{
+  fs::create_directories(outputFolder);
+
+  keyframe::KeyframeSelector selector(mediaPaths, "", treePath, outputFolder.string());
+  selector.setCameraInfos(std::vector<keyframe::KeyframeSelector::CameraInfo>(mediaPaths.size()));
+  selector.useReadAhead(useReadAhead);
+  selector.setSharpnessSelectionPreset(keyframe::ESharpnessSelectionPreset::LOW);
+  selector.setSparseDistanceMaxScore(std::numeric_limits<float>::max());
+  selector.setSharpSubset(2);
+  selector.setMinFrameStep(3);
+  selector.setMaxFrameStep(7);
+  selector.process();
+
+  std::set<std::string> keyframes;
+  for(fs::recursive_directory_iterator it(outputFolder), end; it != end; ++it)
+  {
+    if(fs::is_regular_file(it->path()))
+      keyframes.insert(it->path().string().substr(outputFolder.string().size()));
+  }
+  return keyframes;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Write the frames of a rig of 2 medias, with a few frames not sharp enough
+// - Select the keyframes with the synchronous decoding and with the read-ahead, with scoring batches of several frames
+// - Assert that both give the same keyframes, and that the frames not sharp enough are not selected
+//-----------------
+BOOST_AUTO_TEST_CASE(KeyframeSelector_readAheadSameAsSync)
+{
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+  const std::vector<std::string> mediaPaths = {(folder / "media0").string(), (folder / "media1").string()};
+  writeMedia(mediaPaths[0], 0);
+  writeMedia(mediaPaths[1], 1);
+
+  const std::string treePath = (folder / "tree.tree").string();
+  writeVocabularyTree(treePath);
+
+  // the frames are scored by batches of the number of threads
+  const int nbThreads = omp_get_max_threads();
+  omp_set_num_threads(4);
+
+  const std::set<std::string> syncKeyframes = selectKeyframes(mediaPaths, treePath, folder / "sync", false);
+  const std::set<std::string> asyncKeyframes = selectKeyframes(mediaPaths, treePath, folder / "async", true);
+
+  omp_set_num_threads(nbThreads);
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(asyncKeyframes.begin(), asyncKeyframes.end(), syncKeyframes.begin(), syncKeyframes.end());
+
+  // a keyframe per media for each selected frame
+  std::set<std::string> frames[2];
+  for(const std::string& keyframe : syncKeyframes)
+  {
+    const fs::path keyframePath(keyframe);
+    const int mediaIndex = std::stoi(keyframePath.parent_path().filename().string());
+    const int frameIndex = std::stoi(keyframePath.stem().string());
+    BOOST_REQUIRE(mediaIndex == 0 || mediaIndex == 1);
+    BOOST_CHECK(!isBlurryFrame(frameIndex));
+    frames[mediaIndex].insert(keyframePath.filename().string());
+  }
+  BOOST_CHECK_GT(frames[0].size(), 1);
+  BOOST_CHECK_EQUAL_COLLECTIONS(frames[0].begin(), frames[0].end(), frames[1].begin(), frames[1].end());
+
+  fs::remove_all(folder);
+}
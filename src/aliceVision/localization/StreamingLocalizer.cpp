@@ -0,0 +1,335 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "StreamingLocalizer.hpp"
+#include <aliceVision/system/BoundedQueue.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <mutex>
+#include <thread>
+
+namespace aliceVision {
+namespace localization {
+
+/// A frame going through the stages
+struct StreamingLocalizer::FrameData
+{
+  std::size_t _frameId = 0;
+  Frame _frame;
+  feature::MapRegionsPerDesc _regions;
+  std::vector<voctree::DocMatch> _matchedImages;
+  /// 2D-3D associations collected by the matching
+  OccurenceMap _occurences;
+  sfm::ImageLocalizerMatchData _resectionData;
+  /// pose prior used by the matching
+  VoctreeLocalizer::PosePrior _posePrior;
+  bool _usePosePrior = false;
+  StageLatency _latency;
+  std::chrono::steady_clock::time_point _start;
+};
+
+StreamingLocalizer::StreamingLocalizer(VoctreeLocalizer& localizer,
+                                       const VoctreeLocalizer::Parameters& localizerParam,
+                                       const Parameters& param)
+  : _localizer(localizer)
+  , _localizerParam(localizerParam)
+  , _param(param)
+{
+  if(_localizerParam._algorithm != VoctreeLocalizer::Algorithm::AllResults)
+    throw std::invalid_argument("The streaming localizer only supports the AllResults algorithm.");
+
+  _posePrior._maxReprojectionError = _param._posePriorMaxError;
+  _posePrior._minVisibleRatio = _param._posePriorMinVisibleRatio;
+}
+
+std::size_t StreamingLocalizer::run(const FrameSource& source, const ResultCallback& callback)
+{
+  typedef std::unique_ptr<FrameData> FrameDataPtr;
+  typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+  system::BoundedQueue<FrameDataPtr> decodedFrames(_param._queueSize);
+  system::BoundedQueue<FrameDataPtr> extractedFrames(_param._queueSize);
+  system::BoundedQueue<FrameDataPtr> retrievedFrames(_param._queueSize);
+  system::BoundedQueue<FrameDataPtr> matchedFrames(_param._queueSize);
+
+  _statistics = Statistics();
+  _hasPosePrior = false;
+
+  std::mutex errorMutex;
+  std::exception_ptr error;
+
+  // keep the first error and stop all the stages
+  const auto stop = [&](std::exception_ptr e)
+  {
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if(!error)
+        error = e;
+    }
+    decodedFrames.close();
+    extractedFrames.close();
+    retrievedFrames.close();
+    matchedFrames.close();
+  };
+
+  const auto streamStart = std::chrono::steady_clock::now();
+
+  std::thread decoding([&]()
+  {
+    try
+    {
+      for(std::size_t frameId = 0; ; ++frameId)
+      {
+        FrameDataPtr frameData(new FrameData());
+        frameData->_frameId = frameId;
+        frameData->_start = std::chrono::steady_clock::now();
+        if(!source(frameData->_frame))
+          break;
+        frameData->_latency._decoding = Milliseconds(std::chrono::steady_clock::now() - frameData->_start).count();
+        if(!decodedFrames.push(std::move(frameData)))
+          break;
+      }
+      decodedFrames.close();
+    }
+    catch(...)
+    {
+      stop(std::current_exception());
+    }
+  });
+
+  std::thread extraction([&]()
+  {
+    try
+    {
+      FrameDataPtr frameData;
+      while(decodedFrames.pop(frameData))
+      {
+        system::Timer timer;
+        if(frameData->_frame._regions.empty())
+          _localizer.extractRegions(frameData->_frame._imageGrey, &_localizerParam, frameData->_regions);
+        else
+          frameData->_regions = std::move(frameData->_frame._regions);
+        frameData->_latency._extraction = timer.elapsedMs();
+        if(!extractedFrames.push(std::move(frameData)))
+          break;
+      }
+      extractedFrames.close();
+    }
+    catch(...)
+    {
+      stop(std::current_exception());
+    }
+  });
+
+  std::thread retrieval([&]()
+  {
+    try
+    {
+      FrameDataPtr frameData;
+      while(extractedFrames.pop(frameData))
+      {
+        system::Timer timer;
+        _localizer.retrieveImages(frameData->_regions, _localizerParam._numResults, frameData->_matchedImages);
+        frameData->_latency._retrieval = timer.elapsedMs();
+        if(!retrievedFrames.push(std::move(frameData)))
+          break;
+      }
+      retrievedFrames.close();
+    }
+    catch(...)
+    {
+      stop(std::current_exception());
+    }
+  });
+
+  std::thread matchingThread([&]()
+  {
+    try
+    {
+      FrameDataPtr frameData;
+      while(retrievedFrames.pop(frameData))
+      {
+        system::Timer timer;
+        matching(*frameData);
+        frameData->_latency._matching = timer.elapsedMs();
+        if(!matchedFrames.push(std::move(frameData)))
+          break;
+      }
+      matchedFrames.close();
+    }
+    catch(...)
+    {
+      stop(std::current_exception());
+    }
+  });
+
+  // the resection stage runs in the calling thread
+  try
+  {
+    FrameDataPtr frameData;
+    while(matchedFrames.pop(frameData))
+    {
+      FrameResult result;
+      resection(*frameData, result);
+      result._totalLatency = Milliseconds(std::chrono::steady_clock::now() - frameData->_start).count();
+
+      _statistics._decoding.add(result._latency._decoding);
+      _statistics._extraction.add(result._latency._extraction);
+      _statistics._retrieval.add(result._latency._retrieval);
+      _statistics._matching.add(result._latency._matching);
+      _statistics._resection.add(result._latency._resection);
+      _statistics._total.add(result._totalLatency);
+      ++_statistics._nbFrames;
+      if(result._localizationResult.isValid())
+        ++_statistics._nbLocalized;
+
+      ALICEVISION_LOG_DEBUG("[streaming]\tFrame " << result._frameId << " processed in " << result._totalLatency << " [ms]"
+                            << " (decoding: " << result._latency._decoding
+                            << ", extraction: " << result._latency._extraction
+                            << ", retrieval: " << result._latency._retrieval
+                            << ", matching: " << result._latency._matching
+                            << ", resection: " << result._latency._resection << ")");
+      callback(result);
+    }
+  }
+  catch(...)
+  {
+    stop(std::current_exception());
+  }
+
+  decoding.join();
+  extraction.join();
+  retrieval.join();
+  matchingThread.join();
+
+  _statistics._duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - streamStart).count();
+
+  if(error)
+    std::rethrow_exception(error);
+
+  return _statistics._nbLocalized;
+}
+
+void StreamingLocalizer::matching(FrameData& frameData)
+{
+  const Frame& frame = frameData._frame;
+  const std::pair<std::size_t, std::size_t> imageSize = std::make_pair(frame._imageGrey.Width(), frame._imageGrey.Height());
+
+  {
+    // the resection of the previous frames may not be done yet, use the last available prior
+    std::lock_guard<std::mutex> lock(_posePriorMutex);
+    frameData._usePosePrior = _param._usePosePrior &&
+                              _hasPosePrior &&
+                              (frameData._frameId - _lastLocalizedFrame <= _param._posePriorMaxAge);
+    if(frameData._usePosePrior)
+      frameData._posePrior = _posePrior;
+  }
+
+  // the landmarks are projected with the calibration of the frame if it is known
+  if(frameData._usePosePrior && frame._hasIntrinsics)
+    frameData._posePrior._intrinsics = frame._intrinsics;
+
+  std::unique_lock<std::mutex> lock(_frameBufferMutex, std::defer_lock);
+  if(_localizerParam._nbFrameBufferMatching > 0)
+    lock.lock();
+
+  _localizer.getAllAssociations(frameData._regions,
+                                imageSize,
+                                _localizerParam,
+                                frame._hasIntrinsics,
+                                frame._intrinsics,
+                                frameData._matchedImages,
+                                frameData._usePosePrior ? &frameData._posePrior : nullptr,
+                                frameData._occurences,
+                                frameData._resectionData.pt2D,
+                                frameData._resectionData.pt3D,
+                                frameData._resectionData.vec_descType,
+                                frame._imagePath);
+}
+
+void StreamingLocalizer::resection(FrameData& frameData, FrameResult& result)
+{
+  system::Timer timer;
+
+  const Frame& frame = frameData._frame;
+  const std::pair<std::size_t, std::size_t> imageSize = std::make_pair(frame._imageGrey.Width(), frame._imageGrey.Height());
+  camera::PinholeRadialK3 queryIntrinsics = frame._intrinsics;
+
+  result._frameId = frameData._frameId;
+  result._imagePath = frame._imagePath;
+
+  std::unique_lock<std::mutex> lock(_frameBufferMutex, std::defer_lock);
+  if(_localizerParam._nbFrameBufferMatching > 0)
+    lock.lock();
+
+  bool localized = _localizer.resectAllResults(frameData._regions,
+                                               imageSize,
+                                               _localizerParam,
+                                               frameData._occurences,
+                                               frameData._matchedImages,
+                                               frame._hasIntrinsics,
+                                               queryIntrinsics,
+                                               frameData._resectionData,
+                                               result._localizationResult,
+                                               frame._imagePath);
+  result._usedPosePrior = localized && frameData._usePosePrior;
+
+  if(!localized && frameData._usePosePrior)
+  {
+    ALICEVISION_LOG_DEBUG("[streaming]\tFrame " << frameData._frameId << " cannot be localized with the pose prior, retry without");
+    queryIntrinsics = frame._intrinsics;
+    localized = _localizer.localizeAllResults(frameData._regions,
+                                              imageSize,
+                                              _localizerParam,
+                                              frameData._matchedImages,
+                                              nullptr,
+                                              frame._hasIntrinsics,
+                                              queryIntrinsics,
+                                              result._localizationResult,
+                                              frame._imagePath);
+  }
+
+  if(lock.owns_lock())
+    lock.unlock();
+
+  if(localized)
+  {
+    std::lock_guard<std::mutex> priorLock(_posePriorMutex);
+    _hasPosePrior = true;
+    _lastLocalizedFrame = frameData._frameId;
+    _posePrior._pose = result._localizationResult.getPose();
+    _posePrior._intrinsics = result._localizationResult.getIntrinsics();
+    _posePrior._matchedImages = result._localizationResult.getMatchedImages();
+  }
+
+  result._latency = frameData._latency;
+  result._latency._resection = timer.elapsedMs();
+}
+
+void StreamingLocalizer::logStatistics() const
+{
+  const auto logStage = [](const std::string& name, const StageStatistics& stage)
+  {
+    return "\t- " + name + ": mean " + std::to_string(stage.mean()) + " [ms], max " + std::to_string(stage.max) + " [ms]\n";
+  };
+
+  ALICEVISION_LOG_INFO("Streaming localization of " << _statistics._nbFrames << " frames (" << _statistics._nbLocalized << " localized):\n"
+                       << logStage("decoding", _statistics._decoding)
+                       << logStage("extraction", _statistics._extraction)
+                       << logStage("retrieval", _statistics._retrieval)
+                       << logStage("matching", _statistics._matching)
+                       << logStage("resection", _statistics._resection)
+                       << logStage("total latency", _statistics._total)
+                       << "\t- throughput: " << _statistics.fps() << " fps");
+}
+
+} // namespace localization
+} // namespace aliceVision
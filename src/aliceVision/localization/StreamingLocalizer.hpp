@@ -0,0 +1,218 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/camera/PinholeRadial.hpp>
+#include <aliceVision/image/Image.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Latency statistics of a stage of the streaming localizer (in milliseconds).
+ */
+struct StageStatistics
+{
+  std::size_t count = 0;
+  double sum = 0.0;
+  double max = 0.0;
+
+  void add(double ms)
+  {
+    ++count;
+    sum += ms;
+    max = std::max(max, ms);
+  }
+
+  double mean() const
+  {
+    return (count == 0) ? 0.0 : sum / count;
+  }
+};
+
+/**
+ * @brief Localize the frames of a video stream with a VoctreeLocalizer (AllResults algorithm).
+ *
+ * The localization is split in stages that run in parallel on consecutive frames:
+ *  - decoding: read the next frame from the source (e.g. a dataio::FeedProvider)
+ *  - extraction: extract the regions of the frame with the image describers of the localizer
+ *  - retrieval: find the most similar images of the database with the vocabulary tree
+ *  - matching: match the frame with the retrieved images to collect the 2D-3D associations
+ *  - resection: estimate and refine the camera pose from the associations
+ * Each stage processes one frame at a time and the frames are processed in order,
+ * so the throughput is bounded by the slowest stage instead of the sum of the stages.
+ *
+ * The pose of the last localized frame is used as a prior for the matching of the
+ * next frames, to skip the database images and the landmarks outside the expected
+ * field of view. As the matching runs ahead of the resection, the prior may come from
+ * an older frame than the previous one. If the localization fails with the prior,
+ * the frame is matched and localized again without.
+ *
+ * The stages share the localizer: the extraction is the only stage using the image
+ * describers and the retrieval only reads the vocabulary tree and the database.
+ * The frame buffer of the localizer (see VoctreeLocalizer::Parameters::_nbFrameBufferMatching)
+ * is read by the matching and written by the resection, so these two stages are
+ * serialized by a mutex when the frame buffer matching is enabled.
+ */
+class StreamingLocalizer
+{
+public:
+  struct Parameters
+  {
+    Parameters()
+      : _queueSize(2)
+      , _usePosePrior(true)
+      , _posePriorMaxError(100.0)
+      , _posePriorMinVisibleRatio(0.1)
+      , _posePriorMaxAge(3)
+    {}
+
+    /// maximum number of frames waiting between two stages
+    std::size_t _queueSize;
+    /// use the pose of the last localized frame as a prior
+    bool _usePosePrior;
+    /// maximum distance (in pixels) between a query feature and its landmark projected with the prior
+    double _posePriorMaxError;
+    /// minimum ratio of the landmarks of a database image visible with the prior
+    double _posePriorMinVisibleRatio;
+    /// maximum number of frames since the last localized frame to use its pose as a prior
+    std::size_t _posePriorMaxAge;
+  };
+
+  /// A frame given by the frame source
+  struct Frame
+  {
+    image::Image<float> _imageGrey;
+    camera::PinholeRadialK3 _intrinsics;
+    bool _hasIntrinsics = false;
+    std::string _imagePath;
+    /// regions already extracted by the source, the extraction is skipped if not empty
+    feature::MapRegionsPerDesc _regions;
+  };
+
+  /// Time spent by a frame in each stage (in milliseconds)
+  struct StageLatency
+  {
+    double _decoding = 0.0;
+    double _extraction = 0.0;
+    double _retrieval = 0.0;
+    double _matching = 0.0;
+    double _resection = 0.0;
+  };
+
+  /// The localization of a frame
+  struct FrameResult
+  {
+    std::size_t _frameId = 0;
+    std::string _imagePath;
+    LocalizationResult _localizationResult;
+    /// true if the frame has been localized with the pose prior
+    bool _usedPosePrior = false;
+    StageLatency _latency;
+    /// time between the beginning of the decoding and the end of the resection,
+    /// including the time spent waiting between the stages (in milliseconds)
+    double _totalLatency = 0.0;
+  };
+
+  /// Statistics of the whole stream
+  struct Statistics
+  {
+    StageStatistics _decoding;
+    StageStatistics _extraction;
+    StageStatistics _retrieval;
+    StageStatistics _matching;
+    StageStatistics _resection;
+    StageStatistics _total;
+    std::size_t _nbFrames = 0;
+    std::size_t _nbLocalized = 0;
+    /// wall clock time of the stream (in seconds)
+    double _duration = 0.0;
+
+    double fps() const
+    {
+      return (_duration > 0.0) ? _nbFrames / _duration : 0.0;
+    }
+  };
+
+  /// Fill the next frame, returns false at the end of the stream
+  typedef std::function<bool(Frame&)> FrameSource;
+  /// Called in order for each frame, from the resection stage
+  typedef std::function<void(const FrameResult&)> ResultCallback;
+
+  /**
+   * @brief Initialize the streaming localizer
+   * @param[in] localizer The initialized localizer, it must not be used by another thread during run()
+   * @param[in] localizerParam The parameters of the localizer, only the AllResults algorithm is supported
+   * @param[in] param The parameters of the streaming
+   * @throw std::invalid_argument if the algorithm of the localizer is not AllResults
+   */
+  StreamingLocalizer(VoctreeLocalizer& localizer,
+                     const VoctreeLocalizer::Parameters& localizerParam,
+                     const Parameters& param = Parameters());
+
+  /**
+   * @brief Localize all the frames of the source, it returns at the end of the stream.
+   * The exceptions thrown by a stage or by the callback stop the stream and are rethrown.
+   * @param[in] source The function giving the frames
+   * @param[in] callback The function receiving the localization of each frame
+   * @return the number of localized frames
+   */
+  std::size_t run(const FrameSource& source, const ResultCallback& callback);
+
+  /**
+   * @brief Get the statistics of the last run
+   */
+  const Statistics& getStatistics() const
+  {
+    return _statistics;
+  }
+
+  /**
+   * @brief Log the latency of each stage and the throughput of the last run
+   */
+  void logStatistics() const;
+
+private:
+  struct FrameData;
+
+  /**
+   * @brief Match the frame with the retrieved images to collect its 2D-3D associations,
+   * with the last available pose prior
+   */
+  void matching(FrameData& frameData);
+
+  /**
+   * @brief Estimate the pose of the frame from its associations,
+   * match it again without the pose prior if the localization fails with it
+   */
+  void resection(FrameData& frameData, FrameResult& result);
+
+  VoctreeLocalizer& _localizer;
+  VoctreeLocalizer::Parameters _localizerParam;
+  Parameters _param;
+  Statistics _statistics;
+
+  /// serialize the matching and the resection when they share the frame buffer of the localizer
+  std::mutex _frameBufferMutex;
+
+  /// pose prior from the last localized frame, written by the resection and read by the matching
+  std::mutex _posePriorMutex;
+  VoctreeLocalizer::PosePrior _posePrior;
+  bool _hasPosePrior = false;
+  std::size_t _lastLocalizedFrame = 0;
+};
+
+} // namespace localization
+} // namespace aliceVision
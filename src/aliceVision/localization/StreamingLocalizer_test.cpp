@@ -0,0 +1,212 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "StreamingLocalizer.hpp"
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE StreamingLocalizer
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+namespace fs = boost::filesystem;
+using namespace aliceVision;
+
+typedef feature::SIFT_Regions::DescriptorT DescriptorT;
+
+const int width = 640;
+const int height = 480;
+const camera::PinholeRadialK3 intrinsics(width, height, 500.0, width * 0.5, height * 0.5, 0.0, 0.0, 0.0);
+
+/**
+ * @brief Synthetic scene: landmarks with a random SIFT descriptor each
+ */
+struct Scene
+{
+  std::vector<Vec3> points;
+  std::vector<DescriptorT> descriptors;
+};
+
+Scene generateScene(std::size_t nbPoints, std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> distX(-3.0, 3.0);
+  std::uniform_real_distribution<double> distY(-2.0, 2.0);
+  std::uniform_real_distribution<double> distZ(5.0, 8.0);
+  std::uniform_int_distribution<int> distDesc(0, 255);
+
+  Scene scene;
+  for(std::size_t i = 0; i < nbPoints; ++i)
+  {
+    scene.points.emplace_back(distX(generator), distY(generator), distZ(generator));
+    DescriptorT descriptor;
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      descriptor[j] = static_cast<unsigned char>(distDesc(generator));
+    scene.descriptors.push_back(descriptor);
+  }
+  return scene;
+}
+
+/**
+ * @brief Regions of the landmarks visible from a camera center, and their landmark ids
+ */
+std::unique_ptr<feature::SIFT_Regions> generateRegions(const Scene& scene, const Vec3& center, std::vector<IndexT>& landmarkIds)
+{
+  const geometry::Pose3 pose(Mat3::Identity(), center);
+  std::unique_ptr<feature::SIFT_Regions> regions(new feature::SIFT_Regions());
+  landmarkIds.clear();
+
+  for(std::size_t i = 0; i < scene.points.size(); ++i)
+  {
+    if(pose.depth(scene.points[i]) <= 0.0)
+      continue;
+    const Vec2 x = intrinsics.project(pose, scene.points[i]);
+    if(x(0) < 0.0 || x(0) >= width || x(1) < 0.0 || x(1) >= height)
+      continue;
+    regions->Features().emplace_back(x(0), x(1), 1.0f, 0.0f);
+    regions->Descriptors().push_back(scene.descriptors[i]);
+    landmarkIds.push_back(i);
+  }
+  return regions;
+}
+
+/**
+ * @brief Save the database views, their features and a one level vocabulary tree,
+ * and create the localizer
+ */
+std::unique_ptr<localization::VoctreeLocalizer> createLocalizer(const Scene& scene, const fs::path& folder, std::mt19937& generator)
+{
+  sfmData::SfMData sfmData;
+  sfmData.intrinsics[0] = std::make_shared<camera::PinholeRadialK3>(intrinsics);
+
+  for(IndexT viewId = 0; viewId < 5; ++viewId)
+  {
+    const Vec3 center(-1.0 + 0.5 * viewId, 0.0, 0.0);
+    std::shared_ptr<sfmData::View> view = std::make_shared<sfmData::View>("", viewId, 0, viewId, width, height);
+    sfmData.views[viewId] = view;
+    sfmData.setPose(*view, sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), center)));
+
+    std::vector<IndexT> landmarkIds;
+    const std::unique_ptr<feature::SIFT_Regions> regions = generateRegions(scene, center, landmarkIds);
+    for(std::size_t featId = 0; featId < landmarkIds.size(); ++featId)
+    {
+      sfmData::Landmark& landmark = sfmData.structure[landmarkIds[featId]];
+      landmark.X = scene.points[landmarkIds[featId]];
+      landmark.descType = feature::EImageDescriberType::SIFT;
+      landmark.observations[viewId] = sfmData::Observation(regions->GetRegionPosition(featId), featId);
+    }
+    const std::string basename = (folder / std::to_string(viewId)).string();
+    regions->Save(basename + ".sift.feat", basename + ".sift.desc");
+  }
+
+  voctree::MutableVocabularyTree<DescriptorT> tree;
+  const std::size_t nbWords = 8;
+  tree.setSize(1, nbWords);
+  std::uniform_int_distribution<std::size_t> distPoint(0, scene.descriptors.size() - 1);
+  tree.centers().clear();
+  for(std::size_t i = 0; i < nbWords; ++i)
+    tree.centers().push_back(scene.descriptors[distPoint(generator)]);
+  tree.validCenters().assign(nbWords, 1);
+  const std::string treePath = (folder / "tree.sift.tree").string();
+  tree.save(treePath);
+
+  return std::unique_ptr<localization::VoctreeLocalizer>(new localization::VoctreeLocalizer(sfmData,
+                                                                                            folder.string(),
+                                                                                            treePath,
+                                                                                            "",
+                                                                                            {feature::EImageDescriberType::SIFT}));
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a synthetic scene with random descriptors, its database views and a vocabulary tree
+// - Localize a few frames with the streaming localizer and with the sequential localize()
+// - Assert that the frames are given back in order with the same poses as the sequential localization
+//-----------------
+BOOST_AUTO_TEST_CASE(StreamingLocalizer_sameAsSequential)
+{
+  std::mt19937 generator(42);
+  const Scene scene = generateScene(400, generator);
+
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(folder);
+
+  std::unique_ptr<localization::VoctreeLocalizer> localizer = createLocalizer(scene, folder, generator);
+  BOOST_REQUIRE(localizer->isInit());
+
+  localization::VoctreeLocalizer::Parameters param;
+  param._algorithm = localization::VoctreeLocalizer::Algorithm::AllResults;
+  param._numResults = 3;
+  param._nbFrameBufferMatching = 0;
+  param._refineIntrinsics = false;
+
+  std::vector<Vec3> frameCenters;
+  for(int i = 0; i < 6; ++i)
+    frameCenters.emplace_back(-0.8 + 0.3 * i, 0.1, 0.2);
+
+  // sequential localization
+  std::vector<geometry::Pose3> sequentialPoses;
+  for(const Vec3& center : frameCenters)
+  {
+    std::vector<IndexT> landmarkIds;
+    feature::MapRegionsPerDesc regions;
+    regions[feature::EImageDescriberType::SIFT] = generateRegions(scene, center, landmarkIds);
+
+    camera::PinholeRadialK3 queryIntrinsics = intrinsics;
+    localization::LocalizationResult result;
+    BOOST_REQUIRE(localizer->localize(regions, std::make_pair(width, height), &param, true, queryIntrinsics, result));
+    BOOST_CHECK_SMALL((result.getPose().center() - center).norm(), 1e-3);
+    sequentialPoses.push_back(result.getPose());
+  }
+
+  // streaming localization, with the frame regions given by the source
+  localization::StreamingLocalizer::Parameters streamingParam;
+  streamingParam._usePosePrior = false;
+  localization::StreamingLocalizer streamingLocalizer(*localizer, param, streamingParam);
+
+  std::size_t nextFrame = 0;
+  const auto source = [&](localization::StreamingLocalizer::Frame& frame)
+  {
+    if(nextFrame == frameCenters.size())
+      return false;
+    std::vector<IndexT> landmarkIds;
+    frame._imageGrey.resize(width, height);
+    frame._intrinsics = intrinsics;
+    frame._hasIntrinsics = true;
+    frame._regions[feature::EImageDescriberType::SIFT] = generateRegions(scene, frameCenters[nextFrame], landmarkIds);
+    ++nextFrame;
+    return true;
+  };
+
+  std::vector<geometry::Pose3> streamingPoses;
+  const std::size_t nbLocalized = streamingLocalizer.run(source, [&](const localization::StreamingLocalizer::FrameResult& result)
+  {
+    BOOST_CHECK_EQUAL(result._frameId, streamingPoses.size());
+    BOOST_CHECK(result._localizationResult.isValid());
+    streamingPoses.push_back(result._localizationResult.getPose());
+  });
+
+  BOOST_CHECK_EQUAL(nbLocalized, frameCenters.size());
+  BOOST_REQUIRE_EQUAL(streamingPoses.size(), sequentialPoses.size());
+  for(std::size_t i = 0; i < streamingPoses.size(); ++i)
+  {
+    BOOST_CHECK_SMALL((streamingPoses[i].center() - sequentialPoses[i].center()).norm(), 1e-3);
+    BOOST_CHECK_SMALL((streamingPoses[i].rotation() - sequentialPoses[i].rotation()).norm(), 1e-3);
+  }
+
+  // only the AllResults algorithm can be streamed
+  param._algorithm = localization::VoctreeLocalizer::Algorithm::FirstBest;
+  BOOST_CHECK_THROW(localization::StreamingLocalizer(*localizer, param), std::invalid_argument);
+
+  fs::remove_all(folder);
+}
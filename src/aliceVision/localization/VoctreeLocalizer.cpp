@@ -29,6 +29,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <set>
 
 namespace aliceVision {
 namespace localization {
@@ -102,6 +103,18 @@ FrameData::FrameData(const LocalizationResult &locResult, const feature::MapRegi
   }
 }
 
+/**
+ * @brief Check that a landmark is in front of the expected camera and that it
+ * projects close to its associated query feature.
+ */
+static bool isConsistentWithPrior(const VoctreeLocalizer::PosePrior& posePrior, const Vec3& X, const Vec2& feature)
+{
+  if(posePrior._pose.depth(X) <= 0.0)
+    return false;
+  return (posePrior._intrinsics.project(posePrior._pose, X) - feature).squaredNorm() <=
+         posePrior._maxReprojectionError * posePrior._maxReprojectionError;
+}
+
 VoctreeLocalizer::Algorithm VoctreeLocalizer::initFromString(const std::string &value)
 {
   if(value=="FirstBest")
@@ -191,8 +204,43 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
                                 const std::string& imagePath /* = std::string() */)
 {
   // A. extract descriptors and features from image
-  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
   feature::MapRegionsPerDesc queryRegionsPerDesc;
+  extractRegions(imageGrey, param, queryRegionsPerDesc);
+
+  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
+
+  // if debugging is enable save the svg image with the extracted features
+  if(!param->_visualDebug.empty() && !imagePath.empty())
+  {
+    feature::MapFeaturesPerDesc extractedFeatures;
+
+    for(const auto& imageDescriber : _imageDescribers)
+    {
+      const auto descType = imageDescriber->getDescriberType();
+      extractedFeatures[descType] = queryRegionsPerDesc.at(descType)->GetRegionsPositions();
+    }
+
+    namespace bfs = boost::filesystem;
+    feature::saveFeatures2SVG(imagePath,
+                     queryImageSize,
+                     extractedFeatures,
+                     param->_visualDebug + "/" + bfs::path(imagePath).stem().string() + ".svg");
+  }
+
+  return localize(queryRegionsPerDesc,
+                  queryImageSize,
+                  param,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  localizationResult,
+                  imagePath);
+}
+
+void VoctreeLocalizer::extractRegions(const image::Image<float>& imageGrey,
+                                      const LocalizerParameters *param,
+                                      feature::MapRegionsPerDesc& queryRegionsPerDesc)
+{
+  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
 
   image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
 
@@ -221,34 +269,25 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
 
     ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
   }
+}
 
-  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
-
-  // if debugging is enable save the svg image with the extracted features
-  if(!param->_visualDebug.empty() && !imagePath.empty())
+bool VoctreeLocalizer::retrieveImages(const feature::MapRegionsPerDesc& queryRegions,
+                                      std::size_t numResults,
+                                      std::vector<voctree::DocMatch>& out_matchedImages) const
+{
+  // pass the descriptors through the vocabulary tree to get the visual words
+  // associated to each feature
+  ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
+  if(queryRegions.count(_voctreeDescType) == 0)
   {
-    feature::MapFeaturesPerDesc extractedFeatures;
-
-    for(const auto& imageDescriber : _imageDescribers)
-    {
-      const auto descType = imageDescriber->getDescriberType();
-      extractedFeatures[descType] = queryRegionsPerDesc.at(descType)->GetRegionsPositions();
-    }
-
-    namespace bfs = boost::filesystem;
-    feature::saveFeatures2SVG(imagePath,
-                     queryImageSize,
-                     extractedFeatures,
-                     param->_visualDebug + "/" + bfs::path(imagePath).stem().string() + ".svg");
+    ALICEVISION_LOG_WARNING("[database]\t No feature type " << feature::EImageDescriberType_enumToString(_voctreeDescType) << " in query region.");
+    return false;
   }
+  voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
 
-  return localize(queryRegionsPerDesc,
-                  queryImageSize,
-                  param,
-                  useInputIntrinsics,
-                  queryIntrinsics,
-                  localizationResult,
-                  imagePath);
+  // Request closest images from voctree
+  _database.find(requestImageWords, (numResults == 0) ? (_database.size()) : (numResults), out_matchedImages);
+  return true;
 }
 
 bool VoctreeLocalizer::loadReconstructionDescriptors(const sfmData::SfMData & sfm_data,
@@ -631,6 +670,68 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                      matchedImages,
                      imagePath);
 
+  return resectAllResults(queryRegions,
+                          queryImageSize,
+                          param,
+                          occurences,
+                          matchedImages,
+                          useInputIntrinsics,
+                          queryIntrinsics,
+                          resectionData,
+                          localizationResult,
+                          imagePath);
+}
+
+bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &queryRegions,
+                                          const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                          const Parameters &param,
+                                          const std::vector<voctree::DocMatch>& matchedImages,
+                                          const PosePrior* posePrior,
+                                          bool useInputIntrinsics,
+                                          camera::PinholeRadialK3 &queryIntrinsics,
+                                          LocalizationResult &localizationResult,
+                                          const std::string& imagePath)
+{
+  sfm::ImageLocalizerMatchData resectionData;
+  OccurenceMap occurences;
+
+  // get all the association from the given database images
+  getAllAssociations(queryRegions,
+                     queryImageSize,
+                     param,
+                     useInputIntrinsics,
+                     queryIntrinsics,
+                     matchedImages,
+                     posePrior,
+                     occurences,
+                     resectionData.pt2D,
+                     resectionData.pt3D,
+                     resectionData.vec_descType,
+                     imagePath);
+
+  return resectAllResults(queryRegions,
+                          queryImageSize,
+                          param,
+                          occurences,
+                          matchedImages,
+                          useInputIntrinsics,
+                          queryIntrinsics,
+                          resectionData,
+                          localizationResult,
+                          imagePath);
+}
+
+bool VoctreeLocalizer::resectAllResults(const feature::MapRegionsPerDesc &queryRegions,
+                                        const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                        const Parameters &param,
+                                        const OccurenceMap &occurences,
+                                        const std::vector<voctree::DocMatch>& matchedImages,
+                                        bool useInputIntrinsics,
+                                        camera::PinholeRadialK3 &queryIntrinsics,
+                                        sfm::ImageLocalizerMatchData &resectionData,
+                                        LocalizationResult &localizationResult,
+                                        const std::string& imagePath)
+{
   const std::size_t numCollectedPts = occurences.size();
   std::vector<IndMatch3D2D> associationIDs;
   associationIDs.reserve(numCollectedPts);
@@ -754,31 +855,54 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   assert(out_descTypes.size() == 0);
 
   // A. Find the (visually) similar images in the database 
-  // pass the descriptors through the vocabulary tree to get the visual words
-  // associated to each feature
-  ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
-  if(queryRegions.count(_voctreeDescType) == 0)
-  {
-    ALICEVISION_LOG_WARNING("[database]\t No feature type " << feature::EImageDescriberType_enumToString(_voctreeDescType) << " in query region.");
+  if(!retrieveImages(queryRegions, param._numResults, out_matchedImages))
     return;
-  }
-  voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
-  
-  // Request closest images from voctree
-  _database.find(requestImageWords, (param._numResults==0) ? (_database.size()) : (param._numResults) , out_matchedImages);
 
-//  // Debugging log
-//  // for each similar image found print score and number of features
-//  for(const voctree::DocMatch& currMatch : matchedImages )
-//  {
-//    // get the view handle
-//    const std::shared_ptr<sfmData::View> matchedView = _sfm_data.views[currMatch.id];
-//    ALICEVISION_LOG_DEBUG( "[database]\t\t match " << matchedView->getImagePath()
-//            << " [docid: "<< currMatch.id << "]"
-//            << " with score " << currMatch.score 
-//            << " and it has "  << _regions_per_view[currMatch.id]._regions.RegionCount() 
-//            << " features with 3D points");
-//  }
+  getAllAssociations(queryRegions,
+                     imageSize,
+                     param,
+                     useInputIntrinsics,
+                     queryIntrinsics,
+                     out_matchedImages,
+                     nullptr,
+                     out_occurences,
+                     out_pt2D,
+                     out_pt3D,
+                     out_descTypes,
+                     imagePath);
+}
+
+void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &queryRegions,
+                                          const std::pair<std::size_t, std::size_t> &imageSize,
+                                          const Parameters &param,
+                                          bool useInputIntrinsics,
+                                          const camera::PinholeRadialK3 &queryIntrinsics,
+                                          const std::vector<voctree::DocMatch>& matchedImages,
+                                          const PosePrior* posePrior,
+                                          OccurenceMap &out_occurences,
+                                          Mat &out_pt2D,
+                                          Mat &out_pt3D,
+                                          std::vector<feature::EImageDescriberType>& out_descTypes,
+                                          const std::string& imagePath) const
+{
+  assert(out_descTypes.size() == 0);
+
+  // with a pose prior, the images matched with the previous query are tried first
+  std::vector<voctree::DocMatch> candidateImages;
+  if(posePrior != nullptr)
+  {
+    candidateImages.reserve(posePrior->_matchedImages.size() + matchedImages.size());
+    std::set<voctree::DocId> candidateIds;
+    for(const std::vector<voctree::DocMatch>* images : {&posePrior->_matchedImages, &matchedImages})
+    {
+      for(const voctree::DocMatch& image : *images)
+      {
+        if(_sfm_data.views.count(image.id) && candidateIds.insert(image.id).second)
+          candidateImages.push_back(image);
+      }
+    }
+  }
+  const std::vector<voctree::DocMatch>& queryImages = (posePrior != nullptr) ? candidateImages : matchedImages;
 
   ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
   matching::RegionsDatabaseMatcherPerDesc matchers(_matcherType, queryRegions);
@@ -789,7 +913,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   // query image adn the similar image
   // stop when param._maxResults successful matches have been found
   std::size_t goodMatches = 0;
-  for(const voctree::DocMatch& matchedImage : out_matchedImages)
+  for(const voctree::DocMatch& matchedImage : queryImages)
   {
     // minimum number of points that allows a reliable 3D reconstruction
     const size_t minNum3DPoints = 5;
@@ -808,6 +932,12 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
       ALICEVISION_LOG_DEBUG("[matching]\tSkipping matching with " << matchedView->getImagePath() << " as it has too few visible 3D points");
       continue;
     }
+    // with a pose prior, skip the images that do not see the expected field of view
+    if(posePrior != nullptr && getVisibleRatio(matchedViewId, *posePrior) < posePrior->_minVisibleRatio)
+    {
+      ALICEVISION_LOG_DEBUG("[matching]\tSkipping matching with " << matchedView->getImagePath() << " as too few 3D points are visible with the pose prior");
+      continue;
+    }
     ALICEVISION_LOG_TRACE("[matching]\tTrying to match the query image with " << matchedView->getImagePath());
     ALICEVISION_LOG_TRACE("[matching]\tIt has " << matchedRegions.getNbAllRegions() << " available features to match");
     
@@ -901,6 +1031,11 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
         const IndexT pt3D_id = matchedRegionsMappingType._associated3dPoint[featureMatch._j];
         const IndexT pt2D_id = featureMatch._i;
 
+        if(posePrior != nullptr && !isConsistentWithPrior(*posePrior,
+                                                          _sfm_data.getLandmarks().at(pt3D_id).X,
+                                                          queryRegions.at(descType)->GetRegionPosition(pt2D_id)))
+          continue;
+
         const OccurenceKey key(pt3D_id, descType, pt2D_id);
         if(out_occurences.count(key))
         {
@@ -925,7 +1060,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   {
     ALICEVISION_LOG_DEBUG("[matching]\tUsing frameBuffer matching: matching with the past " 
             << param._nbFrameBufferMatching << " frames" );
-    getAssociationsFromBuffer(matchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences);
+    getAssociationsFromBuffer(matchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences, posePrior);
   }
   
   const std::size_t numCollectedPts = out_occurences.size();
@@ -981,6 +1116,7 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
                                                  bool useInputIntrinsics,
                                                  const camera::PinholeRadialK3 &queryIntrinsics,
                                                  OccurenceMap & out_occurences,
+                                                 const PosePrior* posePrior,
                                                  const std::string& imagePath) const
 {
   std::size_t frameCounter = 0;
@@ -1028,6 +1164,12 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
         // the ID of the 3D point
         const IndexT pt3D_id = frameReconstructedRegions.at(descType)._associated3dPoint.at(featureMatch._j);
         const IndexT pt2D_id = featureMatch._i;
+
+        if(posePrior != nullptr && !isConsistentWithPrior(*posePrior,
+                                                          _sfm_data.getLandmarks().at(pt3D_id).X,
+                                                          matchers.getDatabaseRegions(descType).GetRegionPosition(pt2D_id)))
+          continue;
+
         const OccurenceKey key(pt3D_id, descType, pt2D_id);
 
         if(out_occurences.count(key))
@@ -1047,6 +1189,29 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
   }
 }
 
+double VoctreeLocalizer::getVisibleRatio(IndexT viewId, const PosePrior& posePrior) const
+{
+  const double width = posePrior._intrinsics.w();
+  const double height = posePrior._intrinsics.h();
+  std::size_t nbLandmarks = 0;
+  std::size_t nbVisible = 0;
+
+  for(const auto& mappingIt : _reconstructedRegionsMappingPerView.at(viewId))
+  {
+    for(const IndexT landmarkId : mappingIt.second._associated3dPoint)
+    {
+      ++nbLandmarks;
+      const Vec3& X = _sfm_data.getLandmarks().at(landmarkId).X;
+      if(posePrior._pose.depth(X) <= 0.0)
+        continue;
+      const Vec2 x = posePrior._intrinsics.project(posePrior._pose, X, false);
+      if(x(0) >= 0.0 && x(0) < width && x(1) >= 0.0 && x(1) < height)
+        ++nbVisible;
+    }
+  }
+  return (nbLandmarks == 0) ? 0.0 : static_cast<double>(nbVisible) / nbLandmarks;
+}
+
 bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
                                       const camera::IntrinsicBase * queryIntrinsicsBase,   // the intrinsics of the image we are using as reference
                                       const feature::MapRegionsPerDesc & matchedRegions,
@@ -76,7 +76,26 @@ public:
     /// maximum capacity of the frame buffer
     std::size_t _nbFrameBufferMatching;
   };
-  
+
+  /**
+   * @brief The expected pose of the query camera, e.g. the pose of the previous
+   * frame of a video. It is used to restrict the database images and the landmarks
+   * considered for the localization.
+   */
+  struct PosePrior
+  {
+    /// the expected pose of the query camera
+    geometry::Pose3 _pose;
+    /// the intrinsics used to project the landmarks with the expected pose
+    camera::PinholeRadialK3 _intrinsics;
+    /// maximum distance (in pixels) between a query feature and its landmark projected with the expected pose
+    double _maxReprojectionError = 100.0;
+    /// minimum ratio of the landmarks of a database image that must project inside the query image
+    double _minVisibleRatio = 0.1;
+    /// database images matched with the previous query, they are tried before the retrieved images
+    std::vector<voctree::DocMatch> _matchedImages;
+  };
+
 public:
   
   /**
@@ -128,6 +147,31 @@ public:
                 LocalizationResult &localizationResult, 
                 const std::string& imagePath = std::string()) override;
 
+  /**
+   * @brief Extract the regions of the query image with all the image describers
+   * of the localizer.
+   *
+   * @param[in] imageGrey The input greyscale image.
+   * @param[in] param The parameters for the localization.
+   * @param[out] queryRegions The extracted regions for each describer type.
+   */
+  void extractRegions(const image::Image<float>& imageGrey,
+                      const LocalizerParameters *param,
+                      feature::MapRegionsPerDesc& queryRegions);
+
+  /**
+   * @brief Query the vocabulary tree database to find the images the most similar
+   * to the query image.
+   *
+   * @param[in] queryRegions The input features of the query image.
+   * @param[in] numResults The number of images to retrieve (0 for all the database).
+   * @param[out] out_matchedImages The retrieved images sorted by score.
+   * @return false if the query has no regions of the vocabulary tree describer type.
+   */
+  bool retrieveImages(const feature::MapRegionsPerDesc& queryRegions,
+                      std::size_t numResults,
+                      std::vector<voctree::DocMatch>& out_matchedImages) const;
+
   /**
    * @brief Just a wrapper around the different localization algorithm, the algorithm
    * used to localized is chosen using \p param._algorithm. This version takes as
@@ -235,8 +279,34 @@ public:
                           camera::PinholeRadialK3 &queryIntrinsics,
                           LocalizationResult &localizationResult,
                           const std::string& imagePath = std::string());
-  
-  
+
+  /**
+   * @brief Same as localizeAllResults but with the images already retrieved from
+   * the database (see retrieveImages) and an optional pose prior.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] matchedImages The images retrieved from the database
+   * @param[in] posePrior The expected pose of the query camera, can be nullptr
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera, they are used if the
+   * flag useInputIntrinsics is set to true, otherwise they are estimated from the correspondences.
+   * @param[out] localizationResult The localization result containing the pose and the associations.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the localization is successful
+   */
+  bool localizeAllResults(const feature::MapRegionsPerDesc & queryRegions,
+                          const std::pair<std::size_t, std::size_t> & imageSize,
+                          const Parameters &param,
+                          const std::vector<voctree::DocMatch>& matchedImages,
+                          const PosePrior* posePrior,
+                          bool useInputIntrinsics,
+                          camera::PinholeRadialK3 &queryIntrinsics,
+                          LocalizationResult &localizationResult,
+                          const std::string& imagePath = std::string());
+
+
   /**
    * @brief Retrieve matches to all images of the database.
    *
@@ -264,7 +334,73 @@ public:
                           std::vector<voctree::DocMatch>& out_matchedImages,
                           const std::string& imagePath = std::string()) const;
 
+  /**
+   * @brief Retrieve matches to the given images of the database.
+   * If a pose prior is given, the images of the previous query are tried first,
+   * the images with too few landmarks inside the expected field of view are skipped
+   * and the associations that are not consistent with the expected pose are discarded.
+   *
+   * @param[in] queryRegions
+   * @param[in] imageSize
+   * @param[in] param
+   * @param[in] useInputIntrinsics
+   * @param[in] queryIntrinsics
+   * @param[in] matchedImages the images retrieved from the database
+   * @param[in] posePrior the expected pose of the query camera, can be nullptr
+   * @param[out] out_occurences
+   * @param[out] out_pt2D output matrix of 2D points
+   * @param[out] out_pt3D output matrix of 3D points
+   * @param[out] out_descTypes output vector of describerType
+   * @param[in] imagePath
+   */
+  void getAllAssociations(const feature::MapRegionsPerDesc & queryRegions,
+                          const std::pair<std::size_t, std::size_t> &imageSize,
+                          const Parameters &param,
+                          bool useInputIntrinsics,
+                          const camera::PinholeRadialK3 &queryIntrinsics,
+                          const std::vector<voctree::DocMatch>& matchedImages,
+                          const PosePrior* posePrior,
+                          OccurenceMap & out_occurences,
+                          Mat &out_pt2D,
+                          Mat &out_pt3D,
+                          std::vector<feature::EImageDescriberType>& out_descTypes,
+                          const std::string& imagePath = std::string()) const;
+
+  /**
+   * @brief Estimate and refine the pose from the collected 2D-3D associations
+   * (second part of the AllResults algorithm, see getAllAssociations for the first part).
+   * The localized frame is added to the frame buffer if the frame buffer matching is enabled.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] occurences The collected 2D-3D associations
+   * @param[in] matchedImages The images matched with the query image
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera
+   * @param[in,out] resectionData The 2D-3D correspondences of the associations
+   * @param[out] localizationResult The localization result containing the pose and the associations.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the localization is successful
+   */
+  bool resectAllResults(const feature::MapRegionsPerDesc & queryRegions,
+                        const std::pair<std::size_t, std::size_t> & imageSize,
+                        const Parameters &param,
+                        const OccurenceMap &occurences,
+                        const std::vector<voctree::DocMatch>& matchedImages,
+                        bool useInputIntrinsics,
+                        camera::PinholeRadialK3 &queryIntrinsics,
+                        sfm::ImageLocalizerMatchData &resectionData,
+                        LocalizationResult &localizationResult,
+                        const std::string& imagePath);
+
 private:
+  /**
+   * @brief Ratio of the landmarks of a database view that project inside the
+   * query image with the expected pose.
+   */
+  double getVisibleRatio(IndexT viewId, const PosePrior& posePrior) const;
+
   /**
    * @brief Load the vocabulary tree.
 
@@ -317,6 +453,7 @@ private:
                                  bool useInputIntrinsics,
                                  const camera::PinholeRadialK3 &queryIntrinsics,
                                  OccurenceMap &out_occurences,
+                                 const PosePrior* posePrior = nullptr,
                                  const std::string& imagePath = std::string()) const;
   
   /**
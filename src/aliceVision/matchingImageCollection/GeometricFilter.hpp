@@ -12,6 +12,8 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 
 #include <boost/progress.hpp>
 
@@ -46,6 +48,9 @@ void robustModelEstimation(
   const bool guidedMatching = false,
   const double distanceRatio = 0.6)
 {
+  ALICEVISION_PROFILE_ZONE("matching::geometricFilter");
+  ALICEVISION_MEMORY_PHASE("matching::geometricFilter");
+
   out_geometricMatches.clear();
 
   boost::progress_display progressBar(putativeMatches.size(), std::cout, "Robust Model Estimation\n");
@@ -62,6 +67,7 @@ void robustModelEstimation(
 
     // apply the geometric filter (robust model estimation)
     {
+      ALICEVISION_PROFILE_ZONE("matching::geometricEstimation");
       MatchesPerDescType inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
       const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, inliers);
@@ -69,6 +75,7 @@ void robustModelEstimation(
       {
         if(guidedMatching)
         {
+          ALICEVISION_PROFILE_ZONE("matching::guidedMatching");
           MatchesPerDescType guidedGeometricInliers;
           geometricFilter.Geometry_guided_matching(sfmData, regionsPerView, imagePair, distanceRatio, guidedGeometricInliers);
           //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
@@ -9,6 +9,8 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/IndMatchDecorator.hpp>
 #include <aliceVision/matching/filters.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
@@ -215,6 +217,9 @@ void ImageCollectionMatcher_cascadeHashing::Match
   PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
 ) const
 {
+  ALICEVISION_PROFILE_ZONE("matching::putativeMatches");
+  ALICEVISION_MEMORY_PHASE("matching::putativeMatches");
+
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
   ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
 #endif
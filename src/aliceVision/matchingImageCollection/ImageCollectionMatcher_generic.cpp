@@ -11,6 +11,8 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/RegionsMatcher.hpp>
 #include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
@@ -35,6 +37,9 @@ void ImageCollectionMatcher_generic::Match(
   feature::EImageDescriberType descType,
   matching::PairwiseMatches & map_PutativesMatches)const // the pairwise photometric corresponding points
 {
+  ALICEVISION_PROFILE_ZONE("matching::putativeMatches");
+  ALICEVISION_MEMORY_PHASE("matching::putativeMatches");
+
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
   ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
 #endif
@@ -83,7 +88,10 @@ void ImageCollectionMatcher_generic::Match(
       }
 
       IndMatches vec_putatives_matches;
-      matcher.Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
+      {
+        ALICEVISION_PROFILE_ZONE("matching::matchPair");
+        matcher.Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
+      }
       #pragma omp critical
       {
         ++my_progress_bar;
@@ -12,8 +12,12 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <map>
+#include <memory>
 
 namespace aliceVision {
 namespace mesh {
@@ -30,6 +34,19 @@ Mesh::~Mesh()
     delete tris;
 }
 
+void Mesh::save(const std::string& filename)
+{
+    switch(EMeshFileType_fromFilepath(filename))
+    {
+        case EMeshFileType::OBJ:
+            saveToObj(filename);
+            break;
+        case EMeshFileType::PLY:
+            saveToPly(filename);
+            break;
+    }
+}
+
 void Mesh::saveToObj(const std::string& filename)
 {
   ALICEVISION_LOG_INFO("Save mesh to obj: " << filename);
@@ -37,24 +54,180 @@ void Mesh::saveToObj(const std::string& filename)
   ALICEVISION_LOG_INFO("Nb triangles: " << tris->size());
 
   FILE* f = fopen(filename.c_str(), "w");
+  if(f == nullptr)
+      throw std::runtime_error("Unable to create: " + filename);
 
   fprintf(f, "# \n");
   fprintf(f, "# Wavefront OBJ file\n");
   fprintf(f, "# Created with AliceVision\n");
   fprintf(f, "# \n");
   fprintf(f, "g Mesh\n");
-  for(int i = 0; i < pts->size(); i++)
-      fprintf(f, "v %f %f %f\n", (*pts)[i].x, (*pts)[i].y, (*pts)[i].z);
 
-  for(int i = 0; i < tris->size(); i++)
+  // the lines are formatted in parallel by blocks
+  bool ok = writeLinesParallel(f, pts->size(), [&](int i, char* line, int lineSize)
   {
-      Mesh::triangle& t = (*tris)[i];
-      fprintf(f, "f %i %i %i\n", t.v[0] + 1, t.v[1] + 1, t.v[2] + 1);
-  }
+      return snprintf(line, lineSize, "v %f %f %f\n", (*pts)[i].x, (*pts)[i].y, (*pts)[i].z);
+  });
+  ok = ok && writeLinesParallel(f, tris->size(), [&](int i, char* line, int lineSize)
+  {
+      const Mesh::triangle& t = (*tris)[i];
+      return snprintf(line, lineSize, "f %i %i %i\n", t.v[0] + 1, t.v[1] + 1, t.v[2] + 1);
+  });
   fclose(f);
+  if(!ok)
+      throw std::runtime_error("Unable to write: " + filename);
   ALICEVISION_LOG_INFO("Save mesh to obj done.");
 }
 
+/**
+ * @brief Write a PLY file, the vertex normals, the texture coordinates and the material ids of the triangles are optional
+ */
+static void writePly(const std::string& filename, const StaticVector<Point3d>& pts, const StaticVector<Mesh::triangle>& tris,
+                     const StaticVector<Point3d>* normals, const StaticVector<Point2d>* uvCoords, const StaticVector<Voxel>* trisUvIds,
+                     const StaticVector<int>* trisMtlIds, const std::vector<std::string>& textureFiles, bool binary)
+{
+    if(binary && !isLittleEndianHost())
+        throw std::runtime_error("Binary PLY files can only be written on little-endian hosts: " + filename);
+
+    const bool withNormals = (normals != nullptr);
+    const bool withUVs = (uvCoords != nullptr && trisUvIds != nullptr);
+    const bool withMtlIds = (trisMtlIds != nullptr);
+
+    FILE* f = fopen(filename.c_str(), binary ? "wb" : "w");
+    if(f == nullptr)
+        throw std::runtime_error("Unable to create: " + filename);
+
+    fprintf(f, "ply\n");
+    fprintf(f, "format %s 1.0\n", binary ? "binary_little_endian" : "ascii");
+    fprintf(f, "comment Created with AliceVision\n");
+    for(const std::string& textureFile : textureFiles)
+        fprintf(f, "comment TextureFile %s\n", textureFile.c_str());
+    fprintf(f, "element vertex %i\n", pts.size());
+    fprintf(f, "property double x\n");
+    fprintf(f, "property double y\n");
+    fprintf(f, "property double z\n");
+    if(withNormals)
+    {
+        fprintf(f, "property float nx\n");
+        fprintf(f, "property float ny\n");
+        fprintf(f, "property float nz\n");
+    }
+    fprintf(f, "element face %i\n", tris.size());
+    fprintf(f, "property list uchar int vertex_indices\n");
+    if(withUVs)
+        fprintf(f, "property list uchar float texcoord\n");
+    if(withMtlIds)
+        fprintf(f, "property int texnumber\n");
+    fprintf(f, "end_header\n");
+
+    bool ok;
+    if(binary)
+    {
+        // 3 float64 [+ 3 float32]
+        const std::size_t vertexRecordSize = 3 * sizeof(double) + (withNormals ? 3 * sizeof(float) : 0);
+        ok = writeRecordsParallel(f, pts.size(), vertexRecordSize, [&](int i, char* record)
+        {
+            const double xyz[3] = {pts[i].x, pts[i].y, pts[i].z};
+            std::memcpy(record, xyz, sizeof(xyz));
+            if(withNormals)
+            {
+                const float n[3] = {static_cast<float>((*normals)[i].x), static_cast<float>((*normals)[i].y),
+                                    static_cast<float>((*normals)[i].z)};
+                std::memcpy(record + sizeof(xyz), n, sizeof(n));
+            }
+        });
+
+        // uchar + 3 int32 [+ uchar + 6 float32] [+ int32]
+        const std::size_t faceRecordSize = 1 + 3 * sizeof(std::int32_t) + (withUVs ? 1 + 6 * sizeof(float) : 0) +
+                                           (withMtlIds ? sizeof(std::int32_t) : 0);
+        ok = ok && writeRecordsParallel(f, tris.size(), faceRecordSize, [&](int i, char* record)
+        {
+            record[0] = 3;
+            const std::int32_t v[3] = {tris[i].v[0], tris[i].v[1], tris[i].v[2]};
+            std::memcpy(record + 1, v, sizeof(v));
+            record += 1 + sizeof(v);
+            if(withUVs)
+            {
+                record[0] = 6;
+                float uv[6];
+                for(int k = 0; k < 3; ++k)
+                {
+                    const Point2d& uvCoord = (*uvCoords)[(*trisUvIds)[i].m[k]];
+                    uv[2 * k] = static_cast<float>(uvCoord.x);
+                    uv[2 * k + 1] = static_cast<float>(uvCoord.y);
+                }
+                std::memcpy(record + 1, uv, sizeof(uv));
+                record += 1 + sizeof(uv);
+            }
+            if(withMtlIds)
+            {
+                const std::int32_t mtlId = (*trisMtlIds)[i];
+                std::memcpy(record, &mtlId, sizeof(mtlId));
+            }
+        });
+    }
+    else
+    {
+        ok = writeLinesParallel(f, pts.size(), [&](int i, char* line, int lineSize)
+        {
+            if(withNormals)
+                return snprintf(line, lineSize, "%.17g %.17g %.17g %.9g %.9g %.9g\n", pts[i].x, pts[i].y, pts[i].z,
+                                (*normals)[i].x, (*normals)[i].y, (*normals)[i].z);
+            return snprintf(line, lineSize, "%.17g %.17g %.17g\n", pts[i].x, pts[i].y, pts[i].z);
+        });
+        ok = ok && writeLinesParallel(f, tris.size(), [&](int i, char* line, int lineSize)
+        {
+            // the size returned by snprintf may exceed the buffer, the line is then formatted again
+            int size = snprintf(line, lineSize, "3 %i %i %i", tris[i].v[0], tris[i].v[1], tris[i].v[2]);
+            if(withUVs)
+            {
+                const Point2d& uv0 = (*uvCoords)[(*trisUvIds)[i].m[0]];
+                const Point2d& uv1 = (*uvCoords)[(*trisUvIds)[i].m[1]];
+                const Point2d& uv2 = (*uvCoords)[(*trisUvIds)[i].m[2]];
+                size += snprintf(line + std::min(size, lineSize), std::max(lineSize - size, 0), " 6 %.9g %.9g %.9g %.9g %.9g %.9g",
+                                 uv0.x, uv0.y, uv1.x, uv1.y, uv2.x, uv2.y);
+            }
+            if(withMtlIds)
+                size += snprintf(line + std::min(size, lineSize), std::max(lineSize - size, 0), " %i", (*trisMtlIds)[i]);
+            size += snprintf(line + std::min(size, lineSize), std::max(lineSize - size, 0), "\n");
+            return size;
+        });
+    }
+    fclose(f);
+    if(!ok)
+        throw std::runtime_error("Unable to write: " + filename);
+}
+
+void Mesh::saveToPly(const std::string& filename, bool binary)
+{
+    ALICEVISION_LOG_INFO("Save mesh to ply: " << filename);
+    ALICEVISION_LOG_INFO("Nb points: " << pts->size());
+    ALICEVISION_LOG_INFO("Nb triangles: " << tris->size());
+
+    writePly(filename, *pts, *tris, nullptr, nullptr, nullptr, nullptr, std::vector<std::string>(), binary);
+
+    ALICEVISION_LOG_INFO("Save mesh to ply done.");
+}
+
+void Mesh::saveToPly(const std::string& filename, const StaticVector<Point2d>& uvCoords,
+                     const StaticVector<Voxel>& trisUvIds, const StaticVector<int>& trisMtlIds,
+                     const std::vector<std::string>& textureFiles, bool binary)
+{
+    ALICEVISION_LOG_INFO("Save textured mesh to ply: " << filename);
+    ALICEVISION_LOG_INFO("Nb points: " << pts->size());
+    ALICEVISION_LOG_INFO("Nb triangles: " << tris->size());
+
+    if(trisUvIds.size() != tris->size() || trisMtlIds.size() != tris->size())
+        throw std::runtime_error("Mesh: the texture coordinates or the materials do not match the triangles.");
+
+    // vertex normals for the viewers and the tools that do not recompute them
+    const std::unique_ptr<StaticVector<Point3d>> normals(computeNormalsForPts());
+
+    writePly(filename, *pts, *tris, normals.get(), &uvCoords, &trisUvIds, &trisMtlIds, textureFiles, binary);
+
+    ALICEVISION_LOG_INFO("Save textured mesh to ply done.");
+}
+
 bool Mesh::loadFromBin(std::string binFileName)
 {
     FILE* f = fopen(binFileName.c_str(), "rb");
@@ -510,57 +683,32 @@ bool Mesh::doesTriangleIntersectsRectangle(Mesh::triangle_proj* tp, Mesh::rectan
 
 StaticVector<StaticVector<int>*>* Mesh::getPtsNeighborTriangles()
 {
-    // array of tuples <x: vertexIndex, y: triangleIndex, z: numberOfNeighbors>
-    StaticVector<Voxel> vertexNeighborhoodPairs;
-    vertexNeighborhoodPairs.reserve(tris->size() * 3);
+    // number of neighbor triangles of each point
+    std::vector<int> nbNeighbors(pts->size(), 0);
     for(int i = 0; i < tris->size(); ++i)
     {
-        vertexNeighborhoodPairs.push_back(Voxel((*tris)[i].v[0], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel((*tris)[i].v[1], i, 0));
-        vertexNeighborhoodPairs.push_back(Voxel((*tris)[i].v[2], i, 0));
-    }
-    qsort(&vertexNeighborhoodPairs[0], vertexNeighborhoodPairs.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
-
-    int i = 0; // index of the unique pair of <vertex, neighborhood>
-    int j = 0; // index of the vertex
-    int k = 0; // number of neighbors
-    int firstid = 0;
-    while(i < vertexNeighborhoodPairs.size())
-    {
-        k++;
-        // (*vertexNeighborhoodPairs)[i].z = j;
-        if((i == vertexNeighborhoodPairs.size() - 1) || (vertexNeighborhoodPairs[i].x != vertexNeighborhoodPairs[i + 1].x))
-        {
-            vertexNeighborhoodPairs[firstid].z = k; // store the number of neighbors
-            ++j;
-            firstid = i + 1;
-            k = 0;
-        }
-        ++i;
+        for(int k = 0; k < 3; ++k)
+            ++nbNeighbors[(*tris)[i].v[k]];
     }
-    int npts = j;
 
     StaticVector<StaticVector<int>*>* out_ptsNeighTris = new StaticVector<StaticVector<int>*>();
     out_ptsNeighTris->reserve(pts->size());
     out_ptsNeighTris->resize_with(pts->size(), nullptr);
 
-    i = 0;
-    for(j = 0; j < npts; ++j)
+    for(int i = 0; i < pts->size(); ++i)
     {
-        int middlePtId = vertexNeighborhoodPairs[i].x;
-        int nbNeighbors = vertexNeighborhoodPairs[i].z;
-        int i0 = i;
-        int i1 = i + nbNeighbors;
-        i = i1;
-
+        if(nbNeighbors[i] == 0)
+            continue;
         StaticVector<int>* triTmp = new StaticVector<int>();
-        triTmp->reserve(nbNeighbors);
-        for(int l = i0; l < i1; ++l)
-        {
-            triTmp->push_back(vertexNeighborhoodPairs[l].y); // index of triangle
-        }
+        triTmp->reserve(nbNeighbors[i]);
+        (*out_ptsNeighTris)[i] = triTmp;
+    }
 
-        (*out_ptsNeighTris)[middlePtId] = triTmp;
+    // filled in the triangles order, so the triangles ids are sorted
+    for(int i = 0; i < tris->size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            (*out_ptsNeighTris)[(*tris)[i].v[k]]->push_back(i);
     }
 
     return out_ptsNeighTris;
@@ -568,87 +716,24 @@ StaticVector<StaticVector<int>*>* Mesh::getPtsNeighborTriangles()
 
 StaticVector<StaticVector<int>*>* Mesh::getPtsNeighPtsOrdered()
 {
-    StaticVector<StaticVector<int>*>* ptsNeighborTriangles = getPtsNeighborTriangles();
+    const MeshTopology topology(*this);
 
     StaticVector<StaticVector<int>*>* out_ptsNeighPts = new StaticVector<StaticVector<int>*>();
     out_ptsNeighPts->resize_with(pts->size(), nullptr);
 
     for(int middlePtId = 0; middlePtId < pts->size(); ++middlePtId)
     {
-        StaticVector<int>* neighborTriangles = (*ptsNeighborTriangles)[middlePtId];
-        if((neighborTriangles == nullptr) || neighborTriangles->empty())
+        const MeshTopology::Range ptNeighPts = topology.getPtNeighPts(middlePtId);
+        if(topology.getPtNeighTris(middlePtId).empty())
             continue;
 
-        StaticVector<int> vhid;
-        vhid.reserve(neighborTriangles->size() * 2);
-        int currentTriPtId = (*tris)[(*neighborTriangles)[0]].v[0];
-        int firstTriPtId = currentTriPtId;
-        vhid.push_back(currentTriPtId);
-
-        bool isThereTWithCurrentTriPtId = true;
-        while(!neighborTriangles->empty() && isThereTWithCurrentTriPtId)
-        {
-            isThereTWithCurrentTriPtId = false;
-
-            // find triangle with middlePtId and currentTriPtId and get remaining point id
-            for(int n = 0; n < neighborTriangles->size(); ++n)
-            {
-                bool ok_middlePtId = false;
-                bool ok_actTriPtId = false;
-                int remainingPtId = -1; // remaining pt id
-                for(int k = 0; k < 3; ++k)
-                {
-                    int triPtId = (*tris)[(*neighborTriangles)[n]].v[k];
-                    double length = ((*pts)[middlePtId] - (*pts)[triPtId]).size();
-                    if((triPtId != middlePtId) && (triPtId != currentTriPtId) && (length > 0.0) && (!std::isnan(length)))
-                    {
-                        remainingPtId = triPtId;
-                    }
-                    if(triPtId == middlePtId)
-                    {
-                        ok_middlePtId = true;
-                    }
-                    if(triPtId == currentTriPtId)
-                    {
-                        ok_actTriPtId = true;
-                    }
-                }
-
-                if(ok_middlePtId && ok_actTriPtId && (remainingPtId > -1))
-                {
-                    currentTriPtId = remainingPtId;
-                    neighborTriangles->remove(n);
-                    vhid.push_back(currentTriPtId);
-                    isThereTWithCurrentTriPtId = true; // we removed one, so we try again
-                    break;
-                }
-            }
-        }
-
-        if(!vhid.empty())
-        {
-            if(currentTriPtId == firstTriPtId)
-            {
-                vhid.pop(); // remove last ... which is first
-            }
-
-            // remove duplicates
-            StaticVector<int>* vhid1 = new StaticVector<int>();
-            vhid1->reserve(vhid.size());
-            for(int k1 = 0; k1 < vhid.size(); k1++)
-            {
-                if(vhid1->indexOf(vhid[k1]) == -1)
-                {
-                    vhid1->push_back(vhid[k1]);
-                }
-            }
-
-            (*out_ptsNeighPts)[middlePtId] = vhid1;
-        }
+        StaticVector<int>* vhid1 = new StaticVector<int>();
+        vhid1->reserve(ptNeighPts.size());
+        for(const int ptId : ptNeighPts)
+            vhid1->push_back(ptId);
+        (*out_ptsNeighPts)[middlePtId] = vhid1;
     }
 
-    deleteArrayOfArrays<int>(&ptsNeighborTriangles);
-
     return out_ptsNeighPts;
 }
 
@@ -1159,105 +1244,27 @@ Mesh* Mesh::generateMeshFromTrianglesSubset(const StaticVector<int>& visTris, St
     return outMesh;
 }
 
-void Mesh::getNotOrientedEdges(StaticVector<StaticVector<int>*>** edgesNeighTris,
-                                  StaticVector<Pixel>** edgesPointsPairs)
-{
-    // printf("getNotOrientedEdges\n");
-    StaticVector<Voxel>* edges = new StaticVector<Voxel>();
-    edges->reserve(tris->size() * 3);
-
-    for(int i = 0; i < tris->size(); i++)
-    {
-        int a = (*tris)[i].v[0];
-        int b = (*tris)[i].v[1];
-        int c = (*tris)[i].v[2];
-        edges->push_back(Voxel(std::min(a, b), std::max(a, b), i));
-        edges->push_back(Voxel(std::min(b, c), std::max(b, c), i));
-        edges->push_back(Voxel(std::min(c, a), std::max(c, a), i));
-    }
-
-    qsort(&(*edges)[0], edges->size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
-
-    StaticVector<StaticVector<int>*>* _edgesNeighTris = new StaticVector<StaticVector<int>*>();
-    StaticVector<Pixel>* _edgesPointsPairs = new StaticVector<Pixel>();
-
-    _edgesNeighTris->reserve(tris->size() * 3);
-    _edgesPointsPairs->reserve(tris->size() * 3);
-    // remove duplicities
-    int i0 = 0;
-    long t1 = mvsUtils::initEstimate();
-    for(int i = 0; i < edges->size(); i++)
-    {
-        if((i == edges->size() - 1) || ((*edges)[i].x != (*edges)[i + 1].x))
-        {
-            StaticVector<Voxel>* edges1 = new StaticVector<Voxel>();
-            edges1->reserve(i - i0 + 1);
-            for(int j = i0; j <= i; j++)
-            {
-                edges1->push_back((*edges)[j]);
-            }
-            qsort(&(*edges1)[0], edges1->size(), sizeof(Voxel), qSortCompareVoxelByYAsc);
-
-            int j0 = 0;
-            for(int j = 0; j < edges1->size(); j++)
-            {
-                if((j == edges1->size() - 1) || ((*edges1)[j].y != (*edges1)[j + 1].y))
-                {
-                    _edgesPointsPairs->push_back(Pixel((*edges1)[j].x, (*edges1)[j].y));
-                    StaticVector<int>* neighTris = new StaticVector<int>();
-                    neighTris->reserve(j - j0 + 1);
-                    for(int k = j0; k <= j; k++)
-                    {
-                        neighTris->push_back((*edges1)[k].z);
-                    }
-                    _edgesNeighTris->push_back(neighTris);
-                    j0 = j + 1;
-                }
-            }
-
-            delete edges1;
-            i0 = i + 1;
-        }
-
-        mvsUtils::printfEstimate(i, edges->size(), t1);
-    }
-    mvsUtils::finishEstimate();
-
-    (*edgesNeighTris) = _edgesNeighTris;
-    (*edgesPointsPairs) = _edgesPointsPairs;
-
-    delete edges;
-}
-
-StaticVector<Point3d>* Mesh::getLaplacianSmoothingVectors(StaticVector<StaticVector<int>*>* ptsNeighPts,
-                                                             double maximalNeighDist)
+StaticVector<Point3d>* Mesh::getLaplacianSmoothingVectors(const MeshTopology& topology, double maximalNeighDist)
 {
     StaticVector<Point3d>* nms = new StaticVector<Point3d>();
-    nms->reserve(pts->size());
+    nms->resize_with(pts->size(), Point3d(0.0, 0.0, 0.0));
 
+    #pragma omp parallel for
     for(int i = 0; i < pts->size(); i++)
     {
-        Point3d p = (*pts)[i];
-        StaticVector<int>* nei = (*ptsNeighPts)[i];
-        int nneighs = 0;
-        if(nei != nullptr)
-        {
-            nneighs = nei->size();
-        }
+        const Point3d p = (*pts)[i];
+        const MeshTopology::Range nei = topology.getPtNeighPts(i);
+        const int nneighs = nei.size();
 
-        if(nneighs == 0)
-        {
-            nms->push_back(Point3d(0.0, 0.0, 0.0));
-        }
-        else
+        if(nneighs > 0)
         {
             double maxNeighDist = 0.0f;
             // laplacian smoothing vector
             Point3d n = Point3d(0.0, 0.0, 0.0);
             for(int j = 0; j < nneighs; j++)
             {
-                n = n + (*pts)[(*nei)[j]];
-                maxNeighDist = std::max(maxNeighDist, (p - (*pts)[(*nei)[j]]).size());
+                n = n + (*pts)[nei[j]];
+                maxNeighDist = std::max(maxNeighDist, (p - (*pts)[nei[j]]).size());
             }
             n = ((n / (float)nneighs) - p);
 
@@ -1285,7 +1292,7 @@ StaticVector<Point3d>* Mesh::getLaplacianSmoothingVectors(StaticVector<StaticVec
                 n = Point3d(0.0, 0.0, 0.0);
             }
 
-            nms->push_back(n);
+            (*nms)[i] = n;
         }
     }
 
@@ -1294,14 +1301,13 @@ StaticVector<Point3d>* Mesh::getLaplacianSmoothingVectors(StaticVector<StaticVec
 
 void Mesh::laplacianSmoothPts(float maximalNeighDist)
 {
-    StaticVector<StaticVector<int>*>* ptsNei = getPtsNeighPtsOrdered();
-    laplacianSmoothPts(ptsNei, maximalNeighDist);
-    deleteArrayOfArrays<int>(&ptsNei);
+    const MeshTopology topology(*this);
+    laplacianSmoothPts(topology, maximalNeighDist);
 }
 
-void Mesh::laplacianSmoothPts(StaticVector<StaticVector<int>*>* ptsNeighPts, double maximalNeighDist)
+void Mesh::laplacianSmoothPts(const MeshTopology& topology, double maximalNeighDist)
 {
-    StaticVector<Point3d>* nms = getLaplacianSmoothingVectors(ptsNeighPts, maximalNeighDist);
+    StaticVector<Point3d>* nms = getLaplacianSmoothingVectors(topology, maximalNeighDist);
 
     // smooth
     for(int i = 0; i < pts->size(); i++)
@@ -1333,28 +1339,27 @@ double Mesh::computeTriangleMaxEdgeLength(int idTri) const
 
 StaticVector<Point3d>* Mesh::computeNormalsForPts()
 {
-    StaticVector<StaticVector<int>*>* ptsNeighTris = getPtsNeighborTriangles();
-    StaticVector<Point3d>* nms = computeNormalsForPts(ptsNeighTris);
-    deleteArrayOfArrays<int>(&ptsNeighTris);
-    return nms;
+    const MeshTopology topology(*this);
+    return computeNormalsForPts(topology);
 }
 
-StaticVector<Point3d>* Mesh::computeNormalsForPts(StaticVector<StaticVector<int>*>* ptsNeighTris)
+StaticVector<Point3d>* Mesh::computeNormalsForPts(const MeshTopology& topology)
 {
     StaticVector<Point3d>* nms = new StaticVector<Point3d>();
     nms->reserve(pts->size());
     nms->resize_with(pts->size(), Point3d(0.0f, 0.0f, 0.0f));
 
+    #pragma omp parallel for
     for(int i = 0; i < pts->size(); i++)
     {
-        StaticVector<int>* triTmp = (*ptsNeighTris)[i];
-        if((triTmp != nullptr) && (triTmp->size() > 0))
+        const MeshTopology::Range triTmp = topology.getPtNeighTris(i);
+        if(!triTmp.empty())
         {
             Point3d n = Point3d(0.0f, 0.0f, 0.0f);
             float nn = 0.0f;
-            for(int j = 0; j < triTmp->size(); j++)
+            for(int j = 0; j < triTmp.size(); j++)
             {
-                Point3d n1 = computeTriangleNormal((*triTmp)[j]);
+                Point3d n1 = computeTriangleNormal(triTmp[j]);
                 n1 = n1.normalize();
                 if(std::isnan(n1.x) || std::isnan(n1.y) || std::isnan(n1.z) || (n1.x != n1.x) || (n1.y != n1.y) ||
                    (n1.z != n1.z)) // check if is not NaN
@@ -1363,7 +1368,7 @@ StaticVector<Point3d>* Mesh::computeNormalsForPts(StaticVector<StaticVector<int>
                 }
                 else
                 {
-                    n = n + computeTriangleNormal((*triTmp)[j]);
+                    n = n + computeTriangleNormal(triTmp[j]);
                     nn += 1.0f;
                 }
             }
@@ -1383,22 +1388,24 @@ StaticVector<Point3d>* Mesh::computeNormalsForPts(StaticVector<StaticVector<int>
     return nms;
 }
 
-void Mesh::smoothNormals(StaticVector<Point3d>* nms, StaticVector<StaticVector<int>*>* ptsNeighPts)
+void Mesh::smoothNormals(StaticVector<Point3d>* nms, const MeshTopology& topology)
 {
     StaticVector<Point3d>* nmss = new StaticVector<Point3d>();
     nmss->reserve(pts->size());
     nmss->resize_with(pts->size(), Point3d(0.0f, 0.0f, 0.0f));
 
+    #pragma omp parallel for
     for(int i = 0; i < pts->size(); i++)
     {
+        const MeshTopology::Range ptNeighPts = topology.getPtNeighPts(i);
         Point3d n = (*nms)[i];
-        for(int j = 0; j < sizeOfStaticVector<int>((*ptsNeighPts)[i]); j++)
+        for(int j = 0; j < ptNeighPts.size(); j++)
         {
-            n = n + (*nms)[(*(*ptsNeighPts)[i])[j]];
+            n = n + (*nms)[ptNeighPts[j]];
         }
-        if(sizeOfStaticVector<int>((*ptsNeighPts)[i]) > 0)
+        if(ptNeighPts.size() > 0)
         {
-            n = n / (float)sizeOfStaticVector<int>((*ptsNeighPts)[i]);
+            n = n / (float)ptNeighPts.size();
         }
         n = n.normalize();
         if(std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z) || (n.x != n.x) || (n.y != n.y) || (n.z != n.z))
@@ -1466,57 +1473,7 @@ double Mesh::computeTriangleArea(int idTri)
     return sqrt(p * (p - a) * (p - b) * (p - c));
 }
 
-StaticVector<Voxel>* Mesh::getTrianglesEdgesIds(StaticVector<StaticVector<int>*>* edgesNeighTris)
-{
-    StaticVector<Voxel>* out = new StaticVector<Voxel>();
-    out->reserve(tris->size());
-    out->resize_with(tris->size(), Voxel(-1, -1, -1));
-
-    for(int i = 0; i < edgesNeighTris->size(); i++)
-    {
-        for(int j = 0; j < (*edgesNeighTris)[i]->size(); j++)
-        {
-            int idTri = (*(*edgesNeighTris)[i])[j];
-
-            if((*out)[idTri].x == -1)
-            {
-                (*out)[idTri].x = i;
-            }
-            else
-            {
-                if((*out)[idTri].y == -1)
-                {
-                    (*out)[idTri].y = i;
-                }
-                else
-                {
-                    if((*out)[idTri].z == -1)
-                    {
-                        (*out)[idTri].z = i;
-                    }
-                    else
-                    {
-                        ALICEVISION_LOG_ERROR("getTrianglesEdgesIds: bad condition.");
-                    }
-                }
-            }
-
-        } // for j
-    }     // for i
-
-    // check ... each triangle has to have three edge ids
-    for(int i = 0; i < tris->size(); i++)
-    {
-        if(((*out)[i].x == -1) || ((*out)[i].y == -1) || ((*out)[i].z == -1))
-        {
-            ALICEVISION_LOG_ERROR("triangle " << i << " has to have three edge ids.");
-        }
-    }
-
-    return out;
-}
-
-void Mesh::subdivideMeshCase1(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdEdgeId,
+void Mesh::subdivideMeshCase1(int i, const MeshTopology& topology, Pixel& neptIdEdgeId,
                                  StaticVector<Mesh::triangle>* tris1)
 {
     int ii[5];
@@ -1530,8 +1487,8 @@ void Mesh::subdivideMeshCase1(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdE
         int a = ii[k];
         int b = ii[k + 1];
         int c = ii[k + 2];
-        if((((*edgesi)[neptIdEdgeId.y].x == a) && ((*edgesi)[neptIdEdgeId.y].y == b)) ||
-           (((*edgesi)[neptIdEdgeId.y].y == a) && ((*edgesi)[neptIdEdgeId.y].x == b)))
+        if(((topology.getEdgePts(neptIdEdgeId.y).x == a) && (topology.getEdgePts(neptIdEdgeId.y).y == b)) ||
+           ((topology.getEdgePts(neptIdEdgeId.y).y == a) && (topology.getEdgePts(neptIdEdgeId.y).x == b)))
         {
             Mesh::triangle t;
             t.alive = true;
@@ -1548,7 +1505,7 @@ void Mesh::subdivideMeshCase1(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdE
     }
 }
 
-void Mesh::subdivideMeshCase2(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
+void Mesh::subdivideMeshCase2(int i, const MeshTopology& topology, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
                                  StaticVector<Mesh::triangle>* tris1)
 {
     int ii[5];
@@ -1562,10 +1519,10 @@ void Mesh::subdivideMeshCase2(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdE
         int a = ii[k];
         int b = ii[k + 1];
         int c = ii[k + 2];
-        if(((((*edgesi)[neptIdEdgeId1.y].x == a) && ((*edgesi)[neptIdEdgeId1.y].y == b)) ||
-            (((*edgesi)[neptIdEdgeId1.y].y == a) && ((*edgesi)[neptIdEdgeId1.y].x == b))) &&
-           ((((*edgesi)[neptIdEdgeId2.y].x == b) && ((*edgesi)[neptIdEdgeId2.y].y == c)) ||
-            (((*edgesi)[neptIdEdgeId2.y].y == b) && ((*edgesi)[neptIdEdgeId2.y].x == c))))
+        if((((topology.getEdgePts(neptIdEdgeId1.y).x == a) && (topology.getEdgePts(neptIdEdgeId1.y).y == b)) ||
+            ((topology.getEdgePts(neptIdEdgeId1.y).y == a) && (topology.getEdgePts(neptIdEdgeId1.y).x == b))) &&
+           (((topology.getEdgePts(neptIdEdgeId2.y).x == b) && (topology.getEdgePts(neptIdEdgeId2.y).y == c)) ||
+            ((topology.getEdgePts(neptIdEdgeId2.y).y == b) && (topology.getEdgePts(neptIdEdgeId2.y).x == c))))
         {
             Mesh::triangle t;
             t.alive = true;
@@ -1587,18 +1544,18 @@ void Mesh::subdivideMeshCase2(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdE
     }
 }
 
-void Mesh::subdivideMeshCase3(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
+void Mesh::subdivideMeshCase3(int i, const MeshTopology& topology, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
                                  Pixel& neptIdEdgeId3, StaticVector<Mesh::triangle>* tris1)
 {
     int a = (*tris)[i].v[0];
     int b = (*tris)[i].v[1];
     int c = (*tris)[i].v[2];
-    if(((((*edgesi)[neptIdEdgeId1.y].x == a) && ((*edgesi)[neptIdEdgeId1.y].y == b)) ||
-        (((*edgesi)[neptIdEdgeId1.y].y == a) && ((*edgesi)[neptIdEdgeId1.y].x == b))) &&
-       ((((*edgesi)[neptIdEdgeId2.y].x == b) && ((*edgesi)[neptIdEdgeId2.y].y == c)) ||
-        (((*edgesi)[neptIdEdgeId2.y].y == b) && ((*edgesi)[neptIdEdgeId2.y].x == c))) &&
-       ((((*edgesi)[neptIdEdgeId3.y].x == c) && ((*edgesi)[neptIdEdgeId3.y].y == a)) ||
-        (((*edgesi)[neptIdEdgeId3.y].y == c) && ((*edgesi)[neptIdEdgeId3.y].x == a))))
+    if((((topology.getEdgePts(neptIdEdgeId1.y).x == a) && (topology.getEdgePts(neptIdEdgeId1.y).y == b)) ||
+        ((topology.getEdgePts(neptIdEdgeId1.y).y == a) && (topology.getEdgePts(neptIdEdgeId1.y).x == b))) &&
+       (((topology.getEdgePts(neptIdEdgeId2.y).x == b) && (topology.getEdgePts(neptIdEdgeId2.y).y == c)) ||
+        ((topology.getEdgePts(neptIdEdgeId2.y).y == b) && (topology.getEdgePts(neptIdEdgeId2.y).x == c))) &&
+       (((topology.getEdgePts(neptIdEdgeId3.y).x == c) && (topology.getEdgePts(neptIdEdgeId3.y).y == a)) ||
+        ((topology.getEdgePts(neptIdEdgeId3.y).y == c) && (topology.getEdgePts(neptIdEdgeId3.y).x == a))))
     {
         Mesh::triangle t;
         t.alive = true;
@@ -1779,10 +1736,7 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
                            StaticVector<int>** trisCamsId)
 {
 
-    StaticVector<StaticVector<int>*>* edgesNeighTris;
-    StaticVector<Pixel>* edgesPointsPairs;
-    getNotOrientedEdges(&edgesNeighTris, &edgesPointsPairs);
-    StaticVector<Voxel>* trisEdges = getTrianglesEdgesIds(edgesNeighTris);
+    const MeshTopology topology(*this);
 
     // which triangles should be subdivided
     int nTrisToSubdivide = 0;
@@ -1821,13 +1775,12 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
 
     // which edges are going to be subdivided
     StaticVector<int>* edgesToSubdivide = new StaticVector<int>();
-    edgesToSubdivide->reserve(edgesNeighTris->size());
-    for(int i = 0; i < edgesNeighTris->size(); i++)
+    edgesToSubdivide->reserve(topology.getNbEdges());
+    for(int i = 0; i < topology.getNbEdges(); i++)
     {
         bool hasNeigTriToSubdivide = false;
-        for(int j = 0; j < (*edgesNeighTris)[i]->size(); j++)
+        for(const int idTri : topology.getEdgeNeighTris(i))
         {
-            int idTri = (*(*edgesNeighTris)[i])[j];
             if((*trisToSubdivide)[idTri])
             {
                 hasNeigTriToSubdivide = true;
@@ -1861,7 +1814,7 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
     {
         if((*edgesToSubdivide)[i] > -1)
         {
-            Point3d p = ((*pts)[(*edgesPointsPairs)[i].x] + (*pts)[(*edgesPointsPairs)[i].y]) / 2.0f;
+            Point3d p = ((*pts)[topology.getEdgePts(i).x] + (*pts)[topology.getEdgePts(i).y]) / 2.0f;
             pts1->push_back(p);
         }
     }
@@ -1871,8 +1824,8 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
     for(int i = 0; i < tris->size(); i++)
     {
         bool subdivide =
-            (((*edgesToSubdivide)[(*trisEdges)[i].x] > -1) || ((*edgesToSubdivide)[(*trisEdges)[i].y] > -1) ||
-             ((*edgesToSubdivide)[(*trisEdges)[i].z] > -1));
+            (((*edgesToSubdivide)[topology.getTriEdge(i, 0)] > -1) || ((*edgesToSubdivide)[topology.getTriEdge(i, 1)] > -1) ||
+             ((*edgesToSubdivide)[topology.getTriEdge(i, 2)] > -1));
         (*trisToSubdivide)[i] = subdivide;
         nTrisToSubdivide += static_cast<int>(subdivide);
     }
@@ -1891,12 +1844,11 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
         if((*trisToSubdivide)[i])
         {
             Pixel newPtsIds[3];
-            newPtsIds[0].x = (*edgesToSubdivide)[(*trisEdges)[i].x]; // new pt id
-            newPtsIds[0].y = (*trisEdges)[i].x;                      // edge id
-            newPtsIds[1].x = (*edgesToSubdivide)[(*trisEdges)[i].y];
-            newPtsIds[1].y = (*trisEdges)[i].y;
-            newPtsIds[2].x = (*edgesToSubdivide)[(*trisEdges)[i].z];
-            newPtsIds[2].y = (*trisEdges)[i].z;
+            for(int k = 0; k < 3; k++)
+            {
+                newPtsIds[k].y = topology.getTriEdge(i, k);             // edge id
+                newPtsIds[k].x = (*edgesToSubdivide)[newPtsIds[k].y]; // new pt id
+            }
 
             qsort(&newPtsIds[0], 3, sizeof(Pixel), qSortComparePixelByXDesc);
 
@@ -1913,7 +1865,7 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
 
             if(n == 1)
             {
-                subdivideMeshCase1(i, edgesPointsPairs, newPtsIds[0], tris1);
+                subdivideMeshCase1(i, topology, newPtsIds[0], tris1);
 
                 trisCamsId1->push_back((*(*trisCamsId))[i]);
                 trisCamsId1->push_back((*(*trisCamsId))[i]);
@@ -1921,8 +1873,8 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
 
             if(n == 2)
             {
-                subdivideMeshCase2(i, edgesPointsPairs, newPtsIds[0], newPtsIds[1], tris1);
-                subdivideMeshCase2(i, edgesPointsPairs, newPtsIds[1], newPtsIds[0], tris1);
+                subdivideMeshCase2(i, topology, newPtsIds[0], newPtsIds[1], tris1);
+                subdivideMeshCase2(i, topology, newPtsIds[1], newPtsIds[0], tris1);
 
                 trisCamsId1->push_back((*(*trisCamsId))[i]);
                 trisCamsId1->push_back((*(*trisCamsId))[i]);
@@ -1931,12 +1883,12 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
 
             if(n == 3)
             {
-                subdivideMeshCase3(i, edgesPointsPairs, newPtsIds[0], newPtsIds[1], newPtsIds[2], tris1);
-                subdivideMeshCase3(i, edgesPointsPairs, newPtsIds[0], newPtsIds[2], newPtsIds[1], tris1);
-                subdivideMeshCase3(i, edgesPointsPairs, newPtsIds[1], newPtsIds[0], newPtsIds[2], tris1);
-                subdivideMeshCase3(i, edgesPointsPairs, newPtsIds[1], newPtsIds[2], newPtsIds[0], tris1);
-                subdivideMeshCase3(i, edgesPointsPairs, newPtsIds[2], newPtsIds[0], newPtsIds[1], tris1);
-                subdivideMeshCase3(i, edgesPointsPairs, newPtsIds[2], newPtsIds[1], newPtsIds[0], tris1);
+                subdivideMeshCase3(i, topology, newPtsIds[0], newPtsIds[1], newPtsIds[2], tris1);
+                subdivideMeshCase3(i, topology, newPtsIds[0], newPtsIds[2], newPtsIds[1], tris1);
+                subdivideMeshCase3(i, topology, newPtsIds[1], newPtsIds[0], newPtsIds[2], tris1);
+                subdivideMeshCase3(i, topology, newPtsIds[1], newPtsIds[2], newPtsIds[0], tris1);
+                subdivideMeshCase3(i, topology, newPtsIds[2], newPtsIds[0], newPtsIds[1], tris1);
+                subdivideMeshCase3(i, topology, newPtsIds[2], newPtsIds[1], newPtsIds[0], tris1);
 
                 trisCamsId1->push_back((*(*trisCamsId))[i]);
                 trisCamsId1->push_back((*(*trisCamsId))[i]);
@@ -1959,9 +1911,6 @@ int Mesh::subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, f
     delete(*trisCamsId);
     (*trisCamsId) = trisCamsId1;
 
-    deleteArrayOfArrays<int>(&edgesNeighTris);
-    delete edgesPointsPairs;
-    delete trisEdges;
     delete trisToSubdivide;
     delete edgesToSubdivide;
 
@@ -2355,7 +2304,7 @@ bool Mesh::isTriangleObtuse(int triId)
 
 StaticVector<int>* Mesh::getLargestConnectedComponentTrisIds()
 {
-    StaticVector<StaticVector<int>*>* ptsNeighPtsOrdered = getPtsNeighPtsOrdered();
+    const MeshTopology topology(*this);
 
     StaticVector<int>* colors = new StaticVector<int>();
     colors->reserve(pts->size());
@@ -2387,13 +2336,11 @@ StaticVector<int>* Mesh::getLargestConnectedComponentTrisIds()
                 {
                     delete colors;
                     delete buff;
-                    deleteArrayOfArrays<int>(&ptsNeighPtsOrdered);
                     throw std::runtime_error("getLargestConnectedComponentTrisIds: bad condition.");
                 }
             }
-            for(int j = 0; j < sizeOfStaticVector<int>((*ptsNeighPtsOrdered)[ptid]); ++j)
+            for(const int nptid : topology.getPtNeighPts(ptid))
             {
-                int nptid = (*(*ptsNeighPtsOrdered)[ptid])[j];
                 if((nptid > -1) && ((*colors)[nptid] == -1))
                 {
                     if(buff->size() >= buff->capacity()) // should not happen but no problem
@@ -2429,7 +2376,6 @@ StaticVector<int>* Mesh::getLargestConnectedComponentTrisIds()
 
     delete colors;
     delete buff;
-    deleteArrayOfArrays<int>(&ptsNeighPtsOrdered);
 
     return out;
 }
@@ -2683,6 +2629,352 @@ bool Mesh::loadFromObjAscii(int& nmtls, StaticVector<int>& trisMtlIds, StaticVec
     return npts != 0 && ntris != 0;
 }
 
+namespace {
+
+/// values of interest of a PLY vertex record
+struct PlyVertexRecord
+{
+    /// indexes of the x, y, z, nx, ny, nz properties
+    int properties[6] = {-1, -1, -1, -1, -1, -1};
+    double values[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    void operator()(int property, int, int, double value)
+    {
+        for(int k = 0; k < 6; ++k)
+        {
+            if(property == properties[k])
+                values[k] = value;
+        }
+    }
+};
+
+/// values of interest of a PLY face record
+struct PlyFaceRecord
+{
+    static const int maxNbCorners = 64;
+
+    int vertexIndicesProperty = -1;
+    int texcoordProperty = -1;
+    int texnumberProperty = -1;
+
+    int nbCorners = 0;
+    int corners[maxNbCorners];
+    int nbUvValues = 0;
+    double uvValues[2 * maxNbCorners];
+    int texnumber = -1;
+    bool valid = true;
+
+    void clear()
+    {
+        nbCorners = 0;
+        nbUvValues = 0;
+        texnumber = -1;
+        valid = true;
+    }
+
+    bool hasUVs() const
+    {
+        return nbUvValues == 2 * nbCorners;
+    }
+
+    void operator()(int property, int i, int listSize, double value)
+    {
+        if(property == vertexIndicesProperty)
+        {
+            valid = valid && (listSize <= maxNbCorners);
+            if(valid)
+            {
+                corners[i] = static_cast<int>(value);
+                nbCorners = listSize;
+            }
+        }
+        else if(property == texcoordProperty)
+        {
+            valid = valid && (listSize <= 2 * maxNbCorners);
+            if(valid)
+            {
+                uvValues[i] = value;
+                nbUvValues = listSize;
+            }
+        }
+        else if(property == texnumberProperty)
+        {
+            texnumber = static_cast<int>(value);
+        }
+    }
+};
+
+/// ignore the values of the PLY elements which are not used
+struct PlyIgnoreRecord
+{
+    void operator()(int, int, int, double) {}
+};
+
+} // namespace
+
+bool Mesh::loadFromPly(int& nmtls, StaticVector<int>& trisMtlIds, StaticVector<Point3d>& normals,
+                       StaticVector<Voxel>& trisNormalsIds, StaticVector<Point2d>& uvCoords,
+                       StaticVector<Voxel>& trisUvIds, const std::string& plyFileName)
+{
+    ALICEVISION_LOG_INFO("Loading mesh from ply file: " << plyFileName);
+
+    std::ifstream in(plyFileName, std::ios::binary);
+    if(!in.is_open())
+        return false;
+
+    PlyHeader header;
+    if(!header.read(in))
+        throw std::runtime_error("Mesh: Invalid header while reading ply file: " + plyFileName);
+
+    const bool binary = (header.format != PlyHeader::EFormat::Ascii);
+    if(header.format == PlyHeader::EFormat::BinaryBigEndian || (binary && !isLittleEndianHost()))
+        throw std::runtime_error("Mesh: Unsupported binary format while reading ply file: " + plyFileName);
+
+    const int vertexElementId = header.findElement("vertex");
+    const int faceElementId = header.findElement("face");
+    if(vertexElementId == -1 || faceElementId == -1)
+        throw std::runtime_error("Mesh: No vertex or no face element in ply file: " + plyFileName);
+
+    PlyVertexRecord vertexRecordProto;
+    {
+        const PlyHeader::Element& element = header.elements[vertexElementId];
+        const char* names[6] = {"x", "y", "z", "nx", "ny", "nz"};
+        for(int k = 0; k < 6; ++k)
+            vertexRecordProto.properties[k] = element.findProperty({names[k]});
+        if(vertexRecordProto.properties[0] == -1 || vertexRecordProto.properties[1] == -1 || vertexRecordProto.properties[2] == -1)
+            throw std::runtime_error("Mesh: No vertex coordinates in ply file: " + plyFileName);
+    }
+    const bool withNormals = (vertexRecordProto.properties[3] != -1 && vertexRecordProto.properties[4] != -1 &&
+                              vertexRecordProto.properties[5] != -1);
+
+    PlyFaceRecord faceRecordProto;
+    {
+        const PlyHeader::Element& element = header.elements[faceElementId];
+        faceRecordProto.vertexIndicesProperty = element.findProperty({"vertex_indices", "vertex_index"});
+        faceRecordProto.texcoordProperty = element.findProperty({"texcoord"});
+        faceRecordProto.texnumberProperty = element.findProperty({"texnumber"});
+        if(faceRecordProto.vertexIndicesProperty == -1)
+            throw std::runtime_error("Mesh: No vertex indices in ply file: " + plyFileName);
+    }
+
+    // the binary data is read at once and the records are decoded in parallel when they have a constant size
+    std::vector<char> data;
+    if(binary)
+    {
+        const std::streampos dataBegin = in.tellg();
+        in.seekg(0, std::ios::end);
+        data.resize(static_cast<std::size_t>(in.tellg() - dataBegin));
+        in.seekg(dataBegin);
+        in.read(data.data(), data.size());
+        if(!in)
+            throw std::runtime_error("Mesh: Unable to read ply file: " + plyFileName);
+    }
+    const char* cursor = data.data();
+    const char* const dataEnd = data.data() + data.size();
+
+    pts = new StaticVector<Point3d>();
+    tris = new StaticVector<Mesh::triangle>();
+
+    const auto addVertex = [&](int i, const PlyVertexRecord& record)
+    {
+        (*pts)[i] = Point3d(record.values[0], record.values[1], record.values[2]);
+        if(withNormals)
+            normals[i] = Point3d(record.values[3], record.values[4], record.values[5]);
+    };
+
+    // add the triangles of a polygon with a fan triangulation
+    const auto addFace = [&](const PlyFaceRecord& record)
+    {
+        if(!record.valid)
+            throw std::runtime_error("Mesh: Unsupported face while reading ply file: " + plyFileName);
+        for(int k = 1; k + 1 < record.nbCorners; ++k)
+        {
+            const int c[3] = {0, k, k + 1};
+            triangle t(record.corners[c[0]], record.corners[c[1]], record.corners[c[2]]);
+            tris->push_back(t);
+            trisMtlIds.push_back(record.texnumber);
+            if(withNormals)
+                trisNormalsIds.push_back(Voxel(t.v[0], t.v[1], t.v[2]));
+            if(record.hasUVs())
+            {
+                Voxel uvIds;
+                for(int j = 0; j < 3; ++j)
+                {
+                    uvIds.m[j] = uvCoords.size();
+                    uvCoords.push_back(Point2d(record.uvValues[2 * c[j]], record.uvValues[2 * c[j] + 1]));
+                }
+                trisUvIds.push_back(uvIds);
+            }
+        }
+    };
+
+    for(int elementId = 0; elementId < header.elements.size(); ++elementId)
+    {
+        const PlyHeader::Element& element = header.elements[elementId];
+
+        if(elementId == vertexElementId)
+        {
+            pts->resize(element.count);
+            if(withNormals)
+                normals.resize(element.count);
+
+            bool hasList = false;
+            std::size_t recordSize = 0;
+            for(const PlyHeader::Property& property : element.properties)
+            {
+                hasList = hasList || property.isList;
+                recordSize += getPlyTypeSize(property.type);
+            }
+
+            if(binary && !hasList)
+            {
+                if(static_cast<std::size_t>(dataEnd - cursor) < element.count * recordSize)
+                    throw std::runtime_error("Mesh: Unexpected end of file while reading ply file: " + plyFileName);
+
+                #pragma omp parallel for
+                for(int i = 0; i < element.count; ++i)
+                {
+                    PlyVertexRecord record = vertexRecordProto;
+                    visitPlyBinaryRecord(cursor + i * recordSize, dataEnd, element, record);
+                    addVertex(i, record);
+                }
+                cursor += element.count * recordSize;
+                continue;
+            }
+
+            for(int i = 0; i < element.count; ++i)
+            {
+                PlyVertexRecord record = vertexRecordProto;
+                if(binary)
+                    cursor = visitPlyBinaryRecord(cursor, dataEnd, element, record);
+                if(binary ? cursor == nullptr : !visitPlyAsciiRecord(in, element, record))
+                    throw std::runtime_error("Mesh: Unexpected end of file while reading ply file: " + plyFileName);
+                addVertex(i, record);
+            }
+        }
+        else if(elementId == faceElementId)
+        {
+            tris->reserve(element.count);
+            trisMtlIds.reserve(element.count);
+
+            bool parallelDone = false;
+            if(binary && element.count > 0)
+            {
+                // the size of the first record is the size of all the records if all the faces are triangles
+                // with the same properties, else the faces are decoded sequentially
+                PlyFaceRecord firstRecord = faceRecordProto;
+                const char* firstRecordEnd = visitPlyBinaryRecord(cursor, dataEnd, element, firstRecord);
+                const std::size_t recordSize = (firstRecordEnd != nullptr) ? (firstRecordEnd - cursor) : 0;
+                const bool withUVs = firstRecord.hasUVs();
+
+                if(firstRecordEnd != nullptr && firstRecord.valid && firstRecord.nbCorners == 3 &&
+                   static_cast<std::size_t>(dataEnd - cursor) >= element.count * recordSize)
+                {
+                    tris->resize(element.count);
+                    trisMtlIds.resize(element.count);
+                    if(withNormals)
+                        trisNormalsIds.resize(element.count);
+                    if(withUVs)
+                    {
+                        trisUvIds.resize(element.count);
+                        uvCoords.resize(3 * element.count);
+                    }
+
+                    bool sameSize = true;
+                    #pragma omp parallel for reduction(&&:sameSize)
+                    for(int i = 0; i < element.count; ++i)
+                    {
+                        PlyFaceRecord record = faceRecordProto;
+                        const char* recordBegin = cursor + i * recordSize;
+                        const char* recordEnd = visitPlyBinaryRecord(recordBegin, dataEnd, element, record);
+                        if(recordEnd != recordBegin + recordSize || !record.valid || record.nbCorners != 3 ||
+                           record.hasUVs() != withUVs)
+                        {
+                            sameSize = false;
+                            continue;
+                        }
+                        const triangle t(record.corners[0], record.corners[1], record.corners[2]);
+                        (*tris)[i] = t;
+                        trisMtlIds[i] = record.texnumber;
+                        if(withNormals)
+                            trisNormalsIds[i] = Voxel(t.v[0], t.v[1], t.v[2]);
+                        if(withUVs)
+                        {
+                            trisUvIds[i] = Voxel(3 * i, 3 * i + 1, 3 * i + 2);
+                            for(int k = 0; k < 3; ++k)
+                                uvCoords[3 * i + k] = Point2d(record.uvValues[2 * k], record.uvValues[2 * k + 1]);
+                        }
+                    }
+
+                    parallelDone = sameSize;
+                    if(sameSize)
+                    {
+                        cursor += element.count * recordSize;
+                    }
+                    else
+                    {
+                        tris->resize(0);
+                        trisMtlIds.resize(0);
+                        trisNormalsIds.resize(0);
+                        trisUvIds.resize(0);
+                        uvCoords.resize(0);
+                    }
+                }
+            }
+
+            if(!parallelDone)
+            {
+                for(int i = 0; i < element.count; ++i)
+                {
+                    PlyFaceRecord record = faceRecordProto;
+                    if(binary)
+                        cursor = visitPlyBinaryRecord(cursor, dataEnd, element, record);
+                    if(binary ? cursor == nullptr : !visitPlyAsciiRecord(in, element, record))
+                        throw std::runtime_error("Mesh: Unexpected end of file while reading ply file: " + plyFileName);
+                    addFace(record);
+                }
+            }
+        }
+        else
+        {
+            // skip the other elements
+            PlyIgnoreRecord ignore;
+            for(int i = 0; i < element.count; ++i)
+            {
+                if(binary)
+                    cursor = visitPlyBinaryRecord(cursor, dataEnd, element, ignore);
+                if(binary ? cursor == nullptr : !visitPlyAsciiRecord(in, element, ignore))
+                    throw std::runtime_error("Mesh: Unexpected end of file while reading ply file: " + plyFileName);
+            }
+        }
+    }
+
+    // a texture file per material, or as many materials as the highest material id
+    nmtls = 0;
+    if(faceRecordProto.texnumberProperty != -1)
+    {
+        for(const std::string& comment : header.comments)
+        {
+            if(comment.compare(0, 11, "TextureFile") == 0)
+                ++nmtls;
+        }
+        for(int i = 0; i < trisMtlIds.size(); ++i)
+            nmtls = std::max(nmtls, trisMtlIds[i] + 1);
+    }
+
+    for(int i = 0; i < tris->size(); ++i)
+    {
+        const triangle& t = (*tris)[i];
+        if(t.v[0] < 0 || t.v[1] < 0 || t.v[2] < 0 ||
+           t.v[0] >= pts->size() || t.v[1] >= pts->size() || t.v[2] >= pts->size())
+            throw std::runtime_error("Mesh: Invalid vertex index while reading ply file: " + plyFileName);
+    }
+
+    ALICEVISION_LOG_INFO("Mesh loaded: \n\t- #points: " << pts->size() << "\n\t- # triangles: " << tris->size()
+                         << "\n\t- # uv coordinates: " << uvCoords.size() << "\n\t- # normals: " << normals.size());
+    return !pts->empty() && !tris->empty();
+}
+
 bool Mesh::getEdgeNeighTrisInterval(Pixel& itr, Pixel edge, StaticVector<Voxel>* edgesXStat,
                                        StaticVector<Voxel>* edgesXYStat)
 {
@@ -13,6 +13,8 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/Voxel.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mesh/MeshTopology.hpp>
+#include <aliceVision/mesh/meshIO.hpp>
 
 namespace aliceVision {
 namespace mesh {
@@ -110,14 +112,45 @@ public:
     Mesh();
     ~Mesh();
 
+    /// Save the mesh in the file type given by the extension of the file path (.obj or .ply)
+    void save(const std::string& filename);
+
     void saveToObj(const std::string& filename);
 
+    /**
+     * @brief Save the mesh in a PLY file, binary little-endian by default
+     */
+    void saveToPly(const std::string& filename, bool binary = true);
+
+    /**
+     * @brief Save the textured mesh in a PLY file.
+     * The vertex normals are saved in the "nx", "ny" and "nz" vertex properties,
+     * the texture coordinates of the triangles are saved in the "texcoord" face property and
+     * the material ids in the "texnumber" face property, the texture files in "TextureFile" comments.
+     * @param[in] uvCoords the texture coordinates
+     * @param[in] trisUvIds the texture coordinates ids of each triangle
+     * @param[in] trisMtlIds the material id of each triangle
+     * @param[in] textureFiles the texture file of each material
+     */
+    void saveToPly(const std::string& filename, const StaticVector<Point2d>& uvCoords,
+                   const StaticVector<Voxel>& trisUvIds, const StaticVector<int>& trisMtlIds,
+                   const std::vector<std::string>& textureFiles, bool binary = true);
+
     bool loadFromBin(std::string binFileName);
     void saveToBin(std::string binFileName);
     bool loadFromObjAscii(int& nmtls, StaticVector<int>& trisMtlIds, StaticVector<Point3d>& normals,
                           StaticVector<Voxel>& trisNormalsIds, StaticVector<Point2d>& uvCoords,
                           StaticVector<Voxel>& trisUvIds, std::string objAsciiFileName);
 
+    /**
+     * @brief Load a mesh from an ascii or binary little-endian PLY file, same outputs as loadFromObjAscii.
+     * The polygons are split in triangles. The normals are the vertex normals (nx, ny, nz), the uv coordinates
+     * are the "texcoord" of the faces and the material ids their "texnumber".
+     */
+    bool loadFromPly(int& nmtls, StaticVector<int>& trisMtlIds, StaticVector<Point3d>& normals,
+                     StaticVector<Voxel>& trisNormalsIds, StaticVector<Point2d>& uvCoords,
+                     StaticVector<Voxel>& trisUvIds, const std::string& plyFileName);
+
     void addMesh(Mesh* me);
 
     StaticVector<StaticVector<int>*>* getTrisMap(const mvsUtils::MultiViewParams* mp, int rc, int scale, int w, int h);
@@ -141,16 +174,12 @@ public:
 
     Mesh* generateMeshFromTrianglesSubset(const StaticVector<int> &visTris, StaticVector<int>** out_ptIdToNewPtId) const;
 
-    void getNotOrientedEdges(StaticVector<StaticVector<int>*>** edgesNeighTris, StaticVector<Pixel>** edgesPointsPairs);
-    StaticVector<Voxel>* getTrianglesEdgesIds(StaticVector<StaticVector<int>*>* edgesNeighTris);
-
-    StaticVector<Point3d>* getLaplacianSmoothingVectors(StaticVector<StaticVector<int>*>* ptsNeighPts,
-                                                        double maximalNeighDist = -1.0f);
+    StaticVector<Point3d>* getLaplacianSmoothingVectors(const MeshTopology& topology, double maximalNeighDist = -1.0f);
     void laplacianSmoothPts(float maximalNeighDist = -1.0f);
-    void laplacianSmoothPts(StaticVector<StaticVector<int>*>* ptsNeighPts, double maximalNeighDist = -1.0f);
+    void laplacianSmoothPts(const MeshTopology& topology, double maximalNeighDist = -1.0f);
     StaticVector<Point3d>* computeNormalsForPts();
-    StaticVector<Point3d>* computeNormalsForPts(StaticVector<StaticVector<int>*>* ptsNeighTris);
-    void smoothNormals(StaticVector<Point3d>* nms, StaticVector<StaticVector<int>*>* ptsNeighPts);
+    StaticVector<Point3d>* computeNormalsForPts(const MeshTopology& topology);
+    void smoothNormals(StaticVector<Point3d>* nms, const MeshTopology& topology);
     Point3d computeTriangleNormal(int idTri);
     Point3d computeTriangleCenterOfGravity(int idTri) const;
     double computeTriangleMaxEdgeLength(int idTri) const;
@@ -187,11 +216,11 @@ public:
                                                     StaticVector<StaticVector<int>*>* trisCams, int maxMeshPts);
     int subdivideMesh(const mvsUtils::MultiViewParams* mp, float maxTriArea, float maxEdgeLength, bool useMaxTrisAreaOrAvEdgeLength,
                       StaticVector<StaticVector<int>*>* trisCams, StaticVector<int>** trisCamsId);
-    void subdivideMeshCase1(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdEdgeId,
+    void subdivideMeshCase1(int i, const MeshTopology& topology, Pixel& neptIdEdgeId,
                             StaticVector<Mesh::triangle>* tris1);
-    void subdivideMeshCase2(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
+    void subdivideMeshCase2(int i, const MeshTopology& topology, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
                             StaticVector<Mesh::triangle>* tris1);
-    void subdivideMeshCase3(int i, StaticVector<Pixel>* edgesi, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
+    void subdivideMeshCase3(int i, const MeshTopology& topology, Pixel& neptIdEdgeId1, Pixel& neptIdEdgeId2,
                             Pixel& neptIdEdgeId3, StaticVector<Mesh::triangle>* tris1);
 
     StaticVector<StaticVector<int>*>* computeTrisCams(const mvsUtils::MultiViewParams* mp, std::string tmpDir);
@@ -7,6 +7,8 @@
 #include "MeshAnalyze.hpp"
 #include <aliceVision/mvsData/geometry.hpp>
 
+#include <stdexcept>
+
 namespace aliceVision {
 namespace mesh {
 
@@ -71,21 +73,21 @@ int MeshAnalyze::getVertexIdInTriangleForPtId(int ptId, int triId)
 
 bool MeshAnalyze::getVertexSurfaceNormal(int ptId, Point3d& N)
 {
-    StaticVector<int>* ptNeighPtsOrdered = (*ptsNeighPtsOrdered)[ptId];
-    StaticVector<int>* ptNeighTris = (*ptsNeighTrisSortedAsc)[ptId];
-    if((isIsBoundaryPt(ptId)) || (ptNeighPtsOrdered == nullptr) || (ptNeighTris == nullptr) ||
-       (ptNeighTris->size() == 0))
+    const MeshTopology& topology = getTopology();
+    const MeshTopology::Range ptNeighPtsOrdered = topology.getPtNeighPts(ptId);
+    const MeshTopology::Range ptNeighTris = topology.getPtNeighTris(ptId);
+    if((topology.isBoundaryPt(ptId)) || (ptNeighPtsOrdered.empty()) || (ptNeighTris.empty()))
     {
         return false;
     }
 
     N = Point3d();
-    for(int i = 0; i < ptNeighTris->size(); i++)
+    for(int i = 0; i < ptNeighTris.size(); i++)
     {
-        int triId = (*ptNeighTris)[i];
+        int triId = ptNeighTris[i];
         N = N + computeTriangleNormal(triId);
     }
-    N = N / (float)ptNeighTris->size();
+    N = N / (float)ptNeighTris.size();
 
     return true;
 }
@@ -93,33 +95,34 @@ bool MeshAnalyze::getVertexSurfaceNormal(int ptId, Point3d& N)
 // gts_vertex_mean_curvature_normal [Meyer et al 2002]
 bool MeshAnalyze::getVertexMeanCurvatureNormal(int ptId, Point3d& Kh)
 {
-    StaticVector<int>* ptNeighPtsOrdered = (*ptsNeighPtsOrdered)[ptId];
-    StaticVector<int>* ptNeighTris = (*ptsNeighTrisSortedAsc)[ptId];
-    if((isIsBoundaryPt(ptId)) || (ptNeighPtsOrdered == nullptr) || (ptNeighTris == nullptr))
+    const MeshTopology& topology = getTopology();
+    const MeshTopology::Range ptNeighPtsOrdered = topology.getPtNeighPts(ptId);
+    const MeshTopology::Range ptNeighTris = topology.getPtNeighTris(ptId);
+    if((topology.isBoundaryPt(ptId)) || (ptNeighPtsOrdered.empty()) || (ptNeighTris.empty()))
     {
         return false;
     }
 
     double area = 0.0;
-    for(int i = 0; i < ptNeighTris->size(); i++)
+    for(int i = 0; i < ptNeighTris.size(); i++)
     {
-        int triId = (*ptNeighTris)[i];
+        int triId = ptNeighTris[i];
         int vertexIdInTriangle = getVertexIdInTriangleForPtId(ptId, triId);
         area += getRegionArea(vertexIdInTriangle, triId);
     }
 
     Kh = Point3d(0.0f, 0.0f, 0.0f);
 
-    for(int i = 0; i < ptNeighPtsOrdered->size(); i++)
+    for(int i = 0; i < ptNeighPtsOrdered.size(); i++)
     {
         int ip1 = i + 1;
-        if(ip1 >= ptNeighPtsOrdered->size())
+        if(ip1 >= ptNeighPtsOrdered.size())
         {
             ip1 = 0;
         }
         Point3d v = (*pts)[ptId];
-        Point3d v1 = (*pts)[(*ptNeighPtsOrdered)[i]];
-        Point3d v2 = (*pts)[(*ptNeighPtsOrdered)[ip1]];
+        Point3d v1 = (*pts)[ptNeighPtsOrdered[i]];
+        Point3d v2 = (*pts)[ptNeighPtsOrdered[ip1]];
 
         float temp = getCotanOfAngle(v1, v, v2);
         Kh = Kh + (v2 - v) * temp;
@@ -153,16 +156,16 @@ void MeshAnalyze::getVertexPrincipalCurvatures(double Kh, double Kg, double& K1,
 
 bool MeshAnalyze::applyLaplacianOperator(int ptId, StaticVector<Point3d>* ptsToApplyLaplacianOp, Point3d& ln)
 {
-    StaticVector<int>* ptNeighPtsOrdered = (*ptsNeighPtsOrdered)[ptId];
-    if(ptNeighPtsOrdered == nullptr)
+    const MeshTopology::Range ptNeighPtsOrdered = getTopology().getPtNeighPts(ptId);
+    if(ptNeighPtsOrdered.empty())
     {
         return false;
     }
 
     ln = Point3d(0.0f, 0.0f, 0.0f);
-    for(int i = 0; i < ptNeighPtsOrdered->size(); i++)
+    for(int i = 0; i < ptNeighPtsOrdered.size(); i++)
     {
-        Point3d npt = (*ptsToApplyLaplacianOp)[(*ptNeighPtsOrdered)[i]];
+        Point3d npt = (*ptsToApplyLaplacianOp)[ptNeighPtsOrdered[i]];
 
         if((npt.x == 0.0f) && (npt.y == 0.0f) && (npt.z == 0.0f))
         {
@@ -171,7 +174,7 @@ bool MeshAnalyze::applyLaplacianOperator(int ptId, StaticVector<Point3d>* ptsToA
         }
         ln = ln + npt;
     }
-    ln = (ln / (float)ptNeighPtsOrdered->size()) - (*ptsToApplyLaplacianOp)[ptId];
+    ln = (ln / (float)ptNeighPtsOrdered.size()) - (*ptsToApplyLaplacianOp)[ptId];
 
     Point3d n = ln;
     float d = n.size();
@@ -207,23 +210,23 @@ bool MeshAnalyze::getBiLaplacianSmoothingVector(int ptId, StaticVector<Point3d>*
 {
     if(applyLaplacianOperator(ptId, ptsLaplacian, tp))
     {
-        StaticVector<int>* ptNeighPtsOrdered = (*ptsNeighPtsOrdered)[ptId];
-        StaticVector<int>* ptNeighTris = (*ptsNeighTrisSortedAsc)[ptId];
-        if((ptNeighPtsOrdered == nullptr) || (ptNeighTris == nullptr))
+        const MeshTopology& topology = getTopology();
+        const MeshTopology::Range ptNeighPtsOrdered = topology.getPtNeighPts(ptId);
+        if(ptNeighPtsOrdered.empty() || topology.getPtNeighTris(ptId).empty())
         {
             return false;
         }
 
         float sum = 0.0f;
-        for(int i = 0; i < sizeOfStaticVector<int>(ptNeighPtsOrdered); i++)
+        for(int i = 0; i < ptNeighPtsOrdered.size(); i++)
         {
-            int neighValence = sizeOfStaticVector<int>((*ptsNeighPtsOrdered)[(*ptNeighPtsOrdered)[i]]);
+            int neighValence = topology.getPtNeighPts(ptNeighPtsOrdered[i]).size();
             if(neighValence > 0)
             {
                 sum += 1.0f / (float)neighValence;
             }
         }
-        float v = 1.0f + (1.0f / (float)sizeOfStaticVector<int>(ptNeighPtsOrdered)) * sum;
+        float v = 1.0f + (1.0f / (float)ptNeighPtsOrdered.size()) * sum;
 
         tp = Point3d(0.0f, 0.0f, 0.0f) - tp * (1.0f / v);
 
@@ -286,5 +289,17 @@ bool MeshAnalyze::getMeanCurvAndLaplacianSmoothing(int ptId, Point3d& F, float e
     return false;
 }
 
+const MeshTopology& MeshAnalyze::getTopology() const
+{
+    if(_topology.getNbPts() != pts->size() || _topology.getNbTris() != tris->size())
+        throw std::runtime_error("MeshAnalyze: the topology is not up to date with the mesh, call updateTopology().");
+    return _topology;
+}
+
+void MeshAnalyze::updateTopology()
+{
+    _topology.build(*this);
+}
+
 } // namespace mesh
 } // namespace aliceVision
@@ -10,6 +10,7 @@
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mesh/MeshClean.hpp>
+#include <aliceVision/mesh/MeshTopology.hpp>
 
 namespace aliceVision {
 namespace mesh {
@@ -30,6 +31,18 @@ public:
     bool getBiLaplacianSmoothingVector(int ptId, StaticVector<Point3d>* ptsLaplacian, Point3d& tp);
     bool getMeanCurvAndLaplacianSmoothing(int ptId, Point3d& F, float epsilon);
     bool getVertexSurfaceNormal(int ptId, Point3d& N);
+
+    /**
+     * @brief Topology of the mesh used by the analysis
+     * @note updateTopology() must be called before, and again when the triangles change.
+     * Throws if the topology does not match the mesh.
+     */
+    const MeshTopology& getTopology() const;
+
+    void updateTopology();
+
+private:
+    MeshTopology _topology;
 };
 
 } // namespace mesh
@@ -99,6 +99,9 @@ bool MeshEnergyOpt::optimizeSmooth(float lambda, int niter, StaticVectorBool* pt
         RD.z = std::max(RD.z, (*pts)[i].z);
     }
 
+    // the connectivity does not change during the optimization
+    updateTopology();
+
     ALICEVISION_LOG_INFO("Optimizing mesh smooth: " << std::endl
                          << "\t- lamda: " << lambda << std::endl
                          << "\t- niters: " << niter << std::endl);
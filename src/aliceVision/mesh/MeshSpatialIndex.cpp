@@ -0,0 +1,416 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshSpatialIndex.hpp"
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace aliceVision {
+namespace mesh {
+
+/// maximum number of items in a leaf
+static const int leafMaxSize = 8;
+
+/// version of the file format of save()
+static const int fileVersion = 2;
+
+/// round a double to the next float toward -infinity
+static inline float floatDown(double value)
+{
+    float f = static_cast<float>(value);
+    if(f > value)
+        f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    return f;
+}
+
+/// round a double to the next float toward +infinity
+static inline float floatUp(double value)
+{
+    float f = static_cast<float>(value);
+    if(f < value)
+        f = std::nextafter(f, std::numeric_limits<float>::infinity());
+    return f;
+}
+
+/// squared distance between a point and a box, infinite for an empty box
+static inline double boxDistance2(const float* box, const Point3d& p)
+{
+    if(box[0] > box[3])
+        return std::numeric_limits<double>::infinity();
+    double dist2 = 0.0;
+    for(int k = 0; k < 3; ++k)
+    {
+        const double d = std::max(std::max(box[k] - p.m[k], p.m[k] - box[3 + k]), 0.0);
+        dist2 += d * d;
+    }
+    return dist2;
+}
+
+/**
+ * @brief Get the closest point of a triangle (see Real-Time Collision Detection, C. Ericson)
+ */
+static Point3d closestPointOnTriangle(const Point3d& p, const Point3d& a, const Point3d& b, const Point3d& c)
+{
+    const Point3d ab = b - a;
+    const Point3d ac = c - a;
+    const Point3d ap = p - a;
+    const double d1 = dot(ab, ap);
+    const double d2 = dot(ac, ap);
+    if(d1 <= 0.0 && d2 <= 0.0)
+        return a;
+
+    const Point3d bp = p - b;
+    const double d3 = dot(ab, bp);
+    const double d4 = dot(ac, bp);
+    if(d3 >= 0.0 && d4 <= d3)
+        return b;
+
+    const double vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+        return a + ab * (d1 / (d1 - d3));
+
+    const Point3d cp = p - c;
+    const double d5 = dot(ab, cp);
+    const double d6 = dot(ac, cp);
+    if(d6 >= 0.0 && d5 <= d6)
+        return c;
+
+    const double vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+        return a + ac * (d2 / (d2 - d6));
+
+    const double va = d3 * d6 - d5 * d4;
+    if(va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const double denom = 1.0 / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+template <class ItemCentroid, class ItemBox>
+void MeshSpatialIndex::buildHierarchy(Hierarchy& hierarchy, int nbItems, const ItemCentroid& itemCentroid, const ItemBox& itemBox)
+{
+    hierarchy.depth = 0;
+    while(((nbItems + (1 << hierarchy.depth) - 1) >> hierarchy.depth) > leafMaxSize)
+        ++hierarchy.depth;
+
+    // items with their centroid, to split the nodes
+    struct BuildItem
+    {
+        float centroid[3];
+        int id;
+    };
+    std::vector<BuildItem> buildItems(nbItems);
+
+    #pragma omp parallel for
+    for(int i = 0; i < nbItems; ++i)
+    {
+        const Point3d c = itemCentroid(i);
+        for(int k = 0; k < 3; ++k)
+            buildItems[i].centroid[k] = static_cast<float>(c.m[k]);
+        buildItems[i].id = i;
+    }
+
+    // the nodes of a level cover consecutive ranges of items, split each node in 2 halves
+    // along the largest extent of its centroids
+    std::vector<int> levelBounds = {0, nbItems};
+    for(int level = 0; level < hierarchy.depth; ++level)
+    {
+        const int nbLevelNodes = 1 << level;
+        std::vector<int> childrenBounds(2 * nbLevelNodes + 1);
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int n = 0; n < nbLevelNodes; ++n)
+        {
+            const int begin = levelBounds[n];
+            const int end = levelBounds[n + 1];
+            const int middle = begin + (end - begin) / 2;
+            childrenBounds[2 * n] = begin;
+            childrenBounds[2 * n + 1] = middle;
+            childrenBounds[2 * n + 2] = end;
+            if(end - begin < 2)
+                continue;
+
+            float cMin[3] = {buildItems[begin].centroid[0], buildItems[begin].centroid[1], buildItems[begin].centroid[2]};
+            float cMax[3] = {cMin[0], cMin[1], cMin[2]};
+            for(int i = begin + 1; i < end; ++i)
+            {
+                for(int k = 0; k < 3; ++k)
+                {
+                    cMin[k] = std::min(cMin[k], buildItems[i].centroid[k]);
+                    cMax[k] = std::max(cMax[k], buildItems[i].centroid[k]);
+                }
+            }
+            int axis = 0;
+            for(int k = 1; k < 3; ++k)
+            {
+                if(cMax[k] - cMin[k] > cMax[axis] - cMin[axis])
+                    axis = k;
+            }
+            std::nth_element(buildItems.begin() + begin, buildItems.begin() + middle, buildItems.begin() + end,
+                             [axis](const BuildItem& a, const BuildItem& b) { return a.centroid[axis] < b.centroid[axis]; });
+        }
+        levelBounds.swap(childrenBounds);
+    }
+
+    hierarchy.items.resize(nbItems);
+    #pragma omp parallel for
+    for(int i = 0; i < nbItems; ++i)
+        hierarchy.items[i] = buildItems[i].id;
+    std::vector<BuildItem>().swap(buildItems);
+
+    // bounding boxes of the leaves from the items, then of the parents from their children
+    hierarchy.nodesBox.resize(6 * hierarchy.getNbNodes());
+    const int firstLeaf = hierarchy.getFirstLeaf();
+
+    #pragma omp parallel for
+    for(int n = 0; n < (1 << hierarchy.depth); ++n)
+    {
+        Point3d boxMin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+        Point3d boxMax = -boxMin;
+        for(int i = levelBounds[n]; i < levelBounds[n + 1]; ++i)
+            itemBox(hierarchy.items[i], boxMin, boxMax);
+
+        float* box = &hierarchy.nodesBox[6 * (firstLeaf + n)];
+        for(int k = 0; k < 3; ++k)
+        {
+            box[k] = floatDown(boxMin.m[k]);
+            box[3 + k] = floatUp(boxMax.m[k]);
+        }
+    }
+
+    for(int level = hierarchy.depth - 1; level >= 0; --level)
+    {
+        const int firstNode = (1 << level) - 1;
+
+        #pragma omp parallel for
+        for(int n = firstNode; n < 2 * firstNode + 1; ++n)
+        {
+            const float* box1 = &hierarchy.nodesBox[6 * (2 * n + 1)];
+            const float* box2 = &hierarchy.nodesBox[6 * (2 * n + 2)];
+            float* box = &hierarchy.nodesBox[6 * n];
+            for(int k = 0; k < 3; ++k)
+            {
+                box[k] = std::min(box1[k], box2[k]);
+                box[3 + k] = std::max(box1[3 + k], box2[3 + k]);
+            }
+        }
+    }
+}
+
+template <class ItemDistance>
+int MeshSpatialIndex::getNearestItem(const Hierarchy& hierarchy, const Point3d& point, const ItemDistance& itemDistance2,
+                                     double& out_dist2)
+{
+    out_dist2 = std::numeric_limits<double>::infinity();
+    int nearestItem = -1;
+    if(hierarchy.items.empty())
+        return nearestItem;
+
+    struct Entry
+    {
+        int node;
+        int begin;
+        int end;
+        double dist2;
+    };
+    // depth-first traversal, the nearest child first, at most one pending child per level
+    Entry stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = {0, 0, static_cast<int>(hierarchy.items.size()), boxDistance2(&hierarchy.nodesBox[0], point)};
+
+    const int firstLeaf = hierarchy.getFirstLeaf();
+    while(stackSize > 0)
+    {
+        const Entry entry = stack[--stackSize];
+        if(entry.dist2 >= out_dist2)
+            continue;
+
+        if(entry.node >= firstLeaf)
+        {
+            for(int i = entry.begin; i < entry.end; ++i)
+            {
+                const int item = hierarchy.items[i];
+                const double dist2 = itemDistance2(item);
+                if(dist2 < out_dist2)
+                {
+                    out_dist2 = dist2;
+                    nearestItem = item;
+                }
+            }
+            continue;
+        }
+
+        const int middle = entry.begin + (entry.end - entry.begin) / 2;
+        Entry child1 = {2 * entry.node + 1, entry.begin, middle, 0.0};
+        Entry child2 = {2 * entry.node + 2, middle, entry.end, 0.0};
+        child1.dist2 = boxDistance2(&hierarchy.nodesBox[6 * child1.node], point);
+        child2.dist2 = boxDistance2(&hierarchy.nodesBox[6 * child2.node], point);
+        if(child1.dist2 < child2.dist2)
+            std::swap(child1, child2);
+        // push the farthest child first
+        if(child1.dist2 < out_dist2)
+            stack[stackSize++] = child1;
+        if(child2.dist2 < out_dist2)
+            stack[stackSize++] = child2;
+    }
+    return nearestItem;
+}
+
+void MeshSpatialIndex::build(const Mesh& mesh)
+{
+    ALICEVISION_LOG_DEBUG("Build mesh spatial index.");
+    _mesh = &mesh;
+    const StaticVector<Point3d>& pts = *mesh.pts;
+    const StaticVector<Mesh::triangle>& tris = *mesh.tris;
+
+    buildHierarchy(_vertices, pts.size(),
+        [&](int i) { return pts[i]; },
+        [&](int i, Point3d& boxMin, Point3d& boxMax)
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                boxMin.m[k] = std::min(boxMin.m[k], pts[i].m[k]);
+                boxMax.m[k] = std::max(boxMax.m[k], pts[i].m[k]);
+            }
+        });
+
+    buildHierarchy(_triangles, tris.size(),
+        [&](int i) { return (pts[tris[i].v[0]] + pts[tris[i].v[1]] + pts[tris[i].v[2]]) / 3.0; },
+        [&](int i, Point3d& boxMin, Point3d& boxMax)
+        {
+            for(int v = 0; v < 3; ++v)
+            {
+                const Point3d& p = pts[tris[i].v[v]];
+                for(int k = 0; k < 3; ++k)
+                {
+                    boxMin.m[k] = std::min(boxMin.m[k], p.m[k]);
+                    boxMax.m[k] = std::max(boxMax.m[k], p.m[k]);
+                }
+            }
+        });
+    ALICEVISION_LOG_DEBUG("Build mesh spatial index done.");
+}
+
+/// mix a 64-bit word in a FNV-1a like hash
+static inline void hashCombine(std::uint64_t& hash, std::uint64_t word)
+{
+    hash = (hash ^ word) * 1099511628211ULL;
+}
+
+std::uint64_t MeshSpatialIndex::computeChecksum(const Mesh& mesh)
+{
+    const StaticVector<Point3d>& pts = *mesh.pts;
+    const StaticVector<Mesh::triangle>& tris = *mesh.tris;
+
+    std::uint64_t hash = 14695981039346656037ULL;
+    for(int i = 0; i < pts.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, &pts[i].m[k], sizeof(word));
+            hashCombine(hash, word);
+        }
+    }
+    for(int i = 0; i < tris.size(); ++i)
+    {
+        hashCombine(hash, (static_cast<std::uint64_t>(static_cast<std::uint32_t>(tris[i].v[0])) << 32) |
+                           static_cast<std::uint32_t>(tris[i].v[1]));
+        hashCombine(hash, static_cast<std::uint32_t>(tris[i].v[2]));
+    }
+    return hash;
+}
+
+bool MeshSpatialIndex::saveHierarchy(FILE* file, const Hierarchy& hierarchy)
+{
+    const int nbItems = hierarchy.items.size();
+    return fwrite(&hierarchy.depth, sizeof(int), 1, file) == 1 &&
+           fwrite(&nbItems, sizeof(int), 1, file) == 1 &&
+           fwrite(hierarchy.items.data(), sizeof(int), nbItems, file) == nbItems &&
+           fwrite(hierarchy.nodesBox.data(), sizeof(float), hierarchy.nodesBox.size(), file) == hierarchy.nodesBox.size();
+}
+
+bool MeshSpatialIndex::loadHierarchy(FILE* file, Hierarchy& hierarchy, int nbMeshItems)
+{
+    int nbItems = 0;
+    if(fread(&hierarchy.depth, sizeof(int), 1, file) != 1 || fread(&nbItems, sizeof(int), 1, file) != 1 ||
+       hierarchy.depth < 0 || hierarchy.depth > 30 || nbItems != nbMeshItems)
+        return false;
+    hierarchy.items.resize(nbItems);
+    hierarchy.nodesBox.resize(6 * hierarchy.getNbNodes());
+    if(fread(hierarchy.items.data(), sizeof(int), nbItems, file) != nbItems ||
+       fread(hierarchy.nodesBox.data(), sizeof(float), hierarchy.nodesBox.size(), file) != hierarchy.nodesBox.size())
+        return false;
+
+    // the item ids are used without check by the queries
+    return std::all_of(hierarchy.items.begin(), hierarchy.items.end(), [nbMeshItems](int item) { return item >= 0 && item < nbMeshItems; });
+}
+
+bool MeshSpatialIndex::save(const std::string& filepath) const
+{
+    FILE* file = fopen(filepath.c_str(), "wb");
+    if(file == nullptr)
+        return false;
+
+    const int header[3] = {fileVersion, _mesh->pts->size(), _mesh->tris->size()};
+    const std::uint64_t checksum = computeChecksum(*_mesh);
+    const bool ok = fwrite(header, sizeof(int), 3, file) == 3 && fwrite(&checksum, sizeof(checksum), 1, file) == 1 &&
+                    saveHierarchy(file, _vertices) && saveHierarchy(file, _triangles);
+    fclose(file);
+    return ok;
+}
+
+bool MeshSpatialIndex::load(const std::string& filepath, const Mesh& mesh)
+{
+    FILE* file = fopen(filepath.c_str(), "rb");
+    if(file == nullptr)
+        return false;
+
+    int header[3];
+    std::uint64_t checksum = 0;
+    bool ok = fread(header, sizeof(int), 3, file) == 3 && header[0] == fileVersion &&
+              header[1] == mesh.pts->size() && header[2] == mesh.tris->size() &&
+              fread(&checksum, sizeof(checksum), 1, file) == 1 && checksum == computeChecksum(mesh) &&
+              loadHierarchy(file, _vertices, mesh.pts->size()) && loadHierarchy(file, _triangles, mesh.tris->size());
+    fclose(file);
+
+    _mesh = ok ? &mesh : nullptr;
+    if(!ok)
+        ALICEVISION_LOG_WARNING("Invalid mesh spatial index file: " << filepath);
+    return ok;
+}
+
+int MeshSpatialIndex::getNearestVertex(const Point3d& point) const
+{
+    const StaticVector<Point3d>& pts = *_mesh->pts;
+    double dist2;
+    return getNearestItem(_vertices, point, [&](int i) { return (pts[i] - point).size2(); }, dist2);
+}
+
+int MeshSpatialIndex::getNearestTriangle(const Point3d& point, Point3d& out_nearestPoint, double& out_dist2) const
+{
+    const StaticVector<Point3d>& pts = *_mesh->pts;
+    const StaticVector<Mesh::triangle>& tris = *_mesh->tris;
+    const int nearestTri = getNearestItem(_triangles, point, [&](int i)
+        {
+            const Point3d p = closestPointOnTriangle(point, pts[tris[i].v[0]], pts[tris[i].v[1]], pts[tris[i].v[2]]);
+            return (p - point).size2();
+        }, out_dist2);
+
+    if(nearestTri != -1)
+        out_nearestPoint = closestPointOnTriangle(point, pts[tris[nearestTri].v[0]], pts[tris[nearestTri].v[1]], pts[tris[nearestTri].v[2]]);
+    return nearestTri;
+}
+
+} // namespace mesh
+} // namespace aliceVision
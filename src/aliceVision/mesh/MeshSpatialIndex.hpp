@@ -0,0 +1,124 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+class Mesh;
+
+/**
+ * @brief Spatial index over the vertices and the triangles of a mesh, for nearest vertex and
+ * nearest triangle queries.
+ *
+ * Each set of items is stored in a balanced bounding volume hierarchy with an implicit layout:
+ * the items are permuted so that each node covers a contiguous range of items and the children of the
+ * node n are the nodes 2n+1 and 2n+2. The hierarchy is built level by level, the nodes of a level are
+ * split in parallel. The queries are const and can be done in parallel.
+ *
+ * The index only stores item ids and bounding boxes, the coordinates are read from the mesh,
+ * which must outlive the index. It can be saved and loaded to avoid building it again for the same mesh.
+ */
+class MeshSpatialIndex
+{
+public:
+    MeshSpatialIndex() = default;
+
+    explicit MeshSpatialIndex(const Mesh& mesh)
+    {
+        build(mesh);
+    }
+
+    /**
+     * @brief Build the vertices and triangles hierarchies of the given mesh
+     */
+    void build(const Mesh& mesh);
+
+    /**
+     * @brief Save the index in a binary file
+     * @return false if the file could not be written
+     */
+    bool save(const std::string& filepath) const;
+
+    /**
+     * @brief Load an index saved by save() for the given mesh
+     * @return false if the file could not be read or if it was saved for another mesh
+     * (different vertices or triangles checksum)
+     */
+    bool load(const std::string& filepath, const Mesh& mesh);
+
+    bool isBuilt() const { return _mesh != nullptr; }
+
+    const Mesh& getMesh() const { return *_mesh; }
+
+    /**
+     * @brief Get the nearest vertex of a point
+     * @return the vertex index, -1 if the mesh has no vertex
+     */
+    int getNearestVertex(const Point3d& point) const;
+
+    /**
+     * @brief Get the nearest triangle of a point
+     * @param[in] point the query point
+     * @param[out] out_nearestPoint the nearest point on the triangle
+     * @param[out] out_dist2 the squared distance to the triangle
+     * @return the triangle index, -1 if the mesh has no triangle
+     */
+    int getNearestTriangle(const Point3d& point, Point3d& out_nearestPoint, double& out_dist2) const;
+
+private:
+    /// balanced bounding volume hierarchy over items
+    struct Hierarchy
+    {
+        /// number of levels below the root, the leaves are at this level
+        int depth = 0;
+        /// item ids, the items of a node are contiguous, a node [b, e[ is split at b + (e - b) / 2
+        std::vector<int> items;
+        /// bounding box of each node (min x, y, z, max x, y, z), rounded outward to floats, empty nodes have min > max
+        std::vector<float> nodesBox;
+
+        int getNbNodes() const { return (2 << depth) - 1; }
+        int getFirstLeaf() const { return (1 << depth) - 1; }
+    };
+
+    /**
+     * @brief Build a hierarchy over items
+     * @param[in] itemCentroid function giving the centroid of an item, used to split the nodes
+     * @param[in] itemBox function extending a box (min, max) with an item
+     */
+    template <class ItemCentroid, class ItemBox>
+    static void buildHierarchy(Hierarchy& hierarchy, int nbItems, const ItemCentroid& itemCentroid, const ItemBox& itemBox);
+
+    /**
+     * @brief Get the nearest item of a point in a hierarchy
+     * @param[in] itemDistance2 function giving the squared distance between the point and an item
+     */
+    template <class ItemDistance>
+    static int getNearestItem(const Hierarchy& hierarchy, const Point3d& point, const ItemDistance& itemDistance2,
+                              double& out_dist2);
+
+    /// checksum of the vertices coordinates and of the triangles, to check that a saved index matches a mesh
+    static std::uint64_t computeChecksum(const Mesh& mesh);
+
+    static bool saveHierarchy(FILE* file, const Hierarchy& hierarchy);
+    /// load a hierarchy, the item ids must be below the number of items of the mesh
+    static bool loadHierarchy(FILE* file, Hierarchy& hierarchy, int nbMeshItems);
+
+    const Mesh* _mesh = nullptr;
+    Hierarchy _vertices;
+    Hierarchy _triangles;
+};
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,309 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshTopology.hpp"
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Exclusive prefix sum of the counts, the last element gets the total
+ */
+static void countsToOffsets(std::vector<int>& counts)
+{
+    int sum = 0;
+    for(int& c : counts)
+    {
+        const int count = c;
+        c = sum;
+        sum += count;
+    }
+}
+
+/**
+ * @brief Neighbor points of a point ordered around it, by walking from triangle to triangle.
+ * The walk starts from a boundary edge if any, so that the whole fan is walked, and it is done
+ * again from the remaining triangles for non-manifold points.
+ * @param[in,out] neighborTriangles the neighbor triangles of the point, modified
+ * @param[in] boundaryNeighPts the neighbor points on a boundary edge
+ * @param[out] out_ptNeighPts the ordered neighbor points
+ */
+static void getPtNeighPtsOrdered(const Mesh& mesh, int middlePtId, std::vector<int>& neighborTriangles,
+                                 const std::vector<int>& boundaryNeighPts, std::vector<int>& out_ptNeighPts)
+{
+    const StaticVector<Point3d>& pts = *mesh.pts;
+    const StaticVector<Mesh::triangle>& tris = *mesh.tris;
+
+    const auto isInNeighborTriangles = [&](int ptId) {
+        for(const int triId : neighborTriangles)
+        {
+            if(tris[triId].v[0] == ptId || tris[triId].v[1] == ptId || tris[triId].v[2] == ptId)
+                return true;
+        }
+        return false;
+    };
+
+    out_ptNeighPts.clear();
+    while(!neighborTriangles.empty())
+    {
+        int currentTriPtId = -1;
+        for(const int ptId : boundaryNeighPts)
+        {
+            if(std::find(out_ptNeighPts.begin(), out_ptNeighPts.end(), ptId) == out_ptNeighPts.end() &&
+               isInNeighborTriangles(ptId))
+            {
+                currentTriPtId = ptId;
+                break;
+            }
+        }
+        if(currentTriPtId == -1)
+        {
+            const Mesh::triangle& t = tris[neighborTriangles[0]];
+            currentTriPtId = (t.v[0] != middlePtId) ? t.v[0] : ((t.v[1] != middlePtId) ? t.v[1] : t.v[2]);
+        }
+        const int firstTriPtId = currentTriPtId;
+        const std::size_t fanBegin = out_ptNeighPts.size();
+        out_ptNeighPts.push_back(currentTriPtId);
+
+        bool isThereTWithCurrentTriPtId = true;
+        while(!neighborTriangles.empty() && isThereTWithCurrentTriPtId)
+        {
+            isThereTWithCurrentTriPtId = false;
+
+            // find triangle with middlePtId and currentTriPtId and get remaining point id
+            for(std::size_t n = 0; n < neighborTriangles.size(); ++n)
+            {
+                bool ok_middlePtId = false;
+                bool ok_actTriPtId = false;
+                int remainingPtId = -1;
+                for(int k = 0; k < 3; ++k)
+                {
+                    const int triPtId = tris[neighborTriangles[n]].v[k];
+                    const double length = (pts[middlePtId] - pts[triPtId]).size();
+                    if((triPtId != middlePtId) && (triPtId != currentTriPtId) && (length > 0.0) && (!std::isnan(length)))
+                        remainingPtId = triPtId;
+                    if(triPtId == middlePtId)
+                        ok_middlePtId = true;
+                    if(triPtId == currentTriPtId)
+                        ok_actTriPtId = true;
+                }
+
+                if(ok_middlePtId && ok_actTriPtId && (remainingPtId > -1))
+                {
+                    currentTriPtId = remainingPtId;
+                    neighborTriangles.erase(neighborTriangles.begin() + n);
+                    out_ptNeighPts.push_back(currentTriPtId);
+                    isThereTWithCurrentTriPtId = true; // we removed one, so we try again
+                    break;
+                }
+            }
+        }
+
+        const std::size_t fanSize = out_ptNeighPts.size() - fanBegin;
+        if(fanSize == 1)
+        {
+            // no triangle can be walked from this point (degenerated triangle)
+            neighborTriangles.erase(neighborTriangles.begin());
+        }
+        else if(currentTriPtId == firstTriPtId)
+        {
+            out_ptNeighPts.pop_back(); // remove last ... which is first
+        }
+    }
+
+    // remove duplicates
+    std::size_t nbUnique = 0;
+    for(std::size_t k = 0; k < out_ptNeighPts.size(); ++k)
+    {
+        if(out_ptNeighPts[k] != middlePtId &&
+           std::find(out_ptNeighPts.begin(), out_ptNeighPts.begin() + nbUnique, out_ptNeighPts[k]) ==
+           out_ptNeighPts.begin() + nbUnique)
+            out_ptNeighPts[nbUnique++] = out_ptNeighPts[k];
+    }
+    out_ptNeighPts.resize(nbUnique);
+}
+
+/**
+ * @brief Half-edges of the triangles of a point with the point as smallest endpoint,
+ * as pairs <other point id, half-edge>, sorted by other point id
+ */
+static void getPtHalfEdges(const StaticVector<Mesh::triangle>& tris, int ptId, const MeshTopology::Range& ptNeighTris,
+                           std::vector<std::pair<int, int>>& out_halfEdges)
+{
+    out_halfEdges.clear();
+    int previousTriId = -1;
+    for(const int triId : ptNeighTris)
+    {
+        // a degenerated triangle is several times in the list
+        if(triId == previousTriId)
+            continue;
+        previousTriId = triId;
+
+        for(int k = 0; k < 3; ++k)
+        {
+            const int a = tris[triId].v[k];
+            const int b = tris[triId].v[(k + 1) % 3];
+            if(std::min(a, b) == ptId)
+                out_halfEdges.emplace_back(std::max(a, b), MeshTopology::getHalfEdge(triId, k));
+        }
+    }
+    std::sort(out_halfEdges.begin(), out_halfEdges.end());
+}
+
+void MeshTopology::build(const Mesh& mesh)
+{
+    const StaticVector<Mesh::triangle>& tris = *mesh.tris;
+    const int nbPts = mesh.pts->size();
+    const int nbTris = tris.size();
+
+    // points neighbor triangles, filled in the triangles order so they are sorted
+    _ptsNeighTrisOffsets.assign(nbPts + 1, 0);
+    for(int i = 0; i < nbTris; ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            ++_ptsNeighTrisOffsets[tris[i].v[k]];
+    }
+    countsToOffsets(_ptsNeighTrisOffsets);
+    _ptsNeighTris.resize(3 * nbTris);
+    {
+        std::vector<int> fill(_ptsNeighTrisOffsets.begin(), _ptsNeighTrisOffsets.end() - 1);
+        for(int i = 0; i < nbTris; ++i)
+        {
+            for(int k = 0; k < 3; ++k)
+                _ptsNeighTris[fill[tris[i].v[k]]++] = i;
+        }
+    }
+
+    // edges, numbered by the smallest point id then by the other point id
+    std::vector<int> ptsNbEdges(nbPts + 1, 0);
+    std::vector<int> ptsNbHalfEdges(nbPts + 1, 0);
+    #pragma omp parallel
+    {
+        std::vector<std::pair<int, int>> halfEdges;
+        #pragma omp for
+        for(int ptId = 0; ptId < nbPts; ++ptId)
+        {
+            getPtHalfEdges(tris, ptId, getPtNeighTris(ptId), halfEdges);
+            int nbEdges = 0;
+            for(std::size_t i = 0; i < halfEdges.size(); ++i)
+                nbEdges += static_cast<int>(i == 0 || halfEdges[i].first != halfEdges[i - 1].first);
+            ptsNbEdges[ptId] = nbEdges;
+            ptsNbHalfEdges[ptId] = static_cast<int>(halfEdges.size());
+        }
+    }
+    countsToOffsets(ptsNbEdges);
+    countsToOffsets(ptsNbHalfEdges);
+
+    const int nbEdges = ptsNbEdges[nbPts];
+    _edgesPts.resize(nbEdges);
+    _edgesNeighTrisOffsets.resize(nbEdges + 1);
+    _edgesNeighTrisOffsets[nbEdges] = ptsNbHalfEdges[nbPts];
+    _edgesNeighTris.resize(ptsNbHalfEdges[nbPts]);
+    _halfEdgesEdge.assign(3 * nbTris, -1);
+    _halfEdgesOpposite.assign(3 * nbTris, -1);
+
+    #pragma omp parallel
+    {
+        std::vector<std::pair<int, int>> halfEdges;
+        #pragma omp for
+        for(int ptId = 0; ptId < nbPts; ++ptId)
+        {
+            getPtHalfEdges(tris, ptId, getPtNeighTris(ptId), halfEdges);
+            int edgeId = ptsNbEdges[ptId];
+            int pos = ptsNbHalfEdges[ptId];
+            std::size_t i0 = 0;
+            while(i0 < halfEdges.size())
+            {
+                std::size_t i1 = i0 + 1;
+                while(i1 < halfEdges.size() && halfEdges[i1].first == halfEdges[i0].first)
+                    ++i1;
+
+                _edgesPts[edgeId] = Pixel(ptId, halfEdges[i0].first);
+                _edgesNeighTrisOffsets[edgeId] = pos;
+                for(std::size_t i = i0; i < i1; ++i)
+                {
+                    const int halfEdge = halfEdges[i].second;
+                    _edgesNeighTris[pos++] = halfEdge / 3;
+                    _halfEdgesEdge[halfEdge] = edgeId;
+                }
+                // manifold edge
+                if(i1 - i0 == 2)
+                {
+                    _halfEdgesOpposite[halfEdges[i0].second] = halfEdges[i0 + 1].second;
+                    _halfEdgesOpposite[halfEdges[i0 + 1].second] = halfEdges[i0].second;
+                }
+                ++edgeId;
+                i0 = i1;
+            }
+        }
+    }
+
+    // points neighbor points ordered, each thread processes a contiguous block of points in its own buffer,
+    // then the buffers are concatenated in the order of the threads
+    std::vector<int> ptsNbNeighPts(nbPts + 1, 0);
+    std::vector<std::vector<int>> threadsNeighPts(omp_get_max_threads());
+    std::vector<int> threadsFirstPt(threadsNeighPts.size(), nbPts);
+    _ptsBoundary.assign(nbPts, 0);
+    #pragma omp parallel
+    {
+        std::vector<int>& threadNeighPts = threadsNeighPts[omp_get_thread_num()];
+        std::vector<int> neighborTriangles;
+        std::vector<int> boundaryNeighPts;
+        std::vector<int> ptNeighPts;
+        bool isFirstPt = true;
+        #pragma omp for schedule(static)
+        for(int ptId = 0; ptId < nbPts; ++ptId)
+        {
+            if(isFirstPt)
+            {
+                threadsFirstPt[omp_get_thread_num()] = ptId;
+                isFirstPt = false;
+            }
+            const Range ptNeighTris = getPtNeighTris(ptId);
+
+            boundaryNeighPts.clear();
+            for(const int triId : ptNeighTris)
+            {
+                for(int k = 0; k < 3; ++k)
+                {
+                    if(_halfEdgesOpposite[getHalfEdge(triId, k)] != -1)
+                        continue;
+                    const int a = tris[triId].v[k];
+                    const int b = tris[triId].v[(k + 1) % 3];
+                    if(a == ptId || b == ptId)
+                    {
+                        _ptsBoundary[ptId] = 1;
+                        boundaryNeighPts.push_back(a == ptId ? b : a);
+                    }
+                }
+            }
+
+            neighborTriangles.assign(ptNeighTris.begin(), ptNeighTris.end());
+            getPtNeighPtsOrdered(mesh, ptId, neighborTriangles, boundaryNeighPts, ptNeighPts);
+            threadNeighPts.insert(threadNeighPts.end(), ptNeighPts.begin(), ptNeighPts.end());
+            ptsNbNeighPts[ptId] = static_cast<int>(ptNeighPts.size());
+        }
+    }
+    countsToOffsets(ptsNbNeighPts);
+    _ptsNeighPtsOffsets.swap(ptsNbNeighPts);
+    _ptsNeighPts.resize(_ptsNeighPtsOffsets[nbPts]);
+
+    #pragma omp parallel for
+    for(int t = 0; t < static_cast<int>(threadsNeighPts.size()); ++t)
+    {
+        std::copy(threadsNeighPts[t].begin(), threadsNeighPts[t].end(),
+                  _ptsNeighPts.begin() + _ptsNeighPtsOffsets[threadsFirstPt[t]]);
+    }
+}
+
+} // namespace mesh
+} // namespace aliceVision
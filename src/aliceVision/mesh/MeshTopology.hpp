@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Pixel.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+class Mesh;
+
+/**
+ * @brief Read-only topology of a triangle mesh, stored in compressed sparse row (CSR) arrays.
+ *
+ * It gives for each point its neighbor triangles (sorted by id) and its neighbor points (ordered around
+ * the point), the list of the not oriented edges (sorted by points ids) with their neighbor triangles,
+ * and for each half-edge the opposite half-edge. The half-edge k of the triangle triId goes from
+ * v[k] to v[(k + 1) % 3] and its index is 3 * triId + k.
+ *
+ * All the arrays are allocated at once and filled in parallel, it replaces the arrays of arrays
+ * (StaticVector<StaticVector<int>*>*) for the algorithms which do not modify the mesh connectivity.
+ * The topology must be built again if the triangles of the mesh change.
+ */
+class MeshTopology
+{
+public:
+    /// contiguous range of indexes in a CSR array
+    class Range
+    {
+    public:
+        Range(const int* begin, const int* end)
+            : _begin(begin)
+            , _end(end)
+        {}
+
+        const int* begin() const { return _begin; }
+        const int* end() const { return _end; }
+        int size() const { return static_cast<int>(_end - _begin); }
+        bool empty() const { return _begin == _end; }
+        int operator[](int i) const { return _begin[i]; }
+
+    private:
+        const int* _begin;
+        const int* _end;
+    };
+
+    MeshTopology() = default;
+
+    explicit MeshTopology(const Mesh& mesh)
+    {
+        build(mesh);
+    }
+
+    /**
+     * @brief Compute the topology of the given mesh
+     */
+    void build(const Mesh& mesh);
+
+    int getNbPts() const { return static_cast<int>(_ptsNeighTrisOffsets.size()) - 1; }
+    int getNbTris() const { return static_cast<int>(_halfEdgesEdge.size()) / 3; }
+    int getNbEdges() const { return static_cast<int>(_edgesPts.size()); }
+
+    /// neighbor triangles of a point, sorted by ascending id
+    Range getPtNeighTris(int ptId) const
+    {
+        return getRange(_ptsNeighTrisOffsets, _ptsNeighTris, ptId);
+    }
+
+    /// neighbor points of a point, ordered around the point (same as Mesh::getPtsNeighPtsOrdered)
+    Range getPtNeighPts(int ptId) const
+    {
+        return getRange(_ptsNeighPtsOffsets, _ptsNeighPts, ptId);
+    }
+
+    /// true if the point is on an edge with a single neighbor triangle or on a non-manifold edge
+    bool isBoundaryPt(int ptId) const
+    {
+        return _ptsBoundary[ptId] != 0;
+    }
+
+    static int getHalfEdge(int triId, int k)
+    {
+        return 3 * triId + k;
+    }
+
+    /// not oriented edge of a half-edge
+    int getHalfEdgeEdge(int halfEdge) const
+    {
+        return _halfEdgesEdge[halfEdge];
+    }
+
+    /// index of the edge between v[k] and v[(k + 1) % 3] of the triangle
+    int getTriEdge(int triId, int k) const
+    {
+        return _halfEdgesEdge[getHalfEdge(triId, k)];
+    }
+
+    /**
+     * @brief Get the half-edge of the other triangle of the edge.
+     * The triangles may have inconsistent orientations, so it can have the same direction.
+     * @return -1 if the edge is on the boundary or non-manifold
+     */
+    int getOppositeHalfEdge(int halfEdge) const
+    {
+        return _halfEdgesOpposite[halfEdge];
+    }
+
+    /// points of the edge, x < y
+    const Pixel& getEdgePts(int edgeId) const
+    {
+        return _edgesPts[edgeId];
+    }
+
+    /// neighbor triangles of the edge, sorted by ascending id
+    Range getEdgeNeighTris(int edgeId) const
+    {
+        return getRange(_edgesNeighTrisOffsets, _edgesNeighTris, edgeId);
+    }
+
+private:
+    static Range getRange(const std::vector<int>& offsets, const std::vector<int>& values, int i)
+    {
+        const int* data = values.data();
+        return Range(data + offsets[i], data + offsets[i + 1]);
+    }
+
+    std::vector<int> _ptsNeighTrisOffsets;
+    std::vector<int> _ptsNeighTris;
+    std::vector<int> _ptsNeighPtsOffsets;
+    std::vector<int> _ptsNeighPts;
+    std::vector<char> _ptsBoundary;
+
+    std::vector<int> _halfEdgesEdge;
+    std::vector<int> _halfEdgesOpposite;
+
+    std::vector<Pixel> _edgesPts;
+    std::vector<int> _edgesNeighTrisOffsets;
+    std::vector<int> _edgesNeighTris;
+};
+
+} // namespace mesh
+} // namespace aliceVision
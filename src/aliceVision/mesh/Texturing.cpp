@@ -9,6 +9,8 @@
 #include "UVAtlas.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/mvsData/Color.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
@@ -84,15 +86,6 @@ EVisibilityRemappingMethod EVisibilityRemappingMethod_stringToEnum(const std::st
     throw std::out_of_range("Invalid unwrap method " + method);
 }
 
-
-/**
- * @brief Return whether a pixel is contained in or intersected by a 2D triangle.
- * @param[in] triangle the triangle as an array of 3 point2Ds
- * @param[in] pixel the pixel to test
- * @param[out] barycentricCoords the barycentric
- *  coordinates of this pixel relative to \p triangle
- * @return
- */
 bool isPixelInTriangle(const Point2d* triangle, const Pixel& pixel, Point2d& barycentricCoords)
 {
     // get pixel center
@@ -122,6 +115,8 @@ Point3d barycentricToCartesian(const Point3d* triangle, const Point2d& coords)
 
 void Texturing::generateUVs(mvsUtils::MultiViewParams& mp)
 {
+    ALICEVISION_PROFILE_ZONE("texturing::generateUVs");
+
     if(!me)
         throw std::runtime_error("Can't generate UVs without a mesh");
 
@@ -274,6 +269,9 @@ struct AccuColor {
 void Texturing::generateTexture(const mvsUtils::MultiViewParams& mp,
                                 size_t atlasID, mvsUtils::ImagesCache& imageCache, const bfs::path& outPath, EImageFileType textureFileType)
 {
+    ALICEVISION_PROFILE_ZONE("texturing::generateTexture");
+    ALICEVISION_MEMORY_PHASE("texturing::generateTexture");
+
     if(atlasID >= _atlases.size())
         throw std::runtime_error("Invalid atlas ID " + std::to_string(atlasID));
 
@@ -404,7 +402,11 @@ void Texturing::generateTexture(const mvsUtils::MultiViewParams& mp,
     {
         ALICEVISION_LOG_INFO(" - camera " << camId + 1 << "/" << mp.ncams << " (" << triangles.size() << " triangles)");
 
-        imageCache.refreshData(camId);
+        {
+            ALICEVISION_PROFILE_ZONE("texturing::loadImage");
+            imageCache.refreshData(camId);
+        }
+        ALICEVISION_PROFILE_ZONE("texturing::rasterize");
         #pragma omp parallel for
         for(int ti = 0; ti < triangles.size(); ++ti)
         {
@@ -561,6 +563,7 @@ void Texturing::generateTexture(const mvsUtils::MultiViewParams& mp,
     if(texParams.fillHoles)
     {
         ALICEVISION_LOG_INFO("Filling texture holes.");
+        ALICEVISION_PROFILE_ZONE("texturing::fillHoles");
         imageIO::fillHoles(texParams.textureSide, texParams.textureSide, colorBuffer, alphaBuffer);
         alphaBuffer.clear();
     }
@@ -574,6 +577,7 @@ void Texturing::generateTexture(const mvsUtils::MultiViewParams& mp,
         imageIO::resizeImage(texParams.textureSide, texParams.textureSide, texParams.downscale, colorBuffer, resizedColorBuffer);
         std::swap(resizedColorBuffer, colorBuffer);
     }
+    ALICEVISION_PROFILE_ZONE("texturing::writeTexture");
     imageIO::writeImage(texturePath.string(), outTextureSide, outTextureSide, colorBuffer);
 }
 
@@ -597,16 +601,25 @@ void Texturing::clear()
     me = nullptr;
 }
 
-void Texturing::loadFromOBJ(const std::string& filename, bool flipNormals)
+void Texturing::loadWithAtlas(const std::string& filepath, bool flipNormals)
 {
     // Clear internal data
     clear();
     me = new Mesh();
-    // Load .obj
-    if(!me->loadFromObjAscii(nmtls, trisMtlIds, normals, trisNormalsIds, uvCoords, trisUvIds,
-                             filename.c_str()))
+    // Load .obj or .ply
+    bool loaded = false;
+    switch(EMeshFileType_fromFilepath(filepath))
     {
-        throw std::runtime_error("Unable to load: " + filename);
+        case EMeshFileType::OBJ:
+            loaded = me->loadFromObjAscii(nmtls, trisMtlIds, normals, trisNormalsIds, uvCoords, trisUvIds, filepath);
+            break;
+        case EMeshFileType::PLY:
+            loaded = me->loadFromPly(nmtls, trisMtlIds, normals, trisNormalsIds, uvCoords, trisUvIds, filepath);
+            break;
+    }
+    if(!loaded)
+    {
+        throw std::runtime_error("Unable to load: " + filepath);
     }
 
     // Handle normals flipping
@@ -636,23 +649,31 @@ void Texturing::loadFromMeshing(const std::string& meshFilepath, const std::stri
         throw std::runtime_error("Error: Reference mesh and associated visibilities don't have the same size.");
 }
 
-void Texturing::replaceMesh(const std::string& otherMeshPath, bool flipNormals)
+void Texturing::replaceMesh(const std::string& otherMeshPath, bool flipNormals, const std::string& refMeshIndexPath)
 {
     // keep previous mesh/visibilities as reference
     Mesh* refMesh = me;
     PointsVisibility* refVisibilities = pointsVisibilities;
-    // set pointers to null to avoid deallocation by 'loadFromObj'
+    // set pointers to null to avoid deallocation by 'loadWithAtlas'
     me = nullptr;
     pointsVisibilities = nullptr;
-    // load input obj file
-    loadFromOBJ(otherMeshPath, flipNormals);
+    // load input mesh file
+    loadWithAtlas(otherMeshPath, flipNormals);
     // allocate pointsVisibilities for new internal mesh
     pointsVisibilities = new PointsVisibility();
     // remap visibilities from reconstruction onto input mesh
     if(texParams.visibilityRemappingMethod & EVisibilityRemappingMethod::Pull)
-        remapMeshVisibilities_pullVerticesVisibility(*refMesh, *refVisibilities, *me, *pointsVisibilities);
+    {
+        MeshSpatialIndex refMeshIndex;
+        if(refMeshIndexPath.empty() || !refMeshIndex.load(refMeshIndexPath, *refMesh))
+            refMeshIndex.build(*refMesh);
+        remapMeshVisibilities_pullVerticesVisibility(refMeshIndex, *refVisibilities, *me, *pointsVisibilities);
+    }
     if (texParams.visibilityRemappingMethod & EVisibilityRemappingMethod::Push)
-        remapMeshVisibilities_pushVerticesVisibilityToTriangles(*refMesh, *refVisibilities, *me, *pointsVisibilities);
+    {
+        const MeshSpatialIndex meshIndex(*me);
+        remapMeshVisibilities_pushVerticesVisibilityToTriangles(*refMesh, *refVisibilities, meshIndex, *pointsVisibilities);
+    }
     if(pointsVisibilities->empty())
         throw std::runtime_error("No visibility after visibility remapping.");
 
@@ -663,6 +684,9 @@ void Texturing::replaceMesh(const std::string& otherMeshPath, bool flipNormals)
 
 void Texturing::unwrap(mvsUtils::MultiViewParams& mp, EUnwrapMethod method)
 {
+    ALICEVISION_PROFILE_ZONE("texturing::unwrap");
+    ALICEVISION_MEMORY_PHASE("texturing::unwrap");
+
     if(method == mesh::EUnwrapMethod::Basic)
     {
         // generate UV coordinates based on automatic uv atlas
@@ -700,6 +724,19 @@ void Texturing::unwrap(mvsUtils::MultiViewParams& mp, EUnwrapMethod method)
     }
 }
 
+void Texturing::saveAs(const bfs::path& dir, const std::string& basename, EMeshFileType meshFileType, EImageFileType textureFileType)
+{
+    switch(meshFileType)
+    {
+        case EMeshFileType::OBJ:
+            saveAsOBJ(dir, basename, textureFileType);
+            break;
+        case EMeshFileType::PLY:
+            saveAsPLY(dir, basename, textureFileType);
+            break;
+    }
+}
+
 void Texturing::saveAsOBJ(const bfs::path& dir, const std::string& basename, EImageFileType textureFileType)
 {
     ALICEVISION_LOG_INFO("Writing obj and mtl file.");
@@ -710,6 +747,8 @@ void Texturing::saveAsOBJ(const bfs::path& dir, const std::string& basename, EIm
 
     // create .OBJ file
     FILE* fobj = fopen(objFilename.c_str(), "w");
+    if(fobj == nullptr)
+        throw std::runtime_error("Unable to create: " + objFilename);
 
     // header
     fprintf(fobj, "# \n");
@@ -719,21 +758,30 @@ void Texturing::saveAsOBJ(const bfs::path& dir, const std::string& basename, EIm
     fprintf(fobj, "mtllib %s\n\n", mtlName.c_str());
     fprintf(fobj, "g TexturedMesh\n");
 
+    // the lines are formatted in parallel by blocks
+
     // write vertices
-    auto vertices = me->pts;
-    for(int i = 0; i < vertices->size(); ++i)
-        fprintf(fobj, "v %f %f %f\n", (*vertices)[i].x, (*vertices)[i].y, (*vertices)[i].z);
+    const auto& vertices = *me->pts;
+    bool ok = writeLinesParallel(fobj, vertices.size(), [&](int i, char* line, int lineSize)
+    {
+        return snprintf(line, lineSize, "v %f %f %f\n", vertices[i].x, vertices[i].y, vertices[i].z);
+    });
 
     // write UV coordinates
-    for(int i=0; i < uvCoords.size(); ++i)
-        fprintf(fobj, "vt %f %f\n", uvCoords[i].x, uvCoords[i].y);
+    ok = ok && writeLinesParallel(fobj, uvCoords.size(), [&](int i, char* line, int lineSize)
+    {
+        return snprintf(line, lineSize, "vt %f %f\n", uvCoords[i].x, uvCoords[i].y);
+    });
 
     // write faces per texture atlas
-    for(size_t atlasID=0; atlasID < _atlases.size(); ++atlasID)
+    for(size_t atlasID=0; ok && atlasID < _atlases.size(); ++atlasID)
     {
         fprintf(fobj, "usemtl TextureAtlas_%i\n", atlasID);
-        for(const auto triangleID : _atlases[atlasID])
+        const auto& atlas = _atlases[atlasID];
+        ok = writeLinesParallel(fobj, atlas.size(), [&](int i, char* line, int lineSize)
         {
+            const int triangleID = atlas[i];
+
             // vertex IDs
             int vertexID1 = (*me->tris)[triangleID].v[0];
             int vertexID2 = (*me->tris)[triangleID].v[1];
@@ -743,10 +791,12 @@ void Texturing::saveAsOBJ(const bfs::path& dir, const std::string& basename, EIm
             int uvID2 = trisUvIds[triangleID].m[1];
             int uvID3 = trisUvIds[triangleID].m[2];
 
-            fprintf(fobj, "f %i/%i %i/%i %i/%i\n", vertexID1 + 1, uvID1 + 1, vertexID2 + 1, uvID2 + 1, vertexID3 + 1, uvID3 + 1); // indexed from 1
-        }
+            return snprintf(line, lineSize, "f %i/%i %i/%i %i/%i\n", vertexID1 + 1, uvID1 + 1, vertexID2 + 1, uvID2 + 1, vertexID3 + 1, uvID3 + 1); // indexed from 1
+        });
     }
     fclose(fobj);
+    if(!ok)
+        throw std::runtime_error("Unable to write: " + objFilename);
 
     // create .MTL material file
     FILE* fmtl = fopen(mtlFilename.c_str(), "w");
@@ -778,5 +828,28 @@ void Texturing::saveAsOBJ(const bfs::path& dir, const std::string& basename, EIm
                          << "\t- mtl file: " << mtlFilename);
 }
 
+void Texturing::saveAsPLY(const bfs::path& dir, const std::string& basename, EImageFileType textureFileType)
+{
+    ALICEVISION_LOG_INFO("Writing ply file.");
+
+    const std::string plyFilename = (dir / (basename + ".ply")).string();
+
+    // material id of each triangle from the texture atlases
+    StaticVector<int> trisAtlasIds;
+    trisAtlasIds.resize_with(me->tris->size(), 0);
+    std::vector<std::string> textureFiles;
+    for(size_t atlasID = 0; atlasID < _atlases.size(); ++atlasID)
+    {
+        for(const auto triangleID : _atlases[atlasID])
+            trisAtlasIds[triangleID] = atlasID;
+        textureFiles.push_back("texture_" + std::to_string(atlasID) + "." + EImageFileType_enumToString(textureFileType));
+    }
+
+    me->saveToPly(plyFilename, uvCoords, trisUvIds, trisAtlasIds, textureFiles);
+
+    ALICEVISION_LOG_INFO("Writing done: " << std::endl
+                         << "\t- ply file: " << plyFilename);
+}
+
 } // namespace mesh
 } // namespace aliceVision
@@ -7,12 +7,14 @@
 #pragma once
 
 #include <aliceVision/mvsData/image.hpp>
+#include <aliceVision/mvsData/Pixel.hpp>
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/Voxel.hpp>
 #include <aliceVision/mvsUtils/ImagesCache.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/meshIO.hpp>
 #include <aliceVision/mesh/meshVisibility.hpp>
 #include <aliceVision/stl/bitmask.hpp>
 
@@ -61,6 +63,22 @@ ALICEVISION_BITMASK(EVisibilityRemappingMethod);
 std::string EVisibilityRemappingMethod_enumToString(EVisibilityRemappingMethod method);
 EVisibilityRemappingMethod EVisibilityRemappingMethod_stringToEnum(const std::string& method);
 
+/**
+ * @brief Return whether a pixel is contained in or intersected by a 2D triangle.
+ * @param[in] triangle the triangle as an array of 3 point2Ds
+ * @param[in] pixel the pixel to test
+ * @param[out] barycentricCoords the barycentric
+ *  coordinates of this pixel relative to \p triangle
+ * @return true if the pixel center is at most half a pixel away from the triangle
+ */
+bool isPixelInTriangle(const Point2d* triangle, const Pixel& pixel, Point2d& barycentricCoords);
+
+/**
+ * @brief Get the cartesian coordinates of a point from its barycentric coordinates in a triangle
+ */
+Point2d barycentricToCartesian(const Point2d* triangle, const Point2d& coords);
+Point3d barycentricToCartesian(const Point3d* triangle, const Point2d& coords);
+
 
 struct TexturingParams
 {
@@ -104,8 +122,8 @@ public:
     /// Clear internal mesh data
     void clear();
 
-    /// Load a mesh from a .obj file and initialize internal structures
-    void loadFromOBJ(const std::string& filename, bool flipNormals=false);
+    /// Load a mesh from a .obj or a .ply file and initialize internal structures
+    void loadWithAtlas(const std::string& filepath, bool flipNormals=false);
 
     /**
      * @brief Load a mesh from a dense reconstruction.
@@ -121,8 +139,9 @@ public:
      *
      * @param otherMeshPath the mesh to load
      * @param flipNormals whether to flip normals when loading the mesh
+     * @param refMeshIndexPath the spatial index of the current mesh saved by MeshSpatialIndex::save, built if empty or invalid
      */
-    void replaceMesh(const std::string& otherMeshPath, bool flipNormals=false);
+    void replaceMesh(const std::string& otherMeshPath, bool flipNormals=false, const std::string& refMeshIndexPath="");
 
     /// Returns whether UV coordinates are available
     inline bool hasUVs() const { return !uvCoords.empty(); }
@@ -152,8 +171,15 @@ public:
                          size_t atlasID, mvsUtils::ImagesCache& imageCache,
                          const bfs::path &outPath, EImageFileType textureFileType = EImageFileType::PNG);
 
+    /// Save textured mesh in the given mesh file type
+    void saveAs(const bfs::path& dir, const std::string& basename, EMeshFileType meshFileType = EMeshFileType::OBJ,
+                EImageFileType textureFileType = EImageFileType::PNG);
+
     /// Save textured mesh as an OBJ + MTL file
     void saveAsOBJ(const bfs::path& dir, const std::string& basename, EImageFileType textureFileType = EImageFileType::PNG);
+
+    /// Save textured mesh as a binary PLY file, the texture files are referenced in "TextureFile" comments
+    void saveAsPLY(const bfs::path& dir, const std::string& basename, EImageFileType textureFileType = EImageFileType::PNG);
 };
 
 } // namespace mesh
@@ -0,0 +1,275 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "meshIO.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace bfs = boost::filesystem;
+
+/// number of lines or records formatted by a thread before writing
+static const int ioBlockSize = 1 << 14;
+
+EMeshFileType EMeshFileType_stringToEnum(const std::string& type)
+{
+    std::string t = type;
+    boost::to_lower(t);
+
+    if(t == "obj")
+        return EMeshFileType::OBJ;
+    if(t == "ply")
+        return EMeshFileType::PLY;
+    throw std::out_of_range("Invalid mesh file type " + type);
+}
+
+std::string EMeshFileType_enumToString(EMeshFileType type)
+{
+    switch(type)
+    {
+    case EMeshFileType::OBJ:
+        return "obj";
+    case EMeshFileType::PLY:
+        return "ply";
+    }
+    throw std::out_of_range("Unrecognized EMeshFileType");
+}
+
+EMeshFileType EMeshFileType_fromFilepath(const std::string& filepath)
+{
+    const std::string extension = bfs::path(filepath).extension().string();
+    if(extension.empty())
+        throw std::out_of_range("No mesh file type extension in " + filepath);
+    return EMeshFileType_stringToEnum(extension.substr(1));
+}
+
+/**
+ * @brief Fill blocks of items in parallel and write them in order, a batch of blocks is kept in memory
+ * @param[in] fillBlock fills the buffer with the items [begin, end[
+ */
+static bool writeBlocksParallel(FILE* file, int nbItems, const std::function<void(int, int, std::string&)>& fillBlock)
+{
+    const int nbBlocks = (nbItems + ioBlockSize - 1) / ioBlockSize;
+    const int nbBlocksPerBatch = std::max(1, 2 * omp_get_max_threads());
+    std::vector<std::string> buffers(std::min(nbBlocks, nbBlocksPerBatch));
+
+    for(int batchBegin = 0; batchBegin < nbBlocks; batchBegin += nbBlocksPerBatch)
+    {
+        const int batchEnd = std::min(nbBlocks, batchBegin + nbBlocksPerBatch);
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int b = batchBegin; b < batchEnd; ++b)
+        {
+            std::string& buffer = buffers[b - batchBegin];
+            buffer.clear();
+            fillBlock(b * ioBlockSize, std::min(nbItems, (b + 1) * ioBlockSize), buffer);
+        }
+
+        for(int b = batchBegin; b < batchEnd; ++b)
+        {
+            const std::string& buffer = buffers[b - batchBegin];
+            if(fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+                return false;
+        }
+    }
+    return true;
+}
+
+bool writeLinesParallel(FILE* file, int nbLines, const std::function<int(int, char*, int)>& formatLine)
+{
+    std::atomic<bool> formatError(false);
+
+    const bool ok = writeBlocksParallel(file, nbLines, [&](int begin, int end, std::string& buffer)
+    {
+        std::vector<char> line(MESH_IO_LINE_INITIAL_SIZE);
+        for(int i = begin; i < end; ++i)
+        {
+            int size = formatLine(i, line.data(), static_cast<int>(line.size()));
+            if(size >= static_cast<int>(line.size()))
+            {
+                // truncated line: format it again in a buffer large enough
+                line.resize(size + 1);
+                size = formatLine(i, line.data(), static_cast<int>(line.size()));
+            }
+            if(size < 0 || size >= static_cast<int>(line.size()))
+            {
+                formatError = true;
+                continue;
+            }
+            buffer.append(line.data(), size);
+        }
+    });
+    return ok && !formatError;
+}
+
+bool writeRecordsParallel(FILE* file, int nbRecords, std::size_t recordSize,
+                          const std::function<void(int, char*)>& fillRecord)
+{
+    return writeBlocksParallel(file, nbRecords, [&](int begin, int end, std::string& buffer)
+    {
+        buffer.resize((end - begin) * recordSize);
+        for(int i = begin; i < end; ++i)
+            fillRecord(i, &buffer[(i - begin) * recordSize]);
+    });
+}
+
+std::size_t getPlyTypeSize(EPlyType type)
+{
+    switch(type)
+    {
+        case EPlyType::Int8:
+        case EPlyType::UInt8:
+            return 1;
+        case EPlyType::Int16:
+        case EPlyType::UInt16:
+            return 2;
+        case EPlyType::Int32:
+        case EPlyType::UInt32:
+        case EPlyType::Float32:
+            return 4;
+        case EPlyType::Float64:
+            return 8;
+    }
+    throw std::out_of_range("Unrecognized EPlyType");
+}
+
+bool isLittleEndianHost()
+{
+    const std::uint16_t value = 1;
+    std::uint8_t firstByte;
+    std::memcpy(&firstByte, &value, 1);
+    return firstByte == 1;
+}
+
+/**
+ * @brief get the EPlyType from a PLY type name (old and new names)
+ * @return false if the name is unknown
+ */
+static bool plyTypeFromString(const std::string& name, EPlyType& type)
+{
+    if(name == "char" || name == "int8")
+        type = EPlyType::Int8;
+    else if(name == "uchar" || name == "uint8")
+        type = EPlyType::UInt8;
+    else if(name == "short" || name == "int16")
+        type = EPlyType::Int16;
+    else if(name == "ushort" || name == "uint16")
+        type = EPlyType::UInt16;
+    else if(name == "int" || name == "int32")
+        type = EPlyType::Int32;
+    else if(name == "uint" || name == "uint32")
+        type = EPlyType::UInt32;
+    else if(name == "float" || name == "float32")
+        type = EPlyType::Float32;
+    else if(name == "double" || name == "float64")
+        type = EPlyType::Float64;
+    else
+        return false;
+    return true;
+}
+
+int PlyHeader::Element::findProperty(std::initializer_list<const char*> names) const
+{
+    for(int p = 0; p < properties.size(); ++p)
+    {
+        for(const char* name : names)
+        {
+            if(properties[p].name == name)
+                return p;
+        }
+    }
+    return -1;
+}
+
+bool PlyHeader::read(std::istream& in)
+{
+    std::string line;
+    if(!std::getline(in, line) || line.compare(0, 3, "ply") != 0)
+        return false;
+
+    while(std::getline(in, line))
+    {
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        std::istringstream ss(line);
+        std::string keyword;
+        ss >> keyword;
+
+        if(keyword == "end_header")
+            return true;
+        if(keyword == "format")
+        {
+            std::string formatName;
+            ss >> formatName;
+            if(formatName == "ascii")
+                format = EFormat::Ascii;
+            else if(formatName == "binary_little_endian")
+                format = EFormat::BinaryLittleEndian;
+            else if(formatName == "binary_big_endian")
+                format = EFormat::BinaryBigEndian;
+            else
+                return false;
+        }
+        else if(keyword == "comment" || keyword == "obj_info")
+        {
+            // keep the text after the keyword
+            const std::size_t textBegin = line.find_first_not_of(" \t", line.find(keyword) + keyword.size());
+            comments.push_back(textBegin == std::string::npos ? std::string() : line.substr(textBegin));
+        }
+        else if(keyword == "element")
+        {
+            Element element;
+            if(!(ss >> element.name >> element.count) || element.count < 0)
+                return false;
+            elements.push_back(element);
+        }
+        else if(keyword == "property")
+        {
+            if(elements.empty())
+                return false;
+            Property property;
+            std::string typeName;
+            ss >> typeName;
+            if(typeName == "list")
+            {
+                std::string listSizeTypeName;
+                ss >> listSizeTypeName >> typeName;
+                property.isList = true;
+                if(!plyTypeFromString(listSizeTypeName, property.listSizeType))
+                    return false;
+            }
+            if(!plyTypeFromString(typeName, property.type) || !(ss >> property.name))
+                return false;
+            elements.back().properties.push_back(property);
+        }
+    }
+    // no end_header
+    return false;
+}
+
+int PlyHeader::findElement(const std::string& name) const
+{
+    for(int e = 0; e < elements.size(); ++e)
+    {
+        if(elements[e].name == name)
+            return e;
+    }
+    return -1;
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,223 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Mesh file types
+ */
+enum class EMeshFileType
+{
+    OBJ = 0,
+    PLY
+};
+
+/**
+ * @brief returns the EMeshFileType enum from a string.
+ * @param[in] type the input string.
+ * @return the associated EMeshFileType enum.
+ */
+EMeshFileType EMeshFileType_stringToEnum(const std::string& type);
+
+/**
+ * @brief converts an EMeshFileType enum to a string (the file extension without the dot).
+ * @param[in] type the EMeshFileType enum to convert.
+ * @return the string associated to the EMeshFileType enum.
+ */
+std::string EMeshFileType_enumToString(EMeshFileType type);
+
+/**
+ * @brief returns the EMeshFileType enum from the extension of a file path.
+ * @param[in] filepath the mesh file path.
+ * @return the associated EMeshFileType enum.
+ */
+EMeshFileType EMeshFileType_fromFilepath(const std::string& filepath);
+
+/// initial size of the line buffer of writeLinesParallel, it grows for longer lines
+const int MESH_IO_LINE_INITIAL_SIZE = 256;
+
+/**
+ * @brief Write text lines formatted in parallel.
+ * The lines are formatted by blocks in parallel and the blocks are written in order,
+ * so the file is the same as with a sequential formatting.
+ * @param[in] file the file to write in
+ * @param[in] nbLines the number of lines
+ * @param[in] formatLine the function writing the line i in a buffer of the given size,
+ *            it returns the size of the whole line even if it does not fit (as snprintf),
+ *            the line is then formatted again in a larger buffer
+ * @return false if the file could not be written or a line could not be formatted
+ */
+bool writeLinesParallel(FILE* file, int nbLines, const std::function<int(int, char*, int)>& formatLine);
+
+/**
+ * @brief Write fixed-size binary records filled in parallel.
+ * The records are filled by blocks in parallel and the blocks are written in order.
+ * @param[in] file the file to write in
+ * @param[in] nbRecords the number of records
+ * @param[in] recordSize the size of a record in bytes
+ * @param[in] fillRecord the function filling the record i in a buffer of recordSize bytes
+ * @return false if the file could not be written
+ */
+bool writeRecordsParallel(FILE* file, int nbRecords, std::size_t recordSize,
+                          const std::function<void(int, char*)>& fillRecord);
+
+/**
+ * @brief PLY property value types
+ */
+enum class EPlyType
+{
+    Int8 = 0,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64
+};
+
+/// size of a value in a binary PLY file
+std::size_t getPlyTypeSize(EPlyType type);
+
+/// value of a little-endian binary PLY value
+inline double readPlyValue(const char* data, EPlyType type)
+{
+    switch(type)
+    {
+        case EPlyType::Int8:    { std::int8_t v;   std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::UInt8:   { std::uint8_t v;  std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Int16:   { std::int16_t v;  std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::UInt16:  { std::uint16_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Int32:   { std::int32_t v;  std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::UInt32:  { std::uint32_t v; std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Float32: { float v;         std::memcpy(&v, data, sizeof(v)); return v; }
+        case EPlyType::Float64: { double v;        std::memcpy(&v, data, sizeof(v)); return v; }
+    }
+    return 0.0;
+}
+
+/// is the host little-endian, the binary PLY files are read and written without byte swapping
+bool isLittleEndianHost();
+
+/**
+ * @brief Header of a PLY file
+ */
+struct PlyHeader
+{
+    enum class EFormat
+    {
+        Ascii = 0,
+        BinaryLittleEndian,
+        BinaryBigEndian
+    };
+
+    struct Property
+    {
+        std::string name;
+        EPlyType type = EPlyType::Float32;
+        bool isList = false;
+        /// type of the number of values of a list property
+        EPlyType listSizeType = EPlyType::UInt8;
+    };
+
+    struct Element
+    {
+        std::string name;
+        int count = 0;
+        std::vector<Property> properties;
+
+        /// index of the property with one of the given names, -1 if not found
+        int findProperty(std::initializer_list<const char*> names) const;
+    };
+
+    EFormat format = EFormat::Ascii;
+    std::vector<std::string> comments;
+    std::vector<Element> elements;
+
+    /**
+     * @brief Read the header, the stream is left at the beginning of the data
+     * @return false if the stream is not a valid PLY file
+     */
+    bool read(std::istream& in);
+
+    /// index of the element with the given name, -1 if not found
+    int findElement(const std::string& name) const;
+};
+
+/**
+ * @brief Visit the values of a record of a binary little-endian PLY element.
+ * @param[in] data the beginning of the record
+ * @param[in] dataEnd the end of the data
+ * @param[in] element the element description
+ * @param[in] visitor called for each value with (property index, index in the list, list size, value),
+ *            the index in the list is 0 and the list size is 1 for a scalar property
+ * @return the end of the record, nullptr if the record goes beyond the end of the data
+ */
+template <class Visitor>
+const char* visitPlyBinaryRecord(const char* data, const char* dataEnd, const PlyHeader::Element& element, Visitor& visitor)
+{
+    for(int p = 0; p < element.properties.size(); ++p)
+    {
+        const PlyHeader::Property& property = element.properties[p];
+        const std::size_t typeSize = getPlyTypeSize(property.type);
+        int listSize = 1;
+        if(property.isList)
+        {
+            const std::size_t listSizeTypeSize = getPlyTypeSize(property.listSizeType);
+            if(static_cast<std::size_t>(dataEnd - data) < listSizeTypeSize)
+                return nullptr;
+            listSize = static_cast<int>(readPlyValue(data, property.listSizeType));
+            data += listSizeTypeSize;
+        }
+        if(listSize < 0 || static_cast<std::size_t>(dataEnd - data) < listSize * typeSize)
+            return nullptr;
+        for(int i = 0; i < listSize; ++i)
+        {
+            visitor(p, i, listSize, readPlyValue(data, property.type));
+            data += typeSize;
+        }
+    }
+    return data;
+}
+
+/**
+ * @brief Visit the values of a record of an ascii PLY element, same as visitPlyBinaryRecord.
+ * @return false if the record could not be read
+ */
+template <class Visitor>
+bool visitPlyAsciiRecord(std::istream& in, const PlyHeader::Element& element, Visitor& visitor)
+{
+    for(int p = 0; p < element.properties.size(); ++p)
+    {
+        int listSize = 1;
+        if(element.properties[p].isList && !(in >> listSize))
+            return false;
+        for(int i = 0; i < listSize; ++i)
+        {
+            double value;
+            if(!(in >> value))
+                return false;
+            visitor(p, i, listSize, value);
+        }
+    }
+    return true;
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,283 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/meshIO.hpp>
+#include <aliceVision/mesh/meshTestGenerator.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshIO
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace bfs = boost::filesystem;
+
+/**
+ * @brief Fill a wavy grid far from the origin, to check the precision of the written coordinates
+ */
+void createWavyGridMesh(Mesh& mesh, int size)
+{
+  createGridMesh(mesh, size, 0.1, [](int x, int y) { return std::sin(x * 0.3) * std::cos(y * 0.7) + 1000.0; });
+}
+
+std::string tmpFilepath(const std::string& extension)
+{
+  return (bfs::temp_directory_path() / bfs::unique_path()).string() + extension;
+}
+
+void checkSameTriangles(const Mesh& mesh, const Mesh& loaded)
+{
+  BOOST_REQUIRE_EQUAL(mesh.tris->size(), loaded.tris->size());
+  for(int i = 0; i < mesh.tris->size(); ++i)
+    for(int k = 0; k < 3; ++k)
+      BOOST_CHECK_EQUAL((*mesh.tris)[i].v[k], (*loaded.tris)[i].v[k]);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Save a mesh in binary and ascii PLY files and load it
+// - Assert that the points and the triangles are the same
+//-----------------
+BOOST_AUTO_TEST_CASE(meshIO_plyRoundTrip)
+{
+  Mesh mesh;
+  createWavyGridMesh(mesh, 200);
+
+  for(const bool binary : {true, false})
+  {
+    const std::string filepath = tmpFilepath(".ply");
+    mesh.saveToPly(filepath, binary);
+
+    Mesh loaded;
+    int nmtls = -1;
+    StaticVector<int> trisMtlIds;
+    StaticVector<Point3d> normals;
+    StaticVector<Voxel> trisNormalsIds;
+    StaticVector<Point2d> uvCoords;
+    StaticVector<Voxel> trisUvIds;
+    BOOST_CHECK(loaded.loadFromPly(nmtls, trisMtlIds, normals, trisNormalsIds, uvCoords, trisUvIds, filepath));
+    bfs::remove(filepath);
+
+    BOOST_CHECK_EQUAL(nmtls, 0);
+    BOOST_CHECK(uvCoords.empty());
+    BOOST_CHECK(normals.empty());
+    BOOST_CHECK_EQUAL(trisMtlIds.size(), mesh.tris->size());
+
+    BOOST_REQUIRE_EQUAL(mesh.pts->size(), loaded.pts->size());
+    for(int i = 0; i < mesh.pts->size(); ++i)
+    {
+      // double values are saved without loss
+      BOOST_CHECK_EQUAL((*mesh.pts)[i].x, (*loaded.pts)[i].x);
+      BOOST_CHECK_EQUAL((*mesh.pts)[i].y, (*loaded.pts)[i].y);
+      BOOST_CHECK_EQUAL((*mesh.pts)[i].z, (*loaded.pts)[i].z);
+    }
+    checkSameTriangles(mesh, loaded);
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Save a mesh with texture coordinates and materials in a PLY file and load it
+// - Assert that the texture coordinates and the materials of the triangles are the same
+// - Assert that the vertex normals are saved
+//-----------------
+BOOST_AUTO_TEST_CASE(meshIO_texturedPlyRoundTrip)
+{
+  Mesh mesh;
+  createWavyGridMesh(mesh, 50);
+
+  // shared uv coordinates, 2 materials
+  StaticVector<Point2d> uvCoords;
+  for(int i = 0; i < mesh.pts->size(); ++i)
+    uvCoords.push_back(Point2d((*mesh.pts)[i].x / 5.0, (*mesh.pts)[i].y / 5.0));
+  StaticVector<Voxel> trisUvIds;
+  StaticVector<int> trisMtlIds;
+  for(int i = 0; i < mesh.tris->size(); ++i)
+  {
+    const Mesh::triangle& t = (*mesh.tris)[i];
+    trisUvIds.push_back(Voxel(t.v[0], t.v[1], t.v[2]));
+    trisMtlIds.push_back(i % 2);
+  }
+
+  for(const bool binary : {true, false})
+  {
+    const std::string filepath = tmpFilepath(".ply");
+    mesh.saveToPly(filepath, uvCoords, trisUvIds, trisMtlIds, {"texture_0.png", "texture_1.png"}, binary);
+
+    Mesh loaded;
+    int nmtls = 0;
+    StaticVector<int> loadedTrisMtlIds;
+    StaticVector<Point3d> normals;
+    StaticVector<Voxel> trisNormalsIds;
+    StaticVector<Point2d> loadedUvCoords;
+    StaticVector<Voxel> loadedTrisUvIds;
+    BOOST_CHECK(loaded.loadFromPly(nmtls, loadedTrisMtlIds, normals, trisNormalsIds, loadedUvCoords, loadedTrisUvIds, filepath));
+    bfs::remove(filepath);
+
+    BOOST_CHECK_EQUAL(nmtls, 2);
+    checkSameTriangles(mesh, loaded);
+    BOOST_REQUIRE_EQUAL(normals.size(), mesh.pts->size());
+    for(int i = 0; i < normals.size(); ++i)
+      BOOST_CHECK_SMALL(normals[i].size() - 1.0, 1e-6);
+    BOOST_REQUIRE_EQUAL(loadedTrisUvIds.size(), mesh.tris->size());
+    BOOST_REQUIRE_EQUAL(loadedTrisMtlIds.size(), mesh.tris->size());
+
+    for(int i = 0; i < mesh.tris->size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(loadedTrisMtlIds[i], trisMtlIds[i]);
+      for(int k = 0; k < 3; ++k)
+      {
+        // uv coordinates are saved as floats
+        const Point2d& uv = uvCoords[trisUvIds[i].m[k]];
+        const Point2d& loadedUv = loadedUvCoords[loadedTrisUvIds[i].m[k]];
+        BOOST_CHECK_SMALL(uv.x - loadedUv.x, 1e-6);
+        BOOST_CHECK_SMALL(uv.y - loadedUv.y, 1e-6);
+      }
+    }
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Write lines longer than the initial line buffer with writeLinesParallel
+// - Assert that the lines are not truncated
+//-----------------
+BOOST_AUTO_TEST_CASE(meshIO_writeLinesParallel_longLines)
+{
+  const std::string filepath = tmpFilepath(".txt");
+  const int nbLines = 100;
+  const auto lineContent = [](int i) { return std::string(MESH_IO_LINE_INITIAL_SIZE + 10 * i, 'a' + i % 26); };
+
+  FILE* f = fopen(filepath.c_str(), "w");
+  BOOST_REQUIRE(f != nullptr);
+  const bool ok = writeLinesParallel(f, nbLines, [&](int i, char* line, int lineSize)
+  {
+    return snprintf(line, lineSize, "%s\n", lineContent(i).c_str());
+  });
+  fclose(f);
+  BOOST_CHECK(ok);
+
+  std::ifstream file(filepath);
+  std::string line;
+  int nbRead = 0;
+  while(std::getline(file, line))
+  {
+    BOOST_CHECK_EQUAL(line, lineContent(nbRead));
+    ++nbRead;
+  }
+  file.close();
+  bfs::remove(filepath);
+  BOOST_CHECK_EQUAL(nbRead, nbLines);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Load an ascii PLY file with vertex normals, an unused element and a quad
+// - Assert that the quad is split in 2 triangles and that the normals are the vertex normals
+//-----------------
+BOOST_AUTO_TEST_CASE(meshIO_plyPolygons)
+{
+  const std::string filepath = tmpFilepath(".ply");
+  {
+    std::ofstream out(filepath);
+    out << "ply\n"
+           "format ascii 1.0\n"
+           "comment quad and triangle\n"
+           "element vertex 5\n"
+           "property float x\n"
+           "property float y\n"
+           "property float z\n"
+           "property float nx\n"
+           "property float ny\n"
+           "property float nz\n"
+           "property uchar red\n"
+           "element edge 1\n"
+           "property int vertex1\n"
+           "property int vertex2\n"
+           "element face 2\n"
+           "property list uchar uint vertex_index\n"
+           "end_header\n"
+           "0 0 0 0 0 1 255\n"
+           "1 0 0 0 0 1 255\n"
+           "1 1 0 0 0 1 255\n"
+           "0 1 0 0 0 1 255\n"
+           "2 2 0 0 1 0 255\n"
+           "0 1\n"
+           "4 0 1 2 3\n"
+           "3 2 1 4\n";
+  }
+
+  Mesh loaded;
+  int nmtls = -1;
+  StaticVector<int> trisMtlIds;
+  StaticVector<Point3d> normals;
+  StaticVector<Voxel> trisNormalsIds;
+  StaticVector<Point2d> uvCoords;
+  StaticVector<Voxel> trisUvIds;
+  BOOST_CHECK(loaded.loadFromPly(nmtls, trisMtlIds, normals, trisNormalsIds, uvCoords, trisUvIds, filepath));
+  bfs::remove(filepath);
+
+  BOOST_CHECK_EQUAL(loaded.pts->size(), 5);
+  BOOST_REQUIRE_EQUAL(loaded.tris->size(), 3);
+  const int expectedTris[3][3] = {{0, 1, 2}, {0, 2, 3}, {2, 1, 4}};
+  for(int i = 0; i < 3; ++i)
+    for(int k = 0; k < 3; ++k)
+      BOOST_CHECK_EQUAL((*loaded.tris)[i].v[k], expectedTris[i][k]);
+
+  BOOST_REQUIRE_EQUAL(normals.size(), 5);
+  BOOST_REQUIRE_EQUAL(trisNormalsIds.size(), 3);
+  BOOST_CHECK_EQUAL(normals[4].y, 1.0);
+  BOOST_CHECK_EQUAL(trisNormalsIds[2].z, 4);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Save a mesh in an OBJ file formatted in parallel and load it
+// - Assert that the points and the triangles are the same
+//-----------------
+BOOST_AUTO_TEST_CASE(meshIO_objRoundTrip)
+{
+  Mesh mesh;
+  createWavyGridMesh(mesh, 200);
+
+  const std::string filepath = tmpFilepath(".obj");
+  BOOST_CHECK(EMeshFileType_fromFilepath(filepath) == EMeshFileType::OBJ);
+  mesh.save(filepath);
+
+  Mesh loaded;
+  int nmtls = -1;
+  StaticVector<int> trisMtlIds;
+  StaticVector<Point3d> normals;
+  StaticVector<Voxel> trisNormalsIds;
+  StaticVector<Point2d> uvCoords;
+  StaticVector<Voxel> trisUvIds;
+  BOOST_CHECK(loaded.loadFromObjAscii(nmtls, trisMtlIds, normals, trisNormalsIds, uvCoords, trisUvIds, filepath));
+  bfs::remove(filepath);
+
+  BOOST_REQUIRE_EQUAL(mesh.pts->size(), loaded.pts->size());
+  for(int i = 0; i < mesh.pts->size(); ++i)
+  {
+    // %f precision
+    BOOST_CHECK_SMALL((*mesh.pts)[i].x - (*loaded.pts)[i].x, 1e-6);
+    BOOST_CHECK_SMALL((*mesh.pts)[i].y - (*loaded.pts)[i].y, 1e-6);
+    BOOST_CHECK_SMALL((*mesh.pts)[i].z - (*loaded.pts)[i].z, 1e-6);
+  }
+  checkSameTriangles(mesh, loaded);
+}
@@ -0,0 +1,172 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshSpatialIndex.hpp>
+#include <aliceVision/mesh/meshTestGenerator.hpp>
+#include <aliceVision/mesh/meshVisibility.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+
+#define BOOST_TEST_MODULE meshSpatialIndex
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace bfs = boost::filesystem;
+
+/**
+ * @brief Fill a wavy grid of size x size points
+ */
+void createWavyGridMesh(Mesh& mesh, int size, double step)
+{
+  createGridMesh(mesh, size, step, [step](int x, int y) { return 0.3 * std::sin(x * step) * std::cos(y * step); });
+}
+
+/// squared distance to a triangle, sampled on a fine barycentric grid
+double sampledTriangleDistance2(const Mesh& mesh, int triId, const Point3d& p)
+{
+  const Mesh::triangle& t = (*mesh.tris)[triId];
+  const Point3d& a = (*mesh.pts)[t.v[0]];
+  const Point3d& b = (*mesh.pts)[t.v[1]];
+  const Point3d& c = (*mesh.pts)[t.v[2]];
+  const int n = 50;
+  double best = std::numeric_limits<double>::max();
+  for(int i = 0; i <= n; ++i)
+    for(int j = 0; i + j <= n; ++j)
+      best = std::min(best, (a + (b - a) * (i / double(n)) + (c - a) * (j / double(n)) - p).size2());
+  return best;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Build the spatial index of a grid mesh
+// - Assert that the nearest vertices and triangles of random points are the same as with a brute force search
+// - Save and load the index and assert that the results are the same
+// - Assert that the saved index is rejected for other meshes, even with the same size
+//-----------------
+BOOST_AUTO_TEST_CASE(meshSpatialIndex_nearest)
+{
+  Mesh mesh;
+  createWavyGridMesh(mesh, 40, 0.1);
+  MeshSpatialIndex index(mesh);
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-0.5, 4.4);
+
+  const std::string filepath = (bfs::temp_directory_path() / bfs::unique_path()).string() + ".bin";
+  BOOST_REQUIRE(index.save(filepath));
+  MeshSpatialIndex loadedIndex;
+  BOOST_REQUIRE(loadedIndex.load(filepath, mesh));
+  bfs::remove(filepath);
+
+  for(int q = 0; q < 500; ++q)
+  {
+    const Point3d p(distribution(generator), distribution(generator), distribution(generator) * 0.2);
+
+    double bestVertexDist2 = std::numeric_limits<double>::max();
+    for(int i = 0; i < mesh.pts->size(); ++i)
+      bestVertexDist2 = std::min(bestVertexDist2, ((*mesh.pts)[i] - p).size2());
+
+    const int nearestVertex = index.getNearestVertex(p);
+    BOOST_REQUIRE_NE(nearestVertex, -1);
+    BOOST_CHECK_EQUAL(((*mesh.pts)[nearestVertex] - p).size2(), bestVertexDist2);
+    BOOST_CHECK_EQUAL(loadedIndex.getNearestVertex(p), nearestVertex);
+
+    Point3d nearestPoint;
+    double dist2 = -1.0;
+    const int nearestTri = index.getNearestTriangle(p, nearestPoint, dist2);
+    BOOST_REQUIRE_NE(nearestTri, -1);
+    BOOST_CHECK_SMALL((nearestPoint - p).size2() - dist2, 1e-12);
+
+    // the exact distance is at most the sampled distance of any triangle
+    double bestSampledDist2 = std::numeric_limits<double>::max();
+    for(int i = 0; i < mesh.tris->size(); ++i)
+      bestSampledDist2 = std::min(bestSampledDist2, sampledTriangleDistance2(mesh, i, p));
+    BOOST_CHECK_LE(dist2, bestSampledDist2 + 1e-12);
+    BOOST_CHECK_GE(dist2, 0.0);
+    BOOST_CHECK_LE(std::sqrt(bestSampledDist2) - std::sqrt(dist2), 0.01);
+
+    Point3d loadedNearestPoint;
+    double loadedDist2;
+    BOOST_CHECK_EQUAL(loadedIndex.getNearestTriangle(p, loadedNearestPoint, loadedDist2), nearestTri);
+  }
+
+  // the index does not match another mesh
+  Mesh otherMesh;
+  createWavyGridMesh(otherMesh, 10, 0.1);
+  BOOST_REQUIRE(index.save(filepath));
+  BOOST_CHECK(!loadedIndex.load(filepath, otherMesh));
+  BOOST_CHECK(!loadedIndex.isBuilt());
+
+  // nor another mesh with the same number of vertices and triangles
+  Mesh sameSizeMesh;
+  createWavyGridMesh(sameSizeMesh, 40, 0.1);
+  (*sameSizeMesh.pts)[123].z += 0.01;
+  BOOST_CHECK(!loadedIndex.load(filepath, sameSizeMesh));
+  bfs::remove(filepath);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a fine grid mesh with a visibility per vertex and a coarse grid mesh on the same surface
+// - Remap the visibilities with the pull and the push methods
+// - Assert that the pulled visibility is the one of the nearest vertex and
+//   that the pushed visibilities contain the cameras of the reference vertices
+//-----------------
+BOOST_AUTO_TEST_CASE(meshSpatialIndex_remapVisibilities)
+{
+  Mesh refMesh;
+  createWavyGridMesh(refMesh, 41, 0.05);
+  Mesh mesh;
+  createWavyGridMesh(mesh, 11, 0.2);
+
+  // the camera of a reference vertex depends on its quadrant
+  PointsVisibility refPtsVisibilities;
+  for(int i = 0; i < refMesh.pts->size(); ++i)
+  {
+    const Point3d& p = (*refMesh.pts)[i];
+    PointVisibility* visibility = new PointVisibility();
+    visibility->push_back((p.x < 1.0 ? 0 : 1) + (p.y < 1.0 ? 0 : 2));
+    refPtsVisibilities.push_back(visibility);
+  }
+
+  PointsVisibility pulled;
+  remapMeshVisibilities_pullVerticesVisibility(refMesh, refPtsVisibilities, mesh, pulled);
+  BOOST_REQUIRE_EQUAL(pulled.size(), mesh.pts->size());
+  for(int i = 0; i < mesh.pts->size(); ++i)
+  {
+    // the vertices of the coarse grid are vertices of the fine grid
+    const int x = i % 11;
+    const int y = i / 11;
+    const int refVertex = 4 * y * 41 + 4 * x;
+    BOOST_REQUIRE_EQUAL(pulled[i]->size(), 1);
+    BOOST_CHECK_EQUAL((*pulled[i])[0], (*refPtsVisibilities[refVertex])[0]);
+  }
+
+  PointsVisibility pushed;
+  remapMeshVisibilities_pushVerticesVisibilityToTriangles(refMesh, refPtsVisibilities, mesh, pushed);
+  BOOST_REQUIRE_EQUAL(pushed.size(), mesh.pts->size());
+  for(int i = 0; i < mesh.pts->size(); ++i)
+  {
+    BOOST_CHECK(!pushed[i]->empty());
+    // the pulled camera is pushed by the reference vertex at the same position
+    BOOST_CHECK_NE(pushed[i]->indexOf((*pulled[i])[0]), -1);
+  }
+
+  for(PointsVisibility* visibilities : {&refPtsVisibilities, &pulled, &pushed})
+    for(int i = 0; i < visibilities->size(); ++i)
+      delete (*visibilities)[i];
+}
@@ -0,0 +1,55 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Fill a grid of size x size points, each cell is split in 2 triangles.
+ * The point (x, y) of the grid is at (x * step, y * step, height(x, y)).
+ *
+ * @param[out] mesh The mesh
+ * @param[in] size The number of points on each side of the grid
+ * @param[in] step The distance between two neighbor points of the grid
+ * @param[in] height The function giving the height of a grid point from its grid coordinates
+ */
+template <class HeightFunction>
+void createGridMesh(Mesh& mesh, int size, double step, const HeightFunction& height)
+{
+  mesh.pts = new StaticVector<Point3d>();
+  mesh.tris = new StaticVector<Mesh::triangle>();
+  mesh.pts->reserve(size * size);
+  mesh.tris->reserve(2 * (size - 1) * (size - 1));
+
+  for(int y = 0; y < size; ++y)
+    for(int x = 0; x < size; ++x)
+      mesh.pts->push_back(Point3d(x * step, y * step, height(x, y)));
+
+  for(int y = 0; y < size - 1; ++y)
+  {
+    for(int x = 0; x < size - 1; ++x)
+    {
+      const int a = y * size + x;
+      mesh.tris->push_back(Mesh::triangle(a, a + 1, a + size + 1));
+      mesh.tris->push_back(Mesh::triangle(a, a + size + 1, a + size));
+    }
+  }
+}
+
+/**
+ * @brief Fill a planar grid of size x size points with a unit step, each cell is split in 2 triangles
+ */
+inline void createGridMesh(Mesh& mesh, int size)
+{
+  createGridMesh(mesh, size, 1.0, [](int, int) { return 0.0; });
+}
+
+} // namespace mesh
+} // namespace aliceVision
@@ -0,0 +1,233 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshTopology.hpp>
+#include <aliceVision/mesh/meshTestGenerator.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE meshTopology
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+bool shareEdge(const MeshTopology& topology, int ptId1, int ptId2)
+{
+  for(const int ptId : topology.getPtNeighPts(ptId1))
+    if(ptId == ptId2)
+      return true;
+  return false;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a grid mesh and compute its topology
+// - Assert the number of edges, the edges neighbor triangles, the boundary points and the opposite half-edges
+// - Assert that the neighbor points are ordered around the point
+//-----------------
+BOOST_AUTO_TEST_CASE(meshTopology_grid)
+{
+  const int size = 6;
+  Mesh mesh;
+  createGridMesh(mesh, size);
+  const MeshTopology topology(mesh);
+
+  BOOST_CHECK_EQUAL(topology.getNbPts(), size * size);
+  BOOST_CHECK_EQUAL(topology.getNbTris(), 2 * (size - 1) * (size - 1));
+  // horizontal, vertical and diagonal edges
+  BOOST_CHECK_EQUAL(topology.getNbEdges(), 2 * size * (size - 1) + (size - 1) * (size - 1));
+
+  int nbBoundaryEdges = 0;
+  for(int e = 0; e < topology.getNbEdges(); ++e)
+  {
+    const Pixel& edgePts = topology.getEdgePts(e);
+    BOOST_CHECK_LT(edgePts.x, edgePts.y);
+    if(e > 0)
+    {
+      // sorted by points ids
+      const Pixel& prev = topology.getEdgePts(e - 1);
+      BOOST_CHECK(prev.x < edgePts.x || (prev.x == edgePts.x && prev.y < edgePts.y));
+    }
+    const int nbTris = topology.getEdgeNeighTris(e).size();
+    BOOST_CHECK(nbTris == 1 || nbTris == 2);
+    nbBoundaryEdges += static_cast<int>(nbTris == 1);
+  }
+  BOOST_CHECK_EQUAL(nbBoundaryEdges, 4 * (size - 1));
+
+  for(int triId = 0; triId < topology.getNbTris(); ++triId)
+  {
+    for(int k = 0; k < 3; ++k)
+    {
+      const int halfEdge = MeshTopology::getHalfEdge(triId, k);
+      const Pixel& edgePts = topology.getEdgePts(topology.getTriEdge(triId, k));
+      const int a = (*mesh.tris)[triId].v[k];
+      const int b = (*mesh.tris)[triId].v[(k + 1) % 3];
+      BOOST_CHECK_EQUAL(edgePts.x, std::min(a, b));
+      BOOST_CHECK_EQUAL(edgePts.y, std::max(a, b));
+
+      const int opposite = topology.getOppositeHalfEdge(halfEdge);
+      if(opposite == -1)
+        continue;
+      // the grid is consistently oriented, the opposite half-edge goes from b to a
+      BOOST_CHECK_EQUAL(topology.getOppositeHalfEdge(opposite), halfEdge);
+      BOOST_CHECK_EQUAL((*mesh.tris)[opposite / 3].v[opposite % 3], b);
+      BOOST_CHECK_EQUAL((*mesh.tris)[opposite / 3].v[(opposite % 3 + 1) % 3], a);
+    }
+  }
+
+  for(int y = 0; y < size; ++y)
+  {
+    for(int x = 0; x < size; ++x)
+    {
+      const int ptId = y * size + x;
+      const bool isBorder = (x == 0 || y == 0 || x == size - 1 || y == size - 1);
+      BOOST_CHECK_EQUAL(topology.isBoundaryPt(ptId), isBorder);
+
+      const MeshTopology::Range ptNeighTris = topology.getPtNeighTris(ptId);
+      BOOST_CHECK(std::is_sorted(ptNeighTris.begin(), ptNeighTris.end()));
+
+      // the neighbor points are the points of the edges of the point
+      const MeshTopology::Range ptNeighPts = topology.getPtNeighPts(ptId);
+      std::vector<int> edgesPts;
+      for(int e = 0; e < topology.getNbEdges(); ++e)
+      {
+        const Pixel& edgePts = topology.getEdgePts(e);
+        if(edgePts.x == ptId || edgePts.y == ptId)
+          edgesPts.push_back(edgePts.x == ptId ? edgePts.y : edgePts.x);
+      }
+      std::vector<int> sortedNeighPts(ptNeighPts.begin(), ptNeighPts.end());
+      std::sort(edgesPts.begin(), edgesPts.end());
+      std::sort(sortedNeighPts.begin(), sortedNeighPts.end());
+      BOOST_CHECK(sortedNeighPts == edgesPts);
+
+      // each consecutive neighbor points are connected, the first and the last ones if the point is not on the border
+      for(int i = 0; i + 1 < ptNeighPts.size(); ++i)
+        BOOST_CHECK(shareEdge(topology, ptNeighPts[i], ptNeighPts[i + 1]));
+      if(isBorder)
+        continue;
+
+      BOOST_CHECK_EQUAL(ptNeighTris.size(), 6);
+      BOOST_REQUIRE_EQUAL(ptNeighPts.size(), 6);
+      BOOST_CHECK(shareEdge(topology, ptNeighPts[5], ptNeighPts[0]));
+    }
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a grid mesh
+// - Assert that the points neighbor triangles of Mesh are the same as the topology
+//-----------------
+BOOST_AUTO_TEST_CASE(meshTopology_samePtsNeighborTriangles)
+{
+  Mesh mesh;
+  createGridMesh(mesh, 5);
+  const MeshTopology topology(mesh);
+
+  StaticVector<StaticVector<int>*>* ptsNeighTris = mesh.getPtsNeighborTriangles();
+
+  for(int ptId = 0; ptId < mesh.pts->size(); ++ptId)
+  {
+    const MeshTopology::Range ptNeighTris = topology.getPtNeighTris(ptId);
+    BOOST_REQUIRE_EQUAL(sizeOfStaticVector<int>((*ptsNeighTris)[ptId]), ptNeighTris.size());
+    for(int i = 0; i < ptNeighTris.size(); ++i)
+      BOOST_CHECK_EQUAL((*(*ptsNeighTris)[ptId])[i], ptNeighTris[i]);
+  }
+
+  deleteArrayOfArrays<int>(&ptsNeighTris);
+}
+
+/**
+ * @brief Check that the neighbor points of a point are a sequence of connected points
+ */
+void checkConnectedNeighPts(const MeshTopology& topology, const std::vector<int>& neighPts)
+{
+  for(std::size_t i = 0; i + 1 < neighPts.size(); ++i)
+    BOOST_CHECK(shareEdge(topology, neighPts[i], neighPts[i + 1]));
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create an open fan whose first triangle is in the middle of the fan, a second open fan on the same
+//   point (non-manifold point) and an edge shared by 3 triangles (non-manifold edge)
+// - Assert that the points on an open fan or on a non-manifold edge are boundary points
+// - Assert that the ordered neighbor points of the non-manifold point cover both fans, each fan being
+//   walked from one of its boundary edges, and that the point is not in its own neighbor points
+//-----------------
+BOOST_AUTO_TEST_CASE(meshTopology_boundaryPts)
+{
+  Mesh mesh;
+  mesh.pts = new StaticVector<Point3d>();
+  mesh.tris = new StaticVector<Mesh::triangle>();
+
+  // point 0 in the middle, 1 to 5 on a first fan, 6 to 8 on a second fan
+  mesh.pts->push_back(Point3d(0.0, 0.0, 0.0));
+  for(int i = 0; i < 5; ++i)
+    mesh.pts->push_back(Point3d(std::cos(i * M_PI / 4.0), std::sin(i * M_PI / 4.0), 0.0));
+  for(int i = 0; i < 3; ++i)
+    mesh.pts->push_back(Point3d(std::cos(-0.5 - i * 0.5), std::sin(-0.5 - i * 0.5), 0.0));
+  // 9 and 10 on an edge shared by 3 triangles
+  mesh.pts->push_back(Point3d(5.0, 0.0, 0.0));
+  mesh.pts->push_back(Point3d(6.0, 0.0, 0.0));
+  mesh.pts->push_back(Point3d(5.5, 1.0, 0.0));
+  mesh.pts->push_back(Point3d(5.5, -1.0, 0.0));
+  mesh.pts->push_back(Point3d(5.5, 0.0, 1.0));
+
+  // the first triangle of the point 0 is in the middle of the first fan
+  mesh.tris->push_back(Mesh::triangle(0, 3, 4));
+  mesh.tris->push_back(Mesh::triangle(0, 1, 2));
+  mesh.tris->push_back(Mesh::triangle(0, 2, 3));
+  mesh.tris->push_back(Mesh::triangle(0, 4, 5));
+  mesh.tris->push_back(Mesh::triangle(0, 6, 7));
+  mesh.tris->push_back(Mesh::triangle(0, 7, 8));
+  mesh.tris->push_back(Mesh::triangle(9, 10, 11));
+  mesh.tris->push_back(Mesh::triangle(10, 9, 12));
+  mesh.tris->push_back(Mesh::triangle(9, 10, 13));
+
+  const MeshTopology topology(mesh);
+
+  BOOST_CHECK(topology.isBoundaryPt(0));
+  BOOST_CHECK(topology.isBoundaryPt(3));
+  BOOST_CHECK(topology.isBoundaryPt(9));
+  BOOST_CHECK(topology.isBoundaryPt(10));
+
+  // point inside the first fan: its 2 edges to the center are shared by 2 triangles, the others are on the border
+  const MeshTopology::Range neighPts3 = topology.getPtNeighPts(3);
+  BOOST_CHECK_EQUAL(neighPts3.size(), 3);
+
+  // both fans are walked from a boundary edge, without the point itself
+  const MeshTopology::Range neighPts0 = topology.getPtNeighPts(0);
+  BOOST_REQUIRE_EQUAL(neighPts0.size(), 8);
+  BOOST_CHECK(std::find(neighPts0.begin(), neighPts0.end(), 0) == neighPts0.end());
+
+  std::vector<int> firstFan;
+  std::vector<int> secondFan;
+  for(const int ptId : neighPts0)
+    (ptId <= 5 ? firstFan : secondFan).push_back(ptId);
+  BOOST_REQUIRE_EQUAL(firstFan.size(), 5);
+  BOOST_REQUIRE_EQUAL(secondFan.size(), 3);
+  // each fan is contiguous in the neighbor points
+  BOOST_CHECK(std::equal(firstFan.begin(), firstFan.end(), neighPts0.begin()) ||
+              std::equal(secondFan.begin(), secondFan.end(), neighPts0.begin()));
+
+  checkConnectedNeighPts(topology, firstFan);
+  checkConnectedNeighPts(topology, secondFan);
+  BOOST_CHECK(std::min(firstFan.front(), firstFan.back()) == 1 && std::max(firstFan.front(), firstFan.back()) == 5);
+  BOOST_CHECK(std::min(secondFan.front(), secondFan.back()) == 6 && std::max(secondFan.front(), secondFan.back()) == 8);
+
+  // the 3 triangles of the non-manifold edge are in the neighborhood of its points
+  BOOST_CHECK_EQUAL(topology.getPtNeighTris(9).size(), 3);
+  std::vector<int> neighPts9(topology.getPtNeighPts(9).begin(), topology.getPtNeighPts(9).end());
+  std::sort(neighPts9.begin(), neighPts9.end());
+  BOOST_CHECK(neighPts9 == std::vector<int>({10, 11, 12, 13}));
+}
@@ -5,15 +5,11 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "meshVisibility.hpp"
-#include "geoMesh.hpp"
 
 #include <aliceVision/system/Logger.hpp>
 
-#include <geogram/basic/permutation.h>
-#include <geogram/basic/attributes.h>
-#include <geogram/points/kd_tree.h>
-#include <geogram/mesh/mesh_AABB.h>
-#include <geogram/mesh/mesh_reorder.h>
+#include <cmath>
+#include <vector>
 
 
 namespace aliceVision {
@@ -24,13 +20,12 @@ int getNearestVertices(const Mesh& refMesh, const Mesh& mesh, StaticVector<int>&
     ALICEVISION_LOG_DEBUG("getNearestVertices start.");
     out_nearestVertex.resize(mesh.pts->size(), -1);
 
-    GEO::AdaptiveKdTree refMesh_kdTree(3);
-    refMesh_kdTree.set_points(refMesh.pts->size(), refMesh.pts->front().m);
+    const MeshSpatialIndex refMeshIndex(refMesh);
 
     #pragma omp parallel for
     for(int i = 0; i < mesh.pts->size(); ++i)
     {
-        out_nearestVertex[i] = refMesh_kdTree.get_nearest_neighbor((*mesh.pts)[i].m);
+        out_nearestVertex[i] = refMeshIndex.getNearestVertex((*mesh.pts)[i]);
     }
     ALICEVISION_LOG_DEBUG("getNearestVertices done.");
     return 0;
@@ -41,10 +36,15 @@ void remapMeshVisibilities_pullVerticesVisibility(
     const Mesh& refMesh, const PointsVisibility& refPtsVisibilities,
     const Mesh& mesh, PointsVisibility& out_ptsVisibilities)
 {
-    ALICEVISION_LOG_DEBUG("remapMeshVisibility based on closest vertex start.");
+    const MeshSpatialIndex refMeshIndex(refMesh);
+    remapMeshVisibilities_pullVerticesVisibility(refMeshIndex, refPtsVisibilities, mesh, out_ptsVisibilities);
+}
 
-    GEO::AdaptiveKdTree refMesh_kdTree(3);
-    refMesh_kdTree.set_points(refMesh.pts->size(), refMesh.pts->front().m);
+void remapMeshVisibilities_pullVerticesVisibility(
+    const MeshSpatialIndex& refMeshIndex, const PointsVisibility& refPtsVisibilities,
+    const Mesh& mesh, PointsVisibility& out_ptsVisibilities)
+{
+    ALICEVISION_LOG_DEBUG("remapMeshVisibility based on closest vertex start.");
 
     out_ptsVisibilities.resize(mesh.pts->size(), nullptr);
 
@@ -58,7 +58,7 @@ void remapMeshVisibilities_pullVerticesVisibility(
             out_ptsVisibilities[i] = pOut; // give ownership
         }
 
-        int iRef = refMesh_kdTree.get_nearest_neighbor((*mesh.pts)[i].m);
+        int iRef = refMeshIndex.getNearestVertex((*mesh.pts)[i]);
         if(iRef == -1)
             continue;
         PointVisibility* pRef = refPtsVisibilities[iRef];
@@ -72,32 +72,30 @@ void remapMeshVisibilities_pullVerticesVisibility(
 }
 
 
-double mesh_facet_edges_length(const GEO::Mesh &M, GEO::index_t f)
+static double mesh_facet_edges_length(const Mesh& mesh, int triId)
 {
-    const GEO::vec3& p0 = M.vertices.point(M.facets.vertex(f, 0));
-    const GEO::vec3& p1 = M.vertices.point(M.facets.vertex(f, 1));
-    const GEO::vec3& p2 = M.vertices.point(M.facets.vertex(f, 2));
-    return (p1 - p0).length() + (p2 - p1).length() + (p0 - p2).length();
+    const Mesh::triangle& t = (*mesh.tris)[triId];
+    const Point3d& p0 = (*mesh.pts)[t.v[0]];
+    const Point3d& p1 = (*mesh.pts)[t.v[1]];
+    const Point3d& p2 = (*mesh.pts)[t.v[2]];
+    return (p1 - p0).size() + (p2 - p1).size() + (p0 - p2).size();
 }
 
 void remapMeshVisibilities_pushVerticesVisibilityToTriangles(
     const Mesh& refMesh, const PointsVisibility& refPtsVisibilities,
     const Mesh& mesh, PointsVisibility& out_ptsVisibilities)
 {
-    ALICEVISION_LOG_INFO("remapMeshVisibility based on triangles start.");
-
-    GEO::initialize();
-    GEO::Mesh meshG;
-    toGeoMesh(mesh, meshG);
-
-    // MeshFacetAABB will reorder the mesh, so we need to keep indices
-    GEO::Attribute<GEO::index_t> reorderedVerticesAttr(meshG.vertices.attributes(), "reorder");
-    for(int i = 0; i < meshG.vertices.nb(); ++i)
-        reorderedVerticesAttr[i] = i;
+    const MeshSpatialIndex meshIndex(mesh);
+    remapMeshVisibilities_pushVerticesVisibilityToTriangles(refMesh, refPtsVisibilities, meshIndex, out_ptsVisibilities);
+}
 
-    GEO::MeshFacetsAABB meshAABB(meshG);  // warning: mesh_reorder called inside
+void remapMeshVisibilities_pushVerticesVisibilityToTriangles(
+    const Mesh& refMesh, const PointsVisibility& refPtsVisibilities,
+    const MeshSpatialIndex& meshIndex, PointsVisibility& out_ptsVisibilities)
+{
+    ALICEVISION_LOG_INFO("remapMeshVisibility based on triangles start.");
 
-    GEO::vector<GEO::index_t> reorderedVertices = reorderedVerticesAttr.get_vector();
+    const Mesh& mesh = meshIndex.getMesh();
 
     if (out_ptsVisibilities.size() != mesh.pts->size())
     {
@@ -109,38 +107,66 @@ void remapMeshVisibilities_pushVerticesVisibilityToTriangles(
         }
     }
 
+    // nearest triangle of each reference vertex
+    std::vector<int> refPtsNearestTri(refMesh.pts->size(), -1);
+
     #pragma omp parallel for
     for (int rvi = 0; rvi < refMesh.pts->size(); ++rvi)
     {
-        PointVisibility* rpVis = refPtsVisibilities[rvi];
-        if (rpVis == nullptr)
+        if (refPtsVisibilities[rvi] == nullptr)
             continue;
 
-        const GEO::vec3 rp((*refMesh.pts)[rvi].m);
-        GEO::vec3 nearestPoint;
+        Point3d nearestPoint;
         double dist2 = 0.0;
-        GEO::index_t f = meshAABB.nearest_facet(rp, nearestPoint, dist2);
-        if(f == GEO::NO_FACET)
+        const int f = meshIndex.getNearestTriangle((*refMesh.pts)[rvi], nearestPoint, dist2);
+        if(f == -1)
             continue;
 
-        double avgEdgeLength = mesh_facet_edges_length(meshG, f) / 3.0;
+        double avgEdgeLength = mesh_facet_edges_length(mesh, f) / 3.0;
         // if average edge length is larger than the distance between the output mesh
         // and the closest point in the reference mesh.
         if(std::sqrt(dist2) > avgEdgeLength)
             continue;
 
-        #pragma omp critical
+        refPtsNearestTri[rvi] = f;
+    }
+
+    // reference vertices pushing their visibility to each vertex (CSR arrays),
+    // so that each vertex can be updated by a single thread
+    std::vector<int> ptsRefPtsOffsets(mesh.pts->size() + 1, 0);
+    for (int rvi = 0; rvi < refMesh.pts->size(); ++rvi)
+    {
+        const int f = refPtsNearestTri[rvi];
+        if(f == -1)
+            continue;
+        for (int i = 0; i < 3; ++i)
+            ++ptsRefPtsOffsets[(*mesh.tris)[f].v[i] + 1];
+    }
+    for (int vi = 0; vi < mesh.pts->size(); ++vi)
+        ptsRefPtsOffsets[vi + 1] += ptsRefPtsOffsets[vi];
+
+    std::vector<int> ptsRefPts(ptsRefPtsOffsets.back());
+    {
+        std::vector<int> ptsFill(ptsRefPtsOffsets.begin(), ptsRefPtsOffsets.end() - 1);
+        for (int rvi = 0; rvi < refMesh.pts->size(); ++rvi)
         {
+            const int f = refPtsNearestTri[rvi];
+            if(f == -1)
+                continue;
             for (int i = 0; i < 3; ++i)
-            {
-                GEO::index_t v = meshG.facets.vertex(f, i);
-                if (v == GEO::NO_VERTEX)
-                    continue;
-                PointVisibility* pOut = out_ptsVisibilities[reorderedVertices[v]];
-                
-                for(int j = 0; j < rpVis->size(); ++j)
-                    pOut->push_back_distinct((*rpVis)[j]);
-            }
+                ptsRefPts[ptsFill[(*mesh.tris)[f].v[i]]++] = rvi;
+        }
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int vi = 0; vi < mesh.pts->size(); ++vi)
+    {
+        PointVisibility* pOut = out_ptsVisibilities[vi];
+        for (int r = ptsRefPtsOffsets[vi]; r < ptsRefPtsOffsets[vi + 1]; ++r)
+        {
+            const PointVisibility* rpVis = refPtsVisibilities[ptsRefPts[r]];
+            for(int j = 0; j < rpVis->size(); ++j)
+                pOut->push_back_distinct((*rpVis)[j]);
         }
     }
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/MeshSpatialIndex.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 
 namespace aliceVision {
@@ -38,6 +39,18 @@ void remapMeshVisibilities_pullVerticesVisibility(
     const Mesh& refMesh, const PointsVisibility& refPtsVisibilities,
     const Mesh& mesh, PointsVisibility& out_ptsVisibilities);
 
+/**
+ * @brief Same as remapMeshVisibilities_pullVerticesVisibility with a spatial index of the reference mesh.
+ *
+ * @param[in] refMeshIndex spatial index of the input reference mesh
+ * @param[in] refPtsVisibilities visibility array per vertex of the reference mesh
+ * @param[in] mesh input target mesh
+ * @param[out] out_ptsVisibilities visibility array per vertex of @p mesh
+ */
+void remapMeshVisibilities_pullVerticesVisibility(
+    const MeshSpatialIndex& refMeshIndex, const PointsVisibility& refPtsVisibilities,
+    const Mesh& mesh, PointsVisibility& out_ptsVisibilities);
+
 /**
 * @brief Transfer the visibility per vertex from one mesh to another.
 * For each vertex of the @p refMesh, we search the closest triangle in the @p mesh and copy its visibility information to each vertex of the triangle.
@@ -52,6 +65,20 @@ void remapMeshVisibilities_pushVerticesVisibilityToTriangles(
     const Mesh& refMesh, const PointsVisibility& refPtsVisibilities,
     const Mesh& mesh, PointsVisibility& out_ptsVisibilities);
 
+/**
+ * @brief Same as remapMeshVisibilities_pushVerticesVisibilityToTriangles with a spatial index of the target mesh.
+ * The visibilities pushed to each vertex are merged in parallel per vertex, in the order of the reference vertices,
+ * so the result does not depend on the number of threads.
+ *
+ * @param[in] refMesh input reference mesh
+ * @param[in] refPtsVisibilities visibility array per vertex of @p refMesh
+ * @param[in] meshIndex spatial index of the input target mesh
+ * @param[out] out_ptsVisibilities visibility array per vertex of the target mesh
+ */
+void remapMeshVisibilities_pushVerticesVisibilityToTriangles(
+    const Mesh& refMesh, const PointsVisibility& refPtsVisibilities,
+    const MeshSpatialIndex& meshIndex, PointsVisibility& out_ptsVisibilities);
+
 
 } // namespace mesh
 } // namespace aliceVision
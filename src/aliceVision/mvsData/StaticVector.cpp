@@ -21,14 +21,15 @@ int getArrayLengthFromFile(std::string fileName)
 
     int n = 0;
     size_t retval = fread(&n, sizeof(int), 1, f);
-    if( retval != sizeof(int) )
+    if( retval != 1 )
     {
         ALICEVISION_LOG_WARNING("[IO] getArrayLengthFromFile: can't read array length (1)");
     }
-    if(n == -1)
+    // -1 or -2: compressed array, followed by the array length
+    if(n < 0)
     {
         retval = fread(&n, sizeof(int), 1, f);
-        if( retval != sizeof(int) )
+        if( retval != 1 )
         {
             ALICEVISION_LOG_WARNING("[IO] getArrayLengthFromFile: can't read array length (2)");
         }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsData/compressedChunks.hpp>
 
 #include <algorithm>
 #include <assert.h>
@@ -332,97 +333,29 @@ void saveArrayToFile(std::string fileName, const StaticVector<T>* a, bool docomp
     }
     else
     {
-
-        /* ===========================================================================
-        //from zlib - compress.c
-             Compresses the source buffer into the destination buffer. The level
-           parameter has the same meaning as in deflateInit.  sourceLen is the byte
-           length of the source buffer. Upon entry, destLen is the total size of the
-           destination buffer, which must be at least 0.1% larger than sourceLen plus
-           12 bytes. Upon exit, destLen is the actual size of the compressed buffer.
-
-             compress2 returns Z_OK if success, Z_MEM_ERROR if there was not enough
-           memory, Z_BUF_ERROR if there was not enough room in the output buffer,
-           Z_STREAM_ERROR if the level parameter is invalid.
-        */
-
-        // uLong comprLen = sizeof(T)*a->size();
-        uLong comprLen = uLong((double)(sizeof(T) * a->size()) * 1.02) + 12;
-        Byte* compr = (Byte*)calloc((uInt)comprLen, 1);
-        int err = compress(compr, &comprLen, (const Bytef*)(&(*a)[0]), sizeof(T) * a->size());
-
-        if(err != Z_OK)
+        FILE* f = fopen(fileName.c_str(), "wb");
+        if( f == NULL )
+        {
+            ALICEVISION_THROW_ERROR( "[IO] file " << fileName << " could not be opened, msg: " << strerror(errno) );
+        }
+        // -2: chunked compression, -1 was the single zlib blob of the previous versions
+        const int header[2] = {-2, a->size()};
+        int items = fwrite(header, sizeof(int), 2, f);
+        if( items < 2 )
         {
-            ALICEVISION_LOG_ERROR("compress error " << err << " : " << (sizeof(T) * a->size()) << " -> " << comprLen << ", n " << a->size());
-
-            FILE* f = fopen(fileName.c_str(), "wb");
-            if( f == NULL )
-            {
-                free(compr);
-                ALICEVISION_THROW_ERROR( "[IO] file " << fileName << " could not be opened, msg: " << strerror(errno) );
-            }
-            int n = a->size();
-            if( n > 0 )
-            {
-                int items = fwrite(&n, sizeof(int), 1, f);
-                if( items < 1 && ferror(f) != 0 )
-                {
-                    fclose(f);
-                    free(compr);
-                    ALICEVISION_THROW_ERROR( "[IO] failed to write 1 int to " << fileName << ", msg: " << strerror(errno) );
-                }
-                items = fwrite(&(*a)[0], sizeof(T), n, f);
-                if( items < 1 && ferror(f) != 0 )
-                {
-                    fclose(f);
-                    free(compr);
-                    ALICEVISION_THROW_ERROR( "[IO] failed to write " << n << " items to " << fileName << ", msg: " << strerror(errno) );
-                }
-            }
             fclose(f);
+            ALICEVISION_THROW_ERROR( "[IO] failed to write 2 int to " << fileName << ", msg: " << strerror(errno) );
         }
-        else
+        try
+        {
+            fwriteCompressedChunks(f, a->getData().data(), sizeof(T) * a->size(), fileName);
+        }
+        catch(...)
         {
-            FILE* f = fopen(fileName.c_str(), "wb");
-            if( f == NULL )
-            {
-                free(compr);
-                ALICEVISION_THROW_ERROR( "[IO] file " << fileName << " could not be opened, msg: " << strerror(errno) );
-            }
-            int n = -1;
-            int items = fwrite(&n, sizeof(int), 1, f);
-            if( items < 1 && ferror(f) != 0 )
-            {
-                fclose(f);
-                free(compr);
-                ALICEVISION_THROW_ERROR( "[IO] failed to write 1 int to " << fileName << ", msg: " << strerror(errno) );
-            }
-            n = a->size();
-            items = fwrite(&n, sizeof(int), 1, f);
-            if( items < 1 && ferror(f) != 0 )
-            {
-                fclose(f);
-                free(compr);
-                ALICEVISION_THROW_ERROR( "[IO] failed to write 1 int to " << fileName << ", msg: " << strerror(errno) );
-            }
-            items = fwrite(&comprLen, sizeof(uLong), 1, f);
-            if( items < 1 && ferror(f) != 0 )
-            {
-                fclose(f);
-                free(compr);
-                ALICEVISION_THROW_ERROR( "[IO] failed to write 1 uLong to " << fileName << ", msg: " << strerror(errno) );
-            }
-            items = fwrite(compr, sizeof(Byte), comprLen, f);
-            if( items < 1 && ferror(f) != 0 )
-            {
-                fclose(f);
-                free(compr);
-                ALICEVISION_THROW_ERROR( "[IO] failed to write " << comprLen << " items to " << fileName << ", msg: " << strerror(errno) );
-            }
             fclose(f);
-        };
-
-        free(compr);
+            throw;
+        }
+        fclose(f);
     };
 }
 
@@ -447,7 +380,28 @@ StaticVector<T>* loadArrayFromFile(std::string fileName, bool printfWarning = fa
         }
         StaticVector<T>* a = NULL;
 
-        if(n == -1)
+        if(n == -2)
+        {
+            retval = fread(&n, sizeof(int), 1, f);
+            if( retval != 1 || n < 0 )
+            {
+                fclose(f);
+                ALICEVISION_THROW_ERROR("[IO] loadArrayFromFile: can't read array size (2) from " << fileName);
+            }
+            a = new StaticVector<T>();
+            a->resize(n);
+            try
+            {
+                freadCompressedChunks(f, a->getDataWritable().data(), sizeof(T) * n, fileName);
+            }
+            catch(...)
+            {
+                delete a;
+                fclose(f);
+                throw;
+            }
+        }
+        else if(n == -1)
         {
             retval = fread(&n, sizeof(int), 1, f);
             if( retval != 1 )
@@ -528,10 +482,32 @@ bool loadArrayFromFile( StaticVector<T>& out, std::string fileName, bool printfW
         int n = 0;
         size_t retval = fread(&n, sizeof(int), 1, f);
         if( retval != 1 )
-            ALICEVISION_LOG_WARNING("[IO] loadArrayFromFile: can't read array size (1) from " << fileName);
+        {
+            fclose(f);
+            ALICEVISION_THROW_ERROR("[IO] loadArrayFromFile: can't read array size (1) from " << fileName);
+        }
         out.clear();
 
-        if(n == -1)
+        if(n == -2)
+        {
+            retval = fread(&n, sizeof(int), 1, f);
+            if( retval != 1 || n < 0 )
+            {
+                fclose(f);
+                ALICEVISION_THROW_ERROR("[IO] loadArrayFromFile: can't read array size (2) from " << fileName);
+            }
+            out.resize(n);
+            try
+            {
+                freadCompressedChunks(f, out.getDataWritable().data(), sizeof(T) * n, fileName);
+            }
+            catch(...)
+            {
+                fclose(f);
+                throw;
+            }
+        }
+        else if(n == -1)
         {
             retval = fread(&n, sizeof(int), 1, f);
             if( retval != 1 )
@@ -590,7 +566,29 @@ void loadArrayFromFileIntoArray(StaticVector<T>* a, std::string fileName, bool p
     int n = 0;
     fread(&n, sizeof(int), 1, f);
  
-    if(n == -1)
+    if(n == -2)
+    {
+        if(fread(&n, sizeof(int), 1, f) != 1)
+        {
+            fclose(f);
+            ALICEVISION_THROW_ERROR("loadArrayFromFileIntoArray: can't read array size (2) from " << fileName);
+        }
+        if(a->size() != n)
+        {
+            fclose(f);
+            ALICEVISION_THROW_ERROR("loadArrayFromFileIntoArray: expected length " << a->size() << " loaded length " << n);
+        }
+        try
+        {
+            freadCompressedChunks(f, a->getDataWritable().data(), sizeof(T) * n, fileName);
+        }
+        catch(...)
+        {
+            fclose(f);
+            throw;
+        }
+    }
+    else if(n == -1)
     {
         fread(&n, sizeof(int), 1, f);
         if(a->size() != n)
@@ -0,0 +1,158 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "compressedChunks.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace aliceVision {
+
+namespace {
+
+const std::uint32_t compressedChunksVersion = 1;
+
+/// codec of the chunks, a chunk whose compressed size is its uncompressed size is stored uncompressed
+const std::uint32_t compressedChunksCodecZlib = 1;
+
+template <class T>
+void fwriteValues(FILE* f, const T* values, std::size_t n, const std::string& fileName)
+{
+    if(n > 0 && fwrite(values, sizeof(T), n, f) != n)
+        ALICEVISION_THROW_ERROR("[IO] failed to write compressed chunks to " << fileName << ", msg: " << strerror(errno));
+}
+
+template <class T>
+void freadValues(FILE* f, T* values, std::size_t n, const std::string& fileName)
+{
+    if(n > 0 && fread(values, sizeof(T), n, f) != n)
+        ALICEVISION_THROW_ERROR("[IO] failed to read compressed chunks from " << fileName);
+}
+
+} // namespace
+
+void fwriteCompressedChunks(FILE* f, const void* data, std::size_t size, const std::string& fileName, std::size_t chunkSize)
+{
+    const std::uint64_t nbChunks = (size + chunkSize - 1) / chunkSize;
+    const Bytef* bytes = static_cast<const Bytef*>(data);
+
+    std::vector<std::vector<Bytef>> chunks(nbChunks);
+    std::vector<std::uint64_t> compressedSizes(nbChunks);
+    std::vector<std::uint32_t> checksums(nbChunks);
+    int nbErrors = 0;
+
+#pragma omp parallel for reduction(+:nbErrors)
+    for(int c = 0; c < static_cast<int>(nbChunks); ++c)
+    {
+        const Bytef* chunk = bytes + c * chunkSize;
+        const uLong chunkLen = static_cast<uLong>(std::min(chunkSize, size - c * chunkSize));
+
+        checksums[c] = static_cast<std::uint32_t>(crc32(crc32(0L, Z_NULL, 0), chunk, static_cast<uInt>(chunkLen)));
+
+        uLongf compressedLen = compressBound(chunkLen);
+        chunks[c].resize(compressedLen);
+        if(compress2(chunks[c].data(), &compressedLen, chunk, chunkLen, Z_BEST_SPEED) != Z_OK)
+        {
+            ++nbErrors;
+            continue;
+        }
+
+        if(compressedLen < chunkLen)
+        {
+            chunks[c].resize(compressedLen);
+        }
+        else
+        {
+            // incompressible chunk
+            chunks[c].assign(chunk, chunk + chunkLen);
+        }
+        compressedSizes[c] = chunks[c].size();
+    }
+
+    if(nbErrors > 0)
+        ALICEVISION_THROW_ERROR("[IO] failed to compress " << nbErrors << " chunks of " << fileName);
+
+    const std::uint32_t header[2] = {compressedChunksVersion, compressedChunksCodecZlib};
+    const std::uint64_t sizes[3] = {size, chunkSize, nbChunks};
+    fwriteValues(f, header, 2, fileName);
+    fwriteValues(f, sizes, 3, fileName);
+    fwriteValues(f, compressedSizes.data(), nbChunks, fileName);
+    fwriteValues(f, checksums.data(), nbChunks, fileName);
+    for(const std::vector<Bytef>& chunk : chunks)
+        fwriteValues(f, chunk.data(), chunk.size(), fileName);
+}
+
+void freadCompressedChunks(FILE* f, void* data, std::size_t size, const std::string& fileName)
+{
+    std::uint32_t header[2];
+    std::uint64_t sizes[3];
+    freadValues(f, header, 2, fileName);
+    freadValues(f, sizes, 3, fileName);
+
+    if(header[0] != compressedChunksVersion)
+        ALICEVISION_THROW_ERROR("[IO] unsupported compressed chunks version " << header[0] << " in " << fileName);
+    if(header[1] != compressedChunksCodecZlib)
+        ALICEVISION_THROW_ERROR("[IO] unsupported compressed chunks codec " << header[1] << " in " << fileName);
+
+    const std::uint64_t chunkSize = sizes[1];
+    const std::uint64_t nbChunks = sizes[2];
+    if(sizes[0] != size || chunkSize == 0 || nbChunks != (size + chunkSize - 1) / chunkSize)
+        ALICEVISION_THROW_ERROR("[IO] invalid compressed chunks header in " << fileName << ": size " << sizes[0]
+                                << " (expected " << size << "), chunk size " << chunkSize << ", " << nbChunks << " chunks");
+
+    std::vector<std::uint64_t> compressedSizes(nbChunks);
+    std::vector<std::uint32_t> checksums(nbChunks);
+    freadValues(f, compressedSizes.data(), nbChunks, fileName);
+    freadValues(f, checksums.data(), nbChunks, fileName);
+
+    std::vector<std::uint64_t> offsets(nbChunks + 1, 0);
+    for(std::uint64_t c = 0; c < nbChunks; ++c)
+        offsets[c + 1] = offsets[c] + compressedSizes[c];
+
+    std::vector<Bytef> compressed(offsets.back());
+    freadValues(f, compressed.data(), compressed.size(), fileName);
+
+    Bytef* bytes = static_cast<Bytef*>(data);
+    int nbErrors = 0;
+
+#pragma omp parallel for reduction(+:nbErrors)
+    for(int c = 0; c < static_cast<int>(nbChunks); ++c)
+    {
+        Bytef* chunk = bytes + c * chunkSize;
+        const uLong chunkLen = static_cast<uLong>(std::min<std::uint64_t>(chunkSize, size - c * chunkSize));
+        const Bytef* compressedChunk = compressed.data() + offsets[c];
+        const uLong compressedLen = static_cast<uLong>(compressedSizes[c]);
+
+        if(compressedLen == chunkLen)
+        {
+            std::memcpy(chunk, compressedChunk, chunkLen);
+        }
+        else
+        {
+            uLongf uncompressedLen = chunkLen;
+            if(uncompress(chunk, &uncompressedLen, compressedChunk, compressedLen) != Z_OK || uncompressedLen != chunkLen)
+            {
+                ++nbErrors;
+                continue;
+            }
+        }
+
+        if(crc32(crc32(0L, Z_NULL, 0), chunk, static_cast<uInt>(chunkLen)) != checksums[c])
+            ++nbErrors;
+    }
+
+    if(nbErrors > 0)
+        ALICEVISION_THROW_ERROR("[IO] " << nbErrors << " corrupted chunks in " << fileName);
+}
+
+} // namespace aliceVision
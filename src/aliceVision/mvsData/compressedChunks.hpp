@@ -0,0 +1,44 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace aliceVision {
+
+/// default size of the uncompressed chunks
+const std::size_t compressedChunksDefaultChunkSize = 4 * 1024 * 1024;
+
+/**
+ * @brief Write a buffer in a file as independently compressed chunks, compressed in parallel.
+ *
+ * Layout: version, codec, uncompressed size, chunk size, number of chunks,
+ * table of the compressed size and CRC32 of each uncompressed chunk, compressed chunks.
+ *
+ * @param[in] f the file, opened in binary write mode
+ * @param[in] data the buffer
+ * @param[in] size the buffer size in bytes
+ * @param[in] fileName the file name, for the error messages
+ * @param[in] chunkSize the size of the uncompressed chunks
+ */
+void fwriteCompressedChunks(FILE* f, const void* data, std::size_t size, const std::string& fileName,
+                            std::size_t chunkSize = compressedChunksDefaultChunkSize);
+
+/**
+ * @brief Read a buffer written by fwriteCompressedChunks, the chunks are decompressed in parallel
+ * and their checksums are verified. Throws if the file is corrupted or does not have the expected size.
+ *
+ * @param[in] f the file, opened in binary read mode
+ * @param[out] data the buffer
+ * @param[in] size the expected buffer size in bytes
+ * @param[in] fileName the file name, for the error messages
+ */
+void freadCompressedChunks(FILE* f, void* data, std::size_t size, const std::string& fileName);
+
+} // namespace aliceVision
@@ -0,0 +1,166 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsData/compressedChunks.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE compressedChunks
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace bfs = boost::filesystem;
+
+const std::string tmpFile()
+{
+  return (bfs::temp_directory_path() / bfs::unique_path("compressedChunks_%%%%%%%%.bin")).string();
+}
+
+/// smooth values with some noise: compressible, but not trivially
+StaticVector<float> createValues(int n)
+{
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> noise(0, 3);
+  StaticVector<float> values;
+  values.reserve(n);
+  for(int i = 0; i < n; ++i)
+    values.push_back(static_cast<float>(i / 100 + noise(generator)));
+  return values;
+}
+
+BOOST_AUTO_TEST_CASE(compressedChunks_roundTrip)
+{
+  const std::string fileName = tmpFile();
+
+  // compressible data and incompressible random data, over several chunks with a partial last chunk
+  std::vector<unsigned char> data(100003);
+  for(std::size_t i = 0; i < data.size() / 2; ++i)
+    data[i] = static_cast<unsigned char>(i / 1000);
+  std::mt19937 generator(42);
+  for(std::size_t i = data.size() / 2; i < data.size(); ++i)
+    data[i] = static_cast<unsigned char>(generator());
+
+  FILE* f = fopen(fileName.c_str(), "wb");
+  fwriteCompressedChunks(f, data.data(), data.size(), fileName, 8192);
+  fclose(f);
+
+  std::vector<unsigned char> readData(data.size());
+  f = fopen(fileName.c_str(), "rb");
+  freadCompressedChunks(f, readData.data(), readData.size(), fileName);
+  fclose(f);
+  BOOST_CHECK(readData == data);
+
+  // unexpected size
+  f = fopen(fileName.c_str(), "rb");
+  BOOST_CHECK_THROW(freadCompressedChunks(f, readData.data(), readData.size() - 1, fileName), std::runtime_error);
+  fclose(f);
+
+  bfs::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(compressedChunks_corruption)
+{
+  const std::string fileName = tmpFile();
+
+  std::vector<unsigned char> data(50000);
+  for(std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<unsigned char>(i % 251);
+
+  FILE* f = fopen(fileName.c_str(), "wb");
+  fwriteCompressedChunks(f, data.data(), data.size(), fileName, 4096);
+  fclose(f);
+
+  // flip a byte of the last chunk
+  const std::size_t fileSize = bfs::file_size(fileName);
+  f = fopen(fileName.c_str(), "r+b");
+  fseek(f, static_cast<long>(fileSize - 3), SEEK_SET);
+  const int c = fgetc(f);
+  fseek(f, static_cast<long>(fileSize - 3), SEEK_SET);
+  fputc(c ^ 0xff, f);
+  fclose(f);
+
+  std::vector<unsigned char> readData(data.size());
+  f = fopen(fileName.c_str(), "rb");
+  BOOST_CHECK_THROW(freadCompressedChunks(f, readData.data(), readData.size(), fileName), std::runtime_error);
+  fclose(f);
+
+  bfs::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(compressedChunks_staticVector)
+{
+  const std::string fileName = tmpFile();
+  const StaticVector<float> values = createValues(2000000);
+
+  saveArrayToFile(fileName, values);
+  BOOST_CHECK_EQUAL(getArrayLengthFromFile(fileName), values.size());
+  BOOST_CHECK_LT(bfs::file_size(fileName), values.size() * sizeof(float));
+
+  StaticVector<float> readValues;
+  loadArrayFromFile(readValues, fileName);
+  BOOST_CHECK(readValues.getData() == values.getData());
+
+  StaticVector<float>* readValuesPtr = loadArrayFromFile<float>(fileName);
+  BOOST_CHECK(readValuesPtr->getData() == values.getData());
+  delete readValuesPtr;
+
+  StaticVector<float> readValuesInto;
+  readValuesInto.resize(values.size());
+  loadArrayFromFileIntoArray(&readValuesInto, fileName);
+  BOOST_CHECK(readValuesInto.getData() == values.getData());
+
+  bfs::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(compressedChunks_legacyFile)
+{
+  const std::string fileName = tmpFile();
+  const StaticVector<float> values = createValues(5000);
+
+  // single zlib blob written by the previous versions
+  uLong comprLen = compressBound(sizeof(float) * values.size());
+  std::vector<Byte> compr(comprLen);
+  BOOST_REQUIRE_EQUAL(compress(compr.data(), &comprLen, (const Bytef*)values.getData().data(), sizeof(float) * values.size()), Z_OK);
+
+  FILE* f = fopen(fileName.c_str(), "wb");
+  const int header[2] = {-1, values.size()};
+  fwrite(header, sizeof(int), 2, f);
+  fwrite(&comprLen, sizeof(uLong), 1, f);
+  fwrite(compr.data(), sizeof(Byte), comprLen, f);
+  fclose(f);
+
+  BOOST_CHECK_EQUAL(getArrayLengthFromFile(fileName), values.size());
+  StaticVector<float> readValues;
+  loadArrayFromFile(readValues, fileName);
+  BOOST_CHECK(readValues.getData() == values.getData());
+
+  bfs::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(compressedChunks_truncatedSize)
+{
+  const std::string fileName = tmpFile();
+
+  // compressed array header without its size
+  FILE* f = fopen(fileName.c_str(), "wb");
+  const int header = -2;
+  fwrite(&header, sizeof(int), 1, f);
+  fclose(f);
+
+  StaticVector<float> readValues;
+  BOOST_CHECK_THROW(loadArrayFromFile(readValues, fileName), std::runtime_error);
+  BOOST_CHECK_THROW(loadArrayFromFile<float>(fileName), std::runtime_error);
+  readValues.resize(10);
+  BOOST_CHECK_THROW(loadArrayFromFileIntoArray(&readValues, fileName), std::runtime_error);
+
+  bfs::remove(fileName);
+}
@@ -7,6 +7,7 @@
 #include "ImagesCache.hpp"
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
 
 #include <future>
 
@@ -39,6 +40,9 @@ void ImagesCache::initIC( std::vector<std::string>& _imagesNames )
 {
     float oneimagemb = (sizeof(Color) * mp->getMaxImageWidth() * mp->getMaxImageHeight()) / 1024.f / 1024.f;
     float maxmbCPU = (float)mp->userParams.get<int>("images_cache.maxmbCPU", 5000);
+    // within the memory budget of the process
+    const std::size_t availableMB = system::MemoryTracker::getInstance().getAvailableMemory() / (1024 * 1024);
+    maxmbCPU = std::min(maxmbCPU, static_cast<float>(availableMB));
     int _npreload = std::max((int)(maxmbCPU / oneimagemb), mp->userParams.get<int>("grow.minNumOfConsistentCams", 10));
     N_PRELOADED_IMAGES = std::min(mp->ncams, _npreload);
 
@@ -66,6 +70,12 @@ void ImagesCache::initIC( std::vector<std::string>& _imagesNames )
 
 ImagesCache::~ImagesCache()
 {
+    const std::size_t imageBytes = sizeof(Color) * mp->getMaxImageWidth() * mp->getMaxImageHeight();
+    for(const ImgPtr& img : imgs)
+    {
+        if(img != nullptr)
+            system::MemoryTracker::getInstance().release(imageBytes);
+    }
 }
 
 void ImagesCache::refreshData(int camId)
@@ -93,6 +103,7 @@ void ImagesCache::refreshData(int camId)
         {
             const std::size_t maxSize = mp->getMaxImageWidth() * mp->getMaxImageHeight();
             imgs[mapId] = std::make_shared<Img>( maxSize );
+            system::MemoryTracker::getInstance().allocate(sizeof(Color) * maxSize);
         }
 
         const std::string imagePath = imagesNames.at(camId);
@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "depthSimMapStorage.hpp"
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+EDepthMapStorage EDepthMapStorage_stringToEnum(const std::string& storage)
+{
+    std::string s = storage;
+    boost::to_lower(s);
+
+    if(s == "float")
+        return EDepthMapStorage::FLOAT;
+    if(s == "compact")
+        return EDepthMapStorage::COMPACT;
+    throw std::out_of_range("Invalid depth map storage " + storage);
+}
+
+std::string EDepthMapStorage_enumToString(EDepthMapStorage storage)
+{
+    switch(storage)
+    {
+    case EDepthMapStorage::FLOAT:
+        return "float";
+    case EDepthMapStorage::COMPACT:
+        return "compact";
+    }
+    throw std::out_of_range("Unrecognized EDepthMapStorage");
+}
+
+EDepthMapStorage getDepthMapStorage(const MultiViewParams* mp)
+{
+    return EDepthMapStorage_stringToEnum(mp->userParams.get<std::string>("depthMap.storage", EDepthMapStorage_enumToString(EDepthMapStorage::FLOAT)));
+}
+
+bool isInHalfRange(const std::vector<float>& values)
+{
+    // largest finite half float value
+    const float halfMax = 65504.0f;
+
+    for(const float value : values)
+    {
+        if(std::abs(value) > halfMax)
+            return false;
+    }
+    return true;
+}
+
+float getSimMapScale(const std::vector<float>& simMap)
+{
+    float scale = 0.0f;
+    for(const float sim : simMap)
+        scale = std::max(scale, std::abs(sim));
+    return scale;
+}
+
+int quantizeSim(float sim, float scale)
+{
+    if(scale == 0.0f)
+        return 0;
+
+    int code = static_cast<int>(std::round(sim / scale * 127.0f));
+    if(sim < scale)
+        code = std::min(code, 126);
+    return std::max(-127, std::min(code, 127));
+}
+
+float dequantizeSim(int code, float scale)
+{
+    return (code == 127) ? scale : (code == -127) ? -scale : code * scale / 127.0f;
+}
+
+float quantizeSimMap(std::vector<float>& simMap)
+{
+    const float scale = getSimMapScale(simMap);
+
+    for(float& sim : simMap)
+        sim = dequantizeSim(quantizeSim(sim, scale), scale);
+    return scale;
+}
+
+void readSimMap(const std::string& simMapFilename, int& width, int& height, std::vector<float>& simMap)
+{
+    imageIO::readImage(simMapFilename, width, height, simMap);
+
+    oiio::ParamValueList metadata;
+    imageIO::readImageMetadata(simMapFilename, metadata);
+    const auto scaleIt = metadata.find("AliceVision:simScale");
+    if(scaleIt == metadata.end())
+        return; // not quantized
+
+    const float scale = scaleIt->get_float();
+    for(float& sim : simMap)
+        sim = dequantizeSim(static_cast<int>(std::round(sim)), scale);
+}
+
+void writeDepthSimMaps(const std::string& depthMapFilename, const std::string& simMapFilename, int width, int height,
+                       const std::vector<float>& depthMap, const std::vector<float>& simMap,
+                       const oiio::ParamValueList& metadata, EDepthMapStorage storage)
+{
+    if(storage == EDepthMapStorage::FLOAT)
+    {
+        imageIO::writeImage(depthMapFilename, width, height, depthMap, imageIO::EImageQuality::LOSSLESS, metadata);
+        imageIO::writeImage(simMapFilename, width, height, simMap);
+        return;
+    }
+
+    // half float depth, unless a depth would overflow to infinity
+    EDepthMapStorage depthStorage = storage;
+    if(!isInHalfRange(depthMap))
+    {
+        ALICEVISION_LOG_WARNING("The depth map '" << depthMapFilename << "' exceeds the half float range, it is written as float.");
+        depthStorage = EDepthMapStorage::FLOAT;
+    }
+
+    oiio::ParamValueList depthMetadata = metadata;
+    depthMetadata.push_back(oiio::ParamValue("AliceVision:depthMapStorage", EDepthMapStorage_enumToString(depthStorage)));
+    imageIO::writeImage(depthMapFilename, width, height, depthMap,
+                        (depthStorage == EDepthMapStorage::FLOAT) ? imageIO::EImageQuality::LOSSLESS : imageIO::EImageQuality::OPTIMIZED,
+                        depthMetadata);
+
+    // OpenEXR has no 8 bits pixel type: the codes of the 255 levels are written as half float,
+    // which represents the integers exactly, and the few distinct values compress well
+    const float simScale = getSimMapScale(simMap);
+    std::vector<float> simCodes(simMap.size());
+    for(std::size_t i = 0; i < simMap.size(); ++i)
+        simCodes[i] = static_cast<float>(quantizeSim(simMap[i], simScale));
+
+    oiio::ParamValueList simMetadata;
+    simMetadata.push_back(oiio::ParamValue("AliceVision:depthMapStorage", EDepthMapStorage_enumToString(storage)));
+    simMetadata.push_back(oiio::ParamValue("AliceVision:simScale", simScale));
+    imageIO::writeImage(simMapFilename, width, height, simCodes, imageIO::EImageQuality::OPTIMIZED, simMetadata);
+}
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -0,0 +1,114 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/imageIO/image.hpp>
+
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+class MultiViewParams;
+
+/**
+ * @brief Storage of the depth and similarity maps files.
+ * The depth maps are always read as float, the similarity maps are read with readSimMap(),
+ * so the readers do not depend on the storage.
+ */
+enum class EDepthMapStorage
+{
+    /// float depth, half float similarity
+    FLOAT = 0,
+    /// half float depth (float for the maps out of the half float range),
+    /// similarity quantized on 8 bits (255 levels): the integer codes are written as 16 bits half float,
+    /// which represents them exactly, with the per-map scale in the "AliceVision:simScale" metadata
+    COMPACT
+};
+
+/**
+ * @brief returns the EDepthMapStorage enum from a string.
+ * @param[in] storage the input string.
+ * @return the associated EDepthMapStorage enum.
+ */
+EDepthMapStorage EDepthMapStorage_stringToEnum(const std::string& storage);
+
+/**
+ * @brief converts an EDepthMapStorage enum to a string.
+ * @param[in] storage the EDepthMapStorage enum to convert.
+ * @return the string associated to the EDepthMapStorage enum.
+ */
+std::string EDepthMapStorage_enumToString(EDepthMapStorage storage);
+
+/**
+ * @brief get the storage of the depth and similarity maps from the "depthMap.storage" user parameter
+ */
+EDepthMapStorage getDepthMapStorage(const MultiViewParams* mp);
+
+/**
+ * @brief Check that all the values can be written as half float without overflowing to infinity.
+ * @param[in] values the values to check
+ * @return true if the magnitude of all the values is below the half float maximum (65504)
+ */
+bool isInHalfRange(const std::vector<float>& values);
+
+/**
+ * @brief Get the quantization scale of a similarity map: the largest absolute value of the map
+ */
+float getSimMapScale(const std::vector<float>& simMap);
+
+/**
+ * @brief Quantize a similarity value on 255 levels symmetric around 0.
+ * The values below the scale stay below it once dequantized.
+ * @return the code of the value, in [-127, 127]
+ */
+int quantizeSim(float sim, float scale);
+
+/**
+ * @brief Get the similarity value of a code, the codes -127 and 127 give back exactly -scale and scale
+ */
+float dequantizeSim(int code, float scale);
+
+/**
+ * @brief Quantize the similarity values of a map on 255 levels symmetric around 0.
+ * The scale is the largest absolute value of the map, so the invalid value 1 is kept exactly
+ * when it is the largest one, and the values below the largest one stay below it.
+ * @param[in,out] simMap the similarity values, replaced by their quantized values
+ * @return the scale of the map
+ */
+float quantizeSimMap(std::vector<float>& simMap);
+
+/**
+ * @brief Read a similarity map written with any storage.
+ * The quantized maps are dequantized with their "AliceVision:simScale" metadata.
+ * @param[in] simMapFilename the similarity map file
+ * @param[out] width the map width
+ * @param[out] height the map height
+ * @param[out] simMap the similarity values, row major
+ */
+void readSimMap(const std::string& simMapFilename, int& width, int& height, std::vector<float>& simMap);
+
+/**
+ * @brief Write a depth map and its similarity map with the given storage, the files are compressed losslessly.
+ * With the compact storage, a depth map out of the half float range is written as float,
+ * its "AliceVision:depthMapStorage" metadata is then "float".
+ * @param[in] depthMapFilename the depth map file
+ * @param[in] simMapFilename the similarity map file
+ * @param[in] width the maps width
+ * @param[in] height the maps height
+ * @param[in] depthMap the depth values, row major
+ * @param[in] simMap the similarity values, row major
+ * @param[in] metadata the metadata of the depth map
+ * @param[in] storage the storage of the maps
+ */
+void writeDepthSimMaps(const std::string& depthMapFilename, const std::string& simMapFilename, int width, int height,
+                       const std::vector<float>& depthMap, const std::vector<float>& simMap,
+                       const oiio::ParamValueList& metadata, EDepthMapStorage storage);
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -0,0 +1,240 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsUtils/depthSimMapStorage.hpp>
+#include <aliceVision/imageIO/image.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE depthSimMapStorage
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::mvsUtils;
+
+namespace bfs = boost::filesystem;
+
+/**
+ * @brief Create depth and similarity maps with smooth depths, -NCC similarities and invalid pixels (-1, 1)
+ */
+void createDepthSimMaps(int width, int height, std::vector<float>& depthMap, std::vector<float>& simMap)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> simDistribution(-1.0f, 0.2f);
+  std::uniform_int_distribution<int> invalidDistribution(0, 9);
+
+  depthMap.resize(width * height);
+  simMap.resize(width * height);
+
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const int i = y * width + x;
+      if(invalidDistribution(generator) == 0)
+      {
+        depthMap[i] = -1.0f;
+        simMap[i] = 1.0f;
+        continue;
+      }
+      depthMap[i] = 5.0f + 2.0f * std::sin(0.05f * x) * std::cos(0.03f * y) + 0.01f * x;
+      simMap[i] = simDistribution(generator);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(depthSimMapStorage_enum)
+{
+  BOOST_CHECK(EDepthMapStorage_stringToEnum("float") == EDepthMapStorage::FLOAT);
+  BOOST_CHECK(EDepthMapStorage_stringToEnum("Compact") == EDepthMapStorage::COMPACT);
+  BOOST_CHECK_EQUAL(EDepthMapStorage_enumToString(EDepthMapStorage::COMPACT), "compact");
+  BOOST_CHECK_THROW(EDepthMapStorage_stringToEnum("half"), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(depthSimMapStorage_quantizeSimMap)
+{
+  std::vector<float> depthMap;
+  std::vector<float> simMap;
+  createDepthSimMaps(64, 48, depthMap, simMap);
+
+  std::vector<float> quantizedSimMap = simMap;
+  const float scale = quantizeSimMap(quantizedSimMap);
+  BOOST_CHECK_EQUAL(scale, 1.0f);
+
+  std::set<float> levels;
+  for(std::size_t i = 0; i < simMap.size(); ++i)
+  {
+    levels.insert(quantizedSimMap[i]);
+    BOOST_CHECK_LE(std::abs(quantizedSimMap[i] - simMap[i]), scale / 127.0f);
+
+    // the invalid value is kept and the valid values stay valid
+    if(simMap[i] == 1.0f)
+      BOOST_CHECK_EQUAL(quantizedSimMap[i], 1.0f);
+    else
+      BOOST_CHECK_LT(quantizedSimMap[i], 1.0f);
+  }
+  BOOST_CHECK_LE(levels.size(), 255);
+
+  // per-map scale
+  std::vector<float> smallSimMap = {-0.1f, -0.05f, 0.0f, 0.025f};
+  BOOST_CHECK_CLOSE(quantizeSimMap(smallSimMap), 0.1f, 1e-4);
+  BOOST_CHECK_EQUAL(smallSimMap[0], -0.1f);
+  BOOST_CHECK_LE(std::abs(smallSimMap[1] + 0.05f), 0.1f / 254.0f);
+  BOOST_CHECK_EQUAL(smallSimMap[2], 0.0f);
+
+  // codes of the quantized values
+  BOOST_CHECK_EQUAL(quantizeSim(1.0f, 1.0f), 127);
+  BOOST_CHECK_EQUAL(quantizeSim(0.999f, 1.0f), 126);
+  BOOST_CHECK_EQUAL(quantizeSim(-1.0f, 1.0f), -127);
+  BOOST_CHECK_EQUAL(quantizeSim(0.0f, 0.0f), 0);
+  for(int code = -127; code <= 127; ++code)
+    BOOST_CHECK_EQUAL(quantizeSim(dequantizeSim(code, 0.5f), 0.5f), code);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Write depth and similarity maps with the float and the compact storages
+// - Read them back as float and report the errors and the files sizes of the compact storage
+// - Assert that the compact similarity map stores the quantization codes and its scale,
+//   and that readSimMap() gives back the quantized similarity values
+//-----------------
+BOOST_AUTO_TEST_CASE(depthSimMapStorage_compactAccuracy)
+{
+  const int width = 320;
+  const int height = 240;
+  std::vector<float> depthMap;
+  std::vector<float> simMap;
+  createDepthSimMaps(width, height, depthMap, simMap);
+
+  const bfs::path folder = bfs::temp_directory_path() / bfs::unique_path();
+  bfs::create_directories(folder);
+
+  std::uintmax_t filesSize[2];
+  const EDepthMapStorage storages[2] = {EDepthMapStorage::FLOAT, EDepthMapStorage::COMPACT};
+
+  for(int s = 0; s < 2; ++s)
+  {
+    const std::string name = EDepthMapStorage_enumToString(storages[s]);
+    const std::string depthMapFilename = (folder / (name + "_depthMap.exr")).string();
+    const std::string simMapFilename = (folder / (name + "_simMap.exr")).string();
+    writeDepthSimMaps(depthMapFilename, simMapFilename, width, height, depthMap, simMap, oiio::ParamValueList(), storages[s]);
+    filesSize[s] = bfs::file_size(depthMapFilename) + bfs::file_size(simMapFilename);
+
+    int readWidth, readHeight;
+    std::vector<float> readDepthMap;
+    std::vector<float> readSimMap;
+    imageIO::readImage(depthMapFilename, readWidth, readHeight, readDepthMap);
+    mvsUtils::readSimMap(simMapFilename, readWidth, readHeight, readSimMap);
+    BOOST_REQUIRE_EQUAL(readDepthMap.size(), depthMap.size());
+    BOOST_REQUIRE_EQUAL(readSimMap.size(), simMap.size());
+
+    float maxDepthRelativeError = 0.0f;
+    float maxSimError = 0.0f;
+    for(std::size_t i = 0; i < depthMap.size(); ++i)
+    {
+      maxDepthRelativeError = std::max(maxDepthRelativeError, std::abs(readDepthMap[i] - depthMap[i]) / std::abs(depthMap[i]));
+      maxSimError = std::max(maxSimError, std::abs(readSimMap[i] - simMap[i]));
+      BOOST_CHECK_EQUAL(readDepthMap[i] > 0.0f, depthMap[i] > 0.0f);
+      BOOST_CHECK_EQUAL(readSimMap[i] >= 1.0f, simMap[i] >= 1.0f);
+    }
+
+    BOOST_TEST_MESSAGE(name << " storage: " << filesSize[s] << " bytes, max depth relative error: " << maxDepthRelativeError
+                       << ", max sim error: " << maxSimError);
+
+    if(storages[s] == EDepthMapStorage::FLOAT)
+    {
+      BOOST_CHECK_EQUAL(maxDepthRelativeError, 0.0f);
+    }
+    else
+    {
+      // half float relative precision
+      BOOST_CHECK_LE(maxDepthRelativeError, 1.0f / 2048.0f);
+      // the codes are exact in half float, only the quantization error remains
+      BOOST_CHECK_LE(maxSimError, 1.0f / 127.0f);
+
+      std::vector<float> quantizedSimMap = simMap;
+      quantizeSimMap(quantizedSimMap);
+      for(std::size_t i = 0; i < simMap.size(); ++i)
+        BOOST_CHECK_EQUAL(readSimMap[i], quantizedSimMap[i]);
+
+      std::vector<float> simCodes;
+      imageIO::readImage(simMapFilename, readWidth, readHeight, simCodes);
+      for(const float code : simCodes)
+      {
+        BOOST_CHECK_EQUAL(code, std::round(code));
+        BOOST_CHECK_LE(std::abs(code), 127.0f);
+      }
+
+      oiio::ParamValueList metadata;
+      imageIO::readImageMetadata(simMapFilename, metadata);
+      const auto scaleIt = metadata.find("AliceVision:simScale");
+      BOOST_REQUIRE(scaleIt != metadata.end());
+      BOOST_CHECK_EQUAL(scaleIt->get_float(), 1.0f);
+    }
+  }
+
+  BOOST_TEST_MESSAGE("compact / float files size: " << static_cast<double>(filesSize[1]) / filesSize[0]);
+  BOOST_CHECK_LT(filesSize[1], filesSize[0]);
+
+  bfs::remove_all(folder);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Write a depth map with depths above the half float maximum with the compact storage
+// - Check that it is written as float, so the depths do not overflow to infinity
+//-----------------
+BOOST_AUTO_TEST_CASE(depthSimMapStorage_compactOutOfHalfRange)
+{
+  const int width = 64;
+  const int height = 48;
+  std::vector<float> depthMap;
+  std::vector<float> simMap;
+  createDepthSimMaps(width, height, depthMap, simMap);
+
+  BOOST_CHECK(isInHalfRange(depthMap));
+
+  for(float& depth : depthMap)
+  {
+    if(depth > 0.0f)
+      depth *= 20000.0f;
+  }
+  BOOST_CHECK(!isInHalfRange(depthMap));
+
+  const bfs::path folder = bfs::temp_directory_path() / bfs::unique_path();
+  bfs::create_directories(folder);
+
+  const std::string depthMapFilename = (folder / "depthMap.exr").string();
+  const std::string simMapFilename = (folder / "simMap.exr").string();
+  writeDepthSimMaps(depthMapFilename, simMapFilename, width, height, depthMap, simMap, oiio::ParamValueList(), EDepthMapStorage::COMPACT);
+
+  int readWidth, readHeight;
+  std::vector<float> readDepthMap;
+  imageIO::readImage(depthMapFilename, readWidth, readHeight, readDepthMap);
+  BOOST_REQUIRE_EQUAL(readDepthMap.size(), depthMap.size());
+
+  for(std::size_t i = 0; i < depthMap.size(); ++i)
+  {
+    BOOST_CHECK(std::isfinite(readDepthMap[i]));
+    BOOST_CHECK_EQUAL(readDepthMap[i], depthMap[i]);
+  }
+
+  oiio::ParamValueList metadata;
+  imageIO::readImageMetadata(depthMapFilename, metadata);
+  const auto storageIt = metadata.find("AliceVision:depthMapStorage");
+  BOOST_REQUIRE(storageIt != metadata.end());
+  BOOST_CHECK_EQUAL(storageIt->get_string(), "float");
+
+  bfs::remove_all(folder);
+}
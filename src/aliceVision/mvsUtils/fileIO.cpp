@@ -324,9 +324,8 @@ Matrix3x4 load3x4MatrixFromFile(FILE* fi)
 
 void memcpyRGBImageFromFileToArr(int camId, Color* imgArr, const std::string& fileNameOrigStr, const MultiViewParams* mp, int bandType)
 {
-    int origWidth, origHeight;
-    std::vector<Color> cimg;
-    imageIO::readImage(fileNameOrigStr, origWidth, origHeight, cimg);
+    int origWidth, origHeight, origNChannels;
+    imageIO::readImageSpec(fileNameOrigStr, origWidth, origHeight, origNChannels);
 
     // check image size
     if((mp->getOriginalWidth(camId) != origWidth) || (mp->getOriginalHeight(camId) != origHeight))
@@ -345,12 +344,15 @@ void memcpyRGBImageFromFileToArr(int camId, Color* imgArr, const std::string& fi
     const int height = mp->getHeight(camId);
 
     if(processScale > 1)
-    {
         ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp->getViewId(camId) << ".");
-        std::vector<Color> bmpr;
-        imageIO::resizeImage(origWidth, origHeight, processScale, cimg, bmpr);
-        cimg = bmpr;
-    }
+
+    // read the image at the process scale
+    int readWidth, readHeight;
+    std::vector<Color> cimg;
+    imageIO::readImageDownscaled(fileNameOrigStr, processScale, readWidth, readHeight, cimg);
+
+    if((readWidth != width) || (readHeight != height))
+        throw std::runtime_error("Bad downscaled image dimension for camera : " + std::to_string(camId) + " (" + fileNameOrigStr + ")");
 
     if(bandType == 1)
     {
@@ -7,6 +7,7 @@
 
 #include "generateReport.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
 #include <dependencies/histogram/histogram.hpp>
@@ -23,26 +24,17 @@ bool generateSfMReport(const sfmData::SfMData& sfmData,
                        const std::string& htmlFilename)
 {
   // Compute mean,max,median residual values per View
+  HashMap<IndexT, Mat2X> residualsMatPerView;
+  computeResidualsPerView(sfmData, residualsMatPerView);
+
   IndexT residualCount = 0;
   HashMap< IndexT, std::vector<double> > residuals_per_view;
-  for(sfmData::Landmarks::const_iterator iterTracks = sfmData.getLandmarks().begin();
-    iterTracks != sfmData.getLandmarks().end();
-    ++iterTracks
-  )
+  for(const auto& residualsPair : residualsMatPerView)
   {
-    const sfmData::Observations & observations = iterTracks->second.observations;
-    for(sfmData::Observations::const_iterator itObs = observations.begin();
-      itObs != observations.end(); ++itObs)
-    {
-      const sfmData::View * view = sfmData.getViews().at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId()).get();
-      // Use absolute values
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x).array().abs();
-      residuals_per_view[itObs->first].push_back(residual(0));
-      residuals_per_view[itObs->first].push_back(residual(1));
-      ++residualCount;
-    }
+    // Use absolute values (interleaved x, y residuals)
+    const Mat2X residuals = residualsPair.second.cwiseAbs();
+    residuals_per_view[residualsPair.first].assign(residuals.data(), residuals.data() + residuals.size());
+    residualCount += residuals.cols();
   }
   using namespace htmlDocument;
   // extract directory from htmlFilename
@@ -6,6 +6,8 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "regionsIO.hpp"
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 
 #include <boost/progress.hpp>
 #include <boost/filesystem.hpp>
@@ -124,6 +126,9 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
             const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
             const std::set<IndexT>& viewIdFilter)
 {
+  ALICEVISION_PROFILE_ZONE("sfm::loadRegions");
+  ALICEVISION_MEMORY_PHASE("sfm::loadRegions");
+
   std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders(); // add sfm features folders
   featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end()); // add user features folders
 
@@ -172,6 +177,9 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
                       const std::vector<std::string>& folders,
                       const std::vector<feature::EImageDescriberType>& imageDescriberTypes)
 {
+  ALICEVISION_PROFILE_ZONE("sfm::loadFeatures");
+  ALICEVISION_MEMORY_PHASE("sfm::loadFeatures");
+
   std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders(); // add sfm features folders
   featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end()); // add user features folders
 
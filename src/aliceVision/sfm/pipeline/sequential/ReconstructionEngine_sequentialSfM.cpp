@@ -25,6 +25,8 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cpu.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/config.hpp>
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
@@ -149,6 +151,9 @@ ReconstructionEngine_sequentialSfM::ReconstructionEngine_sequentialSfM(
 
 bool ReconstructionEngine_sequentialSfM::process()
 {
+  ALICEVISION_PROFILE_ZONE("sfm::incrementalSfM");
+  ALICEVISION_MEMORY_PHASE("sfm::incrementalSfM");
+
   initializePyramidScoring();
 
   if(fuseMatchesIntoTracks() == 0)
@@ -217,6 +222,8 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
 
 std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
 {
+  ALICEVISION_PROFILE_ZONE("sfm::fuseMatchesIntoTracks");
+
   // compute tracks from matches
   track::TracksBuilder tracksBuilder;
 
@@ -291,6 +298,8 @@ std::vector<Pair> ReconstructionEngine_sequentialSfM::getInitialImagePairsCandid
 
 void ReconstructionEngine_sequentialSfM::createInitialReconstruction(const std::vector<Pair>& initialImagePairCandidates)
 {
+  ALICEVISION_PROFILE_ZONE("sfm::initialReconstruction");
+
   // initial pair Essential Matrix and [R|t] estimation.
   for(const auto& initialPairCandidate: initialImagePairCandidates)
   {
@@ -363,6 +372,8 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
 
 double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 {
+  ALICEVISION_PROFILE_ZONE("sfm::incrementalReconstruction");
+
   IndexT resectionId = 0;
 
   std::set<IndexT> remainingViewIds;
@@ -576,6 +587,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 
 void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& prevReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
+  ALICEVISION_PROFILE_ZONE("sfm::triangulate");
+
   auto chrono_start = std::chrono::steady_clock::now();
 
   // allow to use to the old triangulatation algorithm (using 2 views only)
@@ -589,6 +602,9 @@ void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& pre
 
 bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newReconstructedViews, bool isInitialPair)
 {
+  ALICEVISION_PROFILE_ZONE("sfm::bundleAdjustment");
+  ALICEVISION_MEMORY_PHASE("sfm::bundleAdjustment");
+
   ALICEVISION_LOG_INFO("Bundle adjustment start.");
   auto chronoStart = std::chrono::steady_clock::now();
 
@@ -781,6 +797,23 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
     _jsonLogTree.put("hardware.cpu.cores", system::get_total_cpus());        // cpu cores
     _jsonLogTree.put("hardware.ram.size", system::getMemoryInfo().totalRam); // ram size
 
+    // peak memory of the process and of the ended memory phases
+    _jsonLogTree.put("memory.peakRss", system::getPeakUsedMemory());
+    _jsonLogTree.put("memory.budget", system::MemoryTracker::getInstance().getBudget());
+    pt::ptree phasesTree;
+    for(const system::MemoryTracker::PhaseStats& phase : system::MemoryTracker::getInstance().getPhases())
+    {
+      pt::ptree phaseTree;
+      phaseTree.put("name", phase.name);
+      phaseTree.put("count", phase.count);
+      phaseTree.put("peakRss", phase.peakRss);
+      phaseTree.put("maxRssIncrease", phase.maxRssIncrease);
+      phaseTree.put("peakTrackedBytes", phase.peakTrackedBytes);
+      phaseTree.put("duration", phase.duration);
+      phasesTree.push_back(std::make_pair("", phaseTree));
+    }
+    _jsonLogTree.put_child("memory.phases", phasesTree);
+
     // write json on disk
     pt::write_json((fs::path(_outputFolder) / "stats.json").string(), _jsonLogTree);
   }
@@ -890,6 +923,8 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   std::vector<IndexT> & out_selectedViewIds,
   const std::set<IndexT>& remainingViewIds) const
 {
+  ALICEVISION_PROFILE_ZONE("sfm::findNextBestViews");
+
   out_selectedViewIds.clear();
   auto chrono_start = std::chrono::steady_clock::now();
   std::vector<ViewConnectionScore> vec_viewsScore;
@@ -1153,6 +1188,8 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPa
 
 bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pair>& out_bestImagePairs, IndexT filterViewId) const
 {
+  ALICEVISION_PROFILE_ZONE("sfm::bestInitialImagePairs");
+
   // From the k view pairs with the highest number of verified matches
   // select a pair that have the largest baseline (mean angle between its bearing vectors).
   
@@ -1439,6 +1476,8 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
  */
 bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewIndex, ResectionData& resectionData)
 {
+  ALICEVISION_PROFILE_ZONE("sfm::resection");
+
   using namespace track;
 
   // A. Compute 2D/3D matches
@@ -1985,6 +2024,8 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
 
 std::size_t ReconstructionEngine_sequentialSfM::removeOutliers(double precision)
 {
+  ALICEVISION_PROFILE_ZONE("sfm::removeOutliers");
+
   const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, precision, 2);
   const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, _minAngleForLandmark);
 
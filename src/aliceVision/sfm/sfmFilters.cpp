@@ -11,6 +11,8 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <iterator>
+#include <stdexcept>
+#include <vector>
 
 namespace aliceVision {
 namespace sfm {
@@ -19,22 +21,53 @@ IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
                                          const double dThresholdPixel,
                                          const unsigned int minTrackLength)
 {
+  // gather view poses and intrinsics once
+  HashMap<IndexT, std::size_t> viewIndexes;
+  std::vector<geometry::Pose3> poses;
+  std::vector<const camera::IntrinsicBase*> intrinsics;
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View* view = viewPair.second.get();
+    if(!sfmData.isPoseAndIntrinsicDefined(view))
+      continue;
+    viewIndexes[viewPair.first] = poses.size();
+    poses.push_back(sfmData.getPose(*view).getTransform());
+    intrinsics.push_back(sfmData.getIntrinsics().at(view->getIntrinsicId()).get());
+  }
+
+  // each landmark is filtered in place by a single thread
+  std::vector<sfmData::Landmark*> landmarks;
+  landmarks.reserve(sfmData.structure.size());
+  for(auto& landmarkPair : sfmData.structure)
+    landmarks.push_back(&landmarkPair.second);
+
+  const int nbLandmarks = static_cast<int>(landmarks.size());
   IndexT outlier_count = 0;
-  sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
+  // exceptions can't leave the parallel loop
+  bool undefinedView = false;
 
-  while(iterTracks != sfmData.structure.end())
+  #pragma omp parallel for reduction(+:outlier_count)
+  for(int i = 0; i < nbLandmarks; ++i)
   {
-    sfmData::Observations & observations = iterTracks->second.observations;
+    const Vec3& X = landmarks[i]->X;
+    sfmData::Observations & observations = landmarks[i]->observations;
     sfmData::Observations::iterator itObs = observations.begin();
 
     while(itObs != observations.end())
     {
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x);
+      const auto itView = viewIndexes.find(itObs->first);
+      if(itView == viewIndexes.end())
+      {
+        #pragma omp critical
+        undefinedView = true;
+        ++itObs;
+        continue;
+      }
+      const std::size_t viewIndex = itView->second;
+      const geometry::Pose3& pose = poses[viewIndex];
+      const Vec2 residual = intrinsics[viewIndex]->residual(pose, X, itObs->second.x);
 
-      if((pose.depth(iterTracks->second.X) < 0) || (residual.norm() > dThresholdPixel))
+      if((pose.depth(X) < 0) || (residual.norm() > dThresholdPixel))
       {
         ++outlier_count;
         itObs = observations.erase(itObs);
@@ -42,12 +75,21 @@ IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
       else
         ++itObs;
     }
+  }
+
+  if(undefinedView)
+    throw std::out_of_range("RemoveOutliers_PixelResidualError: observation in a view without pose or intrinsic");
 
-    if (observations.empty() || observations.size() < minTrackLength)
+  sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
+  while(iterTracks != sfmData.structure.end())
+  {
+    const sfmData::Observations & observations = iterTracks->second.observations;
+    if(observations.empty() || observations.size() < minTrackLength)
       iterTracks = sfmData.structure.erase(iterTracks);
     else
       ++iterTracks;
   }
+
   return outlier_count;
 }
 
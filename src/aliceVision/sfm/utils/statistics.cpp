@@ -7,32 +7,55 @@
 
 #include "statistics.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksStore.hpp>
 
 namespace aliceVision {
 namespace sfm {
 
+void computeResidualsPerView(const sfmData::SfMData& sfmData, HashMap<IndexT, Mat2X>& residualsPerView)
+{
+  const sfmData::LandmarksStore store(sfmData.getLandmarks());
+  const std::vector<IndexT>& viewIds = store.getViewIds();
+
+  residualsPerView.clear();
+
+  // gather view poses and intrinsics once
+  std::vector<geometry::Pose3> poses;
+  std::vector<const camera::IntrinsicBase*> intrinsics;
+  store.getViewCameras(sfmData, poses, intrinsics);
+
+  std::vector<Mat2X*> residuals;
+  residuals.reserve(viewIds.size());
+  for(const IndexT viewId : viewIds)
+    residuals.push_back(&residualsPerView[viewId]);
+
+  const int nbViews = static_cast<int>(viewIds.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int v = 0; v < nbViews; ++v)
+  {
+    Mat3X X;
+    Mat2X x;
+    store.getViewObservations(v, X, x);
+
+    *residuals[v] = intrinsics[v]->residuals(poses[v], X, x);
+  }
+}
+
 double RMSE(const sfmData::SfMData& sfmData)
 {
   // Compute residuals for each observation
-  std::vector<double> vec;
-  for(sfmData::Landmarks::const_iterator iterTracks = sfmData.getLandmarks().begin();
-      iterTracks != sfmData.getLandmarks().end();
-      ++iterTracks)
+  HashMap<IndexT, Mat2X> residualsPerView;
+  computeResidualsPerView(sfmData, residualsPerView);
+
+  double squaredNorm = 0.0;
+  std::size_t nbResiduals = 0;
+  for(const auto& residualsPair : residualsPerView)
   {
-    const sfmData::Observations& obs = iterTracks->second.observations;
-    for(sfmData::Observations::const_iterator itObs = obs.begin();
-      itObs != obs.end(); ++itObs)
-    {
-      const sfmData::View* view = sfmData.getViews().find(itObs->first)->second.get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const std::shared_ptr<camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().at(view->getIntrinsicId());
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x);
-      vec.push_back(residual(0));
-      vec.push_back(residual(1));
-    }
+    squaredNorm += residualsPair.second.squaredNorm();
+    nbResiduals += residualsPair.second.size();
   }
-  const Eigen::Map<Eigen::RowVectorXd> residuals(&vec[0], vec.size());
-  const double RMSE = std::sqrt(residuals.squaredNorm() / vec.size());
+  const double RMSE = std::sqrt(squaredNorm / nbResiduals);
   return RMSE;
 }
 
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/types.hpp>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -15,6 +18,14 @@ class SfMData;
 
 namespace sfm {
 
+/**
+ * @brief Compute the reprojection residuals of all the observations, grouped by view.
+ * Observations of each view are projected in a single batch (views are processed in parallel).
+ * @param[in] sfmData The given input SfMData
+ * @param[out] residualsPerView The residuals of each view (one observation per column)
+ */
+void computeResidualsPerView(const sfmData::SfMData& sfmData, HashMap<IndexT, Mat2X>& residualsPerView);
+
 /**
  * @brief Compute the Root Mean Square Error of the residuals
  * @param[in] sfmData The given input SfMData
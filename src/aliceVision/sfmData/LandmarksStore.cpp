@@ -0,0 +1,183 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarksStore.hpp"
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace sfmData {
+
+void LandmarksStore::fill(const Landmarks& landmarks)
+{
+  clear();
+
+  // the landmarks container is not ordered, sort by id for findLandmarkIndex
+  std::vector<const Landmarks::value_type*> sortedLandmarks;
+  sortedLandmarks.reserve(landmarks.size());
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkPair : landmarks)
+  {
+    sortedLandmarks.push_back(&landmarkPair);
+    nbObservations += landmarkPair.second.observations.size();
+  }
+  std::sort(sortedLandmarks.begin(), sortedLandmarks.end(),
+            [](const Landmarks::value_type* a, const Landmarks::value_type* b) { return a->first < b->first; });
+
+  const std::size_t nbLandmarks = landmarks.size();
+
+  _landmarkIds.reserve(nbLandmarks);
+  _positions.reserve(nbLandmarks);
+  _colors.reserve(nbLandmarks);
+  _descTypes.reserve(nbLandmarks);
+  _obsOffsets.reserve(nbLandmarks + 1);
+
+  _obsViewIds.reserve(nbObservations);
+  _obsFeatureIds.reserve(nbObservations);
+  _obsPoints.reserve(nbObservations);
+
+  for(const Landmarks::value_type* landmarkPair : sortedLandmarks)
+  {
+    const Landmark& landmark = landmarkPair->second;
+
+    _landmarkIds.push_back(landmarkPair->first);
+    _positions.push_back(landmark.X);
+    _colors.push_back(landmark.rgb);
+    _descTypes.push_back(static_cast<std::uint8_t>(landmark.descType));
+
+    // observations are already sorted by view id (flat_map)
+    for(const auto& observationPair : landmark.observations)
+    {
+      _obsViewIds.push_back(observationPair.first);
+      _obsFeatureIds.push_back(observationPair.second.id_feat);
+      _obsPoints.push_back(observationPair.second.x);
+    }
+    _obsOffsets.push_back(static_cast<IndexT>(_obsViewIds.size()));
+  }
+
+  buildViewIndex();
+}
+
+void LandmarksStore::clear()
+{
+  _landmarkIds.clear();
+  _positions.clear();
+  _colors.clear();
+  _descTypes.clear();
+
+  _obsOffsets.assign(1, 0);
+  _obsViewIds.clear();
+  _obsFeatureIds.clear();
+  _obsPoints.clear();
+
+  _viewIds.clear();
+  _viewObsOffsets.assign(1, 0);
+  _viewObsIndexes.clear();
+}
+
+IndexT LandmarksStore::findLandmarkIndex(IndexT landmarkId) const
+{
+  const auto it = std::lower_bound(_landmarkIds.begin(), _landmarkIds.end(), landmarkId);
+  if(it == _landmarkIds.end() || *it != landmarkId)
+    return UndefinedIndexT;
+  return static_cast<IndexT>(std::distance(_landmarkIds.begin(), it));
+}
+
+std::size_t LandmarksStore::getObservationLandmarkIndex(std::size_t obsIndex) const
+{
+  // first offset strictly greater than obsIndex is the end of its landmark
+  const auto it = std::upper_bound(_obsOffsets.begin(), _obsOffsets.end(), static_cast<IndexT>(obsIndex));
+  return std::distance(_obsOffsets.begin(), it) - 1;
+}
+
+IndexT LandmarksStore::findViewIndex(IndexT viewId) const
+{
+  const auto it = std::lower_bound(_viewIds.begin(), _viewIds.end(), viewId);
+  if(it == _viewIds.end() || *it != viewId)
+    return UndefinedIndexT;
+  return static_cast<IndexT>(std::distance(_viewIds.begin(), it));
+}
+
+void LandmarksStore::getViewCameras(const SfMData& sfmData,
+                                    std::vector<geometry::Pose3>& poses,
+                                    std::vector<const camera::IntrinsicBase*>& intrinsics) const
+{
+  poses.clear();
+  intrinsics.clear();
+  poses.reserve(_viewIds.size());
+  intrinsics.reserve(_viewIds.size());
+
+  for(const IndexT viewId : _viewIds)
+  {
+    const View* view = sfmData.getViews().at(viewId).get();
+    poses.push_back(sfmData.getPose(*view).getTransform());
+    intrinsics.push_back(sfmData.getIntrinsics().at(view->getIntrinsicId()).get());
+  }
+}
+
+void LandmarksStore::getViewObservations(std::size_t viewIndex, Mat3X& X, Mat2X& x) const
+{
+  const std::size_t begin = _viewObsOffsets[viewIndex];
+  const std::size_t nbObservations = _viewObsOffsets[viewIndex + 1] - begin;
+
+  X.resize(3, nbObservations);
+  x.resize(2, nbObservations);
+
+  for(std::size_t i = 0; i < nbObservations; ++i)
+  {
+    const std::size_t obsIndex = _viewObsIndexes[begin + i];
+    X.col(i) = _positions[getObservationLandmarkIndex(obsIndex)];
+    x.col(i) = _obsPoints[obsIndex];
+  }
+}
+
+std::size_t LandmarksStore::getMemorySize() const
+{
+  return _landmarkIds.capacity() * sizeof(IndexT) +
+         _positions.capacity() * sizeof(Vec3) +
+         _colors.capacity() * sizeof(image::RGBColor) +
+         _descTypes.capacity() * sizeof(std::uint8_t) +
+         _obsOffsets.capacity() * sizeof(IndexT) +
+         _obsViewIds.capacity() * sizeof(IndexT) +
+         _obsFeatureIds.capacity() * sizeof(IndexT) +
+         _obsPoints.capacity() * sizeof(Vec2) +
+         _viewIds.capacity() * sizeof(IndexT) +
+         _viewObsOffsets.capacity() * sizeof(IndexT) +
+         _viewObsIndexes.capacity() * sizeof(IndexT);
+}
+
+void LandmarksStore::buildViewIndex()
+{
+  _viewIds = _obsViewIds;
+  std::sort(_viewIds.begin(), _viewIds.end());
+  _viewIds.erase(std::unique(_viewIds.begin(), _viewIds.end()), _viewIds.end());
+  _viewIds.shrink_to_fit();
+
+  // count observations per view
+  _viewObsOffsets.assign(_viewIds.size() + 1, 0);
+  std::vector<IndexT> obsViewIndexes(_obsViewIds.size());
+
+  for(std::size_t o = 0; o < _obsViewIds.size(); ++o)
+  {
+    const IndexT viewIndex = findViewIndex(_obsViewIds[o]);
+    obsViewIndexes[o] = viewIndex;
+    ++_viewObsOffsets[viewIndex + 1];
+  }
+
+  // prefix sum
+  for(std::size_t v = 0; v < _viewIds.size(); ++v)
+    _viewObsOffsets[v + 1] += _viewObsOffsets[v];
+
+  // scatter observation indexes (stable: sorted by landmark index for each view)
+  std::vector<IndexT> cursor(_viewObsOffsets.begin(), _viewObsOffsets.end() - 1);
+  _viewObsIndexes.resize(_obsViewIds.size());
+
+  for(std::size_t o = 0; o < _obsViewIds.size(); ++o)
+    _viewObsIndexes[cursor[obsViewIndexes[o]]++] = static_cast<IndexT>(o);
+}
+
+} // namespace sfmData
+} // namespace aliceVision
@@ -0,0 +1,173 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/image/pixelTypes.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/types.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmData {
+
+/**
+ * @brief Compact structure-of-arrays copy of a Landmarks collection.
+ *
+ * Landmark attributes are stored in contiguous arrays indexed by a dense landmark index,
+ * landmarks being sorted by increasing landmark id.
+ * Observations are stored in a CSR table indexed by landmark:
+ * observations of the landmark i are in [getObservationsBegin(i), getObservationsEnd(i)).
+ * A second CSR table gives, for each view, the list of observation indexes seeing this view.
+ *
+ * This store is a read-only snapshot of the Landmarks container: it is filled from it
+ * to run cache-friendly (and parallel) read passes, like the residuals computation.
+ * Passes which modify the landmarks keep working on the Landmarks container.
+ */
+class LandmarksStore
+{
+public:
+  LandmarksStore()
+  {
+    clear();
+  }
+
+  explicit LandmarksStore(const Landmarks& landmarks)
+  {
+    fill(landmarks);
+  }
+
+  /**
+   * @brief Fill the store from a Landmarks collection (previous content is discarded),
+   * the landmarks are sorted by id
+   * @param[in] landmarks The source landmarks
+   */
+  void fill(const Landmarks& landmarks);
+
+  /**
+   * @brief Clear the store
+   */
+  void clear();
+
+  // Landmarks
+
+  inline std::size_t getNbLandmarks() const { return _landmarkIds.size(); }
+  inline IndexT getLandmarkId(std::size_t landmarkIndex) const { return _landmarkIds[landmarkIndex]; }
+
+  inline const Vec3& getPosition(std::size_t landmarkIndex) const { return _positions[landmarkIndex]; }
+  inline Vec3& getPosition(std::size_t landmarkIndex) { return _positions[landmarkIndex]; }
+
+  inline const image::RGBColor& getColor(std::size_t landmarkIndex) const { return _colors[landmarkIndex]; }
+  inline image::RGBColor& getColor(std::size_t landmarkIndex) { return _colors[landmarkIndex]; }
+
+  inline feature::EImageDescriberType getDescType(std::size_t landmarkIndex) const
+  {
+    return static_cast<feature::EImageDescriberType>(_descTypes[landmarkIndex]);
+  }
+
+  /**
+   * @brief Get the dense index of a landmark id (binary search)
+   * @param[in] landmarkId The landmark id
+   * @return the landmark index or UndefinedIndexT if not found
+   */
+  IndexT findLandmarkIndex(IndexT landmarkId) const;
+
+  // Observations (CSR by landmark)
+
+  inline std::size_t getNbObservations() const { return _obsViewIds.size(); }
+  inline std::size_t getObservationsBegin(std::size_t landmarkIndex) const { return _obsOffsets[landmarkIndex]; }
+  inline std::size_t getObservationsEnd(std::size_t landmarkIndex) const { return _obsOffsets[landmarkIndex + 1]; }
+  inline std::size_t getNbObservations(std::size_t landmarkIndex) const
+  {
+    return _obsOffsets[landmarkIndex + 1] - _obsOffsets[landmarkIndex];
+  }
+
+  inline IndexT getObservationViewId(std::size_t obsIndex) const { return _obsViewIds[obsIndex]; }
+  inline IndexT getObservationFeatureId(std::size_t obsIndex) const { return _obsFeatureIds[obsIndex]; }
+  inline const Vec2& getObservationPoint(std::size_t obsIndex) const { return _obsPoints[obsIndex]; }
+  inline Vec2& getObservationPoint(std::size_t obsIndex) { return _obsPoints[obsIndex]; }
+
+  /**
+   * @brief Get the landmark index of an observation (binary search in the CSR offsets)
+   * @param[in] obsIndex The observation index
+   * @return the landmark index
+   */
+  std::size_t getObservationLandmarkIndex(std::size_t obsIndex) const;
+
+  // Observations (CSR by view)
+
+  /// Sorted list of the view ids observed by at least one landmark
+  inline const std::vector<IndexT>& getViewIds() const { return _viewIds; }
+
+  /**
+   * @brief Get the dense index of a view id (binary search)
+   * @param[in] viewId The view id
+   * @return the view index or UndefinedIndexT if no landmark is observed in this view
+   */
+  IndexT findViewIndex(IndexT viewId) const;
+
+  inline std::size_t getViewObservationsBegin(std::size_t viewIndex) const { return _viewObsOffsets[viewIndex]; }
+  inline std::size_t getViewObservationsEnd(std::size_t viewIndex) const { return _viewObsOffsets[viewIndex + 1]; }
+
+  /**
+   * @brief Get an observation index from the view CSR table
+   * @param[in] i Position in [getViewObservationsBegin(viewIndex), getViewObservationsEnd(viewIndex))
+   * @return the observation index
+   */
+  inline std::size_t getViewObservation(std::size_t i) const { return _viewObsIndexes[i]; }
+
+  /**
+   * @brief Get the pose and the intrinsic of each view observed by the store
+   * @param[in] sfmData The SfMData the store is filled from
+   * @param[out] poses The view poses, by view index
+   * @param[out] intrinsics The view intrinsics, by view index
+   */
+  void getViewCameras(const SfMData& sfmData,
+                      std::vector<geometry::Pose3>& poses,
+                      std::vector<const camera::IntrinsicBase*>& intrinsics) const;
+
+  /**
+   * @brief Gather the observations of a view, to project them in a single batch
+   * @param[in] viewIndex The view index
+   * @param[out] X The positions of the observed landmarks, one per column
+   * @param[out] x The observed points, one per column
+   */
+  void getViewObservations(std::size_t viewIndex, Mat3X& X, Mat2X& x) const;
+
+  /**
+   * @brief Memory used by the store arrays
+   * @return size in bytes
+   */
+  std::size_t getMemorySize() const;
+
+private:
+  /// Rebuild the view CSR table from the landmark CSR table
+  void buildViewIndex();
+
+  // landmark attributes
+  std::vector<IndexT> _landmarkIds;
+  std::vector<Vec3> _positions;
+  std::vector<image::RGBColor> _colors;
+  std::vector<std::uint8_t> _descTypes;
+
+  // observations CSR by landmark
+  std::vector<IndexT> _obsOffsets;
+  std::vector<IndexT> _obsViewIds;
+  std::vector<IndexT> _obsFeatureIds;
+  std::vector<Vec2, Eigen::aligned_allocator<Vec2> > _obsPoints;
+
+  // observations CSR by view
+  std::vector<IndexT> _viewIds;
+  std::vector<IndexT> _viewObsOffsets;
+  std::vector<IndexT> _viewObsIndexes;
+};
+
+} // namespace sfmData
+} // namespace aliceVision
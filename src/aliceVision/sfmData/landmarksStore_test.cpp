@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/LandmarksStore.hpp>
+
+#define BOOST_TEST_MODULE sfmDataLandmarksStore
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfmData;
+
+Landmarks createLandmarks()
+{
+  Landmarks landmarks;
+  for(IndexT i = 0; i < 10; ++i)
+  {
+    Landmark& landmark = landmarks[i * 3];
+    landmark.X = Vec3(i, 2.0 * i, 3.0 * i);
+    landmark.descType = feature::EImageDescriberType::SIFT;
+    landmark.rgb = image::RGBColor(i, 0, 255);
+
+    // landmark i is seen by views [0, i % 4 + 1]
+    for(IndexT v = 0; v <= i % 4 + 1; ++v)
+      landmark.observations[v * 10] = Observation(Vec2(i, v), i * 100 + v);
+  }
+  return landmarks;
+}
+
+BOOST_AUTO_TEST_CASE(LandmarksStore_fill)
+{
+  const Landmarks landmarks = createLandmarks();
+  const LandmarksStore store(landmarks);
+
+  BOOST_CHECK_EQUAL(store.getNbLandmarks(), landmarks.size());
+
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkPair : landmarks)
+    nbObservations += landmarkPair.second.observations.size();
+  BOOST_CHECK_EQUAL(store.getNbObservations(), nbObservations);
+
+  for(std::size_t i = 0; i < store.getNbLandmarks(); ++i)
+  {
+    // sorted by landmark id
+    if(i > 0)
+      BOOST_CHECK_LT(store.getLandmarkId(i - 1), store.getLandmarkId(i));
+
+    const Landmark& landmark = landmarks.at(store.getLandmarkId(i));
+    BOOST_CHECK(store.getPosition(i) == landmark.X);
+    BOOST_CHECK(store.getColor(i) == landmark.rgb);
+    BOOST_CHECK(store.getDescType(i) == landmark.descType);
+    BOOST_REQUIRE_EQUAL(store.getNbObservations(i), landmark.observations.size());
+
+    std::size_t o = store.getObservationsBegin(i);
+    for(const auto& observationPair : landmark.observations)
+    {
+      BOOST_CHECK_EQUAL(store.getObservationViewId(o), observationPair.first);
+      BOOST_CHECK_EQUAL(store.getObservationFeatureId(o), observationPair.second.id_feat);
+      BOOST_CHECK(store.getObservationPoint(o) == observationPair.second.x);
+      BOOST_CHECK_EQUAL(store.getObservationLandmarkIndex(o), i);
+      ++o;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LandmarksStore_findLandmarkIndex)
+{
+  // ids inserted in decreasing order, the container does not keep them sorted
+  Landmarks landmarks;
+  for(IndexT i = 0; i < 100; ++i)
+    landmarks[(100 - i) * 7].X = Vec3(i, 0.0, 0.0);
+  const LandmarksStore store(landmarks);
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const IndexT landmarkIndex = store.findLandmarkIndex(landmarkPair.first);
+    BOOST_REQUIRE_NE(landmarkIndex, UndefinedIndexT);
+    BOOST_CHECK_EQUAL(store.getLandmarkId(landmarkIndex), landmarkPair.first);
+    BOOST_CHECK(store.getPosition(landmarkIndex) == landmarkPair.second.X);
+  }
+  BOOST_CHECK_EQUAL(store.findLandmarkIndex(3), UndefinedIndexT);
+  BOOST_CHECK_EQUAL(store.findLandmarkIndex(10000), UndefinedIndexT);
+}
+
+BOOST_AUTO_TEST_CASE(LandmarksStore_viewIndex)
+{
+  const Landmarks landmarks = createLandmarks();
+  const LandmarksStore store(landmarks);
+
+  BOOST_CHECK_EQUAL(store.getViewIds().size(), 5);
+  BOOST_CHECK_EQUAL(store.findViewIndex(7), UndefinedIndexT);
+
+  for(std::size_t v = 0; v < store.getViewIds().size(); ++v)
+  {
+    const IndexT viewId = store.getViewIds()[v];
+    BOOST_CHECK_EQUAL(store.findViewIndex(viewId), v);
+
+    std::size_t nbExpected = 0;
+    for(const auto& landmarkPair : landmarks)
+      nbExpected += landmarkPair.second.observations.count(viewId);
+
+    BOOST_CHECK_EQUAL(store.getViewObservationsEnd(v) - store.getViewObservationsBegin(v), nbExpected);
+
+    for(std::size_t i = store.getViewObservationsBegin(v); i < store.getViewObservationsEnd(v); ++i)
+    {
+      const std::size_t obsIndex = store.getViewObservation(i);
+      BOOST_CHECK_EQUAL(store.getObservationViewId(obsIndex), viewId);
+
+      const std::size_t landmarkIndex = store.getObservationLandmarkIndex(obsIndex);
+      const Landmark& landmark = landmarks.at(store.getLandmarkId(landmarkIndex));
+      BOOST_CHECK_EQUAL(landmark.observations.at(viewId).id_feat, store.getObservationFeatureId(obsIndex));
+    }
+  }
+}
@@ -0,0 +1,140 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Thread-safe FIFO queue with a maximum size, used to connect the stages of a pipeline.
+ *
+ * Producers block in push() while the queue is full, consumers block in pop() while it is empty.
+ * Once close() has been called, push() fails and pop() returns the remaining elements
+ * then fails, so consumers can stop when all the producers are done.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+  explicit BoundedQueue(std::size_t capacity)
+    : _capacity(capacity > 0 ? capacity : 1)
+  {}
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /**
+   * @brief Add an element, wait while the queue is full
+   * @param[in] value The element to add (moved)
+   * @return false if the queue has been closed
+   */
+  bool push(T value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]{ return _closed || _queue.size() < _capacity; });
+    if(_closed)
+      return false;
+    _queue.push_back(std::move(value));
+    lock.unlock();
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Add an element if the queue is not full
+   * @param[in,out] value The element to add (moved if added)
+   * @return false if the queue is full or closed
+   */
+  bool tryPush(T& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if(_closed || _queue.size() >= _capacity)
+      return false;
+    _queue.push_back(std::move(value));
+    lock.unlock();
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Get the oldest element, wait while the queue is empty
+   * @param[out] value The element
+   * @return false if the queue is closed and empty
+   */
+  bool pop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]{ return _closed || !_queue.empty(); });
+    if(_queue.empty())
+      return false;
+    value = std::move(_queue.front());
+    _queue.pop_front();
+    lock.unlock();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Get the oldest element if any
+   * @param[out] value The element
+   * @return false if the queue is empty
+   */
+  bool tryPop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if(_queue.empty())
+      return false;
+    value = std::move(_queue.front());
+    _queue.pop_front();
+    lock.unlock();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Close the queue: wake up all the waiting threads, no more element can be added
+   */
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+    }
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+  }
+
+  bool isClosed() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _closed;
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+  }
+
+  std::size_t capacity() const { return _capacity; }
+
+private:
+  const std::size_t _capacity;
+  bool _closed = false;
+  std::deque<T> _queue;
+  mutable std::mutex _mutex;
+  std::condition_variable _notEmpty;
+  std::condition_variable _notFull;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,200 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ImageCache.hpp"
+#include "MemoryTracker.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifndef _WIN32
+# include <sys/stat.h>
+#endif
+
+namespace aliceVision {
+namespace system {
+
+ImageCache& ImageCache::getInstance()
+{
+    // the memory tracker is created first to outlive the cache
+    MemoryTracker::getInstance();
+    static ImageCache instance([]
+    {
+        const char* maxMB = std::getenv("ALICEVISION_IMAGE_CACHE_MB");
+        return (maxMB == nullptr) ? std::size_t(0) : static_cast<std::size_t>(std::max(0L, std::atol(maxMB))) * 1024 * 1024;
+    }());
+    // removed before the destruction of the cache
+    static const ScopedBudgetListener budgetListener([](std::size_t bytes) { instance.shrink(bytes); });
+    return instance;
+}
+
+std::string ImageCache::getFileStamp(const std::string& path)
+{
+#ifdef _WIN32
+    boost::system::error_code ec;
+    const std::time_t time = boost::filesystem::last_write_time(path, ec);
+    if(ec)
+        return std::string();
+    const boost::uintmax_t size = boost::filesystem::file_size(path, ec);
+    if(ec)
+        return std::string();
+    return std::to_string(time) + ":" + std::to_string(size);
+#else
+    struct stat status;
+    if(::stat(path.c_str(), &status) != 0)
+        return std::string();
+#if defined(__APPLE__)
+    const struct timespec& time = status.st_mtimespec;
+#else
+    const struct timespec& time = status.st_mtim;
+#endif
+    return std::to_string(time.tv_sec) + "." + std::to_string(time.tv_nsec) + ":" + std::to_string(status.st_size);
+#endif
+}
+
+ImageCache::ImageCache(std::size_t maxBytes)
+    : _maxBytes(maxBytes)
+{
+    _stats.maxBytes = maxBytes;
+}
+
+ImageCache::~ImageCache()
+{
+    MemoryTracker::getInstance().release(_stats.bytes);
+}
+
+void ImageCache::setMaxMemory(std::size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxBytes = maxBytes;
+    _stats.maxBytes = maxBytes;
+    evict(maxBytes);
+}
+
+std::size_t ImageCache::getMaxMemory() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _maxBytes;
+}
+
+ImageCache::ImagePtr ImageCache::get(const std::string& path, const std::string& decoding, const std::string& fileStamp)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if(_maxBytes == 0)
+        return nullptr;
+
+    auto it = _entries.find(Key(path, decoding));
+    if(it == _entries.end() || it->second.fileStamp != fileStamp)
+    {
+        // the file has changed
+        if(it != _entries.end())
+            erase(it);
+        ++_stats.nbMisses;
+        return nullptr;
+    }
+
+    _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+    ++_stats.nbHits;
+    _stats.bytesHit += it->second.image->data.size();
+    return it->second.image;
+}
+
+void ImageCache::add(const std::string& path, const std::string& decoding, const std::string& fileStamp, const ImagePtr& image)
+{
+    const std::size_t size = image->data.size();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if(size > _maxBytes || fileStamp.empty())
+        return;
+
+    const Key key(path, decoding);
+    auto it = _entries.find(key);
+    if(it != _entries.end())
+        erase(it);
+
+    evict(_maxBytes - size);
+
+    _lru.push_front(key);
+    Entry& entry = _entries[key];
+    entry.image = image;
+    entry.fileStamp = fileStamp;
+    entry.lruIt = _lru.begin();
+
+    ++_stats.nbImages;
+    _stats.bytes += size;
+    MemoryTracker::getInstance().allocate(size);
+    _stats.peakBytes = std::max(_stats.peakBytes, _stats.bytes);
+}
+
+void ImageCache::invalidate(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _entries.lower_bound(Key(path, std::string()));
+    while(it != _entries.end() && it->first.first == path)
+        erase(it++);
+}
+
+std::size_t ImageCache::shrink(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const std::size_t previousBytes = _stats.bytes;
+    evict(previousBytes - std::min(previousBytes, bytes));
+    return previousBytes - _stats.bytes;
+}
+
+void ImageCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    MemoryTracker::getInstance().release(_stats.bytes);
+    _entries.clear();
+    _lru.clear();
+    _stats.nbImages = 0;
+    _stats.bytes = 0;
+}
+
+ImageCache::Stats ImageCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void ImageCache::erase(std::map<Key, Entry>::iterator it)
+{
+    const std::size_t size = it->second.image->data.size();
+    _stats.bytes -= size;
+    MemoryTracker::getInstance().release(size);
+    --_stats.nbImages;
+    _lru.erase(it->second.lruIt);
+    _entries.erase(it);
+}
+
+void ImageCache::evict(std::size_t maxBytes)
+{
+    while(_stats.bytes > maxBytes)
+    {
+        erase(_entries.find(_lru.back()));
+        ++_stats.nbEvictions;
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const ImageCache::Stats& stats)
+{
+    const double toMB = 1.0 / (1024.0 * 1024.0);
+    os << "Image cache: " << stats.nbHits << " hits, " << stats.nbMisses << " misses, " << stats.nbEvictions << " evictions, "
+       << stats.nbImages << " images (" << stats.bytes * toMB << " MB, peak " << stats.peakBytes * toMB
+       << " MB, budget " << stats.maxBytes * toMB << " MB), " << stats.bytesHit * toMB << " MB read from the cache";
+    return os;
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,154 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Process-wide cache of the decoded images, shared by the image readers of all the modules.
+ *
+ * An image is identified by its file path and by the decoding parameters (pixel type, channels, scale...),
+ * and is only returned if the file has not changed since it was decoded (modification time and size).
+ * The least recently used images are evicted when the cache exceeds its byte budget.
+ * The cache is thread-safe and disabled when its budget is 0.
+ *
+ * The budget is read from the ALICEVISION_IMAGE_CACHE_MB environment variable (default: 0)
+ * and can be changed with setMaxMemory().
+ * The images are accounted in the MemoryTracker, and the cache of the process is shrunk
+ * when the memory budget of the process is exceeded.
+ */
+class ImageCache
+{
+public:
+    /// decoded pixels of an image
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> data;
+    };
+
+    typedef std::shared_ptr<const Image> ImagePtr;
+
+    struct Stats
+    {
+        std::size_t nbHits = 0;
+        std::size_t nbMisses = 0;
+        std::size_t nbEvictions = 0;
+        /// number of images in the cache
+        std::size_t nbImages = 0;
+        std::size_t bytes = 0;
+        std::size_t peakBytes = 0;
+        /// bytes copied from the cache instead of being decoded
+        std::size_t bytesHit = 0;
+        std::size_t maxBytes = 0;
+    };
+
+    /**
+     * @brief Get the cache of the process
+     */
+    static ImageCache& getInstance();
+
+    /**
+     * @brief Get the modification stamp of a file (modification time and size), empty if the file does not exist.
+     * The modification time has the resolution of the file system on POSIX systems,
+     * but only a 1 second resolution on Windows: a file rewritten with the same size within the same second
+     * is not detected there, the writers have to call invalidate().
+     */
+    static std::string getFileStamp(const std::string& path);
+
+    explicit ImageCache(std::size_t maxBytes);
+
+    ~ImageCache();
+
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    /**
+     * @brief Set the byte budget of the cache, 0 disables the cache.
+     * The images exceeding the new budget are evicted.
+     */
+    void setMaxMemory(std::size_t maxBytes);
+
+    std::size_t getMaxMemory() const;
+
+    bool isEnabled() const { return getMaxMemory() > 0; }
+
+    /**
+     * @brief Get a decoded image
+     * @param[in] path the image file path
+     * @param[in] decoding the decoding parameters
+     * @param[in] fileStamp the current modification stamp of the file
+     * @return the image, or nullptr if it is not in the cache or if the file has changed
+     */
+    ImagePtr get(const std::string& path, const std::string& decoding, const std::string& fileStamp);
+
+    /**
+     * @brief Add a decoded image, it is not added if it is larger than the budget or if the file stamp is empty
+     * @param[in] path the image file path
+     * @param[in] decoding the decoding parameters
+     * @param[in] fileStamp the modification stamp of the file when it was decoded
+     * @param[in] image the decoded image
+     */
+    void add(const std::string& path, const std::string& decoding, const std::string& fileStamp, const ImagePtr& image);
+
+    /**
+     * @brief Remove all the decoded images of a file, to call when the file is written
+     */
+    void invalidate(const std::string& path);
+
+    /**
+     * @brief Evict the least recently used images to free memory, the budget is not changed
+     * @param[in] bytes the number of bytes to free
+     * @return the number of bytes freed
+     */
+    std::size_t shrink(std::size_t bytes);
+
+    /**
+     * @brief Remove all the images
+     */
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    typedef std::pair<std::string, std::string> Key;
+
+    struct Entry
+    {
+        ImagePtr image;
+        std::string fileStamp;
+        std::list<Key>::iterator lruIt;
+    };
+
+    void erase(std::map<Key, Entry>::iterator it);
+    void evict(std::size_t maxBytes);
+
+    std::size_t _maxBytes;
+    Stats _stats;
+
+    std::map<Key, Entry> _entries;
+    /// most recently used first
+    std::list<Key> _lru;
+    mutable std::mutex _mutex;
+};
+
+std::ostream& operator<<(std::ostream& os, const ImageCache::Stats& stats);
+
+} // namespace system
+} // namespace aliceVision
@@ -13,11 +13,17 @@
 
 #if defined(__WINDOWS__)
 #include <windows.h>
+#include <psapi.h>
 #elif defined(__LINUX__)
 #include <sys/sysinfo.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdio>
 #elif defined(__APPLE__)
 #include <sys/types.h>
 #include <sys/sysctl.h>
+#include <sys/resource.h>
+#include <mach/task.h>
 #include <mach/vm_statistics.h>
 #include <mach/mach_types.h>
 #include <mach/mach_init.h>
@@ -99,6 +105,59 @@ MemoryInfo getMemoryInfo()
     return infos;
 }
 
+std::size_t getPeakUsedMemory()
+{
+#if defined(__WINDOWS__)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#elif defined(__LINUX__) || defined(__APPLE__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    // in bytes on macOS
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    // in kilobytes on Linux
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+std::size_t getUsedMemory()
+{
+#if defined(__WINDOWS__)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.WorkingSetSize;
+    return 0;
+#elif defined(__LINUX__)
+    // second field: resident pages
+    std::FILE* file = std::fopen("/proc/self/statm", "r");
+    if(file == nullptr)
+        return 0;
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    const int nbRead = std::fscanf(file, "%lu %lu", &size, &resident);
+    std::fclose(file);
+    if(nbRead != 2)
+        return 0;
+    return static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0;
+    return static_cast<std::size_t>(info.resident_size);
+#else
+    return 0;
+#endif
+}
+
 std::ostream& operator<<(std::ostream& os, const MemoryInfo& infos)
 {
   const float convertionGb = std::pow(2,30);
@@ -24,6 +24,18 @@ struct MemoryInfo
 
 MemoryInfo getMemoryInfo();
 
+/**
+ * @brief Get the peak resident memory used by the current process since its start (in bytes).
+ * @return 0 if it is not available on this system
+ */
+std::size_t getPeakUsedMemory();
+
+/**
+ * @brief Get the resident memory currently used by the current process (in bytes).
+ * @return 0 if it is not available on this system
+ */
+std::size_t getUsedMemory();
+
 std::ostream& operator<<(std::ostream& os, const MemoryInfo& infos);
 
 }
@@ -0,0 +1,344 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MemoryTracker.hpp"
+#include "MemoryInfo.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+void updateMax(std::atomic<std::size_t>& value, std::size_t candidate)
+{
+    std::size_t current = value.load();
+    while(candidate > current && !value.compare_exchange_weak(current, candidate))
+    {}
+}
+
+void writeJsonString(std::ostream& os, const std::string& str)
+{
+    os << '"';
+    for(const char c : str)
+    {
+        if(c == '"' || c == '\\')
+            os << '\\' << c;
+        else if(static_cast<unsigned char>(c) < 0x20)
+            os << ' ';
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+/// the memory tracker is configured by the environment when the library is loaded
+const bool memoryTrackerInitialized = (MemoryTracker::getInstance(), true);
+
+} // namespace
+
+MemoryTracker& MemoryTracker::getInstance()
+{
+    static MemoryTracker instance;
+    return instance;
+}
+
+MemoryTracker::MemoryTracker()
+  : _trackedBytes(0)
+  , _peakTrackedBytes(0)
+  , _budget(0)
+  , _nbBudgetSignals(0)
+  , _samplingPeriod(100)
+{
+    const char* budgetMB = std::getenv("ALICEVISION_MEMORY_BUDGET_MB");
+    if(budgetMB != nullptr)
+        _budget = static_cast<std::size_t>(std::max(0L, std::atol(budgetMB))) * 1024 * 1024;
+
+    const char* reportPath = std::getenv("ALICEVISION_MEMORY_REPORT");
+    if(reportPath != nullptr)
+        _reportPath = reportPath;
+
+    updateSampling();
+}
+
+MemoryTracker::~MemoryTracker()
+{
+    std::string reportPath;
+    std::thread samplingThread;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        reportPath = _reportPath;
+        _stopSampling = true;
+        samplingThread = std::move(_samplingThread);
+    }
+    _samplingCondition.notify_all();
+    if(samplingThread.joinable())
+        samplingThread.join();
+
+    if(reportPath.empty())
+        return;
+
+    if(writeReport(reportPath))
+        std::cout << "Memory report written to " << reportPath << std::endl;
+    else
+        std::cerr << "Cannot write the memory report to " << reportPath << std::endl;
+}
+
+void MemoryTracker::allocate(std::size_t bytes)
+{
+    const std::size_t trackedBytes = (_trackedBytes += bytes);
+    updateMax(_peakTrackedBytes, trackedBytes);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto& phase : _activePhases)
+        phase.second.peakTrackedBytes = std::max(phase.second.peakTrackedBytes, trackedBytes);
+}
+
+void MemoryTracker::release(std::size_t bytes)
+{
+    std::size_t current = _trackedBytes.load();
+    while(!_trackedBytes.compare_exchange_weak(current, current - std::min(current, bytes)))
+    {}
+}
+
+std::size_t MemoryTracker::beginPhase(const std::string& name)
+{
+    ActivePhase phase;
+    phase.name = name;
+    phase.start = std::chrono::steady_clock::now();
+    phase.startRss = getUsedMemory();
+    phase.startPeakRss = getPeakUsedMemory();
+    phase.peakRss = phase.startRss;
+    phase.peakTrackedBytes = _trackedBytes.load();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = std::find_if(_phases.begin(), _phases.end(), [&name](const PhaseStats& stats) { return stats.name == name; });
+    if(it == _phases.end())
+    {
+        PhaseStats stats;
+        stats.name = name;
+        stats.startRss = phase.startRss;
+        _phases.push_back(stats);
+    }
+
+    const std::size_t phaseId = _nextPhaseId++;
+    _activePhases.emplace(phaseId, phase);
+    return phaseId;
+}
+
+void MemoryTracker::endPhase(std::size_t phaseId)
+{
+    const std::size_t rss = getUsedMemory();
+    const std::size_t peakRss = getPeakUsedMemory();
+    const std::size_t trackedBytes = _trackedBytes.load();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto activeIt = _activePhases.find(phaseId);
+    if(activeIt == _activePhases.end())
+        return;
+    const ActivePhase& phase = activeIt->second;
+
+    // a new peak of the process was reached during the phase
+    std::size_t phasePeakRss = std::max(phase.peakRss, rss);
+    if(peakRss > phase.startPeakRss)
+        phasePeakRss = std::max(phasePeakRss, peakRss);
+
+    auto it = std::find_if(_phases.begin(), _phases.end(), [&phase](const PhaseStats& stats) { return stats.name == phase.name; });
+    if(it == _phases.end())
+    {
+        // the statistics were cleared during the phase
+        PhaseStats stats;
+        stats.name = phase.name;
+        stats.startRss = phase.startRss;
+        it = _phases.insert(_phases.end(), stats);
+    }
+
+    PhaseStats& stats = *it;
+    ++stats.count;
+    stats.peakRss = std::max(stats.peakRss, phasePeakRss);
+    stats.maxRssIncrease = std::max(stats.maxRssIncrease, phasePeakRss - std::min(phasePeakRss, phase.startRss));
+    stats.peakTrackedBytes = std::max(stats.peakTrackedBytes, std::max(phase.peakTrackedBytes, trackedBytes));
+    stats.duration += std::chrono::duration<double>(std::chrono::steady_clock::now() - phase.start).count();
+
+    _activePhases.erase(activeIt);
+}
+
+std::vector<MemoryTracker::PhaseStats> MemoryTracker::getPhases() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<PhaseStats> phases;
+    for(const PhaseStats& stats : _phases)
+    {
+        if(stats.count > 0)
+            phases.push_back(stats);
+    }
+    return phases;
+}
+
+void MemoryTracker::clearPhases()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _phases.clear();
+}
+
+void MemoryTracker::updatePhases(std::size_t rss, std::size_t trackedBytes)
+{
+    for(auto& phase : _activePhases)
+    {
+        phase.second.peakRss = std::max(phase.second.peakRss, rss);
+        phase.second.peakTrackedBytes = std::max(phase.second.peakTrackedBytes, trackedBytes);
+    }
+}
+
+void MemoryTracker::setBudget(std::size_t bytes)
+{
+    _budget = bytes;
+    updateSampling();
+}
+
+std::size_t MemoryTracker::getAvailableMemory() const
+{
+    const std::size_t budget = _budget.load();
+    if(budget == 0)
+        return std::numeric_limits<std::size_t>::max();
+
+    const std::size_t usedMemory = std::max(getUsedMemory(), _trackedBytes.load());
+    return (budget > usedMemory) ? budget - usedMemory : 0;
+}
+
+std::size_t MemoryTracker::addBudgetListener(const BudgetListener& listener)
+{
+    std::lock_guard<std::mutex> lock(_listenersMutex);
+    const std::size_t listenerId = _nextListenerId++;
+    _listeners.emplace(listenerId, listener);
+    return listenerId;
+}
+
+void MemoryTracker::removeBudgetListener(std::size_t listenerId)
+{
+    std::lock_guard<std::mutex> lock(_listenersMutex);
+    _listeners.erase(listenerId);
+}
+
+bool MemoryTracker::checkBudget()
+{
+    const std::size_t rss = getUsedMemory();
+    const std::size_t trackedBytes = _trackedBytes.load();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        updatePhases(rss, trackedBytes);
+    }
+
+    const std::size_t budget = _budget.load();
+    const std::size_t usedMemory = std::max(rss, trackedBytes);
+    if(budget == 0 || usedMemory <= budget)
+        return false;
+
+    if(_nbBudgetSignals++ == 0)
+    {
+        ALICEVISION_LOG_WARNING("The memory budget is exceeded (used: " << usedMemory / (1024 * 1024)
+                                << " MB, budget: " << budget / (1024 * 1024) << " MB), the caches are shrunk.");
+    }
+
+    std::lock_guard<std::mutex> lock(_listenersMutex);
+    for(auto& listener : _listeners)
+        listener.second(usedMemory - budget);
+    return true;
+}
+
+void MemoryTracker::setReportPath(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _reportPath = path;
+    }
+    updateSampling();
+}
+
+void MemoryTracker::updateSampling()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    const bool needSampling = (_budget.load() > 0 || !_reportPath.empty());
+
+    if(needSampling == _samplingThread.joinable())
+        return;
+
+    if(needSampling)
+    {
+        _stopSampling = false;
+        _samplingThread = std::thread(&MemoryTracker::runSampling, this);
+        return;
+    }
+
+    _stopSampling = true;
+    std::thread samplingThread(std::move(_samplingThread));
+    lock.unlock();
+    _samplingCondition.notify_all();
+    samplingThread.join();
+}
+
+void MemoryTracker::runSampling()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(!_stopSampling)
+    {
+        lock.unlock();
+        checkBudget();
+        lock.lock();
+        _samplingCondition.wait_for(lock, _samplingPeriod, [this] { return _stopSampling; });
+    }
+}
+
+void MemoryTracker::writeReport(std::ostream& os) const
+{
+    const std::vector<PhaseStats> phases = getPhases();
+
+    os << "{" << std::endl
+       << "    \"peakRss\": " << getPeakUsedMemory() << "," << std::endl
+       << "    \"rss\": " << getUsedMemory() << "," << std::endl
+       << "    \"trackedBytes\": " << getTrackedBytes() << "," << std::endl
+       << "    \"peakTrackedBytes\": " << getPeakTrackedBytes() << "," << std::endl
+       << "    \"budget\": " << getBudget() << "," << std::endl
+       << "    \"nbBudgetSignals\": " << getNbBudgetSignals() << "," << std::endl
+       << "    \"phases\": [";
+
+    for(std::size_t i = 0; i < phases.size(); ++i)
+    {
+        const PhaseStats& stats = phases[i];
+        os << ((i == 0) ? "" : ",") << std::endl
+           << "        {\"name\": ";
+        writeJsonString(os, stats.name);
+        os << ", \"count\": " << stats.count
+           << ", \"startRss\": " << stats.startRss
+           << ", \"peakRss\": " << stats.peakRss
+           << ", \"maxRssIncrease\": " << stats.maxRssIncrease
+           << ", \"peakTrackedBytes\": " << stats.peakTrackedBytes
+           << ", \"duration\": " << std::fixed << std::setprecision(3) << stats.duration << "}";
+    }
+    os << std::endl << "    ]" << std::endl << "}" << std::endl;
+}
+
+bool MemoryTracker::writeReport(const std::string& path) const
+{
+    std::ofstream os(path);
+    if(!os.is_open())
+        return false;
+    writeReport(os);
+    return os.good();
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,252 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Process-wide accounting of the memory, per named phase of the process.
+ *
+ * - Phases: the peak resident memory (RSS) and the peak of the tracked bytes are recorded for each phase,
+ *   declared with ALICEVISION_MEMORY_PHASE("name"). The phases can be nested and run on several threads,
+ *   the statistics of the phases with the same name are merged.
+ * - Tracked allocations: the large buffers (caches, images...) are declared with allocate() / release().
+ * - Budget: a soft budget of memory for the process. When the resident memory or the tracked bytes exceed it,
+ *   the budget listeners (caches, schedulers) are asked to free the excess. The schedulers can size their
+ *   work with getAvailableMemory().
+ *
+ * The resident memory is sampled by a background thread when a budget or a report is set.
+ * The budget is read from the ALICEVISION_MEMORY_BUDGET_MB environment variable (default: 0, no budget)
+ * and can be changed with setBudget(). If the ALICEVISION_MEMORY_REPORT environment variable is set to
+ * a file path, the report is written to this file (JSON) at the end of the process.
+ */
+class MemoryTracker
+{
+public:
+    /// memory statistics of the phases of a name
+    struct PhaseStats
+    {
+        std::string name;
+        std::size_t count = 0;
+        /// resident memory when the phase was first started
+        std::size_t startRss = 0;
+        /// peak resident memory during the phases
+        std::size_t peakRss = 0;
+        /// maximum increase of the resident memory during a phase (peak - start)
+        std::size_t maxRssIncrease = 0;
+        /// peak of the tracked bytes during the phases
+        std::size_t peakTrackedBytes = 0;
+        /// total duration of the phases, in seconds
+        double duration = 0.0;
+    };
+
+    /// function asked to free memory, the argument is the number of bytes over the budget
+    typedef std::function<void(std::size_t)> BudgetListener;
+
+    /**
+     * @brief Get the memory tracker of the process
+     */
+    static MemoryTracker& getInstance();
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    ~MemoryTracker();
+
+    /**
+     * @brief Declare the allocation of a tracked buffer
+     */
+    void allocate(std::size_t bytes);
+
+    /**
+     * @brief Declare the release of a tracked buffer
+     */
+    void release(std::size_t bytes);
+
+    std::size_t getTrackedBytes() const { return _trackedBytes.load(); }
+
+    std::size_t getPeakTrackedBytes() const { return _peakTrackedBytes.load(); }
+
+    /**
+     * @brief Start a phase, to use through ALICEVISION_MEMORY_PHASE
+     * @return the phase id
+     */
+    std::size_t beginPhase(const std::string& name);
+
+    /**
+     * @brief End a phase, to use through ALICEVISION_MEMORY_PHASE
+     */
+    void endPhase(std::size_t phaseId);
+
+    /**
+     * @brief Get the statistics per phase name, in the order of the first start of the phases
+     */
+    std::vector<PhaseStats> getPhases() const;
+
+    /**
+     * @brief Remove the statistics of the ended phases
+     */
+    void clearPhases();
+
+    /**
+     * @brief Set the soft memory budget of the process, 0 disables the budget
+     */
+    void setBudget(std::size_t bytes);
+
+    std::size_t getBudget() const { return _budget.load(); }
+
+    /**
+     * @brief Get the memory that can still be used within the budget
+     * (the budget minus the used memory), the maximum value if there is no budget
+     */
+    std::size_t getAvailableMemory() const;
+
+    /**
+     * @brief Add a listener asked to free memory when the budget is exceeded.
+     * The listener is called from the sampling thread or from checkBudget(),
+     * it must not add or remove listeners.
+     * @return the listener id
+     */
+    std::size_t addBudgetListener(const BudgetListener& listener);
+
+    /**
+     * @brief Remove a listener, it is not called anymore once removed
+     */
+    void removeBudgetListener(std::size_t listenerId);
+
+    /**
+     * @brief Sample the resident memory and ask the listeners to free memory if the budget is exceeded
+     * @return true if the budget is exceeded
+     */
+    bool checkBudget();
+
+    /// number of times the listeners were asked to free memory
+    std::size_t getNbBudgetSignals() const { return _nbBudgetSignals.load(); }
+
+    /**
+     * @brief Set the path of the report written at the end of the process, empty to disable it
+     */
+    void setReportPath(const std::string& path);
+
+    /**
+     * @brief Write the report (JSON): peak memory, tracked bytes, budget and statistics per phase
+     */
+    void writeReport(std::ostream& os) const;
+
+    /**
+     * @brief Write the report to a file
+     * @return false if the file cannot be written
+     */
+    bool writeReport(const std::string& path) const;
+
+private:
+    struct ActivePhase
+    {
+        std::string name;
+        std::chrono::steady_clock::time_point start;
+        std::size_t startRss = 0;
+        std::size_t startPeakRss = 0;
+        std::size_t peakRss = 0;
+        std::size_t peakTrackedBytes = 0;
+    };
+
+    MemoryTracker();
+
+    /// update the peaks of the active phases
+    void updatePhases(std::size_t rss, std::size_t trackedBytes);
+    void updateSampling();
+    void runSampling();
+
+    std::atomic<std::size_t> _trackedBytes;
+    std::atomic<std::size_t> _peakTrackedBytes;
+    std::atomic<std::size_t> _budget;
+    std::atomic<std::size_t> _nbBudgetSignals;
+
+    std::size_t _nextPhaseId = 0;
+    std::map<std::size_t, ActivePhase> _activePhases;
+    std::vector<PhaseStats> _phases;
+    std::string _reportPath;
+    mutable std::mutex _mutex;
+
+    std::size_t _nextListenerId = 0;
+    std::map<std::size_t, BudgetListener> _listeners;
+    /// held while the listeners are called
+    std::mutex _listenersMutex;
+
+    /// sampling period of the resident memory
+    const std::chrono::milliseconds _samplingPeriod;
+    std::thread _samplingThread;
+    bool _stopSampling = false;
+    std::condition_variable _samplingCondition;
+};
+
+/**
+ * @brief Phase of the memory tracker, from its construction to the end of its scope
+ */
+class MemoryPhase
+{
+public:
+    explicit MemoryPhase(const std::string& name)
+      : _phaseId(MemoryTracker::getInstance().beginPhase(name))
+    {}
+
+    ~MemoryPhase()
+    {
+        MemoryTracker::getInstance().endPhase(_phaseId);
+    }
+
+    MemoryPhase(const MemoryPhase&) = delete;
+    MemoryPhase& operator=(const MemoryPhase&) = delete;
+
+private:
+    const std::size_t _phaseId;
+};
+
+/**
+ * @brief Budget listener of the memory tracker, registered during its lifetime
+ */
+class ScopedBudgetListener
+{
+public:
+    explicit ScopedBudgetListener(const MemoryTracker::BudgetListener& listener)
+      : _listenerId(MemoryTracker::getInstance().addBudgetListener(listener))
+    {}
+
+    ~ScopedBudgetListener()
+    {
+        MemoryTracker::getInstance().removeBudgetListener(_listenerId);
+    }
+
+    ScopedBudgetListener(const ScopedBudgetListener&) = delete;
+    ScopedBudgetListener& operator=(const ScopedBudgetListener&) = delete;
+
+private:
+    const std::size_t _listenerId;
+};
+
+} // namespace system
+} // namespace aliceVision
+
+#define ALICEVISION_MEMORY_PHASE_CONCAT_IMPL(a, b) a##b
+#define ALICEVISION_MEMORY_PHASE_CONCAT(a, b) ALICEVISION_MEMORY_PHASE_CONCAT_IMPL(a, b)
+
+/// account the memory used from this line to the end of the scope to a phase
+#define ALICEVISION_MEMORY_PHASE(name) \
+    ::aliceVision::system::MemoryPhase ALICEVISION_MEMORY_PHASE_CONCAT(aliceVisionMemoryPhase, __LINE__)(name)
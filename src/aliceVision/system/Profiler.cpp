@@ -0,0 +1,293 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+struct ZoneStatsNs
+{
+    std::size_t count = 0;
+    std::int64_t total = 0;
+    std::int64_t self = 0;
+    std::int64_t min = std::numeric_limits<std::int64_t>::max();
+    std::int64_t max = 0;
+};
+
+void writeJsonString(std::ostream& os, const char* str)
+{
+    os << '"';
+    for(; *str != '\0'; ++str)
+    {
+        const char c = *str;
+        if(c == '"' || c == '\\')
+            os << '\\' << c;
+        else if(static_cast<unsigned char>(c) < 0x20)
+            os << ' ';
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+/// the profiler is enabled by the environment when the library is loaded
+const bool profilerInitialized = (Profiler::getInstance(), true);
+
+} // namespace
+
+/// zones recorded by a thread
+struct Profiler::ThreadBuffer
+{
+    struct Event
+    {
+        const char* name;
+        std::int64_t start;
+        std::int64_t duration;
+    };
+
+    explicit ThreadBuffer(int id)
+      : id(id)
+    {}
+
+    const int id;
+    /// time spent in the nested zones of the started zones, only used by the thread
+    std::vector<std::int64_t> childTimes;
+
+    std::vector<Event> events;
+    std::map<const char*, ZoneStatsNs> stats;
+    std::mutex mutex;
+};
+
+std::atomic<bool> Profiler::_enabled(false);
+
+Profiler& Profiler::getInstance()
+{
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::Profiler()
+  : _origin(std::chrono::steady_clock::now())
+  , _maxTraceEvents(1000000)
+  , _nbTraceEvents(0)
+{
+    const char* tracePath = std::getenv("ALICEVISION_PROFILE_TRACE");
+    if(tracePath != nullptr && tracePath[0] != '\0')
+        enable(tracePath);
+}
+
+Profiler::~Profiler()
+{
+    _enabled = false;
+
+    if(_tracePath.empty())
+        return;
+
+    if(writeChromeTrace(_tracePath))
+        std::cout << "Profiler trace written to " << _tracePath << std::endl;
+    else
+        std::cerr << "Cannot write the profiler trace to " << _tracePath << std::endl;
+    printSummary(std::cout);
+}
+
+void Profiler::enable(const std::string& tracePath)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(!tracePath.empty())
+            _tracePath = tracePath;
+    }
+    _enabled = true;
+}
+
+void Profiler::disable()
+{
+    _enabled = false;
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto& buffer : _threadBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+        buffer->stats.clear();
+    }
+    _nbTraceEvents = 0;
+}
+
+void Profiler::setMaxTraceEvents(std::size_t maxTraceEvents)
+{
+    _maxTraceEvents = maxTraceEvents;
+}
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer()
+{
+    thread_local ThreadBuffer* threadBuffer = nullptr;
+
+    if(threadBuffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threadBuffers.emplace_back(new ThreadBuffer(static_cast<int>(_threadBuffers.size())));
+        threadBuffer = _threadBuffers.back().get();
+    }
+    return *threadBuffer;
+}
+
+std::int64_t Profiler::beginZone()
+{
+    getThreadBuffer().childTimes.push_back(0);
+    return now();
+}
+
+void Profiler::endZone(const char* name, std::int64_t start)
+{
+    const std::int64_t duration = now() - start;
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    std::int64_t childTime = 0;
+    if(!buffer.childTimes.empty())
+    {
+        childTime = buffer.childTimes.back();
+        buffer.childTimes.pop_back();
+        if(!buffer.childTimes.empty())
+            buffer.childTimes.back() += duration;
+    }
+
+    const bool isTraced = (_nbTraceEvents.fetch_add(1, std::memory_order_relaxed) < _maxTraceEvents.load(std::memory_order_relaxed));
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    ZoneStatsNs& stats = buffer.stats[name];
+    ++stats.count;
+    stats.total += duration;
+    stats.self += duration - childTime;
+    stats.min = std::min(stats.min, duration);
+    stats.max = std::max(stats.max, duration);
+
+    if(isTraced)
+        buffer.events.push_back({name, start, duration});
+}
+
+std::vector<Profiler::ZoneStats> Profiler::getSummary() const
+{
+    // the same name can have several addresses (one per translation unit)
+    std::map<std::string, ZoneStatsNs> statsPerName;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(const auto& buffer : _threadBuffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            for(const auto& zone : buffer->stats)
+            {
+                ZoneStatsNs& stats = statsPerName[zone.first];
+                stats.count += zone.second.count;
+                stats.total += zone.second.total;
+                stats.self += zone.second.self;
+                stats.min = std::min(stats.min, zone.second.min);
+                stats.max = std::max(stats.max, zone.second.max);
+            }
+        }
+    }
+
+    std::vector<ZoneStats> summary;
+    summary.reserve(statsPerName.size());
+    for(const auto& zone : statsPerName)
+    {
+        ZoneStats stats;
+        stats.name = zone.first;
+        stats.count = zone.second.count;
+        stats.totalMs = zone.second.total * 1e-6;
+        stats.selfMs = zone.second.self * 1e-6;
+        stats.minMs = zone.second.min * 1e-6;
+        stats.maxMs = zone.second.max * 1e-6;
+        summary.push_back(stats);
+    }
+
+    std::sort(summary.begin(), summary.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.totalMs > b.totalMs; });
+    return summary;
+}
+
+void Profiler::printSummary(std::ostream& os) const
+{
+    const std::vector<ZoneStats> summary = getSummary();
+
+    std::size_t nameWidth = 4;
+    for(const ZoneStats& stats : summary)
+        nameWidth = std::max(nameWidth, stats.name.size());
+
+    const std::ios::fmtflags flags = os.flags();
+    os << "Profiler summary (ms):" << std::endl
+       << std::left << std::setw(nameWidth) << "zone" << std::right
+       << std::setw(10) << "count"
+       << std::setw(14) << "total"
+       << std::setw(14) << "self"
+       << std::setw(12) << "mean"
+       << std::setw(12) << "min"
+       << std::setw(12) << "max" << std::endl;
+
+    os << std::fixed << std::setprecision(3);
+    for(const ZoneStats& stats : summary)
+    {
+        os << std::left << std::setw(nameWidth) << stats.name << std::right
+           << std::setw(10) << stats.count
+           << std::setw(14) << stats.totalMs
+           << std::setw(14) << stats.selfMs
+           << std::setw(12) << stats.totalMs / std::max(stats.count, std::size_t(1))
+           << std::setw(12) << stats.minMs
+           << std::setw(12) << stats.maxMs << std::endl;
+    }
+    os.flags(flags);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const
+{
+    std::ofstream os(path);
+    if(!os.is_open())
+        return false;
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    os << std::fixed << std::setprecision(3);
+
+    bool isFirst = true;
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(const auto& buffer : _threadBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+        os << (isFirst ? "\n" : ",\n")
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+           << ",\"args\":{\"name\":\"thread " << buffer->id << "\"}}";
+        isFirst = false;
+
+        // timestamps and durations in microseconds
+        for(const auto& event : buffer->events)
+        {
+            os << ",\n{\"name\":";
+            writeJsonString(os, event.name);
+            os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+               << ",\"ts\":" << event.start * 1e-3
+               << ",\"dur\":" << event.duration * 1e-3 << "}";
+        }
+    }
+    os << "\n]}\n";
+
+    return os.good();
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,179 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Process-wide profiler of named zones (scopes of code), for all the threads.
+ *
+ * The zones are declared with ALICEVISION_PROFILE_ZONE("name") and nest on each thread.
+ * When the profiler is disabled (default), a zone only costs the read of a flag.
+ * When it is enabled, each zone is recorded in a buffer of its thread:
+ *  - as a trace event, exported in the Chrome trace format (chrome://tracing, Perfetto),
+ *    up to a maximum number of events;
+ *  - in the statistics of its name (count, total time, self time without the nested zones, min, max).
+ *
+ * The profiler is enabled when the ALICEVISION_PROFILE_TRACE environment variable is set to a trace file path:
+ * the trace is then written to this file and the summary is printed at the end of the process.
+ */
+class Profiler
+{
+public:
+    /// statistics of the zones of a name
+    struct ZoneStats
+    {
+        std::string name;
+        std::size_t count = 0;
+        /// total time in the zones, in milliseconds
+        double totalMs = 0.0;
+        /// total time in the zones without their nested zones, in milliseconds
+        double selfMs = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    /**
+     * @brief Get the profiler of the process
+     */
+    static Profiler& getInstance();
+
+    static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    ~Profiler();
+
+    /**
+     * @brief Start recording the zones
+     * @param[in] tracePath the file where the trace is written at the end of the process (optional)
+     */
+    void enable(const std::string& tracePath = std::string());
+
+    /**
+     * @brief Stop recording the zones, the recorded zones are kept
+     */
+    void disable();
+
+    /**
+     * @brief Remove the recorded zones
+     */
+    void clear();
+
+    /**
+     * @brief Set the maximum number of trace events (the statistics are still updated above it)
+     */
+    void setMaxTraceEvents(std::size_t maxTraceEvents);
+
+    /**
+     * @brief Get the statistics per zone name, sorted by decreasing total time
+     */
+    std::vector<ZoneStats> getSummary() const;
+
+    /**
+     * @brief Print the statistics per zone name
+     */
+    void printSummary(std::ostream& os) const;
+
+    /**
+     * @brief Write the recorded zones in the Chrome trace event format (JSON)
+     * @param[in] path the trace file path
+     * @return false if the file cannot be written
+     */
+    bool writeChromeTrace(const std::string& path) const;
+
+    /// time since the profiler creation, in nanoseconds
+    std::int64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _origin).count();
+    }
+
+    /**
+     * @brief Start a zone on the current thread, to use through ALICEVISION_PROFILE_ZONE
+     * @return the zone start time
+     */
+    std::int64_t beginZone();
+
+    /**
+     * @brief End the last zone started on the current thread, to use through ALICEVISION_PROFILE_ZONE
+     * @param[in] name the zone name, it must outlive the profiler (string literal)
+     * @param[in] start the zone start time
+     */
+    void endZone(const char* name, std::int64_t start);
+
+private:
+    struct ThreadBuffer;
+
+    Profiler();
+
+    ThreadBuffer& getThreadBuffer();
+
+    static std::atomic<bool> _enabled;
+
+    const std::chrono::steady_clock::time_point _origin;
+    std::string _tracePath;
+    std::atomic<std::size_t> _maxTraceEvents;
+    std::atomic<std::size_t> _nbTraceEvents;
+
+    std::vector<std::unique_ptr<ThreadBuffer>> _threadBuffers;
+    mutable std::mutex _mutex;
+};
+
+/**
+ * @brief Zone of the profiler, from its construction to the end of its scope
+ */
+class ProfileZone
+{
+public:
+    /**
+     * @param[in] name the zone name, it must outlive the profiler (string literal)
+     */
+    explicit ProfileZone(const char* name)
+      : _name(Profiler::isEnabled() ? name : nullptr)
+    {
+        if(_name != nullptr)
+            _start = Profiler::getInstance().beginZone();
+    }
+
+    ~ProfileZone()
+    {
+        if(_name != nullptr)
+            Profiler::getInstance().endZone(_name, _start);
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* _name;
+    std::int64_t _start = 0;
+};
+
+} // namespace system
+} // namespace aliceVision
+
+#define ALICEVISION_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ALICEVISION_PROFILE_CONCAT(a, b) ALICEVISION_PROFILE_CONCAT_IMPL(a, b)
+
+/// profile the code from this line to the end of the scope
+#define ALICEVISION_PROFILE_ZONE(name) \
+    ::aliceVision::system::ProfileZone ALICEVISION_PROFILE_CONCAT(aliceVisionProfileZone, __LINE__)(name)
+
+/// profile the code from this line to the end of the function
+#define ALICEVISION_PROFILE_FUNCTION() ALICEVISION_PROFILE_ZONE(__FUNCTION__)
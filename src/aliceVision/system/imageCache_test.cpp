@@ -0,0 +1,186 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/ImageCache.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE imageCache
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::system;
+
+namespace bfs = boost::filesystem;
+
+ImageCache::ImagePtr createImage(int width, int height, unsigned char value)
+{
+  std::shared_ptr<ImageCache::Image> image = std::make_shared<ImageCache::Image>();
+  image->width = width;
+  image->height = height;
+  image->data.assign(width * height, value);
+  return image;
+}
+
+BOOST_AUTO_TEST_CASE(imageCache_hitMiss)
+{
+  ImageCache cache(1000);
+
+  BOOST_CHECK(cache.get("a.png", "uint8x1", "1:10") == nullptr);
+  cache.add("a.png", "uint8x1", "1:10", createImage(10, 10, 1));
+
+  const ImageCache::ImagePtr image = cache.get("a.png", "uint8x1", "1:10");
+  BOOST_REQUIRE(image != nullptr);
+  BOOST_CHECK_EQUAL(image->width, 10);
+  BOOST_CHECK_EQUAL(image->data[0], 1);
+
+  // other decoding parameters
+  BOOST_CHECK(cache.get("a.png", "floatx3", "1:10") == nullptr);
+
+  // the file has changed
+  BOOST_CHECK(cache.get("a.png", "uint8x1", "2:10") == nullptr);
+  BOOST_CHECK(cache.get("a.png", "uint8x1", "1:10") == nullptr);
+
+  // unknown file stamp
+  cache.add("b.png", "uint8x1", "", createImage(10, 10, 1));
+  BOOST_CHECK(cache.get("b.png", "uint8x1", "") == nullptr);
+
+  const ImageCache::Stats stats = cache.getStats();
+  BOOST_CHECK_EQUAL(stats.nbHits, 1);
+  BOOST_CHECK_EQUAL(stats.nbMisses, 5);
+  BOOST_CHECK_EQUAL(stats.nbImages, 0);
+  BOOST_CHECK_EQUAL(stats.bytes, 0);
+  BOOST_CHECK_EQUAL(stats.bytesHit, 100);
+}
+
+BOOST_AUTO_TEST_CASE(imageCache_budget)
+{
+  ImageCache cache(250);
+
+  cache.add("a.png", "", "1", createImage(10, 10, 1));
+  cache.add("b.png", "", "1", createImage(10, 10, 2));
+  // a is the most recently used
+  BOOST_CHECK(cache.get("a.png", "", "1") != nullptr);
+  cache.add("c.png", "", "1", createImage(10, 10, 3));
+
+  BOOST_CHECK(cache.get("a.png", "", "1") != nullptr);
+  BOOST_CHECK(cache.get("b.png", "", "1") == nullptr);
+  BOOST_CHECK(cache.get("c.png", "", "1") != nullptr);
+
+  // larger than the budget
+  cache.add("d.png", "", "1", createImage(20, 20, 4));
+  BOOST_CHECK(cache.get("d.png", "", "1") == nullptr);
+  BOOST_CHECK(cache.get("c.png", "", "1") != nullptr);
+
+  ImageCache::Stats stats = cache.getStats();
+  BOOST_CHECK_EQUAL(stats.nbEvictions, 1);
+  BOOST_CHECK_EQUAL(stats.bytes, 200);
+  BOOST_CHECK_EQUAL(stats.peakBytes, 200);
+
+  cache.setMaxMemory(150);
+  BOOST_CHECK(cache.get("a.png", "", "1") == nullptr);
+  BOOST_CHECK(cache.get("c.png", "", "1") != nullptr);
+
+  // disabled
+  cache.setMaxMemory(0);
+  BOOST_CHECK(!cache.isEnabled());
+  BOOST_CHECK(cache.get("c.png", "", "1") == nullptr);
+  BOOST_CHECK_EQUAL(cache.getStats().bytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(imageCache_shrink)
+{
+  MemoryTracker& tracker = MemoryTracker::getInstance();
+  const std::size_t trackedBytes = tracker.getTrackedBytes();
+  {
+    ImageCache cache(1000);
+    cache.add("a.png", "", "1", createImage(10, 10, 1));
+    cache.add("b.png", "", "1", createImage(10, 10, 2));
+    cache.add("c.png", "", "1", createImage(10, 10, 3));
+    BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes + 300);
+
+    // the least recently used images are evicted, the budget is kept
+    BOOST_CHECK_EQUAL(cache.shrink(150), 200);
+    BOOST_CHECK(cache.get("a.png", "", "1") == nullptr);
+    BOOST_CHECK(cache.get("b.png", "", "1") == nullptr);
+    BOOST_CHECK(cache.get("c.png", "", "1") != nullptr);
+    BOOST_CHECK_EQUAL(cache.getMaxMemory(), 1000);
+    BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes + 100);
+
+    cache.add("d.png", "", "1", createImage(10, 10, 4));
+  }
+  BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes);
+}
+
+BOOST_AUTO_TEST_CASE(imageCache_invalidate)
+{
+  ImageCache cache(1000);
+
+  cache.add("a.png", "uint8x1", "1", createImage(10, 10, 1));
+  cache.add("a.png", "uint8x3", "1", createImage(10, 10, 1));
+  cache.add("a.png.png", "uint8x1", "1", createImage(10, 10, 1));
+  cache.invalidate("a.png");
+
+  BOOST_CHECK(cache.get("a.png", "uint8x1", "1") == nullptr);
+  BOOST_CHECK(cache.get("a.png", "uint8x3", "1") == nullptr);
+  BOOST_CHECK(cache.get("a.png.png", "uint8x1", "1") != nullptr);
+  BOOST_CHECK_EQUAL(cache.getStats().nbImages, 1);
+}
+
+BOOST_AUTO_TEST_CASE(imageCache_fileStamp)
+{
+  const bfs::path path = bfs::temp_directory_path() / bfs::unique_path("imageCache_%%%%%%%%.bin");
+  BOOST_CHECK(ImageCache::getFileStamp(path.string()).empty());
+
+  {
+    bfs::ofstream file(path);
+    file << "image";
+  }
+  const std::string stamp = ImageCache::getFileStamp(path.string());
+  BOOST_CHECK(!stamp.empty());
+
+  {
+    bfs::ofstream file(path, std::ios::app);
+    file << "modified";
+  }
+  BOOST_CHECK(ImageCache::getFileStamp(path.string()) != stamp);
+
+  bfs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(imageCache_threads)
+{
+  ImageCache cache(50 * 100);
+
+  std::vector<std::thread> threads;
+  for(int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&cache, t]()
+    {
+      for(int i = 0; i < 1000; ++i)
+      {
+        const std::string path = std::to_string((i * 7 + t) % 80) + ".png";
+        const ImageCache::ImagePtr image = cache.get(path, "", "1");
+        if(image == nullptr)
+          cache.add(path, "", "1", createImage(10, 10, 1));
+        else
+          BOOST_CHECK_EQUAL(image->data.size(), 100);
+      }
+    });
+  }
+  for(std::thread& thread : threads)
+    thread.join();
+
+  const ImageCache::Stats stats = cache.getStats();
+  BOOST_CHECK_EQUAL(stats.nbHits + stats.nbMisses, 4000);
+  BOOST_CHECK_LE(stats.bytes, 50 * 100);
+  BOOST_CHECK_EQUAL(stats.bytes, stats.nbImages * 100);
+}
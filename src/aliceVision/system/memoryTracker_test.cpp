@@ -0,0 +1,190 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE memoryTracker
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::system;
+
+namespace bfs = boost::filesystem;
+
+const std::size_t MB = 1024 * 1024;
+
+const MemoryTracker::PhaseStats* findPhase(const std::vector<MemoryTracker::PhaseStats>& phases, const std::string& name)
+{
+  for(const auto& stats : phases)
+    if(stats.name == name)
+      return &stats;
+  return nullptr;
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Nested phases on several threads, merged per name
+// - The resident memory of a buffer touched in a phase is accounted to the phase
+//-----------------
+BOOST_AUTO_TEST_CASE(memoryTracker_phases)
+{
+  MemoryTracker& tracker = MemoryTracker::getInstance();
+  tracker.clearPhases();
+
+  const std::size_t bufferSize = 64 * MB;
+  {
+    ALICEVISION_MEMORY_PHASE("outer");
+    {
+      ALICEVISION_MEMORY_PHASE("inner");
+      std::unique_ptr<char[]> buffer(new char[bufferSize]);
+      std::memset(buffer.get(), 1, bufferSize);
+      tracker.allocate(bufferSize);
+      tracker.release(bufferSize);
+    }
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 3; ++i)
+      threads.emplace_back([] { ALICEVISION_MEMORY_PHASE("inner"); });
+    for(auto& thread : threads)
+      thread.join();
+  }
+
+  const std::vector<MemoryTracker::PhaseStats> phases = tracker.getPhases();
+  BOOST_REQUIRE_EQUAL(phases.size(), 2);
+  // in the order of the first start
+  BOOST_CHECK_EQUAL(phases[0].name, "outer");
+
+  const MemoryTracker::PhaseStats* outer = findPhase(phases, "outer");
+  const MemoryTracker::PhaseStats* inner = findPhase(phases, "inner");
+  BOOST_REQUIRE(outer != nullptr && inner != nullptr);
+
+  BOOST_CHECK_EQUAL(outer->count, 1);
+  BOOST_CHECK_EQUAL(inner->count, 4);
+  BOOST_CHECK_GE(inner->peakTrackedBytes, bufferSize);
+  BOOST_CHECK_GE(outer->peakTrackedBytes, bufferSize);
+  BOOST_CHECK_GE(tracker.getPeakTrackedBytes(), bufferSize);
+  BOOST_CHECK_GE(outer->duration, 0.0);
+
+  if(getUsedMemory() > 0)
+  {
+    BOOST_CHECK_GE(inner->maxRssIncrease, bufferSize / 2);
+    BOOST_CHECK_GE(outer->peakRss, inner->startRss + bufferSize / 2);
+  }
+
+  tracker.clearPhases();
+  BOOST_CHECK(tracker.getPhases().empty());
+}
+
+BOOST_AUTO_TEST_CASE(memoryTracker_trackedBytes)
+{
+  MemoryTracker& tracker = MemoryTracker::getInstance();
+  const std::size_t trackedBytes = tracker.getTrackedBytes();
+
+  tracker.allocate(10 * MB);
+  tracker.allocate(5 * MB);
+  BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes + 15 * MB);
+  BOOST_CHECK_GE(tracker.getPeakTrackedBytes(), trackedBytes + 15 * MB);
+
+  tracker.release(15 * MB);
+  BOOST_CHECK_EQUAL(tracker.getTrackedBytes(), trackedBytes);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - The listeners are asked to free the memory over the budget
+// - A removed listener is not called anymore
+// - The available memory is limited by the budget
+//-----------------
+BOOST_AUTO_TEST_CASE(memoryTracker_budget)
+{
+  MemoryTracker& tracker = MemoryTracker::getInstance();
+  tracker.setBudget(0);
+
+  BOOST_CHECK_EQUAL(tracker.getAvailableMemory(), std::numeric_limits<std::size_t>::max());
+  BOOST_CHECK(!tracker.checkBudget());
+
+  std::size_t nbCalls = 0;
+  std::size_t bytesToFree = 0;
+  auto listener = [&](std::size_t bytes)
+  {
+    ++nbCalls;
+    bytesToFree = bytes;
+  };
+
+  const std::size_t usedMemory = std::max(getUsedMemory(), tracker.getTrackedBytes());
+  const std::size_t budget = usedMemory + 256 * MB;
+  {
+    ScopedBudgetListener scopedListener(listener);
+    tracker.setBudget(budget);
+
+    const std::size_t availableMemory = tracker.getAvailableMemory();
+    BOOST_CHECK_LE(availableMemory, 256 * MB);
+    BOOST_CHECK_GT(availableMemory, 0);
+
+    // the tracked bytes exceed the budget
+    tracker.allocate(budget + 10 * MB);
+    BOOST_CHECK_EQUAL(tracker.getAvailableMemory(), 0);
+    BOOST_CHECK(tracker.checkBudget());
+    BOOST_CHECK_GE(nbCalls, 1);
+    BOOST_CHECK_EQUAL(bytesToFree, 10 * MB);
+    BOOST_CHECK_GE(tracker.getNbBudgetSignals(), 1);
+
+    tracker.release(budget + 10 * MB);
+    nbCalls = 0;
+    BOOST_CHECK(!tracker.checkBudget());
+    BOOST_CHECK_EQUAL(nbCalls, 0);
+  }
+
+  tracker.setBudget(1);
+  nbCalls = 0;
+  BOOST_CHECK(tracker.checkBudget());
+  BOOST_CHECK_EQUAL(nbCalls, 0);
+
+  tracker.setBudget(0);
+}
+
+BOOST_AUTO_TEST_CASE(memoryTracker_report)
+{
+  MemoryTracker& tracker = MemoryTracker::getInstance();
+  tracker.clearPhases();
+  {
+    ALICEVISION_MEMORY_PHASE("report \"phase\"");
+  }
+
+  const std::string path = (bfs::temp_directory_path() / bfs::unique_path("memoryReport_%%%%%%.json")).string();
+  BOOST_REQUIRE(tracker.writeReport(path));
+
+  boost::property_tree::ptree report;
+  BOOST_REQUIRE_NO_THROW(boost::property_tree::read_json(path, report));
+  bfs::remove(path);
+
+  BOOST_CHECK_EQUAL(report.get<std::size_t>("budget"), 0);
+  BOOST_CHECK_LE(report.get<std::size_t>("peakRss"), getPeakUsedMemory());
+
+  std::size_t nbPhases = 0;
+  for(const auto& phase : report.get_child("phases"))
+  {
+    ++nbPhases;
+    BOOST_CHECK_EQUAL(phase.second.get<std::string>("name"), "report \"phase\"");
+    BOOST_CHECK_EQUAL(phase.second.get<std::size_t>("count"), 1);
+  }
+  BOOST_CHECK_EQUAL(nbPhases, 1);
+
+  tracker.clearPhases();
+}
@@ -0,0 +1,156 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Profiler.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <chrono>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE profiler
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::system;
+
+namespace bfs = boost::filesystem;
+
+void sleepMs(int durationMs)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+}
+
+const Profiler::ZoneStats* findZone(const std::vector<Profiler::ZoneStats>& summary, const std::string& name)
+{
+  for(const auto& stats : summary)
+    if(stats.name == name)
+      return &stats;
+  return nullptr;
+}
+
+BOOST_AUTO_TEST_CASE(profiler_disabled)
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.disable();
+  profiler.clear();
+
+  {
+    ALICEVISION_PROFILE_ZONE("disabled");
+  }
+
+  BOOST_CHECK(profiler.getSummary().empty());
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Nested zones on several threads
+// - The self time of a zone does not count its nested zones
+//-----------------
+BOOST_AUTO_TEST_CASE(profiler_summary)
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.clear();
+  profiler.enable();
+
+  auto work = []
+  {
+    ALICEVISION_PROFILE_ZONE("outer");
+    sleepMs(10);
+    for(int i = 0; i < 2; ++i)
+    {
+      ALICEVISION_PROFILE_ZONE("inner");
+      sleepMs(10);
+    }
+  };
+
+  work();
+  std::vector<std::thread> threads;
+  for(int i = 0; i < 3; ++i)
+    threads.emplace_back(work);
+  for(auto& thread : threads)
+    thread.join();
+
+  profiler.disable();
+
+  const std::vector<Profiler::ZoneStats> summary = profiler.getSummary();
+  BOOST_REQUIRE_EQUAL(summary.size(), 2);
+  // sorted by total time
+  BOOST_CHECK_EQUAL(summary[0].name, "outer");
+
+  const Profiler::ZoneStats* outer = findZone(summary, "outer");
+  const Profiler::ZoneStats* inner = findZone(summary, "inner");
+  BOOST_REQUIRE(outer != nullptr && inner != nullptr);
+
+  BOOST_CHECK_EQUAL(outer->count, 4);
+  BOOST_CHECK_EQUAL(inner->count, 8);
+  BOOST_CHECK_GE(outer->minMs, 30.0);
+  BOOST_CHECK_GE(inner->minMs, 10.0);
+  BOOST_CHECK_LE(outer->minMs, outer->maxMs);
+  BOOST_CHECK_CLOSE(inner->totalMs, inner->selfMs, 1e-6);
+  // the self time of the outer zones only counts their first sleep
+  BOOST_CHECK_CLOSE(outer->selfMs, outer->totalMs - inner->totalMs, 1e-6);
+  BOOST_CHECK_GE(outer->selfMs, 40.0);
+  BOOST_CHECK_LT(outer->selfMs, inner->totalMs);
+
+  std::ostringstream os;
+  profiler.printSummary(os);
+  BOOST_CHECK(os.str().find("inner") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(profiler_chromeTrace)
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.clear();
+  profiler.setMaxTraceEvents(5);
+  profiler.enable();
+
+  std::thread thread([]
+  {
+    ALICEVISION_PROFILE_ZONE("thread \"zone\"");
+  });
+  thread.join();
+  for(int i = 0; i < 10; ++i)
+  {
+    ALICEVISION_PROFILE_FUNCTION();
+  }
+  profiler.disable();
+
+  const std::string path = (bfs::temp_directory_path() / bfs::unique_path("profiler_%%%%%%.json")).string();
+  BOOST_REQUIRE(profiler.writeChromeTrace(path));
+
+  boost::property_tree::ptree trace;
+  BOOST_REQUIRE_NO_THROW(boost::property_tree::read_json(path, trace));
+  bfs::remove(path);
+
+  std::size_t nbZones = 0;
+  std::set<std::string> names;
+  for(const auto& event : trace.get_child("traceEvents"))
+  {
+    if(event.second.get<std::string>("ph") != "X")
+      continue;
+    ++nbZones;
+    names.insert(event.second.get<std::string>("name"));
+    BOOST_CHECK_GE(event.second.get<double>("dur"), 0.0);
+  }
+  // the trace is limited, not the summary
+  BOOST_CHECK_EQUAL(nbZones, 5);
+  BOOST_CHECK(names.count("thread \"zone\"") == 1);
+
+  std::size_t nbSummaryZones = 0;
+  for(const auto& stats : profiler.getSummary())
+    nbSummaryZones += stats.count;
+  BOOST_CHECK_EQUAL(nbSummaryZones, 11);
+
+  profiler.setMaxTraceEvents(1000000);
+  profiler.clear();
+}
@@ -0,0 +1,715 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/config.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+
+#include <Eigen/Core>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace voctree {
+
+/**
+ * @brief Gives access to the raw values of a descriptor type for the batch quantization.
+ * Types without specialization are not supported and use the generic quantization path.
+ */
+template<class DescriptorT>
+struct BatchDescriptorTraits
+{
+  static const bool supported = false;
+};
+
+template<typename T, std::size_t N>
+struct BatchDescriptorTraits<feature::Descriptor<T, N> >
+{
+  static const bool supported = true;
+  typedef T value_type;
+  static std::size_t size() { return N; }
+  static const T* data(const feature::Descriptor<T, N>& descriptor) { return descriptor.getData(); }
+};
+
+template<typename Scalar, int Rows, int Cols, int Options, int MaxRows, int MaxCols>
+struct BatchDescriptorTraits<Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols> >
+{
+  typedef Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols> DescriptorT;
+  static const bool supported = (Rows != Eigen::Dynamic && Cols != Eigen::Dynamic);
+  typedef Scalar value_type;
+  static std::size_t size() { return Rows * Cols; }
+  static const Scalar* data(const DescriptorT& descriptor) { return descriptor.data(); }
+};
+
+namespace simd {
+
+/**
+ * @brief Squared euclidean distance between two uint8 vectors (AVX2 or SSE2 if available)
+ * @note the result is exact for vectors up to 33000 values
+ */
+inline std::int32_t l2SquaredU8(const std::uint8_t* a, const std::uint8_t* b, std::size_t size)
+{
+  std::size_t i = 0;
+  std::int32_t result = 0;
+
+#if defined(__AVX2__)
+  __m256i sum = _mm256_setzero_si256();
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    const __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+    const __m256i diff = _mm256_sub_epi16(va, vb);
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(diff, diff));
+  }
+  __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+  result = _mm_cvtsi128_si32(sum128);
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum = _mm_setzero_si128();
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    const __m128i diffLow = _mm_sub_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+    const __m128i diffHigh = _mm_sub_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(diffLow, diffLow));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(diffHigh, diffHigh));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  result = _mm_cvtsi128_si32(sum);
+#endif
+
+  for(; i < size; ++i)
+  {
+    const std::int32_t diff = static_cast<std::int32_t>(a[i]) - static_cast<std::int32_t>(b[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+/**
+ * @brief Squared euclidean distance between two float vectors (AVX2 or SSE if available)
+ */
+inline float l2SquaredF32(const float* a, const float* b, std::size_t size)
+{
+  std::size_t i = 0;
+  float result = 0.f;
+
+#if defined(__AVX2__)
+  __m256 sum = _mm256_setzero_ps();
+  for(; i + 8 <= size; i += 8)
+  {
+    const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(diff, diff));
+  }
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+  sum128 = _mm_add_ps(sum128, _mm_movehl_ps(sum128, sum128));
+  sum128 = _mm_add_ss(sum128, _mm_shuffle_ps(sum128, sum128, 1));
+  result = _mm_cvtss_f32(sum128);
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  __m128 sum = _mm_setzero_ps();
+  for(; i + 4 <= size; i += 4)
+  {
+    const __m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    sum = _mm_add_ps(sum, _mm_mul_ps(diff, diff));
+  }
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  result = _mm_cvtss_f32(sum);
+#endif
+
+  for(; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+#if defined(__AVX2__)
+inline std::int32_t horizontalSum(__m256i sum)
+{
+  __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum128);
+}
+
+inline float horizontalSum(__m256 sum)
+{
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+  sum128 = _mm_add_ps(sum128, _mm_movehl_ps(sum128, sum128));
+  sum128 = _mm_add_ss(sum128, _mm_shuffle_ps(sum128, sum128, 1));
+  return _mm_cvtss_f32(sum128);
+}
+
+inline __m256i madd8(__m256i sum, __m256i query, const std::uint8_t* center)
+{
+  const __m256i diff = _mm256_sub_epi16(query, _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(center))));
+  return _mm256_add_epi32(sum, _mm256_madd_epi16(diff, diff));
+}
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+inline std::int32_t horizontalSum(__m128i sum)
+{
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+inline float horizontalSum(__m128 sum)
+{
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+inline __m128i madd8(__m128i sum, __m128i queryLow, __m128i queryHigh, const std::uint8_t* center)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(center));
+  const __m128i diffLow = _mm_sub_epi16(queryLow, _mm_unpacklo_epi8(vc, zero));
+  const __m128i diffHigh = _mm_sub_epi16(queryHigh, _mm_unpackhi_epi8(vc, zero));
+  sum = _mm_add_epi32(sum, _mm_madd_epi16(diffLow, diffLow));
+  return _mm_add_epi32(sum, _mm_madd_epi16(diffHigh, diffHigh));
+}
+#endif
+
+/**
+ * @brief Squared euclidean distances between a uint8 vector and 4 contiguous uint8 vectors.
+ * The query values are loaded once for the 4 vectors.
+ */
+inline void l2SquaredU8x4(const std::uint8_t* query, const std::uint8_t* centers, std::size_t size, std::int32_t* distances)
+{
+  const std::uint8_t* c0 = centers;
+  const std::uint8_t* c1 = centers + size;
+  const std::uint8_t* c2 = centers + 2 * size;
+  const std::uint8_t* c3 = centers + 3 * size;
+  std::size_t i = 0;
+  distances[0] = distances[1] = distances[2] = distances[3] = 0;
+
+#if defined(__AVX2__)
+  __m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m256i q = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(query + i)));
+    sum0 = madd8(sum0, q, c0 + i);
+    sum1 = madd8(sum1, q, c1 + i);
+    sum2 = madd8(sum2, q, c2 + i);
+    sum3 = madd8(sum3, q, c3 + i);
+  }
+  distances[0] = horizontalSum(sum0);
+  distances[1] = horizontalSum(sum1);
+  distances[2] = horizontalSum(sum2);
+  distances[3] = horizontalSum(sum3);
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum0 = _mm_setzero_si128(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(query + i));
+    const __m128i qLow = _mm_unpacklo_epi8(q, zero);
+    const __m128i qHigh = _mm_unpackhi_epi8(q, zero);
+    sum0 = madd8(sum0, qLow, qHigh, c0 + i);
+    sum1 = madd8(sum1, qLow, qHigh, c1 + i);
+    sum2 = madd8(sum2, qLow, qHigh, c2 + i);
+    sum3 = madd8(sum3, qLow, qHigh, c3 + i);
+  }
+  distances[0] = horizontalSum(sum0);
+  distances[1] = horizontalSum(sum1);
+  distances[2] = horizontalSum(sum2);
+  distances[3] = horizontalSum(sum3);
+#endif
+
+  for(; i < size; ++i)
+  {
+    const std::int32_t q = query[i];
+    distances[0] += (q - c0[i]) * (q - c0[i]);
+    distances[1] += (q - c1[i]) * (q - c1[i]);
+    distances[2] += (q - c2[i]) * (q - c2[i]);
+    distances[3] += (q - c3[i]) * (q - c3[i]);
+  }
+}
+
+/**
+ * @brief Squared euclidean distances between a float vector and 4 contiguous float vectors.
+ * The query values are loaded once for the 4 vectors.
+ */
+inline void l2SquaredF32x4(const float* query, const float* centers, std::size_t size, float* distances)
+{
+  const float* c0 = centers;
+  const float* c1 = centers + size;
+  const float* c2 = centers + 2 * size;
+  const float* c3 = centers + 3 * size;
+  std::size_t i = 0;
+  distances[0] = distances[1] = distances[2] = distances[3] = 0.f;
+
+#if defined(__AVX2__)
+  __m256 sum0 = _mm256_setzero_ps(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+  for(; i + 8 <= size; i += 8)
+  {
+    const __m256 q = _mm256_loadu_ps(query + i);
+    const __m256 d0 = _mm256_sub_ps(q, _mm256_loadu_ps(c0 + i));
+    const __m256 d1 = _mm256_sub_ps(q, _mm256_loadu_ps(c1 + i));
+    const __m256 d2 = _mm256_sub_ps(q, _mm256_loadu_ps(c2 + i));
+    const __m256 d3 = _mm256_sub_ps(q, _mm256_loadu_ps(c3 + i));
+    sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(d0, d0));
+    sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(d1, d1));
+    sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(d2, d2));
+    sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(d3, d3));
+  }
+  distances[0] = horizontalSum(sum0);
+  distances[1] = horizontalSum(sum1);
+  distances[2] = horizontalSum(sum2);
+  distances[3] = horizontalSum(sum3);
+#elif ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  __m128 sum0 = _mm_setzero_ps(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+  for(; i + 4 <= size; i += 4)
+  {
+    const __m128 q = _mm_loadu_ps(query + i);
+    const __m128 d0 = _mm_sub_ps(q, _mm_loadu_ps(c0 + i));
+    const __m128 d1 = _mm_sub_ps(q, _mm_loadu_ps(c1 + i));
+    const __m128 d2 = _mm_sub_ps(q, _mm_loadu_ps(c2 + i));
+    const __m128 d3 = _mm_sub_ps(q, _mm_loadu_ps(c3 + i));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(d0, d0));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(d1, d1));
+    sum2 = _mm_add_ps(sum2, _mm_mul_ps(d2, d2));
+    sum3 = _mm_add_ps(sum3, _mm_mul_ps(d3, d3));
+  }
+  distances[0] = horizontalSum(sum0);
+  distances[1] = horizontalSum(sum1);
+  distances[2] = horizontalSum(sum2);
+  distances[3] = horizontalSum(sum3);
+#endif
+
+  for(; i < size; ++i)
+  {
+    const float d0 = query[i] - c0[i];
+    const float d1 = query[i] - c1[i];
+    const float d2 = query[i] - c2[i];
+    const float d3 = query[i] - c3[i];
+    distances[0] += d0 * d0;
+    distances[1] += d1 * d1;
+    distances[2] += d2 * d2;
+    distances[3] += d3 * d3;
+  }
+}
+
+/**
+ * @brief Squared euclidean distances between a uint8 vector and contiguous uint8 vectors
+ * @param[in] query The query vector
+ * @param[in] centers The nbCenters vectors, stored one after the other
+ * @param[in] nbCenters The number of vectors
+ * @param[in] size The size of each vector
+ * @param[out] distances The nbCenters squared distances
+ */
+inline void l2SquaredU8Batch(const std::uint8_t* query, const std::uint8_t* centers, std::size_t nbCenters, std::size_t size, std::int32_t* distances)
+{
+  std::size_t c = 0;
+  for(; c + 4 <= nbCenters; c += 4)
+    l2SquaredU8x4(query, centers + c * size, size, distances + c);
+  for(; c < nbCenters; ++c)
+    distances[c] = l2SquaredU8(query, centers + c * size, size);
+}
+
+/**
+ * @brief Squared euclidean distances between a float vector and contiguous float vectors
+ * @see l2SquaredU8Batch
+ */
+inline void l2SquaredF32Batch(const float* query, const float* centers, std::size_t nbCenters, std::size_t size, float* distances)
+{
+  std::size_t c = 0;
+  for(; c + 4 <= nbCenters; c += 4)
+    l2SquaredF32x4(query, centers + c * size, size, distances + c);
+  for(; c < nbCenters; ++c)
+    distances[c] = l2SquaredF32(query, centers + c * size, size);
+}
+
+} // namespace simd
+
+/**
+ * @brief Quantize blocks of descriptors in a vocabulary tree with SIMD distances.
+ *
+ * At each level, the descriptors of a block are grouped by node so the children centers
+ * stay in cache. The children of a node are stored contiguously, so the distances of a
+ * descriptor to all of them are computed in one vector pass:
+ * - uint8 descriptors are compared to uint8 centers. If the tree centers are float, they are
+ *   rounded to compact uint8 centers and the rounding error of each center is kept.
+ *   By the triangle inequality, only the children whose distance lower bound is below
+ *   the smallest upper bound can be the closest one.
+ * - float descriptors are compared to float centers in float precision, the children
+ *   close to the best one are kept.
+ * The remaining candidates are reranked with the exact distance of the tree, so the
+ * resulting words are always identical to VocabularyTree::quantize().
+ *
+ * The quantizer does not keep a reference on the tree centers, they are given back
+ * to quantize() to stay valid when the tree is copied.
+ * It stays empty if the descriptor type has padding, as the centers are not contiguous.
+ */
+template<class Feature>
+class BatchQuantizer
+{
+public:
+  typedef BatchDescriptorTraits<Feature> FeatureTraits;
+
+  /// Number of descriptors quantized together
+  static const std::size_t blockSize = 256;
+
+  /**
+   * @brief Prepare the quantizer for the given tree centers
+   * @param[in] centers The tree centers
+   * @param[in] validCenters The tree valid centers flags
+   * @param[in] splits The tree branching factor
+   * @param[in] levels The tree depth
+   */
+  template<class FeatureAllocator>
+  void build(const std::vector<Feature, FeatureAllocator>& centers,
+             const std::vector<std::uint8_t>& validCenters,
+             std::uint32_t splits,
+             std::uint32_t levels)
+  {
+    clear();
+    build(centers, validCenters, splits, levels, std::integral_constant<bool, FeatureTraits::supported>());
+  }
+
+  /// Release the compact centers
+  void clear()
+  {
+    _splits = 0;
+    _levels = 0;
+    _dimension = 0;
+    _compactCenters.clear();
+    _compactErrors.clear();
+  }
+
+  /// The quantizer has been built
+  inline bool empty() const { return _levels == 0; }
+
+  /// The float centers have been rounded to compact uint8 centers
+  inline bool hasCompactCenters() const { return !_compactCenters.empty(); }
+
+  /// Memory used by the compact centers in bytes
+  inline std::size_t memorySize() const
+  {
+    return _compactCenters.size() * sizeof(std::uint8_t) + _compactErrors.size() * sizeof(float);
+  }
+
+  /**
+   * @brief Check if a descriptor type can be quantized in batch with the tree centers
+   */
+  template<class DescriptorT>
+  bool supports() const
+  {
+    return !empty() && supports<DescriptorT>(std::integral_constant<bool, BatchDescriptorTraits<DescriptorT>::supported>());
+  }
+
+  /**
+   * @brief Quantize a block of descriptors into visual words
+   * @param[in] centers The tree centers (same as in build())
+   * @param[in] validCenters The tree valid centers flags (same as in build())
+   * @param[in] features The descriptors
+   * @param[in] count The number of descriptors
+   * @param[out] words The visual word (leaf index) of each descriptor
+   * @param[in] wordStart The index of the first leaf node
+   * @note supports<DescriptorT>() must be true
+   */
+  template<class DistanceT, class DescriptorT, class FeatureAllocator>
+  void quantize(const std::vector<Feature, FeatureAllocator>& centers,
+                const std::vector<std::uint8_t>& validCenters,
+                const DescriptorT* features,
+                std::size_t count,
+                std::int32_t* words,
+                std::uint32_t wordStart) const
+  {
+    std::vector<std::int32_t> nodes(count, -1); // virtual "root" index
+    std::vector<std::uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+
+    Workspace workspace(_splits);
+
+    for(std::uint32_t level = 0; level < _levels; ++level)
+    {
+      // group the descriptors by node
+      if(level > 0)
+      {
+        std::sort(order.begin(), order.end(), [&nodes](std::uint32_t a, std::uint32_t b) {
+          return nodes[a] < nodes[b] || (nodes[a] == nodes[b] && a < b);
+        });
+      }
+
+      std::int32_t currentNode = -2;
+      std::int32_t firstChild = 0;
+      std::int32_t nbChildren = 0;
+
+      for(const std::uint32_t i : order)
+      {
+        if(nodes[i] != currentNode)
+        {
+          currentNode = nodes[i];
+          firstChild = (currentNode + 1) * static_cast<std::int32_t>(_splits);
+          nbChildren = 0;
+          while(nbChildren < static_cast<std::int32_t>(_splits) && validCenters[firstChild + nbChildren])
+            ++nbChildren;
+        }
+
+        if(nbChildren <= 1)
+        {
+          nodes[i] = firstChild;
+          continue;
+        }
+
+        findCandidates(BatchDescriptorTraits<DescriptorT>::data(features[i]), firstChild, nbChildren,
+                       centers, workspace);
+
+        const std::vector<std::int32_t>& candidates = workspace.candidates;
+        nodes[i] = (candidates.size() == 1) ? candidates.front() : rerank<DistanceT>(features[i], centers, candidates);
+      }
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+      words[i] = nodes[i] - static_cast<std::int32_t>(wordStart);
+  }
+
+private:
+  /// Relative tolerance of the float distances
+  static constexpr double floatTolerance = 1e-4;
+
+  /// Distances and candidates of the children of a node
+  struct Workspace
+  {
+    explicit Workspace(std::size_t splits)
+      : distancesU8(splits)
+      , distancesF32(splits)
+      , bounds(splits)
+    {
+      candidates.reserve(splits);
+    }
+
+    std::vector<std::int32_t> distancesU8;
+    std::vector<float> distancesF32;
+    std::vector<double> bounds;
+    std::vector<std::int32_t> candidates;
+  };
+
+  template<class FeatureAllocator>
+  void build(const std::vector<Feature, FeatureAllocator>&, const std::vector<std::uint8_t>&, std::uint32_t, std::uint32_t, std::false_type)
+  {
+    // unsupported feature type: keep the quantizer empty
+  }
+
+  template<class FeatureAllocator>
+  void build(const std::vector<Feature, FeatureAllocator>& centers,
+             const std::vector<std::uint8_t>& validCenters,
+             std::uint32_t splits,
+             std::uint32_t levels,
+             std::true_type)
+  {
+    typedef typename FeatureTraits::value_type ValueT;
+
+    if(centers.empty() || centers.size() != validCenters.size())
+      return;
+
+    // the distances to the children of a node are computed on contiguous values
+    if(sizeof(Feature) != FeatureTraits::size() * sizeof(ValueT))
+      return;
+
+    _splits = splits;
+    _levels = levels;
+    _dimension = FeatureTraits::size();
+
+    if(!std::is_floating_point<ValueT>::value)
+      return;
+
+    // compact centers are only useful if all the centers are in the uint8 range
+    for(std::size_t c = 0; c < centers.size(); ++c)
+    {
+      if(!validCenters[c])
+        continue;
+      const ValueT* data = FeatureTraits::data(centers[c]);
+      for(std::size_t d = 0; d < _dimension; ++d)
+        if(!(data[d] >= 0 && data[d] <= 255))
+          return;
+    }
+
+    _compactCenters.assign(centers.size() * _dimension, 0);
+    _compactErrors.assign(centers.size(), 0.f);
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t>(centers.size()); ++c)
+    {
+      if(!validCenters[c])
+        continue;
+      const ValueT* data = FeatureTraits::data(centers[c]);
+      std::uint8_t* compact = &_compactCenters[c * _dimension];
+      double error = 0.0;
+      for(std::size_t d = 0; d < _dimension; ++d)
+      {
+        compact[d] = static_cast<std::uint8_t>(std::floor(data[d] + 0.5));
+        const double diff = static_cast<double>(data[d]) - compact[d];
+        error += diff * diff;
+      }
+      // round the error up to keep a valid bound
+      _compactErrors[c] = static_cast<float>(std::sqrt(error) * (1.0 + 1e-6)) + 1e-6f;
+    }
+  }
+
+  template<class DescriptorT>
+  bool supports(std::false_type) const
+  {
+    return false;
+  }
+
+  template<class DescriptorT>
+  bool supports(std::true_type) const
+  {
+    typedef typename BatchDescriptorTraits<DescriptorT>::value_type QueryValueT;
+    typedef typename FeatureTraits::value_type CenterValueT;
+
+    if(BatchDescriptorTraits<DescriptorT>::size() != _dimension)
+      return false;
+    if(std::is_same<QueryValueT, unsigned char>::value)
+      return std::is_same<CenterValueT, unsigned char>::value || hasCompactCenters();
+    return std::is_same<QueryValueT, float>::value && std::is_same<CenterValueT, float>::value;
+  }
+
+  /// Get the uint8 values of a center (tree centers already stored as uint8)
+  template<class FeatureAllocator>
+  const std::uint8_t* centerU8(const std::vector<Feature, FeatureAllocator>& centers, std::int32_t c, std::true_type) const
+  {
+    return reinterpret_cast<const std::uint8_t*>(FeatureTraits::data(centers[c]));
+  }
+
+  /// Get the uint8 values of a center (compact centers)
+  template<class FeatureAllocator>
+  const std::uint8_t* centerU8(const std::vector<Feature, FeatureAllocator>&, std::int32_t c, std::false_type) const
+  {
+    return &_compactCenters[c * _dimension];
+  }
+
+  /// Select the children that can be the closest to a uint8 descriptor
+  template<class FeatureAllocator>
+  void findCandidates(const unsigned char* query,
+                      std::int32_t firstChild,
+                      std::int32_t nbChildren,
+                      const std::vector<Feature, FeatureAllocator>& centers,
+                      Workspace& workspace) const
+  {
+    typedef std::is_same<typename FeatureTraits::value_type, unsigned char> IsCenterU8;
+
+    simd::l2SquaredU8Batch(query, centerU8(centers, firstChild, IsCenterU8()), nbChildren, _dimension, workspace.distancesU8.data());
+
+    double minUpperBound = std::numeric_limits<double>::max();
+    for(std::int32_t c = 0; c < nbChildren; ++c)
+    {
+      const double distance = std::sqrt(static_cast<double>(workspace.distancesU8[c]));
+      const double error = IsCenterU8::value ? 0.0 : _compactErrors[firstChild + c];
+      workspace.bounds[c] = distance - error;
+      minUpperBound = std::min(minUpperBound, distance + error);
+    }
+
+    workspace.candidates.clear();
+    for(std::int32_t c = 0; c < nbChildren; ++c)
+      if(workspace.bounds[c] <= minUpperBound)
+        workspace.candidates.push_back(firstChild + c);
+  }
+
+  /// Select the children that can be the closest to a float descriptor
+  template<class FeatureAllocator>
+  void findCandidates(const float* query,
+                      std::int32_t firstChild,
+                      std::int32_t nbChildren,
+                      const std::vector<Feature, FeatureAllocator>& centers,
+                      Workspace& workspace) const
+  {
+    if(!std::is_same<typename FeatureTraits::value_type, float>::value)
+    {
+      allCandidates(firstChild, nbChildren, workspace.candidates);
+      return;
+    }
+
+    const float* firstCenter = reinterpret_cast<const float*>(FeatureTraits::data(centers[firstChild]));
+    simd::l2SquaredF32Batch(query, firstCenter, nbChildren, _dimension, workspace.distancesF32.data());
+
+    const float minDistance = *std::min_element(workspace.distancesF32.begin(), workspace.distancesF32.begin() + nbChildren);
+    const double threshold = minDistance * (1.0 + floatTolerance) + std::numeric_limits<float>::min();
+    workspace.candidates.clear();
+    for(std::int32_t c = 0; c < nbChildren; ++c)
+      if(workspace.distancesF32[c] <= threshold)
+        workspace.candidates.push_back(firstChild + c);
+  }
+
+  /// Other descriptor types: all the children are candidates
+  template<class T, class FeatureAllocator>
+  void findCandidates(const T*,
+                      std::int32_t firstChild,
+                      std::int32_t nbChildren,
+                      const std::vector<Feature, FeatureAllocator>&,
+                      Workspace& workspace) const
+  {
+    allCandidates(firstChild, nbChildren, workspace.candidates);
+  }
+
+  static void allCandidates(std::int32_t firstChild, std::int32_t nbChildren, std::vector<std::int32_t>& candidates)
+  {
+    candidates.resize(nbChildren);
+    std::iota(candidates.begin(), candidates.end(), firstChild);
+  }
+
+  /// Exact distance on the candidates, same tie-breaking as VocabularyTree::quantize()
+  template<class DistanceT, class DescriptorT, class FeatureAllocator>
+  static std::int32_t rerank(const DescriptorT& feature,
+                             const std::vector<Feature, FeatureAllocator>& centers,
+                             const std::vector<std::int32_t>& candidates)
+  {
+    typedef typename DistanceT::result_type distance_type;
+
+    std::int32_t bestChild = candidates.front();
+    distance_type bestDistance = std::numeric_limits<distance_type>::max();
+    for(const std::int32_t child : candidates)
+    {
+      const distance_type distance = DistanceT()(feature, centers[child]);
+      if(distance < bestDistance)
+      {
+        bestChild = child;
+        bestDistance = distance;
+      }
+    }
+    return bestChild;
+  }
+
+  std::uint32_t _splits = 0;
+  std::uint32_t _levels = 0;
+  std::size_t _dimension = 0;
+  /// float centers rounded to uint8 (empty if the tree centers are not float)
+  std::vector<std::uint8_t> _compactCenters;
+  /// euclidean distance between each float center and its compact center (rounded up)
+  std::vector<float> _compactErrors;
+};
+
+template<class Feature>
+const std::size_t BatchQuantizer<Feature>::blockSize;
+
+template<class Feature>
+constexpr double BatchQuantizer<Feature>::floatTolerance;
+
+} // namespace voctree
+} // namespace aliceVision
@@ -0,0 +1,369 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "MutableVocabularyTree.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace aliceVision {
+namespace voctree {
+
+/**
+ * @brief Class for building a new vocabulary with a hierarchical mini-batch k-means,
+ * without keeping the training features in memory.
+ *
+ * The tree is built level by level. For each level, the training features are streamed
+ * from a reader (see DescriptorFileReader):
+ * - a first pass routes each feature to its node in the current tree and keeps a reservoir
+ *   sample of the features of each node, the k children of each node are seeded with
+ *   k-means++ on this sample;
+ * - the next passes read mini-batches of features, assign them in parallel to the closest
+ *   child of their node and move the children centers with a per-center learning rate
+ *   (Sculley, "Web-scale k-means clustering", WWW 2010).
+ *
+ * A node with k features or less uses them as children centers, the others are marked invalid
+ * as in TreeBuilder.
+ *
+ * The reader must provide:
+ * - void rewind(): go back to the first feature;
+ * - std::size_t read(FeatureVector& features, std::size_t maxCount): read the next features.
+ */
+template<class Feature,
+         template<typename, typename> class DistanceT = L2,
+         class FeatureAllocator = typename DefaultAllocator<Feature>::type>
+class MiniBatchTreeBuilder
+{
+public:
+  typedef MutableVocabularyTree<Feature, DistanceT, FeatureAllocator> Tree;
+  typedef DistanceT<Feature, Feature> Distance;
+  typedef typename Distance::result_type squared_distance_type;
+  typedef std::vector<Feature, FeatureAllocator> FeatureVector;
+
+  /**
+   * @brief Constructor
+   *
+   * @param zero Object representing zero in the feature space
+   * @param d    Functor for calculating squared distance
+   */
+  MiniBatchTreeBuilder(const Feature& zero = Feature(), Distance d = Distance())
+    : zero_(zero)
+    , distance_(d)
+  {}
+
+  /**
+   * @brief Build a new vocabulary tree from a feature reader.
+   *
+   * The number of words in the resulting vocabulary is at most k ^ levels.
+   *
+   * @param reader The training features reader, it is read (1 + iterations) times per level.
+   * @param k      The branching factor, or max children of any node.
+   * @param levels The number of levels in the tree.
+   */
+  template<class FeatureReader>
+  void buildFromReader(FeatureReader& reader, uint32_t k, uint32_t levels);
+
+  /**
+   * @brief Build a new vocabulary tree from features in memory.
+   * @see buildFromReader()
+   */
+  void build(const FeatureVector& training_features, uint32_t k, uint32_t levels)
+  {
+    FeatureVectorReader reader(training_features);
+    buildFromReader(reader, k, levels);
+  }
+
+  /// Get the built vocabulary tree.
+  const Tree& tree() const
+  {
+    return tree_;
+  }
+
+  /// Number of features in each mini-batch.
+  std::size_t getBatchSize() const { return batchSize_; }
+  void setBatchSize(std::size_t batchSize) { batchSize_ = std::max<std::size_t>(1, batchSize); }
+
+  /// Number of mini-batch passes over the training features per level.
+  std::size_t getIterations() const { return iterations_; }
+  void setIterations(std::size_t iterations) { iterations_ = iterations; }
+
+  /// Maximum number of features sampled per level for the k-means++ seeding (shared by the nodes).
+  std::size_t getMaxSamples() const { return maxSamples_; }
+  void setMaxSamples(std::size_t maxSamples) { maxSamples_ = maxSamples; }
+
+  /// Seed of the random generators.
+  unsigned int getRandomSeed() const { return randomSeed_; }
+  void setRandomSeed(unsigned int seed) { randomSeed_ = seed; }
+
+private:
+  /// Reader on a vector of features in memory
+  class FeatureVectorReader
+  {
+  public:
+    explicit FeatureVectorReader(const FeatureVector& features)
+      : features_(features)
+    {}
+
+    void rewind() { position_ = 0; }
+
+    std::size_t read(FeatureVector& features, std::size_t maxCount)
+    {
+      const std::size_t count = std::min(maxCount, features_.size() - position_);
+      features.assign(features_.begin() + position_, features_.begin() + position_ + count);
+      position_ += count;
+      return count;
+    }
+
+  private:
+    const FeatureVector& features_;
+    std::size_t position_ = 0;
+  };
+
+  /**
+   * @brief Descend the tree from the root to the given depth
+   * @return the index of the node, -1 for the root, -2 if the feature reaches an invalid node
+   */
+  int32_t findNode(const Feature& feature, uint32_t depth) const;
+
+  /// Find the closest valid child of a node, -1 if the node has no valid child
+  int32_t findClosestChild(const Feature& feature, int32_t node) const;
+
+  /// Choose k centers among the samples with the k-means++ algorithm
+  void seedCenters(const FeatureVector& samples, std::size_t firstChild, std::mt19937& generator);
+
+  Tree tree_;
+  Feature zero_;
+  Distance distance_;
+  uint32_t k_ = 0;
+  std::size_t batchSize_ = 10000;
+  std::size_t iterations_ = 2;
+  std::size_t maxSamples_ = 1000000;
+  unsigned int randomSeed_ = 0;
+};
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+template<class FeatureReader>
+void MiniBatchTreeBuilder<Feature, DistanceT, FeatureAllocator>::buildFromReader(FeatureReader& reader, uint32_t k, uint32_t levels)
+{
+  typedef typename Distance::value_type feature_value_type;
+
+  // Initial setup and memory allocation for the tree
+  k_ = k;
+  tree_.clear();
+  tree_.setSize(levels, k);
+  std::vector<Feature, FeatureAllocator>& centers = tree_.centers();
+  std::vector<uint8_t>& validCenters = tree_.validCenters();
+  centers.assign(tree_.nodes(), zero_);
+  validCenters.assign(tree_.nodes(), 0);
+
+  FeatureVector batch;
+  std::vector<int32_t> nodes;
+
+  std::size_t levelStart = 0; // index of the first node of the level
+  std::size_t nbParents = 1;  // number of nodes of the previous level
+
+  for(uint32_t level = 0; level < levels; ++level)
+  {
+    ALICEVISION_LOG_INFO("Mini-batch k-means: level " << level + 1 << "/" << levels << " (" << nbParents << " nodes to split)");
+
+    // 1. Route the features to their node and keep a reservoir sample of each node
+    const std::size_t reservoirSize = std::max<std::size_t>(k, maxSamples_ / nbParents);
+    std::vector<std::size_t> nbFeatures(nbParents, 0);
+    std::vector<FeatureVector> reservoirs(nbParents);
+    std::mt19937 generator(randomSeed_ + level);
+
+    reader.rewind();
+    while(reader.read(batch, batchSize_) > 0)
+    {
+      nodes.resize(batch.size());
+
+      #pragma omp parallel for
+      for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(batch.size()); ++i)
+        nodes[i] = findNode(batch[i], level);
+
+      for(std::size_t i = 0; i < batch.size(); ++i)
+      {
+        if(nodes[i] == -2)
+          continue;
+        const std::size_t parent = ((nodes[i] + 1) * k - levelStart) / k;
+        const std::size_t count = ++nbFeatures[parent];
+        FeatureVector& reservoir = reservoirs[parent];
+
+        if(reservoir.size() < reservoirSize)
+        {
+          reservoir.push_back(batch[i]);
+        }
+        else
+        {
+          const std::size_t j = std::uniform_int_distribution<std::size_t>(0, count - 1)(generator);
+          if(j < reservoirSize)
+            reservoir[j] = batch[i];
+        }
+      }
+    }
+
+    // 2. Seed the children of each node
+    std::vector<uint8_t> isClustered(nbParents, 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for(ptrdiff_t parent = 0; parent < static_cast<ptrdiff_t>(nbParents); ++parent)
+    {
+      const std::size_t firstChild = levelStart + parent * k;
+      const FeatureVector& reservoir = reservoirs[parent];
+
+      if(nbFeatures[parent] <= k)
+      {
+        // no need to cluster: use the features as centers, the other children are invalid
+        for(std::size_t j = 0; j < reservoir.size(); ++j)
+        {
+          centers[firstChild + j] = reservoir[j];
+          validCenters[firstChild + j] = 1;
+        }
+        continue;
+      }
+
+      std::mt19937 parentGenerator(randomSeed_ + level * 7919u + static_cast<unsigned int>(parent) * 104729u);
+      seedCenters(reservoir, firstChild, parentGenerator);
+      std::fill(validCenters.begin() + firstChild, validCenters.begin() + firstChild + k, 1);
+      isClustered[parent] = 1;
+    }
+    reservoirs.clear();
+
+    // 3. Mini-batch updates of the children centers
+    std::vector<std::size_t> nbUpdates(nbParents * k, 1);
+
+    for(std::size_t iteration = 0; iteration < iterations_; ++iteration)
+    {
+      ALICEVISION_LOG_DEBUG("Mini-batch k-means: level " << level + 1 << ", iteration " << iteration + 1 << "/" << iterations_);
+
+      reader.rewind();
+      while(reader.read(batch, batchSize_) > 0)
+      {
+        nodes.resize(batch.size());
+
+        // assign the mini-batch to the current centers
+        #pragma omp parallel for
+        for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(batch.size()); ++i)
+        {
+          const int32_t node = findNode(batch[i], level);
+          nodes[i] = (node == -2) ? -1 : findClosestChild(batch[i], node);
+        }
+
+        // move each center toward its features with a decreasing learning rate
+        for(std::size_t i = 0; i < batch.size(); ++i)
+        {
+          if(nodes[i] < 0)
+            continue;
+          const std::size_t child = nodes[i] - levelStart;
+          if(!isClustered[child / k])
+            continue;
+
+          const feature_value_type learningRate = static_cast<feature_value_type>(1.0 / ++nbUpdates[child]);
+          Feature& center = centers[nodes[i]];
+          Feature step = batch[i];
+          step *= learningRate;
+          center *= static_cast<feature_value_type>(1) - learningRate;
+          center += step;
+        }
+      }
+    }
+
+    levelStart += nbParents * k;
+    nbParents *= k;
+  }
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+int32_t MiniBatchTreeBuilder<Feature, DistanceT, FeatureAllocator>::findNode(const Feature& feature, uint32_t depth) const
+{
+  int32_t index = -1; // virtual "root" index
+  for(uint32_t level = 0; level < depth; ++level)
+  {
+    index = findClosestChild(feature, index);
+    if(index < 0)
+      return -2;
+  }
+  return index;
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+int32_t MiniBatchTreeBuilder<Feature, DistanceT, FeatureAllocator>::findClosestChild(const Feature& feature, int32_t node) const
+{
+  const std::vector<Feature, FeatureAllocator>& centers = tree_.centers();
+  const std::vector<uint8_t>& validCenters = tree_.validCenters();
+
+  const int32_t firstChild = (node + 1) * k_;
+  int32_t bestChild = -1;
+  squared_distance_type bestDistance = std::numeric_limits<squared_distance_type>::max();
+  for(int32_t child = firstChild; child < firstChild + static_cast<int32_t>(k_); ++child)
+  {
+    if(!validCenters[child])
+      break; // Fewer than k children.
+    const squared_distance_type distance = distance_(feature, centers[child]);
+    if(distance < bestDistance)
+    {
+      bestChild = child;
+      bestDistance = distance;
+    }
+  }
+  return bestChild;
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+void MiniBatchTreeBuilder<Feature, DistanceT, FeatureAllocator>::seedCenters(const FeatureVector& samples,
+                                                                             std::size_t firstChild,
+                                                                             std::mt19937& generator)
+{
+  std::vector<Feature, FeatureAllocator>& centers = tree_.centers();
+  std::vector<double> distances(samples.size(), std::numeric_limits<double>::max());
+
+  // 1. Choose a random center
+  std::size_t chosen = std::uniform_int_distribution<std::size_t>(0, samples.size() - 1)(generator);
+  centers[firstChild] = samples[chosen];
+
+  for(std::size_t c = 1; c < k_; ++c)
+  {
+    // 2. Update the distance of each sample to its closest center
+    double sum = 0.0;
+    for(std::size_t i = 0; i < samples.size(); ++i)
+    {
+      distances[i] = std::min(distances[i], static_cast<double>(distance_(samples[i], centers[firstChild + c - 1])));
+      sum += distances[i];
+    }
+
+    // 3. Choose a sample with a probability proportional to its squared distance
+    if(sum > 0.0)
+    {
+      double partial = std::uniform_real_distribution<double>(0.0, sum)(generator);
+      chosen = samples.size() - 1;
+      for(std::size_t i = 0; i < samples.size(); ++i)
+      {
+        partial -= distances[i];
+        if(partial < 0.0)
+        {
+          chosen = i;
+          break;
+        }
+      }
+    }
+    else
+    {
+      // all the samples are on the centers
+      chosen = std::uniform_int_distribution<std::size_t>(0, samples.size() - 1)(generator);
+    }
+    centers[firstChild + c] = samples[chosen];
+  }
+}
+
+}
+}
@@ -24,12 +24,17 @@ class MutableVocabularyTree : public VocabularyTree<Feature, Distance, FeatureAl
   typedef VocabularyTree<Feature, Distance, FeatureAllocator> BaseClass;
 
 public:
+  using BaseClass::centers;
+  using BaseClass::validCenters;
+  using BaseClass::invalidateQuantizer;
+
   MutableVocabularyTree()
   {
   }
 
   void setSize(uint32_t levels, uint32_t splits)
   {
+    this->invalidateQuantizer();
     this->levels_ = levels;
     this->k_ = splits;
     this->setNodeCounts();
@@ -40,25 +45,17 @@ public:
     return this->word_start_ + this->num_words_;
   }
 
+  /// @note call invalidateQuantizer() after modifying the centers of a tree already used to quantize
   std::vector<Feature, FeatureAllocator>& centers()
   {
     return this->centers_;
   }
 
-  const std::vector<Feature, FeatureAllocator>& centers() const
-  {
-    return this->centers_;
-  }
-
+  /// @note call invalidateQuantizer() after modifying the centers of a tree already used to quantize
   std::vector<uint8_t>& validCenters()
   {
     return this->valid_centers_;
   }
-
-  const std::vector<uint8_t>& validCenters() const
-  {
-    return this->valid_centers_;
-  }
 };
 
 }
@@ -9,6 +9,7 @@
 #include <aliceVision/config.hpp>
 #include "distance.hpp"
 #include "DefaultAllocator.hpp"
+#include "BatchQuantizer.hpp"
 
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/regionsFactory.hpp>
@@ -24,6 +25,8 @@
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
+#include <memory>
+#include <type_traits>
 
 
 namespace aliceVision {
@@ -117,10 +120,23 @@ public:
   template<class DescriptorT>
   Word quantize(const DescriptorT& feature) const;
 
-  /// Quantizes a set of features into visual words.
+  /**
+   * @brief Quantizes a set of features into visual words.
+   * @note Uses the batch quantizer when it supports the feature type,
+   * the result is the same as quantizing each feature.
+   * The batch quantizer is built on the first call.
+   */
   template<class DescriptorT>
   std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
+  /// Check if a set of features of this type is quantized in batch.
+  template<class DescriptorT>
+  bool isBatchQuantized() const
+  {
+    return std::is_same<Distance<DescriptorT, Feature>, L2<DescriptorT, Feature> >::value &&
+           batchQuantizer()->template supports<DescriptorT>();
+  }
+
   /// Quantizes a set of features into sparse histogram of visual words.
   template<class DescriptorT>
   SparseHistogram quantizeToSparse(const std::vector<DescriptorT>& features) const;
@@ -146,6 +162,16 @@ public:
   /// Load vocabulary from a file.
   void load(const std::string& file) override;
 
+  const std::vector<Feature, FeatureAllocator>& centers() const
+  {
+    return centers_;
+  }
+
+  const std::vector<uint8_t>& validCenters() const
+  {
+    return valid_centers_;
+  }
+
   bool operator==(const VocabularyTree& other) const
   {
     return (centers_ == other.centers_) &&
@@ -170,7 +196,23 @@ protected:
     return num_words_ != 0;
   }
 
+  /**
+   * @brief Release the batch quantizer, it is built again from the centers on the next quantization.
+   * @note Must be called after modifying the centers of a tree already used to quantize.
+   */
+  void invalidateQuantizer()
+  {
+    std::atomic_store(&batch_quantizer_, std::shared_ptr<const BatchQuantizer<Feature> >());
+  }
+
+  /// Get the batch quantizer, build it from the centers if needed
+  std::shared_ptr<const BatchQuantizer<Feature> > batchQuantizer() const;
+
   void setNodeCounts();
+
+private:
+  /// built on the first quantization, shared between the copies of the tree
+  mutable std::shared_ptr<const BatchQuantizer<Feature> > batch_quantizer_;
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -227,6 +269,25 @@ std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(
   // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
   std::vector<Word> imgVisualWords(features.size(), 0);
 
+  if(isBatchQuantized<DescriptorT>())
+  {
+    const std::shared_ptr<const BatchQuantizer<Feature> > batchQuantizer = this->batchQuantizer();
+    const std::size_t blockSize = BatchQuantizer<Feature>::blockSize;
+    const std::size_t nbBlocks = (features.size() + blockSize - 1) / blockSize;
+
+    // quantize the features by blocks
+    #pragma omp parallel for
+    for(ptrdiff_t b = 0; b < static_cast<ptrdiff_t>(nbBlocks); ++b)
+    {
+      const std::size_t begin = b * blockSize;
+      const std::size_t count = std::min(blockSize, features.size() - begin);
+      batchQuantizer->template quantize<Distance<DescriptorT, Feature> >(centers_, valid_centers_,
+                                                                         &features[begin], count,
+                                                                         &imgVisualWords[begin], word_start_);
+    }
+    return imgVisualWords;
+  }
+
   // quantize the features
   #pragma omp parallel for
   for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
@@ -272,6 +333,7 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::clear()
 {
   centers_.clear();
   valid_centers_.clear();
+  invalidateQuantizer();
   k_ = levels_ = num_words_ = word_start_ = 0;
 }
 
@@ -320,6 +382,21 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string
   assert(size == num_words_ + word_start_);
 }
 
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+std::shared_ptr<const BatchQuantizer<Feature> > VocabularyTree<Feature, Distance, FeatureAllocator>::batchQuantizer() const
+{
+  std::shared_ptr<const BatchQuantizer<Feature> > batchQuantizer = std::atomic_load(&batch_quantizer_);
+  if(batchQuantizer)
+    return batchQuantizer;
+
+  // concurrent builds give the same quantizer, the last one is kept
+  std::shared_ptr<BatchQuantizer<Feature> > newBatchQuantizer = std::make_shared<BatchQuantizer<Feature> >();
+  newBatchQuantizer->build(centers_, valid_centers_, k_, levels_);
+  batchQuantizer = newBatchQuantizer;
+  std::atomic_store(&batch_quantizer_, batchQuantizer);
+  return batchQuantizer;
+}
+
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 void VocabularyTree<Feature, Distance, FeatureAllocator>::setNodeCounts()
 {
@@ -0,0 +1,191 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE voctreeBatchQuantizer
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+
+static const std::size_t DIMENSION = 128;
+
+typedef feature::Descriptor<float, DIMENSION> DescriptorFloat;
+typedef feature::Descriptor<unsigned char, DIMENSION> DescriptorUChar;
+
+/**
+ * @brief Create a random tree, some nodes have less children than the branching factor
+ * and some children have the same center to check the tie-breaking.
+ */
+template<class Feature>
+void createTree(const std::string& treeName, std::uint32_t levels, std::uint32_t splits, std::mt19937& generator)
+{
+  std::uniform_real_distribution<float> distribution(0.f, 255.f);
+
+  voctree::MutableVocabularyTree<Feature> tree;
+  tree.setSize(levels, splits);
+  tree.centers().resize(tree.nodes());
+  tree.validCenters().resize(tree.nodes(), 1);
+
+  for(std::size_t c = 0; c < tree.nodes(); ++c)
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      tree.centers()[c][d] = static_cast<typename Feature::value_type>(distribution(generator));
+
+  for(std::size_t firstChild = 0; firstChild < tree.nodes(); firstChild += splits)
+  {
+    const std::size_t parent = firstChild / splits;
+    if(parent % 3 == 1)
+      tree.validCenters()[firstChild + splits - 1] = 0;
+    if(parent % 5 == 2)
+      tree.centers()[firstChild + 1] = tree.centers()[firstChild];
+  }
+
+  tree.save(treeName);
+}
+
+template<class Feature, class DescriptorT>
+void checkSameWords(const voctree::VocabularyTree<Feature>& tree, const std::vector<DescriptorT>& descriptors)
+{
+  BOOST_CHECK(tree.template isBatchQuantized<DescriptorT>());
+
+  const std::vector<voctree::Word> words = tree.quantize(descriptors);
+  BOOST_CHECK_EQUAL(words.size(), descriptors.size());
+
+  std::size_t nbDifferent = 0;
+  for(std::size_t i = 0; i < descriptors.size(); ++i)
+    if(words[i] != tree.quantize(descriptors[i]))
+      ++nbDifferent;
+  BOOST_CHECK_EQUAL(nbDifferent, 0);
+}
+
+template<class DescriptorT>
+std::vector<DescriptorT> createDescriptors(const std::vector<DescriptorT>& centers, std::size_t nbDescriptors, std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> value(0, 255);
+  std::uniform_int_distribution<std::size_t> center(0, centers.size() - 1);
+
+  std::vector<DescriptorT> descriptors(nbDescriptors);
+  for(std::size_t i = 0; i < nbDescriptors; ++i)
+  {
+    if(i % 4 == 0)
+    {
+      // exactly on a center
+      descriptors[i] = centers[center(generator)];
+      continue;
+    }
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      descriptors[i][d] = static_cast<typename DescriptorT::value_type>(value(generator));
+  }
+  return descriptors;
+}
+
+BOOST_AUTO_TEST_CASE(batchQuantizer_floatCenters)
+{
+  std::mt19937 generator(42);
+  const std::string treeName = "batchQuantizerFloat.tree";
+  createTree<DescriptorFloat>(treeName, 3, 10, generator);
+
+  const voctree::VocabularyTree<DescriptorFloat> tree(treeName);
+
+  // centers rounded to uint8 for uint8 descriptors
+  std::vector<DescriptorUChar> centersUChar(tree.centers().size());
+  for(std::size_t c = 0; c < centersUChar.size(); ++c)
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      centersUChar[c][d] = static_cast<unsigned char>(tree.centers()[c][d] + 0.5f);
+
+  checkSameWords(tree, createDescriptors(centersUChar, 1000, generator));
+
+  const std::vector<DescriptorFloat> centersFloat(tree.centers().begin(), tree.centers().end());
+  checkSameWords(tree, createDescriptors(centersFloat, 1000, generator));
+}
+
+BOOST_AUTO_TEST_CASE(batchQuantizer_ucharCenters)
+{
+  std::mt19937 generator(42);
+  const std::string treeName = "batchQuantizerUChar.tree";
+  createTree<DescriptorUChar>(treeName, 3, 10, generator);
+
+  const voctree::VocabularyTree<DescriptorUChar> tree(treeName);
+
+  const std::vector<DescriptorUChar> centers(tree.centers().begin(), tree.centers().end());
+  checkSameWords(tree, createDescriptors(centers, 1000, generator));
+
+  // float descriptors are not supported with uint8 centers
+  BOOST_CHECK(!tree.isBatchQuantized<DescriptorFloat>());
+}
+
+BOOST_AUTO_TEST_CASE(batchQuantizer_modifiedCenters)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(0.f, 255.f);
+  const std::string treeName = "batchQuantizerModified.tree";
+  createTree<DescriptorFloat>(treeName, 2, 10, generator);
+
+  voctree::MutableVocabularyTree<DescriptorFloat> tree;
+  tree.load(treeName);
+
+  // the quantizer is built on the first quantization
+  const std::vector<DescriptorFloat> centers(tree.centers().begin(), tree.centers().end());
+  checkSameWords(tree, createDescriptors(centers, 1000, generator));
+
+  // new centers, the quantizer is built again after the invalidation
+  for(DescriptorFloat& center : tree.centers())
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      center[d] = distribution(generator);
+  tree.invalidateQuantizer();
+
+  const std::vector<DescriptorFloat> newCenters(tree.centers().begin(), tree.centers().end());
+  checkSameWords(tree, createDescriptors(newCenters, 1000, generator));
+}
+
+BOOST_AUTO_TEST_CASE(batchQuantizer_simdDistances)
+{
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> value(0, 255);
+
+  // odd size to check the scalar tail
+  const std::size_t size = 131;
+  std::vector<std::uint8_t> a(size), b(size);
+  std::vector<float> af(size), bf(size);
+  std::int32_t expected = 0;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    a[i] = value(generator);
+    b[i] = value(generator);
+    af[i] = a[i];
+    bf[i] = b[i];
+    expected += (a[i] - b[i]) * (a[i] - b[i]);
+  }
+
+  BOOST_CHECK_EQUAL(voctree::simd::l2SquaredU8(a.data(), b.data(), size), expected);
+  BOOST_CHECK_CLOSE(voctree::simd::l2SquaredF32(af.data(), bf.data(), size), static_cast<float>(expected), 1e-4);
+
+  // distances to contiguous centers, by groups of 4 and a tail
+  const std::size_t nbCenters = 7;
+  std::vector<std::uint8_t> centers(nbCenters * size);
+  std::vector<float> centersF(nbCenters * size);
+  for(std::size_t i = 0; i < centers.size(); ++i)
+  {
+    centers[i] = value(generator);
+    centersF[i] = centers[i];
+  }
+
+  std::vector<std::int32_t> distances(nbCenters);
+  std::vector<float> distancesF(nbCenters);
+  voctree::simd::l2SquaredU8Batch(a.data(), centers.data(), nbCenters, size, distances.data());
+  voctree::simd::l2SquaredF32Batch(af.data(), centersF.data(), nbCenters, size, distancesF.data());
+  for(std::size_t c = 0; c < nbCenters; ++c)
+  {
+    BOOST_CHECK_EQUAL(distances[c], voctree::simd::l2SquaredU8(a.data(), &centers[c * size], size));
+    BOOST_CHECK_CLOSE(distancesF[c], static_cast<float>(distances[c]), 1e-4);
+  }
+}
@@ -11,7 +11,10 @@
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 
+#include <fstream>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace voctree {
@@ -52,6 +55,54 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                          std::vector<DescriptorT>& descriptors,
                          std::vector<std::size_t>& numFeatures);
 
+/**
+ * @brief Read the descriptors of a set of .desc files by batches, without loading all of them in memory.
+ *
+ * The files are read in the order of their view id. \p DescriptorT is the type of descriptor
+ * in which to store the data, \p FileDescriptorT is the type of descriptors stored in the files.
+ */
+template<class DescriptorT, class FileDescriptorT>
+class DescriptorFileReader
+{
+public:
+  /**
+   * @brief Constructor
+   * @param[in] descriptorsFiles The descriptor files per view id (see getListOfDescriptorFiles)
+   */
+  explicit DescriptorFileReader(const std::map<IndexT, std::string>& descriptorsFiles);
+
+  /**
+   * @brief Constructor
+   * @param[in] sfmData The input sfmData
+   * @param[in] featuresFolders The folder(s) containing the descriptor files
+   */
+  DescriptorFileReader(const sfmData::SfMData& sfmData, const std::vector<std::string>& featuresFolders);
+
+  /// Go back to the first descriptor of the first file.
+  void rewind();
+
+  /**
+   * @brief Read the next descriptors, across the files
+   * @param[out] descriptors The read descriptors (previous content is cleared)
+   * @param[in] maxCount The maximum number of descriptors to read
+   * @return the number of read descriptors, 0 once all the files have been read
+   */
+  std::size_t read(std::vector<DescriptorT>& descriptors, std::size_t maxCount);
+
+  /// Get the number of descriptor files.
+  std::size_t getNbFiles() const { return _files.size(); }
+
+private:
+  /// Open the next file and read its number of descriptors, return false if there is no more file
+  bool openNextFile();
+
+  std::vector<std::string> _files;
+  std::size_t _nextFile = 0;
+  std::size_t _remainingInFile = 0;
+  std::ifstream _fileIn;
+  std::vector<FileDescriptorT> _fileBuffer;
+};
+
 } // namespace voctree
 } // namespace aliceVision
 
@@ -11,8 +11,10 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/progress.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 namespace aliceVision {
 namespace voctree {
@@ -89,5 +91,93 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
   return numDescriptors;
 }
 
+template<class DescriptorT, class FileDescriptorT>
+DescriptorFileReader<DescriptorT, FileDescriptorT>::DescriptorFileReader(const std::map<IndexT, std::string>& descriptorsFiles)
+{
+  _files.reserve(descriptorsFiles.size());
+  for(const auto& currentFile : descriptorsFiles)
+    _files.push_back(currentFile.second);
+}
+
+template<class DescriptorT, class FileDescriptorT>
+DescriptorFileReader<DescriptorT, FileDescriptorT>::DescriptorFileReader(const sfmData::SfMData& sfmData,
+                                                                       const std::vector<std::string>& featuresFolders)
+{
+  std::map<IndexT, std::string> descriptorsFiles;
+  getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFiles);
+
+  _files.reserve(descriptorsFiles.size());
+  for(const auto& currentFile : descriptorsFiles)
+    _files.push_back(currentFile.second);
+}
+
+template<class DescriptorT, class FileDescriptorT>
+void DescriptorFileReader<DescriptorT, FileDescriptorT>::rewind()
+{
+  if(_fileIn.is_open())
+    _fileIn.close();
+  _nextFile = 0;
+  _remainingInFile = 0;
+}
+
+template<class DescriptorT, class FileDescriptorT>
+bool DescriptorFileReader<DescriptorT, FileDescriptorT>::openNextFile()
+{
+  if(_fileIn.is_open())
+    _fileIn.close();
+
+  while(_nextFile < _files.size())
+  {
+    const std::string& filepath = _files[_nextFile++];
+    _fileIn.clear();
+    _fileIn.open(filepath, std::ios::in | std::ios::binary);
+
+    if(!_fileIn.is_open())
+      throw std::runtime_error("Can't load descriptor binary file, can't open '" + filepath + "' !");
+
+    // read the number of descriptors in the file
+    _remainingInFile = 0;
+    _fileIn.read(reinterpret_cast<char*>(&_remainingInFile), sizeof(std::size_t));
+
+    if(_remainingInFile > 0)
+      return true;
+
+    _fileIn.close();
+  }
+  return false;
+}
+
+template<class DescriptorT, class FileDescriptorT>
+std::size_t DescriptorFileReader<DescriptorT, FileDescriptorT>::read(std::vector<DescriptorT>& descriptors, std::size_t maxCount)
+{
+  static_assert(sizeof(FileDescriptorT) == FileDescriptorT::static_size * sizeof(typename FileDescriptorT::bin_type),
+                "The file descriptor type must be tightly packed");
+
+  descriptors.clear();
+  descriptors.reserve(maxCount);
+
+  while(descriptors.size() < maxCount)
+  {
+    if(_remainingInFile == 0 && !openNextFile())
+      break;
+
+    // read a contiguous chunk of the current file
+    const std::size_t count = std::min(_remainingInFile, maxCount - descriptors.size());
+    _fileBuffer.resize(count);
+    _fileIn.read(reinterpret_cast<char*>(_fileBuffer.data()), count * sizeof(FileDescriptorT));
+
+    if(!_fileIn.good())
+      throw std::runtime_error("Can't load descriptor binary file, '" + _files[_nextFile - 1] + "' is incorrect !");
+
+    const std::size_t previousSize = descriptors.size();
+    descriptors.resize(previousSize + count);
+    for(std::size_t i = 0; i < count; ++i)
+      feature::convertDesc<FileDescriptorT, DescriptorT>(_fileBuffer[i], descriptors[previousSize + i]);
+
+    _remainingInFile -= count;
+  }
+  return descriptors.size();
+}
+
 } // namespace voctree
 } // namespace aliceVision
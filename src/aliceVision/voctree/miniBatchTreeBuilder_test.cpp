@@ -0,0 +1,153 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/MiniBatchTreeBuilder.hpp>
+#include <aliceVision/voctree/descriptorLoader.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+
+#include <Eigen/Core>
+
+#include <boost/filesystem.hpp>
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE voctreeMiniBatchTreeBuilder
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create 4 groups of 4 clusters, the groups are far from each other
+// - Build a tree with 2 levels and a branching factor of 4
+// - Assert that all the features of a cluster are quantized to the same word
+//   and that each cluster has its own word
+//-----------------
+BOOST_AUTO_TEST_CASE(miniBatchTreeBuilder_clusters)
+{
+  const std::size_t DIMENSION = 3;
+  const std::size_t K = 4;
+  const std::size_t LEVELS = 2;
+  const std::size_t FEATURENUMBER = 200;
+
+  typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat, Eigen::aligned_allocator<FeatureFloat> > FeatureFloatVector;
+
+  std::mt19937 generator(0);
+  std::normal_distribution<float> noise(0.f, 0.1f);
+
+  FeatureFloatVector features;
+  std::vector<std::size_t> clusters;
+  for(std::size_t group = 0; group < K; ++group)
+  {
+    for(std::size_t cluster = 0; cluster < K; ++cluster)
+    {
+      FeatureFloat center = FeatureFloat::Zero();
+      center(0) = 1000.f * group;
+      center(1) = 10.f * cluster;
+      for(std::size_t i = 0; i < FEATURENUMBER; ++i)
+      {
+        features.push_back(center + FeatureFloat(noise(generator), noise(generator), noise(generator)));
+        clusters.push_back(group * K + cluster);
+      }
+    }
+  }
+  std::shuffle(features.begin(), features.end(), std::mt19937(1));
+  std::shuffle(clusters.begin(), clusters.end(), std::mt19937(1));
+
+  voctree::MiniBatchTreeBuilder<FeatureFloat> builder(FeatureFloat::Zero());
+  builder.setBatchSize(100);
+  builder.build(features, K, LEVELS);
+
+  const voctree::MutableVocabularyTree<FeatureFloat>& tree = builder.tree();
+  BOOST_CHECK_EQUAL(tree.centers().size(), K + K * K);
+  for(const uint8_t valid : tree.validCenters())
+    BOOST_CHECK(valid != 0);
+
+  std::vector<std::set<voctree::Word>> clusterWords(K * K);
+  for(std::size_t i = 0; i < features.size(); ++i)
+    clusterWords[clusters[i]].insert(tree.quantize(features[i]));
+
+  std::set<voctree::Word> allWords;
+  for(const std::set<voctree::Word>& words : clusterWords)
+  {
+    BOOST_CHECK_EQUAL(words.size(), 1);
+    allWords.insert(words.begin(), words.end());
+  }
+  BOOST_CHECK_EQUAL(allWords.size(), K * K);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Save random descriptors in several .desc files
+// - Assert that DescriptorFileReader reads the same descriptors as loadDescsFromBinFile
+// - Assert that the tree built from the files is the same as the tree built in memory
+//-----------------
+BOOST_AUTO_TEST_CASE(miniBatchTreeBuilder_descriptorFiles)
+{
+  namespace bfs = boost::filesystem;
+
+  typedef feature::Descriptor<float, 128> DescriptorFloat;
+  typedef feature::Descriptor<unsigned char, 128> DescriptorUChar;
+
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> value(0, 255);
+
+  const bfs::path folder = bfs::temp_directory_path() / bfs::unique_path();
+  bfs::create_directory(folder);
+
+  // the second file is empty
+  const std::vector<std::size_t> nbDescriptorsPerFile = {150, 0, 73, 310};
+  std::map<IndexT, std::string> descriptorsFiles;
+  std::vector<DescriptorFloat> expected;
+
+  for(std::size_t f = 0; f < nbDescriptorsPerFile.size(); ++f)
+  {
+    std::vector<DescriptorUChar> descriptors(nbDescriptorsPerFile[f]);
+    for(DescriptorUChar& descriptor : descriptors)
+      for(std::size_t d = 0; d < 128; ++d)
+        descriptor[d] = static_cast<unsigned char>(value(generator));
+
+    const std::string filepath = (folder / (std::to_string(f) + ".desc")).string();
+    feature::saveDescsToBinFile(filepath, descriptors);
+    feature::loadDescsFromBinFile<DescriptorFloat, DescriptorUChar>(filepath, expected, true);
+    descriptorsFiles[f] = filepath;
+  }
+
+  voctree::DescriptorFileReader<DescriptorFloat, DescriptorUChar> reader(descriptorsFiles);
+  BOOST_CHECK_EQUAL(reader.getNbFiles(), nbDescriptorsPerFile.size());
+
+  for(int pass = 0; pass < 2; ++pass)
+  {
+    reader.rewind();
+    std::vector<DescriptorFloat> read;
+    std::vector<DescriptorFloat> batch;
+    while(reader.read(batch, 64) > 0)
+    {
+      BOOST_CHECK(batch.size() <= 64);
+      read.insert(read.end(), batch.begin(), batch.end());
+    }
+    BOOST_CHECK(read == expected);
+  }
+
+  voctree::MiniBatchTreeBuilder<DescriptorFloat> builderFiles(DescriptorFloat(0));
+  builderFiles.setBatchSize(64);
+  builderFiles.buildFromReader(reader, 4, 3);
+
+  voctree::MiniBatchTreeBuilder<DescriptorFloat> builderMemory(DescriptorFloat(0));
+  builderMemory.setBatchSize(64);
+  builderMemory.build(expected, 4, 3);
+
+  BOOST_CHECK(builderFiles.tree() == builderMemory.tree());
+
+  bfs::remove_all(folder);
+}
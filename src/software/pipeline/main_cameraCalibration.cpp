@@ -43,7 +43,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 namespace bfs = boost::filesystem;
 namespace po = boost::program_options;
@@ -62,6 +62,7 @@ int main(int argc, char** argv)
   std::size_t calibGridSize = 10;
   std::size_t nbDistortionCoef = 3;
   std::size_t minInputFrames = 10;
+  std::size_t readAhead = 0;
   double squareSize = 1.0;
   double maxTotalAvgErr = 0.1;
 
@@ -96,6 +97,8 @@ int main(int argc, char** argv)
            "Define the number of cells per edge.\n")
           ("minInputFrames", po::value<std::size_t>(&minInputFrames)->default_value(minInputFrames),
            "Minimal number of frames to limit the refinement loop.\n")
+          ("readAhead", po::value<std::size_t>(&readAhead)->default_value(readAhead),
+           "Number of frames decoded in advance on a background thread (0 = synchronous decoding).\n")
           ("maxTotalAvgErr,e", po::value<double>(&maxTotalAvgErr)->default_value(maxTotalAvgErr),
            "Max Total Average Error.\n")
           ("debugRejectedImgFolder", po::value<std::string>(&debugRejectedImgFolder)->default_value(""),
@@ -188,6 +191,8 @@ int main(int argc, char** argv)
     nbFramesToProcess = maxNbFrames;
   }
   ALICEVISION_COUT("Input video length is " << feed.nbFrames() << ".");
+  // the frames are read with the discretization's step
+  feed.setReadAhead(readAhead, step);
 
   aliceVision::system::Timer durationAlgo;
   aliceVision::system::Timer duration;
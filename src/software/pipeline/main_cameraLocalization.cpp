@@ -11,6 +11,7 @@
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
 #include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/localization/StreamingLocalizer.hpp>
 #include <aliceVision/localization/optimization.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/dataio/FeedProvider.hpp>
@@ -45,7 +46,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -108,6 +109,12 @@ int main(int argc, char** argv)
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
+  /// run the localization stages of consecutive frames in parallel
+  bool pipelined = false;
+  /// use the pose of the previous localized frame as a prior when pipelined
+  bool usePosePrior = true;
+  /// number of frames decoded in advance on a background thread
+  std::size_t readAhead = 0;
   
   /// the Alembic export file
   std::string exportAlembicFile = "trackedcameras.abc";
@@ -142,7 +149,9 @@ int main(int argc, char** argv)
       ("sfmdata", po::value<std::string>(&sfmFilePath)->required(), 
           "The sfm_data.json kind of file generated by AliceVision.")
       ("mediafile", po::value<std::string>(&mediaFilepath)->required(), 
-          "The folder path or the filename for the media to track");
+          "The folder path or the filename for the media to track")
+      ("readAhead", po::value<std::size_t>(&readAhead)->default_value(readAhead),
+          "Number of frames of the media decoded in advance on a background thread (0 = synchronous decoding).");
   
   po::options_description commonParams(
       "Common optional parameters for the localizer");
@@ -195,6 +204,13 @@ int main(int argc, char** argv)
       ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching), 
           "[voctree] Enable/Disable the robust matching between query and database images, "
           "all putative matches will be considered.")
+      ("pipelined", po::value<bool>(&pipelined)->default_value(pipelined),
+          "[voctree] Run the decoding, feature extraction, image retrieval, matching and resection "
+          "of consecutive frames in parallel, for real-time localization of video streams "
+          "(AllResults algorithm only).")
+      ("posePrior", po::value<bool>(&usePosePrior)->default_value(usePosePrior),
+          "[voctree] When pipelined, use the pose of the previous localized frame to restrict "
+          "the database images and the landmarks used for the resection.")
 // cctag specific options
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
       ("nNearestKeyFrames", po::value<size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames), 
@@ -285,6 +301,12 @@ int main(int argc, char** argv)
   ALICEVISION_COUT("Program called with the following parameters:");
   ALICEVISION_COUT(vm);
 
+  if(pipelined && useVoctreeLocalizer && localization::VoctreeLocalizer::initFromString(algostring) != localization::VoctreeLocalizer::Algorithm::AllResults)
+  {
+    ALICEVISION_LOG_ERROR("The pipelined localization only supports the AllResults algorithm.");
+    return EXIT_FAILURE;
+  }
+
   // if the provided folder for visual debugging does not exist create it
   // recursively
   if((!visualDebug.empty()) && (!bfs::exists(visualDebug)))
@@ -380,6 +402,7 @@ int main(int argc, char** argv)
     ALICEVISION_CERR("ERROR while initializing the FeedProvider!");
     return EXIT_FAILURE;
   }
+  feed.setReadAhead(readAhead);
   
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
   // init alembic exporter
@@ -406,45 +429,83 @@ int main(int argc, char** argv)
   
   std::vector<localization::LocalizationResult> vec_localizationResults;
   
-  while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+  // save the localization of a frame
+  const auto saveResult = [&](const localization::LocalizationResult& localizationResult,
+                              const camera::PinholeRadialK3& intrinsics,
+                              const std::string& imgName)
   {
-    ALICEVISION_COUT("******************************");
-    ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
-    ALICEVISION_COUT("******************************");
-    localization::LocalizationResult localizationResult;
-    auto detect_start = std::chrono::steady_clock::now();
-    localizer->localize(imageGrey, 
-                       param.get(),
-                       hasIntrinsics /*useInputIntrinsics*/,
-                       queryIntrinsics,
-                       localizationResult,
-                       currentImgName);
-    auto detect_end = std::chrono::steady_clock::now();
-    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
-    stats(detect_elapsed.count());
-    
     vec_localizationResults.emplace_back(localizationResult);
 
     // save data
     if(localizationResult.isValid())
     {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.addCameraKeyframe(localizationResult.getPose(), &queryIntrinsics, currentImgName, frameCounter, frameCounter);
+      exporter.addCameraKeyframe(localizationResult.getPose(), &intrinsics, imgName, frameCounter, frameCounter);
 #endif
       
       goodFrameCounter++;
-      goodFrameList.push_back(currentImgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
+      goodFrameList.push_back(imgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
     }
     else
     {
       ALICEVISION_CERR("Unable to localize frame " << frameCounter);
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.jumpKeyframe(currentImgName);
+      exporter.jumpKeyframe(imgName);
 #endif
     }
     ++frameCounter;
-    feed.goToNextFrame();
+  };
+
+  if(pipelined && useVoctreeLocalizer)
+  {
+    localization::StreamingLocalizer::Parameters streamingParam;
+    streamingParam._usePosePrior = usePosePrior;
+
+    localization::StreamingLocalizer streamingLocalizer(*static_cast<localization::VoctreeLocalizer*>(localizer.get()),
+                                                        *static_cast<const localization::VoctreeLocalizer::Parameters*>(param.get()),
+                                                        streamingParam);
+
+    const auto readFrame = [&](localization::StreamingLocalizer::Frame& frame)
+    {
+      if(!feed.readImage(frame._imageGrey, frame._intrinsics, frame._imagePath, frame._hasIntrinsics))
+        return false;
+      feed.goToNextFrame();
+      return true;
+    };
+
+    streamingLocalizer.run(readFrame, [&](const localization::StreamingLocalizer::FrameResult& result)
+    {
+      ALICEVISION_COUT("FRAME " << myToString(result._frameId, 4) << " localized in " << result._totalLatency << " [ms]");
+      stats(result._totalLatency);
+      currentImgName = result._imagePath;
+      saveResult(result._localizationResult, result._localizationResult.getIntrinsics(), result._imagePath);
+    });
+
+    streamingLocalizer.logStatistics();
+  }
+  else
+  {
+    while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+    {
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
+      ALICEVISION_COUT("******************************");
+      localization::LocalizationResult localizationResult;
+      auto detect_start = std::chrono::steady_clock::now();
+      localizer->localize(imageGrey, 
+                         param.get(),
+                         hasIntrinsics /*useInputIntrinsics*/,
+                         queryIntrinsics,
+                         localizationResult,
+                         currentImgName);
+      auto detect_end = std::chrono::steady_clock::now();
+      auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+      ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
+      stats(detect_elapsed.count());
+
+      saveResult(localizationResult, queryIntrinsics, currentImgName);
+      feed.goToNextFrame();
+    }
   }
 
   if(wantsJsonOutput)
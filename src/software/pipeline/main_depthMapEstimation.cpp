@@ -6,15 +6,22 @@
 
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
-#include <aliceVision/depthMap/RefineRc.hpp>
-#include <aliceVision/depthMap/SemiGlobalMatchingRc.hpp>
+#include <aliceVision/depthMap/depthMapEngine.hpp>
+#include <aliceVision/depthMap/PatchMatchRc.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/depthSimMapStorage.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/gpu/gpu.hpp>
+#include <aliceVision/config.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/depthMap/RefineRc.hpp>
+#include <aliceVision/depthMap/SemiGlobalMatchingRc.hpp>
+#endif
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -22,7 +29,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -36,6 +43,13 @@ int main(int argc, char* argv[])
     std::string sfmDataFilename;
     std::string outputFolder;
     std::string imagesFolder;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    std::string depthMapEngineName = depthMap::EDepthMapEngine_enumToString(depthMap::EDepthMapEngine::SGM);
+#else
+    // the sgm engine is not available without CUDA
+    std::string depthMapEngineName = depthMap::EDepthMapEngine_enumToString(depthMap::EDepthMapEngine::PATCHMATCH);
+#endif
+    std::string depthMapStorageName = mvsUtils::EDepthMapStorage_enumToString(mvsUtils::EDepthMapStorage::FLOAT);
 
     // program range
     int rangeStart = -1;
@@ -65,6 +79,14 @@ int main(int argc, char* argv[])
     double refineGammaP = 8.0;
     bool refineUseTcOrRcPixSize = false;
 
+    // patchMatch
+    int patchMatchMaxTCams = 6;
+    int patchMatchWSH = 4;
+    double patchMatchGammaC = 10.0;
+    double patchMatchGammaP = 8.0;
+    int patchMatchNbScales = 3;
+    int patchMatchNbIterations = 4;
+
     po::options_description allParams("AliceVision depthMapEstimation\n"
                                       "Estimate depth map for each input image");
 
@@ -83,6 +105,13 @@ int main(int argc, char* argv[])
             "Compute a sub-range of images from index rangeStart to rangeStart+rangeSize.")
         ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
             "Compute a sub-range of N images (N=rangeSize).")
+        ("depthMapEngine", po::value<std::string>(&depthMapEngineName)->default_value(depthMapEngineName),
+            "Depth map estimation engine: sgm (Semi Global Matching and refinement, needs AliceVision built with CUDA "
+            "and a CUDA device) or patchMatch (CPU). The default is sgm when AliceVision is built with CUDA, patchMatch otherwise.")
+        ("depthMapStorage", po::value<std::string>(&depthMapStorageName)->default_value(depthMapStorageName),
+            "Storage of the depth and similarity maps: float (float depth, half float similarity) or "
+            "compact (half float depth if in range, similarity quantized on 8 bits with a per-map scale, "
+            "the codes being written as half float).")
         ("downscale", po::value<int>(&downscale)->default_value(downscale),
             "Image downscale factor.")
         ("minViewAngle", po::value<float>(&minViewAngle)->default_value(minViewAngle),
@@ -114,7 +143,19 @@ int main(int argc, char* argv[])
         ("refineGammaP", po::value<double>(&refineGammaP)->default_value(refineGammaP),
             "Refine: GammaP threshold.")
         ("refineUseTcOrRcPixSize", po::value<bool>(&refineUseTcOrRcPixSize)->default_value(refineUseTcOrRcPixSize),
-            "Refine: Use current camera pixel size or minimum pixel size of neighbour cameras.");
+            "Refine: Use current camera pixel size or minimum pixel size of neighbour cameras.")
+        ("patchMatchMaxTCams", po::value<int>(&patchMatchMaxTCams)->default_value(patchMatchMaxTCams),
+            "PatchMatch: Number of neighbour cameras.")
+        ("patchMatchWSH", po::value<int>(&patchMatchWSH)->default_value(patchMatchWSH),
+            "PatchMatch: Half size of the patch used to compute the similarity.")
+        ("patchMatchGammaC", po::value<double>(&patchMatchGammaC)->default_value(patchMatchGammaC),
+            "PatchMatch: GammaC threshold.")
+        ("patchMatchGammaP", po::value<double>(&patchMatchGammaP)->default_value(patchMatchGammaP),
+            "PatchMatch: GammaP threshold.")
+        ("patchMatchNbScales", po::value<int>(&patchMatchNbScales)->default_value(patchMatchNbScales),
+            "PatchMatch: Number of scales of the coarse-to-fine estimation.")
+        ("patchMatchNbIterations", po::value<int>(&patchMatchNbIterations)->default_value(patchMatchNbIterations),
+            "PatchMatch: Number of iterations at each scale.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -156,14 +197,24 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
-    // print GPU Information
-    ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+    const depthMap::EDepthMapEngine depthMapEngine = depthMap::EDepthMapEngine_stringToEnum(depthMapEngineName);
 
-    // check if the gpu suppport CUDA compute capability 2.0
-    if(!gpu::gpuSupportCUDA(2,0))
+    if(depthMapEngine == depthMap::EDepthMapEngine::SGM)
     {
-      ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capablility 2.0).");
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+      // print GPU Information
+      ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+      // check if the gpu suppport CUDA compute capability 2.0
+      if(!gpu::gpuSupportCUDA(2,0))
+      {
+        ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capablility 2.0).");
+        return EXIT_FAILURE;
+      }
+#else
+      ALICEVISION_LOG_ERROR("The sgm depth map engine needs AliceVision built with CUDA, use the patchMatch engine.");
       return EXIT_FAILURE;
+#endif
     }
 
     // check if the scale is correct
@@ -189,6 +240,8 @@ int main(int argc, char* argv[])
 
     // set params in bpt
 
+    mp.userParams.put("depthMap.storage", mvsUtils::EDepthMapStorage_enumToString(mvsUtils::EDepthMapStorage_stringToEnum(depthMapStorageName)));
+
     // semiGlobalMatching
     mp.userParams.put("semiGlobalMatching.maxTCams", sgmMaxTCams);
     mp.userParams.put("semiGlobalMatching.wsh", sgmWSH);
@@ -206,6 +259,14 @@ int main(int argc, char* argv[])
     mp.userParams.put("refineRc.gammaP", refineGammaP);
     mp.userParams.put("refineRc.useTcOrRcPixSize", refineUseTcOrRcPixSize);
 
+    // patchMatch
+    mp.userParams.put("patchMatch.maxTCams", patchMatchMaxTCams);
+    mp.userParams.put("patchMatch.wsh", patchMatchWSH);
+    mp.userParams.put("patchMatch.gammaC", patchMatchGammaC);
+    mp.userParams.put("patchMatch.gammaP", patchMatchGammaP);
+    mp.userParams.put("patchMatch.nbScales", patchMatchNbScales);
+    mp.userParams.put("patchMatch.nbIterations", patchMatchNbIterations);
+
     StaticVector<int> cams;
     cams.reserve(mp.ncams);
     if(rangeSize == -1)
@@ -231,9 +292,16 @@ int main(int argc, char* argv[])
 
     ALICEVISION_LOG_INFO("Create depth maps.");
 
+    if(depthMapEngine == depthMap::EDepthMapEngine::PATCHMATCH)
+    {
+      depthMap::estimateDepthMapsPatchMatch(&mp, cams);
+    }
+    else
     {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
       depthMap::computeDepthMapsPSSGM(&mp, cams);
       depthMap::refineDepthMaps(&mp, cams);
+#endif
     }
 
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
@@ -10,6 +10,7 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/depthSimMapStorage.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
@@ -20,7 +21,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -48,6 +49,8 @@ int main(int argc, char* argv[])
     int pixSizeBall = 0;
     int pixSizeBallWithLowSimilarity = 0;
     int nNearestCams = 10;
+    int depthMapsCacheMB = 2048;
+    std::string depthMapStorageName = mvsUtils::EDepthMapStorage_enumToString(mvsUtils::EDepthMapStorage::FLOAT);
 
     po::options_description allParams("AliceVision depthMapFiltering\n"
                                       "Filter depth map to remove values that are not consistent with other depth maps");
@@ -80,7 +83,13 @@ int main(int argc, char* argv[])
         ("pixSizeBallWithLowSimilarity", po::value<int>(&pixSizeBallWithLowSimilarity)->default_value(pixSizeBallWithLowSimilarity),
             "Filter ball size (in px) when the similarity is weak or ambiguous.")
         ("nNearestCams", po::value<int>(&nNearestCams)->default_value(nNearestCams),
-            "Number of nearest cameras.");
+            "Number of nearest cameras.")
+        ("depthMapsCacheMB", po::value<int>(&depthMapsCacheMB)->default_value(depthMapsCacheMB),
+            "Size (in MB) of the cache of the depth maps shared by the cameras using them.")
+        ("depthMapStorage", po::value<std::string>(&depthMapStorageName)->default_value(depthMapStorageName),
+            "Storage of the depth and similarity maps: float (float depth, half float similarity) or "
+            "compact (half float depth if in range, similarity quantized on 8 bits with a per-map scale, "
+            "the codes being written as half float).");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -135,6 +144,8 @@ int main(int argc, char* argv[])
 
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
+    mp.userParams.put("depthMapsCache.maxMB", depthMapsCacheMB);
+    mp.userParams.put("depthMap.storage", mvsUtils::EDepthMapStorage_enumToString(mvsUtils::EDepthMapStorage_stringToEnum(depthMapStorageName)));
 
     StaticVector<int> cams;
     cams.reserve(mp.ncams);
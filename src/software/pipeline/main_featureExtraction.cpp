@@ -17,6 +17,8 @@
 #endif
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Profiler.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
@@ -130,6 +132,8 @@ public:
 
   void process()
   {
+    ALICEVISION_MEMORY_PHASE("featureExtraction");
+
     // iteration on each view in the range in order
     // to prepare viewJob stack
     sfmData::Views::const_iterator itViewBegin = _sfmData.getViews().begin();
@@ -169,7 +173,9 @@ public:
       if(jobMaxMemoryConsuption == 0)
         throw std::runtime_error("Cannot compute feature extraction job max memory consumption.");
 
-      std::size_t nbThreads =  (0.9 * memoryInformation.freeRam) / jobMaxMemoryConsuption;
+      // free memory within the memory budget of the process
+      const std::size_t availableMemory = std::min(memoryInformation.freeRam, system::MemoryTracker::getInstance().getAvailableMemory());
+      std::size_t nbThreads =  (0.9 * availableMemory) / jobMaxMemoryConsuption;
 
       if(memoryInformation.freeRam == 0)
       {
@@ -188,6 +194,9 @@ public:
       // nbThreads should not be higher than the job number
       nbThreads = std::min(_cpuJobs.size(), nbThreads);
 
+      // at least one thread, even if the jobs do not fit in memory
+      nbThreads = std::max(std::size_t(1), nbThreads);
+
       ALICEVISION_LOG_DEBUG("# threads for extraction: " << nbThreads);
       omp_set_nested(1);
 
@@ -207,10 +216,15 @@ private:
 
   void computeViewJob(const ViewJob& job, bool useGPU = false)
   {
+    ALICEVISION_PROFILE_ZONE("featureExtraction::view");
+
     image::Image<float> imageGrayFloat;
     image::Image<unsigned char> imageGrayUChar;
 
-    image::readImage(job.view.getImagePath(), imageGrayFloat);
+    {
+      ALICEVISION_PROFILE_ZONE("featureExtraction::readImage");
+      image::readImage(job.view.getImagePath(), imageGrayFloat);
+    }
 
     const auto imageDescriberIndexes = useGPU ? job.gpuImageDescriberIndexes : job.cpuImageDescriberIndexes;
 
@@ -224,19 +238,25 @@ private:
       ALICEVISION_LOG_INFO("Extracting " << imageDescriberTypeName  << " features from view '" << job.view.getImagePath() << "' " << (useGPU ? "[gpu]" : "[cpu]"));
 
       std::unique_ptr<feature::Regions> regions;
-      if(imageDescriber->useFloatImage())
       {
-        // image buffer use float image, use the read buffer
-        imageDescriber->describe(imageGrayFloat, regions);
+        ALICEVISION_PROFILE_ZONE("featureExtraction::describe");
+        if(imageDescriber->useFloatImage())
+        {
+          // image buffer use float image, use the read buffer
+          imageDescriber->describe(imageGrayFloat, regions);
+        }
+        else
+        {
+          // image buffer can't use float image
+          if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
+            imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
+          imageDescriber->describe(imageGrayUChar, regions);
+        }
       }
-      else
       {
-        // image buffer can't use float image
-        if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
-          imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
-        imageDescriber->describe(imageGrayUChar, regions);
+        ALICEVISION_PROFILE_ZONE("featureExtraction::save");
+        imageDescriber->Save(regions.get(), job.getFeaturesPath(imageDescriberType), job.getDescriptorPath(imageDescriberType));
       }
-      imageDescriber->Save(regions.get(), job.getFeaturesPath(imageDescriberType), job.getDescriptorPath(imageDescriberType));
       ALICEVISION_LOG_INFO(std::left << std::setw(6) << " " << regions->RegionCount() << " " << imageDescriberTypeName  << " features extracted from view '" << job.view.getImagePath() << "'");
     }
   }
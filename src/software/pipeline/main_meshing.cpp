@@ -10,6 +10,7 @@
 #include <aliceVision/fuseCut/ReconstructionPlan.hpp>
 #include <aliceVision/fuseCut/DelaunayGraphCut.hpp>
 #include <aliceVision/mesh/meshPostProcessing.hpp>
+#include <aliceVision/mesh/MeshSpatialIndex.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
@@ -25,7 +26,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 4
 
 using namespace aliceVision;
 
@@ -98,6 +99,10 @@ int main(int argc, char* argv[])
     int maxPtsPerVoxel = 6000000;
     bool meshingFromDepthMaps = true;
     bool estimateSpaceFromSfM = true;
+    bool parallelTetrahedralization = true;
+    bool parallelMaxflow = true;
+    bool saveMaxflowGraph = false;
+    bool saveSpatialIndex = false;
 
     fuseCut::FuseParams fuseParams;
 
@@ -108,7 +113,7 @@ int main(int argc, char* argv[])
         ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
           "SfMData file.")
         ("output,o", po::value<std::string>(&outputMesh)->required(),
-            "Output mesh (OBJ file format).");
+            "Output mesh (OBJ or binary PLY file format, given by the extension).");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -159,7 +164,17 @@ int main(int argc, char* argv[])
         ("minAngleThreshold", po::value<double>(&fuseParams.minAngleThreshold)->default_value(fuseParams.minAngleThreshold),
             "minAngleThreshold")
         ("refineFuse", po::value<bool>(&fuseParams.refineFuse)->default_value(fuseParams.refineFuse),
-            "refineFuse");
+            "refineFuse")
+        ("parallelTetrahedralization", po::value<bool>(&parallelTetrahedralization)->default_value(parallelTetrahedralization),
+            "Use the multithreaded Delaunay tetrahedralization if available.")
+        ("parallelMaxflow", po::value<bool>(&parallelMaxflow)->default_value(parallelMaxflow),
+            "Use the multithreaded push-relabel maxflow instead of the sequential boykov-kolmogorov maxflow.")
+        ("saveMaxflowGraph", po::value<bool>(&saveMaxflowGraph)->default_value(saveMaxflowGraph),
+            "Save the maxflow graph in the output folder (maxflowGraph.bin), to benchmark it with aliceVision_utils_maxflowBenchmark. "
+            "Only used with the multithreaded maxflow.")
+        ("saveSpatialIndex", po::value<bool>(&saveSpatialIndex)->default_value(saveSpatialIndex),
+            "Save the spatial index of the dense reconstruction in the output folder (denseReconstructionIndex.bin), "
+            "so the texturing can remap the visibilities without building it again.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -231,6 +246,8 @@ int main(int argc, char* argv[])
     mvsUtils::MultiViewParams mp(sfmData, "", depthMapsFolder, depthMapsFilterFolder, meshingFromDepthMaps);
 
     mp.userParams.put("LargeScale.universePercentile", universePercentile);
+    mp.userParams.put("delaunaycut.parallelTetrahedralization", parallelTetrahedralization);
+    mp.userParams.put("delaunaycut.parallelMaxflow", parallelMaxflow);
 
     int ocTreeDim = mp.userParams.get<int>("LargeScale.gridLevel0", 1024);
     const auto baseDir = mp.userParams.get<std::string>("LargeScale.baseDirName", "root01024");
@@ -241,6 +258,9 @@ int main(int argc, char* argv[])
 
     fs::path tmpDirectory = outDirectory / "tmp";
 
+    if(saveMaxflowGraph)
+        mp.userParams.put("delaunaycut.maxflowGraphFilepath", (outDirectory / "maxflowGraph.bin").string());
+
     ALICEVISION_LOG_WARNING("repartitionMode: " << repartitionMode);
     ALICEVISION_LOG_WARNING("partitioningMode: " << partitioningMode);
 
@@ -283,7 +303,7 @@ int main(int argc, char* argv[])
                     mesh->saveToBin(spaceBinFileName.string());
 
                     // Export joined mesh to obj
-                    mesh->saveToObj(outputMesh);
+                    mesh->save(outputMesh);
 
                     delete mesh;
 
@@ -365,7 +385,7 @@ int main(int argc, char* argv[])
                     saveArrayOfArraysToFile<int>((outDirectory/"meshPtsCamsFromDGC.bin").string(), ptsCams);
                     deleteArrayOfArrays<int>(&ptsCams);
 
-                    mesh->saveToObj(outputMesh);
+                    mesh->save(outputMesh);
 
                     delete mesh;
                     break;
@@ -457,7 +477,7 @@ int main(int argc, char* argv[])
                     deleteArrayOfArrays<int>(&ptsCams);
                     delete voxels;
 
-                    mesh->saveToObj(outputMesh);
+                    mesh->save(outputMesh);
 
                     delete mesh;
                     break;
@@ -473,6 +493,23 @@ int main(int argc, char* argv[])
             throw std::invalid_argument("Repartition mode is not defined");
     }
 
+    if(saveSpatialIndex)
+    {
+        // save the spatial index of the dense reconstruction, to remap its visibilities without building it again
+        ALICEVISION_LOG_INFO("Save the spatial index of the dense reconstruction.");
+        mesh::Mesh denseReconstruction;
+        if(!denseReconstruction.loadFromBin((outDirectory/"denseReconstruction.bin").string()))
+        {
+            ALICEVISION_LOG_WARNING("Unable to load the dense reconstruction, its spatial index is not saved.");
+        }
+        else
+        {
+            const mesh::MeshSpatialIndex denseReconstructionIndex(denseReconstruction);
+            if(!denseReconstructionIndex.save((outDirectory/"denseReconstructionIndex.bin").string()))
+                ALICEVISION_LOG_WARNING("Unable to save the spatial index of the dense reconstruction.");
+        }
+    }
+
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
 }
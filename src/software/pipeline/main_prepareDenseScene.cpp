@@ -9,6 +9,7 @@
 #include <aliceVision/image/all.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/BoundedQueue.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/program_options.hpp>
@@ -17,7 +18,12 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <set>
 #include <iterator>
@@ -26,7 +32,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -37,6 +43,20 @@ using namespace aliceVision::sfmData;
 namespace po = boost::program_options;
 namespace fs = boost::filesystem;
 
+namespace {
+
+/// An image going through the read / undistort / write pipeline
+struct ImageJob
+{
+  IndexT viewId = UndefinedIndexT;
+  const IntrinsicBase* cam = nullptr;
+  std::string dstColorImage;
+  oiio::ParamValueList metadata;
+  Image<RGBfColor> image;
+};
+
+} // namespace
+
 bool prepareDenseScene(const SfMData& sfmData,
                        const std::vector<std::string>& imagesFolders,
                        int beginIndex,
@@ -44,7 +64,8 @@ bool prepareDenseScene(const SfMData& sfmData,
                        const std::string& outFolder,
                        image::EImageFileType outputFileType,
                        bool saveMetadata,
-                       bool saveMatricesFiles)
+                       bool saveMatricesFiles,
+                       int nbIOThreads)
 {
   // defined view Ids
   std::set<IndexT> viewIds;
@@ -73,139 +94,232 @@ bool prepareDenseScene(const SfMData& sfmData,
     ALICEVISION_LOG_WARNING("Cannot save informations in images metadata.\n"
                             "Choose '.exr' file type if you want AliceVision custom metadata");
 
+  const std::vector<IndexT> viewIdsVec(viewIds.begin(), viewIds.end());
+  const int nbViews = static_cast<int>(viewIdsVec.size());
+  nbIOThreads = std::max(1, nbIOThreads);
+
   // export data
   boost::progress_display progressBar(viewIds.size(), std::cout, "Exporting Scene Undistorted Images\n");
 
-#pragma omp parallel for num_threads(3)
-  for(int i = 0; i < viewIds.size(); ++i)
-  {
-    auto itView = viewIds.begin();
-    std::advance(itView, i);
-
-    const IndexT viewId = *itView;
-    const View* view = sfmData.getViews().at(viewId).get();
+  // pipeline: nbIOThreads readers -> 1 undistort stage (parallel inside) -> nbIOThreads writers
+  // the queues bound the number of images in memory
+  system::BoundedQueue<ImageJob> readQueue(nbIOThreads);
+  system::BoundedQueue<ImageJob> writeQueue(nbIOThreads);
 
-    Intrinsics::const_iterator iterIntrinsic = sfmData.getIntrinsics().find(view->getIntrinsicId());
+  // views sharing the same intrinsic and resolution share the same remap grid
+  UndistortMapCache undistortMapCache;
 
-    //we have a valid view with a corresponding camera & pose
-    const std::string baseFilename = std::to_string(viewId);
+  // number of views to undistort per intrinsic, the remap grids are released after the last view
+  std::map<std::size_t, int> nbRemainingViewsPerIntrinsic;
+  for(const IndexT viewId : viewIdsVec)
+  {
+    const IntrinsicBase* cam = sfmData.getIntrinsicPtr(sfmData.getViews().at(viewId)->getIntrinsicId());
+    if(cam->isValid() && cam->have_disto())
+      ++nbRemainingViewsPerIntrinsic[cam->hashValue()];
+  }
 
-    oiio::ParamValueList metadata;
+  std::atomic<int> nextViewIndex(0);
+  std::atomic<int> nbRunningReaders(nbIOThreads);
+  std::mutex mutex;
+  std::exception_ptr error;
 
-    // export camera
-    if(saveMetadata || saveMatricesFiles)
+  const auto abortPipeline = [&]()
+  {
     {
-      // get camera pose / projection
-      const Pose3 pose = sfmData.getPose(*view).getTransform();
-      Mat34 P = iterIntrinsic->second.get()->get_projective_equivalent(pose);
-
-      // get camera intrinsics matrices
-      const Mat3 K = dynamic_cast<const Pinhole*>(sfmData.getIntrinsicPtr(view->getIntrinsicId()))->K();
-      const Mat3& R = pose.rotation();
-      const Vec3& t = pose.translation();
+      std::lock_guard<std::mutex> lock(mutex);
+      if(!error)
+        error = std::current_exception();
+    }
+    readQueue.close();
+    writeQueue.close();
+  };
 
-      if(saveMatricesFiles)
+  const auto readStage = [&]()
+  {
+    try
+    {
+      for(int i = nextViewIndex++; i < nbViews; i = nextViewIndex++)
       {
-        std::ofstream fileP((fs::path(outFolder) / (baseFilename + "_P.txt")).string());
-        fileP << std::setprecision(10)
-             << P(0, 0) << " " << P(0, 1) << " " << P(0, 2) << " " << P(0, 3) << "\n"
-             << P(1, 0) << " " << P(1, 1) << " " << P(1, 2) << " " << P(1, 3) << "\n"
-             << P(2, 0) << " " << P(2, 1) << " " << P(2, 2) << " " << P(2, 3) << "\n";
-        fileP.close();
-
-        std::ofstream fileKRt((fs::path(outFolder) / (baseFilename + "_KRt.txt")).string());
-        fileKRt << std::setprecision(10)
-             << K(0, 0) << " " << K(0, 1) << " " << K(0, 2) << "\n"
-             << K(1, 0) << " " << K(1, 1) << " " << K(1, 2) << "\n"
-             << K(2, 0) << " " << K(2, 1) << " " << K(2, 2) << "\n"
-             << "\n"
-             << R(0, 0) << " " << R(0, 1) << " " << R(0, 2) << "\n"
-             << R(1, 0) << " " << R(1, 1) << " " << R(1, 2) << "\n"
-             << R(2, 0) << " " << R(2, 1) << " " << R(2, 2) << "\n"
-             << "\n"
-             << t(0) << " " << t(1) << " " << t(2) << "\n";
-        fileKRt.close();
-      }
+        const IndexT viewId = viewIdsVec.at(i);
+        const View* view = sfmData.getViews().at(viewId).get();
 
-      if(saveMetadata)
-      {
-        // convert to 44 matix
-        Mat4 projectionMatrix;
-        projectionMatrix << P(0, 0), P(0, 1), P(0, 2), P(0, 3),
-                            P(1, 0), P(1, 1), P(1, 2), P(1, 3),
-                            P(2, 0), P(2, 1), P(2, 2), P(2, 3),
-                                  0,       0,       0,       1;
-
-        // convert matrices to rowMajor
-        std::vector<double> vP(projectionMatrix.size());
-        std::vector<double> vK(K.size());
-        std::vector<double> vR(R.size());
-
-        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
-        Eigen::Map<RowMatrixXd>(vP.data(), projectionMatrix.rows(), projectionMatrix.cols()) = projectionMatrix;
-        Eigen::Map<RowMatrixXd>(vK.data(), K.rows(), K.cols()) = K;
-        Eigen::Map<RowMatrixXd>(vR.data(), R.rows(), R.cols()) = R;
-
-        // add metadata
-        metadata.push_back(oiio::ParamValue("AliceVision:downscale", 1));
-        metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, vP.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:K", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vK.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:R", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vR.data()));
-        metadata.push_back(oiio::ParamValue("AliceVision:t", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, t.data()));
-      }
-    }
+        Intrinsics::const_iterator iterIntrinsic = sfmData.getIntrinsics().find(view->getIntrinsicId());
 
-    // export undistort image
-    {
-      std::string srcImage = view->getImagePath();
+        //we have a valid view with a corresponding camera & pose
+        const std::string baseFilename = std::to_string(viewId);
 
-      if(!imagesFolders.empty())
-      {
-        bool found = false;
-        for(const std::string& folder : imagesFolders)
+        ImageJob job;
+        job.viewId = viewId;
+        job.cam = iterIntrinsic->second.get();
+
+        // export camera
+        if(saveMetadata || saveMatricesFiles)
         {
-          const fs::recursive_directory_iterator end;
-          const auto findIt = std::find_if(fs::recursive_directory_iterator(folder), end,
-                                   [&view](const fs::directory_entry& e) {
-                                      return (e.path().stem() == std::to_string(view->getViewId()) ||
-                                              e.path().stem() == fs::path(view->getImagePath()).stem());});
+          // get camera pose / projection
+          const Pose3 pose = sfmData.getPose(*view).getTransform();
+          Mat34 P = iterIntrinsic->second.get()->get_projective_equivalent(pose);
 
-          if(findIt != end)
+          // get camera intrinsics matrices
+          const Mat3 K = dynamic_cast<const Pinhole*>(sfmData.getIntrinsicPtr(view->getIntrinsicId()))->K();
+          const Mat3& R = pose.rotation();
+          const Vec3& t = pose.translation();
+
+          if(saveMatricesFiles)
+          {
+            std::ofstream fileP((fs::path(outFolder) / (baseFilename + "_P.txt")).string());
+            fileP << std::setprecision(10)
+                 << P(0, 0) << " " << P(0, 1) << " " << P(0, 2) << " " << P(0, 3) << "\n"
+                 << P(1, 0) << " " << P(1, 1) << " " << P(1, 2) << " " << P(1, 3) << "\n"
+                 << P(2, 0) << " " << P(2, 1) << " " << P(2, 2) << " " << P(2, 3) << "\n";
+            fileP.close();
+
+            std::ofstream fileKRt((fs::path(outFolder) / (baseFilename + "_KRt.txt")).string());
+            fileKRt << std::setprecision(10)
+                 << K(0, 0) << " " << K(0, 1) << " " << K(0, 2) << "\n"
+                 << K(1, 0) << " " << K(1, 1) << " " << K(1, 2) << "\n"
+                 << K(2, 0) << " " << K(2, 1) << " " << K(2, 2) << "\n"
+                 << "\n"
+                 << R(0, 0) << " " << R(0, 1) << " " << R(0, 2) << "\n"
+                 << R(1, 0) << " " << R(1, 1) << " " << R(1, 2) << "\n"
+                 << R(2, 0) << " " << R(2, 1) << " " << R(2, 2) << "\n"
+                 << "\n"
+                 << t(0) << " " << t(1) << " " << t(2) << "\n";
+            fileKRt.close();
+          }
+
+          if(saveMetadata)
           {
-            srcImage = (fs::path(folder) / (findIt->path().stem().string() + findIt->path().extension().string())).string();
-            found = true;
-            break;
+            // convert to 44 matix
+            Mat4 projectionMatrix;
+            projectionMatrix << P(0, 0), P(0, 1), P(0, 2), P(0, 3),
+                                P(1, 0), P(1, 1), P(1, 2), P(1, 3),
+                                P(2, 0), P(2, 1), P(2, 2), P(2, 3),
+                                      0,       0,       0,       1;
+
+            // convert matrices to rowMajor
+            std::vector<double> vP(projectionMatrix.size());
+            std::vector<double> vK(K.size());
+            std::vector<double> vR(R.size());
+
+            typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+            Eigen::Map<RowMatrixXd>(vP.data(), projectionMatrix.rows(), projectionMatrix.cols()) = projectionMatrix;
+            Eigen::Map<RowMatrixXd>(vK.data(), K.rows(), K.cols()) = K;
+            Eigen::Map<RowMatrixXd>(vR.data(), R.rows(), R.cols()) = R;
+
+            // add metadata
+            job.metadata.push_back(oiio::ParamValue("AliceVision:downscale", 1));
+            job.metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, vP.data()));
+            job.metadata.push_back(oiio::ParamValue("AliceVision:K", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vK.data()));
+            job.metadata.push_back(oiio::ParamValue("AliceVision:R", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX33), 1, vR.data()));
+            job.metadata.push_back(oiio::ParamValue("AliceVision:t", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::VEC3), 1, t.data()));
           }
         }
 
-        if(!found)
-          throw std::runtime_error("Cannot find view " + std::to_string(view->getViewId()) + " image file in given folder(s)");
-      }
+        // read source image
+        std::string srcImage = view->getImagePath();
+
+        if(!imagesFolders.empty())
+        {
+          bool found = false;
+          for(const std::string& folder : imagesFolders)
+          {
+            const fs::recursive_directory_iterator end;
+            const auto findIt = std::find_if(fs::recursive_directory_iterator(folder), end,
+                                     [&view](const fs::directory_entry& e) {
+                                        return (e.path().stem() == std::to_string(view->getViewId()) ||
+                                                e.path().stem() == fs::path(view->getImagePath()).stem());});
+
+            if(findIt != end)
+            {
+              srcImage = (fs::path(folder) / (findIt->path().stem().string() + findIt->path().extension().string())).string();
+              found = true;
+              break;
+            }
+          }
 
+          if(!found)
+            throw std::runtime_error("Cannot find view " + std::to_string(view->getViewId()) + " image file in given folder(s)");
+        }
 
-      std::string dstColorImage = (fs::path(outFolder) / (baseFilename + "." + image::EImageFileType_enumToString(outputFileType))).string();
+        job.dstColorImage = (fs::path(outFolder) / (baseFilename + "." + image::EImageFileType_enumToString(outputFileType))).string();
 
-      const IntrinsicBase* cam = iterIntrinsic->second.get();
-      Image<RGBfColor> image, image_ud;
+        readImage(srcImage, job.image);
+
+        if(!readQueue.push(std::move(job)))
+          break; // pipeline aborted
+      }
+    }
+    catch(...)
+    {
+      abortPipeline();
+    }
 
-      readImage(srcImage, image);
+    // the last reader closes the queue
+    if(--nbRunningReaders == 0)
+      readQueue.close();
+  };
 
-      // undistort
-      if(cam->isValid() && cam->have_disto())
+  const auto undistortStage = [&]()
+  {
+    try
+    {
+      ImageJob job;
+      while(readQueue.pop(job))
       {
-        // undistort the image and save it
-        UndistortImage(image, cam, image_ud, FBLACK);
-        writeImage(dstColorImage, image_ud, metadata);
+        // undistort
+        if(job.cam->isValid() && job.cam->have_disto())
+        {
+          const std::shared_ptr<const UndistortMap> undistortMap = undistortMapCache.get(*job.cam, job.image.Width(), job.image.Height());
+          Image<RGBfColor> image_ud;
+          UndistortImage(job.image, *undistortMap, image_ud, FBLACK);
+          job.image.swap(image_ud);
+
+          if(--nbRemainingViewsPerIntrinsic[job.cam->hashValue()] == 0)
+            undistortMapCache.release(*job.cam);
+        }
+
+        if(!writeQueue.push(std::move(job)))
+          break; // pipeline aborted
       }
-      else
+    }
+    catch(...)
+    {
+      abortPipeline();
+    }
+    writeQueue.close();
+  };
+
+  const auto writeStage = [&]()
+  {
+    try
+    {
+      ImageJob job;
+      while(writeQueue.pop(job))
       {
-        writeImage(dstColorImage, image, metadata);
+        writeImage(job.dstColorImage, job.image, job.metadata);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++progressBar;
       }
     }
+    catch(...)
+    {
+      abortPipeline();
+    }
+  };
 
-    #pragma omp critical
-    ++progressBar;
-  }
+  std::vector<std::thread> threads;
+  for(int i = 0; i < nbIOThreads; ++i)
+    threads.emplace_back(readStage);
+  threads.emplace_back(undistortStage);
+  for(int i = 0; i < nbIOThreads; ++i)
+    threads.emplace_back(writeStage);
+
+  for(std::thread& thread : threads)
+    thread.join();
+
+  if(error)
+    std::rethrow_exception(error);
 
   return true;
 }
@@ -223,6 +337,7 @@ int main(int argc, char *argv[])
   int rangeSize = 1;
   bool saveMetadata = true;
   bool saveMatricesTxtFiles = false;
+  int nbIOThreads = 3;
 
   po::options_description allParams("AliceVision prepareDenseScene");
 
@@ -244,6 +359,9 @@ int main(int argc, char *argv[])
       "Save projections and intrinsics information in images metadata.")
     ("saveMatricesTxtFiles", po::value<bool>(&saveMatricesTxtFiles)->default_value(saveMatricesTxtFiles),
       "Save projections and intrinsics information in text files.")
+    ("nbIOThreads", po::value<int>(&nbIOThreads)->default_value(nbIOThreads),
+      "Number of threads reading and number of threads writing images.\n"
+      "Undistortion uses all the available cores.")
     ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
       "Range image index start.")
     ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -325,7 +443,7 @@ int main(int argc, char *argv[])
   }
 
   // export
-  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles))
+  if(prepareDenseScene(sfmData, imagesFolders, rangeStart, rangeEnd, outFolder, outputFileType, saveMetadata, saveMatricesTxtFiles, nbIOThreads))
     return EXIT_SUCCESS;
 
   return EXIT_FAILURE;
@@ -42,7 +42,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -92,6 +92,8 @@ int main(int argc, char** argv)
   double matchingErrorMax = 4.0;
   /// the maximum number of frames in input
   std::size_t maxInputFrames = 0;
+  /// number of frames decoded in advance on a background thread
+  std::size_t readAhead = 0;
 
 
   // parameters for voctree localizer
@@ -156,7 +158,9 @@ int main(int argc, char** argv)
           "Maximum reprojection error (in pixels) allowed for resectioning. If set "
           "to 0 it lets the ACRansac select an optimal value.")
       ("maxInputFrames", po::value<std::size_t>(&maxInputFrames)->default_value(maxInputFrames), 
-          "Maximum number of frames to read in input. 0 means no limit.");
+          "Maximum number of frames to read in input. 0 means no limit.")
+      ("readAhead", po::value<std::size_t>(&readAhead)->default_value(readAhead),
+          "Number of frames decoded in advance on a background thread (0 = synchronous decoding).");
 
   // parameters for voctree localizer
   po::options_description voctreeParams("Parameters specific for the vocabulary tree-based localizer");
@@ -352,6 +356,8 @@ int main(int argc, char** argv)
       nbFramesToProcess = maxInputFrames;
     }
     ALICEVISION_COUT("Input stream length is " << feed.nbFrames() << ".");
+    // the frames are read with the discretization's step
+    feed.setReadAhead(readAhead, step);
 
     //std::string featureFile, cameraResultFile, pointsFile;
     //featureFile = subMediaFilepath + "/cctag" + std::to_string(nRings) + "CC.out";
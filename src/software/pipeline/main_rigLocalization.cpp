@@ -43,7 +43,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -72,6 +72,8 @@ int main(int argc, char** argv)
   std::vector<std::string> cameraIntrinsics;
   /// the file containing the calibration data for the file (subposes)
   std::string rigCalibPath;
+  /// number of frames of each media decoded in advance on a background thread
+  std::size_t readAhead = 0;
   
   /// the describer types name to use for the matching
   std::string matchDescTypeNames = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
@@ -131,7 +133,9 @@ int main(int argc, char** argv)
           "The file containing the calibration data for the rig (subposes)")
       ("cameraIntrinsics", po::value<std::vector<std::string> >(&cameraIntrinsics)->multitoken()->required(),
           "The intrinsics calibration file for each camera of the rig. "
-          "(eg. --cameraIntrinsics /path/to/calib1.txt /path/to/calib2.txt).");
+          "(eg. --cameraIntrinsics /path/to/calib1.txt /path/to/calib2.txt).")
+      ("readAhead", po::value<std::size_t>(&readAhead)->default_value(readAhead),
+          "Number of frames of each media decoded in advance on a background thread (0 = synchronous decoding).");
   
   po::options_description commonParams("Common optional parameters for the localizer");
   commonParams.add_options()
@@ -355,6 +359,7 @@ int main(int argc, char** argv)
               << idCamera << " " << feedPath);
       return EXIT_FAILURE;
     }
+    feeders[idCamera]->setReadAhead(readAhead);
   }
 
   
@@ -13,6 +13,7 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/ImageCache.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
 
@@ -22,7 +23,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -45,10 +46,12 @@ int main(int argc, char* argv[])
     std::string outputFolder;
     std::string imagesFolder;
     std::string outTextureFileTypeName = EImageFileType_enumToString(EImageFileType::PNG);
+    std::string outMeshFileTypeName = mesh::EMeshFileType_enumToString(mesh::EMeshFileType::OBJ);
     bool flipNormals = false;
     mesh::TexturingParams texParams;
     std::string unwrapMethod = mesh::EUnwrapMethod_enumToString(mesh::EUnwrapMethod::Basic);
     std::string visibilityRemappingMethod = mesh::EVisibilityRemappingMethod_enumToString(texParams.visibilityRemappingMethod);
+    int imageCacheMB = 0;
 
     po::options_description allParams("AliceVision texturing");
 
@@ -59,7 +62,7 @@ int main(int argc, char* argv[])
         ("inputDenseReconstruction", po::value<std::string>(&inputDenseReconstruction)->required(),
             "Path to the dense reconstruction (mesh with per vertex visibility).")
         ("output,o", po::value<std::string>(&outputFolder)->required(),
-            "Folder for output mesh: OBJ, material and texture files.");
+            "Folder for output mesh: OBJ and material files or PLY file, and texture files.");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -68,6 +71,8 @@ int main(int argc, char* argv[])
           "Filename should be the image uid.")
         ("outputTextureFileType", po::value<std::string>(&outTextureFileTypeName)->default_value(outTextureFileTypeName),
           EImageFileType_informations().c_str())
+        ("outputMeshFileType", po::value<std::string>(&outMeshFileTypeName)->default_value(outMeshFileTypeName),
+          "Output mesh file type: obj (with a mtl file) or ply (binary).")
         ("textureSide", po::value<unsigned int>(&texParams.textureSide)->default_value(texParams.textureSide),
             "Output texture size")
         ("downscale", po::value<unsigned int>(&texParams.downscale)->default_value(texParams.downscale),
@@ -97,7 +102,11 @@ int main(int argc, char* argv[])
             "Method to remap visibilities from the reconstruction to the input mesh.\n"
             " * Pull: For each vertex of the input mesh, pull the visibilities from the closest vertex in the reconstruction.\n"
             " * Push: For each vertex of the reconstruction, push the visibilities to the closest triangle in the input mesh.\n"
-            " * PullPush: Combine results from Pull and Push results.'");
+            " * PullPush: Combine results from Pull and Push results.'")
+        ("imageCacheMB", po::value<int>(&imageCacheMB)->default_value(imageCacheMB),
+            "Memory budget (in MB) of the cache of the decoded images, 0 to disable it. "
+            "The texturing already keeps a cache of the source images, the shared cache only avoids decoding again "
+            "the images evicted from it between two texture atlases.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -139,9 +148,12 @@ int main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
+    system::ImageCache::getInstance().setMaxMemory(static_cast<std::size_t>(std::max(0, imageCacheMB)) * 1024 * 1024);
+
     texParams.visibilityRemappingMethod = mesh::EVisibilityRemappingMethod_stringToEnum(visibilityRemappingMethod);
     // set output texture file type
     const EImageFileType outputTextureFileType = EImageFileType_stringToEnum(outTextureFileTypeName);
+    const mesh::EMeshFileType outputMeshFileType = mesh::EMeshFileType_stringToEnum(outMeshFileTypeName);
 
     // read the input SfM scene
     sfmData::SfMData sfmData;
@@ -166,7 +178,7 @@ int main(int argc, char* argv[])
     // texturing from input mesh
     if(!inputMeshFilepath.empty())
     {
-      mesh.replaceMesh(inputMeshFilepath, flipNormals);
+      mesh.replaceMesh(inputMeshFilepath, flipNormals, (reconstructionMeshFolder/"denseReconstructionIndex.bin").string());
     }
 
     if(!mesh.hasUVs())
@@ -176,13 +188,14 @@ int main(int argc, char* argv[])
       ALICEVISION_LOG_INFO("Unwrapping done.");
     }
 
-    // save final obj file
-    mesh.saveAsOBJ(outputFolder, "texturedMesh", outputTextureFileType);
+    // save final mesh file
+    mesh.saveAs(outputFolder, "texturedMesh", outputMeshFileType, outputTextureFileType);
 
     // generate textures
     ALICEVISION_LOG_INFO("Generate textures.");
     mesh.generateTextures(mp, outputFolder, outputTextureFileType);
 
+    ALICEVISION_LOG_INFO(system::ImageCache::getInstance().getStats());
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
 }
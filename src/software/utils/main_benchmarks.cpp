@@ -0,0 +1,971 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/matcherType.hpp>
+#include <aliceVision/matchingImageCollection/matchingCommon.hpp>
+#include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+#include <aliceVision/mesh/Texturing.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/multiview/resection/P3PSolver.hpp>
+#include <aliceVision/multiview/resection/ResectionKernel.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/pipeline/RelativePoseInfo.hpp>
+#include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryTracker.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/cpu.hpp>
+#include <aliceVision/track/Track.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/voctree/VocabularyTree.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/version.hpp>
+
+#include <geogram/delaunay/delaunay.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+namespace pt = boost::property_tree;
+
+typedef feature::Descriptor<float, 128> DescriptorFloat;
+typedef feature::Descriptor<unsigned char, 128> DescriptorUChar;
+
+/// parameters of the synthetic inputs, the same parameters give the same inputs
+struct BenchmarkParams
+{
+  /// scale factor of the input sizes
+  double scale = 1.0;
+  unsigned int seed = 1;
+};
+
+/**
+ * @brief A kernel to benchmark on a synthetic input
+ */
+struct Benchmark
+{
+  /// size of the input (points, descriptors, nodes...)
+  std::size_t size = 0;
+  /// restore the input before each run, not timed (optional)
+  std::function<void()> reset;
+  /// run the kernel, returns a value to check the result (number of matches, flow, error...)
+  std::function<double()> run;
+};
+
+/// create the input of a benchmark, a benchmark without run is not available in this build
+typedef std::function<Benchmark(const BenchmarkParams&)> BenchmarkFactory;
+
+struct BenchmarkResult
+{
+  std::string name;
+  std::size_t size = 0;
+  std::vector<double> timesMs;
+  double value = 0.0;
+  std::size_t maxRssIncrease = 0;
+
+  double minMs() const { return *std::min_element(timesMs.begin(), timesMs.end()); }
+  double maxMs() const { return *std::max_element(timesMs.begin(), timesMs.end()); }
+  double meanMs() const { return std::accumulate(timesMs.begin(), timesMs.end(), 0.0) / timesMs.size(); }
+  double medianMs() const
+  {
+    std::vector<double> times = timesMs;
+    std::sort(times.begin(), times.end());
+    const std::size_t middle = times.size() / 2;
+    return (times.size() % 2 == 1) ? times[middle] : 0.5 * (times[middle - 1] + times[middle]);
+  }
+};
+
+std::size_t scaled(std::size_t size, double scale)
+{
+  return std::max(std::size_t(1), static_cast<std::size_t>(std::round(size * scale)));
+}
+
+/**
+ * @brief Create a ring of cameras looking at random points, NViewDataSet relies on std::rand
+ */
+NViewDataSet createRing(std::size_t nbViews, std::size_t nbPoints, const NViewDatasetConfigurator& config, unsigned int seed)
+{
+  std::srand(seed);
+  return NRealisticCamerasRing(nbViews, nbPoints, config);
+}
+
+/**
+ * @brief Replace a ratio of the points by random positions in the image
+ */
+void addOutliers(Mat& points, double outlierRatio, const NViewDatasetConfigurator& config, std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> x(0.0, 2.0 * config._cx);
+  std::uniform_real_distribution<double> y(0.0, 2.0 * config._cy);
+  std::bernoulli_distribution isOutlier(outlierRatio);
+
+  for(Mat::Index i = 0; i < points.cols(); ++i)
+  {
+    if(isOutlier(generator))
+      points.col(i) << x(generator), y(generator);
+  }
+}
+
+/**
+ * @brief Match the regions of a ring of views, all the pairs of views are matched.
+ * Each 3D point has a descriptor, perturbed in each view, and each view has distractor descriptors.
+ */
+template<class RegionsT>
+Benchmark matchingBenchmark(matching::EMatcherType matcherType, feature::EImageDescriberType descType, const BenchmarkParams& params)
+{
+  typedef typename RegionsT::DescriptorT DescriptorT;
+  const bool isBinary = (matcherType == matching::BRUTE_FORCE_HAMMING);
+
+  const std::size_t nbViews = 3;
+  const std::size_t nbPoints = scaled(1500, params.scale);
+  const std::size_t nbDistractors = nbPoints / 3;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = createRing(nbViews, nbPoints, config, params.seed);
+
+  std::mt19937 generator(params.seed);
+  std::uniform_int_distribution<int> value(0, 255);
+  std::uniform_int_distribution<int> noise(-8, 8);
+  std::uniform_int_distribution<int> byteIndex(0, DescriptorT::static_size - 1);
+  std::uniform_int_distribution<int> bitIndex(0, 7);
+  std::uniform_real_distribution<float> position(0.f, 2.f * config._cx);
+
+  const auto randomDescriptor = [&]()
+  {
+    DescriptorT descriptor;
+    for(std::size_t k = 0; k < DescriptorT::static_size; ++k)
+      descriptor[k] = static_cast<typename DescriptorT::bin_type>(value(generator));
+    return descriptor;
+  };
+
+  std::vector<DescriptorT> pointDescriptors(nbPoints);
+  for(DescriptorT& descriptor : pointDescriptors)
+    descriptor = randomDescriptor();
+
+  std::shared_ptr<feature::RegionsPerView> regionsPerView = std::make_shared<feature::RegionsPerView>();
+  for(std::size_t v = 0; v < nbViews; ++v)
+  {
+    RegionsT* regions = new RegionsT;
+    for(std::size_t i = 0; i < nbPoints; ++i)
+    {
+      DescriptorT descriptor = pointDescriptors[i];
+      if(isBinary)
+      {
+        for(int k = 0; k < 16; ++k)
+          descriptor[byteIndex(generator)] ^= static_cast<typename DescriptorT::bin_type>(1 << bitIndex(generator));
+      }
+      else
+      {
+        for(std::size_t k = 0; k < DescriptorT::static_size; ++k)
+          descriptor[k] = static_cast<typename DescriptorT::bin_type>(std::min(255, std::max(0, descriptor[k] + noise(generator))));
+      }
+      regions->Features().emplace_back(d._x[v](0, i), d._x[v](1, i), 1.f, 0.f);
+      regions->Descriptors().push_back(descriptor);
+    }
+    for(std::size_t i = 0; i < nbDistractors; ++i)
+    {
+      regions->Features().emplace_back(position(generator), position(generator), 1.f, 0.f);
+      regions->Descriptors().push_back(randomDescriptor());
+    }
+    regionsPerView->addRegions(v, descType, regions);
+  }
+
+  PairSet pairs;
+  for(std::size_t i = 0; i < nbViews; ++i)
+    for(std::size_t j = i + 1; j < nbViews; ++j)
+      pairs.insert(std::make_pair(i, j));
+
+  const std::shared_ptr<matchingImageCollection::IImageCollectionMatcher> matcher =
+    matchingImageCollection::createImageCollectionMatcher(matcherType, 0.8f);
+
+  Benchmark benchmark;
+  benchmark.size = nbViews * (nbPoints + nbDistractors);
+  benchmark.run = [=]()
+  {
+    matching::PairwiseMatches pairwiseMatches;
+    matcher->Match(*regionsPerView, pairs, descType, pairwiseMatches);
+
+    std::size_t nbMatches = 0;
+    for(const auto& matches : pairwiseMatches)
+      nbMatches += matches.second.getNbAllMatches();
+    return static_cast<double>(nbMatches);
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Build the tracks of the exact matches of a ring of views, all the points are visible in all the views
+ */
+Benchmark tracksBenchmark(const BenchmarkParams& params)
+{
+  const std::size_t nbViews = 20;
+  const std::size_t nbPoints = scaled(5000, params.scale);
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = createRing(nbViews, nbPoints, config, params.seed);
+  const sfmData::SfMData sfmData = sfm::getInputScene(d, config, camera::PINHOLE_CAMERA);
+
+  std::shared_ptr<matching::PairwiseMatches> pairwiseMatches = std::make_shared<matching::PairwiseMatches>();
+  sfm::generateSyntheticMatches(*pairwiseMatches, sfmData, feature::EImageDescriberType::SIFT);
+
+  Benchmark benchmark;
+  benchmark.size = nbViews * nbPoints;
+  benchmark.run = [=]()
+  {
+    track::TracksBuilder tracksBuilder;
+    tracksBuilder.build(*pairwiseMatches);
+    tracksBuilder.filter(2);
+
+    track::TracksMap tracks;
+    tracksBuilder.exportToSTL(tracks);
+    return static_cast<double>(tracks.size());
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Estimate the relative pose of two views with ACRansac on the essential matrix, 20% of outliers
+ */
+Benchmark essentialBenchmark(const BenchmarkParams& params)
+{
+  const std::size_t nbPoints = scaled(1000, params.scale);
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = createRing(2, nbPoints, config, params.seed);
+
+  std::mt19937 generator(params.seed);
+  Mat x1 = d._x[0];
+  Mat x2 = d._x[1];
+  addOutliers(x2, 0.2, config, generator);
+
+  const Mat3 K = d._K[0];
+  const std::pair<std::size_t, std::size_t> imageSize(2 * config._cx, 2 * config._cy);
+
+  Benchmark benchmark;
+  benchmark.size = nbPoints;
+  benchmark.run = [=]()
+  {
+    sfm::RelativePoseInfo relativePoseInfo;
+    sfm::robustRelativePose(K, K, x1, x2, relativePoseInfo, imageSize, imageSize, 4096);
+    return static_cast<double>(relativePoseInfo.vec_inliers.size());
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Localize a view from 2D-3D matches with the robust resection of the localizer, 20% of outliers.
+ * Without intrinsics, the 6 points DLT is used, else the P3P.
+ */
+Benchmark localizationBenchmark(bool useIntrinsics, robustEstimation::ERobustEstimator estimator, const BenchmarkParams& params)
+{
+  const std::size_t nbPoints = scaled(1000, params.scale);
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = createRing(1, nbPoints, config, params.seed);
+
+  std::mt19937 generator(params.seed);
+  sfm::ImageLocalizerMatchData matchData;
+  matchData.pt2D = d._x[0];
+  matchData.pt3D = d._X;
+  addOutliers(matchData.pt2D, 0.2, config, generator);
+
+  const Pair imageSize(2 * config._cx, 2 * config._cy);
+  std::shared_ptr<camera::Pinhole> intrinsics;
+  if(useIntrinsics)
+    intrinsics = std::make_shared<camera::Pinhole>(imageSize.first, imageSize.second, d._K[0]);
+
+  Benchmark benchmark;
+  benchmark.size = nbPoints;
+  benchmark.run = [=]()
+  {
+    sfm::ImageLocalizerMatchData resectionData = matchData;
+    geometry::Pose3 pose;
+    sfm::SfMLocalizer::Localize(imageSize, intrinsics.get(), resectionData, pose, estimator);
+    return static_cast<double>(resectionData.vec_inliers.size());
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Solve the resection on random minimal samples of normalized image points
+ */
+template<class SolverT>
+Benchmark resectionSolverBenchmark(const BenchmarkParams& params)
+{
+  const std::size_t nbPoints = 200;
+  const std::size_t nbSamples = scaled(2000, params.scale);
+  const std::size_t sampleSize = SolverT::MINIMUM_SAMPLES;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = createRing(1, nbPoints, config, params.seed);
+
+  const Mat3 Kinv = d._K[0].inverse();
+  Mat2X points2D(2, nbPoints);
+  for(std::size_t i = 0; i < nbPoints; ++i)
+    points2D.col(i) = (Kinv * d._x[0].col(i).homogeneous()).hnormalized();
+
+  std::mt19937 generator(params.seed);
+  std::vector<std::size_t> indices(nbPoints);
+  std::iota(indices.begin(), indices.end(), 0);
+
+  std::shared_ptr<std::vector<std::pair<Mat, Mat>>> samples = std::make_shared<std::vector<std::pair<Mat, Mat>>>(nbSamples);
+  for(auto& sample : *samples)
+  {
+    std::shuffle(indices.begin(), indices.end(), generator);
+    sample.first.resize(2, sampleSize);
+    sample.second.resize(3, sampleSize);
+    for(std::size_t i = 0; i < sampleSize; ++i)
+    {
+      sample.first.col(i) = points2D.col(indices[i]);
+      sample.second.col(i) = d._X.col(indices[i]);
+    }
+  }
+
+  Benchmark benchmark;
+  benchmark.size = nbSamples;
+  benchmark.run = [=]()
+  {
+    std::size_t nbModels = 0;
+    std::vector<Mat34> models;
+    for(const auto& sample : *samples)
+    {
+      models.clear();
+      SolverT::Solve(sample.first, sample.second, &models);
+      nbModels += models.size();
+    }
+    return static_cast<double>(nbModels);
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Refine a synthetic scene with noisy observations and structure, all the parameters are refined
+ */
+Benchmark bundleAdjustmentBenchmark(camera::EINTRINSIC intrinsicType, const BenchmarkParams& params)
+{
+  const std::size_t nbViews = 10;
+  const std::size_t nbPoints = scaled(1000, params.scale);
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = createRing(nbViews, nbPoints, config, params.seed);
+  const unsigned int seed = params.seed;
+
+  // the intrinsics of a scene are shared by its copies, the scene is created again before each run
+  std::shared_ptr<sfmData::SfMData> sfmData = std::make_shared<sfmData::SfMData>();
+
+  Benchmark benchmark;
+  benchmark.size = nbViews * nbPoints;
+  benchmark.reset = [=]()
+  {
+    *sfmData = sfm::getInputScene(d, config, intrinsicType);
+
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> pointNoise(0.0, 0.01);
+    std::normal_distribution<double> observationNoise(0.0, 0.5);
+    for(auto& landmark : sfmData->structure)
+    {
+      landmark.second.X += Vec3(pointNoise(generator), pointNoise(generator), pointNoise(generator));
+      for(auto& observation : landmark.second.observations)
+        observation.second.x += Vec2(observationNoise(generator), observationNoise(generator));
+    }
+  };
+  benchmark.run = [=]()
+  {
+    sfm::BundleAdjustmentCeres bundleAdjustment(sfm::BundleAdjustmentCeres::CeresOptions(false, true));
+    bundleAdjustment.adjust(*sfmData);
+    return sfm::RMSE(*sfmData);
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Quantize descriptors around the centers of a random vocabulary tree
+ */
+Benchmark voctreeBenchmark(bool batch, const BenchmarkParams& params)
+{
+  const std::size_t nbDescriptors = scaled(20000, params.scale);
+  const std::uint32_t levels = 4;
+  const std::uint32_t splits = 10;
+  std::mt19937 generator(params.seed);
+
+  const std::string treeName = (fs::temp_directory_path() / fs::unique_path("voctree_%%%%%%%%.tree")).string();
+  {
+    std::uniform_real_distribution<float> distribution(0.f, 255.f);
+
+    voctree::MutableVocabularyTree<DescriptorFloat> tree;
+    tree.setSize(levels, splits);
+    tree.centers().resize(tree.nodes());
+    tree.validCenters().resize(tree.nodes(), 1);
+
+    for(DescriptorFloat& center : tree.centers())
+      for(std::size_t k = 0; k < DescriptorFloat::static_size; ++k)
+        center[k] = distribution(generator);
+
+    tree.save(treeName);
+  }
+  std::shared_ptr<const voctree::VocabularyTree<DescriptorFloat>> tree = std::make_shared<const voctree::VocabularyTree<DescriptorFloat>>(treeName);
+  fs::remove(treeName);
+
+  std::uniform_int_distribution<std::size_t> centerIndex(0, tree->centers().size() - 1);
+  std::normal_distribution<float> noise(0.f, 20.f);
+
+  std::shared_ptr<std::vector<DescriptorUChar>> descriptors = std::make_shared<std::vector<DescriptorUChar>>(nbDescriptors);
+  for(DescriptorUChar& descriptor : *descriptors)
+  {
+    const DescriptorFloat& center = tree->centers()[centerIndex(generator)];
+    for(std::size_t k = 0; k < DescriptorUChar::static_size; ++k)
+      descriptor[k] = static_cast<unsigned char>(std::min(255.f, std::max(0.f, center[k] + noise(generator))));
+  }
+
+  Benchmark benchmark;
+  benchmark.size = nbDescriptors;
+  benchmark.run = [=]()
+  {
+    std::vector<voctree::Word> words;
+    if(batch)
+    {
+      words = tree->quantize(*descriptors);
+    }
+    else
+    {
+      words.reserve(descriptors->size());
+      for(const DescriptorUChar& descriptor : *descriptors)
+        words.push_back(tree->quantize(descriptor));
+    }
+    return std::accumulate(words.begin(), words.end(), 0.0);
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Tetrahedralize random points with a geogram Delaunay algorithm (BDEL or PDEL)
+ */
+Benchmark delaunayBenchmark(const std::string& algorithm, const BenchmarkParams& params)
+{
+  GEO::initialize();
+
+  // skip the algorithms geogram is not built with
+  // (Delaunay::create does not fail on an unknown algorithm, it falls back to a nearest neighbors search)
+  Benchmark benchmark;
+  if(!GEO::DelaunayFactory::has_creator(algorithm))
+    return benchmark;
+
+  const std::size_t nbPoints = scaled(200000, params.scale);
+  std::mt19937 generator(params.seed);
+  std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+
+  std::shared_ptr<std::vector<double>> points = std::make_shared<std::vector<double>>(3 * nbPoints);
+  for(double& value : *points)
+    value = coordinate(generator);
+
+  benchmark.size = nbPoints;
+  benchmark.run = [=]()
+  {
+    GEO::Delaunay_var tetrahedralization;
+    tetrahedralization = GEO::Delaunay::create(3, algorithm);
+    tetrahedralization->set_vertices(nbPoints, points->data());
+    return static_cast<double>(tetrahedralization->nb_cells());
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Create a 3D grid graph with random integer capacities,
+ * each node has 6 edge slots (-x, +x, -y, +y, -z, +z)
+ */
+fuseCut::MaxFlow_PushRelabel createGridGraph(int size, std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> edgeCapacity(0, 9);
+  std::uniform_int_distribution<int> terminalCapacity(0, 20);
+
+  const int nbNodes = size * size * size;
+  fuseCut::MaxFlow_PushRelabel graph(nbNodes, 6);
+
+  const auto nodeIndex = [size](int x, int y, int z) { return (z * size + y) * size + x; };
+
+  for(int z = 0; z < size; ++z)
+  {
+    for(int y = 0; y < size; ++y)
+    {
+      for(int x = 0; x < size; ++x)
+      {
+        const int n = nodeIndex(x, y, z);
+        graph.addNode(n, terminalCapacity(generator), terminalCapacity(generator));
+
+        // edges to the next nodes and their reverse edges
+        const int next[3] = {x + 1, y + 1, z + 1};
+        for(int axis = 0; axis < 3; ++axis)
+        {
+          if(next[axis] >= size)
+            continue;
+          const int neighbor = nodeIndex(axis == 0 ? x + 1 : x, axis == 1 ? y + 1 : y, axis == 2 ? z + 1 : z);
+          graph.addEdge(n, 2 * axis + 1, neighbor, 2 * axis, edgeCapacity(generator));
+          graph.addEdge(neighbor, 2 * axis, n, 2 * axis + 1, edgeCapacity(generator));
+        }
+      }
+    }
+  }
+  return graph;
+}
+
+/**
+ * @brief Solve the maxflow of a 3D grid graph with the multithreaded push-relabel or the sequential boykov-kolmogorov,
+ * the graph is built again before each run
+ */
+Benchmark maxflowBenchmark(bool sequential, const BenchmarkParams& params)
+{
+  struct Graphs
+  {
+    std::unique_ptr<fuseCut::MaxFlow_PushRelabel> pushRelabel;
+    std::unique_ptr<fuseCut::MaxFlow_AdjList> adjList;
+  };
+
+  const int size = static_cast<int>(scaled(48, std::cbrt(params.scale)));
+  const unsigned int seed = params.seed;
+  std::shared_ptr<Graphs> graphs = std::make_shared<Graphs>();
+
+  Benchmark benchmark;
+  benchmark.size = static_cast<std::size_t>(size) * size * size;
+  benchmark.reset = [=]()
+  {
+    std::mt19937 generator(seed);
+    graphs->pushRelabel.reset(new fuseCut::MaxFlow_PushRelabel(createGridGraph(size, generator)));
+    if(!sequential)
+      return;
+    graphs->adjList.reset(new fuseCut::MaxFlow_AdjList(graphs->pushRelabel->getNbNodes()));
+    graphs->pushRelabel->copyTo(*graphs->adjList);
+    graphs->pushRelabel.reset();
+  };
+  benchmark.run = [=]()
+  {
+    if(sequential)
+      return static_cast<double>(graphs->adjList->compute());
+    return static_cast<double>(graphs->pushRelabel->compute());
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Rasterize the triangles of a UV grid in a texture, as the texturing does for each source image
+ * (3D position of each pixel from its barycentric coordinates), without the image sampling
+ */
+Benchmark rasterizationBenchmark(const BenchmarkParams& params)
+{
+  const int textureSide = static_cast<int>(scaled(2048, std::sqrt(params.scale)));
+  const int gridSize = 96;
+  const double cellSize = static_cast<double>(textureSide) / gridSize;
+
+  std::mt19937 generator(params.seed);
+  std::uniform_real_distribution<double> jitter(-0.25 * cellSize, 0.25 * cellSize);
+
+  // vertices of the grid with jittered inner UVs and a wavy surface
+  std::vector<Point2d> uvs;
+  std::vector<Point3d> points;
+  for(int j = 0; j <= gridSize; ++j)
+  {
+    for(int i = 0; i <= gridSize; ++i)
+    {
+      const bool isBorder = (i == 0 || j == 0 || i == gridSize || j == gridSize);
+      uvs.emplace_back(i * cellSize + (isBorder ? 0.0 : jitter(generator)), j * cellSize + (isBorder ? 0.0 : jitter(generator)));
+      points.emplace_back(i, j, std::sin(0.1 * i) * std::cos(0.1 * j));
+    }
+  }
+
+  // two triangles per cell
+  std::shared_ptr<std::vector<std::array<int, 3>>> triangles = std::make_shared<std::vector<std::array<int, 3>>>();
+  for(int j = 0; j < gridSize; ++j)
+  {
+    for(int i = 0; i < gridSize; ++i)
+    {
+      const int v = j * (gridSize + 1) + i;
+      triangles->push_back({{v, v + 1, v + gridSize + 2}});
+      triangles->push_back({{v, v + gridSize + 2, v + gridSize + 1}});
+    }
+  }
+
+  std::shared_ptr<const std::vector<Point2d>> sharedUvs = std::make_shared<const std::vector<Point2d>>(std::move(uvs));
+  std::shared_ptr<const std::vector<Point3d>> sharedPoints = std::make_shared<const std::vector<Point3d>>(std::move(points));
+  std::shared_ptr<std::vector<float>> texture = std::make_shared<std::vector<float>>();
+
+  Benchmark benchmark;
+  benchmark.size = static_cast<std::size_t>(textureSide) * textureSide;
+  benchmark.reset = [=]()
+  {
+    texture->assign(static_cast<std::size_t>(textureSide) * textureSide, 0.f);
+  };
+  benchmark.run = [=]()
+  {
+    std::size_t nbPixels = 0;
+
+    #pragma omp parallel for reduction(+:nbPixels)
+    for(int ti = 0; ti < static_cast<int>(triangles->size()); ++ti)
+    {
+      Point2d triPixs[3];
+      Point3d triPts[3];
+      for(int k = 0; k < 3; ++k)
+      {
+        triPixs[k] = (*sharedUvs)[(*triangles)[ti][k]];
+        triPts[k] = (*sharedPoints)[(*triangles)[ti][k]];
+      }
+
+      // triangle bounding box in pixel indexes
+      const int minX = std::max(0, static_cast<int>(std::floor(std::min(std::min(triPixs[0].x, triPixs[1].x), triPixs[2].x))));
+      const int minY = std::max(0, static_cast<int>(std::floor(std::min(std::min(triPixs[0].y, triPixs[1].y), triPixs[2].y))));
+      const int maxX = std::min(textureSide, static_cast<int>(std::ceil(std::max(std::max(triPixs[0].x, triPixs[1].x), triPixs[2].x))));
+      const int maxY = std::min(textureSide, static_cast<int>(std::ceil(std::max(std::max(triPixs[0].y, triPixs[1].y), triPixs[2].y))));
+
+      for(int y = minY; y < maxY; ++y)
+      {
+        for(int x = minX; x < maxX; ++x)
+        {
+          Point2d barycCoords;
+          if(!mesh::isPixelInTriangle(triPixs, Pixel(x, y), barycCoords))
+            continue;
+
+          const Point3d pt3d = mesh::barycentricToCartesian(triPts, barycCoords);
+          float& texel = (*texture)[static_cast<std::size_t>(y) * textureSide + x];
+          #pragma omp atomic
+          texel += static_cast<float>(pt3d.z);
+          ++nbPixels;
+        }
+      }
+    }
+    return static_cast<double>(nbPixels);
+  };
+  return benchmark;
+}
+
+/**
+ * @brief Get the benchmarks, named <module>.<kernel>
+ */
+std::vector<std::pair<std::string, BenchmarkFactory>> getBenchmarks()
+{
+  std::vector<std::pair<std::string, BenchmarkFactory>> benchmarks;
+
+  for(matching::EMatcherType matcherType : {matching::BRUTE_FORCE_L2, matching::ANN_L2, matching::CASCADE_HASHING_L2, matching::FAST_CASCADE_HASHING_L2})
+    benchmarks.emplace_back("matching." + matching::EMatcherType_enumToString(matcherType),
+                            [matcherType](const BenchmarkParams& params) { return matchingBenchmark<feature::SIFT_Regions>(matcherType, feature::EImageDescriberType::SIFT, params); });
+  benchmarks.emplace_back("matching." + matching::EMatcherType_enumToString(matching::BRUTE_FORCE_HAMMING),
+                          [](const BenchmarkParams& params) { return matchingBenchmark<feature::AKAZE_BinaryRegions>(matching::BRUTE_FORCE_HAMMING, feature::EImageDescriberType::AKAZE_MLDB, params); });
+
+  benchmarks.emplace_back("track.build", tracksBenchmark);
+
+  benchmarks.emplace_back("robustEstimation.ACRansac.essential", essentialBenchmark);
+  benchmarks.emplace_back("robustEstimation.ACRansac.resection6Points", [](const BenchmarkParams& params) { return localizationBenchmark(false, robustEstimation::ERobustEstimator::ACRANSAC, params); });
+  benchmarks.emplace_back("robustEstimation.ACRansac.resectionP3P", [](const BenchmarkParams& params) { return localizationBenchmark(true, robustEstimation::ERobustEstimator::ACRANSAC, params); });
+  benchmarks.emplace_back("robustEstimation.LORansac.resectionP3P", [](const BenchmarkParams& params) { return localizationBenchmark(true, robustEstimation::ERobustEstimator::LORANSAC, params); });
+
+  benchmarks.emplace_back("resection.P3P", resectionSolverBenchmark<resection::P3PSolver>);
+  benchmarks.emplace_back("resection.6Points", resectionSolverBenchmark<resection::kernel::SixPointResectionSolver>);
+  benchmarks.emplace_back("resection.EPnP", resectionSolverBenchmark<resection::kernel::EpnpSolver>);
+
+  benchmarks.emplace_back("sfm.bundleAdjustment.pinhole", [](const BenchmarkParams& params) { return bundleAdjustmentBenchmark(camera::PINHOLE_CAMERA, params); });
+  benchmarks.emplace_back("sfm.bundleAdjustment.radial1", [](const BenchmarkParams& params) { return bundleAdjustmentBenchmark(camera::PINHOLE_CAMERA_RADIAL1, params); });
+  benchmarks.emplace_back("sfm.bundleAdjustment.radial3", [](const BenchmarkParams& params) { return bundleAdjustmentBenchmark(camera::PINHOLE_CAMERA_RADIAL3, params); });
+
+  benchmarks.emplace_back("voctree.quantize", [](const BenchmarkParams& params) { return voctreeBenchmark(false, params); });
+  benchmarks.emplace_back("voctree.quantizeBatch", [](const BenchmarkParams& params) { return voctreeBenchmark(true, params); });
+
+  benchmarks.emplace_back("meshing.delaunay", [](const BenchmarkParams& params) { return delaunayBenchmark("BDEL", params); });
+  benchmarks.emplace_back("meshing.delaunayParallel", [](const BenchmarkParams& params) { return delaunayBenchmark("PDEL", params); });
+  benchmarks.emplace_back("meshing.maxflowPushRelabel", [](const BenchmarkParams& params) { return maxflowBenchmark(false, params); });
+  benchmarks.emplace_back("meshing.maxflowBoykovKolmogorov", [](const BenchmarkParams& params) { return maxflowBenchmark(true, params); });
+
+  benchmarks.emplace_back("texturing.rasterize", rasterizationBenchmark);
+
+  return benchmarks;
+}
+
+/**
+ * @brief Create the input of a benchmark and time its runs, the first run is a warm-up run
+ * @return false if the benchmark is not available in this build
+ */
+bool runBenchmark(const std::string& name, const BenchmarkFactory& factory, const BenchmarkParams& params, int repetitions, BenchmarkResult& result)
+{
+  result.name = name;
+  {
+    ALICEVISION_MEMORY_PHASE(name);
+
+    const Benchmark benchmark = factory(params);
+    if(!benchmark.run)
+      return false;
+    result.size = benchmark.size;
+
+    for(int i = 0; i <= repetitions; ++i)
+    {
+      if(benchmark.reset)
+        benchmark.reset();
+      // same random sequence for the robust estimators at each run
+      std::srand(params.seed);
+
+      system::Timer timer;
+      result.value = benchmark.run();
+      if(i > 0)
+        result.timesMs.push_back(timer.elapsedMs());
+    }
+  }
+
+  for(const system::MemoryTracker::PhaseStats& stats : system::MemoryTracker::getInstance().getPhases())
+  {
+    if(stats.name == name)
+      result.maxRssIncrease = stats.maxRssIncrease;
+  }
+  return true;
+}
+
+void writeResults(std::ostream& os, const std::vector<BenchmarkResult>& results, const BenchmarkParams& params, int repetitions)
+{
+  os << "{" << std::endl
+     << "  \"version\": \"" << ALICEVISION_VERSION_STRING << "\"," << std::endl
+     << "  \"hardware\": {\"cpuCores\": " << system::get_total_cpus()
+     << ", \"cpuFrequency\": " << system::cpu_clock_by_os()
+     << ", \"maxThreads\": " << omp_get_max_threads()
+     << ", \"totalRam\": " << system::getMemoryInfo().totalRam << "}," << std::endl
+     << "  \"scale\": " << params.scale << "," << std::endl
+     << "  \"seed\": " << params.seed << "," << std::endl
+     << "  \"repetitions\": " << repetitions << "," << std::endl
+     << "  \"benchmarks\": [";
+
+  for(std::size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& result = results[i];
+    os.unsetf(std::ios::floatfield);
+    os << ((i == 0) ? "" : ",") << std::endl
+       << "    {\"name\": \"" << result.name << "\""
+       << ", \"size\": " << result.size
+       << ", \"runs\": " << result.timesMs.size()
+       << std::fixed << std::setprecision(3)
+       << ", \"minMs\": " << result.minMs()
+       << ", \"medianMs\": " << result.medianMs()
+       << ", \"meanMs\": " << result.meanMs()
+       << ", \"maxMs\": " << result.maxMs()
+       << ", \"value\": " << std::setprecision(10) << result.value
+       << ", \"maxRssIncrease\": " << result.maxRssIncrease << "}";
+  }
+  os << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
+
+/**
+ * @brief Compare the median times with the results of a previous run
+ * @return the number of benchmarks slower than the baseline by more than the tolerance
+ */
+std::size_t compareWithBaseline(const std::vector<BenchmarkResult>& results, const BenchmarkParams& params, const std::string& baselineFilepath, double tolerance)
+{
+  pt::ptree baseline;
+  pt::read_json(baselineFilepath, baseline);
+
+  std::map<std::string, const pt::ptree*> baselineBenchmarks;
+  for(const auto& benchmark : baseline.get_child("benchmarks"))
+    baselineBenchmarks[benchmark.second.get<std::string>("name")] = &benchmark.second;
+
+  if(baseline.get<double>("scale") != params.scale || baseline.get<unsigned int>("seed") != params.seed)
+    ALICEVISION_LOG_WARNING("The baseline was run with other inputs (scale: " << baseline.get<double>("scale") << ", seed: " << baseline.get<unsigned int>("seed") << ").");
+
+  std::size_t nbRegressions = 0;
+  for(const BenchmarkResult& result : results)
+  {
+    const auto it = baselineBenchmarks.find(result.name);
+    if(it == baselineBenchmarks.end())
+    {
+      ALICEVISION_LOG_INFO(result.name << ": not in the baseline.");
+      continue;
+    }
+    const double baselineMs = it->second->get<double>("medianMs");
+    const double ratio = (baselineMs > 0.0) ? result.medianMs() / baselineMs : 1.0;
+
+    if(ratio > 1.0 + tolerance)
+    {
+      ALICEVISION_LOG_ERROR(result.name << ": " << result.medianMs() << " ms instead of " << baselineMs << " ms (x" << ratio << ").");
+      ++nbRegressions;
+    }
+    else
+    {
+      ALICEVISION_LOG_INFO(result.name << ": " << result.medianMs() << " ms, baseline: " << baselineMs << " ms (x" << ratio << ").");
+    }
+
+    const double baselineValue = it->second->get<double>("value");
+    if(std::abs(result.value - baselineValue) > 1e-6 * std::max(1.0, std::abs(baselineValue)))
+      ALICEVISION_LOG_WARNING(result.name << ": the result value " << result.value << " differs from the baseline (" << baselineValue << ").");
+  }
+  return nbRegressions;
+}
+
+/*
+ * This program is used to benchmark the core kernels of the SfM and MVS pipelines on deterministic synthetic inputs
+ */
+int main(int argc, char** argv)
+{
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string outputFilepath;
+  std::vector<std::string> filters;
+  std::string baselineFilepath;
+  BenchmarkParams params;
+  int repetitions = 5;
+  double tolerance = 0.2;
+  bool listOnly = false;
+
+  po::options_description allParams("This program is used to benchmark the core kernels of the SfM and MVS pipelines\n"
+                                    "(matching, tracks, robust estimation, resection, bundle adjustment, vocabulary tree,\n"
+                                    "Delaunay, maxflow and texturing) on deterministic synthetic inputs.\n"
+                                    "The timings are written in JSON and can be compared with a previous run.\n"
+                                    "AliceVision benchmarks");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("output,o", po::value<std::string>(&outputFilepath)->default_value(outputFilepath),
+      "Output JSON file of the results, printed on the standard output if empty.")
+    ("filter", po::value<std::vector<std::string>>(&filters)->multitoken(),
+      "Only run the benchmarks whose name contains one of these strings.")
+    ("list", po::bool_switch(&listOnly),
+      "List the benchmarks and exit.")
+    ("repetitions", po::value<int>(&repetitions)->default_value(repetitions),
+      "Number of timed runs of each benchmark, after a warm-up run.")
+    ("scale", po::value<double>(&params.scale)->default_value(params.scale),
+      "Scale factor of the synthetic input sizes.")
+    ("seed", po::value<unsigned int>(&params.seed)->default_value(params.seed),
+      "Seed of the synthetic inputs.")
+    ("baseline", po::value<std::string>(&baselineFilepath)->default_value(baselineFilepath),
+      "JSON results of a previous run, the program fails if a benchmark is slower than the baseline.")
+    ("tolerance", po::value<double>(&tolerance)->default_value(tolerance),
+      "Relative slowdown of the median time tolerated against the baseline.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(repetitions < 1 || params.scale <= 0.0)
+  {
+    ALICEVISION_LOG_ERROR("The number of repetitions and the scale must be positive.");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<BenchmarkResult> results;
+  for(const auto& benchmark : getBenchmarks())
+  {
+    const std::string& name = benchmark.first;
+    if(!filters.empty() && std::none_of(filters.begin(), filters.end(), [&name](const std::string& filter) { return name.find(filter) != std::string::npos; }))
+      continue;
+
+    if(listOnly)
+    {
+      ALICEVISION_COUT(name);
+      continue;
+    }
+
+    BenchmarkResult result;
+    if(!runBenchmark(name, benchmark.second, params, repetitions, result))
+    {
+      ALICEVISION_LOG_WARNING(name << ": not available in this build.");
+      continue;
+    }
+    ALICEVISION_LOG_INFO(name << " (size " << result.size << "): median " << result.medianMs() << " ms, min " << result.minMs() << " ms, value " << result.value);
+    results.push_back(result);
+  }
+
+  if(listOnly)
+    return EXIT_SUCCESS;
+
+  if(outputFilepath.empty())
+  {
+    writeResults(std::cout, results, params, repetitions);
+  }
+  else
+  {
+    std::ofstream os(outputFilepath);
+    writeResults(os, results, params, repetitions);
+    if(!os.good())
+    {
+      ALICEVISION_LOG_ERROR("Cannot write the results to " << outputFilepath);
+      return EXIT_FAILURE;
+    }
+    ALICEVISION_LOG_INFO("Results written to " << outputFilepath);
+  }
+
+  if(baselineFilepath.empty())
+    return EXIT_SUCCESS;
+
+  std::size_t nbRegressions = 0;
+  try
+  {
+    nbRegressions = compareWithBaseline(results, params, baselineFilepath, tolerance);
+  }
+  catch(const pt::ptree_error& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot read the baseline " << baselineFilepath << ": " << e.what());
+    return EXIT_FAILURE;
+  }
+
+  if(nbRegressions != 0)
+  {
+    ALICEVISION_LOG_ERROR(nbRegressions << " benchmark(s) slower than the baseline.");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Solve the graph with the multithreaded and the sequential maxflow and log the timings
+ * @return the number of nodes with a different labeling
+ */
+std::size_t benchmark(const std::string& graphFilepath, bool compareSequential)
+{
+  fuseCut::MaxFlow_PushRelabel graph;
+  graph.load(graphFilepath);
+  ALICEVISION_LOG_INFO("Graph " << graphFilepath << ": " << graph.getNbNodes() << " nodes, " << graph.getDegree() << " edges per node");
+
+  std::unique_ptr<fuseCut::MaxFlow_AdjList> sequentialGraph;
+  if(compareSequential)
+  {
+    system::Timer timer;
+    sequentialGraph.reset(new fuseCut::MaxFlow_AdjList(graph.getNbNodes()));
+    graph.copyTo(*sequentialGraph);
+    ALICEVISION_LOG_INFO("Sequential graph built in " << timer.elapsed() << " s");
+  }
+
+  system::Timer timer;
+  const float flow = graph.compute();
+  const double time = timer.elapsed();
+
+  ALICEVISION_LOG_INFO("Multithreaded push-relabel:" << std::endl
+    << "\t- time: " << time << " s" << std::endl
+    << "\t- flow: " << flow << std::endl
+    << "\t- peak memory: " << system::getPeakUsedMemory() / (1024 * 1024) << " MB");
+
+  if(!compareSequential)
+    return 0;
+
+  timer.reset();
+  const float sequentialFlow = sequentialGraph->compute();
+  const double sequentialTime = timer.elapsed();
+
+  std::size_t nbDifferent = 0;
+  for(std::size_t n = 0; n < graph.getNbNodes(); ++n)
+  {
+    if(graph.isTarget(n) != sequentialGraph->isTarget(n))
+      ++nbDifferent;
+  }
+
+  ALICEVISION_LOG_INFO("Sequential boykov-kolmogorov:" << std::endl
+    << "\t- time: " << sequentialTime << " s" << std::endl
+    << "\t- flow: " << sequentialFlow << std::endl
+    << "\t- speedup: " << sequentialTime / time << std::endl
+    << "\t- different labels: " << nbDifferent);
+
+  return nbDifferent;
+}
+
+/*
+ * This program is used to benchmark the maxflow of the meshing on saved graphs
+ */
+int main(int argc, char** argv)
+{
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::vector<std::string> graphFilepaths;
+  bool compareSequential = true;
+
+  po::options_description allParams("This program is used to benchmark the multithreaded maxflow of the meshing against the sequential one,\n"
+                                    "on graphs saved by aliceVision_meshing with --saveMaxflowGraph.\n"
+                                    "AliceVision maxflowBenchmark");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::vector<std::string>>(&graphFilepaths)->required()->multitoken(), "Maxflow graph files (.bin).");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("compareSequential", po::value<bool>(&compareSequential)->default_value(compareSequential), "Compare with the sequential boykov-kolmogorov maxflow.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  std::size_t nbDifferent = 0;
+  for(const std::string& graphFilepath : graphFilepaths)
+    nbDifferent += benchmark(graphFilepath, compareSequential);
+
+  if(nbDifferent != 0)
+  {
+    ALICEVISION_LOG_ERROR("The multithreaded maxflow gives a different labeling.");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
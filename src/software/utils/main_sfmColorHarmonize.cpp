@@ -6,6 +6,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/ImageCache.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/cmdline.hpp>
 
@@ -20,7 +21,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -39,6 +40,7 @@ int main( int argc, char **argv )
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   int selectionMethod;
   int imgRef;
+  int imageCacheMB = 1024;
 
   // user optional parameters
 
@@ -64,7 +66,9 @@ int main( int argc, char **argv )
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
-      feature::EImageDescriberType_informations().c_str());
+      feature::EImageDescriberType_informations().c_str())
+    ("imageCacheMB", po::value<int>(&imageCacheMB)->default_value(imageCacheMB),
+      "Memory budget (in MB) of the cache of the decoded images, 0 to disable it.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -105,6 +109,8 @@ int main( int argc, char **argv )
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  system::ImageCache::getInstance().setMaxMemory(static_cast<std::size_t>(std::max(0, imageCacheMB)) * 1024 * 1024);
+
   if(sfmDataFilename.empty())
   {
     ALICEVISION_LOG_ERROR("It is an invalid file input");
@@ -130,6 +136,7 @@ int main( int argc, char **argv )
 
   if(colorHarmonizeEngine.Process())
   {
+    ALICEVISION_LOG_INFO(system::ImageCache::getInstance().getStats());
     ALICEVISION_LOG_INFO("Color harmonization took: " << timer.elapsed() << " s");
     return EXIT_SUCCESS;
   }
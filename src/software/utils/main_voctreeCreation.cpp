@@ -7,6 +7,7 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/voctree/TreeBuilder.hpp>
+#include <aliceVision/voctree/MiniBatchTreeBuilder.hpp>
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 #include <aliceVision/voctree/descriptorLoader.hpp>
@@ -26,7 +27,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -54,6 +55,10 @@ int main(int argc, char** argv)
   std::uint32_t restart = 5;
   std::uint32_t LEVELS = 6;
   bool sanityCheck = true;
+  bool miniBatch = false;
+  std::size_t batchSize = 10000;
+  std::size_t iterations = 2;
+  std::size_t maxSamples = 1000000;
 
   po::options_description allParams("This program is used to load the sift descriptors from a SfMData file and create a vocabulary tree\n"
                                     "It takes as input either a list.txt file containing the a simple list of images (bundler format and older AliceVision version format)\n"
@@ -73,7 +78,11 @@ int main(int argc, char** argv)
     (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
     ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
     (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
-    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
+    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree")
+    ("miniBatch", po::value<bool>(&miniBatch)->default_value(miniBatch), "Use a mini-batch k-means: the descriptors are streamed from the files instead of being loaded all at once")
+    ("batchSize", po::value<std::size_t>(&batchSize)->default_value(batchSize), "Mini-batch k-means: number of descriptors per mini-batch")
+    ("iterations", po::value<std::size_t>(&iterations)->default_value(iterations), "Mini-batch k-means: number of passes over the descriptors per level")
+    ("maxSamples", po::value<std::size_t>(&maxSamples)->default_value(maxSamples), "Mini-batch k-means: maximum number of descriptors sampled per level for the k-means++ initialization");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -122,66 +131,97 @@ int main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
-  std::vector<DescriptorFloat> descriptors;
+  std::map<IndexT, std::string> descriptorsFiles;
+  aliceVision::voctree::getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFiles);
 
+  std::vector<DescriptorFloat> descriptors;
   std::vector<size_t> descRead;
-  ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
-  auto detect_start = std::chrono::steady_clock::now();
-  size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
-  auto detect_end = std::chrono::steady_clock::now();
-  auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-  if(descriptors.size() == 0)
+
+  if(!miniBatch)
   {
-    ALICEVISION_CERR("No descriptors loaded!!");
-    return EXIT_FAILURE;
-  }
+    ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
+    auto detect_start = std::chrono::steady_clock::now();
+    size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
+    auto detect_end = std::chrono::steady_clock::now();
+    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+    if(descriptors.size() == 0)
+    {
+      ALICEVISION_CERR("No descriptors loaded!!");
+      return EXIT_FAILURE;
+    }
 
-  ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
-  ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
+    ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
+    ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
+  }
 
   // Create tree
-  aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
-  builder.setVerbose(tbVerbosity);
-  builder.kmeans().setRestarts(restart);
   ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
-  detect_start = std::chrono::steady_clock::now();
-  builder.build(descriptors, K, LEVELS);
-  detect_end = std::chrono::steady_clock::now();
-  detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+  auto detect_start = std::chrono::steady_clock::now();
+  if(miniBatch)
+  {
+    // stream the descriptors from the files
+    aliceVision::voctree::DescriptorFileReader<DescriptorFloat, DescriptorUChar> reader(descriptorsFiles);
+    {
+      // the descriptors are not loaded in memory, check that the files have at least one
+      std::vector<DescriptorFloat> firstDescriptors;
+      if(reader.read(firstDescriptors, 1) == 0)
+      {
+        ALICEVISION_CERR("No descriptors loaded!!");
+        return EXIT_FAILURE;
+      }
+      reader.rewind();
+    }
+    aliceVision::voctree::MiniBatchTreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
+    builder.setBatchSize(batchSize);
+    builder.setIterations(iterations);
+    builder.setMaxSamples(maxSamples);
+    builder.buildFromReader(reader, K, LEVELS);
+    ALICEVISION_COUT(builder.tree().centers().size() << " centers");
+    ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
+    builder.tree().save(treeName);
+  }
+  else
+  {
+    aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
+    builder.setVerbose(tbVerbosity);
+    builder.kmeans().setRestarts(restart);
+    builder.build(descriptors, K, LEVELS);
+    ALICEVISION_COUT(builder.tree().centers().size() << " centers");
+    ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
+    builder.tree().save(treeName);
+  }
+  auto detect_end = std::chrono::steady_clock::now();
+  auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
   ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
-  ALICEVISION_COUT(builder.tree().centers().size() << " centers");
-  ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
-  builder.tree().save(treeName);
+
+  // reload the saved tree to quantize the features in batch
+  const aliceVision::voctree::VocabularyTree<DescriptorFloat> tree(treeName);
 
   aliceVision::voctree::SparseHistogramPerImage allSparseHistograms;
-  // temporary vector used to save all the visual word for each image before adding them to documents
-  std::vector<aliceVision::voctree::Word> imgVisualWords;
   ALICEVISION_COUT("Quantizing the features");
   size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
   detect_start = std::chrono::steady_clock::now();
   // pass each feature through the vocabulary tree to get the associated visual word
-  // for each read images, recover the number of features in it from descRead and loop over the features
-  for(size_t i = 0; i < descRead.size(); ++i)
+  // for each image, get its features (from the loaded features or from its file) and quantize them
+  std::size_t i = 0;
+  for(const auto& currentFile : descriptorsFiles)
   {
-    // for each image:
-    // clear the temporary vector used to save all the visual word and allocate the proper size
-    imgVisualWords.clear();
-    // allocate as many visual words as the number of the features in the image
-    imgVisualWords.resize(descRead[i], 0);
-
-    #pragma omp parallel for
-    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descRead[i]); ++j)
+    std::vector<DescriptorFloat> imgDescriptors;
+    if(miniBatch)
     {
-      //	store the visual word associated to the feature in the temporary list
-      imgVisualWords[j] = builder.tree().quantize(descriptors[ j + offset ]);
+      aliceVision::feature::loadDescsFromBinFile<DescriptorFloat, DescriptorUChar>(currentFile.second, imgDescriptors);
     }
-    aliceVision::voctree::SparseHistogram histo;
-    aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
+    else
+    {
+      imgDescriptors.assign(descriptors.begin() + offset, descriptors.begin() + offset + descRead[i]);
+      // update the offset
+      offset += descRead[i];
+    }
+
+    aliceVision::voctree::SparseHistogram histo = tree.quantizeToSparse(imgDescriptors);
     // add the vector to the documents
     allSparseHistograms[i] = histo;
-
-    // update the offset
-    offset += descRead[i];
+    ++i;
   }
   detect_end = std::chrono::steady_clock::now();
   detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
@@ -190,7 +230,7 @@ int main(int argc, char** argv)
 
   ALICEVISION_COUT("Creating the database...");
   // Add each object (document) to the database
-  aliceVision::voctree::Database db(builder.tree().words());
+  aliceVision::voctree::Database db(tree.words());
   ALICEVISION_COUT("\tfound " << allSparseHistograms.size() << " documents");
   for(const auto &doc : allSparseHistograms)
   {
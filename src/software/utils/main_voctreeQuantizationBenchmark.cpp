@@ -0,0 +1,206 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2019 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/voctree/VocabularyTree.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+static const int DIMENSION = 128;
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+typedef aliceVision::feature::Descriptor<float, DIMENSION> DescriptorFloat;
+typedef aliceVision::feature::Descriptor<unsigned char, DIMENSION> DescriptorUChar;
+
+/**
+ * @brief Create and save a random vocabulary tree with centers in the uint8 range
+ */
+void createSyntheticTree(const std::string& treeName, std::uint32_t levels, std::uint32_t splits, std::mt19937& generator)
+{
+  std::uniform_real_distribution<float> distribution(0.f, 255.f);
+
+  voctree::MutableVocabularyTree<DescriptorFloat> tree;
+  tree.setSize(levels, splits);
+  tree.centers().resize(tree.nodes());
+  tree.validCenters().resize(tree.nodes(), 1);
+
+  for(DescriptorFloat& center : tree.centers())
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      center[d] = distribution(generator);
+
+  tree.save(treeName);
+}
+
+/**
+ * @brief Create descriptors around random centers of the tree
+ */
+template<class DescriptorT>
+std::vector<DescriptorT> createDescriptors(const voctree::VocabularyTree<DescriptorFloat>& tree, std::size_t nbDescriptors, std::mt19937& generator)
+{
+  std::uniform_int_distribution<std::size_t> centerIndex(0, tree.centers().size() - 1);
+  std::normal_distribution<float> noise(0.f, 20.f);
+
+  std::vector<DescriptorT> descriptors(nbDescriptors);
+  for(DescriptorT& descriptor : descriptors)
+  {
+    const DescriptorFloat& center = tree.centers()[centerIndex(generator)];
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      descriptor[d] = static_cast<typename DescriptorT::value_type>(std::min(255.f, std::max(0.f, center[d] + noise(generator))));
+  }
+  return descriptors;
+}
+
+/**
+ * @brief Quantize the descriptors with the per-descriptor and the batch quantization and log the timings
+ * @return the number of descriptors with a different visual word
+ */
+template<class DescriptorT>
+std::size_t benchmark(const voctree::VocabularyTree<DescriptorFloat>& tree, const std::vector<DescriptorT>& descriptors, const std::string& name)
+{
+  typedef std::chrono::duration<double> Seconds;
+
+  // per-descriptor quantization
+  const auto referenceStart = std::chrono::steady_clock::now();
+  std::vector<voctree::Word> referenceWords(descriptors.size());
+  #pragma omp parallel for
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(descriptors.size()); ++i)
+    referenceWords[i] = tree.quantize(descriptors[i]);
+  const Seconds referenceTime = std::chrono::steady_clock::now() - referenceStart;
+
+  // batch quantization
+  const auto batchStart = std::chrono::steady_clock::now();
+  const std::vector<voctree::Word> batchWords = tree.quantize(descriptors);
+  const Seconds batchTime = std::chrono::steady_clock::now() - batchStart;
+
+  std::size_t nbDifferent = 0;
+  for(std::size_t i = 0; i < descriptors.size(); ++i)
+    if(referenceWords[i] != batchWords[i])
+      ++nbDifferent;
+
+  ALICEVISION_LOG_INFO(name << " descriptors (batch quantizer " << (tree.isBatchQuantized<DescriptorT>() ? "enabled" : "disabled") << "):" << std::endl
+    << "\t- per-descriptor: " << referenceTime.count() << " s (" << descriptors.size() / referenceTime.count() << " descriptors/s)" << std::endl
+    << "\t- batch: " << batchTime.count() << " s (" << descriptors.size() / batchTime.count() << " descriptors/s)" << std::endl
+    << "\t- speedup: " << referenceTime.count() / batchTime.count() << std::endl
+    << "\t- different words: " << nbDifferent);
+
+  return nbDifferent;
+}
+
+/*
+ * This program is used to compare the per-descriptor and the batch quantization of a vocabulary tree
+ */
+int main(int argc, char** argv)
+{
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string treeName;
+  std::size_t nbDescriptors = 1000000;
+  std::uint32_t K = 10;
+  std::uint32_t LEVELS = 4;
+  int randomSeed = 0;
+
+  po::options_description allParams("This program is used to compare the per-descriptor and the batch quantization of a vocabulary tree\n"
+                                    "on synthetic descriptors. If no tree is given, a random tree is created.\n"
+                                    "AliceVision voctreeQuantizationBenchmark");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("tree,t", po::value<std::string>(&treeName), "Input name for the tree file (float descriptors)")
+    ("nbDescriptors,n", po::value<std::size_t>(&nbDescriptors)->default_value(nbDescriptors), "Number of synthetic descriptors to quantize")
+    ("branching,k", po::value<std::uint32_t>(&K)->default_value(K), "The branching factor of the random tree")
+    ("levels,l", po::value<std::uint32_t>(&LEVELS)->default_value(LEVELS), "The number of levels of the random tree")
+    ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed), "Seed of the random generator");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  std::mt19937 generator(randomSeed);
+
+  voctree::VocabularyTree<DescriptorFloat> tree;
+  if(treeName.empty())
+  {
+    const std::string syntheticTreeName = (fs::temp_directory_path() / fs::unique_path("voctree_%%%%%%%%.tree")).string();
+    ALICEVISION_LOG_INFO("Creating a random vocabulary tree (" << LEVELS << " levels, branching factor " << K << ")");
+    createSyntheticTree(syntheticTreeName, LEVELS, K, generator);
+    tree.load(syntheticTreeName);
+    fs::remove(syntheticTreeName);
+  }
+  else
+  {
+    ALICEVISION_LOG_INFO("Loading vocabulary tree " << treeName);
+    tree.load(treeName);
+  }
+
+  ALICEVISION_LOG_INFO("tree loaded with\n\t"
+          << tree.levels() << " levels\n\t"
+          << tree.splits() << " branching factor\n\t"
+          << tree.words() << " words");
+
+  std::size_t nbDifferent = 0;
+  nbDifferent += benchmark(tree, createDescriptors<DescriptorUChar>(tree, nbDescriptors, generator), "uint8");
+  nbDifferent += benchmark(tree, createDescriptors<DescriptorFloat>(tree, nbDescriptors, generator), "float");
+
+  if(nbDifferent != 0)
+  {
+    ALICEVISION_LOG_ERROR("The batch quantization gives different visual words.");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}